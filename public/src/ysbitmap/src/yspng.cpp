@@ -28,6 +28,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 //////////////////////////////////////////////////////////// */
 
 #include <stdio.h>
+#include <string.h>
 
 #include "yspng.h"
 
@@ -72,6 +73,8 @@ unsigned int YsGenericPngDecoder::verboseMode=YSFALSE;
 //     1bit Indexed Color was already supported.  I was forgetting to add in the list below.
 //   2014/12/21
 //     Small improvement in the de-compression efficiency.
+//   2026/10/17
+//     Table-driven inflate.  Non-interlaced images of 8 and 16 bit depth are unfiltered line by line.
 
 /* Supported color and depth
 
@@ -275,6 +278,7 @@ size_t YsPngBinaryMemoryStream::Read(unsigned char buf[],size_t readSize)
 
 YsGenericPngDecoder::YsGenericPngDecoder()
 {
+	useReferenceDecoder=YSFALSE;
 	Initialize();
 }
 
@@ -697,7 +701,467 @@ unsigned YsPngUncompressor::GetBackwardDistance
 	return backDist;
 }
 
+////////////////////////////////////////////////////////////
+
+static inline unsigned int YsPngReverseBit(unsigned int code,unsigned int nBit)
+{
+	unsigned int rev=0;
+	for(unsigned int i=0; i<nBit; ++i)
+	{
+		rev=(rev<<1)|(code&1);
+		code>>=1;
+	}
+	return rev;
+}
+
+int YsPngHuffmanTable::Make(unsigned int n,const unsigned int hLength[])
+{
+	unsigned int count[16],nextCode[16];
+
+	if(MAX_NUM_SYMBOL<n)
+	{
+		return YSERR;
+	}
+
+	for(auto &f : fast)
+	{
+		f=0;
+	}
+	for(auto &c : count)
+	{
+		c=0;
+	}
+	for(unsigned int i=0; i<n; ++i)
+	{
+		if(15<hLength[i])
+		{
+			return YSERR;
+		}
+		count[hLength[i]]++;
+	}
+	count[0]=0;
+
+	// See RFC1951 Specification.  Same as MakeDynamicHuffmanCode.
+	unsigned int code=0,k=0;
+	for(unsigned int len=1; len<16; ++len)
+	{
+		nextCode[len]=code;
+		firstCode[len]=(unsigned short)code;
+		firstSymbol[len]=(unsigned short)k;
+		code+=count[len];
+		if(0<count[len] && (1u<<len)<code)
+		{
+			return YSERR;  // Over-subscribed
+		}
+		maxCode[len]=code<<(16-len);
+		code<<=1;
+		k+=count[len];
+	}
+	maxCode[16]=0x10000;
+	nSymbol=n;
+
+	for(unsigned int i=0; i<n; ++i)
+	{
+		const unsigned int len=hLength[i];
+		if(0<len)
+		{
+			const unsigned int c=nextCode[len]-firstCode[len]+firstSymbol[len];
+			symbol[c]=(unsigned short)i;
+			if(len<=FAST_BITS)
+			{
+				const unsigned short entry=(unsigned short)((i<<4)|len);
+				for(unsigned int j=YsPngReverseBit(nextCode[len],len); j<FAST_SIZE; j+=(1<<len))
+				{
+					fast[j]=entry;
+				}
+			}
+			nextCode[len]++;
+		}
+	}
+
+	return YSOK;
+}
+
+int YsPngHuffmanTable::DecodeSlow(unsigned long long bits,unsigned int &nBit) const
+{
+	// Codes are stored MSB first in the stream.  Reversing the next 16 bits makes them comparable with maxCode.
+	const unsigned int k=YsPngReverseBit((unsigned int)(bits&0xffff),16);
+	unsigned int len;
+	for(len=FAST_BITS+1; maxCode[len]<=k; ++len)
+	{
+	}
+	if(16<=len)
+	{
+		return -1;
+	}
+	const unsigned int c=(k>>(16-len))-firstCode[len]+firstSymbol[len];
+	if(nSymbol<=c)
+	{
+		return -1;
+	}
+	nBit=len;
+	return symbol[c];
+}
+
+////////////////////////////////////////////////////////////
+
+/*! Returns the bits from bitPos of the stream, the first bit in the LSB.  At least 57 bits are valid.
+    The bits after the end of the stream are zero. */
+static inline unsigned long long YsPngPeekBit(const unsigned char dat[],size_t length,size_t bitPos)
+{
+	const size_t bytePtr=(bitPos>>3);
+	unsigned long long bits=0;
+	if(bytePtr+8<=length)
+	{
+		bits=(unsigned long long)dat[bytePtr]|
+		     ((unsigned long long)dat[bytePtr+1]<<8)|
+		     ((unsigned long long)dat[bytePtr+2]<<16)|
+		     ((unsigned long long)dat[bytePtr+3]<<24)|
+		     ((unsigned long long)dat[bytePtr+4]<<32)|
+		     ((unsigned long long)dat[bytePtr+5]<<40)|
+		     ((unsigned long long)dat[bytePtr+6]<<48)|
+		     ((unsigned long long)dat[bytePtr+7]<<56);
+	}
+	else
+	{
+		for(size_t i=0; i<8 && bytePtr+i<length; ++i)
+		{
+			bits|=((unsigned long long)dat[bytePtr+i]<<(8*i));
+		}
+	}
+	return bits>>(bitPos&7);
+}
+
+/*! Output buffer of the table-driven inflate, which also serves as the sliding window.
+    The last HISTORY_SIZE bytes are kept in the buffer after flushing so that the back-references can be copied
+    directly from the buffer.
+*/
+class YsPngInflateBuffer
+{
+public:
+	enum
+	{
+		HISTORY_SIZE=32768,
+		FLUSH_SIZE=65536,
+		MAX_COPY_LENGTH=258,
+		COPY_SLACK=8,
+		BUFFER_SIZE=HISTORY_SIZE+FLUSH_SIZE+MAX_COPY_LENGTH
+	};
+
+	YsGenericPngDecoder *output;
+	unsigned char *buf;
+	size_t used,flushed;
+
+	YsPngInflateBuffer(YsGenericPngDecoder *output)
+	{
+		this->output=output;
+		buf=new unsigned char [BUFFER_SIZE+COPY_SLACK];
+		used=0;
+		flushed=0;
+	}
+	~YsPngInflateBuffer()
+	{
+		delete [] buf;
+	}
+	inline YSBOOL IsFull(void) const
+	{
+		return (HISTORY_SIZE+FLUSH_SIZE<=used ? YSTRUE : YSFALSE);
+	}
+	int Flush(void)
+	{
+		int res=YSOK;
+		if(flushed<used)
+		{
+			res=output->OutputMultiByte(used-flushed,buf+flushed);
+		}
+		if(HISTORY_SIZE<used)
+		{
+			memmove(buf,buf+used-HISTORY_SIZE,HISTORY_SIZE);
+			used=HISTORY_SIZE;
+		}
+		flushed=used;
+		return res;
+	}
+};
+
 int YsPngUncompressor::Uncompress(size_t length,unsigned char dat[])
+{
+	static const unsigned short lengthBase[29]=
+	{
+		3,4,5,6,7,8,9,10,11,13,15,17,19,23,27,31,35,43,51,59,67,83,99,115,131,163,195,227,258
+	};
+	static const unsigned char lengthExtraBit[29]=
+	{
+		0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2,3,3,3,3,4,4,4,4,5,5,5,5,0
+	};
+	static const unsigned short distBase[30]=
+	{
+		1,2,3,4,5,7,9,13,17,25,33,49,65,97,129,193,257,385,513,769,1025,1537,2049,3073,4097,6145,8193,12289,16385,24577
+	};
+	static const unsigned char distExtraBit[30]=
+	{
+		0,0,0,0,1,1,2,2,3,3,4,4,5,5,6,6,7,7,8,8,9,9,10,10,11,11,12,12,13,13
+	};
+
+	if(length<2)
+	{
+		return YSERR;
+	}
+
+	if(YsGenericPngDecoder::verboseMode==YSTRUE)
+	{
+		printf("Begin zLib block length=%d\n",(int)length);
+	}
+
+	const unsigned char cmf=dat[0],flg=dat[1];
+	if((cmf&0x0f)!=8)
+	{
+		printf("Unsupported compression method! (%d)\n",cmf&0x0f);
+		return YSERR;
+	}
+	if(0!=(flg&32))
+	{
+		printf("PNG is not supposed to have a preset dictionary.\n");
+		return YSERR;
+	}
+
+	YsPngInflateBuffer outBuf(output);
+	YsPngHuffmanTable *codeTable=new YsPngHuffmanTable;
+	YsPngHuffmanTable *distTable=new YsPngHuffmanTable;
+	int fixedTableReady=0;
+	int outputError=0;
+
+	size_t bitPos=16;
+	for(;;)
+	{
+		unsigned long long bits=YsPngPeekBit(dat,length,bitPos);
+		const unsigned int bFinal=(unsigned int)(bits&1);
+		const unsigned int bType=(unsigned int)((bits>>1)&3);
+		bitPos+=3;
+
+		if(length<=(bitPos>>3))
+		{
+			printf("Buffer overflow\n");
+			goto ERREND;
+		}
+
+		if(YsGenericPngDecoder::verboseMode==YSTRUE)
+		{
+			printf("bFinal=%d bType=%d\n",bFinal,bType);
+		}
+
+		if(bType==0) // No Compression
+		{
+			size_t bytePtr=((bitPos+7)>>3);
+			if(length<bytePtr+4)
+			{
+				printf("Buffer overflow\n");
+				goto ERREND;
+			}
+
+			size_t len=dat[bytePtr]+dat[bytePtr+1]*256;
+			bytePtr+=4;
+			if(length<bytePtr+len)
+			{
+				printf("Buffer overflow\n");
+				goto ERREND;
+			}
+
+			while(0<len)
+			{
+				size_t nCopy=YsPngInflateBuffer::BUFFER_SIZE-outBuf.used;
+				if(len<nCopy)
+				{
+					nCopy=len;
+				}
+				memcpy(outBuf.buf+outBuf.used,dat+bytePtr,nCopy);
+				outBuf.used+=nCopy;
+				bytePtr+=nCopy;
+				len-=nCopy;
+				if(YSTRUE==outBuf.IsFull() && YSOK!=outBuf.Flush())
+				{
+					outputError=1;
+					goto ERREND;
+				}
+			}
+
+			bitPos=bytePtr*8;
+		}
+		else if(bType==1 || bType==2)
+		{
+			if(bType==1)
+			{
+				if(0==fixedTableReady)
+				{
+					unsigned hLength[288],hCode[288],hLengthDist[30];
+					MakeFixedHuffmanCode(hLength,hCode);
+					for(auto &l : hLengthDist)
+					{
+						l=5;
+					}
+					fixedTableReady=1;
+					if(YSOK!=codeTable->Make(288,hLength) || YSOK!=distTable->Make(30,hLengthDist))
+					{
+						goto ERREND;
+					}
+				}
+			}
+			else
+			{
+				unsigned hLit,hDist,hCLen;
+				unsigned *hLengthLiteral,*hCodeLiteral;
+				unsigned *hLengthDist,*hCodeDist;
+				unsigned hLengthBuf[322],hCodeBuf[322];
+
+				size_t bytePtr=(bitPos>>3);
+				unsigned int bitPtr=(1<<(bitPos&7));
+				DecodeDynamicHuffmanCode
+				   (hLit,hDist,hCLen,
+				    hLengthLiteral,hCodeLiteral,hLengthDist,hCodeDist,hLengthBuf,hCodeBuf,
+				    dat,bytePtr,bitPtr);
+				bitPos=bytePtr*8;
+				while(1<bitPtr)
+				{
+					++bitPos;
+					bitPtr>>=1;
+				}
+
+				fixedTableReady=0;
+				if(YSOK!=codeTable->Make(hLit+257,hLengthLiteral) || YSOK!=distTable->Make(hDist+1,hLengthDist))
+				{
+					printf("Huffman Decompression: Broken code lengths.\n");
+					goto ERREND;
+				}
+			}
+
+			for(;;)
+			{
+				// Literal/length code (up to 15 bits), length extra bits (up to 5), distance code (up to 15),
+				// and distance extra bits (up to 13) fit in the 57 bits from one peek.
+				unsigned int nBit;
+				bits=YsPngPeekBit(dat,length,bitPos);
+
+				const int value=codeTable->Decode(bits,nBit);
+				if(value<0)
+				{
+					printf("Huffman Decompression: Invalid code.\n");
+					goto ERREND;
+				}
+				bits>>=nBit;
+				bitPos+=nBit;
+
+				if(value<256)
+				{
+					outBuf.buf[outBuf.used++]=(unsigned char)value;
+				}
+				else if(value==256)
+				{
+					break;
+				}
+				else
+				{
+					const unsigned int lengthCode=value-257;
+					if(29<=lengthCode)
+					{
+						printf("Huffman Decompression: Invalid length code.\n");
+						goto ERREND;
+					}
+					const unsigned int lengthExtra=lengthExtraBit[lengthCode];
+					const unsigned int copyLength=lengthBase[lengthCode]+(unsigned int)(bits&((1<<lengthExtra)-1));
+					bits>>=lengthExtra;
+					bitPos+=lengthExtra;
+
+					const int distCode=distTable->Decode(bits,nBit);
+					if(distCode<0 || 30<=distCode)
+					{
+						printf("Huffman Decompression: Invalid distance code.\n");
+						goto ERREND;
+					}
+					bits>>=nBit;
+					bitPos+=nBit;
+
+					const unsigned int distExtra=distExtraBit[distCode];
+					const size_t backDist=distBase[distCode]+(unsigned int)(bits&((1<<distExtra)-1));
+					bitPos+=distExtra;
+
+					if(outBuf.used<backDist)
+					{
+						printf("Huffman Decompression: Back reference before the beginning of the data.\n");
+						goto ERREND;
+					}
+
+					// The buffer has COPY_SLACK bytes after the end so that the copy can run in 8-byte pieces.
+					// If backDist is less than 8, a piece overlaps the bytes being written, and it needs to be
+					// copied byte by byte.
+					unsigned char *to=outBuf.buf+outBuf.used;
+					const unsigned char *from=to-backDist;
+					if(8<=backDist)
+					{
+						for(unsigned int i=0; i<copyLength; i+=8)
+						{
+							memcpy(to+i,from+i,8);
+						}
+					}
+					else if(1==backDist)
+					{
+						memset(to,from[0],copyLength);
+					}
+					else
+					{
+						for(unsigned int i=0; i<copyLength; ++i)
+						{
+							to[i]=from[i];
+						}
+					}
+					outBuf.used+=copyLength;
+				}
+
+				if(YSTRUE==outBuf.IsFull() && YSOK!=outBuf.Flush())
+				{
+					outputError=1;
+					goto ERREND;
+				}
+
+				if(length<=(bitPos>>3))
+				{
+					goto ERREND;
+				}
+			}
+		}
+		else
+		{
+			printf("Unknown compression type (bType=3)\n");
+			goto ERREND;
+		}
+
+		if(bFinal!=0)
+		{
+			break;
+		}
+	}
+
+	delete codeTable;
+	delete distTable;
+
+	if(YsGenericPngDecoder::verboseMode==YSTRUE)
+	{
+		printf("End zLib block length=%d bytePtr=%d\n",(int)length,(int)(bitPos>>3));
+	}
+
+	return outBuf.Flush();
+
+ERREND:
+	delete codeTable;
+	delete distTable;
+	if(0==outputError)
+	{
+		// Give the bytes decoded before the error, as UncompressBitByBit does.
+		outBuf.Flush();
+	}
+	return YSERR;
+}
+
+int YsPngUncompressor::UncompressBitByBit(size_t length,unsigned char dat[])
 {
 	size_t windowUsed;
 	unsigned char *windowBuf;
@@ -1099,7 +1563,14 @@ int YsGenericPngDecoder::Decode(YsPngGenericBinaryStream &binStream)
 	{
 		YsPngUncompressor uncompressor;
 		uncompressor.output=this;
-		uncompressor.Uncompress(datBufUsed,datBuf);
+		if(YSTRUE==useReferenceDecoder)
+		{
+			uncompressor.UncompressBitByBit(datBufUsed,datBuf);
+		}
+		else
+		{
+			uncompressor.Uncompress(datBufUsed,datBuf);
+		}
 
 		EndOutput();
 	}
@@ -1119,6 +1590,18 @@ int YsGenericPngDecoder::Output(unsigned char)
 	return YSOK;
 }
 
+int YsGenericPngDecoder::OutputMultiByte(size_t nByte,const unsigned char dat[])
+{
+	for(size_t i=0; i<nByte; ++i)
+	{
+		if(YSOK!=Output(dat[i]))
+		{
+			return YSERR;
+		}
+	}
+	return YSOK;
+}
+
 int YsGenericPngDecoder::EndOutput(void)
 {
 	return YSOK;
@@ -1200,6 +1683,217 @@ static inline void Filter8(unsigned char curLine[],unsigned char prvLine[],int x
 	}
 }
 
+////////////////////////////////////////////////////////////
+
+// Line-by-line unfiltering.  Same results as Filter8 applied pixel by pixel.
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && 2<=_M_IX86_FP)
+#define YSPNG_USE_SSE2
+#include <emmintrin.h>
+
+// A pixel is assembled from the bytes.  Copying 3 bytes to an int in memory and reading it back stalls the
+// store forwarding.  bpp is 3 or 4.
+template <unsigned int bpp>
+static inline __m128i YsPngLoadPixel(const unsigned char ptr[])
+{
+	unsigned int v=(unsigned int)ptr[0]|((unsigned int)ptr[1]<<8)|((unsigned int)ptr[2]<<16);
+	if(4==bpp)
+	{
+		v|=((unsigned int)ptr[3]<<24);
+	}
+	return _mm_cvtsi32_si128((int)v);
+}
+
+template <unsigned int bpp>
+static inline void YsPngStorePixel(unsigned char ptr[],__m128i v)
+{
+	const unsigned int i=(unsigned int)_mm_cvtsi128_si32(v);
+	ptr[0]=(unsigned char)i;
+	ptr[1]=(unsigned char)(i>>8);
+	ptr[2]=(unsigned char)(i>>16);
+	if(4==bpp)
+	{
+		ptr[3]=(unsigned char)(i>>24);
+	}
+}
+
+static inline __m128i YsPngAbs16(__m128i v)
+{
+	return _mm_max_epi16(v,_mm_sub_epi16(_mm_setzero_si128(),v));
+}
+
+static inline __m128i YsPngSelect(__m128i cond,__m128i ifTrue,__m128i ifFalse)
+{
+	return _mm_or_si128(_mm_and_si128(cond,ifTrue),_mm_andnot_si128(cond,ifFalse));
+}
+
+// For 3 and 4 bytes per pixel, a pixel is processed in one SSE2 register.
+template <unsigned int bpp>
+static void YsPngUnfilterSubSSE2(unsigned char cur[],size_t lineLng)
+{
+	__m128i a=_mm_setzero_si128();
+	for(size_t i=0; i+bpp<=lineLng; i+=bpp)
+	{
+		a=_mm_add_epi8(a,YsPngLoadPixel<bpp>(cur+i));
+		YsPngStorePixel<bpp>(cur+i,a);
+	}
+}
+
+template <unsigned int bpp>
+static void YsPngUnfilterAverageSSE2(unsigned char cur[],const unsigned char prv[],size_t lineLng)
+{
+	const __m128i one=_mm_set1_epi8(1);
+	__m128i a=_mm_setzero_si128();
+	for(size_t i=0; i+bpp<=lineLng; i+=bpp)
+	{
+		const __m128i b=YsPngLoadPixel<bpp>(prv+i);
+		// _mm_avg_epu8 rounds up.  Subtracting the lost bit makes it (a+b)/2.
+		const __m128i avg=_mm_sub_epi8(_mm_avg_epu8(a,b),_mm_and_si128(_mm_xor_si128(a,b),one));
+		a=_mm_add_epi8(YsPngLoadPixel<bpp>(cur+i),avg);
+		YsPngStorePixel<bpp>(cur+i,a);
+	}
+}
+
+template <unsigned int bpp>
+static void YsPngUnfilterPaethSSE2(unsigned char cur[],const unsigned char prv[],size_t lineLng)
+{
+	const __m128i zero=_mm_setzero_si128();
+	__m128i a=zero,b=zero,c=zero,d=zero;
+	for(size_t i=0; i+bpp<=lineLng; i+=bpp)
+	{
+		c=b;
+		b=_mm_unpacklo_epi8(YsPngLoadPixel<bpp>(prv+i),zero);
+		a=d;
+		d=_mm_unpacklo_epi8(YsPngLoadPixel<bpp>(cur+i),zero);
+
+		// pa=|p-a|=|b-c|, pb=|p-b|=|a-c|, pc=|p-c|=|(b-c)+(a-c)|
+		__m128i pa=_mm_sub_epi16(b,c);
+		__m128i pb=_mm_sub_epi16(a,c);
+		__m128i pc=_mm_add_epi16(pa,pb);
+		pa=YsPngAbs16(pa);
+		pb=YsPngAbs16(pb);
+		pc=YsPngAbs16(pc);
+
+		// Same tie-breaking as Paeth: a if pa is the smallest, b if pb is the smallest, c otherwise.
+		const __m128i smallest=_mm_min_epi16(pc,_mm_min_epi16(pa,pb));
+		const __m128i nearest=YsPngSelect(_mm_cmpeq_epi16(smallest,pa),a,YsPngSelect(_mm_cmpeq_epi16(smallest,pb),b,c));
+
+		d=_mm_and_si128(_mm_add_epi16(d,nearest),_mm_set1_epi16(0xff));
+		YsPngStorePixel<bpp>(cur+i,_mm_packus_epi16(d,d));
+	}
+}
+#endif
+
+static void YsPngUnfilterLine(unsigned char cur[],const unsigned char prv[],size_t lineLng,unsigned int bpp,int filter)
+{
+	// prv is NULL for the first line.
+	switch(filter)
+	{
+	case 1:
+		#ifdef YSPNG_USE_SSE2
+		if(3==bpp)
+		{
+			YsPngUnfilterSubSSE2<3>(cur,lineLng);
+			break;
+		}
+		else if(4==bpp)
+		{
+			YsPngUnfilterSubSSE2<4>(cur,lineLng);
+			break;
+		}
+		#endif
+		for(size_t i=bpp; i<lineLng; ++i)
+		{
+			cur[i]+=cur[i-bpp];
+		}
+		break;
+	case 2:
+		if(nullptr!=prv)
+		{
+			size_t i=0;
+			#ifdef YSPNG_USE_SSE2
+			for(; i+16<=lineLng; i+=16)
+			{
+				const __m128i c=_mm_loadu_si128((const __m128i *)(cur+i));
+				const __m128i p=_mm_loadu_si128((const __m128i *)(prv+i));
+				_mm_storeu_si128((__m128i *)(cur+i),_mm_add_epi8(c,p));
+			}
+			#endif
+			for(; i<lineLng; ++i)
+			{
+				cur[i]+=prv[i];
+			}
+		}
+		break;
+	case 3:
+		if(nullptr!=prv)
+		{
+			#ifdef YSPNG_USE_SSE2
+			if(3==bpp)
+			{
+				YsPngUnfilterAverageSSE2<3>(cur,prv,lineLng);
+				break;
+			}
+			else if(4==bpp)
+			{
+				YsPngUnfilterAverageSSE2<4>(cur,prv,lineLng);
+				break;
+			}
+			#endif
+			for(size_t i=0; i<bpp && i<lineLng; ++i)
+			{
+				cur[i]+=(unsigned char)(prv[i]/2);
+			}
+			for(size_t i=bpp; i<lineLng; ++i)
+			{
+				cur[i]+=(unsigned char)(((unsigned int)cur[i-bpp]+(unsigned int)prv[i])/2);
+			}
+		}
+		else
+		{
+			for(size_t i=bpp; i<lineLng; ++i)
+			{
+				cur[i]+=(unsigned char)(cur[i-bpp]/2);
+			}
+		}
+		break;
+	case 4:
+		if(nullptr!=prv)
+		{
+			#ifdef YSPNG_USE_SSE2
+			if(3==bpp)
+			{
+				YsPngUnfilterPaethSSE2<3>(cur,prv,lineLng);
+				break;
+			}
+			else if(4==bpp)
+			{
+				YsPngUnfilterPaethSSE2<4>(cur,prv,lineLng);
+				break;
+			}
+			#endif
+			// Paeth(0,b,0) is b.
+			for(size_t i=0; i<bpp && i<lineLng; ++i)
+			{
+				cur[i]+=prv[i];
+			}
+			for(size_t i=bpp; i<lineLng; ++i)
+			{
+				cur[i]+=Paeth(cur[i-bpp],prv[i],prv[i-bpp]);
+			}
+		}
+		else
+		{
+			// Paeth(a,0,0) is a.
+			for(size_t i=bpp; i<lineLng; ++i)
+			{
+				cur[i]+=cur[i-bpp];
+			}
+		}
+		break;
+	}
+}
+
 YsRawPngDecoder::YsRawPngDecoder()
 {
 	wid=0;
@@ -1210,6 +1904,10 @@ YsRawPngDecoder::YsRawPngDecoder()
 	curLine8=NULL;
 	prvLine8=NULL;
 
+	lineByLine=0;
+	lineLng=0;
+	bytePerPixel=0;
+
 	autoDeleteRgbaBuffer=1;
 }
 
@@ -1320,6 +2018,7 @@ int YsRawPngDecoder::PrepareOutput(void)
 	x=-1;
 	y=0;
 	filter=0;
+	lineByLine=0;
 	inLineCount=0;
 	inPixelCount=0;
 	firstByte=1;
@@ -1416,6 +2115,29 @@ int YsRawPngDecoder::PrepareOutput(void)
 	curLine8=twoLineBuf8;
 	prvLine8=twoLineBuf8+twoLineBufLngPerLine;
 
+	lineLng=twoLineBufLngPerLine;
+	bytePerPixel=0;
+	if(YSTRUE!=useReferenceDecoder && 0==hdr.interlaceMethod && 0<wid)
+	{
+		switch(hdr.colorType)
+		{
+		case 0:   // Greyscale
+		case 3:   // Indexed-color
+			bytePerPixel=(8==hdr.bitDepth ? 1 : 0);
+			break;
+		case 2:   // Truecolor
+			bytePerPixel=(8==hdr.bitDepth ? 3 : (16==hdr.bitDepth ? 6 : 0));
+			break;
+		case 4:   // Greyscale with alpha
+			bytePerPixel=(8==hdr.bitDepth ? 2 : 0);
+			break;
+		case 6:   // Truecolor with alpha
+			bytePerPixel=(8==hdr.bitDepth ? 4 : 0);
+			break;
+		}
+	}
+	lineByLine=(0<bytePerPixel ? 1 : 0);
+
 	return YSOK;
 }
 
@@ -1425,6 +2147,11 @@ int YsRawPngDecoder::Output(unsigned char dat)
 	unsigned int colIdx;
 	unsigned int interlaceWid,interlaceHei,interlaceX,interlaceY;
 
+	if(0!=lineByLine)
+	{
+		return OutputLineByLine(1,&dat);
+	}
+
 	if(y>=hei)
 	{
 		return YSERR;
@@ -2005,8 +2732,162 @@ int YsRawPngDecoder::Output(unsigned char dat)
 	// return YSERR;
 }
 
+int YsRawPngDecoder::OutputMultiByte(size_t nByte,const unsigned char dat[])
+{
+	if(0!=lineByLine)
+	{
+		return OutputLineByLine(nByte,dat);
+	}
+	return YsGenericPngDecoder::OutputMultiByte(nByte,dat);
+}
+
+int YsRawPngDecoder::OutputLineByLine(size_t nByte,const unsigned char dat[])
+{
+	while(0<nByte)
+	{
+		if(y>=hei)
+		{
+			return YSERR;
+		}
+
+		if(x==-1)  // First byte is filter type for the line.
+		{
+			filter=dat[0];
+			inLineCount=0;
+			x=0;
+			++dat;
+			--nByte;
+			continue;
+		}
+
+		size_t nCopy=lineLng-(size_t)inLineCount;
+		if(nByte<nCopy)
+		{
+			nCopy=nByte;
+		}
+		memcpy(curLine8+inLineCount,dat,nCopy);
+		inLineCount+=(int)nCopy;
+		dat+=nCopy;
+		nByte-=nCopy;
+
+		if((size_t)inLineCount==lineLng)
+		{
+			UnfilterAndConvertLine(wid);
+			y++;
+			x=-1;
+			ShiftTwoLineBuf();
+		}
+	}
+	return YSOK;
+}
+
+void YsRawPngDecoder::UnfilterAndConvertLine(unsigned int nPixel)
+{
+	YsPngUnfilterLine(curLine8,(0<y ? prvLine8 : nullptr),nPixel*bytePerPixel,bytePerPixel,filter);
+
+	const unsigned char *src=curLine8;
+	unsigned char *dst=rgba+index;
+	switch(hdr.colorType)
+	{
+	case 0:   // Greyscale 8 bit
+		for(unsigned int i=0; i<nPixel; ++i)
+		{
+			dst[0]=src[0];
+			dst[1]=src[0];
+			dst[2]=src[0];
+			dst[3]=((src[0]==trns.col[0] || src[0]==trns.col[1] || src[0]==trns.col[2]) ? 0 : 255);
+			src+=1;
+			dst+=4;
+		}
+		break;
+	case 2:   // Truecolor
+		if(8==hdr.bitDepth && (255<trns.col[0] || 255<trns.col[1] || 255<trns.col[2]))
+		{
+			// No 8-bit color can match the transparent color.
+			for(unsigned int i=0; i<nPixel; ++i)
+			{
+				dst[0]=src[0];
+				dst[1]=src[1];
+				dst[2]=src[2];
+				dst[3]=255;
+				src+=3;
+				dst+=4;
+			}
+		}
+		else if(8==hdr.bitDepth)
+		{
+			for(unsigned int i=0; i<nPixel; ++i)
+			{
+				dst[0]=src[0];
+				dst[1]=src[1];
+				dst[2]=src[2];
+				dst[3]=((src[0]==trns.col[0] && src[1]==trns.col[1] && src[2]==trns.col[2]) ? 0 : 255);
+				src+=3;
+				dst+=4;
+			}
+		}
+		else
+		{
+			for(unsigned int i=0; i<nPixel; ++i)
+			{
+				dst[0]=src[0];
+				dst[1]=src[2];
+				dst[2]=src[4];
+				r=src[0]*256+src[1];
+				g=src[2]*256+src[3];
+				b=src[4]*256+src[5];
+				dst[3]=((r==trns.col[0] && g==trns.col[1] && b==trns.col[2]) ? 0 : 255);
+				src+=6;
+				dst+=4;
+			}
+		}
+		break;
+	case 3:   // Indexed-color 8 bit
+		for(unsigned int i=0; i<nPixel; ++i)
+		{
+			const unsigned int colIdx=src[0];
+			if(colIdx<plt.nEntry)
+			{
+				dst[0]=plt.entry[colIdx*3  ];
+				dst[1]=plt.entry[colIdx*3+1];
+				dst[2]=plt.entry[colIdx*3+2];
+				dst[3]=((colIdx==trns.col[0] || colIdx==trns.col[1] || colIdx==trns.col[2]) ? 0 : 255);
+			}
+			src+=1;
+			dst+=4;
+		}
+		break;
+	case 4:   // Greyscale with alpha 8 bit
+		for(unsigned int i=0; i<nPixel; ++i)
+		{
+			dst[0]=src[0];
+			dst[1]=src[0];
+			dst[2]=src[0];
+			dst[3]=src[1];
+			src+=2;
+			dst+=4;
+		}
+		break;
+	case 6:   // Truecolor with alpha 8 bit
+		memcpy(dst,src,nPixel*4);
+		break;
+	}
+
+	index+=nPixel*4;
+	x=nPixel;
+}
+
 int YsRawPngDecoder::EndOutput(void)
 {
+	if(0!=lineByLine && 0<=x && y<hei)
+	{
+		// The data ended in the middle of a line.  Give the pixels received so far, as Output does.
+		const unsigned int nPixel=(unsigned int)inLineCount/bytePerPixel;
+		if(0<nPixel)
+		{
+			UnfilterAndConvertLine(nPixel);
+		}
+	}
 	if(YsGenericPngDecoder::verboseMode==YSTRUE)
 	{
 		printf("Final Position (%d,%d)\n",x,y);
@@ -84,6 +84,45 @@ public:
 	}
 };
 
+/*! Canonical Huffman decoding table for the table-driven inflate.
+    Codes up to FAST_BITS long are decoded by a single lookup of the next FAST_BITS bits.
+    Longer codes are decoded by comparing the bit-reversed next 16 bits against the largest code of each length.
+*/
+class YsPngHuffmanTable
+{
+public:
+	enum
+	{
+		FAST_BITS=9,
+		FAST_SIZE=1<<FAST_BITS,
+		MAX_NUM_SYMBOL=288
+	};
+
+	unsigned short fast[FAST_SIZE];        // (symbol<<4)|codeLength, or 0 if the code is longer than FAST_BITS.
+	unsigned int maxCode[17];              // One plus the largest code of each length, left-aligned to 16 bits.
+	unsigned short firstCode[16];
+	unsigned short firstSymbol[16];
+	unsigned short symbol[MAX_NUM_SYMBOL]; // Symbols sorted by the code.
+	unsigned int nSymbol;
+
+	/*! Makes a table from the code lengths.  Returns YSERR if the code lengths are over-subscribed. */
+	int Make(unsigned int n,const unsigned int hLength[]);
+
+	/*! Decodes a symbol from the bits (the next bit of the stream in the LSB).
+	    Returns the symbol and the code length in nBit, or -1 if the bits are not a valid code. */
+	inline int Decode(unsigned long long bits,unsigned int &nBit) const
+	{
+		const unsigned int entry=fast[bits&(FAST_SIZE-1)];
+		if(0!=entry)
+		{
+			nBit=(entry&15);
+			return (int)(entry>>4);
+		}
+		return DecodeSlow(bits,nBit);
+	}
+	int DecodeSlow(unsigned long long bits,unsigned int &nBit) const;
+};
+
 class YsPngUncompressor
 {
 public:
@@ -132,7 +171,12 @@ public:
 	unsigned GetCopyLength(unsigned value,unsigned char dat[],size_t &bytePtr,unsigned &bitPtr);
 	unsigned GetBackwardDistance(unsigned distCode,unsigned char dat[],size_t &bytePtr,unsigned &bitPtr);
 
+	/*! Decodes a zlib stream by the table-driven inflate.  The output is sent to output->OutputMultiByte. */
 	int Uncompress(size_t length,unsigned char dat[]);
+
+	/*! The original inflate that walks the Huffman tree bit by bit, and sends the output to output->Output byte by byte.
+	    It is slow, but is kept as the reference for verifying Uncompress. */
+	int UncompressBitByBit(size_t length,unsigned char dat[]);
 };
 
 ////////////////////////////////////////////////////////////
@@ -209,6 +253,10 @@ public:
 	YsPngTransparency trns;
 	unsigned int gamma;
 
+	/*! If YSTRUE, the image is decoded by the original bit-by-bit inflate and byte-by-byte unfiltering.
+	    It is slow.  It is for verifying the output of the fast decoder. */
+	YSBOOL useReferenceDecoder;
+
 	static unsigned int verboseMode;
 
 	YsGenericPngDecoder();
@@ -221,6 +269,8 @@ public:
 
 	virtual int PrepareOutput(void);
 	virtual int Output(unsigned char dat);
+	/*! Receives nByte bytes of the uncompressed data.  The default implementation calls Output for each byte. */
+	virtual int OutputMultiByte(size_t nByte,const unsigned char dat[]);
 	virtual int EndOutput(void);
 };
 
@@ -263,12 +313,25 @@ public:
 	// For filtering
 	unsigned char *twoLineBuf8,*curLine8,*prvLine8;
 
+	// Non-interlaced images of 8 and 16 bit depth are unfiltered a line at a time.
+	// In this mode, inLineCount is the number of bytes stored in curLine8.
+	int lineByLine;
+	size_t lineLng;
+	unsigned int bytePerPixel;
+
 	void ShiftTwoLineBuf(void);
 
 	virtual int PrepareOutput(void);
 	virtual int Output(unsigned char dat);
+	virtual int OutputMultiByte(size_t nByte,const unsigned char dat[]);
 	virtual int EndOutput(void);
 
+private:
+	int OutputLineByLine(size_t nByte,const unsigned char dat[]);
+	void UnfilterAndConvertLine(unsigned int nPixel);
+
+public:
+
 	void Flip(void);  // For drawing in OpenGL
 };
 
@@ -115,6 +115,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "ysshelloctree.h"
 #include "ysshelllattice.h"
 #include "ysshellkdtree.h"
+#include "ysshellbbxtree.h"
 
 #include "ysshell2d.h"
 
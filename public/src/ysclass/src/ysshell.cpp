@@ -370,6 +370,8 @@ void YsShell::CommonInitialization(void)
 	searchTable=NULL;
 
 	trustPolygonNormal=YSFALSE;
+
+	shapeModificationCounter=0;
 }
 
 YsShell::~YsShell()
@@ -418,6 +420,7 @@ void YsShell::CleanUp(void)
 	}
 	RewindSearchKey();
 	bbxIsValid=YSFALSE;
+	++shapeModificationCounter;
 
 	vtxMapping.CleanUp();
 
@@ -610,6 +613,7 @@ YsShellVertexHandle YsShell::AddVertexH(const YsVec3 &vec0)
 		}
 
 		vtx[neo]->SetPosition(vec);
+		++shapeModificationCounter;
 
 		if(searchTable!=NULL)
 		{
@@ -654,6 +658,7 @@ YsShell::PolygonHandle YsShell::AddPolygonH(YSSIZE_T nv,const YsShellVertexHandl
 	{
 		YSSIZE_T i;
 		plg[neo]->SetVertexList(nv,vtHd);
+		++shapeModificationCounter;
 
 		for(i=0; i<nv; i++)
 		{
@@ -746,6 +751,7 @@ YSRESULT YsShell::ModifyPolygon(YsShellPolygonHandle plHd,YSSIZE_T nv,const YsSh
 		}
 
 		plg->SetVertexList(nv,v);
+		++shapeModificationCounter;
 
 		if(searchTable!=NULL)
 		{
@@ -861,6 +867,7 @@ YSRESULT YsShell::ModifyVertexPosition(YsShellVertexHandle vtHd,const YsVec3 &ne
 		}
 		vtx->SetPosition(neoPos);
 		bbxIsValid=YSFALSE;
+		++shapeModificationCounter;
 		return YSOK;
 	}
 	return YSERR;
@@ -2112,6 +2119,7 @@ YSRESULT YsShell::DeleteVertex(YsShellVertexHandle vtHd)
 		vtx.Delete(vtHd);
 
 		bbxIsValid=YSFALSE;
+		++shapeModificationCounter;
 
 		return YSOK;
 	}
@@ -2152,6 +2160,7 @@ YSRESULT YsShell::DeletePolygon(YsShellPolygonHandle plHd)
 
 		DetachSpecialAttributeBeforeDeletingPolygon(*plg[plHd]);
 		plg.Delete(plHd);
+		++shapeModificationCounter;
 
 		return YSOK;
 	}
@@ -2937,6 +2946,11 @@ int YsShell::GetNumVertex(void) const
 	return (int)vtx.GetN();
 }
 
+unsigned long long int YsShell::GetShapeModificationCounter(void) const
+{
+	return shapeModificationCounter;
+}
+
 int YsShell::GetMaxNumVertexOfPolygon(void) const
 {
 	int n,t;
@@ -4890,6 +4904,7 @@ YSRESULT YsShell::FreezeVertex(YsShellVertexHandle vtHd)
 		vtx.Freeze(vtHd);
 
 		bbxIsValid=YSFALSE;
+		++shapeModificationCounter;
 
 		return YSOK;
 	}
@@ -4926,6 +4941,7 @@ YSRESULT YsShell::FreezePolygon(YsShellPolygonHandle plHd)
 		}
 
 		plg.Freeze(plHd);
+		++shapeModificationCounter;
 
 		return YSOK;
 	}
@@ -4939,6 +4955,7 @@ YSRESULT YsShell::MeltVertex(YsShellVertexHandle vtHd)
 		if(YSTRUE==vtx.IsFrozen(vtHd))
 		{
 			vtx.Melt(vtHd);
+			++shapeModificationCounter;
 			if(searchTable!=NULL)
 			{
 				searchTable->AddVertex(*this,vtHd);
@@ -4966,6 +4983,7 @@ YSRESULT YsShell::MeltPolygon(YsShellPolygonHandle plHd)
 		if(YSTRUE==plg.IsFrozen(plHd))
 		{
 			plg.Melt(plHd);
+			++shapeModificationCounter;
 
 			auto plgPtr=plg[plHd];
 			for(int i=0; i<plgPtr->GetNumVertex(); i++)
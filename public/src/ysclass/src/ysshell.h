@@ -1365,6 +1365,12 @@ public:
 	int GetNumVertex(void) const;
 	int GetMaxNumVertexOfPolygon(void) const;
 
+	/*! Returns a number that changes whenever a vertex or a polygon is added, deleted, frozen, or melted,
+	    a vertex is moved, or the vertices of a polygon are changed.  A cache made from the shape of the shell
+	    is valid while the number stays the same.
+	    Changes made directly to YsShellVertex or YsShellPolygon taken by GetVertex or GetPolygon are not counted. */
+	unsigned long long int GetShapeModificationCounter(void) const;
+
 	/*! Returns the vertex position in pos. */
 	YSRESULT GetVertexPosition(YsVec3 &pos,int vtId) const;
 
@@ -1714,6 +1720,9 @@ protected:
 	mutable YSBOOL bbxIsValid;
 	mutable YsVec3 bbx1,bbx2;
 
+	// Incremented by the functions that change the shape.  See GetShapeModificationCounter.
+	unsigned long long int shapeModificationCounter;
+
 public:
 	void ResetVertexMapping(void);
 	VertexHandle FindVertexMapping(const YsShellVertex *fromVtx) const;
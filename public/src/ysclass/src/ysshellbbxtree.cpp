@@ -0,0 +1,404 @@
+/* ////////////////////////////////////////////////////////////
+
+File Name: ysshellbbxtree.cpp
+Copyright (c) 2017 Soji Yamakawa.  All rights reserved.
+http://www.ysflight.com
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, 
+   this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, 
+   this list of conditions and the following disclaimer in the documentation 
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR 
+PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) 
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+//////////////////////////////////////////////////////////// */
+
+#include <algorithm>
+
+#include "ysclass.h"
+#include "ysshellbbxtree.h"
+
+
+
+YsShellBoundingBoxTree::YsShellBoundingBoxTree()
+{
+	CleanUp();
+}
+
+void YsShellBoundingBoxTree::CleanUp(void)
+{
+	vtxPos.CleanUp();
+	plg.CleanUp();
+	node.CleanUp();
+}
+
+YSRESULT YsShellBoundingBoxTree::Build(const YsShell &shl)
+{
+	CleanUp();
+
+	YsArray <Polygon> unsorted;
+	YsArray <YsVec3> unsortedVtxPos;
+	YsArray <YsVec3> center;
+	for(auto plHd : shl.AllPolygon())
+	{
+		int nPlVt;
+		const YsShellVertexHandle *plVtHd;
+		if(YSOK!=shl.GetPolygon(nPlVt,plVtHd,plHd) || 0==nPlVt)
+		{
+			continue;
+		}
+
+		Polygon newPlg;
+		newPlg.plHd=plHd;
+		newPlg.vtx0=unsortedVtxPos.GetN();
+		newPlg.nVtx=nPlVt;
+		for(int i=0; i<nPlVt; ++i)
+		{
+			unsortedVtxPos.Append(shl.GetVertex(plVtHd[i])->GetPosition());
+		}
+
+		const YsVec3 *v=unsortedVtxPos.GetArray()+newPlg.vtx0;
+
+		// Same normal that YsCheckShellCollisionEx(YsShell,YsShell) gives to YsCollisionOfPolygon.
+		newPlg.nom=shl.GetPolygon(plHd)->GetNormal();
+		if(YSTRUE!=shl.TrustPolygonNormal() || YsOrigin()==newPlg.nom)
+		{
+			YsGetAverageNormalVector(newPlg.nom,nPlVt,v);
+		}
+
+		YsBoundingBoxMaker3 bbx;
+		bbx.Make(nPlVt,v);
+		bbx.Get(newPlg.bbxMin,newPlg.bbxMax);
+
+		unsorted.Append(newPlg);
+		center.Append((newPlg.bbxMin+newPlg.bbxMax)/2.0);
+	}
+
+	if(0==unsorted.GetN())
+	{
+		return YSOK;
+	}
+
+	YsArray <YSSIZE_T> order;
+	order.Resize(unsorted.GetN());
+	for(YSSIZE_T i=0; i<order.GetN(); ++i)
+	{
+		order[i]=i;
+	}
+
+	// Node and polygon ranges are decided with the unsorted polygons first.
+	// Then, the polygons and vertices are copied in the leaf order.
+	plg=unsorted;
+	BuildNode(order,center,0,order.GetN());
+
+	for(YSSIZE_T i=0; i<order.GetN(); ++i)
+	{
+		const Polygon &from=unsorted[order[i]];
+		plg[i]=from;
+		plg[i].vtx0=vtxPos.GetN();
+		for(YSSIZE_T j=0; j<from.nVtx; ++j)
+		{
+			vtxPos.Append(unsortedVtxPos[from.vtx0+j]);
+		}
+	}
+
+	return YSOK;
+}
+
+YSSIZE_T YsShellBoundingBoxTree::BuildNode(YsArray <YSSIZE_T> &order,YsArray <YsVec3> &center,YSSIZE_T i0,YSSIZE_T i1)
+{
+	const YSSIZE_T nodeIdx=node.GetN();
+	node.Increment();
+
+	YsBoundingBoxMaker3 bbx,cenBbx;
+	for(YSSIZE_T i=i0; i<i1; ++i)
+	{
+		bbx.Add(plg[order[i]].bbxMin);
+		bbx.Add(plg[order[i]].bbxMax);
+		cenBbx.Add(center[order[i]]);
+	}
+	bbx.Get(node[nodeIdx].bbxMin,node[nodeIdx].bbxMax);
+	node[nodeIdx].child[0]=-1;
+	node[nodeIdx].child[1]=-1;
+	node[nodeIdx].plg0=i0;
+	node[nodeIdx].nPlg=i1-i0;
+
+	YsVec3 cenMin,cenMax;
+	cenBbx.Get(cenMin,cenMax);
+	const YsVec3 dgn=cenMax-cenMin;
+
+	if(i1-i0<=MAX_NUM_POLYGON_PER_LEAF || dgn.GetSquareLength()<YsSqr(YsTolerance))
+	{
+		return nodeIdx;
+	}
+
+	// Median split along the longest axis of the polygon centers.
+	int axis=0;
+	if(dgn[axis]<dgn[1])
+	{
+		axis=1;
+	}
+	if(dgn[axis]<dgn[2])
+	{
+		axis=2;
+	}
+
+	const YSSIZE_T mid=(i0+i1)/2;
+	const YsVec3 *cenPtr=center.GetArray();
+	std::nth_element(order.GetEditableArray()+i0,order.GetEditableArray()+mid,order.GetEditableArray()+i1,
+	    [cenPtr,axis](YSSIZE_T a,YSSIZE_T b){return cenPtr[a][axis]<cenPtr[b][axis];});
+
+	const YSSIZE_T child0=BuildNode(order,center,i0,mid);
+	const YSSIZE_T child1=BuildNode(order,center,mid,i1);
+	node[nodeIdx].child[0]=child0;
+	node[nodeIdx].child[1]=child1;
+	node[nodeIdx].nPlg=0;
+
+	return nodeIdx;
+}
+
+YSBOOL YsShellBoundingBoxTree::IsEmpty(void) const
+{
+	return (0==node.GetN() ? YSTRUE : YSFALSE);
+}
+
+YSSIZE_T YsShellBoundingBoxTree::GetNumNode(void) const
+{
+	return node.GetN();
+}
+
+YSSIZE_T YsShellBoundingBoxTree::GetNumPolygon(void) const
+{
+	return plg.GetN();
+}
+
+const YsShellBoundingBoxTree::Node &YsShellBoundingBoxTree::GetNode(YSSIZE_T nodeIdx) const
+{
+	return node[nodeIdx];
+}
+
+const YsShellBoundingBoxTree::Polygon &YsShellBoundingBoxTree::GetPolygon(YSSIZE_T plgIdx) const
+{
+	return plg[plgIdx];
+}
+
+const YsVec3 *YsShellBoundingBoxTree::GetPolygonVertex(YSSIZE_T plgIdx) const
+{
+	return vtxPos.GetArray()+plg[plgIdx].vtx0;
+}
+
+////////////////////////////////////////////////////////////
+
+// Bounding box of (bbxMin,bbxMax) transformed by tfm.  Conservative, but does not require eight transformations.
+static void YsShellBoundingBoxTreeTransformBbx(YsVec3 &newMin,YsVec3 &newMax,const YsMatrix4x4 &tfm,const YsVec3 &bbxMin,const YsVec3 &bbxMax)
+{
+	YsVec3 cen,ax,ay,az;
+	tfm.Mul(cen,(bbxMin+bbxMax)/2.0,1.0);
+
+	const YsVec3 hlf=(bbxMax-bbxMin)/2.0;
+	tfm.Mul(ax,YsVec3(hlf.x(),0.0,0.0),0.0);
+	tfm.Mul(ay,YsVec3(0.0,hlf.y(),0.0),0.0);
+	tfm.Mul(az,YsVec3(0.0,0.0,hlf.z()),0.0);
+
+	const YsVec3 ext(
+	    fabs(ax.x())+fabs(ay.x())+fabs(az.x()),
+	    fabs(ax.y())+fabs(ay.y())+fabs(az.y()),
+	    fabs(ax.z())+fabs(ay.z())+fabs(az.z()));
+
+	newMin=cen-ext;
+	newMax=cen+ext;
+}
+
+// Transformed polygons of tree2.  Kept per thread so that the arrays are not allocated on every call.
+// A polygon is transformed in the current call if plg2Stamp[plgIdx] equals stamp.
+class YsShellBoundingBoxTreeCollisionBuffer
+{
+public:
+	YsArray <YsVec3> plg2Vtx;
+	YsArray <YsVec3> plg2Nom,plg2BbxMin,plg2BbxMax;
+	YsArray <unsigned int> plg2Stamp;
+	unsigned int stamp;
+
+	YsShellBoundingBoxTreeCollisionBuffer()
+	{
+		stamp=0;
+	}
+	void Prepare(const YsShellBoundingBoxTree &tree2)
+	{
+		YSSIZE_T nVtx=0;
+		for(YSSIZE_T plgIdx=0; plgIdx<tree2.GetNumPolygon(); ++plgIdx)
+		{
+			nVtx+=tree2.GetPolygon(plgIdx).nVtx;
+		}
+		if(plg2Vtx.GetN()<nVtx)
+		{
+			plg2Vtx.Resize(nVtx);
+		}
+
+		const YSSIZE_T nPlg=tree2.GetNumPolygon();
+		if(plg2Stamp.GetN()<nPlg)
+		{
+			const YSSIZE_T nPrev=plg2Stamp.GetN();
+			plg2Nom.Resize(nPlg);
+			plg2BbxMin.Resize(nPlg);
+			plg2BbxMax.Resize(nPlg);
+			plg2Stamp.Resize(nPlg);
+			for(YSSIZE_T plgIdx=nPrev; plgIdx<nPlg; ++plgIdx)
+			{
+				plg2Stamp[plgIdx]=stamp;
+			}
+		}
+
+		++stamp;
+		if(0==stamp)
+		{
+			// Wrapped around.  Stamps left from the earlier calls may equal the new one.
+			for(auto &s : plg2Stamp)
+			{
+				s=0;
+			}
+			stamp=1;
+		}
+	}
+};
+
+static thread_local YsShellBoundingBoxTreeCollisionBuffer ysShellBoundingBoxTreeCollisionBuffer;
+
+YSBOOL YsCheckShellCollisionEx(
+    YsVec3 &firstFound,YsShellPolygonHandle &foundPlHd1,YsShellPolygonHandle &foundPlHd2,
+    const YsShellBoundingBoxTree &tree1,const YsMatrix4x4 &mat1,
+    const YsShellBoundingBoxTree &tree2,const YsMatrix4x4 &mat2)
+{
+	firstFound=YsOrigin();
+	foundPlHd1=NULL;
+	foundPlHd2=NULL;
+
+	if(YSTRUE==tree1.IsEmpty() || YSTRUE==tree2.IsEmpty())
+	{
+		return YSFALSE;
+	}
+
+	// Everything is tested in the coordinate system of tree1.
+	YsMatrix4x4 inv1=mat1;
+	inv1.Invert();
+	const YsMatrix4x4 rel=inv1*mat2;   // tree2 -> tree1
+	YsMatrix4x4 invRel=rel;            // tree1 -> tree2
+	invRel.Invert();
+
+	// Polygons of tree2 are transformed when they are first needed.
+	YsShellBoundingBoxTreeCollisionBuffer &buf=ysShellBoundingBoxTreeCollisionBuffer;
+	buf.Prepare(tree2);
+	YsArray <YsVec3> &plg2Vtx=buf.plg2Vtx;
+	YsArray <YsVec3> &plg2Nom=buf.plg2Nom,&plg2BbxMin=buf.plg2BbxMin,&plg2BbxMax=buf.plg2BbxMax;
+
+	YsCollisionOfPolygon wizard;
+
+	YsArray <YSSIZE_T,128> stack;
+	stack.Append(0);
+	stack.Append(0);
+	while(0<stack.GetN())
+	{
+		const YSSIZE_T nodeIdx2=stack.Last();
+		stack.DeleteLast();
+		const YSSIZE_T nodeIdx1=stack.Last();
+		stack.DeleteLast();
+
+		const YsShellBoundingBoxTree::Node &node1=tree1.GetNode(nodeIdx1);
+		const YsShellBoundingBoxTree::Node &node2=tree2.GetNode(nodeIdx2);
+
+		YsVec3 min2,max2,min1,max1;
+		YsShellBoundingBoxTreeTransformBbx(min2,max2,rel,node2.bbxMin,node2.bbxMax);
+		if(YSTRUE!=YsCheckBoundingBoxCollision3(node1.bbxMin,node1.bbxMax,min2,max2))
+		{
+			continue;
+		}
+		YsShellBoundingBoxTreeTransformBbx(min1,max1,invRel,node1.bbxMin,node1.bbxMax);
+		if(YSTRUE!=YsCheckBoundingBoxCollision3(min1,max1,node2.bbxMin,node2.bbxMax))
+		{
+			continue;
+		}
+
+		const YSBOOL isLeaf1=(0>node1.child[0] ? YSTRUE : YSFALSE);
+		const YSBOOL isLeaf2=(0>node2.child[0] ? YSTRUE : YSFALSE);
+		if(YSTRUE!=isLeaf1 &&
+		   (YSTRUE==isLeaf2 ||
+		    (node2.bbxMax-node2.bbxMin).GetSquareLength()<=(node1.bbxMax-node1.bbxMin).GetSquareLength()))
+		{
+			stack.Append(node1.child[0]);
+			stack.Append(nodeIdx2);
+			stack.Append(node1.child[1]);
+			stack.Append(nodeIdx2);
+		}
+		else if(YSTRUE!=isLeaf2)
+		{
+			stack.Append(nodeIdx1);
+			stack.Append(node2.child[0]);
+			stack.Append(nodeIdx1);
+			stack.Append(node2.child[1]);
+		}
+		else
+		{
+			for(YSSIZE_T plgIdx2=node2.plg0; plgIdx2<node2.plg0+node2.nPlg; ++plgIdx2)
+			{
+				const YsShellBoundingBoxTree::Polygon &plg2=tree2.GetPolygon(plgIdx2);
+				YsVec3 *v2=plg2Vtx.GetEditableArray()+plg2.vtx0;
+				if(buf.plg2Stamp[plgIdx2]!=buf.stamp)
+				{
+					const YsVec3 *src=tree2.GetPolygonVertex(plgIdx2);
+					YsBoundingBoxMaker3 bbx;
+					for(YSSIZE_T i=0; i<plg2.nVtx; ++i)
+					{
+						rel.Mul(v2[i],src[i],1.0);
+						bbx.Add(v2[i]);
+					}
+					bbx.Get(plg2BbxMin[plgIdx2],plg2BbxMax[plgIdx2]);
+					rel.Mul(plg2Nom[plgIdx2],plg2.nom,0.0);
+					buf.plg2Stamp[plgIdx2]=buf.stamp;
+				}
+
+				if(YSTRUE!=YsCheckBoundingBoxCollision3(node1.bbxMin,node1.bbxMax,plg2BbxMin[plgIdx2],plg2BbxMax[plgIdx2]))
+				{
+					continue;
+				}
+
+				wizard.SetPolygon2(plg2.nVtx,v2,plg2Nom[plgIdx2]);
+
+				for(YSSIZE_T plgIdx1=node1.plg0; plgIdx1<node1.plg0+node1.nPlg; ++plgIdx1)
+				{
+					const YsShellBoundingBoxTree::Polygon &plg1=tree1.GetPolygon(plgIdx1);
+					if(YSTRUE!=YsCheckBoundingBoxCollision3(plg1.bbxMin,plg1.bbxMax,plg2BbxMin[plgIdx2],plg2BbxMax[plgIdx2]))
+					{
+						continue;
+					}
+
+					wizard.SetPolygon1(plg1.nVtx,tree1.GetPolygonVertex(plgIdx1),plg1.nom);
+
+					YsVec3 found;
+					if(YSTRUE==wizard.CheckCollision(found))
+					{
+						mat1.Mul(firstFound,found,1.0);
+						foundPlHd1=plg1.plHd;
+						foundPlHd2=plg2.plHd;
+						return YSTRUE;
+					}
+				}
+			}
+		}
+	}
+
+	return YSFALSE;
+}
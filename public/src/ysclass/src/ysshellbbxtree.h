@@ -0,0 +1,104 @@
+/* ////////////////////////////////////////////////////////////
+
+File Name: ysshellbbxtree.h
+Copyright (c) 2017 Soji Yamakawa.  All rights reserved.
+http://www.ysflight.com
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, 
+   this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, 
+   this list of conditions and the following disclaimer in the documentation 
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR 
+PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) 
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+//////////////////////////////////////////////////////////// */
+
+#ifndef YSSHELLBBXTREE_IS_INCLUDED
+#define YSSHELLBBXTREE_IS_INCLUDED
+/* { */
+
+/*! Axis-aligned bounding-box tree of the polygons of a YsShell for narrow-phase collision check.
+
+    The tree is built in the coordinate system of the shell vertices.  The matrix given by YsShell::SetMatrix is ignored.
+    Two trees are tested against each other with their own transformations (see YsCheckShellCollisionEx below), 
+    therefore the shells do not have to be re-transformed when the objects move.
+
+    Vertex positions and normals are copied into the tree.  The tree does not refer to the shell after Build,
+    except the polygon handles returned by the collision check.
+*/
+class YsShellBoundingBoxTree
+{
+public:
+	enum
+	{
+		MAX_NUM_POLYGON_PER_LEAF=4
+	};
+
+	class Node
+	{
+	public:
+		YsVec3 bbxMin,bbxMax;
+		YSSIZE_T child[2];   // -1 if the node is a leaf.
+		YSSIZE_T plg0,nPlg;  // Range of polygons of a leaf node.
+	};
+
+	class Polygon
+	{
+	public:
+		YsShellPolygonHandle plHd;
+		YSSIZE_T vtx0,nVtx;  // Range in the vertex array.
+		YsVec3 nom;
+		YsVec3 bbxMin,bbxMax;
+	};
+
+private:
+	YsArray <YsVec3> vtxPos;
+	YsArray <Polygon> plg;    // Sorted so that the polygons of a leaf node are contiguous.
+	YsArray <Node> node;      // node[0] is the root.
+
+public:
+	YsShellBoundingBoxTree();
+	void CleanUp(void);
+
+	/*! Builds a tree from the polygons of the shell. */
+	YSRESULT Build(const YsShell &shl);
+
+	YSBOOL IsEmpty(void) const;
+	YSSIZE_T GetNumNode(void) const;
+	YSSIZE_T GetNumPolygon(void) const;
+	const Node &GetNode(YSSIZE_T nodeIdx) const;
+	const Polygon &GetPolygon(YSSIZE_T plgIdx) const;
+	const YsVec3 *GetPolygonVertex(YSSIZE_T plgIdx) const;
+
+private:
+	YSSIZE_T BuildNode(YsArray <YSSIZE_T> &order,YsArray <YsVec3> &center,YSSIZE_T i0,YSSIZE_T i1);
+};
+
+
+/*! Polygon-by-polygon collision check between two shells using the bounding-box trees.
+    mat1 and mat2 are the transformations of the shells (the matrices that would be given to YsShell::SetMatrix).
+    Only the relative transformation between the two is used to traverse the trees.
+    If the two collide, this function returns YSTRUE, and one of the collision points in firstFound (in the world coordinate),
+    and the polygons that collide in foundPlHd1 and foundPlHd2. */
+YSBOOL YsCheckShellCollisionEx(
+    YsVec3 &firstFound,YsShellPolygonHandle &foundPlHd1,YsShellPolygonHandle &foundPlHd2,
+    const YsShellBoundingBoxTree &tree1,const YsMatrix4x4 &mat1,
+    const YsShellBoundingBoxTree &tree2,const YsMatrix4x4 &mat2);
+
+
+/* } */
+#endif
@@ -1035,7 +1035,7 @@ YsList <YsSwordPolygon> *YsSword::ConvexnizeOnePolygon
 						todo.push_back(separated);
 						todo.push_back(separated->Next());
 						newPolygon=plgPtr->DeleteFromList();
-						newPolygon=newPolygon->Append(separated);
+						newPolygon=YsList <YsSwordPolygon>::LegacyAppend(newPolygon,separated);
 					}
 				}
 			}
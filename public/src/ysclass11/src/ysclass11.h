@@ -32,6 +32,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 /* { */
 
 #include "ysthread11.h"
+#include "ystaskscheduler.h"
 #include "ysthreadpool.h"
 #include "ysparallelmergesort.h"
 
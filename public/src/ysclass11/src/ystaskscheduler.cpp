@@ -0,0 +1,273 @@
+/* ////////////////////////////////////////////////////////////
+
+File Name: ystaskscheduler.cpp
+Copyright (c) 2017 Soji Yamakawa.  All rights reserved.
+http://www.ysflight.com
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, 
+   this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, 
+   this list of conditions and the following disclaimer in the documentation 
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR 
+PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) 
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+//////////////////////////////////////////////////////////// */
+
+#include "ystaskscheduler.h"
+
+
+
+// Scheduler and worker index of the current thread.  Other threads use the shared deque.
+static thread_local const YsTaskScheduler *ysTaskSchedulerOfThisThread=nullptr;
+static thread_local long long int ysTaskSchedulerWorkerIdxOfThisThread=-1;
+
+
+
+YsTaskScheduler::TaskGroup::TaskGroup(YsTaskScheduler &scheduler)
+{
+	schedulerPtr=&scheduler;
+	nPending=0;
+}
+
+YsTaskScheduler::TaskGroup::~TaskGroup()
+{
+	Wait();
+}
+
+void YsTaskScheduler::TaskGroup::Run(std::function <void()> func)
+{
+	++nPending;
+
+	Task task;
+	task.func=(std::function <void()> &&)func;
+	task.group=this;
+	schedulerPtr->Push((Task &&)task);
+}
+
+void YsTaskScheduler::TaskGroup::Wait(void)
+{
+	const long long int workerIdx=schedulerPtr->GetCurrentWorkerIndex();
+	for(;;)
+	{
+		if(0==nPending)
+		{
+			// RunTask decrements nPending while holding doneMutex.  Taking the lock here makes sure
+			// the last task is not touching this group any more when the group is destroyed.
+			std::lock_guard <std::mutex> lock(doneMutex);
+			return;
+		}
+
+		Task task;
+		if(true==schedulerPtr->Pop(task,workerIdx))
+		{
+			RunTask(task);
+			continue;
+		}
+
+		// Nothing is queued.  Remaining tasks of this group are running in the other threads.
+		// Tasks that they spawn are taken care of by them.
+		std::unique_lock <std::mutex> lock(doneMutex);
+		while(0<nPending)
+		{
+			doneWait.wait(lock);
+		}
+		return;
+	}
+}
+
+
+
+/* static */ void YsTaskScheduler::ThreadEntry(YsTaskScheduler *scheduler,long long int workerIdx)
+{
+	scheduler->ThreadFunc(workerIdx);
+}
+
+void YsTaskScheduler::ThreadFunc(long long int workerIdx)
+{
+	ysTaskSchedulerOfThisThread=this;
+	ysTaskSchedulerWorkerIdxOfThisThread=workerIdx;
+
+	for(;;)
+	{
+		Task task;
+		if(true==Pop(task,workerIdx))
+		{
+			RunTask(task);
+			continue;
+		}
+
+		// Push increments nQueued while holding sleepMutex.  Therefore, the notification cannot come
+		// between checking nQueued and starting to wait.
+		std::unique_lock <std::mutex> lock(sleepMutex);
+		while(true!=bailOut && nQueued<=0)
+		{
+			sleepWait.wait(lock);
+		}
+		if(true==bailOut && nQueued<=0)
+		{
+			break;
+		}
+	}
+
+	ysTaskSchedulerOfThisThread=nullptr;
+	ysTaskSchedulerWorkerIdxOfThisThread=-1;
+}
+
+long long int YsTaskScheduler::GetCurrentWorkerIndex(void) const
+{
+	if(this==ysTaskSchedulerOfThisThread)
+	{
+		return ysTaskSchedulerWorkerIdxOfThisThread;
+	}
+	return nThread;
+}
+
+void YsTaskScheduler::Push(Task &&task)
+{
+	auto &worker=workerArray[GetCurrentWorkerIndex()];
+	{
+		std::lock_guard <std::mutex> lock(worker.dequeMutex);
+		worker.deque.push_back((Task &&)task);
+	}
+	{
+		std::lock_guard <std::mutex> lock(sleepMutex);
+		++nQueued;
+	}
+	sleepWait.notify_one();
+}
+
+bool YsTaskScheduler::Pop(Task &task,long long int workerIdx)
+{
+	// Own deque from the back.  The newest task is the most likely to be in the cache.
+	{
+		auto &worker=workerArray[workerIdx];
+		std::lock_guard <std::mutex> lock(worker.dequeMutex);
+		if(0<worker.deque.size())
+		{
+			task=(Task &&)worker.deque.back();
+			worker.deque.pop_back();
+			--nQueued;
+			return true;
+		}
+	}
+
+	// Steal from the front of the other deques.  The oldest task is likely to be the largest.
+	if(0<nQueued)
+	{
+		for(long long int i=1; i<=nThread; ++i)
+		{
+			auto &victim=workerArray[(workerIdx+i)%(nThread+1)];
+			std::lock_guard <std::mutex> lock(victim.dequeMutex);
+			if(0<victim.deque.size())
+			{
+				task=(Task &&)victim.deque.front();
+				victim.deque.pop_front();
+				--nQueued;
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+/* static */ void YsTaskScheduler::RunTask(Task &task)
+{
+	task.func();
+
+	auto group=task.group;
+	std::lock_guard <std::mutex> lock(group->doneMutex);
+	if(0==--group->nPending)
+	{
+		group->doneWait.notify_all();
+	}
+}
+
+
+
+////////////////////////////////////////////////////////////
+
+
+
+YsTaskScheduler::YsTaskScheduler(int nThread)
+{
+	if(nThread<0)
+	{
+		nThread=0;
+	}
+	this->nThread=nThread;
+	this->nQueued=0;
+	this->bailOut=false;
+	workerArray=new Worker [nThread+1];
+
+	for(long long int idx=0; idx<nThread; ++idx)
+	{
+		std::thread t(ThreadEntry,this,idx);
+		workerArray[idx].t.swap(t);
+	}
+}
+
+YsTaskScheduler::~YsTaskScheduler()
+{
+	{
+		std::lock_guard <std::mutex> lock(sleepMutex);
+		bailOut=true;
+	}
+	sleepWait.notify_all();
+
+	for(long long int idx=0; idx<nThread; ++idx)
+	{
+		workerArray[idx].t.join();
+	}
+
+	delete [] workerArray;
+}
+
+long long int YsTaskScheduler::GetN(void) const
+{
+	return nThread;
+}
+
+long long int YsTaskScheduler::GetConcurrency(void) const
+{
+	return nThread+1;
+}
+
+void YsTaskScheduler::ParallelFor(long long int i0,long long int i1,long long int grainSize,const std::function <void(long long int,long long int)> &func)
+{
+	if(grainSize<1)
+	{
+		grainSize=1;
+	}
+	if(i1-i0<=grainSize || 0==nThread)
+	{
+		if(i0<i1)
+		{
+			func(i0,i1);
+		}
+		return;
+	}
+
+	// The other half is queued for the other threads to steal, and this thread goes on with the first half.
+	const long long int iMid=i0+(i1-i0)/2;
+	TaskGroup group(*this);
+	group.Run([this,iMid,i1,grainSize,&func]()
+	{
+		ParallelFor(iMid,i1,grainSize,func);
+	});
+	ParallelFor(i0,iMid,grainSize,func);
+	group.Wait();
+}
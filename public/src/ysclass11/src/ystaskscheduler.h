@@ -0,0 +1,147 @@
+/* ////////////////////////////////////////////////////////////
+
+File Name: ystaskscheduler.h
+Copyright (c) 2017 Soji Yamakawa.  All rights reserved.
+http://www.ysflight.com
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+//////////////////////////////////////////////////////////// */
+
+#ifndef YSTASKSCHEDULER_IS_INCLUDED
+#define YSTASKSCHEDULER_IS_INCLUDED
+/* { */
+
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <condition_variable>
+
+/*! Work-stealing task scheduler.
+
+    Each worker thread has its own deque.  A worker pushes and pops its own tasks at the back, and
+    steals from the front of the other deques when its own deque is empty.  Threads that are not
+    workers of the scheduler share one extra deque.
+
+    Tasks are submitted through a TaskGroup.  TaskGroup::Wait does not just block.  The waiting
+    thread runs queued tasks (of any group) until all tasks of the group are done.  Therefore a task
+    can create a TaskGroup, or call ParallelFor, inside, and wait for it without a dead lock.
+
+    Usage:
+        YsTaskScheduler scheduler(4);
+
+        YsTaskScheduler::TaskGroup group(scheduler);
+        group.Run([&](){...});
+        group.Run([&](){...});
+        group.Wait();
+
+        scheduler.ParallelFor(0,n,64,[&](long long int i0,long long int i1){...});
+*/
+class YsTaskScheduler
+{
+public:
+	class TaskGroup;
+
+private:
+	class Task
+	{
+	public:
+		std::function <void()> func;
+		TaskGroup *group;
+	};
+
+	class Worker
+	{
+	public:
+		std::mutex dequeMutex;
+		std::deque <Task> deque;
+		std::thread t;
+	};
+
+public:
+	/*! A set of tasks that can be waited together. */
+	class TaskGroup
+	{
+	friend class YsTaskScheduler;
+	private:
+		YsTaskScheduler *schedulerPtr;
+		std::atomic <long long int> nPending;
+		std::mutex doneMutex;
+		std::condition_variable doneWait;
+
+		TaskGroup(const TaskGroup &);
+		TaskGroup &operator=(const TaskGroup &);
+
+	public:
+		TaskGroup(YsTaskScheduler &scheduler);
+
+		/*! The destructor waits for the remaining tasks. */
+		~TaskGroup();
+
+		/*! Queues a task. */
+		void Run(std::function <void()> func);
+
+		/*! Returns when all the tasks of this group are done.  The calling thread runs queued tasks while waiting. */
+		void Wait(void);
+	};
+
+private:
+	long long int nThread;
+	Worker *workerArray;        // nThread workers and one shared deque for the other threads.
+	std::atomic <long long int> nQueued;
+	std::mutex sleepMutex;
+	std::condition_variable sleepWait;
+	bool bailOut;
+
+	YsTaskScheduler(const YsTaskScheduler &);
+	YsTaskScheduler &operator=(const YsTaskScheduler &);
+
+	static void ThreadEntry(YsTaskScheduler *scheduler,long long int workerIdx);
+	void ThreadFunc(long long int workerIdx);
+
+	long long int GetCurrentWorkerIndex(void) const;
+	void Push(Task &&task);
+	bool Pop(Task &task,long long int workerIdx);
+	static void RunTask(Task &task);
+
+public:
+	/*! Starts nThread worker threads.  With nThread=0, tasks run in the thread that waits for them. */
+	YsTaskScheduler(int nThread=4);
+	~YsTaskScheduler();
+
+	/*! Returns the number of worker threads. */
+	long long int GetN(void) const;
+
+	/*! Returns the number of threads that may run tasks at the same time, which is the worker threads
+	    plus the thread that waits. */
+	long long int GetConcurrency(void) const;
+
+	/*! Calls func(j0,j1) for sub-ranges of [i0,i1) in parallel, and returns when all are done.
+	    The range is split in half until the sub-range is not longer than grainSize.
+	    Can be called from inside of a task. */
+	void ParallelFor(long long int i0,long long int i1,long long int grainSize,const std::function <void(long long int,long long int)> &func);
+};
+
+/* } */
+#endif
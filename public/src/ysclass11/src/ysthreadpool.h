@@ -32,58 +32,23 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 /* { */
 
 #include <vector>
-#include <thread>
-#include <mutex>
 #include <functional>
-#include <condition_variable>
+#include "ystaskscheduler.h"
 
-class YsThreadPool
-{
-public:
-	class SubThread
-	{
-	public:
-		int threadIdx;
-
-		std::thread t;
-
-		std::mutex taskMutex;
-		std::condition_variable taskWait;
-		// taskLock owned by the sub thread.
-		// The main thread will notify.
-
-		std::mutex readyMutex;
-		std::condition_variable readyWait;
-		std::unique_lock <std::mutex> *readyLock;
-		// readyWait owned by the main thread.
-		// The sub thread will notify.
-
-		YsThreadPool *threadPoolPtr;
-		bool bailOut,ready,mustStart;
+/*! Fork/join interface on top of YsTaskScheduler.
 
-		SubThread();
-		void ThreadFunc(void);
-	};
-
-private:
-	friend class SubThread;
-	std::mutex taskMutex;
-	int nTask,nTaskDone;
-	const std::function <void()> *taskArray;
+    The thread that calls Run runs the tasks together with the pooled threads.  Therefore the pool keeps
+    nThread-1 worker threads so that nThread tasks run at the same time.
 
+    Run may be called from the inside of a task running from the same pool.  The calling task helps
+    running the nested tasks instead of blocking the pool.  Work that needs finer-grain or nested parallelism
+    can use GetScheduler() directly.
+*/
+class YsThreadPool
+{
 private:
-	// This thread pool may be shared from multiple objects, and may even be
-	// used from the inside of a task running from this thread pool.
-	// In that case, further branching the threads will only make CPU traffic jam,
-	// and also destroys the integrity of the pool.
-	// Therefore, this thread pool should not be used while the pooled threads are
-	// already running.
-	std::mutex preventRecursiveUse;
-
 	long long int nThread;
-	SubThread *threadArray;
-
-	static void ThreadEntry(SubThread *subThread);
+	YsTaskScheduler scheduler;
 
 public:
 	YsThreadPool(int nThread=4);
@@ -98,6 +63,9 @@ public:
 
 	/*! Returns the number of threads in the pool. */
 	long long int size(void) const;
+
+	/*! Returns the scheduler that runs the tasks. */
+	YsTaskScheduler &GetScheduler(void);
 };
 
 /* } */
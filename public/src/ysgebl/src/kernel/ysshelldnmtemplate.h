@@ -227,6 +227,11 @@ public:
 	/*! Default destructor. */
 	~YsShellDnmContainer();
 
+	/*! Builds the static key-word table used by the DNM reader.
+	    The table is otherwise built on the first read.  Call this function from the main thread
+	    before DNMs are read in more than one thread at the same time. */
+	static void PrepareKeyWordList(void);
+
 	/*! Returns the bounding box. */
 	void GetBoundingBox(YsVec3 bbx[2]) const;
 
@@ -1259,14 +1264,20 @@ template <class SHLCLASS,class NODESTATE_EXTRA_INFO>
 YsKeyWordList YsShellDnmContainer<SHLCLASS,NODESTATE_EXTRA_INFO>::keyWordList;
 
 template <class SHLCLASS,class NODESTATE_EXTRA_INFO>
-YSRESULT YsShellDnmContainer<SHLCLASS,NODESTATE_EXTRA_INFO>::ReadDnmOneLine(ReadDnmVariable &var,const YsString &str)
+/* static */ void YsShellDnmContainer<SHLCLASS,NODESTATE_EXTRA_INFO>::PrepareKeyWordList(void)
 {
-	YsArray <YsString,16> av;
-
 	if(keyWordList.GetN()==0)
 	{
 		keyWordList.MakeList(keyWordSource);
 	}
+}
+
+template <class SHLCLASS,class NODESTATE_EXTRA_INFO>
+YSRESULT YsShellDnmContainer<SHLCLASS,NODESTATE_EXTRA_INFO>::ReadDnmOneLine(ReadDnmVariable &var,const YsString &str)
+{
+	YsArray <YsString,16> av;
+
+	PrepareKeyWordList();
 
 	if(var.readState==ReadDnmVariable::READSTATE_PACKEDFILE/*99*/)
 	{
@@ -623,6 +623,8 @@ void YsShellExt::MoveFrom(YsShellExt &from)
 
 	this->vtx.MoveFrom(from.vtx);
 	this->plg.MoveFrom(from.plg);
+	++this->shapeModificationCounter;
+	++from.shapeModificationCounter;
 	YsHasTextMetaData::MoveFrom(from);
 	this->constEdgeArray.MoveFrom(from.constEdgeArray);
 	this->faceGroupArray.MoveFrom(from.faceGroupArray);
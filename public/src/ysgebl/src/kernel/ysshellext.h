@@ -52,6 +52,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 	- using YsShell::ComputeDihedralAngle;
 	- using YsShell::GetNumVertex;
 	- using YsShell::GetNumPolygon;
+	- using YsShell::GetShapeModificationCounter;
 	- using YsShell::GetBoundingBox;
 	- using YsShell::GetBoundingBoxDiagonalLength;
 	- using YsShell::GetBoundingBoxCenter;
@@ -130,6 +131,7 @@ public:
 	using YsShell::ComputeDihedralAngle;
 	using YsShell::GetNumVertex;
 	using YsShell::GetNumPolygon;
+	using YsShell::GetShapeModificationCounter;
 	using YsShell::GetBoundingBox;
 	using YsShell::GetBoundingBoxDiagonalLength;
 	using YsShell::GetBoundingBoxCenter;
@@ -120,6 +120,21 @@ void YsShellExtVboSet::CleanUp(void)
 
 ////////////////////////////////////////////////////////////
 
+YsHasShellExtVboSet::YsHasShellExtVboSet()
+{
+	polygonBufferCached=YSFALSE;
+}
+
+void YsHasShellExtVboSet::SetPolygonBufferCached(YSBOOL cached)
+{
+	polygonBufferCached=cached;
+}
+
+YSBOOL YsHasShellExtVboSet::IsPolygonBufferCached(void) const
+{
+	return polygonBufferCached;
+}
+
 YsShellExtVboSet &YsHasShellExtVboSet::GetVboSet(void)
 {
 	return vboSet;
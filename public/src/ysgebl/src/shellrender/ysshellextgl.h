@@ -84,8 +84,18 @@ class YsHasShellExtVboSet
 {
 protected:
 	mutable YsShellExtVboSet vboSet;
+	YSBOOL polygonBufferCached;
 
 public:
+	YsHasShellExtVboSet();
+
+	/*! Tells that the polygon part of the drawing buffer, which RemakePolygonVbo and RemakePlainPolygonVbo use,
+	    has been filled in advance (for example by YsVisualCache) and does not have to be re-made before the first VBO is made.
+	    It must be reset when the shell is cleaned up or overwritten.
+	*/
+	void SetPolygonBufferCached(YSBOOL cached);
+	YSBOOL IsPolygonBufferCached(void) const;
+
 	/*! In most cases, a YsShellExtWithVbo can own a vboSet.  
 	    However, there are some exceptions.  
 	    For example, a VASI or a PAPI looks differently depending on from which direction the object is seen.
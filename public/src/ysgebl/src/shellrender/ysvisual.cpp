@@ -56,6 +56,7 @@ YsVisualSrf::YsVisualSrf(const YsVisualSrf &incoming)
 YsVisualSrf &YsVisualSrf::operator=(const YsVisualSrf &incoming)
 {
 	vboSet.CleanUp();
+	SetPolygonBufferCached(YSFALSE);
 	YsShellExt::CopyFrom(incoming);
 	return *this;
 }
@@ -63,6 +64,7 @@ YsVisualSrf &YsVisualSrf::operator=(const YsVisualSrf &incoming)
 void YsVisualSrf::CleanUp(void)
 {
 	vboSet.CleanUp();
+	SetPolygonBufferCached(YSFALSE);
 	YsShellExt::CleanUp();
 }
 
@@ -91,7 +93,10 @@ void YsVisualSrf::Draw(const YsMatrix4x4 &modelView,unsigned int drawFlag) const
 {
 	if(YSTRUE!=this->IsPolygonVboPrepared())
 	{
-		this->GetDrawingBuffer().RemakePolygonBuffer(*this,0.8);
+		if(YSTRUE!=this->IsPolygonBufferCached())
+		{
+			this->GetDrawingBuffer().RemakePolygonBuffer(*this,0.8);
+		}
 		this->RemakePolygonVbo(this->vboSet,this->GetDrawingBuffer());
 	}
 
@@ -128,7 +133,10 @@ void YsVisualSrf::Draw(
 	{
 		if(YSTRUE!=this->IsPolygonVboPrepared())
 		{
-			this->GetDrawingBuffer().RemakePolygonBuffer(*this,0.8);
+			if(YSTRUE!=this->IsPolygonBufferCached())
+			{
+				this->GetDrawingBuffer().RemakePolygonBuffer(*this,0.8);
+			}
 			this->RemakePolygonVbo(this->vboSet,this->GetDrawingBuffer());
 		}
 
@@ -153,7 +161,10 @@ void YsVisualSrf::DrawShadow(
 {
 	if(YSTRUE!=this->IsPlainPolygonVboPrepared())
 	{
-		this->GetDrawingBuffer().RemakePolygonBuffer(*this,0.8);
+		if(YSTRUE!=this->IsPolygonBufferCached())
+		{
+			this->GetDrawingBuffer().RemakePolygonBuffer(*this,0.8);
+		}
 		this->RemakePlainPolygonVbo(this->vboSet,this->GetDrawingBuffer());
 	}
 
@@ -228,6 +239,11 @@ YSRESULT YsVisualDnm::Load(YsTextInputStream &inStream,const char fn[])
 	return YSOK;
 }
 
+/* static */ void YsVisualDnm::PrepareMultiThreadLoad(void)
+{
+	Dnm::PrepareKeyWordList();
+}
+
 void YsVisualDnm::CleanUp(void)
 {
 	if(dnmPtr)
@@ -454,7 +470,10 @@ void YsVisualDnm::Draw(const YsMatrix4x4 &tfm,Dnm::Node *nodePtr,unsigned int dr
 	{
 		if(YSTRUE!=nodePtr->IsPolygonVboPrepared())
 		{
-			nodePtr->GetDrawingBuffer().RemakePolygonBuffer(*nodePtr,0.8);
+			if(YSTRUE!=nodePtr->IsPolygonBufferCached())
+			{
+				nodePtr->GetDrawingBuffer().RemakePolygonBuffer(*nodePtr,0.8);
+			}
 			nodePtr->RemakePolygonVbo(nodePtr->GetVboSet(),nodePtr->GetDrawingBuffer());
 		}
 
@@ -533,7 +552,10 @@ void YsVisualDnm::Draw(
 
 			if(YSTRUE!=nodePtr->IsPolygonVboPrepared())
 			{
-				nodePtr->GetDrawingBuffer().RemakePolygonBuffer(*nodePtr,0.8);
+				if(YSTRUE!=nodePtr->IsPolygonBufferCached())
+				{
+					nodePtr->GetDrawingBuffer().RemakePolygonBuffer(*nodePtr,0.8);
+				}
 				nodePtr->RemakePolygonVbo(nodePtr->GetVboSet(),nodePtr->GetDrawingBuffer());
 			}
 
@@ -588,7 +610,10 @@ void YsVisualDnm::DrawShadow(
 		{
 			if(YSTRUE!=nodePtr->IsPlainPolygonVboPrepared())
 			{
-				nodePtr->GetDrawingBuffer().RemakePolygonBuffer(*nodePtr,0.8);
+				if(YSTRUE!=nodePtr->IsPolygonBufferCached())
+				{
+					nodePtr->GetDrawingBuffer().RemakePolygonBuffer(*nodePtr,0.8);
+				}
 				nodePtr->RemakePlainPolygonVbo(nodePtr->GetVboSet(),nodePtr->GetDrawingBuffer());
 			}
 
@@ -116,6 +116,8 @@ public:
 
 class YsVisualDnm : public YsVisual
 {
+	friend class YsVisualCache;
+
 protected:
 	typedef YsShellExtWithVbo <YsShellExt> Shell;
 	typedef YsShellDnmContainer<Shell> Dnm;
@@ -147,6 +149,10 @@ public:
 
 	YSRESULT Load(YsTextInputStream &inStream,const char fn[]);
 
+	/*! Prepares static tables used by Load so that DNMs can be loaded from worker threads.
+	    Must be called from the main thread before the first multi-threaded load. */
+	static void PrepareMultiThreadLoad(void);
+
 	void GetBoundingBox(YsVec3 bbx[2]) const;
 	void GetBoundingBox(YsVec3 &bbx0,YsVec3 &bbx1) const;
 
@@ -0,0 +1,824 @@
+/* ////////////////////////////////////////////////////////////
+
+File Name: ysvisualcache.cpp
+Copyright (c) 2017 Soji Yamakawa.  All rights reserved.
+http://www.ysflight.com
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, 
+   this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, 
+   this list of conditions and the following disclaimer in the documentation 
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR 
+PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) 
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+//////////////////////////////////////////////////////////// */
+
+
+#include <string.h>
+#include <atomic>
+#include <chrono>
+
+#include <ysclass.h>
+#include <ysport.h>
+
+#include "ysvisualcache.h"
+
+
+
+static const char ysVisualCacheMagic[8]={'Y','S','V','I','S','C','A','C'};
+
+// Bytes per element of each ARRAYTYPE.
+static const unsigned long long ysVisualCacheElemSize[YsVisualCache::NUM_ARRAYTYPE]=
+{
+	sizeof(char),                          // ARRAY_NODENAME
+	sizeof(YsVisualCache::NodeState),      // ARRAY_NODESTATE
+	sizeof(double)*3,                      // ARRAY_VTXPOS
+	sizeof(YsVisualCache::VertexAttrib),   // ARRAY_VTXATTRIB
+	sizeof(unsigned int),                  // ARRAY_PLGVTXTOP
+	sizeof(unsigned int),                  // ARRAY_PLGVTXIDX
+	sizeof(YsVisualCache::PolygonAttrib),  // ARRAY_PLGATTRIB
+	sizeof(YSGLFLOAT)*3,                   // ARRAY_NORMALEDGE_VTX
+	sizeof(YSGLFLOAT)*3,                   // ARRAY_SHRUNKEDGE_VTX
+	sizeof(YSGLFLOAT)*3,                   // ARRAY_SOLIDSHADED_VTX
+	sizeof(YSGLFLOAT)*3,                   // ARRAY_SOLIDSHADED_NOM
+	sizeof(YSGLFLOAT)*4,                   // ARRAY_SOLIDSHADED_COL
+	sizeof(YSGLFLOAT)*3,                   // ARRAY_SOLIDUNSHADED_VTX
+	sizeof(YSGLFLOAT)*4,                   // ARRAY_SOLIDUNSHADED_COL
+	sizeof(YSGLFLOAT)*3,                   // ARRAY_TRSPSHADED_VTX
+	sizeof(YSGLFLOAT)*3,                   // ARRAY_TRSPSHADED_NOM
+	sizeof(YSGLFLOAT)*4,                   // ARRAY_TRSPSHADED_COL
+	sizeof(YSGLFLOAT)*3,                   // ARRAY_TRSPUNSHADED_VTX
+	sizeof(YSGLFLOAT)*4,                   // ARRAY_TRSPUNSHADED_COL
+	sizeof(YSGLFLOAT)*3,                   // ARRAY_BACKFACE_VTX
+	sizeof(YSGLFLOAT)*4,                   // ARRAY_BACKFACE_COL
+	sizeof(YSGLFLOAT)*3,                   // ARRAY_LIGHT_VTX
+	sizeof(YSGLFLOAT)*4,                   // ARRAY_LIGHT_COL
+	sizeof(YSGLFLOAT),                     // ARRAY_LIGHT_SIZE
+};
+
+// Pairs of arrays that must have the same number of elements.
+static const YsVisualCache::ARRAYTYPE ysVisualCacheSameLength[][2]=
+{
+	{YsVisualCache::ARRAY_VTXPOS,           YsVisualCache::ARRAY_VTXATTRIB},
+	{YsVisualCache::ARRAY_SOLIDSHADED_VTX,  YsVisualCache::ARRAY_SOLIDSHADED_NOM},
+	{YsVisualCache::ARRAY_SOLIDSHADED_VTX,  YsVisualCache::ARRAY_SOLIDSHADED_COL},
+	{YsVisualCache::ARRAY_SOLIDUNSHADED_VTX,YsVisualCache::ARRAY_SOLIDUNSHADED_COL},
+	{YsVisualCache::ARRAY_TRSPSHADED_VTX,   YsVisualCache::ARRAY_TRSPSHADED_NOM},
+	{YsVisualCache::ARRAY_TRSPSHADED_VTX,   YsVisualCache::ARRAY_TRSPSHADED_COL},
+	{YsVisualCache::ARRAY_TRSPUNSHADED_VTX, YsVisualCache::ARRAY_TRSPUNSHADED_COL},
+	{YsVisualCache::ARRAY_BACKFACE_VTX,     YsVisualCache::ARRAY_BACKFACE_COL},
+	{YsVisualCache::ARRAY_LIGHT_VTX,        YsVisualCache::ARRAY_LIGHT_COL},
+	{YsVisualCache::ARRAY_LIGHT_VTX,        YsVisualCache::ARRAY_LIGHT_SIZE},
+};
+
+static unsigned long long YsVisualCache_Align(unsigned long long offset)
+{
+	return (offset+7)&~(unsigned long long)7;
+}
+
+static void YsVisualCache_SetVec3(double dst[3],const YsVec3 &src)
+{
+	dst[0]=src.x();
+	dst[1]=src.y();
+	dst[2]=src.z();
+}
+
+static void YsVisualCache_SetAtt3(double dst[3],const YsAtt3 &src)
+{
+	dst[0]=src.h();
+	dst[1]=src.p();
+	dst[2]=src.b();
+}
+
+
+
+////////////////////////////////////////////////////////////
+
+
+
+/*! Writes to a temporary file in the same directory as the cache, and renames it to the cache file in Close.
+    Other threads and processes never see an incomplete cache, and an old cache is not lost when writing fails.
+    The temporary file is deleted if Close fails or is not called. */
+class YsVisualCache::Writer
+{
+private:
+	FILE *fp;
+	unsigned long long filePtr;
+	YSBOOL writeError;
+	YsWString fn,tmpFn;
+
+public:
+	Writer();
+	~Writer();
+
+	YSRESULT Open(const wchar_t fn[]);
+
+	/*! Re-writes the header at the top of the file, closes the file, and replaces the cache file. */
+	YSRESULT Close(const FileHeader &hd);
+
+	unsigned long long GetFilePointer(void) const;
+	void Write(unsigned long long nByte,const void *dat);
+	void Align(void);
+
+	template <class T>
+	ArrayInfo WriteArray(YSSIZE_T n,const T dat[]);
+	template <class T,const int D>
+	ArrayInfo WriteBuffer(const YsGLBufferTemplate <T,D> &buf);
+};
+
+YsVisualCache::Writer::Writer()
+{
+	fp=nullptr;
+	filePtr=0;
+	writeError=YSFALSE;
+}
+
+YsVisualCache::Writer::~Writer()
+{
+	if(nullptr!=fp)
+	{
+		fclose(fp);
+		YsFileIO::Remove(tmpFn);
+	}
+}
+
+YSRESULT YsVisualCache::Writer::Open(const wchar_t fn[])
+{
+	this->fn=fn;
+
+	// The name must not collide with another thread or process writing the same cache.  "x" fails if the file exists.
+	static std::atomic <unsigned int> counter(0);
+	const unsigned long long clk=(unsigned long long)std::chrono::high_resolution_clock::now().time_since_epoch().count();
+	for(int trial=0; trial<8 && nullptr==fp; ++trial)
+	{
+		YsString suffix;
+		YsWString wSuffix;
+		suffix.Printf(".%llx.%x.%x.tmp",clk,(unsigned int)(((unsigned long long)(size_t)this)>>4),counter++);
+		wSuffix.SetUTF8String(suffix);
+		tmpFn=fn;
+		tmpFn.Append(wSuffix);
+		fp=YsFileIO::Fopen(tmpFn,"wbx");
+	}
+	if(nullptr==fp)
+	{
+		return YSERR;
+	}
+
+	// Placeholder.  Re-written in Close.  A file left incomplete does not have the magic.
+	FileHeader hd;
+	memset(&hd,0,sizeof(hd));
+	Write(sizeof(hd),&hd);
+
+	return (YSTRUE!=writeError ? YSOK : YSERR);
+}
+
+YSRESULT YsVisualCache::Writer::Close(const FileHeader &hd)
+{
+	if(nullptr==fp)
+	{
+		return YSERR;
+	}
+
+	fseek(fp,0,SEEK_SET);
+	Write(sizeof(hd),&hd);
+
+	if(0!=fclose(fp))
+	{
+		writeError=YSTRUE;
+	}
+	fp=nullptr;
+
+	if(YSTRUE==writeError || YSOK!=YsFileIO::Rename(tmpFn,fn))
+	{
+		YsFileIO::Remove(tmpFn);
+		return YSERR;
+	}
+	return YSOK;
+}
+
+unsigned long long YsVisualCache::Writer::GetFilePointer(void) const
+{
+	return filePtr;
+}
+
+void YsVisualCache::Writer::Write(unsigned long long nByte,const void *dat)
+{
+	if(0<nByte && nByte!=(unsigned long long)fwrite(dat,1,(size_t)nByte,fp))
+	{
+		writeError=YSTRUE;
+	}
+	filePtr+=nByte;
+}
+
+void YsVisualCache::Writer::Align(void)
+{
+	const unsigned char zero[8]={0,0,0,0,0,0,0,0};
+	Write(YsVisualCache_Align(filePtr)-filePtr,zero);
+}
+
+template <class T>
+YsVisualCache::ArrayInfo YsVisualCache::Writer::WriteArray(YSSIZE_T n,const T dat[])
+{
+	Align();
+
+	ArrayInfo info;
+	info.offset=filePtr;
+	info.nByte=sizeof(T)*n;
+	Write(info.nByte,dat);
+	return info;
+}
+
+template <class T,const int D>
+YsVisualCache::ArrayInfo YsVisualCache::Writer::WriteBuffer(const YsGLBufferTemplate <T,D> &buf)
+{
+	return WriteArray(buf.GetN()*D,buf.GetArrayPointer());
+}
+
+
+
+////////////////////////////////////////////////////////////
+
+
+
+class YsVisualCache::Reader
+{
+public:
+	YsFileIO::MappedFile file;
+	const FileHeader *hd;
+	const NodeHeader *nodeTable;
+
+	Reader();
+
+	/*! Maps the file and checks the header, the source file, and all the arrays. */
+	YSRESULT Open(const wchar_t fn[],const SourceInfo &src,MODELTYPE modelType);
+
+	YSSIZE_T GetN(YSSIZE_T nodeIdx,ARRAYTYPE arrayType) const;
+	template <class T>
+	const T *GetArray(YSSIZE_T nodeIdx,ARRAYTYPE arrayType) const;
+	template <class T,const int D>
+	void LoadBuffer(YsGLBufferTemplate <T,D> &buf,YSSIZE_T nodeIdx,ARRAYTYPE arrayType) const;
+
+	YSRESULT LoadShell(Shell &shl,YSSIZE_T nodeIdx) const;
+
+private:
+	YSRESULT CheckNode(YSSIZE_T nodeIdx) const;
+};
+
+YsVisualCache::Reader::Reader()
+{
+	hd=nullptr;
+	nodeTable=nullptr;
+}
+
+YSRESULT YsVisualCache::Reader::Open(const wchar_t fn[],const SourceInfo &src,MODELTYPE modelType)
+{
+	if(YSOK!=file.Open(fn) || file.size()<(long long int)sizeof(FileHeader))
+	{
+		return YSERR;
+	}
+
+	const unsigned long long fileSize=file.size();
+	hd=(const FileHeader *)file.data();
+	if(0!=memcmp(hd->magic,ysVisualCacheMagic,sizeof(hd->magic)) ||
+	   FILE_VERSION!=hd->version ||
+	   BYTE_ORDER_MARK!=hd->byteOrderMark ||
+	   (unsigned int)modelType!=hd->modelType ||
+	   src.size!=hd->srcSize ||
+	   src.modifiedTime!=hd->srcModifiedTime)
+	{
+		return YSERR;
+	}
+
+	YsString srcFnUTF8;
+	srcFnUTF8.EncodeUTF8 <wchar_t> (src.fn);
+	if((unsigned long long)srcFnUTF8.Strlen()!=hd->srcFnLength ||
+	   fileSize<sizeof(FileHeader)+hd->srcFnLength ||
+	   0!=memcmp(file.data()+sizeof(FileHeader),srcFnUTF8.Txt(),(size_t)hd->srcFnLength))
+	{
+		return YSERR;
+	}
+
+	if(0==hd->nNode ||
+	   (MODEL_SRF==modelType && 1!=hd->nNode) ||
+	   hd->nodeTableOffset!=YsVisualCache_Align(hd->nodeTableOffset) ||
+	   fileSize<hd->nodeTableOffset ||
+	   (fileSize-hd->nodeTableOffset)/sizeof(NodeHeader)<hd->nNode)
+	{
+		return YSERR;
+	}
+	nodeTable=(const NodeHeader *)(file.data()+hd->nodeTableOffset);
+
+	for(YSSIZE_T nodeIdx=0; nodeIdx<(YSSIZE_T)hd->nNode; ++nodeIdx)
+	{
+		if(YSOK!=CheckNode(nodeIdx))
+		{
+			return YSERR;
+		}
+	}
+	return YSOK;
+}
+
+YSRESULT YsVisualCache::Reader::CheckNode(YSSIZE_T nodeIdx) const
+{
+	auto &node=nodeTable[nodeIdx];
+
+	// Parent always comes before the child.
+	if(node.parent<-1 || nodeIdx<=node.parent)
+	{
+		return YSERR;
+	}
+
+	for(int arrayType=0; arrayType<NUM_ARRAYTYPE; ++arrayType)
+	{
+		auto &info=node.array[arrayType];
+		if(info.offset!=YsVisualCache_Align(info.offset) ||
+		   info.offset<sizeof(FileHeader) ||
+		   hd->nodeTableOffset<info.offset ||
+		   hd->nodeTableOffset-info.offset<info.nByte ||
+		   0!=info.nByte%ysVisualCacheElemSize[arrayType])
+		{
+			return YSERR;
+		}
+	}
+	for(auto &pair : ysVisualCacheSameLength)
+	{
+		if(GetN(nodeIdx,pair[0])!=GetN(nodeIdx,pair[1]))
+		{
+			return YSERR;
+		}
+	}
+
+	const YSSIZE_T nVtx=GetN(nodeIdx,ARRAY_VTXPOS);
+	const YSSIZE_T nPlg=GetN(nodeIdx,ARRAY_PLGATTRIB);
+	const YSSIZE_T nPlVtIdx=GetN(nodeIdx,ARRAY_PLGVTXIDX);
+	if(nPlg+1!=GetN(nodeIdx,ARRAY_PLGVTXTOP))
+	{
+		return YSERR;
+	}
+
+	auto plVtTop=GetArray<unsigned int>(nodeIdx,ARRAY_PLGVTXTOP);
+	if(0!=plVtTop[0] || nPlVtIdx!=(YSSIZE_T)plVtTop[nPlg])
+	{
+		return YSERR;
+	}
+	for(YSSIZE_T plIdx=0; plIdx<nPlg; ++plIdx)
+	{
+		if(plVtTop[plIdx+1]<plVtTop[plIdx])
+		{
+			return YSERR;
+		}
+	}
+
+	auto plVtIdx=GetArray<unsigned int>(nodeIdx,ARRAY_PLGVTXIDX);
+	for(YSSIZE_T idx=0; idx<nPlVtIdx; ++idx)
+	{
+		if(nVtx<=(YSSIZE_T)plVtIdx[idx])
+		{
+			return YSERR;
+		}
+	}
+
+	return YSOK;
+}
+
+YSSIZE_T YsVisualCache::Reader::GetN(YSSIZE_T nodeIdx,ARRAYTYPE arrayType) const
+{
+	return (YSSIZE_T)(nodeTable[nodeIdx].array[arrayType].nByte/ysVisualCacheElemSize[arrayType]);
+}
+
+template <class T>
+const T *YsVisualCache::Reader::GetArray(YSSIZE_T nodeIdx,ARRAYTYPE arrayType) const
+{
+	return (const T *)(file.data()+nodeTable[nodeIdx].array[arrayType].offset);
+}
+
+template <class T,const int D>
+void YsVisualCache::Reader::LoadBuffer(YsGLBufferTemplate <T,D> &buf,YSSIZE_T nodeIdx,ARRAYTYPE arrayType) const
+{
+	buf.CleanUp();
+	buf.AddArray(GetN(nodeIdx,arrayType),GetArray<T>(nodeIdx,arrayType));
+}
+
+YSRESULT YsVisualCache::Reader::LoadShell(Shell &shl,YSSIZE_T nodeIdx) const
+{
+	const YSSIZE_T nVtx=GetN(nodeIdx,ARRAY_VTXPOS);
+	auto vtxPos=GetArray<double>(nodeIdx,ARRAY_VTXPOS);
+	auto vtxAttrib=GetArray<VertexAttrib>(nodeIdx,ARRAY_VTXATTRIB);
+
+	YsArray <YsShellVertexHandle> vtHd(nVtx,nullptr);
+	for(YSSIZE_T vtIdx=0; vtIdx<nVtx; ++vtIdx)
+	{
+		vtHd[vtIdx]=shl.AddVertex(YsVec3(vtxPos[vtIdx*3],vtxPos[vtIdx*3+1],vtxPos[vtIdx*3+2]));
+		if(0!=vtxAttrib[vtIdx].flags || 0.0!=vtxAttrib[vtIdx].thickness)
+		{
+			YsShellExt::VertexAttrib attrib;
+			attrib.Initialize();
+			attrib.flags=(YsShellExt::VertexAttrib::VTFLAG)vtxAttrib[vtIdx].flags;
+			attrib.thickness=vtxAttrib[vtIdx].thickness;
+			shl.SetVertexAttrib(vtHd[vtIdx],attrib);
+		}
+	}
+
+	const YSSIZE_T nPlg=GetN(nodeIdx,ARRAY_PLGATTRIB);
+	auto plVtTop=GetArray<unsigned int>(nodeIdx,ARRAY_PLGVTXTOP);
+	auto plVtIdx=GetArray<unsigned int>(nodeIdx,ARRAY_PLGVTXIDX);
+	auto plAttrib=GetArray<PolygonAttrib>(nodeIdx,ARRAY_PLGATTRIB);
+
+	YsArray <YsShellVertexHandle,16> plVtHd;
+	for(YSSIZE_T plIdx=0; plIdx<nPlg; ++plIdx)
+	{
+		plVtHd.Clear();
+		for(auto idx=plVtTop[plIdx]; idx<plVtTop[plIdx+1]; ++idx)
+		{
+			plVtHd.Add(vtHd[plVtIdx[idx]]);
+		}
+
+		auto &src=plAttrib[plIdx];
+		auto plHd=shl.AddPolygon(plVtHd);
+
+		YsColor col;
+		col.SetIntRGBA(src.col[0],src.col[1],src.col[2],src.col[3]);
+		shl.SetPolygonColor(plHd,col);
+		shl.SetPolygonNormal(plHd,YsVec3(src.nom[0],src.nom[1],src.nom[2]));
+
+		if(0!=src.flags || 0.0!=src.elemSize || 0.0!=src.thickness)
+		{
+			YsShellExt::PolygonAttrib attrib;
+			attrib.Initialize();
+			attrib.flags=(YsShellExt::PolygonAttrib::PLFLAG)src.flags;
+			attrib.elemSize=src.elemSize;
+			attrib.thickness=src.thickness;
+			shl.SetPolygonAttrib(plHd,attrib);
+		}
+	}
+
+	auto &buf=shl.GetDrawingBuffer();
+	LoadBuffer(buf.normalEdgePosBuffer,nodeIdx,ARRAY_NORMALEDGE_VTX);
+	LoadBuffer(buf.shrunkEdgePosBuffer,nodeIdx,ARRAY_SHRUNKEDGE_VTX);
+	LoadBuffer(buf.solidShadedVtxBuffer,nodeIdx,ARRAY_SOLIDSHADED_VTX);
+	LoadBuffer(buf.solidShadedNomBuffer,nodeIdx,ARRAY_SOLIDSHADED_NOM);
+	LoadBuffer(buf.solidShadedColBuffer,nodeIdx,ARRAY_SOLIDSHADED_COL);
+	LoadBuffer(buf.solidUnshadedVtxBuffer,nodeIdx,ARRAY_SOLIDUNSHADED_VTX);
+	LoadBuffer(buf.solidUnshadedColBuffer,nodeIdx,ARRAY_SOLIDUNSHADED_COL);
+	LoadBuffer(buf.trspShadedVtxBuffer,nodeIdx,ARRAY_TRSPSHADED_VTX);
+	LoadBuffer(buf.trspShadedNomBuffer,nodeIdx,ARRAY_TRSPSHADED_NOM);
+	LoadBuffer(buf.trspShadedColBuffer,nodeIdx,ARRAY_TRSPSHADED_COL);
+	LoadBuffer(buf.trspUnshadedVtxBuffer,nodeIdx,ARRAY_TRSPUNSHADED_VTX);
+	LoadBuffer(buf.trspUnshadedColBuffer,nodeIdx,ARRAY_TRSPUNSHADED_COL);
+	LoadBuffer(buf.backFaceVtxBuffer,nodeIdx,ARRAY_BACKFACE_VTX);
+	LoadBuffer(buf.backFaceColBuffer,nodeIdx,ARRAY_BACKFACE_COL);
+	LoadBuffer(buf.lightVtxBuffer,nodeIdx,ARRAY_LIGHT_VTX);
+	LoadBuffer(buf.lightColBuffer,nodeIdx,ARRAY_LIGHT_COL);
+	LoadBuffer(buf.lightSizeBuffer,nodeIdx,ARRAY_LIGHT_SIZE);
+	shl.SetPolygonBufferCached(YSTRUE);
+
+	return YSOK;
+}
+
+
+
+////////////////////////////////////////////////////////////
+
+
+
+YsVisualCache::SourceInfo::SourceInfo()
+{
+	size=0;
+	modifiedTime=0;
+}
+
+YSRESULT YsVisualCache::SourceInfo::Get(const wchar_t srcFn[])
+{
+	fn=YsFileIO::GetRealPath(srcFn);
+	return YsFileIO::GetFileSizeAndTime(size,modifiedTime,fn);
+}
+
+
+
+/* static */ YSBOOL YsVisualCache::IsCacheable(const YsShellExt &shl)
+{
+	if(0<shl.GetNumTexCoord() || 0<shl.GetNumMetaData() || 0<shl.GetNumVolume())
+	{
+		return YSFALSE;
+	}
+	return YSTRUE;
+}
+
+/* static */ void YsVisualCache::PrepareDrawingBuffer(Shell &shl)
+{
+	if(YSTRUE!=shl.IsPolygonBufferCached())
+	{
+		shl.GetDrawingBuffer().RemakePolygonBuffer(shl,0.8);
+		shl.SetPolygonBufferCached(YSTRUE);
+	}
+}
+
+/* static */ YSRESULT YsVisualCache::Save(const wchar_t cacheFn[],const SourceInfo &src,YsVisualSrf &srf)
+{
+	Shell *shl=&srf;
+	return Save(cacheFn,src,MODEL_SRF,1,&shl,nullptr);
+}
+
+/* static */ YSRESULT YsVisualCache::Save(const wchar_t cacheFn[],const SourceInfo &src,YsVisualDnm &dnm)
+{
+	if(nullptr==dnm.dnmPtr)
+	{
+		return YSERR;
+	}
+
+	auto allNode=dnm.dnmPtr->GetNodePointerAll();
+	YsArray <Shell *> shl(allNode.GetN(),nullptr);
+	for(YSSIZE_T nodeIdx=0; nodeIdx<allNode.GetN(); ++nodeIdx)
+	{
+		shl[nodeIdx]=allNode[nodeIdx];
+	}
+	return Save(cacheFn,src,MODEL_DNM,allNode.GetN(),shl,allNode);
+}
+
+/* static */ YSRESULT YsVisualCache::Save(const wchar_t cacheFn[],const SourceInfo &src,MODELTYPE modelType,YSSIZE_T nNode,Shell *const shl[],Dnm::Node *const node[])
+{
+	if(0==nNode)
+	{
+		return YSERR;
+	}
+	for(YSSIZE_T nodeIdx=0; nodeIdx<nNode; ++nodeIdx)
+	{
+		if(YSTRUE!=IsCacheable(*shl[nodeIdx]))
+		{
+			return YSERR;
+		}
+	}
+
+	YsHashTable <YSSIZE_T> nodeKeyToIndex;
+	if(nullptr!=node)
+	{
+		for(YSSIZE_T nodeIdx=0; nodeIdx<nNode; ++nodeIdx)
+		{
+			nodeKeyToIndex.AddElement(node[nodeIdx]->GetSearchKey(),nodeIdx);
+		}
+	}
+
+	Writer writer;
+	if(YSOK!=writer.Open(cacheFn))
+	{
+		return YSERR;
+	}
+
+	YsString srcFnUTF8;
+	srcFnUTF8.EncodeUTF8 <wchar_t> (src.fn);
+	writer.Write(srcFnUTF8.Strlen(),srcFnUTF8.Txt());
+
+	YsArray <NodeHeader> nodeTable(nNode,nullptr);
+	for(YSSIZE_T nodeIdx=0; nodeIdx<nNode; ++nodeIdx)
+	{
+		auto &nodeHd=nodeTable[nodeIdx];
+		memset(&nodeHd,0,sizeof(nodeHd));
+		nodeHd.parent=-1;
+		nodeHd.localRotationAxis[0]=1.0;
+
+		if(nullptr!=node)
+		{
+			auto nodePtr=node[nodeIdx];
+
+			YSSIZE_T parentIdx;
+			if(nullptr!=nodePtr->parent && YSOK==nodeKeyToIndex.FindElement(parentIdx,nodePtr->parent->GetSearchKey()))
+			{
+				nodeHd.parent=(int)parentIdx;
+			}
+			nodeHd.dnmClassType=nodePtr->dnmClassType;
+			nodeHd.searchKey=nodePtr->GetSearchKey();
+			YsVisualCache_SetVec3(nodeHd.posInParent,nodePtr->posInParent);
+			YsVisualCache_SetAtt3(nodeHd.attInParent,nodePtr->attInParent);
+			YsVisualCache_SetVec3(nodeHd.localRotationCenter,nodePtr->localRotationCenter);
+			YsVisualCache_SetVec3(nodeHd.localRotationAxis,nodePtr->localRotationAxis);
+
+			nodeHd.array[ARRAY_NODENAME]=writer.WriteArray(nodePtr->nodeName.Strlen(),nodePtr->nodeName.Txt());
+
+			YsArray <NodeState> state(nodePtr->stateArray.GetN(),nullptr);
+			for(YSSIZE_T staIdx=0; staIdx<state.GetN(); ++staIdx)
+			{
+				auto &from=nodePtr->stateArray[staIdx];
+				memset(&state[staIdx],0,sizeof(NodeState));
+				YsVisualCache_SetVec3(state[staIdx].relPos,from.relPos);
+				YsVisualCache_SetAtt3(state[staIdx].relAtt,from.relAtt);
+				state[staIdx].show=(YSTRUE==from.GetShow() ? 1 : 0);
+			}
+			nodeHd.array[ARRAY_NODESTATE]=writer.WriteArray(state.GetN(),state.GetArray());
+		}
+		else
+		{
+			nodeHd.array[ARRAY_NODENAME]=writer.WriteArray <char> (0,nullptr);
+			nodeHd.array[ARRAY_NODESTATE]=writer.WriteArray <NodeState> (0,nullptr);
+		}
+
+		PrepareDrawingBuffer(*shl[nodeIdx]);
+		shl[nodeIdx]->Encache();
+		const Shell &s=*shl[nodeIdx];
+
+		YsArray <double> vtxPos;
+		YsArray <VertexAttrib> vtxAttrib;
+		vtxPos.Resize(s.GetNumVertex()*3);
+		vtxAttrib.Resize(s.GetNumVertex());
+		for(auto vtHd : s.AllVertex())
+		{
+			const auto vtIdx=s.GetVertexIdFromHandle(vtHd);
+			const auto pos=s.GetVertexPosition(vtHd);
+			const auto attrib=s.GetVertexAttrib(vtHd);
+			vtxPos[vtIdx*3  ]=pos.x();
+			vtxPos[vtIdx*3+1]=pos.y();
+			vtxPos[vtIdx*3+2]=pos.z();
+			memset(&vtxAttrib[vtIdx],0,sizeof(VertexAttrib));
+			vtxAttrib[vtIdx].flags=attrib->flags;
+			vtxAttrib[vtIdx].thickness=attrib->thickness;
+		}
+		nodeHd.array[ARRAY_VTXPOS]=writer.WriteArray(vtxPos.GetN(),vtxPos.GetArray());
+		nodeHd.array[ARRAY_VTXATTRIB]=writer.WriteArray(vtxAttrib.GetN(),vtxAttrib.GetArray());
+
+		YsArray <unsigned int> plVtTop,plVtIdx;
+		YsArray <PolygonAttrib> plAttrib;
+		plVtTop.Add(0);
+		for(auto plHd : s.AllPolygon())
+		{
+			for(auto vtHd : s.GetPolygonVertex(plHd))
+			{
+				plVtIdx.Add((unsigned int)s.GetVertexIdFromHandle(vtHd));
+			}
+			plVtTop.Add((unsigned int)plVtIdx.GetN());
+
+			const auto col=s.GetColor(plHd);
+			const auto attrib=s.GetPolygonAttrib(plHd);
+
+			plAttrib.Increment();
+			auto &plA=plAttrib.Last();
+			memset(&plA,0,sizeof(plA));
+			YsVisualCache_SetVec3(plA.nom,s.GetNormal(plHd));
+			plA.col[0]=(unsigned char)col.Ri();
+			plA.col[1]=(unsigned char)col.Gi();
+			plA.col[2]=(unsigned char)col.Bi();
+			plA.col[3]=(unsigned char)col.Ai();
+			plA.flags=attrib->flags;
+			plA.elemSize=attrib->elemSize;
+			plA.thickness=attrib->thickness;
+		}
+		nodeHd.array[ARRAY_PLGVTXTOP]=writer.WriteArray(plVtTop.GetN(),plVtTop.GetArray());
+		nodeHd.array[ARRAY_PLGVTXIDX]=writer.WriteArray(plVtIdx.GetN(),plVtIdx.GetArray());
+		nodeHd.array[ARRAY_PLGATTRIB]=writer.WriteArray(plAttrib.GetN(),plAttrib.GetArray());
+
+		const auto &buf=s.GetDrawingBuffer();
+		nodeHd.array[ARRAY_NORMALEDGE_VTX]=writer.WriteBuffer(buf.normalEdgePosBuffer);
+		nodeHd.array[ARRAY_SHRUNKEDGE_VTX]=writer.WriteBuffer(buf.shrunkEdgePosBuffer);
+		nodeHd.array[ARRAY_SOLIDSHADED_VTX]=writer.WriteBuffer(buf.solidShadedVtxBuffer);
+		nodeHd.array[ARRAY_SOLIDSHADED_NOM]=writer.WriteBuffer(buf.solidShadedNomBuffer);
+		nodeHd.array[ARRAY_SOLIDSHADED_COL]=writer.WriteBuffer(buf.solidShadedColBuffer);
+		nodeHd.array[ARRAY_SOLIDUNSHADED_VTX]=writer.WriteBuffer(buf.solidUnshadedVtxBuffer);
+		nodeHd.array[ARRAY_SOLIDUNSHADED_COL]=writer.WriteBuffer(buf.solidUnshadedColBuffer);
+		nodeHd.array[ARRAY_TRSPSHADED_VTX]=writer.WriteBuffer(buf.trspShadedVtxBuffer);
+		nodeHd.array[ARRAY_TRSPSHADED_NOM]=writer.WriteBuffer(buf.trspShadedNomBuffer);
+		nodeHd.array[ARRAY_TRSPSHADED_COL]=writer.WriteBuffer(buf.trspShadedColBuffer);
+		nodeHd.array[ARRAY_TRSPUNSHADED_VTX]=writer.WriteBuffer(buf.trspUnshadedVtxBuffer);
+		nodeHd.array[ARRAY_TRSPUNSHADED_COL]=writer.WriteBuffer(buf.trspUnshadedColBuffer);
+		nodeHd.array[ARRAY_BACKFACE_VTX]=writer.WriteBuffer(buf.backFaceVtxBuffer);
+		nodeHd.array[ARRAY_BACKFACE_COL]=writer.WriteBuffer(buf.backFaceColBuffer);
+		nodeHd.array[ARRAY_LIGHT_VTX]=writer.WriteBuffer(buf.lightVtxBuffer);
+		nodeHd.array[ARRAY_LIGHT_COL]=writer.WriteBuffer(buf.lightColBuffer);
+		nodeHd.array[ARRAY_LIGHT_SIZE]=writer.WriteBuffer(buf.lightSizeBuffer);
+	}
+
+	writer.Align();
+
+	FileHeader hd;
+	memset(&hd,0,sizeof(hd));
+	memcpy(hd.magic,ysVisualCacheMagic,sizeof(hd.magic));
+	hd.version=FILE_VERSION;
+	hd.byteOrderMark=BYTE_ORDER_MARK;
+	hd.modelType=modelType;
+	hd.nNode=(unsigned int)nNode;
+	hd.srcSize=src.size;
+	hd.srcModifiedTime=src.modifiedTime;
+	hd.srcFnLength=srcFnUTF8.Strlen();
+	hd.nodeTableOffset=writer.GetFilePointer();
+	writer.Write(sizeof(NodeHeader)*nNode,nodeTable.GetArray());
+
+	return writer.Close(hd);
+}
+
+/* static */ YSRESULT YsVisualCache::Load(YsVisualSrf &srf,const wchar_t cacheFn[],const SourceInfo &src)
+{
+	Reader reader;
+	if(YSOK!=reader.Open(cacheFn,src,MODEL_SRF))
+	{
+		return YSERR;
+	}
+
+	srf.CleanUp();
+	return reader.LoadShell(srf,0);
+}
+
+/* static */ YSRESULT YsVisualCache::Load(YsVisualDnm &dnm,const wchar_t cacheFn[],const SourceInfo &src)
+{
+	Reader reader;
+	if(YSOK!=reader.Open(cacheFn,src,MODEL_DNM))
+	{
+		return YSERR;
+	}
+
+	const YSSIZE_T nNode=reader.hd->nNode;
+	std::shared_ptr <Dnm> newDnm(new Dnm);
+
+	// Nodes are created in the order of the search keys so that each node gets the same key as it got when the
+	// text was read.  YsVisualDnm::GetDnmNodeNumberFromName returns the key.
+	YsArray <YSHASHKEY> nodeKey(nNode,nullptr);
+	YsArray <YSSIZE_T> nodeOrder(nNode,nullptr);
+	for(YSSIZE_T nodeIdx=0; nodeIdx<nNode; ++nodeIdx)
+	{
+		nodeKey[nodeIdx]=reader.nodeTable[nodeIdx].searchKey;
+		nodeOrder[nodeIdx]=nodeIdx;
+	}
+	YsSimpleMergeSort <YSHASHKEY,YSSIZE_T> (nNode,nodeKey,nodeOrder);
+
+	YsArray <Dnm::Node *> node(nNode,nullptr);
+	YSSIZE_T nSkip=0;
+	for(auto nodeIdx : nodeOrder)
+	{
+		const YSHASHKEY key=reader.nodeTable[nodeIdx].searchKey;
+		auto newNode=newDnm->CreateShell(nullptr);
+		while(newNode->GetSearchKey()<key && nSkip<nNode)
+		{
+			// Skip the keys of the nodes that were deleted while the text was read.
+			newDnm->DeleteShell(newNode);
+			newNode=newDnm->CreateShell(nullptr);
+			++nSkip;
+		}
+		if(newNode->GetSearchKey()!=key)
+		{
+			return YSERR;
+		}
+		node[nodeIdx]=newNode;
+	}
+
+	for(YSSIZE_T nodeIdx=0; nodeIdx<nNode; ++nodeIdx)
+	{
+		auto &nodeHd=reader.nodeTable[nodeIdx];
+		auto nodePtr=node[nodeIdx];
+		if(0<=nodeHd.parent)
+		{
+			newDnm->Reconnect(nodePtr,node[nodeHd.parent]);
+		}
+
+		nodePtr->nodeName.Set(reader.GetN(nodeIdx,ARRAY_NODENAME),reader.GetArray<char>(nodeIdx,ARRAY_NODENAME));
+		nodePtr->dnmClassType=nodeHd.dnmClassType;
+		nodePtr->posInParent.Set(nodeHd.posInParent[0],nodeHd.posInParent[1],nodeHd.posInParent[2]);
+		nodePtr->attInParent.Set(nodeHd.attInParent[0],nodeHd.attInParent[1],nodeHd.attInParent[2]);
+		nodePtr->localRotationCenter.Set(nodeHd.localRotationCenter[0],nodeHd.localRotationCenter[1],nodeHd.localRotationCenter[2]);
+		nodePtr->localRotationAxis.Set(nodeHd.localRotationAxis[0],nodeHd.localRotationAxis[1],nodeHd.localRotationAxis[2]);
+
+		const YSSIZE_T nState=reader.GetN(nodeIdx,ARRAY_NODESTATE);
+		auto state=reader.GetArray<NodeState>(nodeIdx,ARRAY_NODESTATE);
+		nodePtr->stateArray.Resize(nState);
+		for(YSSIZE_T staIdx=0; staIdx<nState; ++staIdx)
+		{
+			auto &to=nodePtr->stateArray[staIdx];
+			to.Initialize();
+			to.relPos.Set(state[staIdx].relPos[0],state[staIdx].relPos[1],state[staIdx].relPos[2]);
+			to.relAtt.Set(state[staIdx].relAtt[0],state[staIdx].relAtt[1],state[staIdx].relAtt[2]);
+			to.SetShow(0!=state[staIdx].show ? YSTRUE : YSFALSE);
+		}
+
+		if(YSOK!=reader.LoadShell(*nodePtr,nodeIdx))
+		{
+			return YSERR;
+		}
+	}
+
+	// Reconnect adds a child at the end.  The tree must come out in the same order as it was saved, or the
+	// drawing order and GetNodePointerAll would be different from the text.
+	auto allNode=newDnm->GetNodePointerAll();
+	if(allNode.GetN()!=nNode)
+	{
+		return YSERR;
+	}
+	for(YSSIZE_T nodeIdx=0; nodeIdx<nNode; ++nodeIdx)
+	{
+		if(allNode[nodeIdx]!=node[nodeIdx])
+		{
+			return YSERR;
+		}
+	}
+
+	dnm.dnmPtr.swap(newDnm);
+	return YSOK;
+}
@@ -0,0 +1,192 @@
+/* ////////////////////////////////////////////////////////////
+
+File Name: ysvisualcache.h
+Copyright (c) 2017 Soji Yamakawa.  All rights reserved.
+http://www.ysflight.com
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, 
+   this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, 
+   this list of conditions and the following disclaimer in the documentation 
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR 
+PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) 
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+//////////////////////////////////////////////////////////// */
+
+
+#ifndef YSVISUALCACHE_IS_INCLUDED
+#define YSVISUALCACHE_IS_INCLUDED
+/* { */
+
+#include <ysclass.h>
+#include "ysvisual.h"
+
+/*! Binary cache of a YsVisualSrf or a YsVisualDnm.
+
+    Loading a text SRF or DNM file parses every line, fixes the orientation of the polygons, and then, when the
+    model is drawn first, tessellates the polygons into the drawing buffer.  The cache file keeps the result of all
+    of them, so that the next load only maps the file and copies the arrays.
+
+    All numbers are in the byte order of the machine that wrote the file (byteOrderMark tells), and every array is
+    aligned to 8 bytes.
+
+      FileHeader
+      char srcFn[srcFnLength]            Full-path name of the source file in UTF-8
+      For each node (only one for SRF)
+        Arrays listed in ARRAYTYPE
+      NodeHeader nodeTable[nNode]        In the order of YsShellDnmContainer::GetNodePointerAll
+
+    The source file is identified by the full-path name, the size, and the last-modified time.  If any of them
+    does not match, or the file is broken, Load returns YSERR, and the caller is expected to read the text file.
+
+    Face groups and constraint edges are not stored.  They only affect the vertex normals, which are already in
+    the drawing buffer.  A shell that has texture coordinates, meta data, or volumes is not cached.
+*/
+class YsVisualCache
+{
+public:
+	enum
+	{
+		FILE_VERSION=1,
+		BYTE_ORDER_MARK=0x01020304
+	};
+	enum MODELTYPE
+	{
+		MODEL_SRF=0,
+		MODEL_DNM=1
+	};
+	enum ARRAYTYPE
+	{
+		ARRAY_NODENAME,              // char
+		ARRAY_NODESTATE,             // NodeState
+		ARRAY_VTXPOS,                // double x3
+		ARRAY_VTXATTRIB,             // VertexAttrib
+		ARRAY_PLGVTXTOP,             // unsigned int x(nPlg+1)
+		ARRAY_PLGVTXIDX,             // unsigned int
+		ARRAY_PLGATTRIB,             // PolygonAttrib
+
+		// Polygon part of YsShellExtDrawingBuffer.
+		ARRAY_NORMALEDGE_VTX,        // float x3
+		ARRAY_SHRUNKEDGE_VTX,        // float x3
+		ARRAY_SOLIDSHADED_VTX,       // float x3
+		ARRAY_SOLIDSHADED_NOM,       // float x3
+		ARRAY_SOLIDSHADED_COL,       // float x4
+		ARRAY_SOLIDUNSHADED_VTX,     // float x3
+		ARRAY_SOLIDUNSHADED_COL,     // float x4
+		ARRAY_TRSPSHADED_VTX,        // float x3
+		ARRAY_TRSPSHADED_NOM,        // float x3
+		ARRAY_TRSPSHADED_COL,        // float x4
+		ARRAY_TRSPUNSHADED_VTX,      // float x3
+		ARRAY_TRSPUNSHADED_COL,      // float x4
+		ARRAY_BACKFACE_VTX,          // float x3
+		ARRAY_BACKFACE_COL,          // float x4
+		ARRAY_LIGHT_VTX,             // float x3
+		ARRAY_LIGHT_COL,             // float x4
+		ARRAY_LIGHT_SIZE,            // float
+
+		NUM_ARRAYTYPE
+	};
+
+	class FileHeader
+	{
+	public:
+		char magic[8];                      // "YSVISCAC"
+		unsigned int version;
+		unsigned int byteOrderMark;
+		unsigned int modelType;
+		unsigned int nNode;
+		long long int srcSize;
+		long long int srcModifiedTime;
+		unsigned long long srcFnLength;
+		unsigned long long nodeTableOffset;
+	};
+	class ArrayInfo
+	{
+	public:
+		unsigned long long offset,nByte;
+	};
+	class NodeHeader
+	{
+	public:
+		int parent;                         // Index in the node table.  -1 for a root node.
+		int dnmClassType;
+		unsigned int searchKey;
+		unsigned int reserved;
+		double posInParent[3],attInParent[3];
+		double localRotationCenter[3],localRotationAxis[3];
+		ArrayInfo array[NUM_ARRAYTYPE];
+	};
+	class NodeState
+	{
+	public:
+		double relPos[3],relAtt[3];
+		unsigned int show,reserved;
+	};
+	class VertexAttrib
+	{
+	public:
+		unsigned int flags,reserved;
+		double thickness;
+	};
+	class PolygonAttrib
+	{
+	public:
+		double nom[3];
+		unsigned char col[4];
+		unsigned int flags;
+		double elemSize,thickness;
+	};
+
+	/*! Identity of the source file. */
+	class SourceInfo
+	{
+	public:
+		YsWString fn;                       // Full-path name.
+		long long int size,modifiedTime;
+
+		SourceInfo();
+		YSRESULT Get(const wchar_t srcFn[]);
+	};
+
+	/*! Returns YSTRUE if everything that the shell has can be stored in the cache. */
+	static YSBOOL IsCacheable(const YsShellExt &shl);
+
+	/*! Writes the model in the cache file.  If the drawing buffer of a shell has not been made, it is made
+	    in this function, and the shell is marked as such so that it is not re-made before the first draw. */
+	static YSRESULT Save(const wchar_t cacheFn[],const SourceInfo &src,YsVisualSrf &srf);
+	static YSRESULT Save(const wchar_t cacheFn[],const SourceInfo &src,YsVisualDnm &dnm);
+
+	/*! Reads the model from the cache file.  It returns YSERR without changing the model if the cache file
+	    does not exist, is broken, or is not made from the given source file. */
+	static YSRESULT Load(YsVisualSrf &srf,const wchar_t cacheFn[],const SourceInfo &src);
+	static YSRESULT Load(YsVisualDnm &dnm,const wchar_t cacheFn[],const SourceInfo &src);
+
+private:
+	class Writer;
+	class Reader;
+
+	typedef YsShellExtWithVbo <YsShellExt> Shell;
+	typedef YsShellDnmContainer <Shell> Dnm;
+
+	static void PrepareDrawingBuffer(Shell &shl);
+
+	/*! node is nullptr for SRF. */
+	static YSRESULT Save(const wchar_t cacheFn[],const SourceInfo &src,MODELTYPE modelType,YSSIZE_T nNode,Shell *const shl[],Dnm::Node *const node[]);
+};
+
+/* } */
+#endif
@@ -101,6 +101,11 @@ public:
 	{
 		this->dat.MoveFrom(incoming.dat);
 	}
+	/*! Adds nElem elements from an array of nElem*D values. */
+	inline void AddArray(YSSIZE_T nElem,const T elem[])
+	{
+		this->dat.Add(nElem*D,elem);
+	}
 
 	inline YSSIZE_T size(void) const
 	{
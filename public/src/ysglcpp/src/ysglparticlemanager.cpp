@@ -27,6 +27,9 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 //////////////////////////////////////////////////////////// */
 
+#include <algorithm>
+#include <string.h>
+
 #include <ysmergesort.h>
 #include <ysclass11.h>
 
@@ -35,6 +38,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 YsGLParticleManager::YsGLParticleManager()
 {
+	sortMethod=SORT_MERGESORT;
 	CleanUp();
 }
 YsGLParticleManager::~YsGLParticleManager()
@@ -54,6 +58,32 @@ void YsGLParticleManager::CleanUp(void)
 	particle.CleanUp();
 	particleOrder.CleanUp();
 	particleDist.CleanUp();
+	sortedKey.CleanUp();
+
+	radixBits.CleanUp();
+	radixBitsBuf.CleanUp();
+	radixOrder.CleanUp();
+
+	nParticleLastSort=0;
+	sortStat.nParticle=0;
+	sortStat.nOutOfOrder=0;
+	sortStat.usedRadixSort=YSFALSE;
+}
+void YsGLParticleManager::ClearParticle(void)
+{
+	particle.Set(0,nullptr);
+}
+void YsGLParticleManager::SetSortMethod(SORT_METHOD sortMethod)
+{
+	this->sortMethod=sortMethod;
+}
+YsGLParticleManager::SORT_METHOD YsGLParticleManager::GetSortMethod(void) const
+{
+	return sortMethod;
+}
+const YsGLParticleManager::SortStatistics &YsGLParticleManager::GetSortStatistics(void) const
+{
+	return sortStat;
 }
 YSSIZE_T YsGLParticleManager::GetNumParticle(void) const
 {
@@ -70,17 +100,207 @@ void YsGLParticleManager::CalculateDotProd(YSSIZE_T i0,YSSIZE_T i1,const YsVec3
 	}
 }
 
+void YsGLParticleManager::MakeSortedKeyFromParticleDist(void)
+{
+	sortedKey.Set(particleDist.GetN(),nullptr);
+	for(YSSIZE_T i=0; i<particleDist.GetN(); ++i)
+	{
+		sortedKey[i]=(float)particleDist[i];
+	}
+
+	nParticleLastSort=particle.GetN();
+	sortStat.nParticle=particle.GetN();
+	sortStat.nOutOfOrder=0;
+	sortStat.usedRadixSort=YSFALSE;
+}
+
+void YsGLParticleManager::MakeCoherentInitialOrder(void)
+{
+	// Particles that still exist stay in the last order.  New particles go to the end.
+	const YSSIZE_T nParticle=particle.GetN();
+	if(particleOrder.GetN()!=nParticleLastSort)
+	{
+		particleOrder.Set(0,nullptr);
+		nParticleLastSort=0;
+	}
+
+	YSSIZE_T nKeep=0;
+	for(YSSIZE_T i=0; i<particleOrder.GetN(); ++i)
+	{
+		if(particleOrder[i]<nParticle)
+		{
+			particleOrder[nKeep++]=particleOrder[i];
+		}
+	}
+	particleOrder.Resize(nKeep);
+	for(YSSIZE_T idx=nParticleLastSort; idx<nParticle; ++idx)
+	{
+		particleOrder.Add(idx);
+	}
+	sortedKey.Set(nParticle,nullptr);
+}
+
+void YsGLParticleManager::CalculateSortKeyInOrder(YSSIZE_T i0,YSSIZE_T i1,const YsVec3 &viewPos,const YsVec3 &viewDir)
+{
+	for(auto i=i0; i<i1; ++i)
+	{
+		auto &p=particle[particleOrder[i]];
+		sortedKey[i]=(float)(-(p.pos-viewPos)*viewDir);
+		p.depth=-sortedKey[i];
+	}
+}
+
+void YsGLParticleManager::SortCoherent(void)
+{
+	// Insertion sort is linear in the number of particles plus the number of inversions.  The order of the last
+	// Sort is usually off only by a few positions, and then it is cheaper than sorting from scratch.
+	// If the camera jumps, or the view direction turns quickly, the number of inversions grows quadratically.
+	// Therefore, the insertion sort gives up after maxNumShift, and the radix sort takes over.
+	const YSSIZE_T nParticle=sortedKey.GetN();
+	const YSSIZE_T maxNumShift=nParticle*8;
+
+	float *key=sortedKey.GetEditableArray();
+	YSSIZE_T *order=particleOrder.GetEditableArray();
+
+	sortStat.nParticle=nParticle;
+	sortStat.nOutOfOrder=0;
+	sortStat.usedRadixSort=YSFALSE;
+
+	YSSIZE_T nShift=0;
+	for(YSSIZE_T i=1; i<nParticle; ++i)
+	{
+		if(key[i-1]<=key[i])
+		{
+			continue;
+		}
+
+		const float k=key[i];
+		const YSSIZE_T o=order[i];
+		YSSIZE_T j=i;
+		while(0<j && k<key[j-1])
+		{
+			key[j]=key[j-1];
+			order[j]=order[j-1];
+			--j;
+		}
+		key[j]=k;
+		order[j]=o;
+
+		++sortStat.nOutOfOrder;
+		nShift+=i-j;
+		if(maxNumShift<nShift)
+		{
+			RadixSortSortedKey();
+			sortStat.usedRadixSort=YSTRUE;
+			return;
+		}
+	}
+}
+
+void YsGLParticleManager::RadixSortSortedKey(void)
+{
+	// LSD radix sort of the float keys in three 11-bit passes.  Float bits are mapped so that the unsigned order
+	// is the same as the float order: flip the sign bit of a positive number, and flip all bits of a negative number.
+	const YSSIZE_T nParticle=sortedKey.GetN();
+	const int nBit=11,nBucket=1<<nBit,nPass=3;
+
+	radixBits.Set(nParticle,nullptr);
+	radixBitsBuf.Set(nParticle,nullptr);
+	for(YSSIZE_T i=0; i<nParticle; ++i)
+	{
+		unsigned int u;
+		memcpy(&u,&sortedKey[i],sizeof(u));
+		radixBits[i]=(0!=(u&0x80000000u) ? ~u : (u|0x80000000u));
+	}
+
+	radixOrder.Set(nParticle,nullptr);
+
+	YSSIZE_T count[nPass][nBucket];
+	memset(count,0,sizeof(count));
+	for(YSSIZE_T i=0; i<nParticle; ++i)
+	{
+		for(int pass=0; pass<nPass; ++pass)
+		{
+			++count[pass][(radixBits[i]>>(pass*nBit))&(nBucket-1)];
+		}
+	}
+
+	unsigned int *srcBits=radixBits,*dstBits=radixBitsBuf;
+	YSSIZE_T *srcOrder=particleOrder,*dstOrder=radixOrder;
+	for(int pass=0; pass<nPass; ++pass)
+	{
+		YSSIZE_T offset=0;
+		for(int b=0; b<nBucket; ++b)
+		{
+			const YSSIZE_T n=count[pass][b];
+			count[pass][b]=offset;
+			offset+=n;
+		}
+		for(YSSIZE_T i=0; i<nParticle; ++i)
+		{
+			const int b=(srcBits[i]>>(pass*nBit))&(nBucket-1);
+			const YSSIZE_T to=count[pass][b]++;
+			dstBits[to]=srcBits[i];
+			dstOrder[to]=srcOrder[i];
+		}
+		std::swap(srcBits,dstBits);
+		std::swap(srcOrder,dstOrder);
+	}
+
+	// Odd number of passes.  The result is in radixOrder.
+	for(YSSIZE_T i=0; i<nParticle; ++i)
+	{
+		const unsigned int u=(0!=(srcBits[i]&0x80000000u) ? (srcBits[i]&0x7fffffffu) : ~srcBits[i]);
+		memcpy(&sortedKey[i],&u,sizeof(u));
+		particleOrder[i]=srcOrder[i];
+	}
+}
+
 void YsGLParticleManager::Sort(const YsVec3 &viewPos,const YsVec3 &viewDir)
 {
+	if(SORT_COHERENT==sortMethod)
+	{
+		MakeCoherentInitialOrder();
+		CalculateSortKeyInOrder(0,particle.GetN(),viewPos,viewDir);
+		SortCoherent();
+		nParticleLastSort=particle.GetN();
+		return;
+	}
+
 	particleOrder.Set(particle.GetN(),nullptr);
 	particleDist.Set(particle.GetN(),nullptr);
 
 	CalculateDotProd(0,particle.size(),viewPos,viewDir);
 
 	YsSimpleMergeSort <double,YSSIZE_T> (particleDist.GetN(),particleDist,particleOrder);
+	MakeSortedKeyFromParticleDist();
 }
 void YsGLParticleManager::Sort(const YsVec3 &viewPos,const YsVec3 &viewDir,class YsThreadPool &thrPool)
 {
+	if(SORT_COHERENT==sortMethod)
+	{
+		MakeCoherentInitialOrder();
+		if(particle.size()<thrPool.size()*2 || thrPool.size()<2)
+		{
+			CalculateSortKeyInOrder(0,particle.GetN(),viewPos,viewDir);
+		}
+		else
+		{
+			std::vector <std::function<void()> > task;
+			task.resize(thrPool.size());
+			for(YSSIZE_T i=0; i<thrPool.size(); ++i)
+			{
+				auto i0=i*particle.size()/thrPool.size();
+				auto i1=(i+1)*particle.size()/thrPool.size();
+				task[i]=std::bind(&YsGLParticleManager::CalculateSortKeyInOrder,this,i0,i1,viewPos,viewDir);
+			}
+			thrPool.Run(task.size(),task.data());
+		}
+		SortCoherent();
+		nParticleLastSort=particle.GetN();
+		return;
+	}
+
 	particleOrder.Set(particle.GetN(),nullptr);
 	particleDist.Set(particle.GetN(),nullptr);
 
@@ -102,6 +322,7 @@ void YsGLParticleManager::Sort(const YsVec3 &viewPos,const YsVec3 &viewDir,class
 	}
 
 	YsSimpleParallelMergeSort <double,YSSIZE_T> (particleDist.GetN(),particleDist,particleOrder,thrPool);
+	MakeSortedKeyFromParticleDist();
 }
 
 void YsGLParticleManager::MakeBufferForPointSprite(double minZ)
@@ -111,16 +332,16 @@ void YsGLParticleManager::MakeBufferForPointSprite(double minZ)
 	pntColBuf.CleanUp();
 	pntSizeBuf.CleanUp();
 
-	for(auto idx : particleOrder)
+	// minZ<=depth  <=>  sortedKey<=-minZ.  The range is [0,nPnt).
+	const double keyThr=-minZ;
+	const YSSIZE_T nPnt=std::upper_bound(sortedKey.GetArray(),sortedKey.GetArray()+sortedKey.GetN(),keyThr,[](double k,float x){return k<(double)x;})-sortedKey.GetArray();
+	for(YSSIZE_T i=0; i<nPnt; ++i)
 	{
-		auto &p=particle[idx];
-		if(minZ<=p.depth)
-		{
-			pntVtxBuf.Add(p.pos);
-			pntTexCoordBuf.Add(p.texCoord[0],p.texCoord[1]);
-			pntColBuf.Add(p.col);
-			pntSizeBuf.Add(p.dimension);
-		}
+		auto &p=particle[particleOrder[i]];
+		pntVtxBuf.Add(p.pos);
+		pntTexCoordBuf.Add(p.texCoord[0],p.texCoord[1]);
+		pntColBuf.Add(p.col);
+		pntSizeBuf.Add(p.dimension);
 	}
 }
 
@@ -137,34 +358,34 @@ void YsGLParticleManager::MakeBufferForTriangle(const YsVec3 &viewDir,const floa
 	auto p01Vec=(-xVec+yVec);
 	auto p11Vec=( xVec+yVec);
 
-	for(auto idx : particleOrder)
+	// depth<maxZ  <=>  -maxZ<sortedKey.  The range is [iTri0,N).
+	const double keyThr=-maxZ;
+	const YSSIZE_T iTri0=std::upper_bound(sortedKey.GetArray(),sortedKey.GetArray()+sortedKey.GetN(),keyThr,[](double k,float x){return k<(double)x;})-sortedKey.GetArray();
+	for(YSSIZE_T i=iTri0; i<sortedKey.GetN(); ++i)
 	{
-		auto &p=particle[idx];
-		if(p.depth<maxZ)
-		{
-			triVtxBuf.Add(p.pos+p00Vec*p.dimension/2.0);
-			triVtxBuf.Add(p.pos+p10Vec*p.dimension/2.0);
-			triVtxBuf.Add(p.pos+p11Vec*p.dimension/2.0);
+		auto &p=particle[particleOrder[i]];
+		triVtxBuf.Add(p.pos+p00Vec*p.dimension/2.0);
+		triVtxBuf.Add(p.pos+p10Vec*p.dimension/2.0);
+		triVtxBuf.Add(p.pos+p11Vec*p.dimension/2.0);
 
-			triVtxBuf.Add(p.pos+p00Vec*p.dimension/2.0);
-			triVtxBuf.Add(p.pos+p11Vec*p.dimension/2.0);
-			triVtxBuf.Add(p.pos+p01Vec*p.dimension/2.0);
+		triVtxBuf.Add(p.pos+p00Vec*p.dimension/2.0);
+		triVtxBuf.Add(p.pos+p11Vec*p.dimension/2.0);
+		triVtxBuf.Add(p.pos+p01Vec*p.dimension/2.0);
 
 
-			triTexCoordBuf.Add(p.texCoord[0],p.texCoord[1]);
-			triTexCoordBuf.Add<float>(p.texCoord[0]+spriteTexCoordRange,p.texCoord[1]);
-			triTexCoordBuf.Add<float>(p.texCoord[0]+spriteTexCoordRange,p.texCoord[1]+spriteTexCoordRange);
+		triTexCoordBuf.Add(p.texCoord[0],p.texCoord[1]);
+		triTexCoordBuf.Add<float>(p.texCoord[0]+spriteTexCoordRange,p.texCoord[1]);
+		triTexCoordBuf.Add<float>(p.texCoord[0]+spriteTexCoordRange,p.texCoord[1]+spriteTexCoordRange);
 
-			triTexCoordBuf.Add(p.texCoord[0],p.texCoord[1]);
-			triTexCoordBuf.Add<float>(p.texCoord[0]+spriteTexCoordRange,p.texCoord[1]+spriteTexCoordRange);
-			triTexCoordBuf.Add<float>(p.texCoord[0],p.texCoord[1]+spriteTexCoordRange);
+		triTexCoordBuf.Add(p.texCoord[0],p.texCoord[1]);
+		triTexCoordBuf.Add<float>(p.texCoord[0]+spriteTexCoordRange,p.texCoord[1]+spriteTexCoordRange);
+		triTexCoordBuf.Add<float>(p.texCoord[0],p.texCoord[1]+spriteTexCoordRange);
 
-			triColBuf.Add(p.col);
-			triColBuf.Add(p.col);
-			triColBuf.Add(p.col);
-			triColBuf.Add(p.col);
-			triColBuf.Add(p.col);
-			triColBuf.Add(p.col);
-		}
+		triColBuf.Add(p.col);
+		triColBuf.Add(p.col);
+		triColBuf.Add(p.col);
+		triColBuf.Add(p.col);
+		triColBuf.Add(p.col);
+		triColBuf.Add(p.col);
 	}
 }
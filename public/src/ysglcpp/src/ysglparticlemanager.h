@@ -36,6 +36,21 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 class YsGLParticleManager
 {
 public:
+	enum SORT_METHOD
+	{
+		SORT_MERGESORT,   // Calculate depth and merge sort from scratch every time.
+		SORT_COHERENT     // Start from the order of the last Sort.  See SortCoherent.
+	};
+
+	/*! Numbers from the last Sort. */
+	class SortStatistics
+	{
+	public:
+		YSSIZE_T nParticle;
+		YSSIZE_T nOutOfOrder;   // Particles that had to be moved from the previous order (SORT_COHERENT)
+		YSBOOL usedRadixSort;   // YSTRUE if SORT_COHERENT fell back to the radix sort.
+	};
+
 	class Particle
 	{
 	public:
@@ -59,12 +74,31 @@ private:
 	YsArray <Particle> particle;
 	YsArray <YSSIZE_T> particleOrder;
 	YsArray <double> particleDist;
+	YsArray <float> sortedKey;  // sortedKey[i] is -depth of particle[particleOrder[i]].  Non-decreasing after Sort.
+
+	SORT_METHOD sortMethod;
+	SortStatistics sortStat;
+	YSSIZE_T nParticleLastSort;
+
+	// Working buffers for the radix sort of SORT_COHERENT
+	YsArray <unsigned int> radixBits,radixBitsBuf;
+	YsArray <YSSIZE_T> radixOrder;
 
 public:
 	YsGLParticleManager();
 	~YsGLParticleManager();
 	void CleanUp(void);
 
+	/*! Clears particles for the next frame.  Unlike CleanUp, the order of the last Sort and the sort method
+	    are kept, so that SORT_COHERENT can start from the last order.  Particles are assumed to be added in
+	    roughly the same order every frame.
+	*/
+	void ClearParticle(void);
+
+	void SetSortMethod(SORT_METHOD sortMethod);
+	SORT_METHOD GetSortMethod(void) const;
+	const SortStatistics &GetSortStatistics(void) const;
+
 	YSSIZE_T GetNumParticle(void) const;
 
 	/*! Adds a particle.  It assumes that each particle takes a constant rectangular space in the
@@ -92,10 +126,19 @@ public:
 
 private:
 	void CalculateDotProd(YSSIZE_T i0,YSSIZE_T i1,const YsVec3 &viewPos,const YsVec3 & viewDir);
+	void MakeSortedKeyFromParticleDist(void);
+
+	void MakeCoherentInitialOrder(void);
+	void CalculateSortKeyInOrder(YSSIZE_T i0,YSSIZE_T i1,const YsVec3 &viewPos,const YsVec3 &viewDir);
+	void SortCoherent(void);
+	void RadixSortSortedKey(void);
 
 public:
 	/*! Sort particles in the given view direction.  Technically, view point is not necessary,
 	    but probably it is good for reducing artifacts by the numerical error.
+
+	    With SORT_COHERENT, the particles are first placed in the order of the last Sort, and then fixed by
+	    the insertion sort.  If the order has changed too much, it falls back to the radix sort of the depth.
 	*/
 	void Sort(const YsVec3 &viewPos,const YsVec3 & viewDir);
 
@@ -109,6 +152,9 @@ public:
 	    OpenGL has a rediculously small max point-sprite size, which typically is 64 pixels.
 	    Therefore particles close to the viewpoint cannot be drawn as a point-sprite.
 	    The idea of minZ is for using point-sprite for far-away particles and use triangles for closer particles.
+
+	    Depth is taken from the sorted keys of Sort.  Since the particles are sorted by depth, the particles
+	    to be drawn as point-sprites are a leading range of the order, and are copied without a depth test.
 	*/
 	void MakeBufferForPointSprite(double minZ);
 
@@ -119,6 +165,8 @@ public:
 	    OpenGL has a rediculously small max point-sprite size, which typically is 64 pixels.
 	    Therefore particles close to the viewpoint cannot be drawn as a point-sprite.
 	    The idea of maxZ is for using point-sprite for far-away particles and use triangles for closer particles.
+
+	    Like MakeBufferForPointSprite, the particles closer than maxZ are a trailing range of the order.
 	*/
 	void MakeBufferForTriangle(const YsVec3 &viewDir,const float spriteTexCoordRange,double maxZ);
 };
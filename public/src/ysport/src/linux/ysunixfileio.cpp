@@ -34,6 +34,8 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <unistd.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/mman.h>
+#include <fcntl.h>
 
 const char *YsFileIO::Getcwd(YsString &cwd)
 {
@@ -115,6 +117,18 @@ YSRESULT YsFileIO::Remove(const char fn[])
 	return YSERR;
 }
 
+YSRESULT YsFileIO::Rename(const wchar_t oldFn[],const wchar_t newFn[])
+{
+	YsString oldFnUTF8,newFnUTF8;
+	oldFnUTF8.EncodeUTF8 <wchar_t> (oldFn);
+	newFnUTF8.EncodeUTF8 <wchar_t> (newFn);
+	if(0==rename(oldFnUTF8,newFnUTF8))
+	{
+		return YSOK;
+	}
+	return YSERR;
+}
+
 /* static */ YsWString YsFileIO::GetRealPath(const wchar_t fn[])
 {
 	YsWString wstr(fn);
@@ -127,3 +141,48 @@ YSRESULT YsFileIO::Remove(const char fn[])
 	}
 	return wstr;
 }
+
+/* static */ YSRESULT YsFileIO::GetFileSizeAndTime(long long int &size,long long int &modifiedTime,const wchar_t fn[])
+{
+	YsString fnUTF8;
+	fnUTF8.EncodeUTF8 <wchar_t> (fn);
+
+	struct stat st;
+	if(0==stat(fnUTF8,&st))
+	{
+		size=st.st_size;
+		modifiedTime=st.st_mtime;
+		return YSOK;
+	}
+	return YSERR;
+}
+
+YSRESULT YsFileIO::MappedFile::MapPlatform(const wchar_t fn[])
+{
+	YsString fnUTF8;
+	fnUTF8.EncodeUTF8 <wchar_t> (fn);
+
+	int fd=open(fnUTF8,O_RDONLY);
+	if(0<=fd)
+	{
+		struct stat st;
+		if(0==fstat(fd,&st) && 0<st.st_size)
+		{
+			void *ptr=mmap(nullptr,st.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+			if(MAP_FAILED!=ptr)
+			{
+				close(fd);  // Mapping stays valid after the file descriptor is closed.
+				dat=(const unsigned char *)ptr;
+				length=st.st_size;
+				return YSOK;
+			}
+		}
+		close(fd);
+	}
+	return YSERR;
+}
+
+void YsFileIO::MappedFile::UnmapPlatform(void)
+{
+	munmap((void *)dat,length);
+}
@@ -30,6 +30,9 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "../ysfileio.h"
 
 #include <direct.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <windows.h>
 
 const char *YsFileIO::Getcwd(YsString &cwd)
 {
@@ -113,8 +116,40 @@ YSRESULT YsFileIO::Remove(const char fn[])
 	return YSERR;
 }
 
+YSRESULT YsFileIO::Rename(const wchar_t oldFn[],const wchar_t newFn[])
+{
+	// _wrename fails if newFn exists.
+	if(0!=MoveFileExW(oldFn,newFn,MOVEFILE_REPLACE_EXISTING))
+	{
+		return YSOK;
+	}
+	return YSERR;
+}
+
 /* static */ YsWString YsFileIO::GetRealPath(const wchar_t fn[])
 {
 	// Sorry, I cannot find the right way to do it.  I just return unchanged.
 	return YsWString(fn);
 }
+
+/* static */ YSRESULT YsFileIO::GetFileSizeAndTime(long long int &size,long long int &modifiedTime,const wchar_t fn[])
+{
+	struct _stat64 st;
+	if(0==_wstat64(fn,&st))
+	{
+		size=st.st_size;
+		modifiedTime=st.st_mtime;
+		return YSOK;
+	}
+	return YSERR;
+}
+
+YSRESULT YsFileIO::MappedFile::MapPlatform(const wchar_t [])
+{
+	// Read in a buffer instead.
+	return YSERR;
+}
+
+void YsFileIO::MappedFile::UnmapPlatform(void)
+{
+}
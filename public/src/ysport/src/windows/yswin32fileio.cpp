@@ -115,6 +115,16 @@ YSRESULT YsFileIO::Remove(const char fn[])
 
 #include <windows.h>
 
+YSRESULT YsFileIO::Rename(const wchar_t oldFn[],const wchar_t newFn[])
+{
+	// _wrename fails if newFn exists.
+	if(0!=MoveFileExW(oldFn,newFn,MOVEFILE_REPLACE_EXISTING))
+	{
+		return YSOK;
+	}
+	return YSERR;
+}
+
 /* static */ YsWString YsFileIO::GetRealPath(const wchar_t fn[])
 {
 	wchar_t buf[MAX_PATH];
@@ -124,3 +134,50 @@ YSRESULT YsFileIO::Remove(const char fn[])
 	}
 	return YsWString(fn);
 }
+
+/* static */ YSRESULT YsFileIO::GetFileSizeAndTime(long long int &size,long long int &modifiedTime,const wchar_t fn[])
+{
+	WIN32_FILE_ATTRIBUTE_DATA attrib;
+	if(0!=GetFileAttributesExW(fn,GetFileExInfoStandard,&attrib))
+	{
+		size=((long long int)attrib.nFileSizeHigh<<32)|(long long int)attrib.nFileSizeLow;
+		modifiedTime=((long long int)attrib.ftLastWriteTime.dwHighDateTime<<32)|(long long int)attrib.ftLastWriteTime.dwLowDateTime;
+		return YSOK;
+	}
+	return YSERR;
+}
+
+YSRESULT YsFileIO::MappedFile::MapPlatform(const wchar_t fn[])
+{
+	HANDLE hFile=CreateFileW(fn,GENERIC_READ,FILE_SHARE_READ,nullptr,OPEN_EXISTING,FILE_ATTRIBUTE_NORMAL,nullptr);
+	if(INVALID_HANDLE_VALUE!=hFile)
+	{
+		LARGE_INTEGER fileSize;
+		if(0!=GetFileSizeEx(hFile,&fileSize) && 0<fileSize.QuadPart)
+		{
+			HANDLE hMap=CreateFileMappingW(hFile,nullptr,PAGE_READONLY,0,0,nullptr);
+			if(nullptr!=hMap)
+			{
+				void *ptr=MapViewOfFile(hMap,FILE_MAP_READ,0,0,0);
+				if(nullptr!=ptr)
+				{
+					dat=(const unsigned char *)ptr;
+					length=fileSize.QuadPart;
+					fileHandle=hFile;
+					mappingHandle=hMap;
+					return YSOK;
+				}
+				CloseHandle(hMap);
+			}
+		}
+		CloseHandle(hFile);
+	}
+	return YSERR;
+}
+
+void YsFileIO::MappedFile::UnmapPlatform(void)
+{
+	UnmapViewOfFile(dat);
+	CloseHandle((HANDLE)mappingHandle);
+	CloseHandle((HANDLE)fileHandle);
+}
@@ -201,3 +201,127 @@ YSRESULT YsFileIO::File::WriteText(const YsConstArrayMask <YsString> txt)
 	}
 	return YSERR;
 }
+
+////////////////////////////////////////////////////////////
+
+YsFileIO::MappedFile::MappedFile()
+{
+	dat=nullptr;
+	length=0;
+	mapped=YSFALSE;
+	opened=YSFALSE;
+	fileHandle=nullptr;
+	mappingHandle=nullptr;
+}
+
+void YsFileIO::MappedFile::MoveFrom(MappedFile &incoming)
+{
+	if(this!=&incoming)
+	{
+		Close();
+		dat=incoming.dat;
+		length=incoming.length;
+		mapped=incoming.mapped;
+		fileHandle=incoming.fileHandle;
+		mappingHandle=incoming.mappingHandle;
+		opened=incoming.opened;
+		buf.MoveFrom(incoming.buf);
+		if(YSTRUE!=mapped)
+		{
+			dat=buf.data();
+		}
+
+		incoming.dat=nullptr;
+		incoming.opened=YSFALSE;
+		incoming.length=0;
+		incoming.mapped=YSFALSE;
+		incoming.fileHandle=nullptr;
+		incoming.mappingHandle=nullptr;
+	}
+}
+
+YsFileIO::MappedFile::MappedFile(MappedFile &&incoming)
+{
+	dat=nullptr;
+	length=0;
+	mapped=YSFALSE;
+	opened=YSFALSE;
+	fileHandle=nullptr;
+	mappingHandle=nullptr;
+	MoveFrom(incoming);
+}
+
+YsFileIO::MappedFile &YsFileIO::MappedFile::operator=(MappedFile &&incoming)
+{
+	MoveFrom(incoming);
+	return *this;
+}
+
+YsFileIO::MappedFile::~MappedFile()
+{
+	Close();
+}
+
+YSRESULT YsFileIO::MappedFile::Open(const wchar_t fn[])
+{
+	Close();
+	if(YSOK==MapPlatform(fn))
+	{
+		mapped=YSTRUE;
+		opened=YSTRUE;
+		return YSOK;
+	}
+
+	File fp(fn,"rb");
+	if(nullptr!=fp)
+	{
+		buf=fp.Fread();
+		dat=buf.data();
+		length=buf.size();
+		opened=YSTRUE;
+		return YSOK;
+	}
+	return YSERR;
+}
+
+YSRESULT YsFileIO::MappedFile::Open(const char fn[])
+{
+	YsWString wfn;
+	wfn.SetUTF8String(fn);
+	return Open(wfn);
+}
+
+void YsFileIO::MappedFile::Close(void)
+{
+	if(YSTRUE==mapped)
+	{
+		UnmapPlatform();
+	}
+	dat=nullptr;
+	length=0;
+	mapped=YSFALSE;
+	opened=YSFALSE;
+	fileHandle=nullptr;
+	mappingHandle=nullptr;
+	buf.ClearDeep();
+}
+
+YSBOOL YsFileIO::MappedFile::IsOpen(void) const
+{
+	return opened;
+}
+
+YSBOOL YsFileIO::MappedFile::IsMapped(void) const
+{
+	return mapped;
+}
+
+const unsigned char *YsFileIO::MappedFile::data(void) const
+{
+	return dat;
+}
+
+long long int YsFileIO::MappedFile::size(void) const
+{
+	return length;
+}
@@ -124,6 +124,11 @@ public:
 	static YSRESULT Remove(const wchar_t fn[]);
 	static YSRESULT Remove(const char fn[]);
 
+	/*! Rename a file.  If a file named newFn exists, it is replaced.
+	    The replacement is atomic if the two files are in the same directory of a local file system.
+	*/
+	static YSRESULT Rename(const wchar_t oldFn[],const wchar_t newFn[]);
+
 	/*! Returns YSTRUE if the file exists, YSFALSE otherwise.
 	*/
 	static YSBOOL CheckFileExist(const wchar_t fn[]);
@@ -136,6 +141,12 @@ public:
 	*/
 	static YsWString GetRealPath(const wchar_t fn[]);
 
+	/*! Returns the size in bytes and the last-modified time of the file.
+	    The time is in seconds since the epoch in Unix-based systems, and in 100-nanosecond units of FILETIME in Windows.
+	    It is meant to be compared with a value taken by the same function, not to be converted to a calendar date.
+	*/
+	static YSRESULT GetFileSizeAndTime(long long int &size,long long int &modifiedTime,const wchar_t fn[]);
+
 	/*! This class covers FILE pointer of C-standard library.
 	    This class owns a file pointer, which is closed in the destructor.
 	    Therefore, copy is not allowed.  However, moving is allowed.
@@ -244,6 +255,62 @@ public:
 		/*! Writes an array of YsStrings. */
 		YSRESULT WriteText(const YsConstArrayMask <YsString> txt);
 	};
+
+	/*! This class maps a whole file in the memory for reading.
+	    It uses mmap in Unix-based systems and MapViewOfFile in Windows.  If the file cannot be mapped,
+	    it reads the whole file in a buffer instead, so that the using program does not have to care.
+
+	    Like File, copy is not allowed.  However, moving is allowed.
+	 */
+	class MappedFile
+	{
+	private:
+		const unsigned char *dat;
+		long long int length;
+		YSBOOL mapped,opened;
+		void *fileHandle,*mappingHandle;   // Used only in Windows.
+		YsArray <unsigned char> buf;       // Used if the file cannot be mapped.
+
+		MappedFile(const MappedFile &);
+		MappedFile &operator=(const MappedFile &);
+		void MoveFrom(MappedFile &incoming);
+
+		// Platform-dependent part.
+		YSRESULT MapPlatform(const wchar_t fn[]);
+		void UnmapPlatform(void);
+
+	public:
+		/*! Default constructor. */
+		MappedFile();
+
+		/*! Move constructor. */
+		MappedFile(MappedFile &&incoming);
+
+		/*! Move operator. */
+		MappedFile &operator=(MappedFile &&incoming);
+
+		/*! Destructor.  It automatically unmaps the file. */
+		~MappedFile();
+
+		/*! Maps a file.  If a file is already mapped, it is unmapped first. */
+		YSRESULT Open(const wchar_t fn[]);
+		YSRESULT Open(const char fn[]);
+
+		/*! Unmaps the file. */
+		void Close(void);
+
+		/*! Returns YSTRUE if a file is open. */
+		YSBOOL IsOpen(void) const;
+
+		/*! Returns YSTRUE if the file is actually mapped rather than read in a buffer. */
+		YSBOOL IsMapped(void) const;
+
+		/*! Returns a pointer to the top of the file contents. */
+		const unsigned char *data(void) const;
+
+		/*! Returns the size of the file in bytes. */
+		long long int size(void) const;
+	};
 };
 
 inline bool operator==(std::nullptr_t,const YsFileIO::File &fp)
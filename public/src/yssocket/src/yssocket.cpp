@@ -24,6 +24,8 @@ typedef int socklen_t;
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <sys/poll.h>
+#include <fcntl.h>
+#include <errno.h>
 typedef int SOCKET;
 typedef struct sockaddr SOCKADDR;
 typedef struct sockaddr_in SOCKADDR_IN;
@@ -33,6 +35,109 @@ typedef struct sockaddr_in SOCKADDR_IN;
 
 #include "yssocket.h"
 
+#ifdef YSSOCKET_USE_EPOLL
+#include <sys/epoll.h>
+
+// Outgoing data of one client.  Data is appended at the tail and sent from the head.
+class YsSocketServer::SendRingBuffer
+{
+private:
+	unsigned char *buf;
+	YSSIZE_T capacity,head,nFilled;
+
+public:
+	YSBOOL watchingWritable;
+
+	SendRingBuffer()
+	{
+		buf=nullptr;
+		capacity=0;
+		head=0;
+		nFilled=0;
+	}
+	~SendRingBuffer()
+	{
+		delete [] buf;
+	}
+	void Allocate(YSSIZE_T newCapacity)
+	{
+		if(newCapacity!=capacity)
+		{
+			delete [] buf;
+			buf=new unsigned char [newCapacity];
+			capacity=newCapacity;
+		}
+		Clear();
+	}
+	void Clear(void)
+	{
+		head=0;
+		nFilled=0;
+		watchingWritable=YSFALSE;
+	}
+	YSSIZE_T GetN(void) const
+	{
+		return nFilled;
+	}
+	YSBOOL CanTake(YSSIZE_T nBytes) const
+	{
+		return (nFilled+nBytes<=capacity ? YSTRUE : YSFALSE);
+	}
+
+	/*! Caller must make sure CanTake(nBytes) is YSTRUE. */
+	void Append(YSSIZE_T nBytes,const unsigned char dat[])
+	{
+		YSSIZE_T tail=(head+nFilled)%capacity;
+		YSSIZE_T nFirst=capacity-tail;
+		if(nBytes<nFirst)
+		{
+			nFirst=nBytes;
+		}
+		memcpy(buf+tail,dat,nFirst);
+		memcpy(buf,dat+nFirst,nBytes-nFirst);
+		nFilled+=nBytes;
+	}
+
+	/*! Sends as much as the socket takes without blocking.
+	    Returns YSERR if the connection is broken. */
+	YSRESULT SendTo(SOCKET sock)
+	{
+		while(0<nFilled)
+		{
+			YSSIZE_T nContiguous=capacity-head;
+			if(nFilled<nContiguous)
+			{
+				nContiguous=nFilled;
+			}
+
+			auto nSent=send(sock,(char *)buf+head,nContiguous,MSG_NOSIGNAL|MSG_DONTWAIT);
+			if(0<nSent)
+			{
+				head=(head+nSent)%capacity;
+				nFilled-=nSent;
+			}
+			else if(0>nSent && EINTR==errno)
+			{
+				continue;
+			}
+			else if(0>nSent && (EAGAIN==errno || EWOULDBLOCK==errno))
+			{
+				break;
+			}
+			else
+			{
+				return YSERR;
+			}
+		}
+		if(0==nFilled)
+		{
+			head=0;
+		}
+		return YSOK;
+	}
+};
+#endif
+
 
 YsSocketServer::YsSocketServer(int listen,int maxNumCli)
 {
@@ -46,6 +151,12 @@ YsSocketServer::YsSocketServer(int listen,int maxNumCli)
 	clientSockUsed=new YSBOOL [maxNumCli];
 	clientReady=new YSBOOL [maxNumCli];
 
+	sendBufferSize=DEFAULT_SEND_BUFFER_SIZE;
+#ifdef YSSOCKET_USE_EPOLL
+	epollFd=-1;
+	sendBuf=new SendRingBuffer [maxNumCli];
+#endif
+
 	int i;
 	for(i=0; i<maxNumCli; i++)
 	{
@@ -64,6 +175,9 @@ YsSocketServer::~YsSocketServer()
 	delete [] clientSock;
 	delete [] clientSockUsed;
 	delete [] clientReady;
+#ifdef YSSOCKET_USE_EPOLL
+	delete [] sendBuf;
+#endif
 }
 
 
@@ -126,6 +240,16 @@ YSRESULT YsSocketServer::Start(void)
 			return YSERR;
 		}
 
+#ifdef YSSOCKET_USE_EPOLL
+		epollFd=epoll_create1(EPOLL_CLOEXEC);
+		if(0>epollFd)
+		{
+			close(listeningSocket);
+			printf("Error occured in epoll_create1()\n");
+			return YSERR;
+		}
+#endif
+
 		int i;
 		for(i=0; i<maxNumClient; i++)
 		{
@@ -158,6 +282,11 @@ YSRESULT YsSocketServer::Terminate(void)
 		close(listeningSocket);
 #endif
 
+#ifdef YSSOCKET_USE_EPOLL
+		close(epollFd);
+		epollFd=-1;
+#endif
+
 		started=YSFALSE;
 		return YSOK;
 	}
@@ -252,6 +381,23 @@ YSRESULT YsSocketServer::CheckAndAcceptConnection(void)
 						printf("Cannot retrieve Send Time Out\n");
 					}
 
+				#ifdef YSSOCKET_USE_EPOLL
+					fcntl(clientSock[i],F_SETFL,fcntl(clientSock[i],F_GETFL,0)|O_NONBLOCK);
+					sendBuf[i].Allocate(sendBufferSize);
+
+					struct epoll_event ev;
+					ev.events=EPOLLIN;
+					ev.data.u64=0;
+					ev.data.u32=i;
+					if(0!=epoll_ctl(epollFd,EPOLL_CTL_ADD,clientSock[i],&ev))
+					{
+						printf("Error occured in epoll_ctl()\n");
+						close(clientSock[i]);
+						clientSockUsed[i]=YSFALSE;
+						return YSERR;
+					}
+				#endif
+
 
 					ConnectionAccepted(i,ipAddr);
 					return YSOK;
@@ -262,6 +408,7 @@ YSRESULT YsSocketServer::CheckAndAcceptConnection(void)
 	return YSERR;
 }
 
+#ifndef YSSOCKET_USE_EPOLL
 YSRESULT YsSocketServer::CheckReceive(void)
 {
 	int byteReceived;
@@ -320,6 +467,81 @@ YSRESULT YsSocketServer::CheckReceive(void)
 	}
 	return YSOK;
 }
+#else
+YSRESULT YsSocketServer::CheckReceive(void)
+{
+	if(YSTRUE!=started)
+	{
+		return YSERR;
+	}
+
+	// One epoll_wait takes care of all readable and writable sockets.
+	enum
+	{
+		MAX_NUM_EVENT=64
+	};
+	struct epoll_event ev[MAX_NUM_EVENT];
+	for(;;)
+	{
+		int nEv=epoll_wait(epollFd,ev,MAX_NUM_EVENT,0);
+		if(0>nEv && EINTR==errno)
+		{
+			continue;
+		}
+
+		for(int evIdx=0; evIdx<nEv; ++evIdx)
+		{
+			const int i=(int)ev[evIdx].data.u32;
+
+			// ReceivedFrom may disconnect a client.
+			if(0<=i && i<maxNumClient && YSTRUE==clientSockUsed[i] && 0!=(ev[evIdx].events&EPOLLOUT))
+			{
+				if(YSOK!=FlushSendBuffer(i))
+				{
+					CloseClientSocket(i);
+					ConnectionClosedByClient(i);
+				}
+			}
+
+			if(0<=i && i<maxNumClient && YSTRUE==clientSockUsed[i] && 0!=(ev[evIdx].events&(EPOLLIN|EPOLLHUP|EPOLLERR)))
+			{
+				for(;;)
+				{
+					auto byteReceived=recv(clientSock[i],(char *)buffer,nBufferSize,0);
+					if(0<byteReceived)
+					{
+						ReceivedFrom(i,byteReceived,buffer);
+						if(YSTRUE!=clientSockUsed[i])
+						{
+							break;
+						}
+					}
+					else if(0>byteReceived && EINTR==errno)
+					{
+						continue;
+					}
+					else if(0>byteReceived && (EAGAIN==errno || EWOULDBLOCK==errno))
+					{
+						break;
+					}
+					else
+					{
+						CloseClientSocket(i);
+						ConnectionClosedByClient(i);
+						break;
+					}
+				}
+			}
+		}
+
+		if(nEv<MAX_NUM_EVENT)
+		{
+			break;
+		}
+	}
+	return YSOK;
+}
+#endif
 
 
 int YsSocketServer::GetNumClient(void) const
@@ -355,6 +577,12 @@ YSRESULT YsSocketServer::Disconnect(int clientId)   /* clientId=-1 to close all
 	{
 #ifdef _WIN32
 		closesocket(clientSock[clientId]);
+#elif defined(YSSOCKET_USE_EPOLL)
+		// Hand whatever the socket takes right now (typically a terminate message) to the kernel, and close without
+		// waiting.  The kernel still delivers what it has taken after close.  What did not fit is dropped.
+		FlushSendBuffer(clientId);
+		shutdown(clientSock[clientId],SHUT_WR);
+		CloseClientSocket(clientId);
 #else
 		close(clientSock[clientId]);
 #endif
@@ -365,6 +593,7 @@ YSRESULT YsSocketServer::Disconnect(int clientId)   /* clientId=-1 to close all
 	return YSERR;
 }
 
+#ifndef YSSOCKET_USE_EPOLL
 YSRESULT YsSocketServer::Send(int clientId,YSSIZE_T nBytes,unsigned char dat[],unsigned timeout)
       /* clientId=-1 to broadcast */
 {
@@ -453,6 +682,90 @@ YSRESULT YsSocketServer::Send(int clientId,YSSIZE_T nBytes,unsigned char dat[],u
 	}
 	return YSERR;
 }
+#else
+YSRESULT YsSocketServer::Send(int clientId,YSSIZE_T nBytes,unsigned char dat[],unsigned)
+      /* clientId=-1 to broadcast */
+{
+	if(0<=clientId && clientId<maxNumClient && clientSockUsed[clientId]==YSTRUE)
+	{
+		if(YSTRUE!=sendBuf[clientId].CanTake(nBytes))
+		{
+			// Make room if the socket can take some now.
+			if(YSOK!=FlushSendBuffer(clientId) || YSTRUE!=sendBuf[clientId].CanTake(nBytes))
+			{
+				return YSERR;
+			}
+		}
+		sendBuf[clientId].Append(nBytes,dat);
+		FlushSendBuffer(clientId);  // Broken connection will be detected in CheckReceive.
+		return YSOK;
+	}
+	else if(clientId<0)
+	{
+		YSRESULT res=YSOK;
+		for(int i=0; i<maxNumClient; i++)
+		{
+			if(clientSockUsed[i]==YSTRUE && YSOK!=Send(i,nBytes,dat,0))
+			{
+				res=YSERR;
+			}
+		}
+		return res;
+	}
+	return YSERR;
+}
+
+YSRESULT YsSocketServer::FlushSendBuffer(int clientId)
+{
+	const YSRESULT res=sendBuf[clientId].SendTo(clientSock[clientId]);
+	const YSBOOL pending=(0<sendBuf[clientId].GetN() ? YSTRUE : YSFALSE);
+	if(YSOK==res && pending!=sendBuf[clientId].watchingWritable)
+	{
+		UpdateEpollEvent(clientId);
+	}
+	return res;
+}
+
+void YsSocketServer::UpdateEpollEvent(int clientId)
+{
+	// Watch writability only while something is waiting.  Otherwise epoll_wait returns immediately every time.
+	struct epoll_event ev;
+	ev.events=EPOLLIN;
+	sendBuf[clientId].watchingWritable=YSFALSE;
+	if(0<sendBuf[clientId].GetN())
+	{
+		ev.events|=EPOLLOUT;
+		sendBuf[clientId].watchingWritable=YSTRUE;
+	}
+	ev.data.u64=0;
+	ev.data.u32=clientId;
+	epoll_ctl(epollFd,EPOLL_CTL_MOD,clientSock[clientId],&ev);
+}
+
+void YsSocketServer::CloseClientSocket(int clientId)
+{
+	epoll_ctl(epollFd,EPOLL_CTL_DEL,clientSock[clientId],NULL);
+	close(clientSock[clientId]);
+	clientSockUsed[clientId]=YSFALSE;
+	sendBuf[clientId].Clear();
+}
+#endif
+
+void YsSocketServer::SetSendBufferSize(YSSIZE_T nBytes)
+{
+	sendBufferSize=nBytes;
+}
+
+YSSIZE_T YsSocketServer::GetNumPendingByte(int clientId) const
+{
+#ifdef YSSOCKET_USE_EPOLL
+	if(0<=clientId && clientId<maxNumClient && clientSockUsed[clientId]==YSTRUE)
+	{
+		return sendBuf[clientId].GetN();
+	}
+#endif
+	return 0;
+}
 
 // YSRESULT YsSocketServer::ReceivedFrom(int clientId,YSSIZE_T nBytes,unsigned char dat[])
 // {
@@ -100,6 +100,11 @@ inline YSBOOL YsXor(YSBOOL a,YSBOOL b)
 	typedef int SOCKET;
 #endif
 
+// Linux server uses non-blocking sockets with epoll.  Define YSSOCKET_NO_EPOLL to use the poll-and-blocking-send backend.
+#if defined(__linux__) && !defined(YSSOCKET_NO_EPOLL)
+	#define YSSOCKET_USE_EPOLL
+#endif
+
 
 class YsSocket
 {
@@ -134,12 +139,25 @@ public:
 
 	YSRESULT Disconnect(int clientId);   /* clientId=-1 to close all connections */
 
+	/*! Sends data to the client.
+	    With the epoll backend, the data is copied to the outgoing buffer of the client, and is sent as much as the socket accepts now.
+	    The rest is sent when the socket becomes writable in CheckReceive.  It never waits for a slow client.
+	    Returns YSERR without taking any of the data if the outgoing buffer does not have enough space.
+	    With the other backend, it waits for the socket to be writable and then sends the data. */
 	YSRESULT Send(int clientId,YSSIZE_T nBytes,unsigned char dat[],unsigned timeout);   /* clientId=-1 to broadcast */
 	virtual YSRESULT ReceivedFrom(int clientId,YSSIZE_T nBytes,unsigned char dat[])=0;
 	virtual YSRESULT SendTerminateMessage(int clientId,unsigned timeout);
 	virtual YSRESULT ConnectionAccepted(int clientId,unsigned int ipAddr[4]);
 	virtual YSRESULT ConnectionClosedByClient(int clientId);
 
+	/*! Sets the size of the outgoing buffer of each client.  Effective for the clients that connect after this call.
+	    Meaningful only with the epoll backend. */
+	void SetSendBufferSize(YSSIZE_T nBytes);
+
+	/*! Returns the number of bytes that are accepted by Send, but not sent to the socket yet.
+	    Always zero with the backend other than epoll. */
+	YSSIZE_T GetNumPendingByte(int clientId) const;
+
 protected:
 	SOCKET GetClientSocket(int clientId);
 
@@ -153,6 +171,22 @@ protected:
 	YSBOOL *clientReady;
 	SOCKET listeningSocket;
 	SOCKET *clientSock;
+
+	enum
+	{
+		DEFAULT_SEND_BUFFER_SIZE=256*1024
+	};
+	YSSIZE_T sendBufferSize;
+
+#ifdef YSSOCKET_USE_EPOLL
+	class SendRingBuffer;
+	int epollFd;
+	SendRingBuffer *sendBuf;
+
+	YSRESULT FlushSendBuffer(int clientId);
+	void UpdateEpollEvent(int clientId);
+	void CloseClientSocket(int clientId);
+#endif
 };
 
 ////////////////////////////////////////////////////////////
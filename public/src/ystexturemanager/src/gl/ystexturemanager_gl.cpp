@@ -220,13 +220,11 @@ YSRESULT YsTextureManager::Unit::Bind(int texIdent) const
 
 	YSRESULT res=YSERR;
 
-	if(YSTRUE!=IsActualTextureReady())
+	// May be the placeholder texture while the texture is in the decode queue.
+	auto bindTexPtr=GetTextureToBind();
+	if(nullptr!=bindTexPtr)
 	{
-		MakeActualTexture();
-	}
-	if(YSTRUE==IsActualTextureReady())
-	{
-		glBindTexture(GL_TEXTURE_2D,GetActualTexture()->texId);
+		glBindTexture(GL_TEXTURE_2D,bindTexPtr->texId);
 
 	#ifdef GL_TEXTURE_ENV
 		glTexEnvi(GL_TEXTURE_ENV,GL_TEXTURE_ENV_MODE,GL_MODULATE);
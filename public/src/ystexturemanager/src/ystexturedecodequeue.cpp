@@ -0,0 +1,329 @@
+/* ////////////////////////////////////////////////////////////
+
+File Name: ystexturedecodequeue.cpp
+Copyright (c) 2017 Soji Yamakawa.  All rights reserved.
+http://www.ysflight.com
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, 
+   this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, 
+   this list of conditions and the following disclaimer in the documentation 
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR 
+PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) 
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+//////////////////////////////////////////////////////////// */
+
+
+#include "ystexturedecodequeue.h"
+#include <yspng.h>
+
+
+YsTextureDecodeJob::YsTextureDecodeJob()
+{
+	queuePtr=nullptr;
+	unitPtr=nullptr;
+	fileDataLength=0;
+	fileData=nullptr;
+	useTransparentColor=YSFALSE;
+	transparentColor.SetIntRGBA(0,0,0,0);
+	effectType=YsTextureManager::Unit::EFFECT_NONE;
+	randomNoiseLevel=0.0;
+	randomNoiseSeed=0;
+	res=YSERR;
+	wid=0;
+	hei=0;
+	rgba=nullptr;
+}
+
+YsTextureDecodeJob::~YsTextureDecodeJob()
+{
+	if(nullptr!=rgba)
+	{
+		delete [] rgba;
+	}
+}
+
+void YsTextureDecodeJob::CopyFileData(void)
+{
+	fileDataCopy.Set(fileDataLength,fileData);
+	fileData=fileDataCopy;
+}
+
+void YsTextureDecodeJob::Decode(void)
+{
+	res=YSERR;
+
+	YsPngBinaryMemoryStream inStream(fileDataLength,fileData);
+	YsRawPngDecoder png;
+	if(YSOK!=(YSRESULT)png.Decode(inStream) || nullptr==png.rgba)
+	{
+		return;
+	}
+
+	// Take the bitmap from the decoder.
+	wid=png.wid;
+	hei=png.hei;
+	rgba=png.rgba;
+	png.rgba=nullptr;
+
+	if(YSTRUE==useTransparentColor)
+	{
+		int tr=transparentColor.Ri();
+		int tg=transparentColor.Gi();
+		int tb=transparentColor.Bi();
+		for(long long int i=0; i<(long long int)wid*hei*4; i+=4)
+		{
+			if(rgba[i  ]==tr &&
+			   rgba[i+1]==tg &&
+			   rgba[i+2]==tb)
+			{
+				rgba[i+3]=0;
+			}
+		}
+	}
+
+	switch(effectType)
+	{
+	default:
+		break;
+	case YsTextureManager::Unit::EFFECT_RANDOMNOISE:
+		YsTextureManager::Unit::ApplyRandomNoise(wid,hei,rgba,randomNoiseLevel,randomNoiseSeed);
+		break;
+	case YsTextureManager::Unit::EFFECT_ALPHAMASK_MAXRGB:
+		YsTextureManager::Unit::MakeAlphaMaskMaxValue(wid,hei,rgba);
+		break;
+	case YsTextureManager::Unit::EFFECT_ALPHA_FROM_MAXRGB:
+		YsTextureManager::Unit::AlphaFromMaxRGB(wid,hei,rgba);
+		break;
+	}
+	res=YSOK;
+}
+
+////////////////////////////////////////////////////////////
+
+YsTextureDecodeQueue::Statistics::Statistics()
+{
+	nWaiting=0;
+	nDecoding=0;
+	nStaged=0;
+	nDecoded=0;
+	nUploaded=0;
+	nUploadedByte=0;
+	totalDecodeLatency=0.0;
+	maxDecodeLatency=0.0;
+}
+
+YsTextureDecodeQueue::YsTextureDecodeQueue(int nThread,long long int maxNumStaged) : scheduler(nThread),group(scheduler)
+{
+	nDecoding=0;
+	this->maxNumStaged=(1<=maxNumStaged ? maxNumStaged : 1);
+}
+
+YsTextureDecodeQueue::~YsTextureDecodeQueue()
+{
+	{
+		std::lock_guard <std::mutex> lock(mutex);
+		for(auto job : waiting)
+		{
+			staged.push_back(job);
+		}
+		waiting.clear();
+	}
+
+	group.Wait();
+
+	for(auto job : staged)
+	{
+		if(nullptr!=job->unitPtr)
+		{
+			job->unitPtr->decodeJob=nullptr;
+		}
+		delete job;
+	}
+	staged.clear();
+}
+
+void YsTextureDecodeQueue::SetMaxNumStaged(long long int maxNumStaged)
+{
+	{
+		std::lock_guard <std::mutex> lock(mutex);
+		this->maxNumStaged=(1<=maxNumStaged ? maxNumStaged : 1);
+	}
+	Dispatch();
+}
+
+YSRESULT YsTextureDecodeQueue::Request(const YsTextureManager::Unit *unitPtr)
+{
+	if(nullptr==unitPtr)
+	{
+		return YSERR;
+	}
+	if(nullptr!=unitPtr->decodeJob)
+	{
+		if(this==unitPtr->decodeJob->queuePtr)
+		{
+			return YSOK;
+		}
+		unitPtr->decodeJob->queuePtr->Cancel(unitPtr);
+	}
+	if(0!=(unitPtr->flags&YsTextureManager::Unit::FLAG_RENDERTARGET) || YsTextureManager::FOM_PNG!=unitPtr->fType)
+	{
+		return YSERR;
+	}
+
+	auto job=new YsTextureDecodeJob;
+	unitPtr->SetUpDecodeJob(*job);
+	job->CopyFileData();
+	job->queuePtr=this;
+	job->unitPtr=unitPtr;
+	job->requestTime=std::chrono::steady_clock::now();
+	unitPtr->decodeJob=job;
+
+	{
+		std::lock_guard <std::mutex> lock(mutex);
+		waiting.push_back(job);
+	}
+	Dispatch();
+	return YSOK;
+}
+
+void YsTextureDecodeQueue::Cancel(const YsTextureManager::Unit *unitPtr)
+{
+	if(nullptr!=unitPtr && nullptr!=unitPtr->decodeJob && this==unitPtr->decodeJob->queuePtr)
+	{
+		// The job itself is deleted when it comes out of the waiting or the staged queue.
+		std::lock_guard <std::mutex> lock(mutex);
+		unitPtr->decodeJob->unitPtr=nullptr;
+		unitPtr->decodeJob=nullptr;
+	}
+}
+
+void YsTextureDecodeQueue::Dispatch(void)
+{
+	std::vector <YsTextureDecodeJob *> toRun;
+	{
+		std::lock_guard <std::mutex> lock(mutex);
+		while(0<waiting.size() && nDecoding+(long long int)staged.size()<maxNumStaged)
+		{
+			auto job=waiting.front();
+			waiting.pop_front();
+			if(nullptr==job->unitPtr)
+			{
+				delete job;
+				continue;
+			}
+			++nDecoding;
+			toRun.push_back(job);
+		}
+	}
+	for(auto job : toRun)
+	{
+		group.Run([this,job](){DecodeInWorker(job);});
+	}
+}
+
+void YsTextureDecodeQueue::DecodeInWorker(YsTextureDecodeJob *job)
+{
+	bool cancelled;
+	{
+		std::lock_guard <std::mutex> lock(mutex);
+		cancelled=(nullptr==job->unitPtr);
+	}
+	if(true!=cancelled)
+	{
+		job->Decode();
+	}
+
+	const double latency=std::chrono::duration <double> (std::chrono::steady_clock::now()-job->requestTime).count();
+
+	std::lock_guard <std::mutex> lock(mutex);
+	--nDecoding;
+	staged.push_back(job);
+	if(true!=cancelled)
+	{
+		++stat.nDecoded;
+		stat.totalDecodeLatency+=latency;
+		if(stat.maxDecodeLatency<latency)
+		{
+			stat.maxDecodeLatency=latency;
+		}
+	}
+}
+
+long long int YsTextureDecodeQueue::Upload(long long int byteBudget)
+{
+	long long int nUploaded=0,nUploadedByte=0;
+	for(;;)
+	{
+		YsTextureDecodeJob *job=nullptr;
+		const YsTextureManager::Unit *unitPtr=nullptr;
+		{
+			std::lock_guard <std::mutex> lock(mutex);
+			if(0==staged.size() || (0<nUploaded && byteBudget<=nUploadedByte))
+			{
+				break;
+			}
+			job=staged.front();
+			staged.pop_front();
+			unitPtr=job->unitPtr;
+		}
+
+		if(nullptr!=unitPtr)
+		{
+			unitPtr->ReceiveDecodeJob(*job);
+			++nUploaded;
+			nUploadedByte+=(long long int)job->wid*job->hei*4;
+		}
+		delete job;
+	}
+
+	{
+		std::lock_guard <std::mutex> lock(mutex);
+		stat.nUploaded+=nUploaded;
+		stat.nUploadedByte+=nUploadedByte;
+	}
+
+	Dispatch();
+	return nUploaded;
+}
+
+void YsTextureDecodeQueue::WaitDecode(void)
+{
+	for(;;)
+	{
+		group.Wait();
+
+		{
+			std::lock_guard <std::mutex> lock(mutex);
+			if(0==waiting.size() || maxNumStaged<=(long long int)staged.size())
+			{
+				break;
+			}
+		}
+		Dispatch();
+	}
+}
+
+YsTextureDecodeQueue::Statistics YsTextureDecodeQueue::GetStatistics(void) const
+{
+	std::lock_guard <std::mutex> lock(mutex);
+	auto s=stat;
+	s.nWaiting=waiting.size();
+	s.nDecoding=nDecoding;
+	s.nStaged=staged.size();
+	return s;
+}
@@ -0,0 +1,176 @@
+/* ////////////////////////////////////////////////////////////
+
+File Name: ystexturedecodequeue.h
+Copyright (c) 2017 Soji Yamakawa.  All rights reserved.
+http://www.ysflight.com
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, 
+   this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, 
+   this list of conditions and the following disclaimer in the documentation 
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR 
+PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) 
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+//////////////////////////////////////////////////////////// */
+
+
+#ifndef YSTEXTUREDECODEQUEUE_IS_INCLUDED
+#define YSTEXTUREDECODEQUEUE_IS_INCLUDED
+/* { */
+
+#include <deque>
+#include <mutex>
+#include <chrono>
+#include <vector>
+#include <ystaskscheduler.h>
+#include "ystexturemanager.h"
+
+/*! Decoding of one texture.
+    MakeActualTexture uses it on the stack to decode synchronously.  YsTextureDecodeQueue makes one for
+    each request, and decodes it in a worker thread.
+*/
+class YsTextureDecodeJob
+{
+private:
+	YsTextureDecodeJob(const YsTextureDecodeJob &);
+	YsTextureDecodeJob &operator=(const YsTextureDecodeJob &);
+
+public:
+	class YsTextureDecodeQueue *queuePtr;
+
+	// The unit that is waiting for this job.  It is set to nullptr when the request is cancelled.
+	// Written by the thread that owns the texture manager while locking the queue.
+	const YsTextureManager::Unit *unitPtr;
+
+	// Input.  Copied from the unit so that the worker thread does not touch the unit.
+	YsArray <unsigned char> fileDataCopy;
+	YSSIZE_T fileDataLength;
+	const unsigned char *fileData;
+	YSBOOL useTransparentColor;
+	YsColor transparentColor;
+	YsTextureManager::Unit::EFFECTTYPE effectType;
+	double randomNoiseLevel;
+	unsigned int randomNoiseSeed;
+
+	// Output.
+	YSRESULT res;
+	int wid,hei;
+	unsigned char *rgba;
+
+	std::chrono::time_point <std::chrono::steady_clock> requestTime;
+
+	YsTextureDecodeJob();
+	~YsTextureDecodeJob();
+
+	/*! Makes fileData point to fileDataCopy. */
+	void CopyFileData(void);
+
+	/*! Decodes the PNG data, and applies the transparent color and the effect.
+	    Does not touch the texture unit.  Can be called from any thread. */
+	void Decode(void);
+};
+
+/*! Decodes textures in worker threads, and keeps the decoded RGBA bitmaps until the
+    thread that owns the graphics context uploads them.
+
+    A texture manager uses the queue once it is given by YsTextureManager::SetDecodeQueue or
+    YsTextureManager::SetDefaultDecodeQueue.  Then, YsTextureManager::GetTextureReady and
+    YsTextureManager::Unit::Bind send a PNG texture that has not been loaded to the queue instead of
+    decoding it on the spot, and Bind uses a placeholder texture until the bitmap is uploaded.
+
+    The number of decoded-but-not-uploaded textures is limited by maxNumStaged.  Requests beyond
+    that wait in the queue without being decoded, so that the staging buffers do not eat up the memory
+    when many textures are requested at once.
+
+    Upload must be called regularly (once per frame) by the thread that owns the graphics context.
+
+    Usage:
+        YsTextureDecodeQueue decodeQueue(2);
+        texMan.SetDecodeQueue(&decodeQueue);
+
+        // In every frame
+        decodeQueue.Upload(4*1024*1024);
+*/
+class YsTextureDecodeQueue
+{
+public:
+	class Statistics
+	{
+	public:
+		long long int nWaiting;        // Requested, but not dispatched because the staging queue is full.
+		long long int nDecoding;       // Dispatched, and not decoded yet.
+		long long int nStaged;         // Decoded, and waiting for the upload.
+		long long int nDecoded;        // Total number of decoded textures.
+		long long int nUploaded;       // Total number of uploaded textures.
+		long long int nUploadedByte;   // Total number of uploaded bytes.
+		double totalDecodeLatency;     // Sum of the time from the request to the end of the decode in seconds.
+		double maxDecodeLatency;       // Longest time from the request to the end of the decode in seconds.
+
+		Statistics();
+	};
+
+private:
+	YsTextureDecodeQueue(const YsTextureDecodeQueue &);
+	YsTextureDecodeQueue &operator=(const YsTextureDecodeQueue &);
+
+	mutable std::mutex mutex;
+	std::deque <YsTextureDecodeJob *> waiting;
+	std::deque <YsTextureDecodeJob *> staged;
+	long long int nDecoding;
+	long long int maxNumStaged;
+	Statistics stat;
+
+	YsTaskScheduler scheduler;
+	YsTaskScheduler::TaskGroup group;
+
+	void Dispatch(void);
+	void DecodeInWorker(YsTextureDecodeJob *job);
+
+public:
+	/*! Starts nThread worker threads.  With nThread=0, textures are decoded only in WaitDecode. */
+	YsTextureDecodeQueue(int nThread=2,long long int maxNumStaged=16);
+
+	/*! Waits for the textures being decoded, and discards the rest.
+	    The texture units that were waiting for the queue will be decoded synchronously next time they are bound. */
+	~YsTextureDecodeQueue();
+
+	/*! Sets the maximum number of decoded textures that are waiting for the upload, including the ones being decoded. */
+	void SetMaxNumStaged(long long int maxNumStaged);
+
+	/*! Sends a texture unit to the queue.
+	    Returns YSOK if the unit is in the queue.
+	    Returns YSERR if the unit cannot be decoded asynchronously, which is a render target, or a texture that is not PNG. */
+	YSRESULT Request(const YsTextureManager::Unit *unitPtr);
+
+	/*! Cancels the request of the unit.  Called when the texture data of the unit changes or the unit is deleted. */
+	void Cancel(const YsTextureManager::Unit *unitPtr);
+
+	/*! Uploads decoded bitmaps until the uploaded bytes reach byteBudget.  At least one bitmap is uploaded if available, even if
+	    it is bigger than byteBudget.  Must be called from the thread that owns the graphics context.
+	    Returns the number of textures uploaded. */
+	long long int Upload(long long int byteBudget);
+
+	/*! Waits until all the requested textures are decoded, or the staging queue becomes full.
+	    The calling thread decodes textures while waiting. */
+	void WaitDecode(void);
+
+	/*! Returns the queue depth and the decode-latency counters. */
+	Statistics GetStatistics(void) const;
+};
+
+/* } */
+#endif
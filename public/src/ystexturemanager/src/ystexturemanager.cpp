@@ -28,6 +28,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 //////////////////////////////////////////////////////////// */
 
 #include "ystexturemanager.h"
+#include "ystexturedecodequeue.h"
 #include <yspng.h>
 #include <stdlib.h>
 
@@ -74,6 +75,7 @@ YsTextureManager::Unit::Unit()
 {
 	owner=nullptr;
 	texPtr=nullptr;
+	decodeJob=nullptr;
 	CleanUp();
 }
 
@@ -104,6 +106,10 @@ void YsTextureManager::Unit::CleanUp(void)
 
 void YsTextureManager::Unit::CleanTextureCache(void) const
 {
+	if(nullptr!=decodeJob)
+	{
+		decodeJob->queuePtr->Cancel(this);
+	}
 	if(NULL!=texPtr)
 	{
 		YsTextureManager::Delete(texPtr);
@@ -200,6 +206,11 @@ YSBOOL YsTextureManager::Unit::IsBitmapLoaded(void) const
 	return bitmapLoaded;
 }
 
+YSBOOL YsTextureManager::Unit::IsDecoding(void) const
+{
+	return (nullptr!=decodeJob ? YSTRUE : YSFALSE);
+}
+
 int YsTextureManager::Unit::GetWidth(void) const
 {
 	return wid;
@@ -225,11 +236,15 @@ void YsTextureManager::Unit::SetDontSave(YSBOOL dontSave)
 	}
 }
 
-void YsTextureManager::Unit::ApplyRandomNoise(int wid,int hei,unsigned char rgba[]) const
+/* static */ void YsTextureManager::Unit::ApplyRandomNoise(int wid,int hei,unsigned char rgba[],double randomNoiseLevel,unsigned int seed)
 {
+	const unsigned int randMax=0x7fff;
+	unsigned int randomState=seed;
 	for(int i=0; i<wid*hei; ++i)
 	{
-		double m=(1.0-randomNoiseLevel)+randomNoiseLevel*(double)rand()/(double)RAND_MAX;
+		randomState=randomState*1103515245+12345;
+		const unsigned int rnd=(randomState>>16)&randMax;
+		double m=(1.0-randomNoiseLevel)+randomNoiseLevel*(double)rnd/(double)randMax;
 		double r,g,b;
 		r=m*(double)rgba[i*4];
 		g=m*(double)rgba[i*4+1];
@@ -241,7 +256,7 @@ void YsTextureManager::Unit::ApplyRandomNoise(int wid,int hei,unsigned char rgba
 	}
 }
 
-void YsTextureManager::Unit::MakeAlphaMaskMaxValue(int wid,int hei,unsigned char rgba[]) const
+/* static */ void YsTextureManager::Unit::MakeAlphaMaskMaxValue(int wid,int hei,unsigned char rgba[])
 {
 	for(int i=0; i<wid*hei; ++i)
 	{
@@ -253,7 +268,7 @@ void YsTextureManager::Unit::MakeAlphaMaskMaxValue(int wid,int hei,unsigned char
 	}
 }
 
-void YsTextureManager::Unit::AlphaFromMaxRGB(int wid,int hei,unsigned char rgba[]) const
+/* static */ void YsTextureManager::Unit::AlphaFromMaxRGB(int wid,int hei,unsigned char rgba[])
 {
 	for(int i=0; i<wid*hei; ++i)
 	{
@@ -277,42 +292,14 @@ YSRESULT YsTextureManager::Unit::MakeActualTexture(TextureGenerationOption opt)
 		{
 		case FOM_PNG:
 			{
-				YsPngBinaryMemoryStream inStream(dat.GetN(),dat);
-				YsRawPngDecoder png;
-				if(YSOK==(YSRESULT)png.Decode(inStream))
+				YsTextureDecodeJob job;
+				SetUpDecodeJob(job);
+				job.Decode();
+				if(YSOK==job.res)
 				{
-					this->wid=png.wid;
-					this->hei=png.hei;
-
-					if(0!=(FLAG_USE_TRANSPARENT_COLOR&flags))
-					{
-						int tr=transparentColor.Ri();
-						int tg=transparentColor.Gi();
-						int tb=transparentColor.Bi();
-						for(long long int i=0; i<png.wid*png.hei*4; i+=4)
-						{
-							if(png.rgba[i  ]==tr &&
-							   png.rgba[i+1]==tg &&
-							   png.rgba[i+2]==tb)
-							{
-								png.rgba[i+3]=0;
-							}
-						}
-					}
-
-					switch(effectType)
-					{
-					case EFFECT_RANDOMNOISE:
-						ApplyRandomNoise(png.wid,png.hei,png.rgba);
-						break;
-					case EFFECT_ALPHAMASK_MAXRGB:
-						MakeAlphaMaskMaxValue(png.wid,png.hei,png.rgba);
-						break;
-					case EFFECT_ALPHA_FROM_MAXRGB:
-						AlphaFromMaxRGB(png.wid,png.hei,png.rgba);
-						break;
-					}
-					return SetUpRGBABitmap(texPtr,png.wid,png.hei,png.rgba,opt);
+					this->wid=job.wid;
+					this->hei=job.hei;
+					return SetUpRGBABitmap(texPtr,job.wid,job.hei,job.rgba,opt);
 				}
 			}
 			break;
@@ -361,6 +348,75 @@ YSRESULT YsTextureManager::Unit::MakeActualTexture(TextureGenerationOption opt)
 	return YSERR;
 }
 
+unsigned int YsTextureManager::Unit::GetRandomNoiseSeed(void) const
+{
+	// FNV-1a
+	unsigned int seed=2166136261u;
+	for(YSSIZE_T i=0; i<label.Strlen(); ++i)
+	{
+		seed^=(unsigned char)label[i];
+		seed*=16777619u;
+	}
+	return seed;
+}
+
+void YsTextureManager::Unit::SetUpDecodeJob(YsTextureDecodeJob &job) const
+{
+	job.fileDataLength=dat.GetN();
+	job.fileData=dat;
+	job.useTransparentColor=(0!=(FLAG_USE_TRANSPARENT_COLOR&flags) ? YSTRUE : YSFALSE);
+	job.transparentColor=transparentColor;
+	job.effectType=effectType;
+	job.randomNoiseLevel=randomNoiseLevel;
+	job.randomNoiseSeed=GetRandomNoiseSeed();
+}
+
+YSRESULT YsTextureManager::Unit::ReceiveDecodeJob(YsTextureDecodeJob &job) const
+{
+	decodeJob=nullptr;
+
+	// Same as MakeActualTexture.  A texture is allocated even if the decoding failed so that it is not requested again.
+	CleanTextureCache();
+	texPtr=YsTextureManager::Alloc();
+	if(YSOK==job.res)
+	{
+		this->wid=job.wid;
+		this->hei=job.hei;
+		return SetUpRGBABitmap(texPtr,job.wid,job.hei,job.rgba,owner->GetTextureGenerationOption());
+	}
+	return YSERR;
+}
+
+YSRESULT YsTextureManager::Unit::RequestAsyncDecode(void) const
+{
+	auto queuePtr=(nullptr!=owner ? owner->GetDecodeQueue() : nullptr);
+	if(nullptr!=queuePtr &&
+	   0==(flags&FLAG_RENDERTARGET) &&
+	   FOM_PNG==fType &&
+	   YSTRUE!=bitmapLoaded)
+	{
+		return queuePtr->Request(this);
+	}
+	return YSERR;
+}
+
+YsTextureManager::ActualTexture *YsTextureManager::Unit::GetTextureToBind(void) const
+{
+	if(YSTRUE!=IsActualTextureReady() && YSOK!=RequestAsyncDecode())
+	{
+		MakeActualTexture();
+	}
+	if(YSTRUE==IsActualTextureReady())
+	{
+		return texPtr;
+	}
+	if(nullptr!=decodeJob)
+	{
+		return YsTextureManager::GetPlaceholderTexture();
+	}
+	return nullptr;
+}
+
 YSRESULT YsTextureManager::Unit::SetUpRGBABitmap(
 	ActualTexture *texPtr,int wid,int hei,const unsigned char rgba[],const TextureGenerationOption &opt) const
 {
@@ -546,11 +602,30 @@ YSBOOL YsTextureManager::Unit::MustNotBeSavedToFile(void) const
 
 ////////////////////////////////////////////////////////////
 
+YsTextureDecodeQueue *YsTextureManager::defaultDecodeQueue=nullptr;
+YsTextureManager::ActualTexture *YsTextureManager::placeholderTexPtr=nullptr;
+
 YsTextureManager::YsTextureManager()
 {
+	decodeQueue=nullptr;
 	ClearLoadingInfo();
 }
 
+/* static */ YsTextureManager::ActualTexture *YsTextureManager::GetPlaceholderTexture(void)
+{
+	if(nullptr==placeholderTexPtr)
+	{
+		// Gray, and transparent so that a sprite or a decal does not show up as a square until the real texture arrives.
+		const unsigned char rgba[4]={128,128,128,0};
+		placeholderTexPtr=Alloc();
+		if(nullptr!=placeholderTexPtr)
+		{
+			TransferRGBABitmap(placeholderTexPtr,1,1,rgba);
+		}
+	}
+	return placeholderTexPtr;
+}
+
 void YsTextureManager::CleanUp(void)
 {
 	TexHandle texHd=nullptr;
@@ -588,6 +663,25 @@ YsTextureManager::TextureGenerationOption YsTextureManager::GetTextureGeneration
 	return this->genOpt;
 }
 
+void YsTextureManager::SetDecodeQueue(YsTextureDecodeQueue *decodeQueue)
+{
+	this->decodeQueue=decodeQueue;
+}
+
+/* static */ void YsTextureManager::SetDefaultDecodeQueue(YsTextureDecodeQueue *decodeQueue)
+{
+	defaultDecodeQueue=decodeQueue;
+}
+
+YsTextureDecodeQueue *YsTextureManager::GetDecodeQueue(void) const
+{
+	if(nullptr!=decodeQueue)
+	{
+		return decodeQueue;
+	}
+	return defaultDecodeQueue;
+}
+
 YSBOOL YsTextureManager::IsLabelUsed(const YsString &str) const
 {
 	return bmpDict.IsWordIncluded(str);
@@ -951,6 +1045,10 @@ const YsTextureManager::Unit *YsTextureManager::GetTextureReady(TexHandle texHd)
 		{
 			if(YSTRUE!=unitPtr->IsActualTextureReady())
 			{
+				if(YSOK==unitPtr->RequestAsyncDecode())
+				{
+					return unitPtr;
+				}
 				unitPtr->MakeActualTexture(genOpt);
 			}
 			if(YSTRUE==unitPtr->IsActualTextureReady())
@@ -962,6 +1060,16 @@ const YsTextureManager::Unit *YsTextureManager::GetTextureReady(TexHandle texHd)
 	return nullptr;
 }
 
+YSRESULT YsTextureManager::RequestAsyncDecode(TexHandle texHd) const
+{
+	auto unitPtr=bmpArray[texHd];
+	if(nullptr!=unitPtr && YSTRUE!=unitPtr->IsActualTextureReady())
+	{
+		return unitPtr->RequestAsyncDecode();
+	}
+	return YSERR;
+}
+
 void YsTextureManager::UnreadyTexture(TexHandle texHd)
 {
 	if(nullptr!=texHd)
@@ -36,6 +36,9 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <yseditarray.h>
 #include <ysbitmap.h>
 
+class YsTextureDecodeJob;
+class YsTextureDecodeQueue;
+
 class YsTextureManager
 {
 friend class Unit;
@@ -79,6 +82,8 @@ public:
 	class Unit
 	{
 	friend class YsTextureManager;
+	friend class YsTextureDecodeJob;
+	friend class YsTextureDecodeQueue;
 
 	public:
 		enum FILTERTYPE
@@ -128,6 +133,9 @@ public:
 		// bitmapLoaded is used for checking if the RGBA bitmap has already been transferred.
 		mutable YSBOOL bitmapLoaded;
 
+		// Non-null while the texture is in a YsTextureDecodeQueue.
+		mutable YsTextureDecodeJob *decodeJob;
+
 		Unit(const Unit &incoming);
 		Unit &operator=(const Unit &incoming);
 	public:
@@ -167,10 +175,21 @@ public:
 		/*! Returns if the texture has already been transferred to the GPU.
 		*/
 		YSBOOL IsBitmapLoaded(void) const;
+
+		/*! Returns YSTRUE if the texture is waiting in a YsTextureDecodeQueue.
+		*/
+		YSBOOL IsDecoding(void) const;
 	private:
-		void ApplyRandomNoise(int wid,int hei,unsigned char rgba[]) const;
-		void MakeAlphaMaskMaxValue(int wid,int hei,unsigned char rgba[]) const;
-		void AlphaFromMaxRGB(int wid,int hei,unsigned char rgba[]) const;
+		/*! Noise is made from the seed, not from rand(), so that the texture can be decoded in any thread
+		    and looks the same every time it is decoded. */
+		static void ApplyRandomNoise(int wid,int hei,unsigned char rgba[],double randomNoiseLevel,unsigned int seed);
+		static void MakeAlphaMaskMaxValue(int wid,int hei,unsigned char rgba[]);
+		static void AlphaFromMaxRGB(int wid,int hei,unsigned char rgba[]);
+
+		/*! Returns the seed of the random noise made from the label. */
+		unsigned int GetRandomNoiseSeed(void) const;
+		void SetUpDecodeJob(YsTextureDecodeJob &job) const;
+		YSRESULT ReceiveDecodeJob(YsTextureDecodeJob &job) const;
 
 	public:
 		/*! If you need to support poor & incapable OpenGL ES, I feel your pain.
@@ -191,6 +210,19 @@ public:
 		*/
 		YSRESULT MakeActualTexture(TextureGenerationOption opt) const;
 
+		/*! Sends the texture to the decode queue of the owner.
+		    Returns YSOK if the texture is in the queue.
+		    Returns YSERR if the owner has no decode queue, or the texture needs to be made synchronously,
+		    which is a render target, a texture that is not PNG, or a texture that has already been transferred once.
+		*/
+		YSRESULT RequestAsyncDecode(void) const;
+
+		/*! Makes the texture ready, or sends it to the decode queue, and returns the texture to bind.
+		    While the texture is in the decode queue, it returns the placeholder texture.
+		    Called from Bind.
+		*/
+		ActualTexture *GetTextureToBind(void) const;
+
 	private:
 		YSRESULT SetUpRGBABitmap(ActualTexture *texPtr,int wid,int hei,const unsigned char rgba[],const TextureGenerationOption &opt) const;
 		int UpscaleDimension(int d) const;
@@ -247,6 +279,11 @@ private:
 	YsEditArray <Unit,8> bmpArray;
 	YsDictionary <YsString,YsEditArrayObjectHandle <Unit,8> > bmpDict;
 	TextureGenerationOption genOpt;
+	YsTextureDecodeQueue *decodeQueue;
+
+	static YsTextureDecodeQueue *defaultDecodeQueue;
+	static ActualTexture *placeholderTexPtr;
+	static ActualTexture *GetPlaceholderTexture(void);
 
 	static ActualTexture *Alloc(void);         // Written in ystexturemanagergl.h/cpp or ystexturemanager_d3d9.h/cpp
 	static void Delete(ActualTexture *texPtr); // Written in ystexturemanagergl.h/cpp or ystexturemanager_d3d9.h/cpp
@@ -272,6 +309,21 @@ public:
 	*/
 	TextureGenerationOption GetTextureGenerationOption(void) const;
 
+	/*! Sets the decode queue.  Textures will be decoded in the worker threads of the queue, and Bind uses
+	    a placeholder texture until YsTextureDecodeQueue::Upload transfers the bitmap.
+	    If nullptr is given, the default decode queue is used.
+	*/
+	void SetDecodeQueue(YsTextureDecodeQueue *decodeQueue);
+
+	/*! Sets the decode queue of the texture managers that have no decode queue of their own.
+	    If nullptr is given (default), those texture managers decode textures synchronously.
+	*/
+	static void SetDefaultDecodeQueue(YsTextureDecodeQueue *decodeQueue);
+
+	/*! Returns the decode queue used by this texture manager, or nullptr if textures are decoded synchronously.
+	*/
+	YsTextureDecodeQueue *GetDecodeQueue(void) const;
+
 
 	typedef YsEditArrayObjectHandle <Unit,8> TexHandle;
 
@@ -377,9 +429,16 @@ public:
 
 	/*! Make the texture ready and return the pointer to the texture unit.
 	    Returns nullptr if the texHd is nullptr or the texture could not be made ready.
+	    If this texture manager has a decode queue, the texture may be sent to the queue instead.  The unit is returned
+	    in that case, and Bind uses the placeholder texture until the bitmap is uploaded.
 	*/
 	const Unit *GetTextureReady(TexHandle texHd) const;
 
+	/*! Sends the texture to the decode queue so that it is ready by the time it is used.
+	    Returns YSERR if it cannot be decoded asynchronously.
+	*/
+	YSRESULT RequestAsyncDecode(TexHandle texHd) const;
+
 	/*! Make texture un-ready state.
 	*/
 	void UnreadyTexture(TexHandle texHd);
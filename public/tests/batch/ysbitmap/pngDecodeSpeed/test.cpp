@@ -0,0 +1,191 @@
+/* ////////////////////////////////////////////////////////////
+
+File Name: test.cpp
+Copyright (c) 2017 Soji Yamakawa.  All rights reserved.
+http://www.ysflight.com
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, 
+   this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, 
+   this list of conditions and the following disclaimer in the documentation 
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR 
+PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) 
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+//////////////////////////////////////////////////////////// */
+
+#include <ysclass.h>
+#include <ysport.h>
+#include <yspng.h>
+
+#include <chrono>
+#include <vector>
+#include <string.h>
+
+
+
+class PngFile
+{
+public:
+	YsString fn;
+	std::vector <unsigned char> dat;
+};
+
+void FindPngFile(std::vector <PngFile> &pngFile,const char dir[])
+{
+	YsFileList fileList;
+	if(YSOK!=fileList.FindFileList(dir,nullptr,nullptr))
+	{
+		return;
+	}
+	for(YSSIZE_T i=0; i<fileList.GetN(); ++i)
+	{
+		YsString baseName(fileList.GetSystemEncodingName(i));
+		if(0==strcmp(baseName,".") || 0==strcmp(baseName,".."))
+		{
+			continue;
+		}
+
+		YsString fn;
+		fileList.GetSystemEncodingNameWithPath(fn,i);
+		if(YSTRUE==fileList.IsDirectory(i))
+		{
+			FindPngFile(pngFile,fn);
+		}
+		else
+		{
+			auto ext=baseName.GetExtension();
+			ext.Capitalize();
+			if(0==strcmp(ext,".PNG"))
+			{
+				PngFile png;
+				png.fn=fn;
+				FILE *fp=fopen(fn,"rb");
+				if(nullptr!=fp)
+				{
+					png.dat.resize(fileList.GetSize(i));
+					if(0<png.dat.size() && png.dat.size()==fread(png.dat.data(),1,png.dat.size(),fp))
+					{
+						pngFile.push_back(png);
+					}
+					fclose(fp);
+				}
+			}
+		}
+	}
+}
+
+YSBOOL Decode(YsRawPngDecoder &decoder,const PngFile &png,YSBOOL useReferenceDecoder)
+{
+	decoder.useReferenceDecoder=useReferenceDecoder;
+	YsPngBinaryMemoryStream stream(png.dat.size(),png.dat.data());
+	if(YSOK==decoder.Decode(stream) && nullptr!=decoder.rgba && 0<decoder.wid && 0<decoder.hei)
+	{
+		return YSTRUE;
+	}
+	return YSFALSE;
+}
+
+YSRESULT TestPngDecodeSpeed(const std::vector <PngFile> &pngFile)
+{
+	int nFail=0,nDecoded=0;
+	double fastTime=0.0,referenceTime=0.0;
+	size_t nPixelTotal=0,nPngByteTotal=0;
+
+	for(auto &png : pngFile)
+	{
+		const int nRepeat=4;
+
+		YsRawPngDecoder fast,reference;
+
+		auto t0=std::chrono::high_resolution_clock::now();
+		for(int i=0; i<nRepeat; ++i)
+		{
+			Decode(reference,png,YSTRUE);
+		}
+		auto t1=std::chrono::high_resolution_clock::now();
+		for(int i=0; i<nRepeat; ++i)
+		{
+			Decode(fast,png,YSFALSE);
+		}
+		auto t2=std::chrono::high_resolution_clock::now();
+
+		if(YSTRUE!=Decode(reference,png,YSTRUE))
+		{
+			// Not a PNG, or colorType-bitDepth combination not supported.
+			printf("Skipped %s\n",png.fn.Txt());
+			continue;
+		}
+		if(YSTRUE!=Decode(fast,png,YSFALSE))
+		{
+			fprintf(stderr,"Error! The fast decoder failed: %s\n",png.fn.Txt());
+			++nFail;
+			continue;
+		}
+
+		if(fast.wid!=reference.wid ||
+		   fast.hei!=reference.hei ||
+		   0!=memcmp(fast.rgba,reference.rgba,(size_t)fast.wid*(size_t)fast.hei*4))
+		{
+			fprintf(stderr,"Error! The output does not match the reference decoder: %s\n",png.fn.Txt());
+			++nFail;
+			continue;
+		}
+
+		++nDecoded;
+		referenceTime+=std::chrono::duration_cast<std::chrono::microseconds>(t1-t0).count()/(1000000.0*nRepeat);
+		fastTime+=std::chrono::duration_cast<std::chrono::microseconds>(t2-t1).count()/(1000000.0*nRepeat);
+		nPixelTotal+=(size_t)fast.wid*(size_t)fast.hei;
+		nPngByteTotal+=png.dat.size();
+	}
+
+	printf("%d PNG files, %d decoded, %lld bytes, %lld pixels\n",(int)pngFile.size(),nDecoded,(long long)nPngByteTotal,(long long)nPixelTotal);
+	if(0<fastTime && 0<referenceTime)
+	{
+		const double mega=1024.0*1024.0;
+		printf("Reference decoder %.2lf ms  %.2lf MB/s (RGBA output)\n",referenceTime*1000.0,(double)nPixelTotal*4.0/mega/referenceTime);
+		printf("Fast decoder      %.2lf ms  %.2lf MB/s (RGBA output)\n",fastTime*1000.0,(double)nPixelTotal*4.0/mega/fastTime);
+		printf("Speed up x%.2lf\n",referenceTime/fastTime);
+	}
+
+	if(0<nFail)
+	{
+		return YSERR;
+	}
+	return YSOK;
+}
+
+int main(int ac,char *av[])
+{
+	std::vector <PngFile> pngFile;
+	for(int i=1; i<ac; ++i)
+	{
+		FindPngFile(pngFile,av[i]);
+	}
+
+	int nFail=0;
+	if(YSOK!=TestPngDecodeSpeed(pngFile))
+	{
+		++nFail;
+	}
+
+	printf("%d failed.\n",nFail);
+	if(0<nFail)
+	{
+		return 1;
+	}
+	return 0;
+}
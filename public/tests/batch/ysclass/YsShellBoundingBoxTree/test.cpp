@@ -0,0 +1,181 @@
+/* ////////////////////////////////////////////////////////////
+
+File Name: test.cpp
+Copyright (c) 2017 Soji Yamakawa.  All rights reserved.
+http://www.ysflight.com
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, 
+   this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, 
+   this list of conditions and the following disclaimer in the documentation 
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR 
+PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) 
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+//////////////////////////////////////////////////////////// */
+
+#include <ysclass.h>
+#include <ysclass.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <chrono>
+
+
+
+// Tessellated sphere.  nLng*nLat quadrilaterals, minus degenerate ones at the poles which become triangles.
+static void MakeSphere(YsShell &shl,const double rad,int nLng,int nLat)
+{
+	YsArray <YsShellVertexHandle> vtHd;
+	auto north=shl.AddVertexH(YsVec3(0.0,rad,0.0));
+	auto south=shl.AddVertexH(YsVec3(0.0,-rad,0.0));
+	for(int lat=1; lat<nLat; ++lat)
+	{
+		const double p=YsPi/2.0-YsPi*(double)lat/(double)nLat;
+		for(int lng=0; lng<nLng; ++lng)
+		{
+			const double h=YsPi*2.0*(double)lng/(double)nLng;
+			vtHd.Append(shl.AddVertexH(YsVec3(rad*cos(p)*cos(h),rad*sin(p),rad*cos(p)*sin(h))));
+		}
+	}
+
+	for(int lng=0; lng<nLng; ++lng)
+	{
+		const int lngNext=(lng+1)%nLng;
+		YsShellVertexHandle tri[3]={north,vtHd[lngNext],vtHd[lng]};
+		shl.AddPolygonH(3,tri);
+
+		const int base=(nLat-2)*nLng;
+		YsShellVertexHandle triS[3]={south,vtHd[base+lng],vtHd[base+lngNext]};
+		shl.AddPolygonH(3,triS);
+
+		for(int lat=0; lat<nLat-2; ++lat)
+		{
+			YsShellVertexHandle quad[4]=
+			{
+				vtHd[lat*nLng+lng],
+				vtHd[lat*nLng+lngNext],
+				vtHd[(lat+1)*nLng+lngNext],
+				vtHd[(lat+1)*nLng+lng]
+			};
+			shl.AddPolygonH(4,quad);
+		}
+	}
+}
+
+static double Rand(const double min,const double max)
+{
+	return min+(max-min)*(double)rand()/(double)RAND_MAX;
+}
+
+static YsMatrix4x4 RandomTransformation(const double minDist,const double maxDist)
+{
+	YsVec3 dir(Rand(-1.0,1.0),Rand(-1.0,1.0),Rand(-1.0,1.0));
+	if(YSOK!=dir.Normalize())
+	{
+		dir=YsXVec();
+	}
+
+	YsMatrix4x4 mat;
+	mat.Translate(dir*Rand(minDist,maxDist));
+	mat.Rotate(YsAtt3(Rand(-YsPi,YsPi),Rand(-YsPi/2.0,YsPi/2.0),Rand(-YsPi,YsPi)));
+	return mat;
+}
+
+int main(void)
+{
+	auto t=time(NULL);
+	srand((unsigned int)t);
+
+	YsShell shl1,shl2;
+	MakeSphere(shl1,1.0,48,24);
+	MakeSphere(shl2,0.8,32,16);
+	printf("Shell1 %d polygons\n",(int)shl1.GetNumPolygon());
+	printf("Shell2 %d polygons\n",(int)shl2.GetNumPolygon());
+
+	YsShellBoundingBoxTree tree1,tree2;
+	tree1.Build(shl1);
+	tree2.Build(shl2);
+	printf("Tree1 %d nodes\n",(int)tree1.GetNumNode());
+	printf("Tree2 %d nodes\n",(int)tree2.GetNumNode());
+
+	YSRESULT res=YSOK;
+	const int nTest=40;
+	double tOld=0.0,tNew=0.0;
+	int nCollide=0;
+	for(int i=0; i<nTest; ++i)
+	{
+		// Sphere surfaces intersect if the distance between the centers is between 0.2 and 1.8.
+		// Stay away from the tangent cases, where the tolerance may tip the result either way.
+		const YsMatrix4x4 mat1=RandomTransformation(0.0,100.0);
+		const YsMatrix4x4 mat2=(0==i%2 ? mat1*RandomTransformation(0.4,1.6) : mat1*RandomTransformation(2.0,2.5));
+
+		shl1.SetMatrix(mat1);
+		shl2.SetMatrix(mat2);
+
+		YsVec3 oldPos,newPos;
+		YsShellPolygonHandle oldPlHd1,oldPlHd2,newPlHd1,newPlHd2;
+
+		auto t0=std::chrono::high_resolution_clock::now();
+		auto oldRes=YsCheckShellCollisionEx(oldPos,oldPlHd1,oldPlHd2,shl1,shl2);
+		auto t1=std::chrono::high_resolution_clock::now();
+		auto newRes=YsCheckShellCollisionEx(newPos,newPlHd1,newPlHd2,tree1,mat1,tree2,mat2);
+		auto t2=std::chrono::high_resolution_clock::now();
+
+		tOld+=(double)std::chrono::duration_cast<std::chrono::microseconds>(t1-t0).count();
+		tNew+=(double)std::chrono::duration_cast<std::chrono::microseconds>(t2-t1).count();
+
+		if(oldRes!=newRes)
+		{
+			printf("Error!  Result does not match.  Old=%s New=%s\n",YsBoolToStr(oldRes),YsBoolToStr(newRes));
+			res=YSERR;
+		}
+		else if(YSTRUE==newRes)
+		{
+			++nCollide;
+
+			// The collision point must be on both shells.
+			YsVec3 p1,p2;
+			YsMatrix4x4 inv1=mat1,inv2=mat2;
+			inv1.Invert();
+			inv2.Invert();
+			inv1.Mul(p1,newPos,1.0);
+			inv2.Mul(p2,newPos,1.0);
+			if(YsAbs(p1.GetLength()-1.0)>0.05 || YsAbs(p2.GetLength()-0.8)>0.05)
+			{
+				printf("Error!  Collision point is not on the shells.  %s\n",newPos.Txt());
+				res=YSERR;
+			}
+		}
+	}
+
+	printf("%d tests, %d collisions\n",nTest,nCollide);
+	printf("YsCheckShellCollisionEx(YsShell,YsShell)         %.1lf us per pair\n",tOld/(double)nTest);
+	printf("YsCheckShellCollisionEx(YsShellBoundingBoxTree)  %.1lf us per pair\n",tNew/(double)nTest);
+
+	printf("srand=%ld\n",(long)t);
+	if(YSOK==res)
+	{
+		printf("OK!\n");
+		return 0;
+	}
+	else
+	{
+		printf("Error!\n");
+		return 1;
+	}
+}
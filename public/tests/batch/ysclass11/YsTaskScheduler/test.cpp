@@ -0,0 +1,375 @@
+/* ////////////////////////////////////////////////////////////
+
+File Name: test.cpp
+Copyright (c) 2017 Soji Yamakawa.  All rights reserved.
+http://www.ysflight.com
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, 
+   this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, 
+   this list of conditions and the following disclaimer in the documentation 
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR 
+PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) 
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+//////////////////////////////////////////////////////////// */
+
+#include <chrono>
+#include <vector>
+#include <atomic>
+#include <math.h>
+
+#include <ysclass.h>
+#include <ystaskscheduler.h>
+#include <ysthreadpool.h>
+#include <ysparallelmergesort.h>
+#include <stdio.h>
+
+#include "legacythreadpool.h"
+
+
+
+YSRESULT NestedParallelForTest(YsTaskScheduler &scheduler)
+{
+	// Outer ParallelFor over rows, inner ParallelFor over columns.
+	const long long int nRow=64,nColumn=10000;
+	std::vector <long long int> rowSum(nRow,0);
+	scheduler.ParallelFor(0,nRow,1,[&](long long int r0,long long int r1)
+	{
+		for(auto r=r0; r<r1; ++r)
+		{
+			std::atomic <long long int> sum(0);
+			scheduler.ParallelFor(0,nColumn,256,[&](long long int c0,long long int c1)
+			{
+				long long int s=0;
+				for(auto c=c0; c<c1; ++c)
+				{
+					s+=r*nColumn+c;
+				}
+				sum+=s;
+			});
+			rowSum[r]=sum;
+		}
+	});
+
+	for(long long int r=0; r<nRow; ++r)
+	{
+		const long long int expected=r*nColumn*nColumn+nColumn*(nColumn-1)/2;
+		if(expected!=rowSum[r])
+		{
+			fprintf(stderr,"Row %lld: Expected %lld  Got %lld\n",r,expected,rowSum[r]);
+			return YSERR;
+		}
+	}
+	return YSOK;
+}
+
+YSRESULT NestedTaskGroupTest(YsTaskScheduler &scheduler)
+{
+	// Each task spawns a group of its own and waits for it.
+	std::atomic <int> count(0);
+	{
+		YsTaskScheduler::TaskGroup outer(scheduler);
+		for(int i=0; i<16; ++i)
+		{
+			outer.Run([&]()
+			{
+				YsTaskScheduler::TaskGroup inner(scheduler);
+				for(int j=0; j<16; ++j)
+				{
+					inner.Run([&](){++count;});
+				}
+				inner.Wait();
+			});
+		}
+		outer.Wait();
+	}
+	if(256!=count)
+	{
+		fprintf(stderr,"Expected 256 tasks  Ran %d\n",(int)count);
+		return YSERR;
+	}
+	return YSOK;
+}
+
+YSRESULT NestedThreadPoolTest(void)
+{
+	// YsThreadPool::Run from inside of a task of the same pool.
+	YsThreadPool pool(4);
+	std::atomic <int> count(0);
+
+	std::vector <std::function <void()> > inner;
+	for(int i=0; i<8; ++i)
+	{
+		inner.push_back([&](){++count;});
+	}
+	std::vector <std::function <void()> > outer;
+	for(int i=0; i<8; ++i)
+	{
+		outer.push_back([&](){pool.Run(inner.size(),inner.data());});
+	}
+	pool.Run(outer.size(),outer.data());
+
+	if(64!=count)
+	{
+		fprintf(stderr,"Expected 64 tasks  Ran %d\n",(int)count);
+		return YSERR;
+	}
+	return YSOK;
+}
+
+static double StepState(double x,long long int i)
+{
+	// Stands in for the integration of one airplane.  Every step depends on the last one.
+	for(int step=0; step<64; ++step)
+	{
+		x=x*0.999+sin(x+(double)i)*0.01;
+	}
+	return x;
+}
+
+YSRESULT RunEquivalenceTest(void)
+{
+	// YsThreadPool::Run must run every task exactly once, same as the old pool.
+	YsLegacyThreadPool legacyPool(4);
+	YsThreadPool pool(4);
+	for(int nTask : {0,1,2,3,4,5,8,33})
+	{
+		std::vector <std::atomic <int> > legacyCount(nTask),newCount(nTask);
+		std::vector <double> legacyResult(nTask,0.0),newResult(nTask,0.0);
+		std::vector <std::function <void()> > legacyTask,newTask;
+		for(int i=0; i<nTask; ++i)
+		{
+			legacyCount[i]=0;
+			newCount[i]=0;
+			legacyTask.push_back([&,i](){++legacyCount[i];legacyResult[i]=StepState(1.0,i);});
+			newTask.push_back([&,i](){++newCount[i];newResult[i]=StepState(1.0,i);});
+		}
+
+		legacyPool.Run(legacyTask.size(),legacyTask.data());
+		pool.Run(newTask.size(),newTask.data());
+
+		for(int i=0; i<nTask; ++i)
+		{
+			if(1!=legacyCount[i] || 1!=newCount[i] || legacyResult[i]!=newResult[i])
+			{
+				fprintf(stderr,"%d tasks: Task %d ran %d times (old pool %d times)\n",nTask,i,(int)newCount[i],(int)legacyCount[i]);
+				return YSERR;
+			}
+		}
+	}
+	return YSOK;
+}
+
+YSRESULT ChunkEquivalenceTest(void)
+{
+	// FsSimulation::SimMoveAirplanePhysicsInParallel used to give one contiguous chunk per thread to the old pool.
+	// It now gives smaller chunks to ParallelFor.  The states must come out the same.
+	YsLegacyThreadPool legacyPool(4);
+	YsThreadPool pool(4);
+	const long long int nThread=pool.GetN();
+	for(long long int nAir : {1,2,3,4,7,16,100,1000})
+	{
+		std::vector <double> legacyState(nAir),newState(nAir);
+		std::vector <std::atomic <int> > newCount(nAir);
+		for(long long int i=0; i<nAir; ++i)
+		{
+			legacyState[i]=(double)i;
+			newState[i]=(double)i;
+			newCount[i]=0;
+		}
+
+		// Old path
+		const long long int nChunk=YsSmaller(nThread,nAir);
+		std::vector <std::function <void()> > taskArray;
+		for(long long int chunkIdx=0; chunkIdx<nChunk; ++chunkIdx)
+		{
+			const long long int i0=nAir* chunkIdx   /nChunk;
+			const long long int i1=nAir*(chunkIdx+1)/nChunk;
+			taskArray.push_back([&,i0,i1]()
+			{
+				for(auto i=i0; i<i1; ++i)
+				{
+					legacyState[i]=StepState(legacyState[i],i);
+				}
+			});
+		}
+		legacyPool.Run(taskArray.size(),taskArray.data());
+
+		// New path
+		const long long int grainSize=YsGreater <long long int> (1,nAir/(nThread*4));
+		pool.GetScheduler().ParallelFor(0,nAir,grainSize,[&](long long int i0,long long int i1)
+		{
+			for(auto i=i0; i<i1; ++i)
+			{
+				++newCount[i];
+				newState[i]=StepState(newState[i],i);
+			}
+		});
+
+		for(long long int i=0; i<nAir; ++i)
+		{
+			if(1!=newCount[i] || legacyState[i]!=newState[i])
+			{
+				fprintf(stderr,"%lld airplanes: Airplane %lld moved %d times.  State %lf (old path %lf)\n",
+				    nAir,i,(int)newCount[i],newState[i],legacyState[i]);
+				return YSERR;
+			}
+		}
+	}
+	return YSOK;
+}
+
+YSRESULT MergeSortEquivalenceTest(void)
+{
+	// YsParallelMergeSort through the new pool against the serial merge sort.
+	YsThreadPool pool(4);
+	for(int nKey : {0,1,7,8,1000,65536})
+	{
+		YsArray <int> serialKey,parallelKey,serialValue,parallelValue;
+		unsigned int state=(unsigned int)nKey;
+		for(int i=0; i<nKey; ++i)
+		{
+			state=state*1103515245+12345;
+			serialKey.Add((int)((state>>8)&0xffffff)*65536+i);   // Unique keys, so that the order is unambiguous.
+			serialValue.Add(i);
+		}
+		parallelKey=serialKey;
+		parallelValue=serialValue;
+
+		YsSimpleMergeSort <int,int> (serialKey.GetN(),serialKey,serialValue);
+		YsSimpleParallelMergeSort <int,int> (parallelKey.GetN(),parallelKey,parallelValue,pool);
+
+		if(!(serialKey==parallelKey) || !(serialValue==parallelValue))
+		{
+			fprintf(stderr,"%d keys: Parallel merge sort does not agree with the serial merge sort.\n",nKey);
+			return YSERR;
+		}
+	}
+	return YSOK;
+}
+
+YSRESULT DispatchBenchmark(void)
+{
+	// Short tasks.  Three tasks are the field-elevation, rect-region, and collision tasks of a simulation step.
+	// The numbers are printed for comparison, and not checked.  They depend on the machine too much.
+	const int nRepeat=2000;
+	std::atomic <int> count(0);
+	std::vector <std::function <void()> > taskArray;
+	for(int i=0; i<8; ++i)
+	{
+		taskArray.push_back([&](){++count;});
+	}
+
+	YsLegacyThreadPool legacyPool(4);
+	YsThreadPool pool(4);
+	int nExpected=0;
+
+	printf("Dispatch overhead per call (us)\n");
+	printf("  tasks   old YsThreadPool  YsThreadPool  TaskGroup\n");
+	for(int nTask : {1,2,3,4,8})
+	{
+		double usec[3];
+
+		auto t0=std::chrono::high_resolution_clock::now();
+		for(int i=0; i<nRepeat; ++i)
+		{
+			legacyPool.Run(nTask,taskArray.data());
+		}
+		auto t1=std::chrono::high_resolution_clock::now();
+		usec[0]=(double)std::chrono::duration_cast <std::chrono::nanoseconds> (t1-t0).count()/(1000.0*nRepeat);
+
+		t0=std::chrono::high_resolution_clock::now();
+		for(int i=0; i<nRepeat; ++i)
+		{
+			pool.Run(nTask,taskArray.data());
+		}
+		t1=std::chrono::high_resolution_clock::now();
+		usec[1]=(double)std::chrono::duration_cast <std::chrono::nanoseconds> (t1-t0).count()/(1000.0*nRepeat);
+
+		auto &scheduler=pool.GetScheduler();
+		t0=std::chrono::high_resolution_clock::now();
+		for(int i=0; i<nRepeat; ++i)
+		{
+			YsTaskScheduler::TaskGroup group(scheduler);
+			for(int j=1; j<nTask; ++j)
+			{
+				group.Run(taskArray[j]);
+			}
+			taskArray[0]();
+			group.Wait();
+		}
+		t1=std::chrono::high_resolution_clock::now();
+		usec[2]=(double)std::chrono::duration_cast <std::chrono::nanoseconds> (t1-t0).count()/(1000.0*nRepeat);
+
+		printf("  %5d   %16.2lf  %12.2lf  %9.2lf\n",nTask,usec[0],usec[1],usec[2]);
+		nExpected+=nRepeat*nTask*3;
+	}
+
+	if(nExpected!=count)
+	{
+		fprintf(stderr,"Some tasks did not run.\n");
+		return YSERR;
+	}
+	return YSOK;
+}
+
+int main(void)
+{
+	int nFail=0;
+
+	YsTaskScheduler scheduler4(4),scheduler1(1),scheduler0(0);
+	for(auto schedulerPtr : {&scheduler4,&scheduler1,&scheduler0})
+	{
+		printf("%lld worker threads\n",schedulerPtr->GetN());
+		if(YSOK!=NestedParallelForTest(*schedulerPtr))
+		{
+			++nFail;
+		}
+		if(YSOK!=NestedTaskGroupTest(*schedulerPtr))
+		{
+			++nFail;
+		}
+	}
+	if(YSOK!=NestedThreadPoolTest())
+	{
+		++nFail;
+	}
+	if(YSOK!=RunEquivalenceTest())
+	{
+		++nFail;
+	}
+	if(YSOK!=ChunkEquivalenceTest())
+	{
+		++nFail;
+	}
+	if(YSOK!=MergeSortEquivalenceTest())
+	{
+		++nFail;
+	}
+
+	if(YSOK!=DispatchBenchmark())
+	{
+		++nFail;
+	}
+
+	printf("%d failed.\n",nFail);
+	if(0<nFail)
+	{
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,407 @@
+/* ////////////////////////////////////////////////////////////
+
+File Name: test.cpp
+Copyright (c) 2017 Soji Yamakawa.  All rights reserved.
+http://www.ysflight.com
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, 
+   this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, 
+   this list of conditions and the following disclaimer in the documentation 
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR 
+PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) 
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+//////////////////////////////////////////////////////////// */
+
+#include <ysclass.h>
+#include <ysport.h>
+#include <ysvisual.h>
+#include <ysvisualcache.h>
+
+#include <chrono>
+#include <vector>
+#include <string.h>
+
+
+
+const wchar_t *cacheFn=L"visualcache_test.ysvcache";
+
+
+
+class VisualSrf : public YsVisualSrf
+{
+public:
+	/*! Makes the drawing buffer, which is otherwise made when the model is drawn first. */
+	void PrepareDrawingBuffer(void)
+	{
+		GetDrawingBuffer().RemakePolygonBuffer(*this,0.8);
+		SetPolygonBufferCached(YSTRUE);
+	}
+};
+
+class VisualDnm : public YsVisualDnm
+{
+public:
+	void PrepareDrawingBuffer(void)
+	{
+		for(auto nodePtr : dnmPtr->GetNodePointerAll())
+		{
+			nodePtr->GetDrawingBuffer().RemakePolygonBuffer(*nodePtr,0.8);
+			nodePtr->SetPolygonBufferCached(YSTRUE);
+		}
+	}
+	std::vector <const Dnm::Node *> GetNode(void) const
+	{
+		std::vector <const Dnm::Node *> node;
+		for(auto nodePtr : dnmPtr->GetNodePointerAll())
+		{
+			node.push_back(nodePtr);
+		}
+		return node;
+	}
+	YSBOOL IsCacheable(void) const
+	{
+		for(auto nodePtr : dnmPtr->GetNodePointerAll())
+		{
+			if(YSTRUE!=YsVisualCache::IsCacheable(*nodePtr))
+			{
+				return YSFALSE;
+			}
+		}
+		return YSTRUE;
+	}
+};
+
+
+
+void FindModelFile(std::vector <YsWString> &srfFn,std::vector <YsWString> &dnmFn,const char dir[])
+{
+	YsFileList fileList;
+	if(YSOK!=fileList.FindFileList(dir,nullptr,nullptr))
+	{
+		return;
+	}
+	for(YSSIZE_T i=0; i<fileList.GetN(); ++i)
+	{
+		YsString baseName(fileList.GetSystemEncodingName(i));
+		if(0==strcmp(baseName,".") || 0==strcmp(baseName,".."))
+		{
+			continue;
+		}
+
+		YsString fn;
+		fileList.GetSystemEncodingNameWithPath(fn,i);
+		if(YSTRUE==fileList.IsDirectory(i))
+		{
+			FindModelFile(srfFn,dnmFn,fn);
+		}
+		else
+		{
+			auto ext=baseName.GetExtension();
+			ext.Capitalize();
+
+			YsWString wfn;
+			wfn.SetUTF8String(fn);
+			if(0==strcmp(ext,".SRF"))
+			{
+				srfFn.push_back(wfn);
+			}
+			else if(0==strcmp(ext,".DNM"))
+			{
+				dnmFn.push_back(wfn);
+			}
+		}
+	}
+}
+
+YSRESULT LoadText(YsVisualSrf &srf,const wchar_t fn[])
+{
+	YsFileIO::File fp(fn,"r");
+	if(nullptr!=fp.Fp())
+	{
+		auto inStream=fp.InStream();
+		return srf.Load(inStream);
+	}
+	return YSERR;
+}
+
+YSRESULT LoadText(YsVisualDnm &dnm,const wchar_t fn[])
+{
+	YsString utf8;
+	utf8.EncodeUTF8 <wchar_t> (fn);
+
+	YsFileIO::File fp(fn,"r");
+	if(nullptr!=fp.Fp())
+	{
+		auto inStream=fp.InStream();
+		return dnm.Load(inStream,utf8);
+	}
+	return YSERR;
+}
+
+YSBOOL IsCacheable(const VisualSrf &srf)
+{
+	return YsVisualCache::IsCacheable(srf);
+}
+YSBOOL IsCacheable(const VisualDnm &dnm)
+{
+	return dnm.IsCacheable();
+}
+
+template <class T,const int D>
+YSBOOL SameBuffer(const YsGLBufferTemplate <T,D> &buf0,const YsGLBufferTemplate <T,D> &buf1)
+{
+	if(buf0.GetN()!=buf1.GetN() ||
+	   (0<buf0.GetN() && 0!=memcmp(buf0.GetArrayPointer(),buf1.GetArrayPointer(),sizeof(T)*D*buf0.GetN())))
+	{
+		return YSFALSE;
+	}
+	return YSTRUE;
+}
+
+template <class ShellClass>
+YSBOOL SameShell(const ShellClass &shl0,const ShellClass &shl1)
+{
+	if(shl0.GetNumVertex()!=shl1.GetNumVertex() || shl0.GetNumPolygon()!=shl1.GetNumPolygon())
+	{
+		return YSFALSE;
+	}
+
+	auto plHd0=shl0.AllPolygon().begin();
+	auto plHd1=shl1.AllPolygon().begin();
+	for(; plHd0!=shl0.AllPolygon().end(); ++plHd0,++plHd1)
+	{
+		auto plVtHd0=shl0.GetPolygonVertex(*plHd0);
+		auto plVtHd1=shl1.GetPolygonVertex(*plHd1);
+		if(plVtHd0.GetN()!=plVtHd1.GetN() ||
+		   shl0.GetColor(*plHd0)!=shl1.GetColor(*plHd1) ||
+		   shl0.GetNormal(*plHd0)!=shl1.GetNormal(*plHd1))
+		{
+			return YSFALSE;
+		}
+		for(YSSIZE_T i=0; i<plVtHd0.GetN(); ++i)
+		{
+			if(shl0.GetVertexPosition(plVtHd0[i])!=shl1.GetVertexPosition(plVtHd1[i]))
+			{
+				return YSFALSE;
+			}
+		}
+	}
+
+	auto &buf0=shl0.GetDrawingBuffer();
+	auto &buf1=shl1.GetDrawingBuffer();
+	if(YSTRUE!=SameBuffer(buf0.solidShadedVtxBuffer,buf1.solidShadedVtxBuffer) ||
+	   YSTRUE!=SameBuffer(buf0.solidShadedNomBuffer,buf1.solidShadedNomBuffer) ||
+	   YSTRUE!=SameBuffer(buf0.solidShadedColBuffer,buf1.solidShadedColBuffer) ||
+	   YSTRUE!=SameBuffer(buf0.trspShadedVtxBuffer,buf1.trspShadedVtxBuffer) ||
+	   YSTRUE!=SameBuffer(buf0.backFaceVtxBuffer,buf1.backFaceVtxBuffer) ||
+	   YSTRUE!=SameBuffer(buf0.normalEdgePosBuffer,buf1.normalEdgePosBuffer) ||
+	   YSTRUE!=SameBuffer(buf0.lightVtxBuffer,buf1.lightVtxBuffer) ||
+	   YSTRUE!=SameBuffer(buf0.lightSizeBuffer,buf1.lightSizeBuffer))
+	{
+		return YSFALSE;
+	}
+	return YSTRUE;
+}
+
+YSBOOL SameModel(const VisualSrf &srf0,const VisualSrf &srf1)
+{
+	return SameShell(srf0,srf1);
+}
+
+YSBOOL SameModel(const VisualDnm &dnm0,const VisualDnm &dnm1)
+{
+	auto node0=dnm0.GetNode();
+	auto node1=dnm1.GetNode();
+	if(node0.size()!=node1.size())
+	{
+		return YSFALSE;
+	}
+	for(size_t i=0; i<node0.size(); ++i)
+	{
+		if(0!=strcmp(node0[i]->nodeName,node1[i]->nodeName) ||
+		   node0[i]->GetSearchKey()!=node1[i]->GetSearchKey() ||
+		   node0[i]->dnmClassType!=node1[i]->dnmClassType ||
+		   node0[i]->stateArray.GetN()!=node1[i]->stateArray.GetN() ||
+		   node0[i]->posInParent!=node1[i]->posInParent ||
+		   (nullptr==node0[i]->parent)!=(nullptr==node1[i]->parent) ||
+		   (nullptr!=node0[i]->parent && node0[i]->parent->GetSearchKey()!=node1[i]->parent->GetSearchKey()) ||
+		   dnm0.GetDnmNodeNumberFromName(node0[i]->nodeName)!=dnm1.GetDnmNodeNumberFromName(node1[i]->nodeName) ||
+		   YSTRUE!=SameShell(*node0[i],*node1[i]))
+		{
+			return YSFALSE;
+		}
+	}
+	return YSTRUE;
+}
+
+template <class VisualClass>
+YSRESULT TestVisualCache(const std::vector <YsWString> &modelFn,const char label[])
+{
+	int nFail=0,nCached=0;
+	double textTime=0.0,saveTime=0.0,cacheTime=0.0;
+
+	for(auto &fn : modelFn)
+	{
+		YsString utf8;
+		utf8.EncodeUTF8 <wchar_t> (fn);
+
+		YsVisualCache::SourceInfo src;
+		if(YSOK!=src.Get(fn))
+		{
+			fprintf(stderr,"Error! Cannot get the file information: %s\n",utf8.Txt());
+			++nFail;
+			continue;
+		}
+
+		// Text parsing and tessellation that is done before the first draw.
+		VisualClass text;
+		auto t0=std::chrono::high_resolution_clock::now();
+		if(YSOK!=LoadText(text,fn))
+		{
+			printf("Skipped %s\n",utf8.Txt());
+			continue;
+		}
+		text.PrepareDrawingBuffer();
+		auto t1=std::chrono::high_resolution_clock::now();
+
+		if(YSTRUE!=IsCacheable(text))
+		{
+			printf("Not cacheable %s\n",utf8.Txt());
+			continue;
+		}
+		if(YSOK!=YsVisualCache::Save(cacheFn,src,text))
+		{
+			fprintf(stderr,"Error! Cannot write the cache: %s\n",utf8.Txt());
+			++nFail;
+			continue;
+		}
+		auto t2=std::chrono::high_resolution_clock::now();
+
+		VisualClass cached;
+		if(YSOK!=YsVisualCache::Load(cached,cacheFn,src))
+		{
+			fprintf(stderr,"Error! Cannot read the cache: %s\n",utf8.Txt());
+			++nFail;
+			continue;
+		}
+		auto t3=std::chrono::high_resolution_clock::now();
+
+		if(YSTRUE!=SameModel(text,cached))
+		{
+			fprintf(stderr,"Error! The cache does not match the text: %s\n",utf8.Txt());
+			++nFail;
+			continue;
+		}
+
+		// Cache made from a different version of the source must be rejected.
+		YsVisualCache::SourceInfo stale=src;
+		stale.size+=1;
+		VisualClass rejected;
+		if(YSOK==YsVisualCache::Load(rejected,cacheFn,stale))
+		{
+			fprintf(stderr,"Error! A stale cache was accepted: %s\n",utf8.Txt());
+			++nFail;
+			continue;
+		}
+		stale=src;
+		stale.modifiedTime+=1;
+		if(YSOK==YsVisualCache::Load(rejected,cacheFn,stale))
+		{
+			fprintf(stderr,"Error! A stale cache was accepted: %s\n",utf8.Txt());
+			++nFail;
+			continue;
+		}
+
+		++nCached;
+		textTime+=std::chrono::duration_cast<std::chrono::microseconds>(t1-t0).count()/1000000.0;
+		saveTime+=std::chrono::duration_cast<std::chrono::microseconds>(t2-t1).count()/1000000.0;
+		cacheTime+=std::chrono::duration_cast<std::chrono::microseconds>(t3-t2).count()/1000000.0;
+	}
+	YsFileIO::Remove(cacheFn);
+
+	printf("%d %s files, %d cached\n",(int)modelFn.size(),label,nCached);
+	if(0<textTime && 0<cacheTime)
+	{
+		printf("Text parse and tessellation %.2lf ms\n",textTime*1000.0);
+		printf("Cache write                 %.2lf ms\n",saveTime*1000.0);
+		printf("Cache read                  %.2lf ms\n",cacheTime*1000.0);
+		printf("Speed up x%.2lf\n",textTime/cacheTime);
+	}
+
+	if(0<nFail)
+	{
+		return YSERR;
+	}
+	return YSOK;
+}
+
+// The cache is written to a temporary file and renamed.  Nothing must be left after the cache files are written
+// over and over.
+YSRESULT TestNoTemporaryFile(void)
+{
+	YsFileList fileList;
+	if(YSOK!=fileList.FindFileList(".",nullptr,nullptr))
+	{
+		fprintf(stderr,"Error! Cannot list the current directory.\n");
+		return YSERR;
+	}
+
+	YsString prefix;
+	prefix.EncodeUTF8 <wchar_t> (cacheFn);
+	prefix.Append(".");
+	for(YSSIZE_T i=0; i<fileList.GetN(); ++i)
+	{
+		YsString baseName(fileList.GetSystemEncodingName(i));
+		if(0==strncmp(baseName,prefix,prefix.Strlen()))
+		{
+			fprintf(stderr,"Error! Temporary file is left: %s\n",baseName.Txt());
+			return YSERR;
+		}
+	}
+	return YSOK;
+}
+
+int main(int ac,char *av[])
+{
+	std::vector <YsWString> srfFn,dnmFn;
+	for(int i=1; i<ac; ++i)
+	{
+		FindModelFile(srfFn,dnmFn,av[i]);
+	}
+
+	int nFail=0;
+	if(YSOK!=TestVisualCache<VisualSrf>(srfFn,"SRF"))
+	{
+		++nFail;
+	}
+	if(YSOK!=TestVisualCache<VisualDnm>(dnmFn,"DNM"))
+	{
+		++nFail;
+	}
+	if(YSOK!=TestNoTemporaryFile())
+	{
+		++nFail;
+	}
+
+	printf("%d failed.\n",nFail);
+	if(0<nFail)
+	{
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,280 @@
+/* ////////////////////////////////////////////////////////////
+
+File Name: test.cpp
+Copyright (c) 2017 Soji Yamakawa.  All rights reserved.
+http://www.ysflight.com
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, 
+   this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, 
+   this list of conditions and the following disclaimer in the documentation 
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR 
+PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) 
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+//////////////////////////////////////////////////////////// */
+
+#include <chrono>
+#include <vector>
+#include <math.h>
+#include <stdio.h>
+
+#include <ysclass.h>
+#include <ysclass11.h>
+#include <ysglcpp.h>
+#include <ysglparticlemanager.h>
+
+
+
+// Smoke trails that lose the oldest puff and get a new one at the end, like FsAirplane smoke, and drifting cloud particles.
+class ParticleScene
+{
+public:
+	class Trail
+	{
+	public:
+		std::vector <YsVec3> puff;
+		YsVec3 head,vel;
+	};
+	std::vector <Trail> trail;
+	std::vector <YsVec3> cloud;
+	unsigned int seed;
+
+	double Random(void)
+	{
+		seed=seed*1103515245+12345;
+		return (double)((seed>>8)&0xffff)/65535.0;
+	}
+
+	void Make(int nTrail,int nPuffPerTrail,int nCloud)
+	{
+		seed=12345;
+		trail.resize(nTrail);
+		for(auto &t : trail)
+		{
+			t.head.Set(Random()*8000.0-4000.0,500.0+Random()*3000.0,Random()*8000.0-4000.0);
+			t.vel.Set(Random()*400.0-200.0,Random()*20.0-10.0,Random()*400.0-200.0);
+			for(int i=0; i<nPuffPerTrail; ++i)
+			{
+				t.puff.push_back(t.head-t.vel*0.05*(double)(nPuffPerTrail-i));
+			}
+		}
+		cloud.resize(nCloud);
+		for(auto &c : cloud)
+		{
+			c.Set(Random()*20000.0-10000.0,1000.0+Random()*500.0,Random()*20000.0-10000.0);
+		}
+	}
+	void Advance(int frame)
+	{
+		for(auto &t : trail)
+		{
+			t.head+=t.vel/60.0;
+			if(0==frame%3)
+			{
+				t.puff.erase(t.puff.begin());
+				t.puff.push_back(t.head);
+			}
+		}
+		for(auto &c : cloud)
+		{
+			c.AddX(0.2);
+		}
+	}
+	void AddTo(YsGLParticleManager &partMan) const
+	{
+		for(auto &t : trail)
+		{
+			for(auto &p : t.puff)
+			{
+				partMan.Add(p,YsWhite(),10.0f,0.0f,0.0f);
+			}
+		}
+		for(auto &c : cloud)
+		{
+			partMan.Add(c,YsWhite(),80.0f,0.125f,0.0f);
+		}
+	}
+};
+
+class Camera
+{
+public:
+	YsVec3 pos,dir;
+	void Set(int frame,YSBOOL cut)
+	{
+		// Circling around the scene at 150m/s, 60 frames per second.  A cut jumps to the opposite side.
+		double a=(double)frame*150.0/60.0/5000.0;
+		if(YSTRUE==cut && 0!=(frame/100)%2)
+		{
+			a+=YsPi;
+		}
+		pos.Set(5000.0*cos(a),1500.0,5000.0*sin(a));
+		dir.Set(-sin(a)-0.3*cos(a),-0.05,cos(a)-0.3*sin(a));
+		dir.Normalize();
+	}
+};
+
+double VertexDepth(const YsGLVertexBuffer &buf,YSSIZE_T idx,const Camera &cam)
+{
+	auto vtx=buf[idx];
+	return (YsVec3(vtx[0],vtx[1],vtx[2])-cam.pos)*cam.dir;
+}
+
+YSRESULT CompareBuffer(const YsGLVertexBuffer &ref,const YsGLVertexBuffer &tst,const Camera &cam,YSSIZE_T stride,int frame)
+{
+	if(ref.GetN()!=tst.GetN())
+	{
+		fprintf(stderr,"Frame %d: Number of vertices differ %lld %lld\n",frame,(long long)ref.GetN(),(long long)tst.GetN());
+		return YSERR;
+	}
+	for(YSSIZE_T i=0; i<tst.GetN(); i+=stride)
+	{
+		// Same depth sequence, and from far to near.
+		const double refDepth=VertexDepth(ref,i,cam),tstDepth=VertexDepth(tst,i,cam);
+		if(0.5<fabs(refDepth-tstDepth))
+		{
+			fprintf(stderr,"Frame %d: Depth differs at %lld %lf %lf\n",frame,(long long)i,refDepth,tstDepth);
+			return YSERR;
+		}
+		if(stride<=i && VertexDepth(tst,i-stride,cam)<tstDepth-0.5)
+		{
+			fprintf(stderr,"Frame %d: Not sorted at %lld\n",frame,(long long)i);
+			return YSERR;
+		}
+	}
+	return YSOK;
+}
+
+YSRESULT CoherentSortTest(YSBOOL cut)
+{
+	ParticleScene scene;
+	scene.Make(200,100,20000);
+
+	YsGLParticleManager refMan,tstMan;
+	tstMan.SetSortMethod(YsGLParticleManager::SORT_COHERENT);
+
+	for(int frame=0; frame<300; ++frame)
+	{
+		Camera cam;
+		cam.Set(frame,cut);
+		scene.Advance(frame);
+
+		refMan.CleanUp();
+		scene.AddTo(refMan);
+		refMan.Sort(cam.pos,cam.dir);
+		refMan.MakeBufferForTriangle(cam.dir,0.125,1000.0);
+		refMan.MakeBufferForPointSprite(1000.0);
+
+		tstMan.ClearParticle();
+		scene.AddTo(tstMan);
+		tstMan.Sort(cam.pos,cam.dir);
+		tstMan.MakeBufferForTriangle(cam.dir,0.125,1000.0);
+		tstMan.MakeBufferForPointSprite(1000.0);
+
+		if(YSOK!=CompareBuffer(refMan.pntVtxBuf,tstMan.pntVtxBuf,cam,1,frame) ||
+		   YSOK!=CompareBuffer(refMan.triVtxBuf,tstMan.triVtxBuf,cam,6,frame))
+		{
+			return YSERR;
+		}
+	}
+	return YSOK;
+}
+
+void Benchmark(YsGLParticleManager::SORT_METHOD sortMethod,YsThreadPool *thrPool,YSBOOL cut)
+{
+	ParticleScene scene;
+	scene.Make(200,100,40000);
+
+	YsGLParticleManager partMan;
+	partMan.SetSortMethod(sortMethod);
+
+	const int nFrame=300;
+	long long int sortTime=0,bufferTime=0;
+	long long int nOutOfOrder=0;
+	int nRadix=0;
+	for(int frame=0; frame<nFrame; ++frame)
+	{
+		Camera cam;
+		cam.Set(frame,cut);
+		scene.Advance(frame);
+
+		partMan.ClearParticle();
+		scene.AddTo(partMan);
+
+		auto t0=std::chrono::high_resolution_clock::now();
+		if(nullptr!=thrPool)
+		{
+			partMan.Sort(cam.pos,cam.dir,*thrPool);
+		}
+		else
+		{
+			partMan.Sort(cam.pos,cam.dir);
+		}
+		auto t1=std::chrono::high_resolution_clock::now();
+		partMan.MakeBufferForTriangle(cam.dir,0.125,1000.0);
+		partMan.MakeBufferForPointSprite(1000.0);
+		auto t2=std::chrono::high_resolution_clock::now();
+
+		sortTime+=std::chrono::duration_cast <std::chrono::microseconds> (t1-t0).count();
+		bufferTime+=std::chrono::duration_cast <std::chrono::microseconds> (t2-t1).count();
+		nOutOfOrder+=partMan.GetSortStatistics().nOutOfOrder;
+		if(YSTRUE==partMan.GetSortStatistics().usedRadixSort)
+		{
+			++nRadix;
+		}
+	}
+
+	printf("%s %s %s: %lld particles  Sort %.3lfms  Buffer %.3lfms per frame  Out of order %.1lf%%  Radix %d/%d frames\n",
+	    (YsGLParticleManager::SORT_COHERENT==sortMethod ? "Coherent " : "MergeSort"),
+	    (nullptr!=thrPool ? "ThreadPool" : "Serial    "),
+	    (YSTRUE==cut ? "Cut every 100 frames" : "Continuous          "),
+	    (long long)partMan.GetNumParticle(),
+	    (double)sortTime/1000.0/nFrame,
+	    (double)bufferTime/1000.0/nFrame,
+	    100.0*(double)nOutOfOrder/(double)(nFrame*partMan.GetNumParticle()),
+	    nRadix,nFrame);
+}
+
+int main(void)
+{
+	int nFail=0;
+
+	if(YSOK!=CoherentSortTest(YSFALSE))
+	{
+		++nFail;
+	}
+	if(YSOK!=CoherentSortTest(YSTRUE))
+	{
+		++nFail;
+	}
+
+	YsThreadPool thrPool(4);
+	for(auto cut : {YSFALSE,YSTRUE})
+	{
+		Benchmark(YsGLParticleManager::SORT_MERGESORT,nullptr,cut);
+		Benchmark(YsGLParticleManager::SORT_COHERENT,nullptr,cut);
+		Benchmark(YsGLParticleManager::SORT_MERGESORT,&thrPool,cut);
+		Benchmark(YsGLParticleManager::SORT_COHERENT,&thrPool,cut);
+	}
+
+	printf("%d failed.\n",nFail);
+	if(0<nFail)
+	{
+		return 1;
+	}
+	return 0;
+}
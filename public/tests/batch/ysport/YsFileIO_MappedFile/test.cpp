@@ -0,0 +1,147 @@
+/* ////////////////////////////////////////////////////////////
+
+File Name: test.cpp
+Copyright (c) 2017 Soji Yamakawa.  All rights reserved.
+http://www.ysflight.com
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, 
+   this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, 
+   this list of conditions and the following disclaimer in the documentation 
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR 
+PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) 
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+//////////////////////////////////////////////////////////// */
+
+#include <stdio.h>
+#include <ysclass.h>
+#include <ysport.h>
+
+
+
+static int CompareContents(const YsFileIO::MappedFile &mapped,const YsArray <unsigned char> &dat)
+{
+	if(YSTRUE!=mapped.IsOpen())
+	{
+		printf("File is not open.\n");
+		return 1;
+	}
+	if(mapped.size()!=dat.GetN())
+	{
+		printf("Size mismatch (%lld, expected %lld).\n",mapped.size(),(long long int)dat.GetN());
+		return 1;
+	}
+	if(0<dat.GetN() && 0!=memcmp(mapped.data(),dat.GetArray(),dat.GetN()))
+	{
+		printf("Contents mismatch.\n");
+		return 1;
+	}
+	return 0;
+}
+
+int TestMappedFile(void)
+{
+	printf("@@@ TESTING: YsFileIO::MappedFile\n");
+
+	int nFail=0;
+	const char fn[]="test_batch_ysport_mappedfile.bin";
+
+	YsArray <unsigned char> dat;
+	for(int i=0; i<100000; ++i)
+	{
+		dat.Append((unsigned char)(i*7+i/256));
+	}
+	{
+		YsFileIO::File fp(fn,"wb");
+		fp.Fwrite(dat);
+	}
+
+	YsFileIO::MappedFile mapped;
+	if(YSOK!=mapped.Open(fn))
+	{
+		printf("Cannot open the file.\n");
+		return 1;
+	}
+	printf("Mapped=%s\n",YsBoolToStr(mapped.IsMapped()));
+	nFail+=CompareContents(mapped,dat);
+
+	// Moving must keep the contents.
+	YsFileIO::MappedFile moved(std::move(mapped));
+	if(YSTRUE==mapped.IsOpen() || nullptr!=mapped.data())
+	{
+		printf("Moved-from object still holds the file.\n");
+		++nFail;
+	}
+	nFail+=CompareContents(moved,dat);
+
+	moved.Close();
+	if(YSTRUE==moved.IsOpen() || 0!=moved.size())
+	{
+		printf("Close failed.\n");
+		++nFail;
+	}
+
+	// Empty file cannot be mapped, but must still open.
+	{
+		YsFileIO::File fp(fn,"wb");
+	}
+	dat.Clear();
+	if(YSOK!=moved.Open(fn))
+	{
+		printf("Cannot open an empty file.\n");
+		++nFail;
+	}
+	else
+	{
+		nFail+=CompareContents(moved,dat);
+	}
+	moved.Close();
+
+	if(YSOK==moved.Open("test_batch_ysport_mappedfile_does_not_exist.bin"))
+	{
+		printf("Opened a file that does not exist.\n");
+		++nFail;
+	}
+
+	YsFileIO::Remove(fn);
+
+	if(0==nFail)
+	{
+		printf("@@@ TEST RESULT: OK\n");
+	}
+	else
+	{
+		printf("@@@ TEST RESULT: ERROR\n");
+	}
+	return nFail;
+}
+
+
+
+int main(void)
+{
+	int nFail=0;
+
+	nFail+=TestMappedFile();
+
+	printf("%d failed.\n",nFail);
+	if(0<nFail)
+	{
+		return 1;
+	}
+	return 0;
+}
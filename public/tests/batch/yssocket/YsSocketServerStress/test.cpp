@@ -0,0 +1,424 @@
+/* ////////////////////////////////////////////////////////////
+
+File Name: test.cpp
+Copyright (c) 2017 Soji Yamakawa.  All rights reserved.
+http://www.ysflight.com
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, 
+   this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, 
+   this list of conditions and the following disclaimer in the documentation 
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR 
+PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) 
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+//////////////////////////////////////////////////////////// */
+
+#include <yssocket.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <vector>
+
+#ifdef YSSOCKET_USE_EPOLL
+
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+
+
+// 64 clients on the loopback.  16 of them read very slowly.
+// The server must not be blocked by the slow clients, and every message it accepted must arrive intact.
+
+const int nClient=64;
+const int nSlowClient=16;
+const int nRound=200;
+const int serverSendBufferSize=64*1024;
+const double maxServerLoopTime=0.1;
+
+class TestServer : public YsSocketServer
+{
+public:
+	long long nByteReceived[nClient];
+	int nAccepted,nClosed;
+
+	TestServer(int port) : YsSocketServer(port,nClient)
+	{
+		for(auto &n : nByteReceived)
+		{
+			n=0;
+		}
+		nAccepted=0;
+		nClosed=0;
+	}
+	virtual YSRESULT ReceivedFrom(int clientId,YSSIZE_T nBytes,unsigned char [])
+	{
+		nByteReceived[clientId]+=nBytes;
+		return YSOK;
+	}
+	virtual YSRESULT ConnectionAccepted(int clientId,unsigned int [4])
+	{
+		// Loopback kernel buffer is large enough to hide a slow client.  Make it small.
+		if(clientId<nSlowClient)
+		{
+			int sndBuf=4096;
+			setsockopt(clientSock[clientId],SOL_SOCKET,SO_SNDBUF,&sndBuf,sizeof(sndBuf));
+		}
+		++nAccepted;
+		return YSOK;
+	}
+	virtual YSRESULT ConnectionClosedByClient(int)
+	{
+		++nClosed;
+		return YSOK;
+	}
+};
+
+class TestClient
+{
+public:
+	int sock;
+	YSBOOL slow;
+	std::vector <unsigned char> received;
+	long long nByteReceived,nByteSent;
+	int nMessage;
+	int lastSeq;
+	YSBOOL error;
+
+	TestClient()
+	{
+		sock=-1;
+		slow=YSFALSE;
+		nByteReceived=0;
+		nByteSent=0;
+		nMessage=0;
+		lastSeq=-1;
+		error=YSFALSE;
+	}
+
+	/*! Reads up to maxRead bytes without blocking, and checks the messages received so far. */
+	void Read(YSSIZE_T maxRead)
+	{
+		unsigned char buf[8192];
+		while(0<maxRead)
+		{
+			auto nRead=recv(sock,buf,(maxRead<(YSSIZE_T)sizeof(buf) ? maxRead : sizeof(buf)),MSG_DONTWAIT);
+			if(0>=nRead)
+			{
+				break;
+			}
+			received.insert(received.end(),buf,buf+nRead);
+			nByteReceived+=nRead;
+			maxRead-=nRead;
+		}
+		Parse();
+	}
+	void Parse(void)
+	{
+		YSSIZE_T ptr=0;
+		while(ptr+8<=(YSSIZE_T)received.size())
+		{
+			const unsigned char *msg=received.data()+ptr;
+			const int seq=GetInt(msg);
+			const int len=GetInt(msg+4);
+			if(ptr+8+len>(YSSIZE_T)received.size())
+			{
+				break;
+			}
+			for(int k=0; k<len; ++k)
+			{
+				if(msg[8+k]!=(unsigned char)((seq+k)&255))
+				{
+					printf("Payload broken.\n");
+					error=YSTRUE;
+					break;
+				}
+			}
+			// Slow clients may miss messages that did not fit in the server's buffer.
+			if((YSTRUE!=slow && seq!=lastSeq+1) || (YSTRUE==slow && seq<=lastSeq))
+			{
+				printf("Out of order.  Seq=%d  Last=%d\n",seq,lastSeq);
+				error=YSTRUE;
+			}
+			lastSeq=seq;
+			++nMessage;
+			ptr+=8+len;
+		}
+		received.erase(received.begin(),received.begin()+ptr);
+	}
+	static int GetInt(const unsigned char dat[])
+	{
+		return dat[0]|(dat[1]<<8)|(dat[2]<<16)|(dat[3]<<24);
+	}
+};
+
+static void MakeMessage(std::vector <unsigned char> &msg,int seq,int len)
+{
+	msg.resize(8+len);
+	for(int i=0; i<4; ++i)
+	{
+		msg[i]=(unsigned char)((seq>>(i*8))&255);
+		msg[4+i]=(unsigned char)((len>>(i*8))&255);
+	}
+	for(int k=0; k<len; ++k)
+	{
+		msg[8+k]=(unsigned char)((seq+k)&255);
+	}
+}
+
+static double Elapsed(std::chrono::time_point<std::chrono::high_resolution_clock> t0)
+{
+	return std::chrono::duration<double>(std::chrono::high_resolution_clock::now()-t0).count();
+}
+
+int StressTest(void)
+{
+	int nFail=0;
+
+	TestServer *server=nullptr;
+	int port=0;
+	for(int trial=0; trial<10 && nullptr==server; ++trial)
+	{
+		port=20000+(getpid()+trial*977)%20000;
+		server=new TestServer(port);
+		server->SetSendBufferSize(serverSendBufferSize);
+		if(YSOK!=server->Start())
+		{
+			delete server;
+			server=nullptr;
+		}
+	}
+	if(nullptr==server)
+	{
+		printf("Cannot start the server.\n");
+		return 1;
+	}
+	printf("Port %d\n",port);
+
+	// The listen backlog is small.  Accept each client right after connecting.
+	TestClient client[nClient];
+	for(int i=0; i<nClient; ++i)
+	{
+		client[i].slow=(i<nSlowClient ? YSTRUE : YSFALSE);
+		client[i].sock=socket(PF_INET,SOCK_STREAM,0);
+		if(YSTRUE==client[i].slow)
+		{
+			int rcvBuf=4096;
+			setsockopt(client[i].sock,SOL_SOCKET,SO_RCVBUF,&rcvBuf,sizeof(rcvBuf));
+		}
+
+		struct sockaddr_in addr;
+		memset(&addr,0,sizeof(addr));
+		addr.sin_family=AF_INET;
+		addr.sin_port=htons(port);
+		addr.sin_addr.s_addr=inet_addr("127.0.0.1");
+		if(0!=connect(client[i].sock,(struct sockaddr *)&addr,sizeof(addr)))
+		{
+			printf("Cannot connect client %d.\n",i);
+			return 1;
+		}
+
+		auto t0=std::chrono::high_resolution_clock::now();
+		while(server->nAccepted<=i && Elapsed(t0)<5.0)
+		{
+			server->CheckAndAcceptConnection();
+		}
+		if(server->nAccepted<=i)
+		{
+			printf("Connection not accepted.\n");
+			return 1;
+		}
+	}
+	printf("%d clients connected.\n",nClient);
+
+
+	long long nByteAccepted[nClient];
+	int nSendRejected[nClient];
+	for(int i=0; i<nClient; ++i)
+	{
+		nByteAccepted[i]=0;
+		nSendRejected[i]=0;
+	}
+
+	// Client IDs are given in the order of connection.
+	double worstLoopTime=0.0;
+	std::vector <unsigned char> msg;
+	unsigned char toServer[64];
+	memset(toServer,0,sizeof(toServer));
+	for(int round=0; round<nRound; ++round)
+	{
+		auto t0=std::chrono::high_resolution_clock::now();
+		for(int i=0; i<nClient; ++i)
+		{
+			MakeMessage(msg,round,64+(round*37+i*11)%2000);
+			if(YSOK==server->Send(i,msg.size(),msg.data(),0))
+			{
+				nByteAccepted[i]+=msg.size();
+			}
+			else
+			{
+				++nSendRejected[i];
+			}
+		}
+		server->CheckReceive();
+		const double loopTime=Elapsed(t0);
+		if(worstLoopTime<loopTime)
+		{
+			worstLoopTime=loopTime;
+		}
+
+		for(int i=0; i<nClient; ++i)
+		{
+			if(YSTRUE!=client[i].slow)
+			{
+				client[i].Read(0x7fffffff);
+			}
+			else if(0==round%50)
+			{
+				client[i].Read(512);
+			}
+			auto nSent=send(client[i].sock,toServer,1+(round+i)%sizeof(toServer),MSG_DONTWAIT|MSG_NOSIGNAL);
+			if(0<nSent)
+			{
+				client[i].nByteSent+=nSent;
+			}
+		}
+	}
+
+	printf("Worst server loop time %lfms\n",worstLoopTime*1000.0);
+	if(maxServerLoopTime<worstLoopTime)
+	{
+		printf("Server was blocked.\n");
+		++nFail;
+	}
+	for(int i=nSlowClient; i<nClient; ++i)
+	{
+		if(0<nSendRejected[i])
+		{
+			printf("Send to a fast client %d was rejected %d times.\n",i,nSendRejected[i]);
+			++nFail;
+		}
+	}
+	int nSlowRejected=0;
+	for(int i=0; i<nSlowClient; ++i)
+	{
+		nSlowRejected+=nSendRejected[i];
+	}
+	printf("%d messages to the slow clients were rejected.\n",nSlowRejected);
+	if(0==nSlowRejected)
+	{
+		printf("Slow clients were supposed to overflow the send buffer.\n");
+		++nFail;
+	}
+
+
+	// Drain.  Everything accepted by Send must arrive.
+	auto t0=std::chrono::high_resolution_clock::now();
+	for(;;)
+	{
+		server->CheckReceive();
+
+		YSBOOL done=YSTRUE;
+		for(int i=0; i<nClient; ++i)
+		{
+			client[i].Read(0x7fffffff);
+			if(client[i].nByteReceived<nByteAccepted[i] || server->nByteReceived[i]<client[i].nByteSent)
+			{
+				done=YSFALSE;
+			}
+		}
+		if(YSTRUE==done || 10.0<Elapsed(t0))
+		{
+			break;
+		}
+	}
+	for(int i=0; i<nClient; ++i)
+	{
+		if(client[i].nByteReceived!=nByteAccepted[i])
+		{
+			printf("Client %d received %lld bytes.  Server accepted %lld bytes.\n",i,client[i].nByteReceived,nByteAccepted[i]);
+			++nFail;
+		}
+		if(0!=server->GetNumPendingByte(i))
+		{
+			printf("Client %d still has pending bytes.\n",i);
+			++nFail;
+		}
+		if(server->nByteReceived[i]!=client[i].nByteSent)
+		{
+			printf("Server received %lld bytes from client %d.  Client sent %lld bytes.\n",server->nByteReceived[i],i,client[i].nByteSent);
+			++nFail;
+		}
+		if(YSTRUE==client[i].error || 0!=client[i].received.size())
+		{
+			printf("Client %d received broken data.\n",i);
+			++nFail;
+		}
+		if(YSTRUE!=client[i].slow && nRound!=client[i].nMessage)
+		{
+			printf("Fast client %d received %d messages.\n",i,client[i].nMessage);
+			++nFail;
+		}
+	}
+
+
+	// Closing from the client side.
+	for(int i=0; i<nClient; ++i)
+	{
+		close(client[i].sock);
+	}
+	t0=std::chrono::high_resolution_clock::now();
+	while(server->nClosed<nClient && Elapsed(t0)<5.0)
+	{
+		server->CheckReceive();
+	}
+	if(nClient!=server->nClosed)
+	{
+		printf("Server detected %d closed connections.\n",server->nClosed);
+		++nFail;
+	}
+
+	server->Terminate();
+	delete server;
+
+	return nFail;
+}
+
+#endif
+
+
+
+int main(void)
+{
+	int nFail=0;
+
+#ifdef YSSOCKET_USE_EPOLL
+	nFail+=StressTest();
+#else
+	printf("Non-blocking server is not used in this platform.  Skipped.\n");
+#endif
+
+	printf("%d failed.\n",nFail);
+	if(0<nFail)
+	{
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,353 @@
+/* ////////////////////////////////////////////////////////////
+
+File Name: test.cpp
+Copyright (c) 2017 Soji Yamakawa.  All rights reserved.
+http://www.ysflight.com
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, 
+   this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, 
+   this list of conditions and the following disclaimer in the documentation 
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR 
+PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) 
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+//////////////////////////////////////////////////////////// */
+
+#include <stdio.h>
+#include <ysclass.h>
+#include <yspngenc.h>
+#include <ystexturemanager.h>
+#include <ystexturedecodequeue.h>
+
+// Linked with the null texture back end.  Nothing is sent to the GPU, but the decode queue, the staging queue,
+// and the upload budget work the same as with OpenGL.
+
+static YsArray <unsigned char> MakePng(int wid,int hei,int seed)
+{
+	YsArray <unsigned char> rgba;
+	rgba.resize(wid*hei*4);
+	for(int i=0; i<wid*hei; ++i)
+	{
+		rgba[i*4  ]=(unsigned char)(i+seed);
+		rgba[i*4+1]=(unsigned char)(i*3+seed);
+		rgba[i*4+2]=(unsigned char)(i*7+seed);
+		rgba[i*4+3]=255;
+	}
+
+	YsMemoryPngEncoder encoder;
+	encoder.verboseMode=YSFALSE;
+	encoder.Encode(wid,hei,8,6,rgba);
+
+	YsArray <unsigned char> png;
+	png.Set(encoder.GetLength(),encoder.GetByteData());
+	return png;
+}
+
+static const int nTex=6;
+static const int texWid[nTex]={64,33,128,17,256,40};
+static const int texHei[nTex]={64,65,32,200,256,1};
+
+static void AddTextures(YsTextureManager &texMan,YsTextureManager::TexHandle texHd[nTex])
+{
+	for(int i=0; i<nTex; ++i)
+	{
+		auto png=MakePng(texWid[i],texHei[i],i);
+		texHd[i]=texMan.AddTexture("",YsTextureManager::FOM_PNG,0,0,png);
+	}
+}
+
+YSRESULT TestStagedUpload(void)
+{
+	printf("%s\n",__FUNCTION__);
+
+	// No worker thread.  Textures are decoded only in WaitDecode so that the test is deterministic.
+	YsTextureDecodeQueue decodeQueue(0,4);
+	YsTextureManager texMan;
+	texMan.SetDecodeQueue(&decodeQueue);
+
+	YsTextureManager::TexHandle texHd[nTex];
+	AddTextures(texMan,texHd);
+
+	long long int totalByte=0;
+	for(int i=0; i<nTex; ++i)
+	{
+		auto unitPtr=texMan.GetTextureReady(texHd[i]);
+		if(nullptr==unitPtr || YSTRUE!=unitPtr->IsDecoding() || YSTRUE==unitPtr->IsBitmapLoaded())
+		{
+			fprintf(stderr,"Texture %d is not in the decode queue.\n",i);
+			return YSERR;
+		}
+		totalByte+=texWid[i]*texHei[i]*4;
+	}
+
+	auto stat=decodeQueue.GetStatistics();
+	if(4!=stat.nDecoding || 2!=stat.nWaiting || 0!=stat.nStaged)
+	{
+		fprintf(stderr,"Wrong queue depth (%lld decoding, %lld waiting, %lld staged)\n",stat.nDecoding,stat.nWaiting,stat.nStaged);
+		return YSERR;
+	}
+
+	decodeQueue.WaitDecode();
+	stat=decodeQueue.GetStatistics();
+	if(0!=stat.nDecoding || 2!=stat.nWaiting || 4!=stat.nStaged || 4!=stat.nDecoded)
+	{
+		fprintf(stderr,"Staging queue is not bounded (%lld decoding, %lld waiting, %lld staged)\n",stat.nDecoding,stat.nWaiting,stat.nStaged);
+		return YSERR;
+	}
+
+	// At least one texture is uploaded even if it is bigger than the budget.
+	if(1!=decodeQueue.Upload(1))
+	{
+		fprintf(stderr,"Upload budget is not respected.\n");
+		return YSERR;
+	}
+	int nLoaded=0;
+	for(int i=0; i<nTex; ++i)
+	{
+		if(YSTRUE==texMan.GetTexture(texHd[i])->IsBitmapLoaded())
+		{
+			++nLoaded;
+		}
+	}
+	if(1!=nLoaded)
+	{
+		fprintf(stderr,"%d textures are marked as loaded after uploading one.\n",nLoaded);
+		return YSERR;
+	}
+
+	// Uploading makes room in the staging queue, and the remaining two are dispatched.
+	decodeQueue.Upload(totalByte);
+	decodeQueue.WaitDecode();
+	decodeQueue.Upload(totalByte);
+
+	stat=decodeQueue.GetStatistics();
+	if(nTex!=stat.nUploaded || totalByte!=stat.nUploadedByte || 0!=stat.nWaiting+stat.nDecoding+stat.nStaged)
+	{
+		fprintf(stderr,"Not all textures are uploaded (%lld uploaded %lld bytes)\n",stat.nUploaded,stat.nUploadedByte);
+		return YSERR;
+	}
+	if(stat.maxDecodeLatency<0.0 || stat.totalDecodeLatency<stat.maxDecodeLatency)
+	{
+		fprintf(stderr,"Wrong decode latency.\n");
+		return YSERR;
+	}
+
+	for(int i=0; i<nTex; ++i)
+	{
+		auto unitPtr=texMan.GetTexture(texHd[i]);
+		if(YSTRUE!=unitPtr->IsBitmapLoaded() || YSTRUE==unitPtr->IsDecoding() ||
+		   texWid[i]!=unitPtr->GetWidth() || texHei[i]!=unitPtr->GetHeight())
+		{
+			fprintf(stderr,"Texture %d is not uploaded correctly.\n",i);
+			return YSERR;
+		}
+	}
+
+	return YSOK;
+}
+
+YSRESULT TestCancel(void)
+{
+	printf("%s\n",__FUNCTION__);
+
+	YsTextureDecodeQueue decodeQueue(0,2);
+	YsTextureManager texMan;
+	texMan.SetDecodeQueue(&decodeQueue);
+
+	YsTextureManager::TexHandle texHd[nTex];
+	AddTextures(texMan,texHd);
+
+	for(int i=0; i<nTex; ++i)
+	{
+		texMan.RequestAsyncDecode(texHd[i]);
+	}
+
+	// One dispatched and one waiting texture are deleted, one dispatched texture gets new data, and
+	// one waiting texture is made synchronously.
+	texMan.Delete(texHd[0]);
+	texMan.Delete(texHd[2]);
+	auto png=MakePng(8,8,0);
+	texMan.SetTextureFileData(texHd[1],YsTextureManager::FOM_PNG,0,0,png);
+	texMan.GetTexture(texHd[3])->MakeActualTexture();
+
+	if(YSTRUE==texMan.GetTexture(texHd[1])->IsDecoding() || YSTRUE==texMan.GetTexture(texHd[3])->IsDecoding())
+	{
+		fprintf(stderr,"Request is not cancelled.\n");
+		return YSERR;
+	}
+
+	for(int i=0; i<4; ++i)
+	{
+		decodeQueue.WaitDecode();
+		decodeQueue.Upload(1024*1024);
+	}
+
+	auto stat=decodeQueue.GetStatistics();
+	if(2!=stat.nUploaded || 0!=stat.nWaiting+stat.nDecoding+stat.nStaged)
+	{
+		fprintf(stderr,"Cancelled textures are uploaded (%lld uploaded)\n",stat.nUploaded);
+		return YSERR;
+	}
+	if(YSTRUE==texMan.GetTexture(texHd[1])->IsBitmapLoaded())
+	{
+		fprintf(stderr,"Old data is uploaded to a texture with new data.\n");
+		return YSERR;
+	}
+	if(YSTRUE!=texMan.GetTexture(texHd[4])->IsBitmapLoaded() || YSTRUE!=texMan.GetTexture(texHd[5])->IsBitmapLoaded())
+	{
+		fprintf(stderr,"Textures that are not cancelled are not uploaded.\n");
+		return YSERR;
+	}
+	return YSOK;
+}
+
+YSRESULT TestQueueDeletedFirst(void)
+{
+	printf("%s\n",__FUNCTION__);
+
+	YsTextureManager texMan;
+	YsTextureManager::TexHandle texHd[nTex];
+	AddTextures(texMan,texHd);
+
+	{
+		YsTextureDecodeQueue decodeQueue(1,2);
+		YsTextureManager::SetDefaultDecodeQueue(&decodeQueue);
+		for(int i=0; i<nTex; ++i)
+		{
+			texMan.GetTextureReady(texHd[i]);
+		}
+		YsTextureManager::SetDefaultDecodeQueue(nullptr);
+	}
+
+	for(int i=0; i<nTex; ++i)
+	{
+		auto unitPtr=texMan.GetTexture(texHd[i]);
+		if(YSTRUE==unitPtr->IsDecoding())
+		{
+			fprintf(stderr,"Texture %d is still waiting for a deleted queue.\n",i);
+			return YSERR;
+		}
+
+		// Without a queue, the texture is made synchronously.
+		texMan.GetTextureReady(texHd[i]);
+		if(YSTRUE!=unitPtr->IsBitmapLoaded() || texWid[i]!=unitPtr->GetWidth())
+		{
+			fprintf(stderr,"Texture %d is not made synchronously.\n",i);
+			return YSERR;
+		}
+	}
+	return YSOK;
+}
+
+YSRESULT TestWorkerThread(void)
+{
+	printf("%s\n",__FUNCTION__);
+
+	YsTextureDecodeQueue decodeQueue(2,3);
+	YsTextureManager texMan;
+	texMan.SetDecodeQueue(&decodeQueue);
+
+	YsTextureManager::TexHandle texHd[nTex];
+	AddTextures(texMan,texHd);
+	for(int i=0; i<nTex; ++i)
+	{
+		texMan.GetTextureReady(texHd[i]);
+	}
+
+	for(int loop=0; loop<1000 && decodeQueue.GetStatistics().nUploaded<nTex; ++loop)
+	{
+		decodeQueue.WaitDecode();
+		decodeQueue.Upload(64*64*4);
+	}
+
+	auto stat=decodeQueue.GetStatistics();
+	printf("Average decode latency %lfms  Max %lfms\n",1000.0*stat.totalDecodeLatency/(double)stat.nDecoded,1000.0*stat.maxDecodeLatency);
+	if(nTex!=stat.nUploaded)
+	{
+		fprintf(stderr,"Not all textures are uploaded.\n");
+		return YSERR;
+	}
+	return YSOK;
+}
+
+YSRESULT TestRandomNoiseSeed(void)
+{
+	printf("%s\n",__FUNCTION__);
+
+	auto png=MakePng(64,64,0);
+	YsArray <unsigned char> rgba[3];
+	const unsigned int seed[3]={1,1,2};
+	for(int i=0; i<3; ++i)
+	{
+		YsTextureDecodeJob job;
+		job.fileDataLength=png.GetN();
+		job.fileData=png;
+		job.effectType=YsTextureManager::Unit::EFFECT_RANDOMNOISE;
+		job.randomNoiseLevel=0.5;
+		job.randomNoiseSeed=seed[i];
+		job.Decode();
+		if(YSOK!=job.res)
+		{
+			fprintf(stderr,"Cannot decode.\n");
+			return YSERR;
+		}
+		rgba[i].Set(job.wid*job.hei*4,job.rgba);
+	}
+
+	if(!(rgba[0]==rgba[1]))
+	{
+		fprintf(stderr,"Same seed gives different noise.\n");
+		return YSERR;
+	}
+	if(rgba[0]==rgba[2])
+	{
+		fprintf(stderr,"Different seeds give the same noise.\n");
+		return YSERR;
+	}
+	return YSOK;
+}
+
+int main(void)
+{
+	int nFail=0;
+	if(YSOK!=TestStagedUpload())
+	{
+		++nFail;
+	}
+	if(YSOK!=TestCancel())
+	{
+		++nFail;
+	}
+	if(YSOK!=TestQueueDeletedFirst())
+	{
+		++nFail;
+	}
+	if(YSOK!=TestWorkerThread())
+	{
+		++nFail;
+	}
+	if(YSOK!=TestRandomNoiseSeed())
+	{
+		++nFail;
+	}
+	printf("%d failed.\n",nFail);
+	if(0<nFail)
+	{
+		return 1;
+	}
+	return 0;
+}
@@ -368,12 +368,20 @@ FsAutopilot::FsAutopilot()
 	// For ShallowPursuit
 	shallowPursuitState=0;
 	shallowPursuitStateChangeTimer=0.0;
+
+	randomState=(unsigned int)rand();
 }
 
 FsAutopilot::~FsAutopilot()
 {
 }
 
+int FsAutopilot::Random(void)
+{
+	randomState=randomState*1103515245+12345;
+	return (int)((randomState>>16)&RANDOM_MAX);
+}
+
 /* static */ void FsAutopilot::Delete(FsAutopilot *ap)
 {
 	delete ap;
@@ -430,6 +438,13 @@ YSBOOL FsAutopilot::ObjectiveAccomplished(void)
 }
 
 YSRESULT FsAutopilot::Control(FsAirplane &air,FsSimulation *sim,const double &dt)
+{
+	auto res=Decide(air,sim,dt);
+	ApplyDeferredAction(air,sim);
+	return res;
+}
+
+YSRESULT FsAutopilot::Decide(FsAirplane &air,FsSimulation *sim,const double &dt)
 {
 	if(emr!=EMR_NONE)
 	{
@@ -450,6 +465,27 @@ YSRESULT FsAutopilot::Control(FsAirplane &air,FsSimulation *sim,const double &dt
 	}
 }
 
+void FsAutopilot::ApplyDeferredAction(FsAirplane &air,FsSimulation *sim)
+{
+	for(auto wpnType : deferredWeaponRelease)
+	{
+		YSBOOL blockedByBombBayDoor;
+		air.Prop().FireWeapon
+		   (blockedByBombBayDoor,sim,sim->GetClock(),sim->GetWeaponStore(),&air,wpnType);
+	}
+	deferredWeaponRelease.CleanUp();
+}
+
+/* virtual */ YSBOOL FsAutopilot::CanDecideInParallel(void) const
+{
+	return YSFALSE;
+}
+
+void FsAutopilot::FireWeaponDeferred(FSWEAPONTYPE wpnType)
+{
+	deferredWeaponRelease.Append(wpnType);
+}
+
 YSRESULT FsAutopilot::Save(FILE *fp,const FsSimulation *sim)
 {
 	fprintf(fp,"INTENTIO\n");
@@ -3229,6 +3265,11 @@ YSBOOL FsGotoPosition::MissionAccomplished(FsAirplane &air,FsSimulation *) const
 	return YSFALSE;
 }
 
+/* virtual */ YSBOOL FsGotoPosition::CanDecideInParallel(void) const
+{
+	return YSTRUE;
+}
+
 
 ////////////////////////////////////////////////////////////
 
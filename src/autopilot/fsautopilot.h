@@ -96,7 +96,20 @@ public:
 	virtual unsigned OverridedControl(void);
 	virtual YSBOOL ObjectiveAccomplished(void);
 
+	/*! Decide phase and apply phase in one call. */
 	YSRESULT Control(class FsAirplane &air,class FsSimulation *sim,const double &dt);
+
+	/*! Decide phase.  Makes a decision and sets the controls of the airplane.  Actions that change the
+	    simulation, such as releasing a weapon, are deferred to ApplyDeferredAction. */
+	YSRESULT Decide(class FsAirplane &air,class FsSimulation *sim,const double &dt);
+
+	/*! Apply phase.  Carries out the actions deferred in Decide.  Must be called from one thread at a time. */
+	void ApplyDeferredAction(class FsAirplane &air,class FsSimulation *sim);
+
+	/*! Returns YSTRUE if Decide writes only to this autopilot and the controls of the airplane, and reads
+	    the autopilot state of the other airplanes only through FsSimulation::GetAiControlSnapshot.
+	    Decide of such autopilots may run in parallel for different airplanes.  Default is YSFALSE. */
+	virtual YSBOOL CanDecideInParallel(void) const;
 	YSRESULT Save(FILE *fp,const FsSimulation *sim);
 
 	YSRESULT GetRelativeAttitude
@@ -125,6 +138,24 @@ protected:
 
 	FsAutopilot *nextObjective;
 
+	// Weapons to be released in ApplyDeferredAction >>
+	YsArray <FSWEAPONTYPE,2> deferredWeaponRelease;
+	// <<
+
+	/*! Releases a weapon of the given type in ApplyDeferredAction. */
+	void FireWeaponDeferred(FSWEAPONTYPE wpnType);
+
+	// Random numbers of this autopilot.  Decide may run in a worker thread, and cannot use rand(). >>
+	enum
+	{
+		RANDOM_MAX=0x7fff
+	};
+	unsigned int randomState;
+
+	/*! Returns 0 to RANDOM_MAX.  The sequence is seeded by rand() of the main thread when the autopilot is made. */
+	int Random(void);
+	// <<
+
 	YSRESULT EmergencyRecovery(FsAirplane &air);
 public:
 	virtual YSRESULT MakePriorityDecision(FsAirplane &air);
@@ -311,6 +342,8 @@ public:
 	virtual YSRESULT ApplyControl(FsAirplane &air,FsSimulation *sim,const double &dt);
 
 	virtual YSBOOL MissionAccomplished(FsAirplane &air,FsSimulation *sim) const;
+
+	virtual YSBOOL CanDecideInParallel(void) const;
 };
 
 
@@ -459,6 +459,7 @@ const double FsDefenderAutopilot::TargetDist(const FsAirplane *air,FsSimulation
 			break;
 		case SUBSTATE_ENGAGE:
 			df->ApplyControl(air,sim,dt);
+			df->ApplyDeferredAction(air,sim);  // The defender decides serially.  No need to wait for the apply phase.
 			break;
 		default:
 			break;
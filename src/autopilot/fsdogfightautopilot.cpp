@@ -276,18 +276,38 @@ YSRESULT FsDogfight::SearchTarget(FsAirplane &air,FsSimulation *sim)
 
 	pos=air.Prop().GetPosition();
 
-	FsAirplane *can;
 	double min=0.0;
-	can=NULL;
-	while(NULL!=(can=sim->FindNextAirplane(can)))
+	const auto &sensor=sim->GetSensorIndex();
+	if(YSTRUE==sensor.IsValid())
 	{
-		if(YSTRUE==CanBeTarget(&air,can))
+		// Same conditions as CanBeTarget.
+		FsSensorIndex::AirFilter filter;
+		filter.excludeIff=air.iff;
+		filter.activeOnly=YSTRUE;
+		filter.flyingOnly=targetFlyingAircraftOnly;
+		filter.skipDontAttackIfGroundStatic=YSTRUE;
+
+		YsArray <FsAirplane *,64> nearest;
+		sensor.GetKNearestAir(nearest,pos,1,filter);
+		if(0<nearest.GetN())
 		{
-			tpos=can->GetPosition();
-			if(trg==NULL || (tpos-pos).GetSquareLength()<min)
+			trg=nearest[0];
+		}
+	}
+	else
+	{
+		FsAirplane *can;
+		can=NULL;
+		while(NULL!=(can=sim->FindNextAirplane(can)))
+		{
+			if(YSTRUE==CanBeTarget(&air,can))
 			{
-				trg=can;
-				min=(tpos-pos).GetSquareLength();
+				tpos=can->GetPosition();
+				if(trg==NULL || (tpos-pos).GetSquareLength()<min)
+				{
+					trg=can;
+					min=(tpos-pos).GetSquareLength();
+				}
 			}
 		}
 	}
@@ -330,6 +350,31 @@ YSBOOL FsDogfight::CanBeTarget(const FsAirplane *air,const FsAirplane *trg) cons
 	return YSTRUE;
 }
 
+YSRESULT FsDogfight::GetDogfightStateOf(int &dfMode,FsAirplane *&dfTarget,const FsAirplane *other,FsSimulation *sim) const
+{
+	auto state=sim->GetAiControlSnapshot().FindAir(other);
+	if(NULL!=state)
+	{
+		if(FSAUTOPILOT_DOGFIGHT==state->apType)
+		{
+			dfMode=state->dogfightMode;
+			dfTarget=sim->FindAirplane(state->dogfightTargetKey);
+			return YSOK;
+		}
+		return YSERR;
+	}
+
+	auto ap=other->GetAutopilot();
+	if(NULL!=ap && FSAUTOPILOT_DOGFIGHT==ap->Type())
+	{
+		auto df=(const FsDogfight *)ap;
+		dfMode=df->mode;
+		dfTarget=sim->FindAirplane(df->targetAirplaneKey);
+		return YSOK;
+	}
+	return YSERR;
+}
+
 void FsDogfight::SetTarget(FsAirplane *air)
 {
 	targetAirplaneKey=air->SearchKey();
@@ -340,6 +385,16 @@ FsAirplane *FsDogfight::GetTarget(FsSimulation *sim)
 	return sim->FindAirplane(targetAirplaneKey);
 }
 
+YSHASHKEY FsDogfight::GetTargetKey(void) const
+{
+	return targetAirplaneKey;
+}
+
+/* virtual */ YSBOOL FsDogfight::CanDecideInParallel(void) const
+{
+	return YSTRUE;
+}
+
 YSRESULT FsDogfight::MakePriorityDecision(FsAirplane &air)
 {
 	if(mode==DFMODE_NOTARGET/*-1*/ || air.Prop().GetFlightState()==FSSTALL)
@@ -424,27 +479,39 @@ YSRESULT FsDogfight::MakeDecision(FsAirplane &air,FsSimulation *sim,const double
 	{
 		YSBOOL targetOk=YSFALSE;
 
-		FsAutopilot *ap=target->GetAutopilot();
-		if(ap!=NULL && ap->Type()==FSAUTOPILOT_DOGFIGHT) // ap->WhatItIs()==FsDogfight::ClassName)
+		int dfMode;
+		FsAirplane *dfTarget;
+		if(YSOK==GetDogfightStateOf(dfMode,dfTarget,target,sim) && dfTarget==defendThis)
 		{
-			FsDogfight *df=(FsDogfight *)ap;
-			if(df->GetTarget(sim)==defendThis)
-			{
-				targetOk=YSTRUE;
-			}
+			targetOk=YSTRUE;
 		}
 		// If none of the airplanes is chasing the defend target, don't need to update the target.
 		if(targetOk!=YSTRUE)
 		{
-			FsAirplane *tst=NULL;
-			while((tst=sim->FindNextAirplane(tst))!=NULL)
+			const auto &snapshot=sim->GetAiControlSnapshot();
+			if(YSTRUE==snapshot.IsValid())
+			{
+				const YSHASHKEY defendThisKey=defendThis->SearchKey();
+				for(auto &tst : snapshot.AllAir())
+				{
+					if(tst.isActive==YSTRUE &&
+					   tst.apType==FSAUTOPILOT_DOGFIGHT &&
+					   tst.dogfightTargetKey==defendThisKey)
+					{
+						targetAirplaneKey=tst.searchKey;
+						target=tst.air;
+						break;
+					}
+				}
+			}
+			else
 			{
-				ap=tst->GetAutopilot();
-				if(tst->Prop().IsActive()==YSTRUE &&
-				   ap!=NULL && ap->Type()==FSAUTOPILOT_DOGFIGHT) // (ap->WhatItIs()==FsDogfight::ClassName))
+				FsAirplane *tst=NULL;
+				while((tst=sim->FindNextAirplane(tst))!=NULL)
 				{
-					FsDogfight *df=(FsDogfight *)ap;
-					if(df->GetTarget(sim)==defendThis)
+					if(tst->Prop().IsActive()==YSTRUE &&
+					   YSOK==GetDogfightStateOf(dfMode,dfTarget,tst,sim) &&
+					   dfTarget==defendThis)
 					{
 						targetAirplaneKey=FsExistence::GetSearchKey(tst);
 						target=tst;
@@ -536,11 +603,11 @@ YSRESULT FsDogfight::MakeDecision(FsAirplane &air,FsSimulation *sim,const double
 			else if(rel1.z()<0.0 && radar<backSenseRange)
 			{
 				mode=DFMODE_TARGET_ONBACK_BREAK/*3*/;  // Target is on the back!!
-				nextClock=clock+double(rand()%100)/100.0;
+				nextClock=clock+double(Random()%100)/100.0;
 			}
 			else if(modeDuration>20.0)
 			{
-				if(rand()%2==0)
+				if(Random()%2==0)
 				{
 					mode=DFMODE_HIGH_G_YO_YO/*7*/;
 				}
@@ -575,7 +642,7 @@ YSRESULT FsDogfight::MakeDecision(FsAirplane &air,FsSimulation *sim,const double
 			    rel1.z()<0.0 || radar>YsDegToRad(50.0))  // <- The target is no longer in front of the airplane.
 			{
 				int d;
-				d=rand()%4;
+				d=Random()%4;
 				switch(d)
 				{
 				case 0:
@@ -619,7 +686,7 @@ YSRESULT FsDogfight::MakeDecision(FsAirplane &air,FsSimulation *sim,const double
 			air.Prop().GetVelocity(vel);
 			if(air.GetAttitude().p()>YsDegToRad(30.0) || vel.y()>0.0)
 			{
-				if(rand()%3==1)
+				if(Random()%3==1)
 				{
 					mode=DFMODE_HIGH_G_YO_YO/*7*/;
 				}
@@ -692,7 +759,7 @@ YSRESULT FsDogfight::MakeDecision(FsAirplane &air,FsSimulation *sim,const double
 		else if(WingmanClosingIn(air,sim)==YSTRUE)
 		{
 			int a;
-			a=rand();
+			a=Random();
 			a&=255;
 			if(a<64)
 			{
@@ -768,7 +835,7 @@ YSRESULT FsDogfight::MakeDecision(FsAirplane &air,FsSimulation *sim,const double
 			nextTargetSearchTimer-=dt;
 			if(YsTolerance>nextTargetSearchTimer)
 			{
-				nextTargetSearchTimer=1.0+(double)(rand()%100)/20.0;
+				nextTargetSearchTimer=1.0+(double)(Random()%100)/20.0;
 				SearchTarget(air,sim);
 			}
 			if(YSTRUE==TargetIsWithinCombatRange(air,*target))
@@ -792,15 +859,13 @@ FsAirplane *FsDogfight::GetWingmansTarget(FsAirplane &,FsSimulation *sim)
 	wingman=sim->FindAirplane(wingmanAirplaneKey);
 	if(wingman!=NULL)
 	{
-		FsAutopilot *ap;
-		ap=wingman->GetAutopilot();
-		if(ap!=NULL && ap->Type()==FSAUTOPILOT_DOGFIGHT)
+		int dfMode;
+		FsAirplane *dfTarget;
+		if(YSOK==GetDogfightStateOf(dfMode,dfTarget,wingman,sim))
 		{
-			FsDogfight *df;
-			df=(FsDogfight *)ap;
-			if(df->mode<DFMODE_ACT_AS_DECOY_LEVELOFF/*200*/ || DFMODE_ACT_AS_DECOY_LASTRESERVED/*299*/<df->mode)
+			if(dfMode<DFMODE_ACT_AS_DECOY_LEVELOFF/*200*/ || DFMODE_ACT_AS_DECOY_LASTRESERVED/*299*/<dfMode)
 			{
-				return df->GetTarget(sim);
+				return dfTarget;
 			}
 		}
 	}
@@ -813,16 +878,12 @@ YSBOOL FsDogfight::BeingChasedByWingmansTarget(FsAirplane &air,FsSimulation *sim
 	wingman=sim->FindAirplane(wingmanAirplaneKey);
 	if(wingman!=NULL)
 	{
-		FsAutopilot *ap;
-		ap=wingman->GetAutopilot();
-		if(ap!=NULL && ap->Type()==FSAUTOPILOT_DOGFIGHT)
+		int dfMode;
+		FsAirplane *wingmanTarget;
+		if(YSOK==GetDogfightStateOf(dfMode,wingmanTarget,wingman,sim))
 		{
-			FsDogfight *df;
-			FsAirplane *wingmanTarget;
-			df=(FsDogfight *)ap;
-			if(df->mode<DFMODE_ACT_AS_DECOY_LEVELOFF/*200*/ || DFMODE_ACT_AS_DECOY_LASTRESERVED/*299*/<df->mode)
+			if(dfMode<DFMODE_ACT_AS_DECOY_LEVELOFF/*200*/ || DFMODE_ACT_AS_DECOY_LASTRESERVED/*299*/<dfMode)
 			{
-				wingmanTarget=df->GetTarget(sim);
 				if(wingmanTarget!=NULL && 
 				   (wingmanTarget->GetPosition()-wingman->GetPosition()).GetSquareLength()<1200.0*1200.0)
 				{
@@ -851,14 +912,10 @@ YSBOOL FsDogfight::WingmanClosingIn(FsAirplane &,FsSimulation *sim)
 	wingman=sim->FindAirplane(wingmanAirplaneKey);
 	if(wingman!=NULL)
 	{
-		FsAutopilot *ap;
-		ap=wingman->GetAutopilot();
-		if(ap!=NULL && ap->Type()==FSAUTOPILOT_DOGFIGHT)
+		int dfMode;
+		FsAirplane *wingmanTarget;
+		if(YSOK==GetDogfightStateOf(dfMode,wingmanTarget,wingman,sim))
 		{
-			FsDogfight *df;
-			FsAirplane *wingmanTarget;
-			df=(FsDogfight *)ap;
-			wingmanTarget=df->GetTarget(sim);
 			if(wingmanTarget!=NULL && 
 			   (wingmanTarget->GetPosition()-wingman->GetPosition()).GetSquareLength()<400.0*400.0)
 			{
@@ -1180,13 +1237,11 @@ YSRESULT FsDogfight::ApplyControl(FsAirplane &air,FsSimulation *sim,const double
 							if(targetNew!=NULL && fireClock<clock)
 							{
 								int weaponId;
-								YSBOOL blockedByBombBayDoor;
 								weaponId=air.Prop().GetRecentlyFiredMissileId();
 								if(sim->IsWeaponGuidedToTarget(weaponId)!=YSTRUE ||
 								   sim->IsWeaponShotBy(weaponId,&air)!=YSTRUE)
 								{
-									air.Prop().FireWeapon
-									   (blockedByBombBayDoor,sim,sim->GetClock(),sim->GetWeaponStore(),&air,shortRangeType);
+									FireWeaponDeferred(shortRangeType);
 									fireClock=clock+5.0;
 								}
 							}
@@ -1207,9 +1262,7 @@ YSRESULT FsDogfight::ApplyControl(FsAirplane &air,FsSimulation *sim,const double
 							}
 							if(targetNew!=NULL && fireClock<clock)
 							{
-								YSBOOL blockedByBombBayDoor;
-								air.Prop().FireWeapon
-								   (blockedByBombBayDoor,sim,sim->GetClock(),sim->GetWeaponStore(),&air,FSWEAPON_AIM120);
+								FireWeaponDeferred(FSWEAPON_AIM120);
 								fireClock=clock+12.0;
 							}
 						}
@@ -1410,16 +1463,12 @@ YSRESULT FsDogfight::ApplyControl(FsAirplane &air,FsSimulation *sim,const double
 				wingman=sim->FindAirplane(wingmanAirplaneKey);
 				if(wingman!=NULL)
 				{
-					FsAutopilot *ap;
-					ap=wingman->GetAutopilot();
-					if(ap!=NULL && ap->Type()==FSAUTOPILOT_DOGFIGHT)
+					int dfMode;
+					FsAirplane *wingmanTarget;
+					if(YSOK==GetDogfightStateOf(dfMode,wingmanTarget,wingman,sim))
 					{
-						FsDogfight *df;
-						FsAirplane *wingmanTarget;
-						df=(FsDogfight *)ap;
-						if(df->mode<200 || 299<df->mode)
+						if(dfMode<200 || 299<dfMode)
 						{
-							wingmanTarget=df->GetTarget(sim);
 							if(wingmanTarget!=NULL)
 							{
 								pos=wingmanTarget->GetPosition();
@@ -1457,7 +1506,7 @@ YSRESULT FsDogfight::ApplyControl(FsAirplane &air,FsSimulation *sim,const double
 								jinkDesigBank=-jinkDesigBank;
 							}
 						}
-						jinkNextBankChangeTime=3.0+(double)(rand()%5);
+						jinkNextBankChangeTime=3.0+(double)(Random()%5);
 					}
 
 					air.Prop().BankController(jinkDesigBank);
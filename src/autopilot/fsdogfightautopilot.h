@@ -3,6 +3,7 @@
 /* { */
 
 #include "fsautopilot.h"
+#include "fsaicontrolsnapshot.h"
 
 class FsDogfight : public FsAutopilot
 {
@@ -132,6 +133,14 @@ public:
 	YSBOOL CanBeTarget(const FsAirplane *air,const FsAirplane *trg) const;
 	void SetTarget(FsAirplane *trg);
 	FsAirplane *GetTarget(FsSimulation *sim);
+	YSHASHKEY GetTargetKey(void) const;
+
+	/*! Returns the mode and the target of the dogfight autopilot of the other airplane.  Reads from the snapshot
+	    during the control tick, since the other airplane may be deciding at the same time.
+	    Returns YSERR if the other airplane is not in a dogfight. */
+	YSRESULT GetDogfightStateOf(int &dfMode,FsAirplane *&dfTarget,const FsAirplane *other,FsSimulation *sim) const;
+
+	virtual YSBOOL CanDecideInParallel(void) const;
 
 	virtual YSRESULT MakePriorityDecision(FsAirplane &air);
 	FsAirplane *GetWingmansTarget(FsAirplane &air,FsSimulation *sim);
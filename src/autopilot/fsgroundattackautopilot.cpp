@@ -67,6 +67,11 @@ FsGroundAttack::FsGroundAttack()
 	turnAwayDistance=15000.0;
 	turnAwayRelDir=YsOrigin();
 	turnAwayTurnDir=-1;
+	routeWaitTime=0.0;
+	inboundRouteIdx=0;
+	followingRoute=YSFALSE;
+	waitingRoute=YSFALSE;
+	relRouteHorizontal=YsOrigin();
 	target=NULL;
 	playerGroundKey=YSNULLHASHKEY;
 	prevDist=0;
@@ -82,6 +87,7 @@ FsGroundAttack::FsGroundAttack()
 	attackDone=YSFALSE;
 
 	takeEvasiveAction=YSTRUE;
+	avoidThreatInbound=YSTRUE;
 
 	bomberAlt=YsUnitConv::FTtoM(5000.0);
 	attackAlt=YsUnitConv::FTtoM(5000.0);
@@ -126,6 +132,10 @@ YSRESULT FsGroundAttack::SaveIntention(FILE *fp,const FsSimulation *)
 	{
 		fprintf(fp,"NOEVASIV\n");
 	}
+	if(avoidThreatInbound!=YSTRUE)
+	{
+		fprintf(fp,"NOTHRAVD\n");
+	}
 	fprintf(fp,"BOMBRALT %lfm\n",bomberAlt);
 	fprintf(fp,"ATACKALT %lfm\n",attackAlt);
 
@@ -205,6 +215,10 @@ YSRESULT FsGroundAttack::ReadIntention(YsTextInputStream &inStream,const YsStrin
 			{
 				takeEvasiveAction=YSFALSE;
 			}
+			else if(0==strcmp(args[0],"NOTHRAVD"))
+			{
+				avoidThreatInbound=YSFALSE;
+			}
 			else if(0==strcmp(args[0],"BOMBRALT"))
 			{
 				FsGetLength(bomberAlt,args[1]);
@@ -356,7 +370,7 @@ YSRESULT FsGroundAttack::MakeDecision(FsAirplane &air,FsSimulation *sim,const do
 	breakingTime+=dt;
 	if(takeEvasiveAction==YSTRUE && Phase()!=STATE_EVASIVE_0 && Phase()!=STATE_EVASIVE_1 && BeingChasedByEnemy(air,sim)==YSTRUE)
 	{
-		SetPhase(air,((rand()&1)==0 ? STATE_EVASIVE_0 : STATE_EVASIVE_1));
+		SetPhase(air,((Random()&1)==0 ? STATE_EVASIVE_0 : STATE_EVASIVE_1));
 		air.Prop().CaptureGControllerSmoother();
 		breakingTime=0.0;
 	}
@@ -367,7 +381,7 @@ YSRESULT FsGroundAttack::MakeDecision(FsAirplane &air,FsSimulation *sim,const do
 
 	if(YSTRUE==flareDispenser.MissileChasing() && YSTRUE==breakOnMissile && Phase()!=STATE_EVASIVE_0 && Phase()!=STATE_EVASIVE_1)
 	{
-		SetPhase(air,((rand()&1)==0 ? STATE_EVASIVE_0 : STATE_EVASIVE_1));
+		SetPhase(air,((Random()&1)==0 ? STATE_EVASIVE_0 : STATE_EVASIVE_1));
 		air.Prop().CaptureGControllerSmoother();
 		breakingTime=0.0;
 	}
@@ -493,7 +507,10 @@ YSRESULT FsGroundAttack::MakeDecision(FsAirplane &air,FsSimulation *sim,const do
 		else if(Phase()==STATE_TURNINBOUND /*1*/)
 		{
 			attackDone=YSFALSE;
-			if(relHorizontal.z()>YsTolerance &&
+			FollowInboundRoute(air,sim,dt);
+			if(YSTRUE!=followingRoute &&
+			   YSTRUE!=waitingRoute &&
+			   relHorizontal.z()>YsTolerance &&
 			   YsAbs(relHorizontal.x()/relHorizontal.z())<0.1)
 			{
 				int nSel;
@@ -537,7 +554,7 @@ YSRESULT FsGroundAttack::MakeDecision(FsAirplane &air,FsSimulation *sim,const do
 					}
 					else
 					{
-						choice=sel[rand()%nSel];
+						choice=sel[Random()%nSel];
 						air.Prop().SetWeaponOfChoice(choice);
 						switch(choice)
 						{
@@ -567,7 +584,7 @@ YSRESULT FsGroundAttack::MakeDecision(FsAirplane &air,FsSimulation *sim,const do
 					if(nSel>0)
 					{
 						SetPhase(air,STATE_INBOUND_BOMB /*3*/);
-						choice=sel[rand()%nSel];
+						choice=sel[Random()%nSel];
 						air.Prop().SetWeaponOfChoice(choice);
 					}
 					else
@@ -622,7 +639,7 @@ YSRESULT FsGroundAttack::MakeDecision(FsAirplane &air,FsSimulation *sim,const do
 				else
 				{
 					// It is flying straight to the target anyway.  Choose left or right randomly.
-					const double hdgOffset=(0==(rand()&1) ? YsPi*0.75 : -YsPi*0.75);
+					const double hdgOffset=(0==(Random()&1) ? YsPi*0.75 : -YsPi*0.75);
 					turnAwayHeading=air.GetAttitude().h()+hdgOffset;
 				}
 				turnAwayFrom=target->GetPosition();
@@ -765,7 +782,8 @@ YSRESULT FsGroundAttack::ApplyControl(FsAirplane &air,FsSimulation *sim,const do
 	else
 	{
 		double hdgErr,bnk;
-		hdgErr=atan2(-relHorizontal.x(),relHorizontal.z());
+		const YsVec3 &steer=(Phase()==STATE_TURNINBOUND && YSTRUE==followingRoute ? relRouteHorizontal : relHorizontal);
+		hdgErr=atan2(-steer.x(),steer.z());
 
 		if(air.Prop().GetAirplaneCategory()==FSAC_AEROBATIC ||
 		   air.Prop().GetAirplaneCategory()==FSAC_FIGHTER ||
@@ -929,9 +947,8 @@ YSRESULT FsGroundAttack::ApplyControl(FsAirplane &air,FsSimulation *sim,const do
 
 				   (air.Prop().GetNumWeapon(FSWEAPON_BOMB)>2))
 				{
-					YSBOOL blockedByBombBayDoor;
-					air.Prop().FireWeapon
-					   (blockedByBombBayDoor,sim,sim->GetClock(),sim->GetWeaponStore(),&air,FSWEAPON_BOMB);
+					// Decide may run in a worker thread.  The bomb is released in ApplyDeferredAction.
+					FireWeaponDeferred(FSWEAPON_BOMB);
 				}
 			}
 			else
@@ -1006,6 +1023,75 @@ YSBOOL FsGroundAttack::OutOfThreatRange(FsAirplane &air,const double margin) con
 	return YSTRUE;
 }
 
+void FsGroundAttack::FollowInboundRoute(FsAirplane &air,FsSimulation *sim,const double &dt)
+{
+	followingRoute=YSFALSE;
+	waitingRoute=YSFALSE;
+	if(YSTRUE!=avoidThreatInbound || NULL==target)
+	{
+		return;
+	}
+
+	// Asks again when the threats have changed since the route was planned.  The old route is followed until the
+	// new one is ready.
+	if(true!=newInboundRoute.valid() &&
+	   (true!=inboundRoute.valid() || inboundRoute.get().threatVersion!=sim->GetThreatAvoidingRouteVersion()))
+	{
+		newInboundRoute=sim->RequestThreatAvoidingRoute(air,target->GetPosition());
+		routeWaitTime=0.0;
+	}
+	if(true==newInboundRoute.valid())
+	{
+		if(std::future_status::ready==newInboundRoute.wait_for(std::chrono::seconds(0)))
+		{
+			inboundRoute=newInboundRoute;
+			newInboundRoute=std::shared_future <FsRoutePlanner::Route>();
+			inboundRouteIdx=1;
+		}
+		else
+		{
+			// The attack run is not started while the route is being planned, but the planner is not waited forever.
+			const double maxRouteWaitTime=5.0;
+			routeWaitTime+=dt;
+			if(routeWaitTime<maxRouteWaitTime)
+			{
+				waitingRoute=YSTRUE;
+			}
+			if(true!=inboundRoute.valid())
+			{
+				// Keep turning toward the target until the route is ready.
+				return;
+			}
+		}
+	}
+
+	// The last way point is the center of the cell of the target.  The last leg is flown to the target itself.
+	const double wayPointRadius=2000.0;
+	const YsArray <YsVec2> &wayPoint=inboundRoute.get().wayPoint;
+	const YsVec2 pos(air.GetPosition().x(),air.GetPosition().z());
+	while(inboundRouteIdx<wayPoint.GetN()-1)
+	{
+		const YsVec2 &wp=wayPoint[inboundRouteIdx];
+		const YsVec2 &next=wayPoint[inboundRouteIdx+1];
+		if((wp-pos).GetLength()<wayPointRadius || 0.0<(pos-wp)*(next-wp))  // Reached, or passed.
+		{
+			++inboundRouteIdx;
+		}
+		else
+		{
+			break;
+		}
+	}
+
+	if(inboundRouteIdx<wayPoint.GetN()-1)
+	{
+		const YsVec2 &wp=wayPoint[inboundRouteIdx];
+		relRouteHorizontal.Set(wp.x()-pos.x(),0.0,wp.y()-pos.y());
+		relRouteHorizontal.RotateXZ(-air.GetAttitude().h());
+		followingRoute=YSTRUE;
+	}
+}
+
 void FsGroundAttack::SearchTarget(FsAirplane &air,FsSimulation *sim)
 {
 	FsGround *can,*tmp;
@@ -1099,39 +1185,61 @@ void FsGroundAttack::SearchTarget(FsAirplane &air,FsSimulation *sim)
 
 YSBOOL FsGroundAttack::BeingChasedByEnemy(FsAirplane &air,FsSimulation *sim)
 {
+	const auto &snapshot=sim->GetAiControlSnapshot();
+	if(YSTRUE==snapshot.IsValid())
+	{
+		for(auto &enemy : snapshot.AllAir())
+		{
+			if(enemy.iff!=air.iff && YSTRUE==IsChasing(air,enemy.pos,enemy.att))
+			{
+				return YSTRUE;
+			}
+		}
+		return YSFALSE;
+	}
+
 	FsAirplane *enemy;
 
 	enemy=NULL;
 	while((enemy=sim->FindNextAirplane(enemy))!=NULL)
 	{
-		if(enemy->iff!=air.iff)
+		if(enemy->iff!=air.iff && YSTRUE==IsChasing(air,enemy->GetPosition(),enemy->GetAttitude()))
 		{
-			YsVec3 ePos,eEv,eUv;
-			YsAtt3 eAtt;
-
-			ePos=enemy->GetPosition();
-			eAtt=enemy->GetAttitude();
-			eEv=eAtt.GetForwardVector();
-			eUv=eAtt.GetUpVector();
-
-			air.Prop().GetInverseMatrix().Mul(ePos,ePos,1.0);
-			air.Prop().GetInverseMatrix().Mul(eEv,eEv,0.0);
-			air.Prop().GetInverseMatrix().Mul(eUv,eUv,0.0);
-
-			if(-900.0<ePos.z() && ePos.z()<0.0 &&
-			   YsAbs(ePos.x()/ePos.z())<0.5 &&
-			   YsAbs(ePos.y()/ePos.z())<0.5 &&
-			   eEv.z()>0.0 &&
-			   YsAbs(eEv.x()/eEv.z())<0.5 &&
-			   YsAbs(eEv.y()/eEv.z())<0.5)
-			{
-				return YSTRUE;
-			}
+			return YSTRUE;
 		}
 	}
 	return YSFALSE;
 }
 
+YSBOOL FsGroundAttack::IsChasing(const FsAirplane &air,const YsVec3 &enemyPos,const YsAtt3 &enemyAtt) const
+{
+	YsVec3 ePos,eEv,eUv;
+
+	ePos=enemyPos;
+	eEv=enemyAtt.GetForwardVector();
+	eUv=enemyAtt.GetUpVector();
+
+	air.Prop().GetInverseMatrix().Mul(ePos,ePos,1.0);
+	air.Prop().GetInverseMatrix().Mul(eEv,eEv,0.0);
+	air.Prop().GetInverseMatrix().Mul(eUv,eUv,0.0);
+
+	if(-900.0<ePos.z() && ePos.z()<0.0 &&
+	   YsAbs(ePos.x()/ePos.z())<0.5 &&
+	   YsAbs(ePos.y()/ePos.z())<0.5 &&
+	   eEv.z()>0.0 &&
+	   YsAbs(eEv.x()/eEv.z())<0.5 &&
+	   YsAbs(eEv.y()/eEv.z())<0.5)
+	{
+		return YSTRUE;
+	}
+	return YSFALSE;
+}
+
+/* virtual */ YSBOOL FsGroundAttack::CanDecideInParallel(void) const
+{
+	return YSTRUE;
+}
+
 FsGroundAttack::STATE FsGroundAttack::Phase(void) const
 {
 	return attackPhase;
@@ -1139,6 +1247,15 @@ FsGroundAttack::STATE FsGroundAttack::Phase(void) const
 
 void FsGroundAttack::SetPhase(FsAirplane &air,FsGroundAttack::STATE phase)
 {
+	if(STATE_TURNINBOUND==phase)
+	{
+		// Asks for the route from where the airplane is now.
+		inboundRoute=std::shared_future <FsRoutePlanner::Route>();
+		newInboundRoute=std::shared_future <FsRoutePlanner::Route>();
+		routeWaitTime=0.0;
+	}
+	followingRoute=YSFALSE;
+	waitingRoute=YSFALSE;
 	attackPhase=phase;
 	air.Prop().CaptureGControllerSmoother();
 }
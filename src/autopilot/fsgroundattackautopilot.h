@@ -3,6 +3,7 @@
 /* { */
 
 #include "fsautopilot.h"
+#include "fsrouteplanner.h"
 
 class FsGroundAttack : public FsAutopilot
 {
@@ -52,6 +53,13 @@ private:
 	YsVec3 turnAwayFrom;    // Only in STATE_TURNAWAY
 	YsVec3 turnAwayRelDir;  // Only in STATE_TURNAWAY
 	int turnAwayTurnDir;    // Only in STATE_TURNAWAY
+	std::shared_future <FsRoutePlanner::Route> inboundRoute;     // Only in STATE_TURNINBOUND.  Always ready if valid.
+	std::shared_future <FsRoutePlanner::Route> newInboundRoute;  // Only in STATE_TURNINBOUND.  Being planned.
+	double routeWaitTime;                                        // Only in STATE_TURNINBOUND
+	YSSIZE_T inboundRouteIdx;                                    // Only in STATE_TURNINBOUND
+	YSBOOL followingRoute;                                       // Only in STATE_TURNINBOUND
+	YSBOOL waitingRoute;                                         // Only in STATE_TURNINBOUND
+	YsVec3 relRouteHorizontal;                                   // Only in STATE_TURNINBOUND
 	// No save.  Calculated on the fly <<
 
 public:
@@ -65,6 +73,7 @@ public:
 	double flareInterval;
 	YSBOOL breakOnMissile;
 	YSBOOL takeEvasiveAction;
+	YSBOOL avoidThreatInbound;  // Fly around the SAM and AAA sites on the way to the target.
 	YsString pendingGndTargetName;
 
 	YsVec3 leadTargetPos;
@@ -115,9 +124,14 @@ public:
 
 private:
 	YSBOOL OutOfThreatRange(FsAirplane &air,const double margin) const;
+	void FollowInboundRoute(FsAirplane &air,FsSimulation *sim,const double &dt);
 public:
 	void SearchTarget(FsAirplane &air,FsSimulation *sim);
 	YSBOOL BeingChasedByEnemy(FsAirplane &air,FsSimulation *sim);
+	YSBOOL IsChasing(const FsAirplane &air,const YsVec3 &enemyPos,const YsAtt3 &enemyAtt) const;
+
+	virtual YSBOOL CanDecideInParallel(void) const;
+
 	STATE Phase(void) const;
 	void SetPhase(FsAirplane &air,STATE phase);
 };
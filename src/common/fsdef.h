@@ -5,7 +5,7 @@
 #include <ysclass.h>
 
 #define YSFLIGHT_VERSION 20181124
-#define YSFLIGHT_YFSVERSION 20180930
+#define YSFLIGHT_YFSVERSION 20261017
 #define YSFLIGHT_NETVERSION 20180930
 
 // VERSION 20060514 : 2006 Summer Test Ver.
@@ -43,6 +43,7 @@
 // YFS 20141026 : 2014 Fall test - Added INITPLYR
 // YFS 20141101 : 2014 Fall test - Added SIMTITLE
 // YFS 20141127 : 2014 Fall test - Smoke 0/1 -> Flags
+// YFS 20261017 : Added RECDFILE and BINRECOR (binary flight record)
 
 // NET 20050701 : 200509 Test version
 // NET 20051102 : 2005 fall official version
@@ -2,108 +2,19 @@
 #define FSRECORD_IS_INCLUDED
 /* { */
 
+#include <string.h>
+#include <type_traits>
+#include <ysclass.h>
+
 ////////////////////////////////////////////////////////////
 
-template <class T>
-class FsAllocOnceArray
+class FsTurretRecord
 {
 public:
-	inline FsAllocOnceArray();
-	inline ~FsAllocOnceArray();
-	inline YSRESULT Alloc(int n);
-
-	inline FsAllocOnceArray <T> &operator=(const FsAllocOnceArray <T> &from);
-	inline const T &operator[](int idx) const;
-	inline T &operator[](int idx);
-
-	inline int GetN(void) const;
-
-protected:
-	int lng;
-	T *dat;
+	float h,p;
+	unsigned int turretState;
 };
 
-template <class T>
-inline FsAllocOnceArray <T>::FsAllocOnceArray()
-{
-	lng=0;
-	dat=NULL;
-}
-
-template <class T>
-inline FsAllocOnceArray <T>::~FsAllocOnceArray()
-{
-	if(dat!=NULL)
-	{
-		delete [] dat;
-	}
-}
-
-template <class T>
-inline YSRESULT FsAllocOnceArray <T>::Alloc(int n)
-{
-	if(dat!=NULL)
-	{
-		delete [] dat;
-		dat=NULL;
-		lng=0;
-	}
-
-	dat=new T [n];
-	if(dat!=NULL)
-	{
-		lng=n;
-		return YSOK;
-	}
-
-	return YSERR;
-}
-
-template <class T>
-inline FsAllocOnceArray <T> &FsAllocOnceArray <T>::operator=(const FsAllocOnceArray <T> &from)
-{
-	int i;
-
-	if(dat!=NULL)
-	{
-		delete [] dat;
-		dat=NULL;
-		lng=0;
-	}
-
-	if(from.lng>0)
-	{
-		dat=new T [from.lng];
-		lng=from.lng;
-		for(i=0; i<from.lng; i++)
-		{
-			dat[i]=from.dat[i];
-		}
-	}
-
-	return *this;
-}
-
-template <class T>
-inline const T &FsAllocOnceArray <T>::operator [](int idx) const
-{
-	return dat[idx];
-}
-
-template <class T>
-inline T &FsAllocOnceArray <T>::operator [](int idx)
-{
-	return dat[idx];
-}
-
-template <class T>
-inline int FsAllocOnceArray <T>::GetN(void) const
-{
-	return lng;
-}
-
-
-
 ////////////////////////////////////////////////////////////
 
 
@@ -112,6 +23,7 @@ template <class T> class FsRecordElement
 public:
 	double t;
 	T dat;
+	unsigned int turretTop,nTurret;  // Turret samples are FsRecord::turretPool[turretTop] to [turretTop+nTurret-1]
 };
 
 // The word:
@@ -123,18 +35,24 @@ template <class T> class FsRecord
 public:
 	enum 
 	{
-		SEGARRAY_BITSHIFT=10
+		SEGARRAY_BITSHIFT=10,
+		TURRETPOOL_BITSHIFT=12,
+		MAX_NUM_TURRET=(1<<TURRETPOOL_BITSHIFT)  // Turret samples of one element beyond this number are not recorded.
 	};
 
 	FsRecord();
 	virtual ~FsRecord();
 
-	YSRESULT AddElement(T &dat,double t);
+	YSRESULT AddElement(const T &dat,double t);
+	YSRESULT AddElement(const T &dat,double t,const YsConstArrayMask <FsTurretRecord> &turret);
 	YSRESULT GetIndexByTime(YSSIZE_T &idx,double t);
 	YSRESULT GetIndexByTime(YSSIZE_T &idx1,YSSIZE_T &idx2,double t1,double t2);  // It is more like GetIndexRangeByTimeRange t1-t2 must enclose idx1-idx2
 	T *GetElement(double &t,YSSIZE_T index);
 	const T *GetElement(double &t,YSSIZE_T index) const;
-	int GetNumRecord(void);
+	int GetNumRecord(void) const;
+
+	/*! Returns turret samples of the index-th element. */
+	YsConstArrayMask <FsTurretRecord> GetTurret(YSSIZE_T index) const;
 
 	T *GetTopElement(double &t);
 	const T *GetTopElement(double &t) const;
@@ -149,7 +67,18 @@ public:
 	const double GetRecordEndTime(void) const;
 
 protected:
+	// Elements are trivially copyable, and turret samples, which vary in number, are pooled in turretPool
+	// in the order of the elements.  Elements in one segment of recordArray are contiguous.  Turret samples
+	// of one element are also contiguous since they never cross the segment boundary of turretPool.
 	YsSegmentedArray <FsRecordElement <T>,SEGARRAY_BITSHIFT> recordArray;
+	YsSegmentedArray <FsTurretRecord,TURRETPOOL_BITSHIFT> turretPool;
+
+	static YSSIZE_T PlaceTurret(YSSIZE_T top,YSSIZE_T n);
+	YSSIZE_T AllocTurret(YSSIZE_T n);
+	void RepackTurret(YSSIZE_T from);
+	void MoveElement(YSSIZE_T to,YSSIZE_T from,YSSIZE_T n);
+	void DeleteElement(YSSIZE_T from,YSSIZE_T n);
+	void ShrinkElement(YSSIZE_T n);
 };
 
 template <class T> FsRecord <T>::FsRecord()
@@ -160,14 +89,142 @@ template <class T> FsRecord <T>::~FsRecord()
 {
 }
 
-template <class T> YSRESULT FsRecord <T>::AddElement(T &dat,double t)
+template <class T> YSRESULT FsRecord <T>::AddElement(const T &dat,double t)
+{
+	return AddElement(dat,t,YsConstArrayMask <FsTurretRecord> (0,nullptr));
+}
+
+template <class T> YSRESULT FsRecord <T>::AddElement(const T &dat,double t,const YsConstArrayMask <FsTurretRecord> &turret)
 {
+	static_assert(std::is_trivially_copyable <FsRecordElement <T> >::value,"Record element must be trivially copyable.");
+
+	const YSSIZE_T nTurret=YsSmaller <YSSIZE_T> (turret.GetN(),MAX_NUM_TURRET);
+	const YSSIZE_T turretTop=AllocTurret(nTurret);
+	if(0<nTurret)
+	{
+		memcpy(&turretPool[turretTop],turret.GetArray(),sizeof(FsTurretRecord)*nTurret);
+	}
+
 	recordArray.Increment();
-	recordArray.GetEnd().dat=dat;
-	recordArray.GetEnd().t=t;
+	auto &elem=recordArray.GetEnd();
+	elem.dat=dat;
+	elem.t=t;
+	elem.turretTop=(unsigned int)turretTop;
+	elem.nTurret=(unsigned int)nTurret;
 	return YSOK;
 }
 
+template <class T>
+YsConstArrayMask <FsTurretRecord> FsRecord <T>::GetTurret(YSSIZE_T idx) const
+{
+	if(YSTRUE==recordArray.IsInRange(idx) && 0<recordArray[idx].nTurret)
+	{
+		return YsConstArrayMask <FsTurretRecord> (recordArray[idx].nTurret,&turretPool[recordArray[idx].turretTop]);
+	}
+	return YsConstArrayMask <FsTurretRecord> (0,nullptr);
+}
+
+template <class T>
+YSSIZE_T FsRecord <T>::PlaceTurret(YSSIZE_T top,YSSIZE_T n)
+{
+	const YSSIZE_T segSize=((YSSIZE_T)1<<TURRETPOOL_BITSHIFT);
+	const YSSIZE_T remain=segSize-(top&(segSize-1));
+	if(0<n && remain<n)
+	{
+		return top+remain;
+	}
+	return top;
+}
+
+template <class T>
+YSSIZE_T FsRecord <T>::AllocTurret(YSSIZE_T n)
+{
+	const YSSIZE_T top=PlaceTurret(turretPool.GetN(),n);
+	if(0<n)
+	{
+		turretPool.Resize(top+n);
+	}
+	return top;
+}
+
+template <class T>
+void FsRecord <T>::RepackTurret(YSSIZE_T from)
+{
+	if(0==turretPool.GetN())
+	{
+		return;  // turretTop of all elements are zero.
+	}
+
+	// Placing the same sequence of samples from an earlier position never places a sample at a later position.
+	// Therefore, samples can be moved toward the top in place.
+	YSSIZE_T top=0;
+	if(0<from)
+	{
+		top=recordArray[from-1].turretTop+recordArray[from-1].nTurret;
+	}
+	const YSSIZE_T segSize=((YSSIZE_T)1<<SEGARRAY_BITSHIFT);
+	for(YSSIZE_T idx=from; idx<recordArray.GetN(); )
+	{
+		FsRecordElement <T> *elem=&recordArray[idx];
+		const YSSIZE_T run=YsSmaller <YSSIZE_T> (recordArray.GetN()-idx,segSize-(idx&(segSize-1)));
+		for(YSSIZE_T i=0; i<run; ++i)
+		{
+			const YSSIZE_T newTop=PlaceTurret(top,elem[i].nTurret);
+			if(0<elem[i].nTurret && newTop!=elem[i].turretTop)
+			{
+				FsTurretRecord *dst=&turretPool[newTop];
+				const FsTurretRecord *src=&turretPool[elem[i].turretTop];
+				for(unsigned int j=0; j<elem[i].nTurret; ++j)
+				{
+					dst[j]=src[j];
+				}
+			}
+			elem[i].turretTop=(unsigned int)newTop;
+			top=newTop+elem[i].nTurret;
+		}
+		idx+=run;
+	}
+	turretPool.Resize(top);
+}
+
+template <class T>
+void FsRecord <T>::MoveElement(YSSIZE_T to,YSSIZE_T from,YSSIZE_T n)
+{
+	// to must be smaller than from.  Moved in runs that do not cross the segment boundary.
+	const YSSIZE_T segSize=((YSSIZE_T)1<<SEGARRAY_BITSHIFT);
+	while(0<n)
+	{
+		YSSIZE_T run=n;
+		YsMakeSmaller <YSSIZE_T> (run,segSize-(to&(segSize-1)));
+		YsMakeSmaller <YSSIZE_T> (run,segSize-(from&(segSize-1)));
+		memmove(&recordArray[to],&recordArray[from],sizeof(FsRecordElement <T>)*run);
+		to+=run;
+		from+=run;
+		n-=run;
+	}
+}
+
+template <class T>
+void FsRecord <T>::DeleteElement(YSSIZE_T from,YSSIZE_T n)
+{
+	if(0<n)
+	{
+		MoveElement(from,from+n,recordArray.GetN()-from-n);
+		recordArray.Resize(recordArray.GetN()-n);
+		RepackTurret(from);
+	}
+}
+
+template <class T>
+void FsRecord <T>::ShrinkElement(YSSIZE_T n)
+{
+	if(n<recordArray.GetN())
+	{
+		recordArray.Resize(n);
+		RepackTurret(n);
+	}
+}
+
 template <class T>
 YSRESULT FsRecord <T>::GetIndexByTime(YSSIZE_T &idx,double t)
 {
@@ -306,7 +363,7 @@ const T *FsRecord <T>::GetElement(double &t,YSSIZE_T idx) const
 }
 
 template <class T>
-int FsRecord<T>::GetNumRecord(void)
+int FsRecord<T>::GetNumRecord(void) const
 {
 	return (int)recordArray.GetN();
 }
@@ -366,12 +423,7 @@ template <class T> YSRESULT FsRecord <T>::RipOffEarlyPartOfRecord(void)
 
 	if(nSave<recordArray.GetN())
 	{
-		const YSSIZE_T offset=recordArray.GetN()-nSave;
-		for(YSSIZE_T idx=0; idx<nSave; ++idx)
-		{
-			recordArray[idx]=recordArray[idx+offset];
-		}
-		recordArray.Resize(nSave);
+		DeleteElement(0,recordArray.GetN()-nSave);
 	}
 	return YSOK;
 }
@@ -402,7 +454,7 @@ template <class T> YSRESULT FsRecord <T>::DeleteRecord(const double &t1,const do
 		else if(t1<=topT && lastT<=t2)  //  (t1)<-------------Del------------------->(t2)
 		{                               //           (topT)<---Record--->(lastT)
 			recordArray[0].t=t1;
-			recordArray.Resize(1);
+			ShrinkElement(1);
 			return YSOK;
 		}
 		else
@@ -446,7 +498,7 @@ template <class T> YSRESULT FsRecord <T>::DeleteRecord(const double &t1,const do
 
 			if(topT<t1 && lastT<=t2)  //             (t1)<----------Del------------>(t2)
 			{                         //  (topT)<------------Record--->(lastT)
-				recordArray.Resize(beginIdx);
+				ShrinkElement(beginIdx);
 			}
 			else
 			{
@@ -459,12 +511,11 @@ template <class T> YSRESULT FsRecord <T>::DeleteRecord(const double &t1,const do
 				const YSSIZE_T nDel=endIdx-beginIdx;
 				if(0<nDel)
 				{
-					for(YSSIZE_T recIdx=beginIdx; recIdx<recordArray.GetN()-nDel; ++recIdx)
+					DeleteElement(beginIdx,nDel);
+					for(YSSIZE_T recIdx=beginIdx; recIdx<recordArray.GetN(); ++recIdx)
 					{
-						recordArray[recIdx]=recordArray[recIdx+nDel];
 						recordArray[recIdx].t-=dt;
 					}
-					recordArray.Resize(recordArray.GetN()-nDel);
 				}
 				else // Even if none is deletd, time stamps must be updated.
 				{
@@ -502,13 +553,6 @@ const double FsRecord <T>::GetRecordEndTime(void) const
 	return 0.0;
 }
 
-class FsTurretRecord
-{
-public:
-	float h,p;
-	unsigned int turretState;
-};
-
 class FsFlightRecord
 {
 public:
@@ -532,7 +576,6 @@ public:
 	unsigned char thr;
 	char elv,ail,rud,elvTrim;
 	unsigned char thrVector,bombBay,thrReverser;  // 2003/04/11
-	FsAllocOnceArray <FsTurretRecord> turret;
 };
 
 inline int operator==(const FsFlightRecord &a,const FsFlightRecord &b)
@@ -581,7 +624,6 @@ public:
 	float aaaAimh,aaaAimp,aaaAimb;
 	float samAimh,samAimp,samAimb;
 	float canAimh,canAimp,canAimb;
-	FsAllocOnceArray <FsTurretRecord> turret;
 };
 
 inline int operator==(const FsGroundRecord &a,const FsGroundRecord &b)
@@ -59,6 +59,13 @@ void FsFlightConfig::SetDefault(void)
 
 	accurateTime=YSTRUE;
 
+	parallelSimMove=YSTRUE;
+	checkParallelSimMove=YSFALSE;
+	parallelAiDecision=YSTRUE;
+	asyncTextureDecode=YSTRUE;
+	textureUploadBudget=4096;
+	asyncAirplaneModel=YSTRUE;
+
 	fogVisibility=FS_FOG_VISIBILITY_MAX;
 	radarAltitudeLimit=1000.0*0.3048;
 	noExtAirView=YSFALSE;
@@ -228,6 +235,13 @@ const char *const FsFlightConfig::keyWordSource[]=
 
 	"SHADOWMOD",  // 2024/01/01 - Experimental shadow mode
 
+	"PARALMOVE",
+	"CHKPRLMOV",
+	"PARALAIDC",
+	"ASYNCTEXD",
+	"TEXUPLDKB",
+	"ASYNCAIRM",
+
 	NULL
 };
 YsKeyWordList FsFlightConfig::keyWordList;
@@ -524,6 +538,20 @@ YSRESULT FsFlightConfig::SendCommand(const char cmd[])
 				// Update legacy drawShadow for compatibility
 				drawShadow = (shadowMode != FSSHADOW_FAST) ? YSTRUE : YSFALSE;
 				return YSOK;
+
+			case 63: //	"PARALMOVE",
+				return FsGetBool(parallelSimMove,av[1]);
+			case 64: //	"CHKPRLMOV",
+				return FsGetBool(checkParallelSimMove,av[1]);
+			case 65: //	"PARALAIDC",
+				return FsGetBool(parallelAiDecision,av[1]);
+			case 66: //	"ASYNCTEXD",
+				return FsGetBool(asyncTextureDecode,av[1]);
+			case 67: //	"TEXUPLDKB",
+				textureUploadBudget=atoi(av[1]);
+				return YSOK;
+			case 68: //	"ASYNCAIRM",
+				return FsGetBool(asyncAirplaneModel,av[1]);
 			}
 		}
 		else
@@ -698,6 +726,13 @@ YSRESULT FsFlightConfig::Save(const wchar_t fn[])
 
 		fprintf(fp,"RLDAYVISI %lfm\n",drawLightsInDaylightVisibilityThr);
 
+		fprintf(fp,"PARALMOVE %s\n",FsTrueFalseString(parallelSimMove));
+		fprintf(fp,"CHKPRLMOV %s\n",FsTrueFalseString(checkParallelSimMove));
+		fprintf(fp,"PARALAIDC %s\n",FsTrueFalseString(parallelAiDecision));
+		fprintf(fp,"ASYNCTEXD %s\n",FsTrueFalseString(asyncTextureDecode));
+		fprintf(fp,"TEXUPLDKB %d\n",textureUploadBudget);
+		fprintf(fp,"ASYNCAIRM %s\n",FsTrueFalseString(asyncAirplaneModel));
+
 		fclose(fp);
 		return YSOK;
 	}
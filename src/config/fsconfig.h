@@ -105,6 +105,13 @@ public:
 
 	YSBOOL accurateTime;
 
+	YSBOOL parallelSimMove;       // Integrate per-aircraft physics on the thread pool.  See FsSimulation::SimMove
+	YSBOOL checkParallelSimMove;  // Debug: run serial integration as well and report mismatches.
+	YSBOOL parallelAiDecision;    // Run the decide phase of the autopilots on the thread pool.  See FsSimulation::SimControlByComputer
+	YSBOOL asyncTextureDecode;    // Decode textures in worker threads while flying.  See FsCommonTexture::StartAsyncTextureDecode
+	int textureUploadBudget;      // Kilobytes of decoded textures sent to the GPU per frame when asyncTextureDecode is on.
+	YSBOOL asyncAirplaneModel;    // Load airplane models in worker threads while flying.  See FsWorld::SetUseStandInAirplaneModel
+
 	void SetDefault(void);
 	void SetDetailedMode(void);
 	void SetFastMode(void);
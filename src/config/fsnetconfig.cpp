@@ -53,6 +53,16 @@ const char *const fsNetCmd[]=
 	"LOGONTMOUT", // Log on time out  2007/09/12
 	"MLTCONNLMT", // Multi-Connection Limit  2007/09/12
 
+	"AOIENABLED", // Area-of-interest filtering of airplane states
+	"AOINEARDST", // Full-rate distance
+	"AOIMIDDIST",
+	"AOIFARDIST", // Culled beyond this distance
+	"AOIMIDRATE",
+	"AOIFARRATE",
+	"AOIKPALIVE", // Keep-alive interval of culled airplanes
+
+	"TRAFFICRPT", // Traffic report interval
+
 	NULL
 };
 
@@ -103,6 +113,16 @@ void FsNetConfig::SetDefault(void)
 	sendWelcomeMessage=YSTRUE;
 
 	saveChatLog=YSFALSE;
+
+	serverAreaOfInterest=YSTRUE;
+	aoiNearDist=5000.0;
+	aoiMidDist=20000.0;
+	aoiFarDist=40000.0;
+	aoiMidRate=2.0;
+	aoiFarRate=1.0;
+	aoiCullKeepAlive=5.0;
+
+	trafficReportInterval=0;
 }
 
 YSRESULT FsNetConfig::Load(const wchar_t fn[])
@@ -297,6 +317,40 @@ YSRESULT FsNetConfig::Load(const wchar_t fn[])
 						res=YSOK;
 						break;
 
+					case 33: // "AOIENABLED"
+						res=YSOK;
+						serverAreaOfInterest=YsStrToBool(av[1]);
+						break;
+					case 34: // "AOINEARDST"
+						aoiNearDist=atof(av[1]);
+						res=YSOK;
+						break;
+					case 35: // "AOIMIDDIST"
+						aoiMidDist=atof(av[1]);
+						res=YSOK;
+						break;
+					case 36: // "AOIFARDIST"
+						aoiFarDist=atof(av[1]);
+						res=YSOK;
+						break;
+					case 37: // "AOIMIDRATE"
+						aoiMidRate=atof(av[1]);
+						res=YSOK;
+						break;
+					case 38: // "AOIFARRATE"
+						aoiFarRate=atof(av[1]);
+						res=YSOK;
+						break;
+					case 39: // "AOIKPALIVE"
+						aoiCullKeepAlive=atof(av[1]);
+						res=YSOK;
+						break;
+
+					case 40: // "TRAFFICRPT"
+						trafficReportInterval=atoi(av[1]);
+						res=YSOK;
+						break;
+
 					default:
 						res=YSERR;
 						break;
@@ -371,6 +425,16 @@ YSRESULT FsNetConfig::Save(const wchar_t fn[])
 		fprintf(fp,"LOGONTMOUT %d\n",logOnTimeOut);
 		fprintf(fp,"MLTCONNLMT %d\n",multiConnLimit);
 
+		fprintf(fp,"AOIENABLED %s\n",YsBoolToStr(serverAreaOfInterest));
+		fprintf(fp,"AOINEARDST %.1lf\n",aoiNearDist);
+		fprintf(fp,"AOIMIDDIST %.1lf\n",aoiMidDist);
+		fprintf(fp,"AOIFARDIST %.1lf\n",aoiFarDist);
+		fprintf(fp,"AOIMIDRATE %.2lf\n",aoiMidRate);
+		fprintf(fp,"AOIFARRATE %.2lf\n",aoiFarRate);
+		fprintf(fp,"AOIKPALIVE %.2lf\n",aoiCullKeepAlive);
+
+		fprintf(fp,"TRAFFICRPT %d\n",trafficReportInterval);
+
 		fclose(fp);
 		return YSOK;
 	}
@@ -49,6 +49,18 @@ public:
 
 	int portNumber;
 
+	// Area of interest >>
+	// Airplane states are sent at the full rate within aoiNearDist from the user's airplane,
+	// at aoiMidRate (Hz) within aoiMidDist, at aoiFarRate (Hz) within aoiFarDist, and are culled beyond aoiFarDist.
+	// Culled airplanes are sent every aoiCullKeepAlive seconds so that the clients won't dead-reckon them forever.
+	// (aoiCullKeepAlive=0 -> Not sent at all)
+	YSBOOL serverAreaOfInterest;
+	double aoiNearDist,aoiMidDist,aoiFarDist;
+	double aoiMidRate,aoiFarRate;
+	double aoiCullKeepAlive;
+	// Area of interest <<
+
+	int trafficReportInterval;   // Seconds.  0 -> No report.
 
 
 	FsNetConfig();
@@ -0,0 +1,83 @@
+#include <ysclass.h>
+
+#include "fs.h"
+#include "fsaicontrolsnapshot.h"
+
+
+
+FsAiControlSnapshot::FsAiControlSnapshot()
+{
+	CleanUp();
+}
+
+void FsAiControlSnapshot::CleanUp(void)
+{
+	valid=YSFALSE;
+	airState.CleanUp();
+}
+
+void FsAiControlSnapshot::Make(const FsSimulation *sim)
+{
+	airState.Set(0,NULL);
+	for(const FsAirplane *air=NULL; NULL!=(air=sim->FindNextAirplane(air)); )
+	{
+		air->fsAiControlSnapshotIdx=airState.GetN();
+
+		airState.Increment();
+		auto &state=airState.Last();
+		state.air=const_cast <FsAirplane *>(air);
+		state.searchKey=air->SearchKey();
+		state.pos=air->GetPosition();
+		state.att=air->GetAttitude();
+		state.iff=air->iff;
+		state.airFlag=air->airFlag;
+		state.isActive=air->Prop().IsActive();
+		state.isOnGround=air->Prop().IsOnGround();
+		state.flightState=air->Prop().GetFlightState();
+
+		state.apType=FSAUTOPILOT_NONE;
+		state.dogfightMode=FsDogfight::DFMODE_NOTARGET;
+		state.dogfightTargetKey=YSNULLHASHKEY;
+
+		const FsAutopilot *ap=air->GetAutopilot();
+		if(NULL!=ap)
+		{
+			state.apType=ap->Type();
+			if(FSAUTOPILOT_DOGFIGHT==ap->Type())
+			{
+				const FsDogfight *df=(const FsDogfight *)ap;
+				state.dogfightMode=df->mode;
+				state.dogfightTargetKey=df->GetTargetKey();
+			}
+		}
+	}
+	valid=YSTRUE;
+}
+
+void FsAiControlSnapshot::Invalidate(void)
+{
+	valid=YSFALSE;
+}
+
+YSBOOL FsAiControlSnapshot::IsValid(void) const
+{
+	return valid;
+}
+
+YsConstArrayMask <FsAiControlSnapshot::AirState> FsAiControlSnapshot::AllAir(void) const
+{
+	return YsConstArrayMask <AirState>(airState.GetN(),airState);
+}
+
+const FsAiControlSnapshot::AirState *FsAiControlSnapshot::FindAir(const FsAirplane *air) const
+{
+	if(YSTRUE==valid && NULL!=air)
+	{
+		const YSSIZE_T idx=air->fsAiControlSnapshotIdx;
+		if(YSTRUE==airState.IsInRange(idx) && airState[idx].air==air)
+		{
+			return &airState[idx];
+		}
+	}
+	return NULL;
+}
@@ -0,0 +1,64 @@
+#ifndef FSAICONTROLSNAPSHOT_IS_INCLUDED
+#define FSAICONTROLSNAPSHOT_IS_INCLUDED
+/* { */
+
+#include <ysclass.h>
+#include "fsdef.h"
+
+class FsAirplane;
+class FsSimulation;
+
+/*! Frozen state of the airplanes for the decide phase of SimControlByComputer.
+
+    Made once per control tick, before the autopilots run in parallel.  Positions and attitudes do not change
+    during the decide phase, but the autopilot state of the other airplanes (such as the target of FsDogfight) does.
+    An autopilot that needs the state of another airplane's autopilot must read it from here, not from the autopilot
+    itself.  The scans over all airplanes are also cheaper over this array than over the airplane list.
+
+    The snapshot is valid only during SimControlByComputer.  Outside, IsValid returns YSFALSE, and the autopilots
+    should read the live state.
+*/
+class FsAiControlSnapshot
+{
+public:
+	class AirState
+	{
+	public:
+		FsAirplane *air;
+		YSHASHKEY searchKey;
+		YsVec3 pos;
+		YsAtt3 att;
+		int iff;
+		unsigned int airFlag;
+		YSBOOL isActive,isOnGround;
+		FSFLIGHTSTATE flightState;
+
+		FSAUTOPILOTTYPE apType;       // FSAUTOPILOT_NONE if the airplane has no autopilot.
+		int dogfightMode;             // FsDogfight::mode if apType==FSAUTOPILOT_DOGFIGHT
+		YSHASHKEY dogfightTargetKey;  // Target of FsDogfight if apType==FSAUTOPILOT_DOGFIGHT
+	};
+
+private:
+	YSBOOL valid;
+	YsArray <AirState> airState;
+
+public:
+	FsAiControlSnapshot();
+	void CleanUp(void);
+
+	/*! Takes the state of all the airplanes in the simulation. */
+	void Make(const FsSimulation *sim);
+
+	/*! Marks the snapshot out of date, but keeps the memory for the next Make. */
+	void Invalidate(void);
+
+	YSBOOL IsValid(void) const;
+
+	YsConstArrayMask <AirState> AllAir(void) const;
+
+	/*! Returns the state of the airplane, or NULL if the snapshot is invalid or does not include the airplane. */
+	const AirState *FindAir(const FsAirplane *air) const;
+};
+
+/* } */
+#endif
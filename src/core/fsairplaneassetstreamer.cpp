@@ -0,0 +1,83 @@
+#include <memory>
+#include <ysclass.h>
+
+#include "fsfilename.h"
+#include "fsairplaneassetstreamer.h"
+
+
+FsAirplaneModelSet::FsAirplaneModelSet()
+{
+	modelMask=0;
+}
+
+////////////////////////////////////////////////////////////
+
+void FsAirplaneModelRequest::Cancel(void) const
+{
+	if(nullptr!=cancelled)
+	{
+		*cancelled=true;
+	}
+}
+
+////////////////////////////////////////////////////////////
+
+FsAirplaneAssetStreamer::FsAirplaneAssetStreamer(int nThread) : scheduler(nThread),group(scheduler)
+{
+	// Lazily-made statics used in FsVisualDnm::Load.  Must exist before the first worker reads a file.
+	YsVisualDnm::PrepareMultiThreadLoad();
+	FsGetModelCacheDir();
+}
+
+FsAirplaneAssetStreamer::~FsAirplaneAssetStreamer()
+{
+	group.Wait();
+}
+
+void FsAirplaneAssetStreamer::Wait(void)
+{
+	group.Wait();
+}
+
+/* static */ FsAirplaneModelSet FsAirplaneAssetStreamer::LoadModelSet(unsigned int modelMask,const YsWString &visFn,const YsWString &lodFn,const YsWString &cockpitFn)
+{
+	FsAirplaneModelSet modelSet;
+	modelSet.modelMask=modelMask;
+	if(0!=(modelMask&FsAirplaneModelSet::MODEL_VISUAL) && 0<visFn.Strlen())
+	{
+		modelSet.vis.Load(visFn);
+	}
+	if(0!=(modelMask&FsAirplaneModelSet::MODEL_LOD) && 0<lodFn.Strlen())
+	{
+		modelSet.lod.Load(lodFn);
+	}
+	if(0!=(modelMask&FsAirplaneModelSet::MODEL_COCKPIT) && 0<cockpitFn.Strlen())
+	{
+		modelSet.cockpit.Load(cockpitFn);
+	}
+	return modelSet;
+}
+
+FsAirplaneModelRequest FsAirplaneAssetStreamer::Load(unsigned int modelMask,const wchar_t visFn[],const wchar_t lodFn[],const wchar_t cockpitFn[])
+{
+	YsWString visFnCopy(visFn),lodFnCopy(lodFn),cockpitFnCopy(cockpitFn);
+
+	FsAirplaneModelRequest req;
+	req.cancelled=std::make_shared <std::atomic <bool> >(false);
+
+	// std::function needs a copyable callable.  packaged_task is move-only, therefore it is shared.
+	auto cancelled=req.cancelled;
+	auto task=std::make_shared <std::packaged_task <FsAirplaneModelSet()> >(
+		[modelMask,visFnCopy,lodFnCopy,cockpitFnCopy,cancelled]()
+		{
+			if(true==*cancelled)
+			{
+				return FsAirplaneModelSet();
+			}
+			return LoadModelSet(modelMask,visFnCopy,lodFnCopy,cockpitFnCopy);
+		});
+
+	req.modelSet=task->get_future().share();
+	group.Run([task](){(*task)();});
+	return req;
+}
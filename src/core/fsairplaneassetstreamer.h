@@ -0,0 +1,83 @@
+#ifndef FSAIRPLANEASSETSTREAMER_IS_INCLUDED
+#define FSAIRPLANEASSETSTREAMER_IS_INCLUDED
+/* { */
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <ysclass.h>
+#include <ystaskscheduler.h>
+
+#include "fsvisual.h"
+
+/*! Models of one airplane template loaded by FsAirplaneAssetStreamer.
+    A model that was not requested, or could not be loaded, is nullptr.
+*/
+class FsAirplaneModelSet
+{
+public:
+	enum
+	{
+		MODEL_VISUAL=1,
+		MODEL_LOD=2,
+		MODEL_COCKPIT=4,
+		MODEL_ALL=7
+	};
+
+	unsigned int modelMask;  // Requested models.
+	FsVisualDnm vis,lod,cockpit;
+
+	FsAirplaneModelSet();
+};
+
+/*! A load started by FsAirplaneAssetStreamer::Load. */
+class FsAirplaneModelRequest
+{
+public:
+	std::shared_future <FsAirplaneModelSet> modelSet;
+	std::shared_ptr <std::atomic <bool> > cancelled;
+
+	/*! Skips the load if no worker has started it yet.  Then, modelSet gives an FsAirplaneModelSet with modelMask=0.
+	    A load that is already started is finished as usual. */
+	void Cancel(void) const;
+};
+
+/*! Loads airplane models (visual, coarse, and cockpit) in worker threads.
+
+    The property and the collision shell are not streamed.  FsAirplaneProperty::LoadProperty is not
+    thread-safe, and FsWorld::AddAirplane needs both of them on the spot anyway.  They are much smaller
+    than the visual model.
+
+    A worker only reads the files and fills FsVisualDnm objects of its own.  The results are handed back
+    through a future, and are given to the template by FsAirplaneTemplate::InstallStreamedModel in the
+    main thread.  Static tables used by the DNM reader are made in the constructor, therefore the
+    streamer must be constructed in the main thread.
+*/
+class FsAirplaneAssetStreamer
+{
+private:
+	FsAirplaneAssetStreamer(const FsAirplaneAssetStreamer &);
+	FsAirplaneAssetStreamer &operator=(const FsAirplaneAssetStreamer &);
+
+	YsTaskScheduler scheduler;
+	YsTaskScheduler::TaskGroup group;
+
+	static FsAirplaneModelSet LoadModelSet(unsigned int modelMask,const YsWString &visFn,const YsWString &lodFn,const YsWString &cockpitFn);
+
+public:
+	/*! With nThread=0, the loads run in the thread that calls Wait. */
+	FsAirplaneAssetStreamer(int nThread);
+
+	/*! Waits for the loads that are already started. */
+	~FsAirplaneAssetStreamer();
+
+	/*! Waits for all the loads, including the cancelled ones. */
+	void Wait(void);
+
+	/*! Starts loading the models in modelMask (combination of FsAirplaneModelSet::MODEL_*) from the given files.
+	    An empty file name is skipped.  The file names are copied before this function returns. */
+	FsAirplaneModelRequest Load(unsigned int modelMask,const wchar_t visFn[],const wchar_t lodFn[],const wchar_t cockpitFn[]);
+};
+
+/* } */
+#endif
@@ -0,0 +1,551 @@
+#include <string.h>
+
+#include <ysclass.h>
+#include <ysport.h>
+
+#include "fs.h"
+#include "fsbinaryrecord.h"
+
+
+
+static const char fsBinaryRecordMagic[8]={'Y','S','F','L','T','R','E','C'};
+
+
+
+unsigned long long FsBinaryRecord::Align(unsigned long long offset)
+{
+	return (offset+7)&~(unsigned long long)7;
+}
+
+FsBinaryRecord::BlockLayout FsBinaryRecord::MakeBlockLayout(STREAMTYPE streamType,unsigned long long nRecord,unsigned long long nTurret)
+{
+	const unsigned long long stateSize=(STREAM_AIRPLANE==streamType ? sizeof(FlightState) : sizeof(GroundState));
+
+	BlockLayout layout;
+	layout.tOffset=0;
+	layout.xOffset=Align(layout.tOffset+sizeof(double)*nRecord);
+	layout.yOffset=Align(layout.xOffset+sizeof(double)*nRecord);
+	layout.zOffset=Align(layout.yOffset+sizeof(double)*nRecord);
+	layout.hOffset=Align(layout.zOffset+sizeof(double)*nRecord);
+	layout.pOffset=Align(layout.hOffset+sizeof(float)*nRecord);
+	layout.bOffset=Align(layout.pOffset+sizeof(float)*nRecord);
+	layout.stateOffset=Align(layout.bOffset+sizeof(float)*nRecord);
+	layout.turretTopOffset=Align(layout.stateOffset+stateSize*nRecord);
+	layout.turretOffset=Align(layout.turretTopOffset+sizeof(unsigned int)*(nRecord+1));
+	layout.size=Align(layout.turretOffset+sizeof(TurretState)*nTurret);
+	return layout;
+}
+
+
+
+////////////////////////////////////////////////////////////
+
+
+
+FsBinaryRecordWriter::FsBinaryRecordWriter()
+{
+	fp=NULL;
+	filePtr=0;
+	writeError=YSFALSE;
+}
+
+FsBinaryRecordWriter::~FsBinaryRecordWriter()
+{
+	Close();
+}
+
+YSRESULT FsBinaryRecordWriter::Open(const wchar_t fn[])
+{
+	Close();
+
+	fp=YsFileIO::Fopen(fn,"wb");
+	if(NULL==fp)
+	{
+		return YSERR;
+	}
+
+	filePtr=0;
+	writeError=YSFALSE;
+	streamTable.Clear();
+
+	// Placeholder.  Re-written in Close.
+	FileHeader hd;
+	memset(&hd,0,sizeof(hd));
+	Write(sizeof(hd),&hd);
+
+	return (YSTRUE!=writeError ? YSOK : YSERR);
+}
+
+YSRESULT FsBinaryRecordWriter::Close(void)
+{
+	if(NULL==fp)
+	{
+		return YSERR;
+	}
+
+	FileHeader hd;
+	memset(&hd,0,sizeof(hd));
+	memcpy(hd.magic,fsBinaryRecordMagic,sizeof(hd.magic));
+	hd.version=FILE_VERSION;
+	hd.byteOrderMark=BYTE_ORDER_MARK;
+	hd.streamTableOffset=filePtr;
+	hd.nStream=(unsigned int)streamTable.GetN();
+
+	Write(sizeof(StreamHeader)*streamTable.GetN(),streamTable.GetArray());
+
+	fseek(fp,0,SEEK_SET);
+	Write(sizeof(hd),&hd);
+
+	fclose(fp);
+	fp=NULL;
+	streamTable.ClearDeep();
+	blockBuf.ClearDeep();
+	turretBuf.ClearDeep();
+
+	return (YSTRUE!=writeError ? YSOK : YSERR);
+}
+
+int FsBinaryRecordWriter::AddStream(const FsRecord <FsFlightRecord> &rec)
+{
+	return AddStream <FsFlightRecord,FlightState> (STREAM_AIRPLANE,rec);
+}
+
+int FsBinaryRecordWriter::AddStream(const FsRecord <FsGroundRecord> &rec)
+{
+	return AddStream <FsGroundRecord,GroundState> (STREAM_GROUND,rec);
+}
+
+void FsBinaryRecordWriter::Write(YSSIZE_T nByte,const void *dat)
+{
+	if(0<nByte && nByte!=(YSSIZE_T)fwrite(dat,1,nByte,fp))
+	{
+		writeError=YSTRUE;
+	}
+	filePtr+=nByte;
+}
+
+template <class RecordType,class StateType>
+int FsBinaryRecordWriter::AddStream(STREAMTYPE streamType,const FsRecord <RecordType> &rec)
+{
+	if(NULL==fp)
+	{
+		return -1;
+	}
+
+	const YSSIZE_T nRecord=rec.GetNumRecord();
+
+	StreamHeader stream;
+	stream.streamType=streamType;
+	stream.nBlock=(unsigned int)((nRecord+MAX_BLOCK_SIZE-1)/MAX_BLOCK_SIZE);
+	stream.nRecord=nRecord;
+	stream.blockIndexOffset=0;
+	stream.tBegin=0.0;
+	stream.tEnd=0.0;
+
+	YsArray <BlockHeader> blockIndex;
+	for(YSSIZE_T recIdx0=0; recIdx0<nRecord; recIdx0+=MAX_BLOCK_SIZE)
+	{
+		const YSSIZE_T n=YsSmaller <YSSIZE_T> (MAX_BLOCK_SIZE,nRecord-recIdx0);
+
+		turretBuf.Clear();
+		for(YSSIZE_T i=0; i<n; ++i)
+		{
+			auto turret=rec.GetTurret(recIdx0+i);
+			for(YSSIZE_T j=0; j<turret.GetN(); ++j)
+			{
+				TurretState tur;
+				tur.h=turret[j].h;
+				tur.p=turret[j].p;
+				tur.turretState=turret[j].turretState;
+				turretBuf.Append(tur);
+			}
+		}
+
+		const BlockLayout layout=MakeBlockLayout(streamType,n,turretBuf.GetN());
+		blockBuf.Resize(layout.size);
+		memset(blockBuf.GetEditableArray(),0,layout.size);
+
+		unsigned char *blk=blockBuf.GetEditableArray();
+		double *tCol=(double *)(blk+layout.tOffset);
+		double *xCol=(double *)(blk+layout.xOffset);
+		double *yCol=(double *)(blk+layout.yOffset);
+		double *zCol=(double *)(blk+layout.zOffset);
+		float *hCol=(float *)(blk+layout.hOffset);
+		float *pCol=(float *)(blk+layout.pOffset);
+		float *bCol=(float *)(blk+layout.bOffset);
+		StateType *stateCol=(StateType *)(blk+layout.stateOffset);
+		unsigned int *turretTopCol=(unsigned int *)(blk+layout.turretTopOffset);
+
+		unsigned int turretTop=0;
+		for(YSSIZE_T i=0; i<n; ++i)
+		{
+			double t;
+			const RecordType *r=rec.GetElement(t,recIdx0+i);
+			tCol[i]=t;
+			xCol[i]=r->pos.x();
+			yCol[i]=r->pos.y();
+			zCol[i]=r->pos.z();
+			hCol[i]=r->h;
+			pCol[i]=r->p;
+			bCol[i]=r->b;
+			CopyState(stateCol[i],*r);
+			turretTopCol[i]=turretTop;
+			turretTop+=(unsigned int)rec.GetTurret(recIdx0+i).GetN();
+		}
+		turretTopCol[n]=turretTop;
+		if(0<turretBuf.GetN())
+		{
+			memcpy(blk+layout.turretOffset,turretBuf.GetArray(),sizeof(TurretState)*turretBuf.GetN());
+		}
+
+		BlockHeader blkHd;
+		blkHd.tBegin=tCol[0];
+		blkHd.tEnd=tCol[n-1];
+		blkHd.offset=filePtr;
+		blkHd.nRecord=(unsigned int)n;
+		blkHd.nTurret=(unsigned int)turretBuf.GetN();
+		blockIndex.Append(blkHd);
+
+		Write(layout.size,blk);
+	}
+
+	if(0<blockIndex.GetN())
+	{
+		stream.tBegin=blockIndex[0].tBegin;
+		stream.tEnd=blockIndex.Last().tEnd;
+	}
+	stream.blockIndexOffset=filePtr;
+	Write(sizeof(BlockHeader)*blockIndex.GetN(),blockIndex.GetArray());
+
+	streamTable.Append(stream);
+	return (int)streamTable.GetN()-1;
+}
+
+void FsBinaryRecordWriter::CopyState(FlightState &state,const FsFlightRecord &rec)
+{
+	state.g=rec.g;
+	state.state=rec.state;
+	state.vgw=rec.vgw;
+	state.spoiler=rec.spoiler;
+	state.gear=rec.gear;
+	state.flap=rec.flap;
+	state.brake=rec.brake;
+	state.smoke=rec.smoke;
+	state.vapor=rec.vapor;
+	state.flags=rec.flags;
+	state.dmgTolerance=rec.dmgTolerance;
+	state.thr=rec.thr;
+	state.elv=rec.elv;
+	state.ail=rec.ail;
+	state.rud=rec.rud;
+	state.elvTrim=rec.elvTrim;
+	state.thrVector=rec.thrVector;
+	state.bombBay=rec.bombBay;
+	state.thrReverser=rec.thrReverser;
+	state.reserved=0;
+}
+
+void FsBinaryRecordWriter::CopyState(GroundState &state,const FsGroundRecord &rec)
+{
+	state.state=rec.state;
+	state.dmgTolerance=rec.dmgTolerance;
+	state.steering=rec.steering;
+	state.leftDoor=rec.leftDoor;
+	state.rightDoor=rec.rightDoor;
+	state.rearDoor=rec.rearDoor;
+	state.brake=rec.brake;
+	state.lightState=rec.lightState;
+	state.aaaAimh=rec.aaaAimh;
+	state.aaaAimp=rec.aaaAimp;
+	state.aaaAimb=rec.aaaAimb;
+	state.samAimh=rec.samAimh;
+	state.samAimp=rec.samAimp;
+	state.samAimb=rec.samAimb;
+	state.canAimh=rec.canAimh;
+	state.canAimp=rec.canAimp;
+	state.canAimb=rec.canAimb;
+}
+
+
+
+////////////////////////////////////////////////////////////
+
+
+
+FsBinaryRecordReader::FsBinaryRecordReader()
+{
+	nStream=0;
+	streamTable=nullptr;
+}
+
+YSRESULT FsBinaryRecordReader::Open(const wchar_t fn[])
+{
+	Close();
+
+	if(YSOK!=file.Open(fn))
+	{
+		return YSERR;
+	}
+
+	const unsigned long long fileSize=file.size();
+	const unsigned char *dat=file.data();
+
+	FileHeader hd;
+	if(fileSize<sizeof(hd))
+	{
+		Close();
+		return YSERR;
+	}
+	memcpy(&hd,dat,sizeof(hd));
+	if(0!=memcmp(hd.magic,fsBinaryRecordMagic,sizeof(hd.magic)) ||
+	   FILE_VERSION!=hd.version ||
+	   BYTE_ORDER_MARK!=hd.byteOrderMark ||
+	   0!=(hd.streamTableOffset&7) ||
+	   fileSize<hd.streamTableOffset ||
+	   (fileSize-hd.streamTableOffset)/sizeof(StreamHeader)<hd.nStream)
+	{
+		Close();
+		return YSERR;
+	}
+
+	const StreamHeader *table=(const StreamHeader *)(dat+hd.streamTableOffset);
+	for(unsigned int streamIdx=0; streamIdx<hd.nStream; ++streamIdx)
+	{
+		const StreamHeader &stream=table[streamIdx];
+		if((STREAM_AIRPLANE!=stream.streamType && STREAM_GROUND!=stream.streamType) ||
+		   0!=(stream.blockIndexOffset&7) ||
+		   fileSize<stream.blockIndexOffset ||
+		   (fileSize-stream.blockIndexOffset)/sizeof(BlockHeader)<stream.nBlock)
+		{
+			Close();
+			return YSERR;
+		}
+
+		unsigned long long nRecord=0;
+		const BlockHeader *blockIndex=(const BlockHeader *)(dat+stream.blockIndexOffset);
+		for(unsigned int blockIdx=0; blockIdx<stream.nBlock; ++blockIdx)
+		{
+			const BlockHeader &blk=blockIndex[blockIdx];
+			const BlockLayout layout=MakeBlockLayout((STREAMTYPE)stream.streamType,blk.nRecord,blk.nTurret);
+			if(0==blk.nRecord ||
+			   MAX_BLOCK_SIZE<blk.nRecord ||
+			   0!=(blk.offset&7) ||
+			   fileSize<blk.offset ||
+			   fileSize-blk.offset<layout.size)
+			{
+				Close();
+				return YSERR;
+			}
+
+			const unsigned int *turretTop=(const unsigned int *)(dat+blk.offset+layout.turretTopOffset);
+			if(blk.nTurret!=turretTop[blk.nRecord])
+			{
+				Close();
+				return YSERR;
+			}
+			nRecord+=blk.nRecord;
+		}
+		if(nRecord!=stream.nRecord)
+		{
+			Close();
+			return YSERR;
+		}
+	}
+
+	nStream=hd.nStream;
+	streamTable=table;
+	return YSOK;
+}
+
+void FsBinaryRecordReader::Close(void)
+{
+	file.Close();
+	nStream=0;
+	streamTable=nullptr;
+}
+
+YSBOOL FsBinaryRecordReader::IsOpen(void) const
+{
+	return file.IsOpen();
+}
+
+YSSIZE_T FsBinaryRecordReader::GetNumStream(void) const
+{
+	return nStream;
+}
+
+const FsBinaryRecord::StreamHeader *FsBinaryRecordReader::GetStream(YSSIZE_T streamIdx) const
+{
+	if(0<=streamIdx && streamIdx<nStream)
+	{
+		return &streamTable[streamIdx];
+	}
+	return nullptr;
+}
+
+YSSIZE_T FsBinaryRecordReader::GetNumBlock(YSSIZE_T streamIdx) const
+{
+	auto stream=GetStream(streamIdx);
+	if(nullptr!=stream)
+	{
+		return stream->nBlock;
+	}
+	return 0;
+}
+
+const FsBinaryRecord::BlockHeader *FsBinaryRecordReader::GetBlockHeader(YSSIZE_T streamIdx,YSSIZE_T blockIdx) const
+{
+	auto stream=GetStream(streamIdx);
+	if(nullptr!=stream && 0<=blockIdx && blockIdx<(YSSIZE_T)stream->nBlock)
+	{
+		return ((const BlockHeader *)(file.data()+stream->blockIndexOffset))+blockIdx;
+	}
+	return nullptr;
+}
+
+FsBinaryRecord::Block FsBinaryRecordReader::GetBlock(YSSIZE_T streamIdx,YSSIZE_T blockIdx) const
+{
+	Block block;
+	memset(&block,0,sizeof(block));
+
+	auto stream=GetStream(streamIdx);
+	auto blkHd=GetBlockHeader(streamIdx,blockIdx);
+	if(nullptr!=stream && nullptr!=blkHd)
+	{
+		const BlockLayout layout=MakeBlockLayout((STREAMTYPE)stream->streamType,blkHd->nRecord,blkHd->nTurret);
+		const unsigned char *blk=file.data()+blkHd->offset;
+
+		block.nRecord=blkHd->nRecord;
+		block.t=(const double *)(blk+layout.tOffset);
+		block.x=(const double *)(blk+layout.xOffset);
+		block.y=(const double *)(blk+layout.yOffset);
+		block.z=(const double *)(blk+layout.zOffset);
+		block.h=(const float *)(blk+layout.hOffset);
+		block.p=(const float *)(blk+layout.pOffset);
+		block.b=(const float *)(blk+layout.bOffset);
+		if(STREAM_AIRPLANE==stream->streamType)
+		{
+			block.flightState=(const FlightState *)(blk+layout.stateOffset);
+		}
+		else
+		{
+			block.groundState=(const GroundState *)(blk+layout.stateOffset);
+		}
+		block.turretTop=(const unsigned int *)(blk+layout.turretTopOffset);
+		block.turret=(const TurretState *)(blk+layout.turretOffset);
+	}
+	return block;
+}
+
+static YSRESULT FsBinaryRecordCopyTurret(YsArray <FsTurretRecord,16> &turret,const FsBinaryRecord::Block &block,YSSIZE_T i)
+{
+	const unsigned int top=block.turretTop[i],end=block.turretTop[i+1];
+	if(end<top || block.turretTop[block.nRecord]<end)
+	{
+		return YSERR;
+	}
+	turret.Resize(end-top);
+	for(unsigned int j=top; j<end; ++j)
+	{
+		turret[j-top].h=block.turret[j].h;
+		turret[j-top].p=block.turret[j].p;
+		turret[j-top].turretState=block.turret[j].turretState;
+	}
+	return YSOK;
+}
+
+YSRESULT FsBinaryRecordReader::LoadStream(YSSIZE_T streamIdx,FsAirplane &air) const
+{
+	auto stream=GetStream(streamIdx);
+	if(nullptr==stream || STREAM_AIRPLANE!=stream->streamType)
+	{
+		return YSERR;
+	}
+
+	FsFlightRecord rec;
+	YsArray <FsTurretRecord,16> turret;
+	for(YSSIZE_T blockIdx=0; blockIdx<(YSSIZE_T)stream->nBlock; ++blockIdx)
+	{
+		const Block block=GetBlock(streamIdx,blockIdx);
+		for(YSSIZE_T i=0; i<block.nRecord; ++i)
+		{
+			const FlightState &state=block.flightState[i];
+			rec.pos.Set(block.x[i],block.y[i],block.z[i]);
+			rec.h=block.h[i];
+			rec.p=block.p[i];
+			rec.b=block.b[i];
+			rec.g=state.g;
+			rec.state=state.state;
+			rec.vgw=state.vgw;
+			rec.spoiler=state.spoiler;
+			rec.gear=state.gear;
+			rec.flap=state.flap;
+			rec.brake=state.brake;
+			rec.smoke=state.smoke;
+			rec.vapor=state.vapor;
+			rec.flags=state.flags;
+			rec.dmgTolerance=state.dmgTolerance;
+			rec.thr=state.thr;
+			rec.elv=state.elv;
+			rec.ail=state.ail;
+			rec.rud=state.rud;
+			rec.elvTrim=state.elvTrim;
+			rec.thrVector=state.thrVector;
+			rec.bombBay=state.bombBay;
+			rec.thrReverser=state.thrReverser;
+			if(YSOK!=FsBinaryRecordCopyTurret(turret,block,i))
+			{
+				return YSERR;
+			}
+			air.Record(block.t[i],rec,turret,YSTRUE);
+		}
+	}
+	return YSOK;
+}
+
+YSRESULT FsBinaryRecordReader::LoadStream(YSSIZE_T streamIdx,FsGround &gnd) const
+{
+	auto stream=GetStream(streamIdx);
+	if(nullptr==stream || STREAM_GROUND!=stream->streamType)
+	{
+		return YSERR;
+	}
+
+	FsGroundRecord rec;
+	YsArray <FsTurretRecord,16> turret;
+	for(YSSIZE_T blockIdx=0; blockIdx<(YSSIZE_T)stream->nBlock; ++blockIdx)
+	{
+		const Block block=GetBlock(streamIdx,blockIdx);
+		for(YSSIZE_T i=0; i<block.nRecord; ++i)
+		{
+			const GroundState &state=block.groundState[i];
+			rec.pos.Set(block.x[i],block.y[i],block.z[i]);
+			rec.h=block.h[i];
+			rec.p=block.p[i];
+			rec.b=block.b[i];
+			rec.state=state.state;
+			rec.dmgTolerance=state.dmgTolerance;
+			rec.steering=state.steering;
+			rec.leftDoor=state.leftDoor;
+			rec.rightDoor=state.rightDoor;
+			rec.rearDoor=state.rearDoor;
+			rec.brake=state.brake;
+			rec.lightState=state.lightState;
+			rec.aaaAimh=state.aaaAimh;
+			rec.aaaAimp=state.aaaAimp;
+			rec.aaaAimb=state.aaaAimb;
+			rec.samAimh=state.samAimh;
+			rec.samAimp=state.samAimp;
+			rec.samAimb=state.samAimb;
+			rec.canAimh=state.canAimh;
+			rec.canAimp=state.canAimp;
+			rec.canAimb=state.canAimb;
+			if(YSOK!=FsBinaryRecordCopyTurret(turret,block,i))
+			{
+				return YSERR;
+			}
+			gnd.Record(block.t[i],rec,turret,YSTRUE);
+		}
+	}
+	return YSOK;
+}
@@ -0,0 +1,191 @@
+#ifndef FSBINARYRECORD_IS_INCLUDED
+#define FSBINARYRECORD_IS_INCLUDED
+/* { */
+
+#include <stdio.h>
+#include <ysclass.h>
+#include <ysport.h>
+
+#include "fsrecord.h"
+
+/*! Binary container of the airplane and ground-object records (.yfr).
+    The text .yfs keeps headers, events, and autopilots, and refers to the container by RECDFILE and BINRECOR.
+
+    The file is meant to be mapped in the memory and read without parsing.  All numbers are in the byte order
+    of the machine that wrote the file (byteOrderMark tells), and every column is aligned to 8 bytes.
+
+      FileHeader
+      For each stream (one stream per object)
+        For each block (up to MAX_BLOCK_SIZE records)
+          double t[n]
+          double x[n],y[n],z[n]
+          float h[n],p[n],b[n]
+          FlightState or GroundState state[n]
+          unsigned int turretTop[n+1]
+          TurretState turret[turretTop[n]]
+        BlockHeader blockIndex[nBlock]
+      StreamHeader streamTable[nStream]
+*/
+class FsBinaryRecord
+{
+public:
+	enum
+	{
+		FILE_VERSION=1,
+		BYTE_ORDER_MARK=0x01020304,
+		MAX_BLOCK_SIZE=4096
+	};
+	enum STREAMTYPE
+	{
+		STREAM_AIRPLANE=0,
+		STREAM_GROUND=1
+	};
+
+	class FileHeader
+	{
+	public:
+		char magic[8];                      // "YSFLTREC"
+		unsigned int version;
+		unsigned int byteOrderMark;
+		unsigned long long streamTableOffset;
+		unsigned int nStream;
+		unsigned int reserved;
+	};
+	class StreamHeader
+	{
+	public:
+		unsigned int streamType;
+		unsigned int nBlock;
+		unsigned long long nRecord;
+		unsigned long long blockIndexOffset;
+		double tBegin,tEnd;
+	};
+	class BlockHeader
+	{
+	public:
+		double tBegin,tEnd;
+		unsigned long long offset;
+		unsigned int nRecord;
+		unsigned int nTurret;
+	};
+
+	/*! Members of FsFlightRecord other than time, position, attitude, and turrets. */
+	class FlightState
+	{
+	public:
+		float g;
+		unsigned char state,vgw,spoiler,gear,flap,brake,smoke,vapor;
+		unsigned short flags;
+		unsigned char dmgTolerance,thr;
+		signed char elv,ail,rud,elvTrim;
+		unsigned char thrVector,bombBay,thrReverser,reserved;
+	};
+	/*! Members of FsGroundRecord other than time, position, attitude, and turrets. */
+	class GroundState
+	{
+	public:
+		unsigned char state,dmgTolerance;
+		signed char steering;
+		unsigned char leftDoor,rightDoor,rearDoor,brake,lightState;
+		float aaaAimh,aaaAimp,aaaAimb;
+		float samAimh,samAimp,samAimb;
+		float canAimh,canAimp,canAimb;
+	};
+	class TurretState
+	{
+	public:
+		float h,p;
+		unsigned int turretState;
+	};
+
+	/*! Pointers to the columns of one block. */
+	class Block
+	{
+	public:
+		YSSIZE_T nRecord;
+		const double *t,*x,*y,*z;
+		const float *h,*p,*b;
+		const FlightState *flightState;  // nullptr for a ground stream
+		const GroundState *groundState;  // nullptr for an airplane stream
+		const unsigned int *turretTop;
+		const TurretState *turret;
+	};
+
+protected:
+	class BlockLayout
+	{
+	public:
+		unsigned long long tOffset,xOffset,yOffset,zOffset;
+		unsigned long long hOffset,pOffset,bOffset;
+		unsigned long long stateOffset,turretTopOffset,turretOffset;
+		unsigned long long size;
+	};
+	static unsigned long long Align(unsigned long long offset);
+	static BlockLayout MakeBlockLayout(STREAMTYPE streamType,unsigned long long nRecord,unsigned long long nTurret);
+};
+
+
+
+class FsBinaryRecordWriter : public FsBinaryRecord
+{
+private:
+	FILE *fp;
+	unsigned long long filePtr;
+	YSBOOL writeError;
+	YsArray <StreamHeader> streamTable;
+	YsArray <unsigned char> blockBuf;
+	YsArray <TurretState> turretBuf;
+
+public:
+	FsBinaryRecordWriter();
+	~FsBinaryRecordWriter();
+
+	YSRESULT Open(const wchar_t fn[]);
+
+	/*! Writes the stream table and the header, and closes the file. */
+	YSRESULT Close(void);
+
+	/*! Writes a record and returns the stream index, which goes to BINRECOR. */
+	int AddStream(const FsRecord <FsFlightRecord> &rec);
+	int AddStream(const FsRecord <FsGroundRecord> &rec);
+
+private:
+	void Write(YSSIZE_T nByte,const void *dat);
+	template <class RecordType,class StateType>
+	int AddStream(STREAMTYPE streamType,const FsRecord <RecordType> &rec);
+	static void CopyState(FlightState &state,const FsFlightRecord &rec);
+	static void CopyState(GroundState &state,const FsGroundRecord &rec);
+};
+
+
+
+class FsBinaryRecordReader : public FsBinaryRecord
+{
+private:
+	YsFileIO::MappedFile file;
+	YSSIZE_T nStream;
+	const StreamHeader *streamTable;
+
+public:
+	FsBinaryRecordReader();
+
+	/*! Maps the file and checks the header, the stream table, and the block indices. */
+	YSRESULT Open(const wchar_t fn[]);
+	void Close(void);
+	YSBOOL IsOpen(void) const;
+
+	YSSIZE_T GetNumStream(void) const;
+	const StreamHeader *GetStream(YSSIZE_T streamIdx) const;
+	YSSIZE_T GetNumBlock(YSSIZE_T streamIdx) const;
+	const BlockHeader *GetBlockHeader(YSSIZE_T streamIdx,YSSIZE_T blockIdx) const;
+
+	/*! Returns the columns of the block.  The pointers point directly into the mapped file. */
+	Block GetBlock(YSSIZE_T streamIdx,YSSIZE_T blockIdx) const;
+
+	/*! Adds all records of the stream to the object. */
+	YSRESULT LoadStream(YSSIZE_T streamIdx,class FsAirplane &air) const;
+	YSRESULT LoadStream(YSSIZE_T streamIdx,class FsGround &gnd) const;
+};
+
+/* } */
+#endif
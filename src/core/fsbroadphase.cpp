@@ -0,0 +1,471 @@
+#include <math.h>
+#include <ysclass.h>
+
+#include "fsdef.h"
+#include "fssimulation.h"
+#include "fsbroadphase.h"
+#include "fsexistence.h"
+
+
+FsBroadPhase::FsBroadPhase()
+{
+	Initialize();
+}
+
+FsBroadPhase::~FsBroadPhase()
+{
+}
+
+void FsBroadPhase::Initialize(void)
+{
+	SetUp(YsVec2(-20000.0,-20000.0),YsVec2(20000.0,20000.0),(double)DEFAULT_CELL_SIZE,(double)DEFAULT_POSITION_SLACK);
+}
+
+void FsBroadPhase::SetUp(const YsVec2 &min,const YsVec2 &max,const double cellSize,const double positionSlack)
+{
+	this->cellSize=cellSize;
+	this->positionSlack=positionSlack;
+	domainMin=min;
+
+	for(;;)
+	{
+		nColumnX=1+(int)((max.x()-min.x())/this->cellSize);
+		nColumnZ=1+(int)((max.y()-min.y())/this->cellSize);
+		if((double)nColumnX*(double)nColumnZ<=(double)MAX_NUM_COLUMN)
+		{
+			break;
+		}
+		this->cellSize*=2.0;
+	}
+
+	column.ClearDeep();
+	column.Resize(nColumnX*nColumnZ);
+
+	Clear();
+}
+
+void FsBroadPhase::Clear(void)
+{
+	maxRadius[OBJTYPE_AIR]=0.0;
+	maxRadius[OBJTYPE_GND]=0.0;
+	for(auto &col : column)
+	{
+		col.cellIdx.Clear();
+	}
+	cell.ClearDeep();
+	large.entry[OBJTYPE_AIR].ClearDeep();
+	large.entry[OBJTYPE_GND].ClearDeep();
+	ResetLargeBbx();
+
+	stat.nColumn=column.GetN();
+	stat.nCell=0;
+	stat.nEmptyCell=0;
+	stat.nLargeObject=0;
+	stat.nMoved=0;
+}
+
+YSRESULT FsBroadPhase::Add(const FsExistence *obj)
+{
+	if(0>GetObjType(obj))
+	{
+		return YSERR;
+	}
+	AddEntry(obj,GetObjPosition(obj),GetObjRadius(obj));
+	return YSOK;
+}
+
+YSRESULT FsBroadPhase::Delete(const FsExistence *obj)
+{
+	if(NOT_IN_BROADPHASE!=obj->fsBroadPhaseCell)
+	{
+		DeleteEntry(obj);
+		return YSOK;
+	}
+	return YSERR;
+}
+
+YSRESULT FsBroadPhase::Update(const FsSimulation *sim)
+{
+	stat.nMoved=0;
+	ResetLargeBbx();
+
+	auto updateObj=[&](const FsExistence *obj)
+	{
+		const YsVec3 &pos=GetObjPosition(obj);
+		const double rad=GetObjRadius(obj);
+
+		if(0<=obj->fsBroadPhaseCell && rad<=cellSize/4.0)
+		{
+			int idx[3];
+			GetCellIndex(idx,pos);
+
+			auto &c=cell[obj->fsBroadPhaseCell];
+			if(idx[0]==c.idx[0] && idx[1]==c.idx[1] && idx[2]==c.idx[2])
+			{
+				auto &e=c.entry[GetObjType(obj)][obj->fsBroadPhaseSlot];
+				e.pos=pos;
+				e.rad=rad;
+				return;
+			}
+		}
+		else if(LARGE_OBJECT_CELL==obj->fsBroadPhaseCell && cellSize/4.0<rad)
+		{
+			auto &e=large.entry[GetObjType(obj)][obj->fsBroadPhaseSlot];
+			e.pos=pos;
+			e.rad=rad;
+			ExpandLargeBbx(GetObjType(obj),pos,rad);
+			return;
+		}
+
+		if(NOT_IN_BROADPHASE!=obj->fsBroadPhaseCell)
+		{
+			DeleteEntry(obj);
+		}
+		AddEntry(obj,pos,rad);
+		++stat.nMoved;
+	};
+
+	for(const FsAirplane *air=NULL; NULL!=(air=sim->FindNextAirplane(air)); )
+	{
+		updateObj(air);
+	}
+	for(const FsGround *gnd=NULL; NULL!=(gnd=sim->FindNextGround(gnd)); )
+	{
+		updateObj(gnd);
+	}
+
+	maxRadius[OBJTYPE_AIR]=0.0;
+	maxRadius[OBJTYPE_GND]=0.0;
+	stat.nCell=cell.GetN();
+	stat.nEmptyCell=0;
+	stat.nLargeObject=large.entry[OBJTYPE_AIR].GetN()+large.entry[OBJTYPE_GND].GetN();
+	for(auto &c : cell)
+	{
+		if(0==c.entry[OBJTYPE_AIR].GetN() && 0==c.entry[OBJTYPE_GND].GetN())
+		{
+			++stat.nEmptyCell;
+		}
+		for(int objType=0; objType<2; ++objType)
+		{
+			for(auto &e : c.entry[objType])
+			{
+				YsMakeGreater(maxRadius[objType],e.rad);
+			}
+		}
+	}
+
+	// Cells that airplanes have left are not deleted one by one, because the indices of the cells are in the objects.
+	// Instead, all cells are made again when the majority of the cells become empty.
+	if(64<stat.nEmptyCell && stat.nCell<stat.nEmptyCell*2)
+	{
+		Rebuild(sim);
+	}
+
+	return YSOK;
+}
+
+const FsBroadPhase::Statistics &FsBroadPhase::GetStatistics(void) const
+{
+	return stat;
+}
+
+void FsBroadPhase::GetCollisionCandidateOnSegments(
+    YsArray <SegmentCandidate <FsAirplane> > &airCan,YsArray <SegmentCandidate <FsGround> > &gndCan,
+    YSSIZE_T nSeg,const YsVec3 p0[],const YsVec3 p1[],const double rad) const
+{
+	airCan.Clear();
+	gndCan.Clear();
+
+	// Projectiles are short segments, and there are many more of them than the occupied cells.  The bounding box of
+	// the entries in each occupied cell is calculated once for the batch, and then each segment is tested against
+	// the boxes.  The box is padded by the same margin as EntryIsNearSegment, therefore the box test does not
+	// drop any candidate.
+	class OccupiedCell
+	{
+	public:
+		const Cell *c;
+		int objType;
+		YsVec3 min,max;
+	};
+	YsArray <OccupiedCell,64> occupied;
+
+	auto addOccupied=[&](const Cell &c)
+	{
+		for(int objType=0; objType<2; ++objType)
+		{
+			if(0<c.entry[objType].GetN())
+			{
+				occupied.Increment();
+				auto &occ=occupied.Last();
+				occ.c=&c;
+				occ.objType=objType;
+				occ.min.Set( YsInfinity, YsInfinity, YsInfinity);
+				occ.max.Set(-YsInfinity,-YsInfinity,-YsInfinity);
+				for(auto &e : c.entry[objType])
+				{
+					const double r=e.rad+positionSlack+rad;
+					for(int i=0; i<3; ++i)
+					{
+						YsMakeSmaller(occ.min[i],e.pos[i]-r);
+						YsMakeGreater(occ.max[i],e.pos[i]+r);
+					}
+				}
+			}
+		}
+	};
+	for(auto &c : cell)
+	{
+		addOccupied(c);
+	}
+	addOccupied(large);
+
+	const double slack=positionSlack;
+	for(YSSIZE_T segIdx=0; segIdx<nSeg; ++segIdx)
+	{
+		const YsVec3 &s0=p0[segIdx],&s1=p1[segIdx];
+		const double minX=YsSmaller(s0.x(),s1.x()),maxX=YsGreater(s0.x(),s1.x());
+		const double minY=YsSmaller(s0.y(),s1.y()),maxY=YsGreater(s0.y(),s1.y());
+		const double minZ=YsSmaller(s0.z(),s1.z()),maxZ=YsGreater(s0.z(),s1.z());
+		for(auto &occ : occupied)
+		{
+			if(maxX<occ.min.x() || occ.max.x()<minX ||
+			   maxY<occ.min.y() || occ.max.y()<minY ||
+			   maxZ<occ.min.z() || occ.max.z()<minZ)
+			{
+				continue;
+			}
+			for(auto &e : occ.c->entry[occ.objType])
+			{
+				if(YSTRUE==EntryIsNearSegment(e,slack,s0,s1,rad))
+				{
+					if(OBJTYPE_AIR==occ.objType)
+					{
+						airCan.Increment();
+						airCan.Last().segIdx=segIdx;
+						airCan.Last().obj=(FsAirplane *)e.obj;
+					}
+					else
+					{
+						gndCan.Increment();
+						gndCan.Last().segIdx=segIdx;
+						gndCan.Last().obj=(FsGround *)e.obj;
+					}
+				}
+			}
+		}
+	}
+}
+
+int FsBroadPhase::GetObjType(const FsExistence *obj)
+{
+	switch(obj->GetType())
+	{
+	case FSEX_AIRPLANE:
+		return OBJTYPE_AIR;
+	case FSEX_GROUND:
+		return OBJTYPE_GND;
+	default:
+		break;
+	}
+	return -1;
+}
+
+void FsBroadPhase::GetCellIndex(int idx[3],const YsVec3 &pos) const
+{
+	// Positions outside of the domain are clamped to the border columns.  The clamping is monotonic, and an object
+	// in a border column is still found by a query that covers the column.
+	idx[0]=(int)YsBound(floor((pos.x()-domainMin.x())/cellSize),0.0,(double)(nColumnX-1));
+	idx[1]=(int)YsBound(floor(pos.y()/cellSize),-1048576.0,1048576.0);
+	idx[2]=(int)YsBound(floor((pos.z()-domainMin.y())/cellSize),0.0,(double)(nColumnZ-1));
+}
+
+const FsBroadPhase::Column &FsBroadPhase::GetColumn(int ix,int iz) const
+{
+	return column[iz*nColumnX+ix];
+}
+
+FsBroadPhase::Column &FsBroadPhase::GetColumn(int ix,int iz)
+{
+	return column[iz*nColumnX+ix];
+}
+
+YSSIZE_T FsBroadPhase::FindOrCreateCell(const int idx[3])
+{
+	auto &col=GetColumn(idx[0],idx[2]);
+	for(auto cellIdx : col.cellIdx)
+	{
+		if(cell[cellIdx].idx[1]==idx[1])
+		{
+			return cellIdx;
+		}
+	}
+
+	const YSSIZE_T cellIdx=cell.GetN();
+	cell.Increment();
+	cell.Last().idx[0]=idx[0];
+	cell.Last().idx[1]=idx[1];
+	cell.Last().idx[2]=idx[2];
+	cell.Last().entry[OBJTYPE_AIR].Clear();
+	cell.Last().entry[OBJTYPE_GND].Clear();
+	col.cellIdx.Append(cellIdx);
+	return cellIdx;
+}
+
+void FsBroadPhase::AddEntry(const FsExistence *obj,const YsVec3 &pos,const double rad)
+{
+	Cell *c;
+	if(cellSize/4.0<rad)
+	{
+		c=&large;
+		obj->fsBroadPhaseCell=LARGE_OBJECT_CELL;
+		ExpandLargeBbx(GetObjType(obj),pos,rad);
+	}
+	else
+	{
+		int idx[3];
+		GetCellIndex(idx,pos);
+		obj->fsBroadPhaseCell=FindOrCreateCell(idx);
+		c=&cell[obj->fsBroadPhaseCell];
+		YsMakeGreater(maxRadius[GetObjType(obj)],rad);
+	}
+
+	auto &entry=c->entry[GetObjType(obj)];
+	obj->fsBroadPhaseSlot=entry.GetN();
+	entry.Increment();
+	entry.Last().obj=obj;
+	entry.Last().pos=pos;
+	entry.Last().rad=rad;
+}
+
+void FsBroadPhase::ResetLargeBbx(void)
+{
+	for(auto &bbx : largeBbx)
+	{
+		bbx[0].Set( YsInfinity, YsInfinity, YsInfinity);
+		bbx[1].Set(-YsInfinity,-YsInfinity,-YsInfinity);
+	}
+}
+
+void FsBroadPhase::ExpandLargeBbx(int objType,const YsVec3 &pos,const double rad)
+{
+	const double r=rad+positionSlack;
+	for(int i=0; i<3; ++i)
+	{
+		YsMakeSmaller(largeBbx[objType][0][i],pos[i]-r);
+		YsMakeGreater(largeBbx[objType][1][i],pos[i]+r);
+	}
+}
+
+void FsBroadPhase::DeleteEntry(const FsExistence *obj)
+{
+	Cell &c=(LARGE_OBJECT_CELL==obj->fsBroadPhaseCell ? large : cell[obj->fsBroadPhaseCell]);
+	auto &entry=c.entry[GetObjType(obj)];
+	const auto slot=obj->fsBroadPhaseSlot;
+	entry.DeleteBySwapping(slot);
+	if(slot<entry.GetN())
+	{
+		entry[slot].obj->fsBroadPhaseSlot=slot;
+	}
+	obj->fsBroadPhaseCell=NOT_IN_BROADPHASE;
+}
+
+void FsBroadPhase::Rebuild(const FsSimulation *sim)
+{
+	Clear();
+	for(const FsAirplane *air=NULL; NULL!=(air=sim->FindNextAirplane(air)); )
+	{
+		Add(air);
+	}
+	for(const FsGround *gnd=NULL; NULL!=(gnd=sim->FindNextGround(gnd)); )
+	{
+		Add(gnd);
+	}
+	stat.nCell=cell.GetN();
+	stat.nLargeObject=large.entry[OBJTYPE_AIR].GetN()+large.entry[OBJTYPE_GND].GetN();
+}
+
+YSBOOL FsBroadPhase::SegmentMayPassCell(const Cell &c,int objType,const YsVec3 &p0,const YsVec3 &p1,const double rad) const
+{
+	// Slab test against the cell extended by the loose margin.
+	const double ext=maxRadius[objType]+positionSlack+rad;
+	double t0=0.0,t1=1.0;
+	const double origin[3]={domainMin.x(),0.0,domainMin.y()};
+	const int nIdx[3]={nColumnX,0,nColumnZ};
+	for(int i=0; i<3; ++i)
+	{
+		if(1!=i && (0==c.idx[i] || nIdx[i]-1==c.idx[i]))
+		{
+			continue;  // Border column.  Unbounded in this axis.
+		}
+
+		const double min=origin[i]+(double)c.idx[i]*cellSize-ext;
+		const double max=origin[i]+(double)(c.idx[i]+1)*cellSize+ext;
+		const double d=p1[i]-p0[i];
+		if(YsTolerance>fabs(d))
+		{
+			if(p0[i]<min || max<p0[i])
+			{
+				return YSFALSE;
+			}
+		}
+		else
+		{
+			double s0=(min-p0[i])/d;
+			double s1=(max-p0[i])/d;
+			if(s1<s0)
+			{
+				std::swap(s0,s1);
+			}
+			YsMakeGreater(t0,s0);
+			YsMakeSmaller(t1,s1);
+			if(t1<t0)
+			{
+				return YSFALSE;
+			}
+		}
+	}
+	return YSTRUE;
+}
+
+YSBOOL FsBroadPhase::EntryIsInBox(const Entry &e,const double slack,const YsVec3 &min,const YsVec3 &max)
+{
+	const double r=e.rad+slack;
+	for(int i=0; i<3; ++i)
+	{
+		if(e.pos[i]+r<min[i] || max[i]<e.pos[i]-r)
+		{
+			return YSFALSE;
+		}
+	}
+	return YSTRUE;
+}
+
+YSBOOL FsBroadPhase::EntryIsInSphere(const Entry &e,const double slack,const YsVec3 &cen,const double rad)
+{
+	const double r=e.rad+slack+rad;
+	return ((e.pos-cen).GetSquareLength()<=r*r ? YSTRUE : YSFALSE);
+}
+
+YSBOOL FsBroadPhase::EntryIsNearSegment(const Entry &e,const double slack,const YsVec3 &p0,const YsVec3 &p1,const double rad)
+{
+	const YsVec3 d=p1-p0;
+	const double sqLen=d.GetSquareLength();
+	double t=0.0;
+	if(YsTolerance<sqLen)
+	{
+		t=YsBound(((e.pos-p0)*d)/sqLen,0.0,1.0);
+	}
+	const YsVec3 np=p0+d*t;
+	const double r=e.rad+slack+rad;
+	return ((e.pos-np).GetSquareLength()<=r*r ? YSTRUE : YSFALSE);
+}
+
+const YsVec3 &FsBroadPhase::GetObjPosition(const FsExistence *obj)
+{
+	return obj->GetPosition();
+}
+
+double FsBroadPhase::GetObjRadius(const FsExistence *obj)
+{
+	return obj->GetApproximatedCollideRadius();
+}
@@ -0,0 +1,344 @@
+#ifndef FSBROADPHASE_IS_INCLUDED
+#define FSBROADPHASE_IS_INCLUDED
+/* { */
+
+#include <ysclass.h>
+
+class FsExistence;
+class FsAirplane;
+class FsGround;
+class FsSimulation;
+
+/*! Altitude-aware broad phase for the collision check and the target search.
+
+    Every object is stored once, in the cubic cell that includes its center.  A query visits the cells within
+    the query range extended by the largest radius of the objects in the cells (loose grid), and then tests each object
+    against the query range in 3D.  Therefore a query never finds the same object twice, and the candidates do not need
+    de-duplication.  Objects larger than a cell are kept in a separate list and tested one by one.
+
+    The cells are grouped in the vertical columns on the XZ plane, and a query looks up the columns in the range,
+    and then checks the altitude of the few cells in each column.  The columns cover the domain given to SetUp, and
+    an object outside of the domain goes to the column at the border.  The altitude is not bounded.
+
+    Positions are taken in Add and Update.  Objects move after Update, and every object is padded by positionSlack
+    so that the candidates stay conservative until the next Update.
+*/
+class FsBroadPhase
+{
+public:
+	enum
+	{
+		DEFAULT_CELL_SIZE=1000,
+		DEFAULT_POSITION_SLACK=100,
+		MAX_NUM_COLUMN=1024*1024
+	};
+	enum
+	{
+		LARGE_OBJECT_CELL=-1,    // FsExistence::fsBroadPhaseCell of an object larger than the cell
+		NOT_IN_BROADPHASE=-2
+	};
+
+	class Entry
+	{
+	public:
+		const FsExistence *obj;
+		YsVec3 pos;
+		double rad;
+	};
+
+	class Cell
+	{
+	public:
+		int idx[3];
+		YsArray <Entry,4> entry[2];  // [OBJTYPE_AIR] and [OBJTYPE_GND]
+	};
+
+	class Column
+	{
+	public:
+		YsArray <YSSIZE_T,4> cellIdx;
+	};
+
+	/*! Numbers from the last Update. */
+	class Statistics
+	{
+	public:
+		YSSIZE_T nColumn,nCell,nEmptyCell,nLargeObject;
+		YSSIZE_T nMoved;
+	};
+
+protected:
+	enum
+	{
+		OBJTYPE_AIR=0,
+		OBJTYPE_GND=1
+	};
+
+	double cellSize;
+	double positionSlack;
+	YsVec2 domainMin;
+	int nColumnX,nColumnZ;
+	double maxRadius[2];  // Largest radius of the airplanes and the ground objects in the cells.  May be larger than actual between Updates.
+	YsArray <Cell> cell;
+	YsArray <Column> column;
+	Cell large;
+	YsVec3 largeBbx[2][2];  // Bounding box of the large objects, padded by positionSlack.  [objType][min/max]
+	Statistics stat;
+
+public:
+	FsBroadPhase();
+	~FsBroadPhase();
+
+	/*! Removes all objects, and sets up the default domain of 40km by 40km. */
+	void Initialize(void);
+
+	/*! Removes all objects, and sets up columns that cover the domain in the XZ plane.
+	    The cell size is increased if the domain needs more than MAX_NUM_COLUMN columns. */
+	void SetUp(const YsVec2 &min,const YsVec2 &max,const double cellSize,const double positionSlack);
+
+	YSRESULT Add(const FsExistence *obj);
+	YSRESULT Delete(const FsExistence *obj);
+
+	/*! Takes the current positions of the objects, and moves the objects that went into other cells. */
+	YSRESULT Update(const FsSimulation *sim);
+
+	const Statistics &GetStatistics(void) const;
+
+	/*! Objects that may overlap with the object. */
+	template <const int N>
+	inline YSRESULT GetAirCollisionCandidate(YsArray <FsAirplane *,N> &airCan,const FsExistence *from) const;
+	template <const int N>
+	inline YSRESULT GetGndCollisionCandidate(YsArray <FsGround *,N> &gndCan,const FsExistence *from) const;
+
+	/*! Objects that may be within rad from cen. */
+	template <const int N>
+	inline YSRESULT GetAirCollisionCandidate(YsArray <FsAirplane *,N> &airCan,const YsVec3 &cen,const double rad) const;
+	template <const int N>
+	inline YSRESULT GetGndCollisionCandidate(YsArray <FsGround *,N> &gndCan,const YsVec3 &cen,const double rad) const;
+
+	/*! Objects that may overlap with the axis-aligned box. */
+	template <const int N>
+	inline YSRESULT GetAirCollisionCandidateInBox(YsArray <FsAirplane *,N> &airCan,const YsVec3 &min,const YsVec3 &max) const;
+	template <const int N>
+	inline YSRESULT GetGndCollisionCandidateInBox(YsArray <FsGround *,N> &gndCan,const YsVec3 &min,const YsVec3 &max) const;
+
+	/*! Objects that may be within rad from the line segment p0-p1.  For the projectiles.
+	    If the segment is longer than a cell, cells that the segment does not pass are skipped, and a long segment
+	    does not collect the objects in the bounding box of the segment. */
+	template <const int N>
+	inline YSRESULT GetAirCollisionCandidateOnSegment(YsArray <FsAirplane *,N> &airCan,const YsVec3 &p0,const YsVec3 &p1,const double rad) const;
+	template <const int N>
+	inline YSRESULT GetGndCollisionCandidateOnSegment(YsArray <FsGround *,N> &gndCan,const YsVec3 &p0,const YsVec3 &p1,const double rad) const;
+
+	/*! Batch version of GetAirCollisionCandidateOnSegment and GetGndCollisionCandidateOnSegment for many projectiles.
+	    The candidates of the segment p0[i]-p1[i] are appended to airCan and gndCan with segIdx=i, and both arrays are
+	    sorted by segIdx.  The occupied cells are listed once for the batch, therefore it is faster than calling the
+	    single-segment version for each segment when there are many more segments than the occupied cells. */
+	template <class ObjType>
+	class SegmentCandidate
+	{
+	public:
+		YSSIZE_T segIdx;
+		ObjType *obj;
+	};
+	void GetCollisionCandidateOnSegments(
+	    YsArray <SegmentCandidate <FsAirplane> > &airCan,YsArray <SegmentCandidate <FsGround> > &gndCan,
+	    YSSIZE_T nSeg,const YsVec3 p0[],const YsVec3 p1[],const double rad) const;
+
+	/*! Same as GetAirCollisionCandidate(airCan,cen,rad).  For the area of interest of the network server. */
+	template <const int N>
+	inline YSRESULT GetAirCandidateWithinRadius(YsArray <FsAirplane *,N> &airCan,const YsVec3 &cen,const double rad) const;
+
+protected:
+	static int GetObjType(const FsExistence *obj);
+	void Clear(void);
+	void GetCellIndex(int idx[3],const YsVec3 &pos) const;
+	const Column &GetColumn(int ix,int iz) const;
+	Column &GetColumn(int ix,int iz);
+	YSSIZE_T FindOrCreateCell(const int idx[3]);
+	void AddEntry(const FsExistence *obj,const YsVec3 &pos,const double rad);
+	void ResetLargeBbx(void);
+	void ExpandLargeBbx(int objType,const YsVec3 &pos,const double rad);
+	void DeleteEntry(const FsExistence *obj);
+	void Rebuild(const FsSimulation *sim);
+
+	YSBOOL SegmentMayPassCell(const Cell &c,int objType,const YsVec3 &p0,const YsVec3 &p1,const double rad) const;
+
+	static YSBOOL EntryIsInBox(const Entry &e,const double slack,const YsVec3 &min,const YsVec3 &max);
+	static YSBOOL EntryIsInSphere(const Entry &e,const double slack,const YsVec3 &cen,const double rad);
+	static YSBOOL EntryIsNearSegment(const Entry &e,const double slack,const YsVec3 &p0,const YsVec3 &p1,const double rad);
+
+	/*! Collects the objects of objType that pass entryTest from the cells that may overlap with the box and pass cellTest,
+	    and from the large objects. */
+	template <class ObjType,const int N,class CellTest,class EntryTest>
+	void Collect(YsArray <ObjType *,N> &can,int objType,const YsVec3 &min,const YsVec3 &max,CellTest cellTest,EntryTest entryTest) const;
+
+	template <class ObjType,const int N>
+	void CollectInSphere(YsArray <ObjType *,N> &can,int objType,const YsVec3 &cen,const double rad) const;
+	template <class ObjType,const int N>
+	void CollectInBox(YsArray <ObjType *,N> &can,int objType,const YsVec3 &min,const YsVec3 &max) const;
+	template <class ObjType,const int N>
+	void CollectOnSegment(YsArray <ObjType *,N> &can,int objType,const YsVec3 &p0,const YsVec3 &p1,const double rad) const;
+
+	static const YsVec3 &GetObjPosition(const FsExistence *obj);
+	static double GetObjRadius(const FsExistence *obj);
+};
+
+
+template <class ObjType,const int N,class CellTest,class EntryTest>
+void FsBroadPhase::Collect(YsArray <ObjType *,N> &can,int objType,const YsVec3 &min,const YsVec3 &max,CellTest cellTest,EntryTest entryTest) const
+{
+	can.Clear();
+
+	auto collectFromCell=[&](const Cell &c)
+	{
+		for(auto &e : c.entry[objType])
+		{
+			if(YSTRUE==entryTest(e))
+			{
+				can.Append((ObjType *)e.obj);
+			}
+		}
+	};
+
+	const double ext=maxRadius[objType]+positionSlack;
+	const YsVec3 extVec(ext,ext,ext);
+
+	int idx0[3],idx1[3];
+	GetCellIndex(idx0,min-extVec);
+	GetCellIndex(idx1,max+extVec);
+	for(int ix=idx0[0]; ix<=idx1[0]; ++ix)
+	{
+		for(int iz=idx0[2]; iz<=idx1[2]; ++iz)
+		{
+			for(auto cellIdx : GetColumn(ix,iz).cellIdx)
+			{
+				const Cell &c=cell[cellIdx];
+				if(idx0[1]<=c.idx[1] && c.idx[1]<=idx1[1] && YSTRUE==cellTest(c))
+				{
+					collectFromCell(c);
+				}
+			}
+		}
+	}
+
+	if(largeBbx[objType][0].x()<=max.x() && min.x()<=largeBbx[objType][1].x() &&
+	   largeBbx[objType][0].y()<=max.y() && min.y()<=largeBbx[objType][1].y() &&
+	   largeBbx[objType][0].z()<=max.z() && min.z()<=largeBbx[objType][1].z())
+	{
+		collectFromCell(large);
+	}
+}
+
+template <class ObjType,const int N>
+void FsBroadPhase::CollectInSphere(YsArray <ObjType *,N> &can,int objType,const YsVec3 &cen,const double rad) const
+{
+	const YsVec3 radVec(rad,rad,rad);
+	const double slack=positionSlack;
+	Collect(can,objType,cen-radVec,cen+radVec,
+	    [](const Cell &) {return YSTRUE;},
+	    [&](const Entry &e) {return EntryIsInSphere(e,slack,cen,rad);});
+}
+
+template <class ObjType,const int N>
+void FsBroadPhase::CollectInBox(YsArray <ObjType *,N> &can,int objType,const YsVec3 &min,const YsVec3 &max) const
+{
+	const double slack=positionSlack;
+	Collect(can,objType,min,max,
+	    [](const Cell &) {return YSTRUE;},
+	    [&](const Entry &e) {return EntryIsInBox(e,slack,min,max);});
+}
+
+template <class ObjType,const int N>
+void FsBroadPhase::CollectOnSegment(YsArray <ObjType *,N> &can,int objType,const YsVec3 &p0,const YsVec3 &p1,const double rad) const
+{
+	YsVec3 min=p0,max=p0;
+	for(int i=0; i<3; ++i)
+	{
+		YsMakeSmaller(min[i],p1[i]);
+		YsMakeGreater(max[i],p1[i]);
+		min[i]-=rad;
+		max[i]+=rad;
+	}
+
+	const double slack=positionSlack;
+	if((p1-p0).GetSquareLength()<cellSize*cellSize)
+	{
+		// A segment shorter than the cell passes most of the few cells in its bounding box.  The slab test does not pay.
+		Collect(can,objType,min,max,
+		    [](const Cell &) {return YSTRUE;},
+		    [&](const Entry &e) {return EntryIsNearSegment(e,slack,p0,p1,rad);});
+	}
+	else
+	{
+		Collect(can,objType,min,max,
+		    [&](const Cell &c) {return SegmentMayPassCell(c,objType,p0,p1,rad);},
+		    [&](const Entry &e) {return EntryIsNearSegment(e,slack,p0,p1,rad);});
+	}
+}
+
+template <const int N>
+YSRESULT FsBroadPhase::GetAirCollisionCandidate(YsArray <FsAirplane *,N> &airCan,const FsExistence *from) const
+{
+	CollectInSphere(airCan,OBJTYPE_AIR,GetObjPosition(from),GetObjRadius(from));
+	return YSOK;
+}
+
+template <const int N>
+YSRESULT FsBroadPhase::GetGndCollisionCandidate(YsArray <FsGround *,N> &gndCan,const FsExistence *from) const
+{
+	CollectInSphere(gndCan,OBJTYPE_GND,GetObjPosition(from),GetObjRadius(from));
+	return YSOK;
+}
+
+template <const int N>
+YSRESULT FsBroadPhase::GetAirCollisionCandidate(YsArray <FsAirplane *,N> &airCan,const YsVec3 &cen,const double rad) const
+{
+	CollectInSphere(airCan,OBJTYPE_AIR,cen,rad);
+	return YSOK;
+}
+
+template <const int N>
+YSRESULT FsBroadPhase::GetGndCollisionCandidate(YsArray <FsGround *,N> &gndCan,const YsVec3 &cen,const double rad) const
+{
+	CollectInSphere(gndCan,OBJTYPE_GND,cen,rad);
+	return YSOK;
+}
+
+template <const int N>
+YSRESULT FsBroadPhase::GetAirCollisionCandidateInBox(YsArray <FsAirplane *,N> &airCan,const YsVec3 &min,const YsVec3 &max) const
+{
+	CollectInBox(airCan,OBJTYPE_AIR,min,max);
+	return YSOK;
+}
+
+template <const int N>
+YSRESULT FsBroadPhase::GetGndCollisionCandidateInBox(YsArray <FsGround *,N> &gndCan,const YsVec3 &min,const YsVec3 &max) const
+{
+	CollectInBox(gndCan,OBJTYPE_GND,min,max);
+	return YSOK;
+}
+
+template <const int N>
+YSRESULT FsBroadPhase::GetAirCollisionCandidateOnSegment(YsArray <FsAirplane *,N> &airCan,const YsVec3 &p0,const YsVec3 &p1,const double rad) const
+{
+	CollectOnSegment(airCan,OBJTYPE_AIR,p0,p1,rad);
+	return YSOK;
+}
+
+template <const int N>
+YSRESULT FsBroadPhase::GetGndCollisionCandidateOnSegment(YsArray <FsGround *,N> &gndCan,const YsVec3 &p0,const YsVec3 &p1,const double rad) const
+{
+	CollectOnSegment(gndCan,OBJTYPE_GND,p0,p1,rad);
+	return YSOK;
+}
+
+template <const int N>
+YSRESULT FsBroadPhase::GetAirCandidateWithinRadius(YsArray <FsAirplane *,N> &airCan,const YsVec3 &cen,const double rad) const
+{
+	CollectInSphere(airCan,OBJTYPE_AIR,cen,rad);
+	return YSOK;
+}
+
+/* } */
+#endif
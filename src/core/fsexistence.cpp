@@ -276,6 +276,7 @@ void FsExistence::Initialize(void)
 
 	collSrc.CleanUp();  // <- 2003/12/11 Why was I not doing it?
 	collSrc.SetMatrix(YsIdentity4x4());  // 2003/12/19 Preventive
+	collTree=nullptr;
 
 	collBbx[0]=YsOrigin();
 	collBbx[1]=YsOrigin();
@@ -315,6 +316,9 @@ void FsExistence::Initialize(void)
 
 	fsLtcCache[0].Set(-1,-1);
 	fsLtcCache[1].Set(-1,-1);
+	fsBroadPhaseCell=FsBroadPhase::NOT_IN_BROADPHASE;
+	fsBroadPhaseSlot=0;
+	fsAiControlSnapshotIdx=-1;
 
 	bouncedLastTime=YSFALSE;
 }
@@ -363,6 +367,11 @@ const YsVec3 &FsExistence::GetCollisionShellCenter(void) const
 	return collCen;
 }
 
+const YsShellBoundingBoxTree *FsExistence::GetCollisionShellBoundingBoxTree(void) const
+{
+	return collTree.get();
+}
+
 void FsExistence::SetCollisionShell(const FsVisualSrf &src)
 {
 	coll.SetMatrix(YsIdentity4x4());  // Preventive
@@ -373,6 +382,8 @@ void FsExistence::SetCollisionShell(const FsVisualSrf &src)
 	collSrc=src;
 	collSrc.Encache();
 
+	collTree=src.GetBoundingBoxTree();
+
 	src.GetBoundingBox(collBbx[0],collBbx[1]);
 	collCen=(collBbx[0]+collBbx[1])/2.0;
 	collRadius=(collBbx[1]-collBbx[0]).GetLength()/2.0;
@@ -389,6 +400,7 @@ void FsExistence::ClearCollisionShell(void)
 	coll.CleanUp();
 	collSrc.SetMatrix(YsIdentity4x4());
 	coll.CleanUp();
+	collTree=nullptr;
 }
 
 YSBOOL FsExistence::MayCollideWith(const FsExistence &test,const double clearance) const
@@ -717,6 +729,7 @@ void FsAirplane::CopyFrom(const FsAirplane &from)
 	// instPanel;
 	// curAutoPilotIdx;
 	// autoPilotList;
+	// smokeTrailCache;
 	// Must not be copied <<
 
 	// Doesn't matter >>
@@ -773,6 +786,7 @@ void FsAirplane::CleanUp(void)
 		delete rec;
 		rec=NULL;
 	}
+	smokeTrailCache.CleanUp();
 
 	ClearAutopilot();
 
@@ -787,6 +801,33 @@ void FsAirplane::CleanUp(void)
 	FsExistence::CleanUp();
 }
 
+YSSIZE_T FsAirplane::CatchTrailRecordIndex(double &t,double currentTime,double t0) const
+{
+	// Same as stepping t back from currentTime by 0.05 until the record covers t.  While the airplane is flying,
+	// currentTime is usually after the last record, and the steps up to the last record are skipped at once.
+	// If t is before the first record, stepping back more does not find it either.
+	YSSIZE_T idx=-1;
+	t=currentTime;
+
+	double topT,lastT;
+	if(nullptr!=rec && nullptr!=rec->GetTopElement(topT) && nullptr!=rec->GetLastElement(lastT))
+	{
+		if(1<rec->GetNumRecord() && lastT<=t)
+		{
+			t-=0.05*(floor((t-lastT)/0.05)+1.0);
+		}
+		while(t>t0 && topT<=t)
+		{
+			if(rec->GetIndexByTime(idx,t)==YSOK)
+			{
+				break;
+			}
+			t-=0.05;
+		}
+	}
+	return idx;
+}
+
 void FsAirplane::MakeVaporVertexArray(class YsGLVertexBuffer &vtxBuf,class YsGLColorBuffer &colBuf,double currentTime,double remainTime,int step) const
 {
 	vtxBuf.CleanUp();
@@ -800,15 +841,7 @@ void FsAirplane::MakeVaporVertexArray(class YsGLVertexBuffer &vtxBuf,class YsGLC
 		// Catch the index
 		t0=YsGreater(currentTime-remainTime,0.0);
 		t1=currentTime;
-		t=currentTime;
-		while(t>t0)
-		{
-			if(rec->GetIndexByTime(idx,t)==YSOK)
-			{
-				break;
-			}
-			t-=0.05;
-		}
+		idx=CatchTrailRecordIndex(t,currentTime,t0);
 
 		idx++; // Trick
 
@@ -965,18 +998,15 @@ void FsAirplane::AddSingleSmokeVertexArray(
 
 		// Catch the index
 		double t0=YsGreater(currentTime-remainTime,0.0);
-		double t=currentTime;
-		while(t>t0)
-		{
-			if(rec->GetIndexByTime(idx,t)==YSOK)
-			{
-				break;
-			}
-			t-=0.05;
-		}
+		double t;
+		idx=CatchTrailRecordIndex(t,currentTime,t0);
 
 		idx++; // Trick
 
+		// The segments that do not change any more are taken from the smoke-trail cache.
+		const FsSmokeTrailCache *cache=UpdateSmokeTrailCache(smkId,idx,currentTime,t0,smk,step);
+		const YSSIZE_T cacheTop=(nullptr!=cache && YSTRUE!=cache->IsEmpty() ? cache->Newest().recIdx1 : -1);
+
 		// Draw smoke
 		FsFlightRecord *r0,*r1;
 		FsFlightRecord fakeRecord;
@@ -1070,29 +1100,7 @@ void FsAirplane::AddSingleSmokeVertexArray(
 					}
 					alpha0=0.8-0.8*(currentTime-tm0)/remainTime;
 					alpha1=0.8-0.8*(currentTime-tm1)/remainTime;
-					switch(smk)
-					{
-					default:
-						break;
-					case FSSMKNOODLE:
-					case FSSMKTOWEL:
-						AddTowelSmoke(vtxBuf,nomBuf,colBuf,smkId,smkp0,smka0,ra0,smkp1,smka1,ra1,alpha0,alpha1);
-						break;
-					case FSSMKSOLID:
-						if((r0->smoke&(1<<smkId))!=0 && (r1->smoke&(1<<smkId))!=0)
-						{
-							AddSolidSmoke(vtxBuf,nomBuf,colBuf,smkId,smkp0,smka0,ra0,smkp1,smka1,ra1,alpha0,alpha1);
-						}
-						else if((r0->smoke&(1<<smkId))!=0)
-						{
-							AddSolidSmokeLid(vtxBuf,nomBuf,colBuf,smkId,smkp0,smka0,ra0,alpha0);
-						}
-						else if((r1->smoke&(1<<smkId))!=0)
-						{
-							AddSolidSmokeLid(vtxBuf,nomBuf,colBuf,smkId,smkp1,smka1,ra1,alpha1);
-						}
-						break;
-					}
+					AddSmokeSegment(vtxBuf,nomBuf,colBuf,smkId,smk,*r0,*r1,smkp0,smka0,ra0,smkp1,smka1,ra1,alpha0,alpha1);
 					drewPrevious=YSTRUE;
 				}
 				else
@@ -1114,11 +1122,161 @@ void FsAirplane::AddSingleSmokeVertexArray(
 						d=step;
 					}
 				}
+
+				if(idx<cacheTop)
+				{
+					break;
+				}
 			}
+
+			if(nullptr!=cache)
+			{
+				cache->AddToBuffer(vtxBuf,nomBuf,colBuf,smkCol,currentTime,remainTime);
+			}
+		}
+	}
+}
+
+void FsAirplane::AddSmokeSegment(
+    class YsGLVertexBuffer &vtxBuf,class YsGLNormalBuffer &nomBuf,class YsGLColorBuffer &colBuf,
+    int smkId,FSSMOKETYPE smk,const FsFlightRecord &r0,const FsFlightRecord &r1,
+    YsVec3 &smkp0,YsAtt3 &smka0,const double &ra0,
+    YsVec3 &smkp1,YsAtt3 &smka1,const double &ra1,
+    const double &alpha0,const double &alpha1) const
+{
+	switch(smk)
+	{
+	default:
+		break;
+	case FSSMKNOODLE:
+	case FSSMKTOWEL:
+		AddTowelSmoke(vtxBuf,nomBuf,colBuf,smkId,smkp0,smka0,ra0,smkp1,smka1,ra1,alpha0,alpha1);
+		break;
+	case FSSMKSOLID:
+		if((r0.smoke&(1<<smkId))!=0 && (r1.smoke&(1<<smkId))!=0)
+		{
+			AddSolidSmoke(vtxBuf,nomBuf,colBuf,smkId,smkp0,smka0,ra0,smkp1,smka1,ra1,alpha0,alpha1);
+		}
+		else if((r0.smoke&(1<<smkId))!=0)
+		{
+			AddSolidSmokeLid(vtxBuf,nomBuf,colBuf,smkId,smkp0,smka0,ra0,alpha0);
 		}
+		else if((r1.smoke&(1<<smkId))!=0)
+		{
+			AddSolidSmokeLid(vtxBuf,nomBuf,colBuf,smkId,smkp1,smka1,ra1,alpha1);
+		}
+		break;
 	}
 }
 
+const FsSmokeTrailCache *FsAirplane::UpdateSmokeTrailCache(int smkId,YSSIZE_T lastIdx,double currentTime,double t0,FSSMOKETYPE smk,int step) const
+{
+	if(smokeTrailCache.GetN()<=smkId)
+	{
+		smokeTrailCache.Resize(smkId+1);
+	}
+	auto &cache=smokeTrailCache[smkId];
+
+	// The replay does not use the cache, since the time can jump back and forth.
+	if(YSTRUE==isPlayingRecord || nullptr==rec || step<1 || lastIdx<=0)
+	{
+		cache.CleanUp();
+		return nullptr;
+	}
+
+	YsVec3 smkGen;
+	prop.GetSmokeGeneratorPosition(smkGen,smkId);
+
+	// AddSingleSmokeVertexArray samples every record from the last record lastIdx down to stepBoundary, and then
+	// every step records.  The cached segments are between the multiples of step below stepBoundary.
+	const YSSIZE_T stepBoundary=((lastIdx-1)/step)*step-(2*step-1)*step;
+
+	YSBOOL valid=YSTRUE;
+	if(cache.smk!=smk || cache.step!=step || cache.smkGen!=smkGen || currentTime<cache.lastTime)
+	{
+		valid=YSFALSE;
+	}
+	else if(YSTRUE!=cache.IsEmpty())
+	{
+		// Records may have been deleted or ripped off, which shifts the indices.
+		double tm;
+		if(stepBoundary<cache.Newest().recIdx1 ||
+		   nullptr==rec->GetElement(tm,cache.Oldest().recIdx0) || tm!=cache.Oldest().tm0 ||
+		   nullptr==rec->GetElement(tm,cache.Newest().recIdx1) || tm!=cache.Newest().tm1)
+		{
+			valid=YSFALSE;
+		}
+	}
+	if(YSTRUE!=valid)
+	{
+		cache.CleanUp();
+		cache.smk=smk;
+		cache.step=step;
+		cache.smkGen=smkGen;
+	}
+	cache.lastTime=currentTime;
+
+	cache.Expire(t0);
+
+	// A segment can be cached when the smoke radius of the newer end stops growing, which takes one second.
+	YSSIZE_T newestIdx=stepBoundary;
+	double tmNewest;
+	while(step<newestIdx && (nullptr==rec->GetElement(tmNewest,newestIdx) || currentTime-tmNewest<1.0))
+	{
+		newestIdx-=step;
+	}
+
+	YSSIZE_T idx0;
+	if(YSTRUE!=cache.IsEmpty())
+	{
+		idx0=cache.Newest().recIdx1;
+	}
+	else
+	{
+		// Start from the oldest segment whose newer end is after t0.  Record 0 is never the older end.
+		YSSIZE_T idxT0,firstIdx1=0;
+		if(YSOK==rec->GetIndexByTime(idxT0,t0))
+		{
+			firstIdx1=idxT0+1;
+		}
+		idx0=YsGreater <YSSIZE_T> (step,(0<firstIdx1 ? ((firstIdx1-1)/step)*step : 0));
+	}
+
+	YsGLVertexBuffer segVtxBuf;
+	YsGLNormalBuffer segNomBuf;
+	YsGLColorBuffer segColBuf;
+	for(; idx0+step<=newestIdx; idx0+=step)
+	{
+		double tm0,tm1;
+		const FsFlightRecord *r0=rec->GetElement(tm0,idx0);
+		const FsFlightRecord *r1=rec->GetElement(tm1,idx0+step);
+
+		segVtxBuf.CleanUp();
+		segNomBuf.CleanUp();
+		segColBuf.CleanUp();
+		if(r0!=NULL && r1!=NULL && ((r0->smoke&(1<<smkId))!=0 || (r1->smoke&(1<<smkId))!=0))
+		{
+			YsVec3 smkp0,smkp1;
+			YsAtt3 smka0,smka1;
+
+			smka0.Set(r0->h,r0->p,r0->b);
+			smka0.Mul(smkp0,smkGen);
+			smkp0=smkp0+r0->pos;
+
+			smka1.Set(r1->h,r1->p,r1->b);
+			smka1.Mul(smkp1,smkGen);
+			smkp1=smkp1+r1->pos;
+
+			// Alpha 0 and 1 mark the older and the newer ends.  See FsSmokeTrailCache.
+			AddSmokeSegment(segVtxBuf,segNomBuf,segColBuf,smkId,smk,*r0,*r1,smkp0,smka0,5.0,smkp1,smka1,5.0,0.0,1.0);
+		}
+		cache.Add(idx0,tm0,idx0+step,tm1,segVtxBuf,segNomBuf,segColBuf);
+	}
+
+	return &cache;
+}
+
+
 void FsAirplane::AddSmokeRect(
     class YsGLVertexBuffer &vtxBuf,class YsGLNormalBuffer &nomBuf,class YsGLColorBuffer &colBuf,
     int smkIdx,
@@ -1393,15 +1551,8 @@ void FsAirplane::AddSingleSmokeToParticleManager(class YsGLParticleManager &part
 
 		// Catch the index
 		double t0=YsGreater(currentTime-remainTime,0.0);
-		double t=currentTime;
-		while(t>t0)
-		{
-			if(rec->GetIndexByTime(idx,t)==YSOK)
-			{
-				break;
-			}
-			t-=0.05;
-		}
+		double t;
+		idx=CatchTrailRecordIndex(t,currentTime,t0);
 
 		idx++; // Trick
 
@@ -1548,8 +1699,9 @@ YSRESULT FsAirplane::Record(const double &t,YSBOOL forceRecord)
 	if(rec!=NULL)
 	{
 		FsFlightRecord dat;
-		prop.WriteFlightRecord(dat);
-		return Record(t,dat,forceRecord);
+		YsArray <FsTurretRecord,16> turret;
+		prop.WriteFlightRecord(dat,turret);
+		return Record(t,dat,turret,forceRecord);
 	}
 	else
 	{
@@ -1557,7 +1709,7 @@ YSRESULT FsAirplane::Record(const double &t,YSBOOL forceRecord)
 	}
 }
 
-YSRESULT FsAirplane::Record(const double &t,FsFlightRecord &dat,YSBOOL forceRecord)
+YSRESULT FsAirplane::Record(const double &t,const FsFlightRecord &dat,const YsConstArrayMask <FsTurretRecord> &turret,YSBOOL forceRecord)
 {
 	if(rec==NULL)
 	{
@@ -1575,7 +1727,7 @@ YSRESULT FsAirplane::Record(const double &t,FsFlightRecord &dat,YSBOOL forceReco
 		}
 		else if(last==NULL || tLast<t)
 		{
-			return rec->AddElement(dat,t);
+			return rec->AddElement(dat,t,turret);
 		}
 	}
 	return YSERR;
@@ -1689,19 +1841,19 @@ YSRESULT FsAirplane::PlayRecord(const double &ct,const double &dt)
 		r.p=(float)a.p();
 		r.b=(float)a.b();
 
-		prop.ReadbackFlightRecord(r,dt,velocity,vRot,force,unitVelVec);
+		prop.ReadbackFlightRecord(r,rec->GetTurret(idx),dt,velocity,vRot,force,unitVelVec);
 
 		return YSOK;
 	}
 	else if(r0!=NULL)
 	{
 		prop.ReadbackFlightRecord
-		    (*r0,dt,0.0,YsAtt3(0.0,0.0,0.0),YsVec3(0.0,0.0,0.0),YsOrigin());
+		    (*r0,rec->GetTurret(idx),dt,0.0,YsAtt3(0.0,0.0,0.0),YsVec3(0.0,0.0,0.0),YsOrigin());
 	}
 	else if(r1!=NULL)
 	{
 		prop.ReadbackFlightRecord
-		    (*r1,dt,0.0,YsAtt3(0.0,0.0,0.0),YsVec3(0.0,0.0,0.0),YsOrigin());
+		    (*r1,rec->GetTurret(idx+1),dt,0.0,YsAtt3(0.0,0.0,0.0),YsVec3(0.0,0.0,0.0),YsOrigin());
 	}
 	else // if(r0==NULL && r1==NULL)
 	{
@@ -1722,7 +1874,7 @@ YSRESULT FsAirplane::PlayRecord(const double &ct,const double &dt)
 				else if(t0<ct)
 				{
 					prop.ReadbackFlightRecord
-					    (*r0,dt,0.0,YsAtt3(0.0,0.0,0.0),YsVec3(0.0,0.0,0.0),YsOrigin());
+					    (*r0,rec->GetTurret(rec->GetNumRecord()-1),dt,0.0,YsAtt3(0.0,0.0,0.0),YsVec3(0.0,0.0,0.0),YsOrigin());
 				}
 			}
 		}
@@ -1859,17 +2011,38 @@ YSBOOL FsAirplane::LockOn(FsSimulation *sim,const double &radarAltLimit)
 	agmAngle=prop.GetAGMRadarAngle();
 
 
+	const FsSensorIndex &sensor=sim->GetSensorIndex();
+
 	// Air Target
 	if(prop.GuidedAAMIsLoaded()==YSTRUE)
 	{
 		FsAirplane *airTarget;
-		FsAirplane *air;
 
 		radar=YsPi/2.0;
 		airTarget=NULL;
 
-		air=NULL;
-		while((air=sim->FindNextAirplane(air))!=NULL)
+		YsArray <FsAirplane *,64> airCan;
+		if(YSTRUE==sensor.IsValid())
+		{
+			FsSensorIndex::AirFilter filter;
+			filter.excludeIff=this->iff;
+			filter.aliveOnly=YSTRUE;
+			filter.useRadarAltLimit=YSTRUE;
+			filter.radarAltLimit=radarAltLimit;
+			filter.scaleRangeByRcs=YSTRUE;
+			// The range of the AAM does not depend on the airplane.
+			const double aamRange=prop.GetAAMRange(prop.GetWeaponOfChoice()==FSWEAPON_AIM120 ? FSWEAPON_AIM120 : FSWEAPON_AIM9);
+			sensor.GetAirInCone(airCan,*pos,att->GetForwardVector(),YsSmaller(aamAngle,radar),aamRange,filter);
+		}
+		else
+		{
+			for(FsAirplane *air=NULL; NULL!=(air=sim->FindNextAirplane(air)); )
+			{
+				airCan.Append(air);
+			}
+		}
+
+		for(auto air : airCan)
 		{
 			if(air->prop.IsAlive()==YSTRUE && air->iff!=this->iff)
 			{
@@ -1916,14 +2089,29 @@ YSBOOL FsAirplane::LockOn(FsSimulation *sim,const double &radarAltLimit)
 	// Ground Target
 	if(prop.GuidedAGMIsLoaded()>0)
 	{
-		FsGround *gnd;
 		FsGround *gndTarget;
 		gndTarget=NULL;
 
 		radar=YsPi/2.0;
 
-		gnd=NULL;
-		while((gnd=sim->FindNextGround(gnd))!=NULL)
+		YsArray <FsGround *,64> gndCan;
+		if(YSTRUE==sensor.IsValid())
+		{
+			FsSensorIndex::GndFilter filter;
+			filter.excludeIff=this->iff;
+			filter.aliveOnly=YSTRUE;
+			filter.skipNonGameObject=YSTRUE;
+			sensor.GetGndInCone(gndCan,*pos,att->GetForwardVector(),YsSmaller(agmAngle,radar),-1.0,filter);
+		}
+		else
+		{
+			for(FsGround *gnd=NULL; NULL!=(gnd=sim->FindNextGround(gnd)); )
+			{
+				gndCan.Append(gnd);
+			}
+		}
+
+		for(auto gnd : gndCan)
 		{
 			if(gnd->Prop().IsAlive()==YSTRUE && gnd->iff!=this->iff && gnd->Prop().IsNonGameObject()!=YSTRUE)
 			{
@@ -2698,8 +2886,9 @@ YSRESULT FsGround::Record(const double &t,YSBOOL forceRecord)
 	if(rec!=NULL)
 	{
 		FsGroundRecord dat;
-		prop.WriteRecord(dat);
-		return Record(t,dat,forceRecord);
+		YsArray <FsTurretRecord,16> turret;
+		prop.WriteRecord(dat,turret);
+		return Record(t,dat,turret,forceRecord);
 	}
 	else
 	{
@@ -2707,7 +2896,7 @@ YSRESULT FsGround::Record(const double &t,YSBOOL forceRecord)
 	}
 }
 
-YSRESULT FsGround::Record(const double &t,FsGroundRecord &dat,YSBOOL forceRecord)
+YSRESULT FsGround::Record(const double &t,const FsGroundRecord &dat,const YsConstArrayMask <FsTurretRecord> &turret,YSBOOL forceRecord)
 {
 	if(rec==NULL)
 	{
@@ -2725,7 +2914,7 @@ YSRESULT FsGround::Record(const double &t,FsGroundRecord &dat,YSBOOL forceRecord
 		}
 		else if(last==NULL || tLast<t)
 		{
-			return rec->AddElement(dat,t);
+			return rec->AddElement(dat,t,turret);
 		}
 	}
 	return YSERR;
@@ -2789,17 +2978,17 @@ YSRESULT FsGround::PlayRecord(const double &ct,const double &dt)
 		r.h=(float)a.h();
 		r.p=(float)a.p();
 		r.b=(float)a.b();
-		prop.ReadbackRecord(r,dt,velocity);
+		prop.ReadbackRecord(r,rec->GetTurret(idx),dt,velocity);
 
 		return YSOK;
 	}
 	else if(r0!=NULL)
 	{
-		prop.ReadbackRecord(*r0,dt,0.0);
+		prop.ReadbackRecord(*r0,rec->GetTurret(idx),dt,0.0);
 	}
 	else if(r1!=NULL)
 	{
-		prop.ReadbackRecord(*r1,dt,0.0);
+		prop.ReadbackRecord(*r1,rec->GetTurret(idx+1),dt,0.0);
 	}
 	else // if(r0==NULL && r1==NULL)
 	{
@@ -2813,7 +3002,7 @@ YSRESULT FsGround::PlayRecord(const double &ct,const double &dt)
 			r0=rec->GetLastElement(t0);
 			if(r0!=NULL && t0<ct)
 			{
-				prop.ReadbackRecord(*r0,dt,0.0);
+				prop.ReadbackRecord(*r0,rec->GetTurret(rec->GetNumRecord()-1),dt,0.0);
 			}
 		}
 	}
@@ -3182,6 +3371,7 @@ YSRESULT FsGround::AimAt(
 void FsGround::SearchTarget(FsSimulation *sim)
 {
 	double dist;
+	const FsSensorIndex &sensor=sim->GetSensorIndex();
 
 	if(prop.IsAntiGround()==YSTRUE)
 	{
@@ -3207,6 +3397,29 @@ void FsGround::SearchTarget(FsSimulation *sim)
 		gndTrg=NULL;
 		for(i=0; i<2; i++)
 		{
+			if(YSTRUE==sensor.IsValid())
+			{
+				FsSensorIndex::GndFilter filter;
+				filter.excludeIff=(prop.TargetAny()==YSTRUE ? -1 : this->iff);
+				filter.aliveOnly=YSTRUE;
+				filter.skipNonGameObject=YSTRUE;
+				filter.primaryTargetOnly=(i==0 ? YSTRUE : YSFALSE);
+				filter.tankOrShipOnly=(targetAny==YSTRUE ? YSFALSE : YSTRUE);
+
+				YsArray <FsGround *,64> nearest;
+				sensor.GetKNearestGnd(nearest,GetPosition(),1,filter);
+				if(0<nearest.GetN() && ((nearest[0]->GetPosition())-GetPosition()).GetSquareLength()<dist)
+				{
+					gndTrg=nearest[0];
+					dist=((gndTrg->GetPosition())-GetPosition()).GetSquareLength();
+				}
+				if(gndTrg!=NULL)
+				{
+					break;
+				}
+				continue;
+			}
+
 			gnd=NULL;
 			while((gnd=sim->FindNextGround(gnd))!=NULL)
 			{
@@ -3250,6 +3463,22 @@ void FsGround::SearchTarget(FsSimulation *sim)
 	dist=10000000000.0;
 	airTrg=NULL;
 	air=NULL;
+	if(YSTRUE==sensor.IsValid())
+	{
+		FsSensorIndex::AirFilter filter;
+		filter.excludeIff=(prop.TargetAny()==YSTRUE ? -1 : this->iff);
+		filter.activeOnly=YSTRUE;
+		filter.skipDontAttackIfGroundStatic=YSTRUE;
+
+		YsArray <FsAirplane *,64> nearest;
+		sensor.GetKNearestAir(nearest,GetPosition(),1,filter);
+		if(0<nearest.GetN() && ((nearest[0]->GetPosition())-GetPosition()).GetSquareLength()<dist)
+		{
+			airTrg=nearest[0];
+		}
+		prop.SetAirTarget(airTrg);
+		return;
+	}
 	while((air=sim->FindNextAirplane(air))!=NULL)
 	{
 		if(0!=(air->airFlag&FSAIRFLAG_DONTATTACKIFGROUNDSTATIC) && air->Prop().GetFlightState()==FSGROUNDSTATIC)
@@ -3310,16 +3539,35 @@ YSBOOL FsGround::LockOn(FsSimulation *sim,const double &radarAltLimit)
 	aamAngle=YsPi/3.0;
 	agmAngle=YsPi/3.0;
 
+	const FsSensorIndex &sensor=sim->GetSensorIndex();
+
 	// Air Target
 	{
 		FsAirplane *airTarget;
-		FsAirplane *air;
 
 		radar=YsPi/2.0;
 		airTarget=NULL;
 
-		air=NULL;
-		while((air=sim->FindNextAirplane(air))!=NULL)
+		YsArray <FsAirplane *,64> airCan;
+		if(YSTRUE==sensor.IsValid())
+		{
+			FsSensorIndex::AirFilter filter;
+			filter.excludeIff=this->iff;
+			filter.aliveOnly=YSTRUE;
+			filter.useRadarAltLimit=YSTRUE;
+			filter.radarAltLimit=radarAltLimit;
+			filter.scaleRangeByRcs=YSTRUE;
+			sensor.GetAirInCone(airCan,*pos,att->GetForwardVector(),YsSmaller(aamAngle,radar),Prop().GetSAMRange(),filter);
+		}
+		else
+		{
+			for(FsAirplane *air=NULL; NULL!=(air=sim->FindNextAirplane(air)); )
+			{
+				airCan.Append(air);
+			}
+		}
+
+		for(auto air : airCan)
 		{
 			if(air->IsAlive()==YSTRUE && air->iff!=this->iff)
 			{
@@ -3358,14 +3606,29 @@ YSBOOL FsGround::LockOn(FsSimulation *sim,const double &radarAltLimit)
 
 	// Ground Target
 	{
-		FsGround *gnd;
 		FsGround *gndTarget;
 		gndTarget=NULL;
 
 		radar=YsPi/2.0;
 
-		gnd=NULL;
-		while((gnd=sim->FindNextGround(gnd))!=NULL)
+		YsArray <FsGround *,64> gndCan;
+		if(YSTRUE==sensor.IsValid())
+		{
+			FsSensorIndex::GndFilter filter;
+			filter.excludeIff=this->iff;
+			filter.aliveOnly=YSTRUE;
+			filter.skipNonGameObject=YSTRUE;
+			sensor.GetGndInCone(gndCan,*pos,att->GetForwardVector(),YsSmaller(agmAngle,radar),-1.0,filter);
+		}
+		else
+		{
+			for(FsGround *gnd=NULL; NULL!=(gnd=sim->FindNextGround(gnd)); )
+			{
+				gndCan.Append(gnd);
+			}
+		}
+
+		for(auto gnd : gndCan)
 		{
 			if(gnd->Prop().IsAlive()==YSTRUE && gnd->iff!=this->iff && gnd->Prop().IsNonGameObject()!=YSTRUE)
 			{
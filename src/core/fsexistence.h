@@ -10,6 +10,7 @@
 #include "fsairplaneproperty.h"
 #include "fsgroundproperty.h"
 #include "fsatc.h"
+#include "fssmoketrailcache.h"
 #include "fssiminfo.h" // Need FsSimInfo::AirBase  
 
 
@@ -25,6 +26,7 @@ private:
 
 protected:
 	FsVisualSrf coll,collSrc;
+	std::shared_ptr <const YsShellBoundingBoxTree> collTree;
 	YsVec3 collCen,collBbx[2];
 	double collRadius;
 
@@ -44,6 +46,8 @@ protected:
 
 public:
 	mutable YsVec2i fsLtcCache[2];  // Initialized in AddAirplane/AddGround, Updated in FsLattice::Add
+	mutable YSSIZE_T fsBroadPhaseCell,fsBroadPhaseSlot;  // Updated in FsBroadPhase
+	mutable YSSIZE_T fsAiControlSnapshotIdx;  // Updated in FsAiControlSnapshot::Make
 	YSBOOL rectRgnCached;
 	YsArray <const class YsSceneryRectRegion *,4> rectRgnCache;
 
@@ -157,6 +161,10 @@ public:
 	const FsVisualSrf &UntransformedCollisionShell(void) const;
 	const YsVec3 *GetCollisionShellBbx(void) const;
 	const YsVec3 &GetCollisionShellCenter(void) const;
+
+	/*! Returns the bounding-box tree of the untransformed collision shell, or nullptr if the collision shell is not set.
+	    The tree is shared among the objects that use the same template. */
+	const YsShellBoundingBoxTree *GetCollisionShellBoundingBoxTree(void) const;
 	void SetCollisionShell(const FsVisualSrf &src);
 	void SetTransformationToCollisionShell(const YsMatrix4x4 &mat);
 	void ClearCollisionShell(void);
@@ -271,6 +279,8 @@ protected:
 	YsArray <FsAutopilot *> autoPilotList;
 	// Autopilot <<
 
+	mutable YsArray <FsSmokeTrailCache> smokeTrailCache;  // One per smoke generator.  Updated in AddSingleSmokeVertexArray.
+
 public:
 	FsAirplane();
 	FsAirplane(const FsAirplane &from);
@@ -287,6 +297,17 @@ public:
 	void MakeVaporVertexArray(class YsGLVertexBuffer &vtxBuf,class YsGLColorBuffer &colBuf,double currentTime,double remainTime,int step) const;
 	void MakeSmokeVertexArray(class YsGLVertexBuffer &vtxBuf,class YsGLNormalBuffer &nomBuf,class YsGLColorBuffer &colBuf,double currentTime,double remainTime,FSSMOKETYPE smk,int step) const;
 private:
+	/*! Returns the record index that the smoke and vapor trails are drawn back from, and the time in t. */
+	YSSIZE_T CatchTrailRecordIndex(double &t,double currentTime,double t0) const;
+	/*! Brings the smoke-trail cache of the smoke generator up to date, and returns it.  Returns nullptr if
+	    the cache cannot be used, such as while playing back the record. */
+	const FsSmokeTrailCache *UpdateSmokeTrailCache(int smkId,YSSIZE_T lastIdx,double currentTime,double t0,FSSMOKETYPE smk,int step) const;
+	void AddSmokeSegment(
+	    class YsGLVertexBuffer &vtxBuf,class YsGLNormalBuffer &nomBuf,class YsGLColorBuffer &colBuf,
+	    int smkId,FSSMOKETYPE smk,const FsFlightRecord &r0,const FsFlightRecord &r1,
+	    YsVec3 &smkp0,YsAtt3 &smka0,const double &ra0,
+	    YsVec3 &smkp1,YsAtt3 &smka1,const double &ra1,
+	    const double &alpha0,const double &alpha1) const;
 	void AddSingleSmokeVertexArray(
 	    class YsGLVertexBuffer &vtxBuf,class YsGLNormalBuffer &nomBuf,class YsGLColorBuffer &colBuf,
 	    int smkId,double currentTime,double remainTime,FSSMOKETYPE smk,int step) const;
@@ -338,7 +359,7 @@ public:
 	void Overrun(const double &ctime);
 
 	YSRESULT Record(const double &t,YSBOOL forceRecord);
-	YSRESULT Record(const double &t,class FsFlightRecord &rec,YSBOOL forceRecord);
+	YSRESULT Record(const double &t,const class FsFlightRecord &rec,const YsConstArrayMask <FsTurretRecord> &turret,YSBOOL forceRecord);
 	YSRESULT PlayRecord(const double &ct,const double &dt);
 	virtual YSRESULT GetAttitudeFromRecord(YsAtt3 &att,const double &t) const;
 	const FsFlightRecord *LastAddedRecord(void) const;
@@ -472,7 +493,7 @@ public:
 	YSRESULT Settle(const YsAtt3 &att);
 
 	YSRESULT Record(const double &t,YSBOOL forceRecord);
-	YSRESULT Record(const double &t,FsGroundRecord &rec,YSBOOL forceRecord);
+	YSRESULT Record(const double &t,const FsGroundRecord &rec,const YsConstArrayMask <FsTurretRecord> &turret,YSBOOL forceRecord);
 	YSRESULT PlayRecord(const double &ct,const double &dt);
 	const FsGroundRecord *LastAddedRecord(void) const;
 	FSGNDSTATE GetFinalState(void) const;
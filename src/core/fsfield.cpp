@@ -100,6 +100,14 @@ void FsField::CacheMapDrawingOrder(void) const
 	}
 }
 
+void FsField::CacheElevationIndex(void) const
+{
+	if(nullptr!=fld && YSTRUE!=fld->ElevationIndexCached())
+	{
+		fld->CacheElevationIndex();
+	}
+}
+
 void FsField::DrawProtectPolygon(const YsVec3 &viewPos,const YsAtt3 &viewAtt,const YsMatrix4x4 &projMat,const double &nearZ) const
 {
 	if(fld!=NULL)
@@ -202,6 +210,40 @@ const YsSceneryItem * FsField::GetFieldElevationAndNormal(double &elv,YsVec3 &no
 	return NULL;
 }
 
+void FsField::GetFieldElevationAndNormal(YSSIZE_T nPos,const YsVec2 xz[],double elv[],YsVec3 nom[]) const
+{
+	if(fld!=NULL)
+	{
+		fld->pos=pos;
+		fld->att=att;
+
+		YsArray <YsVec3,16> pos3d(nPos,NULL);
+		for(YSSIZE_T i=0; i<nPos; ++i)
+		{
+			pos3d[i].Set(xz[i].x(),0.0,xz[i].y());
+		}
+		if(nullptr!=nom)
+		{
+			fld->GetElevationAndNormal(nPos,pos3d,elv,nom,nullptr);
+		}
+		else
+		{
+			fld->GetElevation(nPos,pos3d,elv,nullptr);
+		}
+	}
+	else
+	{
+		for(YSSIZE_T i=0; i<nPos; ++i)
+		{
+			elv[i]=0.0;
+			if(nullptr!=nom)
+			{
+				nom[i]=YsYVec();
+			}
+		}
+	}
+}
+
 double FsField::GetBaseElevation(void) const
 {
 	if(NULL!=fld)
@@ -243,6 +285,25 @@ YSBOOL FsField::GetFieldShellCollision(YsVec3 &itscPos,const YsVec3 &p1,const Ys
 	return YSFALSE;
 }
 
+void FsField::GetFieldShellCollision(YSSIZE_T nSeg,const YsVec3 p1[],const YsVec3 p2[],YSBOOL coll[],YsVec3 itscPos[]) const
+{
+	YsArray <const YsSceneryShell *,64> collShl(nSeg,NULL);
+	for(auto &shl : collShl)
+	{
+		shl=nullptr;
+	}
+	if(nullptr!=fld)
+	{
+		fld->pos=pos;
+		fld->att=att;
+		fld->CheckShellCollision(nSeg,p1,p2,collShl,itscPos,YsIdentity4x4());
+	}
+	for(YSSIZE_T i=0; i<nSeg; ++i)
+	{
+		coll[i]=(nullptr!=collShl[i] ? YSTRUE : YSFALSE);
+	}
+}
+
 YSBOOL FsField::GetFieldShellCollision(const YsShell &shl,const YsMatrix4x4 modelTfm) const
 {
 	if(nullptr!=fld)
@@ -39,6 +39,7 @@ public:
 
 	void ApplyColorScale(const double &plgScale,const double &linScale,const double &pntScale);
 	void CacheMapDrawingOrder(void) const;
+	void CacheElevationIndex(void) const;
 	void DrawProtectPolygon
 	 (const YsVec3 &viewPos,const YsAtt3 &viewAtt,const YsMatrix4x4 &projMat,const double &nearZ) const;
 	void DrawVisual(const YsVec3 &viewPos,const YsAtt3 &viewAtt,const YsMatrix4x4 &projMat,YSBOOL forShadowMap) const;
@@ -56,6 +57,9 @@ public:
 
 	const YsSceneryItem *GetFieldElevation(double &elv,const double &x,const double &z) const;
 	const YsSceneryItem *GetFieldElevationAndNormal(double &elv,YsVec3 &nom,const double &x,const double &z) const;
+
+	/*! Batch version of GetFieldElevationAndNormal.  xz[i].y() is the z coordinate.  nom can be nullptr. */
+	void GetFieldElevationAndNormal(YSSIZE_T nPos,const YsVec2 xz[],double elv[],YsVec3 nom[]) const;
 	double GetBaseElevation(void) const;
 	YSBOOL CanResume(void) const;
 	YSBOOL CanContinue(void) const;
@@ -64,6 +68,9 @@ public:
 	template <const int N>
 	YSRESULT GetFieldRegion(YsArray <const class YsSceneryRectRegion *,N> &id,const double &x,const double &z) const;
 	YSBOOL GetFieldShellCollision(YsVec3 &itscPos,const YsVec3 &p1,const YsVec3 &p2) const;
+
+	/*! Batch version of GetFieldShellCollision(itscPos,p1,p2).  coll[i] is YSTRUE if p1[i]-p2[i] hits a shell. */
+	void GetFieldShellCollision(YSSIZE_T nSeg,const YsVec3 p1[],const YsVec3 p2[],YSBOOL coll[],YsVec3 itscPos[]) const;
 	YSBOOL GetFieldShellCollision(const YsShell &shl,const YsMatrix4x4 modelTfm) const;
 	YSSCNAREATYPE GetAreaType(const YsVec3 &pos) const;
 
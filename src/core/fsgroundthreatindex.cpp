@@ -0,0 +1,365 @@
+#include <math.h>
+#include <ysclass.h>
+
+#include "fs.h"
+#include "fsgroundthreatindex.h"
+
+
+
+void FsGroundThreatIndex::Partition::Clear(void)
+{
+	entry.Set(0,NULL);
+	cellStart.Set(0,NULL);
+	cellEntry.Set(0,NULL);
+	min.Set(0.0,0.0);
+	cellSize=(double)MIN_CELL_SIZE;
+	nx=0;
+	nz=0;
+}
+
+void FsGroundThreatIndex::Partition::MakeGrid(void)
+{
+	cellStart.Set(0,NULL);
+	cellEntry.Set(0,NULL);
+	if(0==entry.GetN())
+	{
+		nx=0;
+		nz=0;
+		return;
+	}
+
+	YsVec2 max;
+	double sumRad=0.0;
+	min.Set(entry[0].pos.x(),entry[0].pos.z());
+	max=min;
+	for(auto &e : entry)
+	{
+		min.Set(YsSmaller(min.x(),e.pos.x()-e.rad),YsSmaller(min.y(),e.pos.z()-e.rad));
+		max.Set(YsGreater(max.x(),e.pos.x()+e.rad),YsGreater(max.y(),e.pos.z()+e.rad));
+		sumRad+=e.rad;
+	}
+
+	// About the average range so that a site covers a few cells.
+	const double wid=max.x()-min.x(),hei=max.y()-min.y();
+	cellSize=YsGreater((double)MIN_CELL_SIZE,sumRad/(double)entry.GetN());
+	while(((int)(wid/cellSize)+1)*((int)(hei/cellSize)+1)>MAX_CELL_PER_PARTITION)
+	{
+		cellSize*=2.0;
+	}
+	nx=(int)(wid/cellSize)+1;
+	nz=(int)(hei/cellSize)+1;
+
+	// A site goes to the cells that its range circle overlaps.  Counted first, and then filled.
+	auto circleOverlapsCell=[&](const Entry &e,int ix,int iz) -> YSBOOL
+	{
+		const double x0=min.x()+cellSize*(double)ix,z0=min.y()+cellSize*(double)iz;
+		const double dx=YsGreater(0.0,YsGreater(x0-e.pos.x(),e.pos.x()-(x0+cellSize)));
+		const double dz=YsGreater(0.0,YsGreater(z0-e.pos.z(),e.pos.z()-(z0+cellSize)));
+		return (dx*dx+dz*dz<=e.rad*e.rad ? YSTRUE : YSFALSE);
+	};
+
+	cellStart.Set(nx*nz+1,NULL);
+	for(auto &c : cellStart)
+	{
+		c=0;
+	}
+	for(auto &e : entry)
+	{
+		int ix0,iz0,ix1,iz1;
+		GetCellRange(ix0,iz0,ix1,iz1,YsVec2(e.pos.x()-e.rad,e.pos.z()-e.rad),YsVec2(e.pos.x()+e.rad,e.pos.z()+e.rad));
+		for(int iz=iz0; iz<=iz1; ++iz)
+		{
+			for(int ix=ix0; ix<=ix1; ++ix)
+			{
+				if(YSTRUE==circleOverlapsCell(e,ix,iz))
+				{
+					++cellStart[iz*nx+ix+1];
+				}
+			}
+		}
+	}
+	for(int i=0; i<nx*nz; ++i)
+	{
+		cellStart[i+1]+=cellStart[i];
+	}
+
+	cellEntry.Set(cellStart[nx*nz],NULL);
+	YsArray <int> fill(nx*nz,NULL);
+	for(int i=0; i<nx*nz; ++i)
+	{
+		fill[i]=cellStart[i];
+	}
+	for(YSSIZE_T i=0; i<entry.GetN(); ++i)
+	{
+		auto &e=entry[i];
+		int ix0,iz0,ix1,iz1;
+		GetCellRange(ix0,iz0,ix1,iz1,YsVec2(e.pos.x()-e.rad,e.pos.z()-e.rad),YsVec2(e.pos.x()+e.rad,e.pos.z()+e.rad));
+		for(int iz=iz0; iz<=iz1; ++iz)
+		{
+			for(int ix=ix0; ix<=ix1; ++ix)
+			{
+				if(YSTRUE==circleOverlapsCell(e,ix,iz))
+				{
+					cellEntry[fill[iz*nx+ix]++]=(int)i;
+				}
+			}
+		}
+	}
+}
+
+void FsGroundThreatIndex::Partition::GetCellRange(int &ix0,int &iz0,int &ix1,int &iz1,const YsVec2 &rMin,const YsVec2 &rMax) const
+{
+	ix0=YsBound((int)((rMin.x()-min.x())/cellSize),0,nx-1);
+	iz0=YsBound((int)((rMin.y()-min.y())/cellSize),0,nz-1);
+	ix1=YsBound((int)((rMax.x()-min.x())/cellSize),0,nx-1);
+	iz1=YsBound((int)((rMax.y()-min.y())/cellSize),0,nz-1);
+}
+
+void FsGroundThreatIndex::Partition::CollectCell(YsArray <int> &order,YsArray <const FsGround *> &gnd,int ix,int iz) const
+{
+	const int c=iz*nx+ix;
+	for(int i=cellStart[c]; i<cellStart[c+1]; ++i)
+	{
+		const Entry &e=entry[cellEntry[i]];
+		order.Append(e.order);
+		gnd.Append(e.gnd);
+	}
+}
+
+void FsGroundThreatIndex::Partition::CollectOnLine(YsArray <int> &order,YsArray <const FsGround *> &gnd,const YsVec2 &a,const YsVec2 &b) const
+{
+	if(0==nx || 0==nz)
+	{
+		return;
+	}
+
+	// Cell index of a coordinate, -1 or n if outside.  Clamped before converted to int because the line is not bounded.
+	auto toIdx=[&](const double v,const double org,const int n) -> int
+	{
+		const double f=floor((v-org)/cellSize);
+		return (int)YsBound(f,-1.0,(double)n);
+	};
+
+	const YsVec2 d=b-a;
+	if(0.0==d.x() && 0.0==d.y())
+	{
+		// Vertical line.  Only the cell under it.
+		const int ix=toIdx(a.x(),min.x(),nx),iz=toIdx(a.y(),min.y(),nz);
+		if(0<=ix && ix<nx && 0<=iz && iz<nz)
+		{
+			CollectCell(order,gnd,ix,iz);
+		}
+	}
+	else if(fabs(d.y())<=fabs(d.x()))
+	{
+		// March along X.  The line moves at most one cell in Z in each column.
+		const double slope=d.y()/d.x();
+		for(int ix=0; ix<nx; ++ix)
+		{
+			const double x0=min.x()+cellSize*(double)ix,x1=x0+cellSize;
+			const double z0=a.y()+(x0-a.x())*slope,z1=a.y()+(x1-a.x())*slope;
+			const int iz0=YsGreater(0,toIdx(YsSmaller(z0,z1),min.y(),nz));
+			const int iz1=YsSmaller(nz-1,toIdx(YsGreater(z0,z1),min.y(),nz));
+			for(int iz=iz0; iz<=iz1; ++iz)
+			{
+				CollectCell(order,gnd,ix,iz);
+			}
+		}
+	}
+	else
+	{
+		const double slope=d.x()/d.y();
+		for(int iz=0; iz<nz; ++iz)
+		{
+			const double z0=min.y()+cellSize*(double)iz,z1=z0+cellSize;
+			const double x0=a.x()+(z0-a.y())*slope,x1=a.x()+(z1-a.y())*slope;
+			const int ix0=YsGreater(0,toIdx(YsSmaller(x0,x1),min.x(),nx));
+			const int ix1=YsSmaller(nx-1,toIdx(YsGreater(x0,x1),min.x(),nx));
+			for(int ix=ix0; ix<=ix1; ++ix)
+			{
+				CollectCell(order,gnd,ix,iz);
+			}
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////
+
+FsGroundThreatIndex::FsGroundThreatIndex()
+{
+	CleanUp();
+}
+
+void FsGroundThreatIndex::CleanUp(void)
+{
+	valid=YSFALSE;
+	version=0;
+	tracked.Set(0,NULL);
+	for(auto &p : part)
+	{
+		p.Clear();
+	}
+}
+
+void FsGroundThreatIndex::Invalidate(void)
+{
+	valid=YSFALSE;
+}
+
+void FsGroundThreatIndex::Update(const FsSimulation *sim)
+{
+	if(YSTRUE!=valid)
+	{
+		Rebuild(sim);
+		return;
+	}
+
+	const double slackSq=YsSqr((double)POSITION_SLACK/2.0);
+	YSSIZE_T i=0;
+	for(const FsGround *gnd=NULL; NULL!=(gnd=sim->FindNextGround(gnd)); ++i)
+	{
+		if(tracked.GetN()<=i || tracked[i].gnd!=gnd)
+		{
+			Rebuild(sim);
+			return;
+		}
+
+		const Site &t=tracked[i];
+		const YSBOOL isAlive=gnd->IsAlive();
+		if(isAlive!=t.isAlive || gnd->GetIff()!=t.iff)
+		{
+			Rebuild(sim);
+			return;
+		}
+		if(YSTRUE==isAlive)
+		{
+			// A shorter range than indexed only makes the candidates more conservative.
+			const double range=GetThreatRange(*gnd);
+			if(t.range<range ||
+			   (0.0<t.range && slackSq<(gnd->GetPosition()-t.pos).GetSquareLength()))
+			{
+				Rebuild(sim);
+				return;
+			}
+		}
+	}
+	if(tracked.GetN()!=i)
+	{
+		Rebuild(sim);
+	}
+}
+
+void FsGroundThreatIndex::Rebuild(const FsSimulation *sim)
+{
+	YsArray <Site> site;
+	for(const FsGround *gnd=NULL; NULL!=(gnd=sim->FindNextGround(gnd)); )
+	{
+		site.Increment();
+		auto &t=site.Last();
+		t.gnd=gnd;
+		t.pos=gnd->GetPosition();
+		t.iff=gnd->GetIff();
+		t.isAlive=gnd->IsAlive();
+		t.range=(YSTRUE==t.isAlive ? GetThreatRange(*gnd) : 0.0);
+	}
+	Rebuild(site);
+}
+
+void FsGroundThreatIndex::Rebuild(const YsArray <Site> &site)
+{
+	tracked=site;
+	for(auto &p : part)
+	{
+		p.entry.Set(0,NULL);
+	}
+
+	for(int order=0; order<(int)tracked.GetN(); ++order)
+	{
+		const Site &t=tracked[order];
+		if(FS_IFF_NEUTRAL!=t.iff && YSTRUE==t.isAlive && YsTolerance<t.range)
+		{
+			auto &p=part[GetPartition(t.iff)];
+			p.entry.Increment();
+			auto &e=p.entry.Last();
+			e.gnd=t.gnd;
+			e.order=order;
+			e.pos=t.pos;
+			e.rad=t.range+(double)POSITION_SLACK;
+		}
+	}
+
+	for(auto &p : part)
+	{
+		p.MakeGrid();
+	}
+
+	++version;
+	valid=YSTRUE;
+}
+
+YSBOOL FsGroundThreatIndex::IsValid(void) const
+{
+	return valid;
+}
+
+unsigned int FsGroundThreatIndex::GetVersion(void) const
+{
+	return version;
+}
+
+YSRESULT FsGroundThreatIndex::GetThreatCandidateOnLine(YsArray <const FsGround *,64> &can,const YsVec3 &A,const YsVec3 &B,int airIff) const
+{
+	can.Clear();
+	if(YSTRUE!=valid || (B-A).GetSquareLength()<=YsSqr(YsTolerance))
+	{
+		return YSERR;
+	}
+
+	// Distance from the line in 3D is never shorter than the distance on the XZ plane.
+	const YsVec2 a(A.x(),A.z()),b(B.x(),B.z());
+	YsArray <int> order;
+	YsArray <const FsGround *> gnd;
+	for(int i=0; i<NUM_PARTITION; ++i)
+	{
+		// The last partition has mixed IFFs, and cannot be skipped as a whole.
+		if(i<NUM_PARTITION-1 && i==GetPartition(airIff))
+		{
+			continue;
+		}
+		part[i].CollectOnLine(order,gnd,a,b);
+	}
+
+	// A site may be found in more than one cell.
+	YsQuickSort <int,const FsGround *> (order.GetN(),order,gnd);
+	for(YSSIZE_T i=0; i<order.GetN(); ++i)
+	{
+		if(0==i || order[i-1]!=order[i])
+		{
+			can.Append(gnd[i]);
+		}
+	}
+	return YSOK;
+}
+
+/* static */ double FsGroundThreatIndex::GetThreatRange(const FsGround &gnd)
+{
+	double range=0.0;
+	if(0<gnd.Prop().GetNumSAM())
+	{
+		range=YsGreater(range,gnd.Prop().GetSAMRange());
+	}
+	if(0<gnd.Prop().GetNumAaaBullet())
+	{
+		range=YsGreater(range,gnd.Prop().GetAAARange());
+	}
+	return range;
+}
+
+/* static */ int FsGroundThreatIndex::GetPartition(int iff)
+{
+	if(0<=iff && iff<=FS_IFF_NEUTRAL)
+	{
+		return iff;
+	}
+	return NUM_PARTITION-1;
+}
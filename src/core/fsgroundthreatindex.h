@@ -0,0 +1,111 @@
+#ifndef FSGROUNDTHREATINDEX_IS_INCLUDED
+#define FSGROUNDTHREATINDEX_IS_INCLUDED
+/* { */
+
+#include <ysclass.h>
+#include "fsdef.h"
+
+class FsGround;
+class FsSimulation;
+
+/*! Ground-to-air threats (SAM and AAA sites) partitioned by IFF for FsSimulation::FindGroundToAirThreat.
+
+    Each IFF has its own grid on the XZ plane, and a site is stored in all the cells that its range circle overlaps.
+    Therefore a query along a line only needs to visit the cells that the line passes, whatever the weapon ranges are.
+
+    Update is called every step.  It compares the ground objects with the state taken in the last rebuild, and
+    rebuilds the index when a ground object is added or deleted, dies or is revived, changes IFF, gains a longer range,
+    or moves more than half of POSITION_SLACK.  The range circles are padded by POSITION_SLACK, so that the candidates
+    stay conservative until the next Update.  The index is not valid between AddGround/DeleteGround and the next Update,
+    and the caller must scan the ground list in the meantime.
+*/
+class FsGroundThreatIndex
+{
+public:
+	enum
+	{
+		NUM_PARTITION=FS_IFF_NEUTRAL+2,   // FS_IFF0 to FS_IFF_NEUTRAL, and the last one for the other IFFs.
+		MIN_CELL_SIZE=1000,
+		MAX_CELL_PER_PARTITION=64*64,
+		POSITION_SLACK=200
+	};
+
+	/*! State of a ground object when the index was made.  range is 0.0 if the site is dead. */
+	class Site
+	{
+	public:
+		const FsGround *gnd;
+		YsVec3 pos;
+		int iff;
+		double range;
+		YSBOOL isAlive;
+	};
+
+private:
+	class Entry
+	{
+	public:
+		const FsGround *gnd;
+		int order;
+		YsVec3 pos;
+		double rad;   // range+POSITION_SLACK
+	};
+
+	/*! Entries of cell (ix,iz) are entry[cellEntry[cellStart[iz*nx+ix]]] to entry[cellEntry[cellStart[iz*nx+ix+1]-1]]. */
+	class Partition
+	{
+	public:
+		YsArray <Entry> entry;
+		YsArray <int> cellStart,cellEntry;
+		YsVec2 min;
+		double cellSize;
+		int nx,nz;
+
+		void Clear(void);
+		void MakeGrid(void);
+		void GetCellRange(int &ix0,int &iz0,int &ix1,int &iz1,const YsVec2 &min,const YsVec2 &max) const;
+		void CollectCell(YsArray <int> &order,YsArray <const FsGround *> &gnd,int ix,int iz) const;
+		void CollectOnLine(YsArray <int> &order,YsArray <const FsGround *> &gnd,const YsVec2 &a,const YsVec2 &b) const;
+	};
+
+	YSBOOL valid;
+	unsigned int version;
+	YsArray <Site> tracked;
+	Partition part[NUM_PARTITION];
+
+public:
+	FsGroundThreatIndex();
+	void CleanUp(void);
+
+	/*! Marks the index out of date.  Called when a ground object is added or deleted. */
+	void Invalidate(void);
+
+	/*! Rebuilds the index if the ground objects have changed since the last rebuild. */
+	void Update(const FsSimulation *sim);
+
+	/*! Rebuilds the index from the sites in the order of the ground list.  Update calls it with the current state of
+	    the ground objects.  The index does not look at site[i].gnd except for returning it. */
+	void Rebuild(const YsArray <Site> &site);
+
+	YSBOOL IsValid(void) const;
+
+	/*! Incremented every time the index is rebuilt.  A path planned against the threats is still good while the
+	    version is the same. */
+	unsigned int GetVersion(void) const;
+
+	/*! Ground objects that may be a threat to an airplane of airIff near the line through A and B, in the order of
+	    the ground list.  The line is not bounded by A and B, same as YsGetPointLineDistance3.
+	    The caller needs to test the candidates with the current range and position.
+	    Returns YSERR if the index cannot narrow down the candidates (invalid, or A and B are the same point). */
+	YSRESULT GetThreatCandidateOnLine(YsArray <const FsGround *,64> &can,const YsVec3 &A,const YsVec3 &B,int airIff) const;
+
+	/*! Returns the range of the ground object as a threat to the airplanes.  0.0 if it has no SAM and no AAA left. */
+	static double GetThreatRange(const FsGround &gnd);
+
+private:
+	void Rebuild(const FsSimulation *sim);
+	static int GetPartition(int iff);
+};
+
+/* } */
+#endif
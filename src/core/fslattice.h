@@ -55,6 +55,13 @@ public:
 	template <const int N>
 	inline YSRESULT GetGndCollisionCandidate(YsArray <FsGround *,N> &gndCan,int bx0,int by0,int bx1,int by1) const;
 
+	/*! Returns airplanes that may be within rad (in XZ plane) from cen.
+	    GetAirCollisionCandidate gives up the lattice and uses the outside element only if the range sticks out of the lattice,
+	    which almost always happens with a large range.  This function clamps the range to the lattice instead,
+	    and always includes the airplanes in the outside element. */
+	template <const int N>
+	inline YSRESULT GetAirCandidateWithinRadius(YsArray <FsAirplane *,N> &airCan,const YsVec3 &cen,const double rad) const;
+
 	const FsLatticeElement &GetBlock(const YsVec2i &blk) const;
 
 	void TestDraw(void);
@@ -157,6 +164,29 @@ YSRESULT FsLattice::GetAirCollisionCandidate(YsArray <FsAirplane *,N> &airCan,in
 	return YSOK;
 }
 
+template <const int N>
+YSRESULT FsLattice::GetAirCandidateWithinRadius(YsArray <FsAirplane *,N> &airCan,const YsVec3 &cen,const double rad) const
+{
+	airCan.Clear();
+
+	int bx0,by0,bx1,by1;
+	if(YSOK==GetBlockIndexAutoBound(bx0,by0,YsVec2(cen.x()-rad,cen.z()-rad)) &&
+	   YSOK==GetBlockIndexAutoBound(bx1,by1,YsVec2(cen.x()+rad,cen.z()+rad)))
+	{
+		for(int x=bx0; x<=bx1; x++)
+		{
+			for(int y=by0; y<=by1; y++)
+			{
+				airCan.Append(GetElement(x,y)->air);
+			}
+		}
+	}
+	airCan.Append(outside.air);
+
+	YsRemoveDuplicateInUnorderedArray(airCan);
+	return YSOK;
+}
+
 template <const int N>
 YSRESULT FsLattice::GetGndCollisionCandidate(YsArray <FsGround *,N> &gndCan,int bx0,int by0,int bx1,int by1) const
 {
@@ -0,0 +1,452 @@
+#include <string.h>
+
+#include <ysclass.h>
+
+#include "fsnetutil.h"
+#include "fsnetwork.h"
+#include "fsnetstatedelta.h"
+
+
+
+// Fields of the short-format AIRPLANESTATE packet (see FsAirplaneProperty::NetworkEncode).
+// Ordered roughly from the most frequently changing, so that the bit mask stays short.
+const FsNetAirplaneStateDelta::Field FsNetAirplaneStateDelta::fieldTable[]=
+{
+	{ 4,4,FIELD_SMOOTH},   // Time.  Must be the first.  Other predictions use it.
+	{14,4,FIELD_QUADRATIC},// x
+	{18,4,FIELD_QUADRATIC},// y
+	{22,4,FIELD_QUADRATIC},// z
+	{26,2,FIELD_QUADRATIC},// h
+	{28,2,FIELD_QUADRATIC},// p
+	{30,2,FIELD_QUADRATIC},// b
+	{32,2,FIELD_LINEAR},   // vx
+	{34,2,FIELD_LINEAR},   // vy
+	{36,2,FIELD_LINEAR},   // vz
+	{38,2,FIELD_LINEAR},   // vPitch
+	{40,2,FIELD_LINEAR},   // vYaw
+	{42,2,FIELD_LINEAR},   // vRoll
+	{66,1,FIELD_PLAIN},    // g
+	{46,4,FIELD_SMOOTH},   // Fuel
+	{67,1,FIELD_PLAIN},    // Throttle
+	{68,1,FIELD_PLAIN},    // Elevator
+	{69,1,FIELD_PLAIN},    // Aileron
+	{70,1,FIELD_PLAIN},    // Rudder
+	{56,2,FIELD_PLAIN},    // Flags
+	{71,1,FIELD_PLAIN},    // Elevator trim
+	{52,1,FIELD_PLAIN},    // Flight state
+	{53,1,FIELD_PLAIN},    // Variable-geometry wing
+	{54,1,FIELD_PLAIN},    // Spoiler and landing gear
+	{55,1,FIELD_PLAIN},    // Flap and brake
+	{58,2,FIELD_PLAIN},    // Gun
+	{60,2,FIELD_PLAIN},    // Rocket
+	{62,1,FIELD_PLAIN},    // AAM
+	{63,1,FIELD_PLAIN},    // AGM
+	{64,1,FIELD_PLAIN},    // Bomb
+	{65,1,FIELD_PLAIN},    // Life
+	{44,2,FIELD_PLAIN},    // Smoke oil
+	{50,2,FIELD_PLAIN},    // Payload
+	{12,2,FIELD_PLAIN},    // Version (4 or 5)
+	{72,1,FIELD_PLAIN},    // Thrust vector and reverser (Version 4 only)
+	{73,1,FIELD_PLAIN},    // Bomb-bay door (Version 4 only)
+};
+const int FsNetAirplaneStateDelta::nField=sizeof(fieldTable)/sizeof(fieldTable[0]);
+
+/* static */ YSBOOL FsNetAirplaneStateDelta::IsDeltaCandidate(YSSIZE_T nDat,const unsigned char dat[])
+{
+	if(14<=nDat && FSNETCMD_AIRPLANESTATE==FsGetInt(dat))
+	{
+		const int version=FsGetShort(dat+12);
+		if((4==version || 5==version) && nDat==GetPacketLength(version))
+		{
+			return YSTRUE;
+		}
+	}
+	return YSFALSE;
+}
+
+/* static */ int FsNetAirplaneStateDelta::GetPacketLength(int version)
+{
+	// FsAirplaneProperty::NetworkEncode returns one byte longer than it writes.
+	return (4==version ? 75 : 73);
+}
+
+/* static */ unsigned int FsNetAirplaneStateDelta::GetField(const unsigned char pck[],const Field &fld)
+{
+	switch(fld.size)
+	{
+	case 1:
+		return pck[fld.offset];
+	case 2:
+		return FsGetUnsignedShort(pck+fld.offset);
+	}
+	return FsGetUnsignedInt(pck+fld.offset);
+}
+
+/* static */ void FsNetAirplaneStateDelta::SetField(unsigned char pck[],const Field &fld,unsigned int value)
+{
+	switch(fld.size)
+	{
+	case 1:
+		pck[fld.offset]=(unsigned char)value;
+		break;
+	case 2:
+		FsSetUnsignedShort(pck+fld.offset,(unsigned short)value);
+		break;
+	default:
+		FsSetUnsignedInt(pck+fld.offset,value);
+		break;
+	}
+}
+
+/* static */ unsigned int FsNetAirplaneStateDelta::Mask(const Field &fld,unsigned int value)
+{
+	switch(fld.size)
+	{
+	case 1:
+		return value&0xff;
+	case 2:
+		return value&0xffff;
+	}
+	return value;
+}
+
+/* static */ int FsNetAirplaneStateDelta::SignExtend(const Field &fld,unsigned int value)
+{
+	switch(fld.size)
+	{
+	case 1:
+		return (signed char)(value&0xff);
+	case 2:
+		return (short)(value&0xffff);
+	}
+	return (int)value;
+}
+
+/* static */ unsigned int FsNetAirplaneStateDelta::Predict(const Baseline &base,int fieldIdx,const unsigned char newPck[],const unsigned char *prevPckInBatch)
+{
+	const Field &fld=fieldTable[fieldIdx];
+	const unsigned int prev=GetField(base.pck,fld);
+
+	if(0==fieldIdx && nullptr!=prevPckInBatch)
+	{
+		// All airplanes in one batch are most likely from the same broadcast.
+		return GetField(prevPckInBatch,fld);
+	}
+
+	switch(fld.kind)
+	{
+	default:
+	case FIELD_PLAIN:
+		return prev;
+	case FIELD_SMOOTH:
+		return Mask(fld,prev+base.lastChange[fieldIdx]);
+	case FIELD_LINEAR:
+	case FIELD_QUADRATIC:
+		{
+			// Server broadcast interval is not constant.  Scale the changes by the time steps.
+			// Time is compared as the bit pattern of the float, which is close enough to linear within a few
+			// frames, and the prediction is done in integer so that it is exactly reproducible on both ends.
+			// Ratios are in 16-bit fixed point.
+			const Field &timeFld=fieldTable[0];
+			const long long dtNew=SignExtend(timeFld,GetField(newPck,timeFld)-GetField(base.pck,timeFld));
+			const long long dt1=SignExtend(timeFld,base.lastChange[0]);
+			const long long dt0=SignExtend(timeFld,base.prevChange[0]);
+			const long long change1=SignExtend(fld,base.lastChange[fieldIdx]);
+			const long long change0=SignExtend(fld,base.prevChange[fieldIdx]);
+
+			if(0>=dtNew || 0>=dt1 || dt1*16<dtNew)
+			{
+				return Mask(fld,prev+(unsigned int)change1);
+			}
+
+			const long long r1=dtNew*65536/dt1;
+			long long change=change1*r1/65536;
+			if(FIELD_QUADRATIC==fld.kind && 0<dt0 && dt0*16>dt1)
+			{
+				// change0 scaled to dt1, and the difference from change1 is the acceleration term.
+				const long long r0=dt1*65536/dt0;
+				const long long s=(dt1+dtNew)*65536/(dt0+dt1);
+				const long long q=r1*s/65536;
+				change+=(change1-change0*r0/65536)*q/65536;
+			}
+			return Mask(fld,prev+(unsigned int)change);
+		}
+	}
+}
+
+/* static */ void FsNetAirplaneStateDelta::MakeKeyFrame(Baseline &base,YSSIZE_T nDat,const unsigned char dat[])
+{
+	const int version=FsGetShort(dat+12);
+	base.pckLength=GetPacketLength(version);
+
+	// The last byte is not written by NetworkEncode.  Always zero in the baseline.
+	memset(base.pck,0,sizeof(base.pck));
+	memcpy(base.pck,dat,YsSmaller <YSSIZE_T> (nDat,base.pckLength)-1);
+
+	for(int i=0; i<MAX_NUM_FIELD; ++i)
+	{
+		base.lastChange[i]=0;
+		base.prevChange[i]=0;
+	}
+	base.keyFrameTime=FsGetFloat(dat+4);
+}
+
+/* static */ void FsNetAirplaneStateDelta::Advance(Baseline &base,const unsigned char newPck[])
+{
+	for(int i=0; i<nField; ++i)
+	{
+		const Field &fld=fieldTable[i];
+		base.prevChange[i]=base.lastChange[i];
+		base.lastChange[i]=Mask(fld,GetField(newPck,fld)-GetField(base.pck,fld));
+	}
+	memcpy(base.pck,newPck,sizeof(base.pck));
+	base.pckLength=GetPacketLength(FsGetShort(newPck+12));
+}
+
+/* static */ void FsNetAirplaneStateDelta::PushVarUInt(YsArray <unsigned char> &buf,unsigned long long value)
+{
+	while(0x80<=value)
+	{
+		buf.Append((unsigned char)(0x80|(value&0x7f)));
+		value>>=7;
+	}
+	buf.Append((unsigned char)value);
+}
+
+/* static */ YSRESULT FsNetAirplaneStateDelta::PopVarUInt(unsigned long long &value,const unsigned char *&ptr,const unsigned char *end)
+{
+	value=0;
+	for(int shift=0; shift<64 && ptr<end; shift+=7)
+	{
+		const unsigned char c=*ptr;
+		++ptr;
+		value|=((unsigned long long)(c&0x7f))<<shift;
+		if(0==(c&0x80))
+		{
+			return YSOK;
+		}
+	}
+	return YSERR;
+}
+
+////////////////////////////////////////////////////////////
+
+FsNetAirplaneStateDeltaEncoder::FsNetAirplaneStateDeltaEncoder()
+{
+	keyFrameInterval=(double)DEFAULT_KEYFRAME_INTERVAL;
+	nBatchState=0;
+}
+
+void FsNetAirplaneStateDeltaEncoder::CleanUp(void)
+{
+	baseline.PrepareTable();
+	Discard();
+}
+
+void FsNetAirplaneStateDeltaEncoder::Forget(unsigned int idOnSvr)
+{
+	baseline.DeleteIfExist(idOnSvr);
+}
+
+const FsNetAirplaneStateDelta::Baseline *FsNetAirplaneStateDeltaEncoder::FindBaseline(unsigned int idOnSvr) const
+{
+	auto stagedIdxPtr=stagedIndex[idOnSvr];
+	if(nullptr!=stagedIdxPtr)
+	{
+		return &staged[*stagedIdxPtr];
+	}
+	return baseline[idOnSvr];
+}
+
+void FsNetAirplaneStateDeltaEncoder::Stage(unsigned int idOnSvr,const Baseline &newBase)
+{
+	auto stagedIdxPtr=stagedIndex[idOnSvr];
+	if(nullptr!=stagedIdxPtr)
+	{
+		staged[*stagedIdxPtr]=newBase;
+	}
+	else
+	{
+		stagedIndex.Add(idOnSvr,staged.GetN());
+		stagedId.Append(idOnSvr);
+		staged.Append(newBase);
+	}
+}
+
+YSBOOL FsNetAirplaneStateDeltaEncoder::Encode(YSSIZE_T nDat,const unsigned char dat[])
+{
+	const unsigned int idOnSvr=FsGetUnsignedInt(dat+8);
+
+	Baseline next;
+	MakeKeyFrame(next,nDat,dat);
+
+	auto prevBase=FindBaseline(idOnSvr);
+	if(nullptr==prevBase ||
+	   next.keyFrameTime<prevBase->keyFrameTime ||
+	   keyFrameInterval<=next.keyFrameTime-prevBase->keyFrameTime)
+	{
+		Stage(idOnSvr,next);
+		return YSFALSE;
+	}
+
+	unsigned long long mask=0;
+	unsigned long long code[MAX_NUM_FIELD];
+	int nCode=0;
+	for(int i=0; i<nField; ++i)
+	{
+		const Field &fld=fieldTable[i];
+		const unsigned int residual=Mask(fld,GetField(next.pck,fld)-Predict(*prevBase,i,next.pck,(0<nBatchState ? lastPckInBatch : nullptr)));
+		if(0!=residual)
+		{
+			const long long s=SignExtend(fld,residual);
+			mask|=(1ULL<<i);
+			code[nCode++]=(0<=s ? (unsigned long long)s*2 : (unsigned long long)(-s)*2-1);
+		}
+	}
+
+	if(0==nBatchState)
+	{
+		batch.Resize(6);
+		FsSetInt(batch.GetEditableArray(),FSNETCMD_AIRPLANESTATE_DELTA);
+	}
+	memcpy(lastPckInBatch,next.pck,sizeof(lastPckInBatch));
+	PushVarUInt(batch,idOnSvr);
+	PushVarUInt(batch,mask);
+	for(int i=0; i<nCode; ++i)
+	{
+		PushVarUInt(batch,code[i]);
+	}
+	++nBatchState;
+	FsSetShort(batch.GetEditableArray()+4,(short)nBatchState);
+
+	Baseline advanced=*prevBase;
+	Advance(advanced,next.pck);
+	Stage(idOnSvr,advanced);
+
+	return YSTRUE;
+}
+
+YSBOOL FsNetAirplaneStateDeltaEncoder::BatchIsEmpty(void) const
+{
+	return (0==nBatchState ? YSTRUE : YSFALSE);
+}
+
+YSBOOL FsNetAirplaneStateDeltaEncoder::BatchIsFull(void) const
+{
+	// One state takes 2+5+5*nField bytes at worst.
+	return (MAX_BATCH_SIZE<batch.GetN()+7+5*MAX_NUM_FIELD || 32767<=nBatchState ? YSTRUE : YSFALSE);
+}
+
+YSSIZE_T FsNetAirplaneStateDeltaEncoder::GetBatchSize(void) const
+{
+	return (0<nBatchState ? batch.GetN() : 0);
+}
+
+const unsigned char *FsNetAirplaneStateDeltaEncoder::GetBatch(void) const
+{
+	return batch.GetArray();
+}
+
+void FsNetAirplaneStateDeltaEncoder::ClearBatch(void)
+{
+	batch.Clear();
+	nBatchState=0;
+}
+
+void FsNetAirplaneStateDeltaEncoder::Commit(void)
+{
+	for(auto idx : staged.AllIndex())
+	{
+		baseline.Update(stagedId[idx],staged[idx]);
+	}
+	stagedIndex.PrepareTable();
+	stagedId.Clear();
+	staged.Clear();
+}
+
+void FsNetAirplaneStateDeltaEncoder::Discard(void)
+{
+	stagedIndex.PrepareTable();
+	stagedId.Clear();
+	staged.Clear();
+	ClearBatch();
+}
+
+////////////////////////////////////////////////////////////
+
+void FsNetAirplaneStateDeltaDecoder::CleanUp(void)
+{
+	baseline.PrepareTable();
+}
+
+void FsNetAirplaneStateDeltaDecoder::Forget(unsigned int idOnSvr)
+{
+	baseline.DeleteIfExist(idOnSvr);
+}
+
+void FsNetAirplaneStateDeltaDecoder::SetKeyFrame(YSSIZE_T nDat,const unsigned char dat[])
+{
+	if(YSTRUE==IsDeltaCandidate(nDat,dat))
+	{
+		Baseline base;
+		MakeKeyFrame(base,nDat,dat);
+		baseline.Update(FsGetUnsignedInt(dat+8),base);
+	}
+}
+
+YSRESULT FsNetAirplaneStateDeltaDecoder::Decode(YSSIZE_T nDat,const unsigned char dat[],std::function <void(YSSIZE_T,unsigned char [])> receiveFunc)
+{
+	if(nDat<6)
+	{
+		return YSERR;
+	}
+
+	const unsigned char *ptr=dat+6,*end=dat+nDat;
+	const int nState=FsGetShort(dat+4);
+	unsigned char prevPck[MAX_STATE_PACKET_SIZE];
+	for(int stateIdx=0; stateIdx<nState; ++stateIdx)
+	{
+		unsigned long long idOnSvr,mask;
+		if(YSOK!=PopVarUInt(idOnSvr,ptr,end) || YSOK!=PopVarUInt(mask,ptr,end))
+		{
+			return YSERR;
+		}
+
+		auto base=baseline[(unsigned int)idOnSvr];
+
+		unsigned char pck[MAX_STATE_PACKET_SIZE];
+		memset(pck,0,sizeof(pck));
+		for(int i=0; i<nField; ++i)
+		{
+			const Field &fld=fieldTable[i];
+			unsigned int residual=0;
+			if(0!=(mask&(1ULL<<i)))
+			{
+				unsigned long long code;
+				if(YSOK!=PopVarUInt(code,ptr,end))
+				{
+					return YSERR;
+				}
+				residual=(0==(code&1) ? (unsigned int)(code>>1) : (unsigned int)(-(long long)((code+1)>>1)));
+			}
+			if(nullptr!=base)
+			{
+				SetField(pck,fld,Predict(*base,i,pck,(0<stateIdx ? prevPck : nullptr))+residual);
+			}
+		}
+
+		// The server always sends a key frame first.  Missing baseline means a broken stream.  Skip it.
+		if(nullptr!=base)
+		{
+			FsSetInt(pck,FSNETCMD_AIRPLANESTATE);
+			FsSetUnsignedInt(pck+8,(unsigned int)idOnSvr);
+			Advance(*base,pck);
+		}
+		memcpy(prevPck,pck,sizeof(prevPck));
+		if(nullptr!=base)
+		{
+			receiveFunc(base->pckLength,pck);
+		}
+	}
+	return YSOK;
+}
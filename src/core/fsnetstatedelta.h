@@ -0,0 +1,142 @@
+#ifndef FSNETSTATEDELTA_IS_INCLUDED
+#define FSNETSTATEDELTA_IS_INCLUDED
+/* { */
+
+#include <functional>
+#include <ysclass.h>
+
+/*! Delta coding of the short-format (version 4 and 5) FSNETCMD_AIRPLANESTATE packets.
+
+    Each field of the state packet is predicted from the last two states of the same airplane that the other end has,
+    scaled by the time steps, and only the non-zero residuals are sent as variable-length integers.  Fields that do not move take no byte,
+    and the number of bytes for the moving fields follows how fast they move.
+    The prediction is done in integer, on the same bytes that the short-format packet carries.  Therefore,
+    the decoder rebuilds byte-identical AIRPLANESTATE packet, and FsNetReceivedAirplaneState::Decode gives the
+    exact same state as the full packet.
+
+    Deltas of multiple airplanes are packed in one FSNETCMD_AIRPLANESTATE_DELTA packet.
+      int   FSNETCMD_AIRPLANESTATE_DELTA
+      short Number of airplanes
+      For each airplane
+        varint idOnSvr
+        varint Bit mask of the fields that have non-zero residuals
+        varint Zig-zag coded residuals
+*/
+class FsNetAirplaneStateDelta
+{
+public:
+	enum
+	{
+		MAX_STATE_PACKET_SIZE=80,
+		MAX_NUM_FIELD=40,
+		MAX_BATCH_SIZE=4096
+	};
+
+	/*! Returns YSTRUE if the packet is a short-format AIRPLANESTATE packet that can be delta coded. */
+	static YSBOOL IsDeltaCandidate(YSSIZE_T nDat,const unsigned char dat[]);
+
+protected:
+	enum FIELDKIND
+	{
+		FIELD_PLAIN,      // Predicted to be the same as the last value.
+		FIELD_SMOOTH,     // Predicted to change by the same amount as the last change.
+		FIELD_LINEAR,     // Same as FIELD_SMOOTH, but the change is scaled by the time step.
+		FIELD_QUADRATIC   // Extrapolated from the last two changes and time steps.
+	};
+	class Field
+	{
+	public:
+		int offset,size;
+		FIELDKIND kind;
+	};
+	static const Field fieldTable[];
+	static const int nField;
+
+	class Baseline
+	{
+	public:
+		unsigned char pck[MAX_STATE_PACKET_SIZE];
+		int pckLength;
+		unsigned int lastChange[MAX_NUM_FIELD],prevChange[MAX_NUM_FIELD];
+		double keyFrameTime;
+	};
+
+	static unsigned int GetField(const unsigned char pck[],const Field &fld);
+	static void SetField(unsigned char pck[],const Field &fld,unsigned int value);
+	static unsigned int Mask(const Field &fld,unsigned int value);
+	static int SignExtend(const Field &fld,unsigned int value);
+
+	/*! Field 0 (time) of newPck must be ready when predicting other fields.
+	    prevPckInBatch is the state that precedes in the same FSNETCMD_AIRPLANESTATE_DELTA packet, or nullptr. */
+	static unsigned int Predict(const Baseline &base,int fieldIdx,const unsigned char newPck[],const unsigned char *prevPckInBatch);
+	static int GetPacketLength(int version);
+	static void MakeKeyFrame(Baseline &base,YSSIZE_T nDat,const unsigned char dat[]);
+	static void Advance(Baseline &base,const unsigned char newPck[]);
+
+	static void PushVarUInt(YsArray <unsigned char> &buf,unsigned long long value);
+	static YSRESULT PopVarUInt(unsigned long long &value,const unsigned char *&ptr,const unsigned char *end);
+};
+
+/*! Server side.  Staged baselines are committed after the packets are given to the socket. */
+class FsNetAirplaneStateDeltaEncoder : public FsNetAirplaneStateDelta
+{
+public:
+	enum
+	{
+		DEFAULT_KEYFRAME_INTERVAL=5   // Seconds
+	};
+
+private:
+	YsHashTable <Baseline> baseline;
+	YsHashTable <YSSIZE_T> stagedIndex;
+	YsArray <unsigned int> stagedId;
+	YsArray <Baseline> staged;
+	YsArray <unsigned char> batch;
+	int nBatchState;
+	unsigned char lastPckInBatch[MAX_STATE_PACKET_SIZE];
+
+public:
+	double keyFrameInterval;
+
+	FsNetAirplaneStateDeltaEncoder();
+	void CleanUp(void);
+	void Forget(unsigned int idOnSvr);
+
+	/*! Writes the delta to the batch and returns YSTRUE, or returns YSFALSE if the packet needs to be sent as is
+	    as a key frame.  Either way, the state is staged as the next baseline.
+	    The packet must be a delta candidate. */
+	YSBOOL Encode(YSSIZE_T nDat,const unsigned char dat[]);
+
+	YSBOOL BatchIsEmpty(void) const;
+	YSBOOL BatchIsFull(void) const;
+	YSSIZE_T GetBatchSize(void) const;
+	const unsigned char *GetBatch(void) const;
+	void ClearBatch(void);
+
+	void Commit(void);
+	void Discard(void);
+
+private:
+	const Baseline *FindBaseline(unsigned int idOnSvr) const;
+	void Stage(unsigned int idOnSvr,const Baseline &newBase);
+};
+
+/*! Client side. */
+class FsNetAirplaneStateDeltaDecoder : public FsNetAirplaneStateDelta
+{
+private:
+	YsHashTable <Baseline> baseline;
+
+public:
+	void CleanUp(void);
+	void Forget(unsigned int idOnSvr);
+
+	/*! Takes a full AIRPLANESTATE packet as the baseline of the airplane.  Packets that are not delta candidates are ignored. */
+	void SetKeyFrame(YSSIZE_T nDat,const unsigned char dat[]);
+
+	/*! Rebuilds AIRPLANESTATE packets from a FSNETCMD_AIRPLANESTATE_DELTA packet, and gives each of them to receiveFunc. */
+	YSRESULT Decode(YSSIZE_T nDat,const unsigned char dat[],std::function <void(YSSIZE_T,unsigned char [])> receiveFunc);
+};
+
+/* } */
+#endif
@@ -245,151 +245,249 @@ static void FsDecodeWeaponConfig(int &airId,YsArray <int,64> &weaponConfig,unsig
 	}
 }
 
-static void FsDeletePacket(YSSIZE_T &nSendQueue,unsigned char sendQueue[],unsigned pckPtr)
+YSBOOL FsIsLowPriorityPacket(int cmd)
 {
-	unsigned i;
-	unsigned pckLng;
-	pckLng=FsGetUnsignedInt(sendQueue+pckPtr);
-
-	for(i=pckPtr; i+(pckLng+4)<nSendQueue; i++)
+	if(cmd==FSNETCMD_REMOVEGROUND ||
+	   cmd==FSNETCMD_GROUNDSTATE ||
+	   cmd==FSNETCMD_RESENDGNDREQUEST ||
+	   cmd==FSNETCMD_ERROR ||
+	   cmd==FSNETCMD_NOP)
 	{
-		sendQueue[i]=sendQueue[i+pckLng+4];
+		return YSTRUE;
 	}
+	else
+	{
+		return YSFALSE;
+	}
+}
 
-	YSSIZE_T prevNSendQueue;
-	prevNSendQueue=nSendQueue;
+////////////////////////////////////////////////////////////
 
-	nSendQueue=nSendQueue-(pckLng+4);
 
-	if(prevNSendQueue<nSendQueue)
-	{
-		nSendQueue=0;
-		fsConsole.Printf("Buffer underflow!\n");
-	}
+FsNetSendQueue::FsNetSendQueue()
+{
+	firstPacket=0;
+	nByteAlive=0;
+	nByteDead=0;
 }
 
-//static void FsDietSendBufferByDeletingOldState(unsigned &nSendQueue,unsigned char sendQueue[])
-//{
-//	unsigned char *gndPtr,*airPtr;
-//	unsigned i;
-//	i=0;
-//	gndPtr=NULL;
-//	airPtr=NULL;
-//	while(i<nSendQueue)
-//	{
-//		int cmd1;
-//		unsigned pckLng1;
-//		unsigned char *pckTop1,*cmdTop1;
-//
-//		pckTop1=sendQueue+i;
-//		cmdTop1=sendQueue+i+4;
-//
-//		pckLng1=FsGetUnsignedInt(pckTop1);
-//		cmd1=FsGetInt(cmdTop1);
-//
-//		if(cmd1==FSNETCMD_AIRPLANESTATE || cmd1==FSNETCMD_GROUNDSTATE)
-//		{
-//			unsigned j;
-//			int cmd2,idOnSvr1;
-//			unsigned pckLng2;
-//			unsigned char *pckTop2,*cmdTop2;
-//
-//			idOnSvr1=FsGetInt(cmdTop1+8);
-//			j=i+pckLng1+4;
-//			while(j<nSendQueue)
-//			{
-//				pckTop2=sendQueue+j;
-//				cmdTop2=sendQueue+j+4;
-//
-//				pckLng2=FsGetUnsignedInt(pckTop2);
-//				cmd2=FsGetInt(cmdTop2);
-//
-//				if(cmd1==cmd2 && FsGetInt(cmdTop2+8)==idOnSvr1)
-//				{
-//					FsDeletePacket(nSendQueue,sendQueue,i);
-//					break;
-//				}
-//				j=j+FsGetUnsignedInt(sendQueue+j)+4;
-//			}
-//		}
-//
-//		pckLng1=FsGetUnsignedInt(pckTop1);  // <- Don't forget refreshing it
-//		i=i+pckLng1+4;
-//	}
-//}
+void FsNetSendQueue::CleanUp(void)
+{
+	packetBuf.Clear();
+	packet.Clear();
+	firstPacket=0;
+	nByteAlive=0;
+	nByteDead=0;
+	stateSlot.PrepareTable();
+}
 
-static void FsDeleteOldStatePacket(YSSIZE_T &nSendQueue,unsigned char sendQueue[],int cmd0,int idOnSvr0)
+YSSIZE_T FsNetSendQueue::GetNumByte(void) const
 {
-	unsigned i;
-	i=0;
+	return nByteAlive;
+}
 
-	while(i+8<=nSendQueue)
-	{
-		int cmd;
-		unsigned char *pckTop,*cmdTop;
+YSBOOL FsNetSendQueue::IsEmpty(void) const
+{
+	return (0==nByteAlive ? YSTRUE : YSFALSE);
+}
 
-		pckTop=sendQueue+i;
-		cmdTop=sendQueue+i+4;
+YSHASHKEY FsNetSendQueue::GetStateKey(YSSIZE_T nDat,const unsigned char dat[])
+{
+	if(12<=nDat)
+	{
+		// AIRPLANESTATE and GROUNDSTATE have idOnSvr at dat+8.
+		const int cmd=FsGetInt(dat);
+		if(cmd==FSNETCMD_AIRPLANESTATE || cmd==FSNETCMD_GROUNDSTATE)
+		{
+			const unsigned int idOnSvr=FsGetUnsignedInt(dat+8);
+			return (YSHASHKEY)(idOnSvr*2+(cmd==FSNETCMD_GROUNDSTATE ? 1 : 0));
+		}
+	}
+	return YSNULLHASHKEY;
+}
 
-		cmd=FsGetInt(cmdTop);
+void FsNetSendQueue::Add(YSSIZE_T nDat,const unsigned char dat[])
+{
+	Packet pck;
+	pck.top=packetBuf.GetN();
+	pck.length=nDat;
+	pck.stateKey=GetStateKey(nDat,dat);
+	pck.alive=YSTRUE;
 
-		if(cmd==cmd0 && FsGetInt(cmdTop+8)==idOnSvr0)
+	// Old state of the same object is useless.
+	if(YSNULLHASHKEY!=pck.stateKey)
+	{
+		auto slotPtr=stateSlot[pck.stateKey];
+		if(nullptr!=slotPtr)
 		{
-			FsDeletePacket(nSendQueue,sendQueue,i);
+			Kill(*slotPtr);
+			*slotPtr=packet.GetN();
 		}
-		else // 2003/01/07
+		else
 		{
-			unsigned pckLng;
-			pckLng=FsGetUnsignedInt(pckTop);
-			i=i+pckLng+4;
+			stateSlot.Add(pck.stateKey,packet.GetN());
 		}
 	}
+
+	packetBuf.Append(nDat,dat);
+	packet.Append(pck);
+	nByteAlive+=4+nDat;
+
+	if(MAX_CHUNK_SIZE<nByteDead && nByteAlive<nByteDead)
+	{
+		Compact();
+	}
 }
 
-YSBOOL FsIsLowPriorityPacket(int cmd)
+void FsNetSendQueue::Kill(YSSIZE_T packetIdx)
 {
-	if(cmd==FSNETCMD_REMOVEGROUND ||
-	   cmd==FSNETCMD_GROUNDSTATE ||
-	   cmd==FSNETCMD_RESENDGNDREQUEST ||
-	   cmd==FSNETCMD_ERROR ||
-	   cmd==FSNETCMD_NOP)
+	auto &pck=packet[packetIdx];
+	if(YSTRUE==pck.alive)
 	{
-		return YSTRUE;
+		pck.alive=YSFALSE;
+		nByteAlive-=4+pck.length;
+		nByteDead+=4+pck.length;
 	}
-	else
+}
+
+void FsNetSendQueue::DeleteLowPriorityPacket(void)
+{
+	for(auto idx=firstPacket; idx<packet.GetN(); ++idx)
 	{
-		return YSFALSE;
+		auto &pck=packet[idx];
+		if(YSTRUE==pck.alive && YSTRUE==FsIsLowPriorityPacket(FsGetInt(packetBuf.GetArray()+pck.top)))
+		{
+			if(YSNULLHASHKEY!=pck.stateKey)
+			{
+				stateSlot.DeleteIfExist(pck.stateKey);
+			}
+			Kill(idx);
+		}
 	}
 }
 
-void FsDeleteLowPriorityPacket(YSSIZE_T &nSendQueue,unsigned char sendQueue[])
+void FsNetSendQueue::Compact(void)
 {
-	unsigned i;
-	i=0;
+	YSSIZE_T nPacket=0,nByte=0;
+	for(auto idx=firstPacket; idx<packet.GetN(); ++idx)
+	{
+		auto pck=packet[idx];
+		if(YSTRUE==pck.alive)
+		{
+			memmove(packetBuf.GetEditableArray()+nByte,packetBuf.GetArray()+pck.top,pck.length);
+			pck.top=nByte;
+			packet[nPacket]=pck;
+			if(YSNULLHASHKEY!=pck.stateKey)
+			{
+				stateSlot.Update(pck.stateKey,nPacket);
+			}
+			nByte+=pck.length;
+			++nPacket;
+		}
+	}
+	packetBuf.Resize(nByte);
+	packet.Resize(nPacket);
+	firstPacket=0;
+	nByteDead=0;
+}
 
-	while(i+8<=nSendQueue)
+YSRESULT FsNetSendQueue::Flush(YSSIZE_T &nByteSent,std::function <YSRESULT(YSSIZE_T,unsigned char [])> sendFunc,FsNetAirplaneStateDeltaEncoder *deltaEncoder)
+{
+	auto closeBatch=[&]()
 	{
-		int cmd;
-		unsigned char *pckTop,*cmdTop;
+		if(nullptr!=deltaEncoder && YSTRUE!=deltaEncoder->BatchIsEmpty())
+		{
+			unsigned char nByte[4];
+			FsSetUnsignedInt(nByte,(unsigned int)deltaEncoder->GetBatchSize());
+			wireBuf.Append(4,nByte);
+			wireBuf.Append(deltaEncoder->GetBatchSize(),deltaEncoder->GetBatch());
+			deltaEncoder->ClearBatch();
+		}
+	};
 
-		pckTop=sendQueue+i;
-		cmdTop=sendQueue+i+4;
+	nByteSent=0;
+	while(firstPacket<packet.GetN())
+	{
+		wireBuf.Clear();
+		YSSIZE_T nByteTaken=0;
+		auto idx=firstPacket;
+		for(idx=firstPacket; idx<packet.GetN(); ++idx)
+		{
+			const auto &pck=packet[idx];
+			if(YSTRUE==pck.alive)
+			{
+				const YSSIZE_T nBatch=(nullptr!=deltaEncoder ? deltaEncoder->GetBatchSize() : 0);
+				if(0<wireBuf.GetN()+nBatch && MAX_CHUNK_SIZE<wireBuf.GetN()+nBatch+8+pck.length)
+				{
+					break;
+				}
+				nByteTaken+=4+pck.length;
 
-		cmd=FsGetInt(cmdTop);
+				const unsigned char *pckTop=packetBuf.GetArray()+pck.top;
+				if(nullptr!=deltaEncoder && YSTRUE==FsNetAirplaneStateDelta::IsDeltaCandidate(pck.length,pckTop))
+				{
+					if(YSTRUE==deltaEncoder->Encode(pck.length,pckTop))
+					{
+						if(YSTRUE==deltaEncoder->BatchIsFull())
+						{
+							closeBatch();
+						}
+						continue;
+					}
+				}
+				closeBatch();
+
+				unsigned char nByte[4];
+				FsSetUnsignedInt(nByte,(unsigned int)pck.length);
+				wireBuf.Append(4,nByte);
+				wireBuf.Append(pck.length,pckTop);
+			}
+		}
+		closeBatch();
 
-		if(FsIsLowPriorityPacket(cmd)==YSTRUE)
+		if(0<wireBuf.GetN())
 		{
-			FsDeletePacket(nSendQueue,sendQueue,i);
+			if(YSOK!=sendFunc(wireBuf.GetN(),wireBuf.GetEditableArray()))
+			{
+				if(nullptr!=deltaEncoder)
+				{
+					deltaEncoder->Discard();
+				}
+				if(firstPacket*2>packet.GetN())
+				{
+					Compact();
+				}
+				return YSERR;
+			}
+			if(nullptr!=deltaEncoder)
+			{
+				deltaEncoder->Commit();
+			}
+			nByteSent+=wireBuf.GetN();
+			nByteAlive-=nByteTaken;
 		}
-		else // 2003/01/07
+
+		for(auto i=firstPacket; i<idx; ++i)
 		{
-			unsigned pckLng;
-			pckLng=FsGetUnsignedInt(pckTop);
-			i=i+pckLng+4;
+			if(YSTRUE!=packet[i].alive)
+			{
+				nByteDead-=4+packet[i].length;
+			}
+			else if(YSNULLHASHKEY!=packet[i].stateKey)
+			{
+				stateSlot.DeleteIfExist(packet[i].stateKey);
+			}
 		}
+		firstPacket=idx;
 	}
-}
 
+	packetBuf.Clear();
+	packet.Clear();
+	firstPacket=0;
+	nByteAlive=0;
+	nByteDead=0;
+	return YSOK;
+}
 
 
 
@@ -426,16 +524,6 @@ void FsNetworkScoreLog::FormatKilledMessage(YsString &msg)
 ////////////////////////////////////////////////////////////
 
 
-void FsNetworkUser::AddToSendQueue(YSSIZE_T nByte,unsigned char dat[])
-{
-
-	for(decltype(nByte) i=0; i<nByte; i++)
-	{
-		sendQueue[nSendQueueFilled+i]=dat[i];
-	}
-	nSendQueueFilled+=nByte;
-}
-
 void FsNetworkUser::Initialize(void)
 {
 	state=FSUSERSTATE_NOTCONNECTED; // Will be set to PENDING in ReceiveLogOnUser
@@ -448,7 +536,10 @@ void FsNetworkUser::Initialize(void)
 	ipAddr[3]=ipAddr[3];
 	air=NULL;
 	nComBuf=0;
-	nSendQueueFilled=0;
+	sendQueue.CleanUp();
+	disconnectPending=YSFALSE;
+	stateEncoder.CleanUp();
+	capability=0;
 
 	sendCriticalInfoTimer=0.0;
 	configStringToSend.Set(0,NULL);
@@ -465,6 +556,19 @@ void FsNetworkUser::Initialize(void)
 	controlShowUserNameReadBack=YSFALSE;
 	environmentReadBack=YSFALSE;
 	preparationReadBack=YSFALSE;
+
+	aoiNearAir.CleanUp();
+	airStateNextSendTime.PrepareTable();
+
+	nByteSentInPeriod=0;
+	bytePerSec=0.0;
+}
+
+void FsNetworkUser::ForgetAirplane(unsigned int airKey)
+{
+	aoiNearAir.Delete(airKey);
+	airStateNextSendTime.DeleteIfExist(airKey);
+	stateEncoder.Forget(airKey);
 }
 
 
@@ -901,6 +1005,9 @@ YSRESULT FsSocketServer::ReceivedFrom(int clientId,YSSIZE_T nBytes,unsigned char
 				case FSNETCMD_GNDCMD:                 //  45
 					ReceiveGndCmd(clientId,cmdTop,packetLength);
 					break;
+				case FSNETCMD_CAPABILITY:             //  53
+					ReceiveCapability(clientId,cmdTop,packetLength);
+					break;
 
 				case FSNETCMD_CONFIRMEXISTENCE:              //  42
 				case FSNETCMD_SERVER_FORCE_JOIN:       //  47
@@ -908,8 +1015,7 @@ YSRESULT FsSocketServer::ReceivedFrom(int clientId,YSSIZE_T nBytes,unsigned char
 				case FSNETCMD_SKYCOLOR:              //  49
 				case FSNETCMD_GNDCOLOR:              //  50
 				case FSNETCMD_RESERVED_FOR_LIGHTCOLOR:              //  51
-				case FSNETCMD_RESERVED21:              //  52
-				case FSNETCMD_RESERVED22:             //  53
+				case FSNETCMD_AIRPLANESTATE_DELTA:     //  52
 				case FSNETCMD_RESERVED23:             //  54
 				case FSNETCMD_RESERVED24:             //  55
 				case FSNETCMD_RESERVED25:             //  56
@@ -1219,11 +1325,34 @@ YSRESULT FsSocketServer::DisconnectUser(int clientId)
 		Disconnect(clientId);
 		user[clientId].state=FSUSERSTATE_NOTCONNECTED;
 		user[clientId].air=NULL;
+		user[clientId].disconnectPending=YSFALSE;
 		return YSOK;
 	}
 	return YSERR;
 }
 
+YSRESULT FsSocketServer::DisconnectPendingUser(void)
+{
+	// DisconnectUser broadcasts REMOVEAIRPLANE, which may mark another user.  Repeat until no user is marked.
+	YSBOOL disconnected=YSTRUE;
+	while(YSTRUE==disconnected)
+	{
+		disconnected=YSFALSE;
+		for(int clientId=0; clientId<FS_MAX_NUM_USER; clientId++)
+		{
+			if(YSTRUE==user[clientId].disconnectPending)
+			{
+				char str[256];
+				sprintf(str,"Cannot flush the send queue of #%d.  Disconnecting.",clientId);
+				AddMessage(str);
+				DisconnectUser(clientId);
+				disconnected=YSTRUE;
+			}
+		}
+	}
+	return YSOK;
+}
+
 YSRESULT FsSocketServer::SendTerminateMessage(int /*clientId*/,unsigned /*timeout*/)
 {
 	return YSOK;
@@ -1341,6 +1470,23 @@ YSRESULT FsSocketServer::BroadcastAirplaneState(void)
 		int idOnSvr;
 		FsAirplane *air;
 
+		if(YSTRUE==netcfg->serverAreaOfInterest)
+		{
+			YsArray <FsAirplane *,256> nearAir;
+			for(int userId=0; userId<FS_MAX_NUM_USER; userId++)
+			{
+				user[userId].aoiNearAir.CleanUp();
+				if(user[userId].state==FSUSERSTATE_LOGGEDON && NULL!=user[userId].air && YSTRUE==user[userId].air->IsAlive())
+				{
+					sim->GetBroadPhase().GetAirCandidateWithinRadius(nearAir,user[userId].air->GetPosition(),netcfg->aoiNearDist);
+					for(auto nearAirPtr : nearAir)
+					{
+						user[userId].aoiNearAir.Add(FsExistence::GetSearchKey(nearAirPtr));
+					}
+				}
+			}
+		}
+
 		air=NULL;
 		while((air=sim->FindNextAirplane(air))!=NULL)
 		{
@@ -1367,15 +1513,19 @@ YSRESULT FsSocketServer::BroadcastAirplaneState(void)
 				{
 					if(user[userId].state==FSUSERSTATE_LOGGEDON && air!=user[userId].air)
 					{
-						if(/* user[userId].version>=20060805 && */packetSizeShort>0)
-						{
-							SendPacket(userId,packetSizeShort,datShort);
-						}
-						else
+						if(YSTRUE==AirplaneStateIsDue(userId,air))
 						{
-							SendPacket(userId,packetSize,dat);
+							if(/* user[userId].version>=20060805 && */packetSizeShort>0)
+							{
+								SendPacket(userId,packetSizeShort,datShort);
+							}
+							else
+							{
+								SendPacket(userId,packetSize,dat);
+							}
 						}
 
+						// Turret state is sent only when changed.  Must not be skipped.
 						if(turretPackSize>0 /* && user[userId].version>=20050701 */)
 						{
 							SendPacket(userId,turretPackSize,turretCmd);
@@ -1390,6 +1540,71 @@ YSRESULT FsSocketServer::BroadcastAirplaneState(void)
 	return YSOK;
 }
 
+YSBOOL FsSocketServer::AirplaneStateIsDue(int userId,const FsAirplane *air)
+{
+	const FsAirplane *userAir=user[userId].air;
+	if(YSTRUE!=netcfg->serverAreaOfInterest || NULL==userAir || YSTRUE!=userAir->IsAlive())
+	{
+		// Observers need everything.
+		return YSTRUE;
+	}
+
+	const unsigned int airKey=FsExistence::GetSearchKey(air);
+	const double *nextSendTime=user[userId].airStateNextSendTime[airKey];
+
+	// Airplanes that are not found by the lattice cannot be in the full-rate range.
+	// No need to even calculate the distance until the next time.
+	const YSBOOL mayBeNear=user[userId].aoiNearAir.IsIncluded(airKey);
+	if(YSTRUE!=mayBeNear && NULL!=nextSendTime && netClock<*nextSendTime)
+	{
+		return YSFALSE;
+	}
+
+	const double dist=(air->GetPosition()-userAir->GetPosition()).GetLength();
+	const FsWeather &weather=sim->GetWeather();
+	const YSBOOL visible=(YSTRUE==weather.GetFog() && weather.GetFogVisibility()<dist ? YSFALSE : YSTRUE);
+
+	YSBOOL due=YSTRUE;
+	double interval=0.0;
+	if(dist<=netcfg->aoiNearDist && YSTRUE==visible)
+	{
+		interval=0.0;
+	}
+	else if(dist<=netcfg->aoiMidDist)
+	{
+		interval=(0.0<netcfg->aoiMidRate ? 1.0/netcfg->aoiMidRate : 0.0);
+	}
+	else if(dist<=netcfg->aoiFarDist)
+	{
+		interval=(0.0<netcfg->aoiFarRate ? 1.0/netcfg->aoiFarRate : 0.0);
+	}
+	else if(0.0<netcfg->aoiCullKeepAlive)
+	{
+		interval=netcfg->aoiCullKeepAlive;
+	}
+	else
+	{
+		// Culled.  Check again at the lowest rate in case it comes back.
+		due=YSFALSE;
+		interval=(0.0<netcfg->aoiFarRate ? 1.0/netcfg->aoiFarRate : 1.0);
+	}
+
+	if(0.0<interval && NULL!=nextSendTime && netClock<*nextSendTime)
+	{
+		return YSFALSE;
+	}
+
+	if(NULL!=nextSendTime)
+	{
+		user[userId].airStateNextSendTime.Update(airKey,netClock+interval);
+	}
+	else
+	{
+		user[userId].airStateNextSendTime.Add(airKey,netClock+interval);
+	}
+	return due;
+}
+
 YSRESULT FsSocketServer::RectifyIllegalMissiles(void)
 {
 	int userId;
@@ -1602,6 +1817,7 @@ YSRESULT FsSocketServer::BroadcastRemoveAirplane(int airId,YSBOOL explosion)
 
 	for(i=0; i<FS_MAX_NUM_USER; i++)
 	{
+		user[i].ForgetAirplane(airId);
 		if(user[i].state!=FSUSERSTATE_NOTCONNECTED)
 		{
 			SendRemoveAirplane(i,airId,explosion);
@@ -2559,12 +2775,15 @@ YSRESULT FsSocketServer::ReceiveLogOnUser(int clientId,int version,const char re
 		}
 		user[clientId].air=NULL;
 		user[clientId].version=version;
+		user[clientId].capability=0;
+		user[clientId].stateEncoder.CleanUp();
 
 		user[clientId].sendCriticalInfoTimer=sim->currentTime+0.5;
 
 		FlushSendQueue(clientId,FS_NETEMERGENCYTIMEOUT);
 
 		SendVersionNotify(clientId);
+		SendCapability(clientId);
 		SendUseMissile(clientId,netcfg->useMissile);
 		SendUseUnguidedWeapon(clientId,netcfg->useUnguidedWeapon);
 		SendControlShowUserName(clientId,netcfg->serverControlShowUserName);
@@ -3580,6 +3799,21 @@ YSRESULT FsSocketServer::ReceiveListUser(int clientId)
 	return YSOK;
 }
 
+YSRESULT FsSocketServer::ReceiveCapability(int clientId,unsigned char cmdTop[],unsigned packetLength)
+{
+	if(clientId<FS_MAX_NUM_USER && user[clientId].state!=FSUSERSTATE_NOTCONNECTED && 8<=packetLength)
+	{
+		const unsigned int capability=(unsigned int)FsGetInt(cmdTop+4)&FSNETCAPABILITY_ALL;
+		if(0==(capability&FSNETCAPABILITY_AIRPLANESTATE_DELTA))
+		{
+			user[clientId].stateEncoder.CleanUp();
+		}
+		user[clientId].capability=capability;
+		return YSOK;
+	}
+	return YSERR;
+}
+
 YSRESULT FsSocketServer::ReceiveQueryAirState(int clientId,unsigned char cmdTop[],unsigned )
 {
 	printf("ReceiveQueryAirState\n"); 
@@ -4194,6 +4428,15 @@ YSRESULT FsSocketServer::SendVersionNotify(int clientId)
 	return YSOK;
 }
 
+YSRESULT FsSocketServer::SendCapability(int clientId)
+{
+	unsigned char dat[16],*ptr;
+	ptr=dat;
+	FsPushInt(ptr,FSNETCMD_CAPABILITY);
+	FsPushInt(ptr,FSNETCAPABILITY_ALL);
+	return SendPacket(clientId,ptr-dat,dat);
+}
+
 // BroadcastAirCmd is available after 20010624
 YSRESULT FsSocketServer::SendAirCmd(int clientId,int airId,const char cmd[])
 {
@@ -4603,17 +4846,59 @@ YSRESULT FsSocketServer::SendForceJoin(int clientId)
 
 YSRESULT FsSocketServer::FlushSendQueue(int clientId,unsigned timeout)
 {
-	if(user[clientId].state!=FSUSERSTATE_NOTCONNECTED && user[clientId].nSendQueueFilled>0)
+	if(user[clientId].state!=FSUSERSTATE_NOTCONNECTED && YSTRUE!=user[clientId].sendQueue.IsEmpty())
+	{
+		YSSIZE_T nByteSent;
+		YSRESULT res=user[clientId].sendQueue.Flush(
+		    nByteSent,
+		    std::bind(&FsSocketServer::Send,this,clientId,std::placeholders::_1,std::placeholders::_2,timeout),
+		    (0!=(user[clientId].capability&FSNETCAPABILITY_AIRPLANESTATE_DELTA) ? &user[clientId].stateEncoder : nullptr));
+		user[clientId].nByteSentInPeriod+=nByteSent;
+		return res;
+	}
+	else if(user[clientId].state!=FSUSERSTATE_NOTCONNECTED)
+	{
+		return YSOK;  // Nothing to send
+	}
+	return YSERR;
+}
+
+void FsSocketServer::UpdateTrafficStatistics(const double &passedTime)
+{
+	trafficStatTimer+=passedTime;
+	if(1.0<=trafficStatTimer)
 	{
-		YSRESULT res;
-		res=Send(clientId,user[clientId].nSendQueueFilled,user[clientId].sendQueue,timeout);
-		if(res==YSOK)
+		for(int i=0; i<FS_MAX_NUM_USER; i++)
 		{
-			user[clientId].nSendQueueFilled=0;
-			return YSOK;
+			user[i].bytePerSec=(double)user[i].nByteSentInPeriod/trafficStatTimer;
+			user[i].nByteSentInPeriod=0;
+		}
+		trafficStatTimer=0.0;
+	}
+
+	if(0<netcfg->trafficReportInterval)
+	{
+		trafficReportTimer+=passedTime;
+		if((double)netcfg->trafficReportInterval<=trafficReportTimer)
+		{
+			double total=0.0;
+			int nUser=0;
+			for(int i=0; i<FS_MAX_NUM_USER; i++)
+			{
+				if(user[i].state!=FSUSERSTATE_NOTCONNECTED)
+				{
+					fsConsole.Printf("[TRAFFIC] %-16s %9.0lf bytes/sec",user[i].username.Txt(),user[i].bytePerSec);
+					total+=user[i].bytePerSec;
+					++nUser;
+				}
+			}
+			if(0<nUser)
+			{
+				fsConsole.Printf("[TRAFFIC] Total %.0lf bytes/sec  Average %.0lf bytes/sec/user",total,total/(double)nUser);
+			}
+			trafficReportTimer=0.0;
 		}
 	}
-	return YSERR;
 }
 
 void FsSocketServer::AddTestAirplaneInClient(int clientId,int type)
@@ -4667,18 +4952,20 @@ void FsSocketServer::PrintPlayerList(void)
 			if(user[i].air!=NULL && user[i].air->IsAlive()==YSTRUE)
 			{
 				YsString ipAddrString;
-				fsConsole.Printf("[%04d] (IFF=%d) IP-ADDR=%s %s",
+				fsConsole.Printf("[%04d] (IFF=%d) IP-ADDR=%s %s (%.0lf bytes/sec)",
 				    FsExistence::GetSearchKey(user[i].air),
 				    user[i].air->iff,
 				    GetUserIpAddressString(i,ipAddrString),
-				    user[i].username.Txt());
+				    user[i].username.Txt(),
+				    user[i].bytePerSec);
 			}
 			else
 			{
 				YsString ipAddrString;
-				fsConsole.Printf("[****] (IFF=*)  IP-ADDR=%s %s",
+				fsConsole.Printf("[****] (IFF=*)  IP-ADDR=%s %s (%.0lf bytes/sec)",
 				    GetUserIpAddressString(i,ipAddrString),
-				    user[i].username.Txt());
+				    user[i].username.Txt(),
+				    user[i].bytePerSec);
 			}
 		}
 	}
@@ -4744,15 +5031,16 @@ void FsSocketServer::ClearUserAirplaneForMemoryCleanUpPurpose(void)
 
 YSRESULT FsSocketServer::FlushAllSendQueue(unsigned timeout)
 {
+	YSRESULT res=YSOK;
 	int i;
 	for(i=0; i<FS_MAX_NUM_USER; i++)
 	{
-		if(user[i].state!=FSUSERSTATE_NOTCONNECTED)
+		if(user[i].state!=FSUSERSTATE_NOTCONNECTED && YSOK!=FlushSendQueue(i,timeout))
 		{
-			FlushSendQueue(i,timeout);
+			res=YSERR;
 		}
 	}
-	return YSOK;
+	return res;
 }
 
 YSRESULT FsSocketServer::BroadcastPacket(YSSIZE_T nDat,unsigned char dat[],unsigned version)
@@ -4780,37 +5068,33 @@ YSRESULT FsSocketServer::SendPacket(int clientId,YSSIZE_T nDat,unsigned char dat
 		return YSERR;
 	}
 
-	if(FsNetworkUser::SENDQUEUESIZE<total)
+	if(YSTRUE==user[clientId].disconnectPending)
 	{
-		AddMessage("Tried to send huge packet. (larger than queue)");
+		// The client is not taking the packets.  Don't wait for the flush again until it is disconnected.
 		return YSERR;
 	}
 
-
-	// if sending AIRPLANESTATE or GROUNDSTATE, delete old ones.
-	if(FsGetInt(dat)==FSNETCMD_AIRPLANESTATE ||
-	   FsGetInt(dat)==FSNETCMD_GROUNDSTATE)
+	if(FsNetSendQueue::MAX_PACKET_SIZE<total)
 	{
-		FsDeleteOldStatePacket
-		    (user[clientId].nSendQueueFilled,user[clientId].sendQueue,
-		     FsGetInt(dat),FsGetInt(dat+8));
+		AddMessage("Tried to send huge packet. (larger than queue)");
+		return YSERR;
 	}
 
 
-	if(FsNetworkUser::SENDQUEUESIZE<user[clientId].nSendQueueFilled+total)
+	// Older AIRPLANESTATE or GROUNDSTATE of the same object is replaced in the queue.
+	if(FsNetSendQueue::MAX_QUEUE_SIZE<user[clientId].sendQueue.GetNumByte()+total)
 	{
 		// Buffer overflow?
-		FlushSendQueue(clientId,FS_NETEMERGENCYTIMEOUT);  // Try flushing send queue
+		YSRESULT flushRes=FlushSendQueue(clientId,FS_NETEMERGENCYTIMEOUT);  // Try flushing send queue
 
 		// If couldn't flush, delete low priority packets.
-		if(user[clientId].nSendQueueFilled!=0)
+		if(YSTRUE!=user[clientId].sendQueue.IsEmpty())
 		{
-			FsDeleteLowPriorityPacket(user[clientId].nSendQueueFilled,user[clientId].sendQueue);
+			user[clientId].sendQueue.DeleteLowPriorityPacket();
 			printf("X1\n");
 		}
 
-		// Even if it's failed, I abundon old packets. What else can I do?
-		if(FsNetworkUser::SENDQUEUESIZE<user[clientId].nSendQueueFilled+total)
+		if(FsNetSendQueue::MAX_QUEUE_SIZE<user[clientId].sendQueue.GetNumByte()+total)
 		{
 			if(FsIsLowPriorityPacket(FsGetInt(dat))==YSTRUE)
 			{
@@ -4818,14 +5102,21 @@ YSRESULT FsSocketServer::SendPacket(int clientId,YSSIZE_T nDat,unsigned char dat
 				return YSERR;
 			}
 			printf("X2\n");
-			user[clientId].nSendQueueFilled=0;
+
+			// Dropping the packets that are not low-priority leaves the client out of sync.
+			// If the client is not taking the packets, disconnect it the same way as a failed send.
+			// SendPacket may be called in a loop over the users, therefore the user is only marked here,
+			// and disconnected in DisconnectPendingUser.
+			user[clientId].sendQueue.CleanUp();
+			if(YSOK!=flushRes)
+			{
+				user[clientId].disconnectPending=YSTRUE;
+				return YSERR;
+			}
 		}
 	}
 
-	unsigned char nByte[4];
-	FsSetUnsignedInt(nByte,(unsigned int)nDat);
-	user[clientId].AddToSendQueue(4,nByte);
-	user[clientId].AddToSendQueue(nDat,dat);
+	user[clientId].sendQueue.Add(nDat,dat);
 
 	return YSOK;
 }
@@ -4933,7 +5224,6 @@ FsSocketClient::FsSocketClient(const char username[],const int port,FsSimulation
 	nComBuf=0;
 	receivedApproval=YSFALSE;
 	receivedRejection=YSFALSE;
-	nSendQueueFilled=0;
 
 	sideWindowAssigned=YSFALSE;
 
@@ -5040,8 +5330,12 @@ YSRESULT FsSocketClient::Received(YSSIZE_T nBytes,unsigned char dat[])
 					ReceiveRejectToJoin(cmdTop);
 					break;
 				case FSNETCMD_AIRPLANESTATE:
+					stateDecoder.SetKeyFrame(packetLength,cmdTop);
 					ReceiveAirplaneState(cmdTop);
 					break;
+				case FSNETCMD_AIRPLANESTATE_DELTA:
+					ReceiveAirplaneStateDelta(packetLength,cmdTop);
+					break;
 				case FSNETCMD_REMOVEAIRPLANE:
 					ReceiveRemoveAirplane(cmdTop);
 					break;
@@ -5139,9 +5433,10 @@ YSRESULT FsSocketClient::Received(YSSIZE_T nBytes,unsigned char dat[])
 				case FSNETCMD_GNDCOLOR:             //  50
 					ReceiveGroundColor(cmdTop);
 					break;
+				case FSNETCMD_CAPABILITY:           //  53
+					ReceiveCapability(packetLength,cmdTop);
+					break;
 				case FSNETCMD_RESERVED_FOR_LIGHTCOLOR:             //  51
-				case FSNETCMD_RESERVED21:             //  52
-				case FSNETCMD_RESERVED22:             //  53
 				case FSNETCMD_RESERVED23:             //  54
 				case FSNETCMD_RESERVED24:             //  55
 				case FSNETCMD_RESERVED25:             //  56
@@ -5413,6 +5708,14 @@ YSRESULT FsSocketClient::SendError(int errorCode)
 	return SendPacket(8,dat);
 }
 
+YSRESULT FsSocketClient::SendCapability(unsigned int capability)
+{
+	unsigned char dat[16];
+	FsSetInt(dat+0,FSNETCMD_CAPABILITY);
+	FsSetInt(dat+4,(int)capability);
+	return SendPacket(8,dat);
+}
+
 YSRESULT FsSocketClient::SendJoinRequest
     (int iff,const char *air,const char *stp,int fuelPercent,YSBOOL smokeOil)
 {
@@ -6477,6 +6780,17 @@ YSRESULT FsSocketClient::ReceiveGndCmd(unsigned char dat[])
 	return YSERR;
 }
 
+YSRESULT FsSocketClient::ReceiveCapability(int packetLength,unsigned char dat[])
+{
+	if(8<=packetLength)
+	{
+		// Reply with the capabilities that this client also supports.
+		const unsigned int svrCapability=(unsigned int)FsGetInt(dat+4);
+		return SendCapability(svrCapability&FSNETCAPABILITY_ALL);
+	}
+	return YSERR;
+}
+
 YSRESULT FsSocketClient::ReceiveUseMissile(int ,unsigned char dat[])
 {
 	int useMissile;
@@ -6612,6 +6926,11 @@ YSRESULT FsSocketClient::ReceiveList(int packetLength,unsigned char dat[])
 				}
 			}
 
+			// Any of them may come in FSNETCMD_ADDOBJECT.  Coarse models are loaded in advance so that
+			// the airplane can be shown while the visual model is streamed.  Loading all visual models
+			// here would be loading the entire library.
+			sim->world->PrefetchAirplaneModel(str,FsAirplaneModelSet::MODEL_LOD);
+
 			ptr+=(l+1);
 		}
 		break;
@@ -7006,6 +7325,16 @@ YSRESULT FsSocketClient::ReceiveTextMessage(unsigned char dat[])
 	return YSOK;
 }
 
+YSRESULT FsSocketClient::ReceiveAirplaneStateDelta(int packetLength,unsigned char dat[])
+{
+	return stateDecoder.Decode(
+	    packetLength,dat,
+	    [this](YSSIZE_T,unsigned char pck[])
+	    {
+		    ReceiveAirplaneState(pck);
+	    });
+}
+
 YSRESULT FsSocketClient::ReceiveRemoveAirplane(unsigned char dat[])
 {
 	YSSIZE_T i;
@@ -7016,6 +7345,8 @@ YSRESULT FsSocketClient::ReceiveRemoveAirplane(unsigned char dat[])
 	idOnSvr=FsGetInt(dat+4);
 	flags=FsGetShort(dat+8);
 
+	stateDecoder.Forget(idOnSvr);
+
 
 	forYsArrayRev(i,airUnjoinToSend)
 	{
@@ -7253,14 +7584,14 @@ YSRESULT FsSocketClient::ReceiveGndTurretState(unsigned char dat[],unsigned int
 
 YSRESULT FsSocketClient::FlushSendQueue(unsigned int timeout)
 {
-	YSRESULT res;
-	res=Send(nSendQueueFilled,sendQueue,timeout);
-	if(res==YSOK)
+	if(YSTRUE!=sendQueue.IsEmpty())
 	{
-		nSendQueueFilled=0;
-		return YSOK;
+		YSSIZE_T nByteSent;
+		return sendQueue.Flush(
+		    nByteSent,
+		    std::bind(&FsSocketClient::Send,this,std::placeholders::_1,std::placeholders::_2,timeout));
 	}
-	return YSERR;
+	return YSOK;  // Nothing to send
 }
 
 YSRESULT FsSocketClient::SendPacket(YSSIZE_T nDat,unsigned char dat[])
@@ -7268,36 +7599,27 @@ YSRESULT FsSocketClient::SendPacket(YSSIZE_T nDat,unsigned char dat[])
 	auto total=nDat+4;
 
 
-	if(SENDQUEUESIZE<total)
+	if(FsNetSendQueue::MAX_PACKET_SIZE<total)
 	{
 		AddMessage("Tried to send huge packet. (larger than queue)");
 		return YSERR;
 	}
 
 
-	// if sending AIRPLANESTATE or GROUNDSTATE, delete old ones.
-	if(FsGetInt(dat)==FSNETCMD_AIRPLANESTATE ||
-	   FsGetInt(dat)==FSNETCMD_GROUNDSTATE)
-	{
-		FsDeleteOldStatePacket
-		    (nSendQueueFilled,sendQueue,FsGetInt(dat),FsGetInt(dat+8));
-	}
-
-
-	if(SENDQUEUESIZE-nSendQueueFilled<total)
+	// Older AIRPLANESTATE or GROUNDSTATE of the same object is replaced in the queue.
+	if(FsNetSendQueue::MAX_QUEUE_SIZE<sendQueue.GetNumByte()+total)
 	{
 		// Buffer overflow?
-		FlushSendQueue(FS_NETEMERGENCYTIMEOUT);  // Try flushing send queue
+		YSRESULT flushRes=FlushSendQueue(FS_NETEMERGENCYTIMEOUT);  // Try flushing send queue
 
 		// If couldn't flush, delete low priority packets.
-		if(nSendQueueFilled!=0)
+		if(YSTRUE!=sendQueue.IsEmpty())
 		{
-			FsDeleteLowPriorityPacket(nSendQueueFilled,sendQueue);
+			sendQueue.DeleteLowPriorityPacket();
 			printf("Y1\n");
 		}
 
-		// Even if it's failed, I abundon old packets. What else can I do?
-		if(SENDQUEUESIZE-nSendQueueFilled<total)
+		if(FsNetSendQueue::MAX_QUEUE_SIZE<sendQueue.GetNumByte()+total)
 		{
 			if(FsIsLowPriorityPacket(FsGetInt(dat))==YSTRUE)
 			{
@@ -7305,14 +7627,19 @@ YSRESULT FsSocketClient::SendPacket(YSSIZE_T nDat,unsigned char dat[])
 				return YSERR;
 			}
 			printf("X2\n");
-			nSendQueueFilled=0;
+
+			// Same as the server.  If the server is not taking the packets, the connection is closed.
+			sendQueue.CleanUp();
+			if(YSOK!=flushRes)
+			{
+				AddMessage("Cannot flush the send queue.  Disconnecting.");
+				Disconnect();
+				return YSERR;
+			}
 		}
 	}
 
-	unsigned char nByte[4];
-	FsSetUnsignedInt(nByte,(unsigned int)nDat);
-	AddToSendQueue(4,nByte);
-	AddToSendQueue(nDat,dat);
+	sendQueue.Add(nDat,dat);
 
 	return YSOK;
 
@@ -7330,16 +7657,6 @@ YSRESULT FsSocketClient::SendPacket(YSSIZE_T nDat,unsigned char dat[])
 //	}
 }
 
-void FsSocketClient::AddToSendQueue(YSSIZE_T nByte,unsigned char dat[])
-{
-
-	for(decltype(nByte) i=0; i<nByte; i++)
-	{
-		sendQueue[nSendQueueFilled+i]=dat[i];
-	}
-	nSendQueueFilled+=nByte;
-}
-
 FsExistence *FsSocketClient::FindObject(int idOnSvr,YSBOOL isAirplane)
 {
 	if(idOnSvr>=0)
@@ -7716,7 +8033,7 @@ YSBOOL FsSimulation::NetActivity(void)
 		}
 	}
 
-	if(bulletHolder.FindNextActiveWeapon(NULL)!=NULL)
+	if(YSTRUE==bulletHolder.IsAnyWeaponActive())
 	{
 		return YSTRUE;
 	}
@@ -8170,8 +8487,14 @@ FsServerVariable::FsServerVariable(const char _name[],FsSimulation *_sim,FsNetCo
 		user[i].username.Set("");
 		user[i].air=NULL;
 		user[i].nComBuf=0;
+		user[i].nByteSentInPeriod=0;
+		user[i].bytePerSec=0.0;
 	}
 
+	netClock=0.0;
+	trafficStatTimer=0.0;
+	trafficReportTimer=0.0;
+
 	receivedKillServer=YSFALSE;
 
 	locked=YSFALSE;
@@ -9082,6 +9405,9 @@ void FsSimulation::RunServerModeOneStep(FsServerRunLoop &svrSta)
 			server.timeToBroadcastAirplane=0.0;
 			server.timeToBroadcastGround=0.0;
 			server.nextConsoleUpdateTime=0.0;
+			server.netClock=0.0;
+			server.trafficStatTimer=0.0;
+			server.trafficReportTimer=0.0;
 
 			svrSta.runState=FsServerRunLoop::SERVER_RUNSTATE_LOOP;
 
@@ -9120,6 +9446,7 @@ void FsSimulation::RunServerModeOneStep(FsServerRunLoop &svrSta)
 			}
 			// 2009/07/10 <<
 
+			server.netClock+=passedTime;
 			server.timeToBroadcastAirplane+=passedTime;
 			if(server.timeToBroadcastAirplane>0.1)
 			{
@@ -9136,6 +9463,7 @@ void FsSimulation::RunServerModeOneStep(FsServerRunLoop &svrSta)
 				server.BroadcastGroundState();
 				server.timeToBroadcastGround=0.0;
 			}
+			server.UpdateTrafficStatistics(passedTime);
 
 			const int prevServerState=server.serverState;
 
@@ -9237,6 +9565,7 @@ void FsSimulation::RunServerModeOneStep(FsServerRunLoop &svrSta)
 			printf("N4\n");
 		#endif
 			server.BroadcastStateChange();
+			server.DisconnectPendingUser();
 
 		#ifdef CRASHINVESTIGATION
 			printf("N5\n");
@@ -3,11 +3,13 @@
 /* { */
 
 #include "queue"
+#include <functional>
 
 #include "fsdef.h"
 #include "yssocket.h"
 #include "fsutil.h"
 #include "fsweapon.h"
+#include "fsnetstatedelta.h"
 
 enum
 {
@@ -47,7 +49,7 @@ enum
 	FSNETCMD_JOINREQUEST,            //   8 Svr<- Cli
 	FSNETCMD_JOINAPPROVAL,           //   9 Svr ->Cli
 	FSNETCMD_REJECTJOINREQ,          //  10
-	FSNETCMD_AIRPLANESTATE,          //  11 Svr<->Cli   // Be careful in FsDeleteOldStatePacket when modify
+	FSNETCMD_AIRPLANESTATE,          //  11 Svr<->Cli   // Be careful in FsNetSendQueue::GetStateKey when modify
 	FSNETCMD_UNJOIN,                 //  12 Svr<- Cli
 	FSNETCMD_REMOVEAIRPLANE,         //  13 Svr<->Cli
 	FSNETCMD_REQUESTTESTAIRPLANE,    //  14
@@ -57,7 +59,7 @@ enum
 	FSNETCMD_LOCKON,                 //  18 Svr<->Cli
 	FSNETCMD_REMOVEGROUND,           //  19 Svr<->Cli
 	FSNETCMD_MISSILELAUNCH,          //  20 Svr<->Cli   // fsweapon.cpp is responsible for encoding/decoding
-	FSNETCMD_GROUNDSTATE,            //  21 Svr<->Cli   // Be careful in FsDeleteOldStatePacket when modify
+	FSNETCMD_GROUNDSTATE,            //  21 Svr<->Cli   // Be careful in FsNetSendQueue::GetStateKey when modify
 	FSNETCMD_GETDAMAGE,              //  22 Svr<->Cli
 	FSNETCMD_GNDTURRETSTATE,         //  23 Svr<->Cli
 	FSNETCMD_SETTESTAUTOPILOT,       //  24 Svr ->Cli
@@ -88,8 +90,8 @@ enum
 	FSNETCMD_SKYCOLOR,               //  49 Svr -> Cli
 	FSNETCMD_GNDCOLOR,               //  50 Svr -> Cli
 	FSNETCMD_RESERVED_FOR_LIGHTCOLOR,//  51 Svr -> Cli
-	FSNETCMD_RESERVED21,             //  52
-	FSNETCMD_RESERVED22,             //  53
+	FSNETCMD_AIRPLANESTATE_DELTA,    //  52 Svr -> Cli  // Only if FSNETCAPABILITY_AIRPLANESTATE_DELTA is agreed
+	FSNETCMD_CAPABILITY,             //  53 Svr<->Cli  (*2)
 	FSNETCMD_RESERVED23,             //  54
 	FSNETCMD_RESERVED24,             //  55
 	FSNETCMD_RESERVED25,             //  56
@@ -126,6 +128,17 @@ enum
 //   Svr->Cli Report environment
 //     The request will be sent whenever a client receives FSNETCMD_LOADFIELD
 
+// (*2)
+// FSNETCMD_CAPABILITY
+//   Svr->Cli Capabilities of the server (FSNETCAPABILITY_*) sent after log-on.  Older clients ignore it.
+//   Cli->Svr Capabilities of the server that the client also supports.
+//   The server uses the capabilities only after the reply.  Older clients never reply, and are served the same as before.
+enum
+{
+	FSNETCAPABILITY_AIRPLANESTATE_DELTA=1,
+	FSNETCAPABILITY_ALL=FSNETCAPABILITY_AIRPLANESTATE_DELTA
+};
+
 
 
 class FsNetworkFldToSend
@@ -155,6 +168,63 @@ public:
 	void FormatKilledMessage(YsString &msg);
 };
 
+/*! Outgoing packets of one connection.
+    A new AIRPLANESTATE or GROUNDSTATE packet replaces the older state of the same object that is still waiting.
+    The replacement is O(1) through the slot table keyed by the object.  Other packets are kept in FIFO order.
+    Packets are converted to the wire format (4-byte length followed by the packet) only when flushed.
+*/
+class FsNetSendQueue
+{
+public:
+	enum
+	{
+		MAX_PACKET_SIZE=8192,          // Must fit in the receiver's command buffer.
+		MAX_CHUNK_SIZE=65536,          // Bytes given to one Send call at most.
+		MAX_QUEUE_SIZE=1024*1024       // Low-priority packets are dropped beyond this size.
+	};
+
+private:
+	class Packet
+	{
+	public:
+		YSSIZE_T top,length;           // Location in packetBuf
+		YSHASHKEY stateKey;            // YSNULLHASHKEY if not a state packet
+		YSBOOL alive;
+	};
+
+	YsArray <unsigned char> packetBuf,wireBuf;
+	YsArray <Packet> packet;
+	YSSIZE_T firstPacket;
+	YSSIZE_T nByteAlive,nByteDead;    // Wire size including the 4-byte length
+	YsHashTable <YSSIZE_T> stateSlot; // State key -> Index to packet
+
+public:
+	FsNetSendQueue();
+	void CleanUp(void);
+
+	/*! Returns the number of bytes that will go to the wire. */
+	YSSIZE_T GetNumByte(void) const;
+	YSBOOL IsEmpty(void) const;
+
+	void Add(YSSIZE_T nDat,const unsigned char dat[]);
+	void DeleteLowPriorityPacket(void);
+
+	/*! Sends the packets in chunks of MAX_CHUNK_SIZE bytes at most.
+	    The packets that were sent are removed.  Returns YSERR when sendFunc failed, and the remaining packets stay in the queue.
+	    nByteSent will be the total bytes that sendFunc accepted.
+	    If deltaEncoder is given, consecutive short-format AIRPLANESTATE packets are sent as FSNETCMD_AIRPLANESTATE_DELTA.
+	    The encoder's baselines move forward only when sendFunc accepts the chunk. */
+	YSRESULT Flush(
+	    YSSIZE_T &nByteSent,
+	    std::function <YSRESULT(YSSIZE_T,unsigned char [])> sendFunc,
+	    FsNetAirplaneStateDeltaEncoder *deltaEncoder=nullptr);
+
+private:
+	static YSHASHKEY GetStateKey(YSSIZE_T nDat,const unsigned char dat[]);
+	void Kill(YSSIZE_T packetIdx);
+	void Compact(void);
+};
+
 class FsNetworkUser
 {
 public:
@@ -168,16 +238,17 @@ public:
 
 	enum
 	{
-		COMBUFSIZE=8192,
-		SENDQUEUESIZE=8192
+		COMBUFSIZE=8192
 	};
 	YSSIZE_T nComBuf;
 	unsigned char comBuf[COMBUFSIZE];   // Store commands that are not completed in "Received"
 
 	unsigned version;
 
-	YSSIZE_T nSendQueueFilled;
-	unsigned char sendQueue[SENDQUEUESIZE];
+	FsNetSendQueue sendQueue;
+	YSBOOL disconnectPending;                     // Set by SendPacket when the send queue is stuck.  Processed in FsSocketServer::DisconnectPendingUser.
+	FsNetAirplaneStateDeltaEncoder stateEncoder;  // Used if capability has FSNETCAPABILITY_AIRPLANESTATE_DELTA
+	unsigned int capability;                      // Agreed in FSNETCMD_CAPABILITY
 
 	// Variables should be initialized in ConnectionAccepted()
 	double sendCriticalInfoTimer;
@@ -195,8 +266,21 @@ public:
 	                   // 11:Waiting for Ground Read Back  12:Waiting for SetPlayer Ground Read Back
 	                   // 13:Waiting for Approval Read Back
 
+	// Area of interest >>
+	YsKeyStore aoiNearAir;                     // Airplanes that the lattice found within the full-rate range.  Re-made in every broadcast.
+	YsHashTable <double> airStateNextSendTime; // Search key of the airplane -> Next FsServerVariable::netClock to send the state.
+	// Area of interest <<
+
+	// Traffic statistics >>
+	YSSIZE_T nByteSentInPeriod;
+	double bytePerSec;
+	// Traffic statistics <<
+
 	void Initialize(void);
-	void AddToSendQueue(YSSIZE_T nByte,unsigned char dat[]);
+
+	/*! Drops what this user keeps for the airplane of the search key.  Must be called when the airplane is removed,
+	    or the area-of-interest schedule and the delta-encoder baseline of the airplane stay until the user logs off. */
+	void ForgetAirplane(unsigned int airKey);
 };
 
 
@@ -315,6 +399,9 @@ public:
 	double timeToBroadcastAirplane,timeToBroadcastGround;
 	mutable double nextConsoleUpdateTime;
 
+	double netClock;  // Seconds since the server started.  Unlike sim->currentTime, keeps running while standing by.
+	double trafficStatTimer,trafficReportTimer;
+
 	class FsNetConfig *netcfg;
 
 	class FsAutoCloseFile chatLogFp;
@@ -354,6 +441,9 @@ public:
 	YSRESULT CheckAndSendPendingData(int clientId,const double &currentTime,const double &interval);
 
 	YSRESULT DisconnectUser(int clientId);
+	/*! Disconnects the users that SendPacket marked for disconnection.  SendPacket is called from the loops over the
+	    users, and cannot disconnect the user by itself. */
+	YSRESULT DisconnectPendingUser(void);
 
 	YSRESULT ReceivedFrom(int clientId,YSSIZE_T nBytes,unsigned char dat[]);
 	YSRESULT SendTerminateMessage(int clientId,unsigned timeout);
@@ -362,6 +452,11 @@ public:
 	YSRESULT DisconnectInactiveUser(const double &passedTime,const double &timeOut);
 
 	YSRESULT BroadcastAirplaneState(void);
+protected:
+	/*! Returns YSTRUE if the state of the airplane needs to be sent to the user now.
+	    Based on the distance between the airplane and the user's airplane (see area-of-interest parameters in FsNetConfig). */
+	YSBOOL AirplaneStateIsDue(int userId,const FsAirplane *air);
+public:
 	YSRESULT BroadcastGroundState(void);
 	YSRESULT BroadcastReviveGround(void);
 	YSRESULT BroadcastAddAirplane(const FsAirplane *air,FSNETTYPE netType);
@@ -420,6 +515,7 @@ public:
 	YSRESULT ReceiveWeaponConfig(int clientId,unsigned char cmdTop[],unsigned packetLength);
 	YSRESULT ReceiveListUser(int clientId);
 	YSRESULT ReceiveQueryAirState(int clientId,unsigned char cmdTop[],unsigned packetLength);
+	YSRESULT ReceiveCapability(int clientId,unsigned char cmdTop[],unsigned packetLength);
 	YSRESULT ReceiveAirTurretState(int clientId,unsigned char cmdTop[],unsigned packetLength);
 	YSRESULT ReceiveGndTurretState(int clientId,unsigned char cmdTop[],unsigned packetLength);
 	YSRESULT ReceiveReadBack(int clientId,unsigned char cmdTop[]);
@@ -443,6 +539,7 @@ public:
 	YSRESULT SendSetTestAutopilot(int clientId,int idOnSvr,int type);
 	YSRESULT SendAssignSideWindow(int clientId,int idOnSvr,const double &hdgOffset,const double &pchOffset);
 	YSRESULT SendVersionNotify(int clientId);
+	YSRESULT SendCapability(int clientId);
 	YSRESULT SendAirCmd(int clientId,int airIdOnSvr,const char cmd[]);
 	YSRESULT SendGndCmd(int clientId,int gndIdOnSvr,const char cmd[]);
 	YSRESULT SendUseMissile(int clientId,YSBOOL useMissile);
@@ -460,9 +557,14 @@ public:
 	YSRESULT SendReportScore(int clientId,YSBOOL scored,FsNetworkScoreLog &score);
 	YSRESULT SendForceJoin(int clientId);
 
+	/*! Returns YSOK if the queue is empty after the call.  YSERR if the socket did not take all the packets. */
 	YSRESULT FlushSendQueue(int clientId,unsigned timeout);
+	/*! Returns YSERR if the send queue of any of the users could not be flushed. */
 	YSRESULT FlushAllSendQueue(unsigned timeout);
 
+	/*! Updates bytes sent per second of each user, and prints them every netcfg->trafficReportInterval seconds. */
+	void UpdateTrafficStatistics(const double &passedTime);
+
 	void AddTestAirplaneInClient(int clientId,int type);
 
 	void PrintPlayerList(void);
@@ -564,6 +666,7 @@ public:
 
 	YSRESULT SendLogOn(const char username[],int version);
 	YSRESULT SendError(int errorCode);
+	YSRESULT SendCapability(unsigned int capability);
 	YSRESULT SendJoinRequest(int iff,const char *air,const char *stp,int fuelPercent,YSBOOL smokeOil);
 	YSRESULT SendUnjoin(int airId,YSBOOL explosion);
 	YSRESULT SendRequestTestAirplane(void);
@@ -599,6 +702,7 @@ public:
 	YSRESULT ReceiveApproveToJoin(int packetLength,unsigned char dat[]);
 	YSRESULT ReceiveRejectToJoin(unsigned char dat[]);
 	YSRESULT ReceiveAirplaneState(unsigned char dat[]);
+	YSRESULT ReceiveAirplaneStateDelta(int packetLength,unsigned char dat[]);
 	YSRESULT ReceiveRemoveAirplane(unsigned char dat[]);
 	YSRESULT ReceiveRemoveGround(unsigned char dat[]);
 	YSRESULT ReceivePrepareSimulation(int packetLength,unsigned char dat[]);
@@ -609,6 +713,7 @@ public:
 	YSRESULT ReceiveSetTestAutopilot(unsigned char dat[]);
 	YSRESULT ReceiveAssignSideWindow(unsigned char dat[]);
 	YSRESULT ReceiveVersionNotify(unsigned char dat[]);
+	YSRESULT ReceiveCapability(int packetLength,unsigned char dat[]);
 	YSRESULT ReceiveAirCmd(unsigned char dat[]);
 	YSRESULT ReceiveGndCmd(unsigned char dat[]);
 	YSRESULT ReceiveTextMessage(unsigned char dat[]);
@@ -637,16 +742,15 @@ protected:
 	enum
 	{
 		MAXNUMMESSAGE=16,
-		COMBUFSIZE=8192,
-		SENDQUEUESIZE=8192
+		COMBUFSIZE=8192
 	};
 	int nMsg;
 	char msg[MAXNUMMESSAGE][256];
 
 	YSBOOL svrUseMissile,svrUseUnguidedWeapon;
 
-	YSSIZE_T nSendQueueFilled;
-	unsigned char sendQueue[SENDQUEUESIZE];
+	FsNetSendQueue sendQueue;
+	FsNetAirplaneStateDeltaDecoder stateDecoder;
 
 	unsigned nComBuf;
 	unsigned char comBuf[COMBUFSIZE];
@@ -659,7 +763,6 @@ protected:
 	FsAirplane *sideWindowAirplane;
 	double sideWindowHdg,sideWindowPch;
 
-	void AddToSendQueue(YSSIZE_T nByte,unsigned char dat[]);
 
 	FsExistence *FindObject(int idOnSvr,YSBOOL isAirplane);
 	int FindIdOnServer(int idOnCli,YSBOOL isAirplane);
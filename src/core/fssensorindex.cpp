@@ -0,0 +1,477 @@
+#include <ysclass.h>
+
+#include "fs.h"
+#include "fssensorindex.h"
+
+
+
+FsSensorIndex::AirFilter::AirFilter()
+{
+	excludeIff=-1;
+	aliveOnly=YSFALSE;
+	activeOnly=YSFALSE;
+	flyingOnly=YSFALSE;
+	skipDontAttackIfGroundStatic=YSFALSE;
+	useRadarAltLimit=YSFALSE;
+	radarAltLimit=0.0;
+	scaleRangeByRcs=YSFALSE;
+}
+
+FsSensorIndex::GndFilter::GndFilter()
+{
+	excludeIff=-1;
+	aliveOnly=YSFALSE;
+	skipNonGameObject=YSFALSE;
+	primaryTargetOnly=YSFALSE;
+	tankOrShipOnly=YSFALSE;
+}
+
+////////////////////////////////////////////////////////////
+
+template <class EntryType>
+void FsSensorIndex::Partition<EntryType>::Clear(void)
+{
+	entry.Set(0,NULL);
+	cellStart.Set(0,NULL);
+	min.Set(0.0,0.0);
+	cellSize=(double)MIN_CELL_SIZE;
+	nx=0;
+	nz=0;
+}
+
+template <class EntryType>
+void FsSensorIndex::Partition<EntryType>::MakeGrid(void)
+{
+	if(0==entry.GetN())
+	{
+		nx=0;
+		nz=0;
+		cellStart.Set(0,NULL);
+		return;
+	}
+
+	YsVec2 max;
+	min.Set(entry[0].pos.x(),entry[0].pos.z());
+	max=min;
+	for(auto &e : entry)
+	{
+		min.Set(YsSmaller(min.x(),e.pos.x()),YsSmaller(min.y(),e.pos.z()));
+		max.Set(YsGreater(max.x(),e.pos.x()),YsGreater(max.y(),e.pos.z()));
+	}
+
+	// About one object per cell, but not too many cells.
+	const double wid=max.x()-min.x(),hei=max.y()-min.y();
+	cellSize=YsGreater((double)MIN_CELL_SIZE,sqrt(wid*hei/(double)entry.GetN()));
+	while(((int)(wid/cellSize)+1)*((int)(hei/cellSize)+1)>MAX_CELL_PER_PARTITION)
+	{
+		cellSize*=2.0;
+	}
+	nx=(int)(wid/cellSize)+1;
+	nz=(int)(hei/cellSize)+1;
+
+	// Counting sort.  Stable, so that the entries in a cell stay in the order of the list.
+	YsArray <int> cellOfEntry(entry.GetN(),NULL);
+	cellStart.Set(nx*nz+1,NULL);
+	for(auto &c : cellStart)
+	{
+		c=0;
+	}
+	for(YSSIZE_T i=0; i<entry.GetN(); ++i)
+	{
+		int ix,iz;
+		GetCellIndex(ix,iz,entry[i].pos);
+		cellOfEntry[i]=iz*nx+ix;
+		++cellStart[cellOfEntry[i]+1];
+	}
+	for(int i=0; i<nx*nz; ++i)
+	{
+		cellStart[i+1]+=cellStart[i];
+	}
+
+	YsArray <EntryType> sorted(entry.GetN(),NULL);
+	YsArray <int> fill(nx*nz,NULL);
+	for(int i=0; i<nx*nz; ++i)
+	{
+		fill[i]=cellStart[i];
+	}
+	for(YSSIZE_T i=0; i<entry.GetN(); ++i)
+	{
+		sorted[fill[cellOfEntry[i]]++]=entry[i];
+	}
+	entry.MoveFrom(sorted);
+}
+
+template <class EntryType>
+void FsSensorIndex::Partition<EntryType>::GetCellIndex(int &ix,int &iz,const YsVec3 &pos) const
+{
+	ix=YsBound((int)((pos.x()-min.x())/cellSize),0,nx-1);
+	iz=YsBound((int)((pos.z()-min.y())/cellSize),0,nz-1);
+}
+
+template <class EntryType>
+double FsSensorIndex::Partition<EntryType>::RingDistanceLowerBound(int d) const
+{
+	// The cell of pos is the cell nearest to pos.  A cell in the ring d is at least d-1 cells away from it, and
+	// if pos is outside of the grid, projecting pos onto the grid does not make the distance longer.
+	return (double)YsGreater(0,d-1)*cellSize;
+}
+
+////////////////////////////////////////////////////////////
+
+FsSensorIndex::FsSensorIndex()
+{
+	CleanUp();
+}
+
+void FsSensorIndex::CleanUp(void)
+{
+	valid=YSFALSE;
+	for(auto &p : air)
+	{
+		p.Clear();
+	}
+	for(auto &p : gnd)
+	{
+		p.Clear();
+	}
+	maxRcs=0.0;
+}
+
+void FsSensorIndex::Make(const FsSimulation *sim)
+{
+	for(auto &p : air)
+	{
+		p.entry.Set(0,NULL);
+	}
+	for(auto &p : gnd)
+	{
+		p.entry.Set(0,NULL);
+	}
+	maxRcs=0.0;
+
+	int order=0;
+	for(const FsAirplane *a=NULL; NULL!=(a=sim->FindNextAirplane(a)); ++order)
+	{
+		auto &part=air[GetPartition(a->iff)];
+		part.entry.Increment();
+		auto &e=part.entry.Last();
+		e.air=const_cast <FsAirplane *>(a);
+		e.order=order;
+		e.pos=a->GetPosition();
+		e.rcs=a->Prop().GetRadarCrossSection();
+		e.isAlive=a->IsAlive();
+		e.isActive=a->Prop().IsActive();
+		e.isOnGround=a->Prop().IsOnGround();
+		e.dontAttack=((0!=(a->airFlag&FSAIRFLAG_DONTATTACKIFGROUNDSTATIC) && a->Prop().GetFlightState()==FSGROUNDSTATIC) ? YSTRUE : YSFALSE);
+		maxRcs=YsGreater(maxRcs,e.rcs);
+	}
+
+	order=0;
+	for(const FsGround *g=NULL; NULL!=(g=sim->FindNextGround(g)); ++order)
+	{
+		auto &part=gnd[GetPartition(g->iff)];
+		part.entry.Increment();
+		auto &e=part.entry.Last();
+		e.gnd=const_cast <FsGround *>(g);
+		e.order=order;
+		e.pos=g->GetPosition();
+		e.isAlive=g->Prop().IsAlive();
+		e.isNonGameObject=g->Prop().IsNonGameObject();
+		e.isPrimaryTarget=g->primaryTarget;
+		e.isTankOrShip=((g->Prop().chType==FSTANK || g->Prop().chType==FSNAVYSHIP) ? YSTRUE : YSFALSE);
+	}
+
+	for(auto &p : air)
+	{
+		p.MakeGrid();
+	}
+	for(auto &p : gnd)
+	{
+		p.MakeGrid();
+	}
+	valid=YSTRUE;
+}
+
+void FsSensorIndex::Invalidate(void)
+{
+	valid=YSFALSE;
+}
+
+YSBOOL FsSensorIndex::IsValid(void) const
+{
+	return valid;
+}
+
+void FsSensorIndex::GetAirInCone(
+    YsArray <FsAirplane *,64> &can,const YsVec3 &pos,const YsVec3 &dir,const double halfAngle,const double range,
+    const AirFilter &filter) const
+{
+	GetInCone(can,air,pos,dir,halfAngle,range,filter);
+}
+
+void FsSensorIndex::GetGndInCone(
+    YsArray <FsGround *,64> &can,const YsVec3 &pos,const YsVec3 &dir,const double halfAngle,const double range,
+    const GndFilter &filter) const
+{
+	GetInCone(can,gnd,pos,dir,halfAngle,range,filter);
+}
+
+void FsSensorIndex::GetKNearestAir(YsArray <FsAirplane *,64> &can,const YsVec3 &pos,int k,const AirFilter &filter) const
+{
+	GetKNearest(can,air,pos,k,filter);
+}
+
+void FsSensorIndex::GetKNearestGnd(YsArray <FsGround *,64> &can,const YsVec3 &pos,int k,const GndFilter &filter) const
+{
+	GetKNearest(can,gnd,pos,k,filter);
+}
+
+/* static */ int FsSensorIndex::GetPartition(int iff)
+{
+	if(0<=iff && iff<=FS_IFF_NEUTRAL)
+	{
+		return iff;
+	}
+	return NUM_PARTITION-1;
+}
+
+/* static */ YSBOOL FsSensorIndex::IsExcludedPartition(int partition,int excludeIff)
+{
+	// The last partition has mixed IFFs, and cannot be skipped as a whole.
+	if(0<=excludeIff && partition<NUM_PARTITION-1 && partition==GetPartition(excludeIff))
+	{
+		return YSTRUE;
+	}
+	return YSFALSE;
+}
+
+YSBOOL FsSensorIndex::PassFilter(const AirEntry &e,const AirFilter &filter,const YsVec3 &pos) const
+{
+	if((YSTRUE==filter.aliveOnly && YSTRUE!=e.isAlive) ||
+	   (YSTRUE==filter.activeOnly && YSTRUE!=e.isActive) ||
+	   (YSTRUE==filter.flyingOnly && YSTRUE==e.isOnGround) ||
+	   (YSTRUE==filter.skipDontAttackIfGroundStatic && YSTRUE==e.dontAttack) ||
+	   (0<=filter.excludeIff && e.air->iff==filter.excludeIff))
+	{
+		return YSFALSE;
+	}
+	if(YSTRUE==filter.useRadarAltLimit)
+	{
+		const double altLimit=filter.radarAltLimit+1000.0*(1.0-e.rcs);
+		if((pos-e.pos).GetSquareLength()>=1000.0*1000.0 && pos.y()>=e.pos.y() && altLimit>=e.pos.y())
+		{
+			return YSFALSE;
+		}
+	}
+	return YSTRUE;
+}
+
+YSBOOL FsSensorIndex::PassFilter(const GndEntry &e,const GndFilter &filter,const YsVec3 &) const
+{
+	if((YSTRUE==filter.aliveOnly && YSTRUE!=e.isAlive) ||
+	   (YSTRUE==filter.skipNonGameObject && YSTRUE==e.isNonGameObject) ||
+	   (YSTRUE==filter.primaryTargetOnly && YSTRUE!=e.isPrimaryTarget) ||
+	   (YSTRUE==filter.tankOrShipOnly && YSTRUE!=e.isTankOrShip) ||
+	   (0<=filter.excludeIff && e.gnd->iff==filter.excludeIff))
+	{
+		return YSFALSE;
+	}
+	return YSTRUE;
+}
+
+/* static */ double FsSensorIndex::GetRangeScale(const AirEntry &e,const AirFilter &filter)
+{
+	return (YSTRUE==filter.scaleRangeByRcs ? e.rcs : 1.0);
+}
+
+/* static */ double FsSensorIndex::GetRangeScale(const GndEntry &,const GndFilter &)
+{
+	return 1.0;
+}
+
+double FsSensorIndex::GetMaxRangeScale(const AirFilter &filter) const
+{
+	return (YSTRUE==filter.scaleRangeByRcs ? maxRcs : 1.0);
+}
+
+double FsSensorIndex::GetMaxRangeScale(const GndFilter &) const
+{
+	return 1.0;
+}
+
+/* static */ FsAirplane *FsSensorIndex::GetObj(const AirEntry &e)
+{
+	return e.air;
+}
+
+/* static */ FsGround *FsSensorIndex::GetObj(const GndEntry &e)
+{
+	return e.gnd;
+}
+
+template <class EntryType,class ObjType,class FilterType>
+void FsSensorIndex::GetInCone(
+    YsArray <ObjType *,64> &can,const Partition <EntryType> part[],
+    const YsVec3 &pos,const YsVec3 &dir,const double halfAngle,const double range,const FilterType &filter) const
+{
+	can.Set(0,NULL);
+
+	YsVec3 unitDir=dir;
+	if(YSOK!=unitDir.Normalize())
+	{
+		return;
+	}
+
+	// The caller tests the angle by atan2 in its own coordinate.  The cone and the range are slightly widened here
+	// so that the round-off error never drops an object that the caller would take.
+	const YSBOOL wholeHemisphere=(YsPi/2.0<=halfAngle ? YSTRUE : YSFALSE);
+	const double tanHalf=(YSTRUE==wholeHemisphere ? 0.0 : tan(halfAngle)*(1.0+1e-6));
+	const double margin=1e-3;
+	const double maxRange=(0.0<=range ? range*GetMaxRangeScale(filter)+margin : -1.0);
+
+	YsArray <int,64> order;
+	for(int p=0; p<NUM_PARTITION; ++p)
+	{
+		const auto &pt=part[p];
+		if(0==pt.entry.GetN() || YSTRUE==IsExcludedPartition(p,filter.excludeIff))
+		{
+			continue;
+		}
+
+		int ix0=0,iz0=0,ix1=pt.nx-1,iz1=pt.nz-1;
+		if(0.0<=maxRange)
+		{
+			pt.GetCellIndex(ix0,iz0,pos-YsVec3(maxRange,0.0,maxRange));
+			pt.GetCellIndex(ix1,iz1,pos+YsVec3(maxRange,0.0,maxRange));
+		}
+
+		for(int iz=iz0; iz<=iz1; ++iz)
+		{
+			for(int ix=ix0; ix<=ix1; ++ix)
+			{
+				const int cellIdx=iz*pt.nx+ix;
+				for(int i=pt.cellStart[cellIdx]; i<pt.cellStart[cellIdx+1]; ++i)
+				{
+					const auto &e=pt.entry[i];
+					const YsVec3 v=e.pos-pos;
+					if(0.0<=range)
+					{
+						const double r=range*GetRangeScale(e,filter)+margin;
+						if(v.GetSquareLength()>r*r)
+						{
+							continue;
+						}
+					}
+
+					const double c=v*unitDir;
+					if(c<-margin)
+					{
+						continue;
+					}
+					if(YSTRUE!=wholeHemisphere && (v-unitDir*c).GetLength()>c*tanHalf+margin)
+					{
+						continue;
+					}
+
+					if(YSTRUE==PassFilter(e,filter,pos))
+					{
+						order.Append(e.order);
+						can.Append(GetObj(e));
+					}
+				}
+			}
+		}
+	}
+
+	YsQuickSort <int,ObjType *> (order.GetN(),order,can);
+}
+
+template <class EntryType,class ObjType,class FilterType>
+void FsSensorIndex::GetKNearest(
+    YsArray <ObjType *,64> &can,const Partition <EntryType> part[],const YsVec3 &pos,int k,const FilterType &filter) const
+{
+	can.Set(0,NULL);
+	if(0>=k)
+	{
+		return;
+	}
+
+	// Best k so far, sorted by (distance, order).
+	YsArray <double,64> bestSqDist;
+	YsArray <int,64> bestOrder;
+
+	auto isBetter=[&](double sqDist,int order,YSSIZE_T idx)
+	{
+		return ((sqDist<bestSqDist[idx] || (sqDist==bestSqDist[idx] && order<bestOrder[idx])) ? YSTRUE : YSFALSE);
+	};
+
+	for(int p=0; p<NUM_PARTITION; ++p)
+	{
+		const auto &pt=part[p];
+		if(0==pt.entry.GetN() || YSTRUE==IsExcludedPartition(p,filter.excludeIff))
+		{
+			continue;
+		}
+
+		int cx,cz;
+		pt.GetCellIndex(cx,cz,pos);
+		const int maxRing=YsGreater(YsGreater(cx,pt.nx-1-cx),YsGreater(cz,pt.nz-1-cz));
+		for(int d=0; d<=maxRing; ++d)
+		{
+			if(k<=bestSqDist.GetN())
+			{
+				const double lb=pt.RingDistanceLowerBound(d);
+				if(bestSqDist.Last()<lb*lb)
+				{
+					break;
+				}
+			}
+
+			for(int iz=cz-d; iz<=cz+d; ++iz)
+			{
+				if(iz<0 || pt.nz<=iz)
+				{
+					continue;
+				}
+				const int step=((iz==cz-d || iz==cz+d) ? 1 : 2*d);
+				for(int ix=cx-d; ix<=cx+d; ix+=YsGreater(1,step))
+				{
+					if(ix<0 || pt.nx<=ix)
+					{
+						continue;
+					}
+
+					const int cellIdx=iz*pt.nx+ix;
+					for(int i=pt.cellStart[cellIdx]; i<pt.cellStart[cellIdx+1]; ++i)
+					{
+						const auto &e=pt.entry[i];
+						const double sqDist=(e.pos-pos).GetSquareLength();
+						if(k<=bestSqDist.GetN() && YSTRUE!=isBetter(sqDist,e.order,bestSqDist.GetN()-1))
+						{
+							continue;
+						}
+						if(YSTRUE!=PassFilter(e,filter,pos))
+						{
+							continue;
+						}
+
+						YSSIZE_T insertAt=bestSqDist.GetN();
+						while(0<insertAt && YSTRUE==isBetter(sqDist,e.order,insertAt-1))
+						{
+							--insertAt;
+						}
+						bestSqDist.Insert(insertAt,sqDist);
+						bestOrder.Insert(insertAt,e.order);
+						can.Insert(insertAt,GetObj(e));
+						if(k<bestSqDist.GetN())
+						{
+							bestSqDist.DeleteLast();
+							bestOrder.DeleteLast();
+							can.DeleteLast();
+						}
+					}
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,156 @@
+#ifndef FSSENSORINDEX_IS_INCLUDED
+#define FSSENSORINDEX_IS_INCLUDED
+/* { */
+
+#include <ysclass.h>
+#include "fsdef.h"
+
+class FsAirplane;
+class FsGround;
+class FsSimulation;
+
+/*! Airplanes and ground objects partitioned by IFF for the target search.
+
+    Made once per control tick after the autopilots that cannot decide in parallel, and valid until the end of
+    SimControlByComputer.  Positions do not change in the meantime.
+    Each IFF has its own grid on the XZ plane, and a query only visits the partitions of the IFFs it is looking for,
+    and the cells that may include an object within the range.
+
+    The queries return the objects in the order of the airplane list or the ground list, so that a caller that picks
+    the best of the candidates with the strict comparison picks the same object as scanning the whole list.
+    The filters only reject the objects that the caller would reject, therefore the caller may keep its own tests.
+*/
+class FsSensorIndex
+{
+public:
+	enum
+	{
+		NUM_PARTITION=FS_IFF_NEUTRAL+2,   // FS_IFF0 to FS_IFF_NEUTRAL, and the last one for the other IFFs.
+		MIN_CELL_SIZE=500,
+		MAX_CELL_PER_PARTITION=64*64
+	};
+
+	class AirFilter
+	{
+	public:
+		int excludeIff;              // Skip the airplanes of this IFF.  -1 to take all IFFs.
+		YSBOOL aliveOnly;            // Skip if FsAirplane::IsAlive is YSFALSE.
+		YSBOOL activeOnly;           // Skip if FsAirplaneProperty::IsActive is YSFALSE.
+		YSBOOL flyingOnly;           // Skip if FsAirplaneProperty::IsOnGround is YSTRUE.
+		YSBOOL skipDontAttackIfGroundStatic;  // Skip if FSAIRFLAG_DONTATTACKIFGROUNDSTATIC and FSGROUNDSTATIC.
+		YSBOOL useRadarAltLimit;     // Same as FsAirplane::LockOn.  Skip a target lower than the sensor and
+		double radarAltLimit;        // radarAltLimit+1000*(1-RCS) unless it is within 1km.
+		YSBOOL scaleRangeByRcs;      // Range of the query is multiplied by the radar cross section of the target.
+
+		AirFilter();
+	};
+
+	class GndFilter
+	{
+	public:
+		int excludeIff;              // Skip the ground objects of this IFF.  -1 to take all IFFs.
+		YSBOOL aliveOnly;            // Skip if FsGroundProperty::IsAlive is YSFALSE.
+		YSBOOL skipNonGameObject;    // Skip if FsGroundProperty::IsNonGameObject is YSTRUE.
+		YSBOOL primaryTargetOnly;    // Skip if FsGround::primaryTarget is not YSTRUE.
+		YSBOOL tankOrShipOnly;       // Skip if the type is not FSTANK or FSNAVYSHIP.
+
+		GndFilter();
+	};
+
+private:
+	class AirEntry
+	{
+	public:
+		FsAirplane *air;
+		int order;
+		YsVec3 pos;
+		double rcs;
+		YSBOOL isAlive,isActive,isOnGround,dontAttack;
+	};
+	class GndEntry
+	{
+	public:
+		FsGround *gnd;
+		int order;
+		YsVec3 pos;
+		YSBOOL isAlive,isNonGameObject,isPrimaryTarget,isTankOrShip;
+	};
+
+	/*! Entries sorted by cell.  Entries of cell (ix,iz) are entry[cellStart[iz*nx+ix]] to entry[cellStart[iz*nx+ix+1]-1]. */
+	template <class EntryType>
+	class Partition
+	{
+	public:
+		YsArray <EntryType> entry;
+		YsArray <int> cellStart;
+		YsVec2 min;
+		double cellSize;
+		int nx,nz;
+
+		void Clear(void);
+		void MakeGrid(void);
+		void GetCellIndex(int &ix,int &iz,const YsVec3 &pos) const;
+		/*! Lower bound of the distance from pos to an object in the cells of the ring at d (Chebyshev distance) from
+		    the cell of pos. */
+		double RingDistanceLowerBound(int d) const;
+	};
+
+	YSBOOL valid;
+	Partition <AirEntry> air[NUM_PARTITION];
+	Partition <GndEntry> gnd[NUM_PARTITION];
+	double maxRcs;
+
+public:
+	FsSensorIndex();
+	void CleanUp(void);
+
+	/*! Takes the state of all the airplanes and ground objects in the simulation. */
+	void Make(const FsSimulation *sim);
+
+	/*! Marks the index out of date, but keeps the memory for the next Make. */
+	void Invalidate(void);
+
+	YSBOOL IsValid(void) const;
+
+	/*! Airplanes within range from pos and within halfAngle from dir.  dir does not have to be a unit vector.
+	    Give a negative range for no limit.  The result is in the order of the airplane list. */
+	void GetAirInCone(
+	    YsArray <FsAirplane *,64> &can,const YsVec3 &pos,const YsVec3 &dir,const double halfAngle,const double range,
+	    const AirFilter &filter) const;
+
+	/*! Ground objects within range from pos and within halfAngle from dir.  Same as GetAirInCone. */
+	void GetGndInCone(
+	    YsArray <FsGround *,64> &can,const YsVec3 &pos,const YsVec3 &dir,const double halfAngle,const double range,
+	    const GndFilter &filter) const;
+
+	/*! Up to k airplanes nearest to pos, from the nearest.  The one earlier in the airplane list comes first among
+	    the ones at the same distance. */
+	void GetKNearestAir(YsArray <FsAirplane *,64> &can,const YsVec3 &pos,int k,const AirFilter &filter) const;
+
+	/*! Up to k ground objects nearest to pos.  Same as GetKNearestAir. */
+	void GetKNearestGnd(YsArray <FsGround *,64> &can,const YsVec3 &pos,int k,const GndFilter &filter) const;
+
+private:
+	static int GetPartition(int iff);
+	static YSBOOL IsExcludedPartition(int partition,int excludeIff);
+	YSBOOL PassFilter(const AirEntry &e,const AirFilter &filter,const YsVec3 &pos) const;
+	YSBOOL PassFilter(const GndEntry &e,const GndFilter &filter,const YsVec3 &pos) const;
+	static double GetRangeScale(const AirEntry &e,const AirFilter &filter);
+	static double GetRangeScale(const GndEntry &e,const GndFilter &filter);
+	double GetMaxRangeScale(const AirFilter &filter) const;
+	double GetMaxRangeScale(const GndFilter &filter) const;
+
+	template <class EntryType,class ObjType,class FilterType>
+	void GetInCone(
+	    YsArray <ObjType *,64> &can,const Partition <EntryType> part[],
+	    const YsVec3 &pos,const YsVec3 &dir,const double halfAngle,const double range,const FilterType &filter) const;
+	template <class EntryType,class ObjType,class FilterType>
+	void GetKNearest(
+	    YsArray <ObjType *,64> &can,const Partition <EntryType> part[],const YsVec3 &pos,int k,const FilterType &filter) const;
+
+	static FsAirplane *GetObj(const AirEntry &e);
+	static FsGround *GetObj(const GndEntry &e);
+};
+
+/* } */
+#endif
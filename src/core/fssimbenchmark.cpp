@@ -0,0 +1,621 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+
+#include <ysclass.h>
+
+#include "fs.h"
+#include "fssimbenchmark.h"
+
+
+
+FsSimulationBenchmark::Setting::Setting()
+{
+	scenario=SCENARIO_DOGFIGHT;
+	fldName.Set("ATSUGI_AIRBASE");
+	nAir=16;
+	nGnd=0;
+	simTime=60.0;
+	stepTime=0.025;   // Same as the physics step of SimulateOneStep.  One call makes one move and one control tick.
+	seed=12345;
+	record=YSTRUE;
+}
+
+////////////////////////////////////////////////////////////
+
+FsSimulationBenchmark::FsSimulationBenchmark()
+{
+	result.nStep=0;
+	result.wallNanosec=0;
+	result.nAirSpawned=0;
+	result.nAirAlive=0;
+	result.nGndAlive=0;
+	nFriendly=0;
+	nextSpawnTime=0.0;
+	nextFlareTime=0.0;
+}
+
+/* static */ FsSimulationBenchmark::SCENARIO FsSimulationBenchmark::StrToScenario(const char str[])
+{
+	for(int i=0; i<(int)SCENARIO_UNKNOWN; ++i)
+	{
+		if(0==strcmp(str,ScenarioToStr((SCENARIO)i)))
+		{
+			return (SCENARIO)i;
+		}
+	}
+	return SCENARIO_UNKNOWN;
+}
+
+/* static */ const char *FsSimulationBenchmark::ScenarioToStr(SCENARIO scenario)
+{
+	switch(scenario)
+	{
+	case SCENARIO_DOGFIGHT:
+		return "dogfight";
+	case SCENARIO_ENDURANCE:
+		return "endurance";
+	case SCENARIO_AIRSHOW:
+		return "airshow";
+	case SCENARIO_FLARESTORM:
+		return "flarestorm";
+	case SCENARIO_STRIKE:
+		return "strike";
+	default:
+		break;
+	}
+	return "unknown";
+}
+
+YSRESULT FsSimulationBenchmark::SetUp(FsWorld *world,const Setting &setting)
+{
+	this->setting=setting;
+	result.nStep=0;
+	result.wallNanosec=0;
+	result.nAirSpawned=0;
+	result.nAirAlive=0;
+	result.nGndAlive=0;
+	result.phaseTimer.CleanUp();
+
+	srand(setting.seed);
+
+	world->TerminateSimulation();
+	world->PrepareSimulation();
+
+	// No field objects and no field airplanes so that the numbers of objects are exactly nAir and nGnd.
+	if(NULL==world->AddField(NULL,setting.fldName,YsOrigin(),YsZeroAtt(),YSFALSE,YSFALSE))
+	{
+		return YSERR;
+	}
+
+	FsSimulation *sim=world->GetSimulation();
+
+	YsVec3 bbx[2];
+	sim->GetField()->GetBoundingBox(bbx[0],bbx[1]);
+	YsVec3 cen=(bbx[0]+bbx[1])/2.0;
+	double elv;
+	sim->GetField()->GetFieldElevation(elv,cen.x(),cen.z());
+	cen.SetY(elv);
+
+	YSRESULT res=YSERR;
+	switch(setting.scenario)
+	{
+	case SCENARIO_DOGFIGHT:
+		res=SetUpDogfight(world,sim,cen);
+		break;
+	case SCENARIO_ENDURANCE:
+		res=SetUpEndurance(world,sim,cen);
+		break;
+	case SCENARIO_AIRSHOW:
+		res=SetUpAirshow(world,sim,cen);
+		break;
+	case SCENARIO_FLARESTORM:
+		res=SetUpDogfight(world,sim,cen);
+		if(YSOK==res)
+		{
+			for(FsAirplane *air=NULL; NULL!=(air=sim->FindNextAirplane(air)); )
+			{
+				air->SendCommand("LOADWEPN AIM9 4");
+			}
+			nextFlareTime=0.0;
+		}
+		break;
+	case SCENARIO_STRIKE:
+		res=SetUpStrike(world,sim,cen);
+		break;
+	default:
+		break;
+	}
+	if(YSOK!=res || YSOK!=SetUpGround(world,sim,cen))
+	{
+		world->TerminateSimulation();
+		return YSERR;
+	}
+
+	sim->PrepareRunSimulation();
+	return YSOK;
+}
+
+YSRESULT FsSimulationBenchmark::Run(FsWorld *world)
+{
+	FsSimulation *sim=world->GetSimulation();
+	if(NULL==sim)
+	{
+		return YSERR;
+	}
+
+	result.phaseTimer.CleanUp();
+	sim->SetPhaseTimer(&result.phaseTimer);
+
+	const long long int nStep=(long long int)(setting.simTime/setting.stepTime+0.5);
+	for(long long int step=0; step<nStep; ++step)
+	{
+		if(SCENARIO_ENDURANCE==setting.scenario && nextSpawnTime<=sim->GetClock())
+		{
+			SpawnEnduranceEnemy(world,sim);
+			nextSpawnTime=sim->GetClock()+1.0;
+		}
+		if(SCENARIO_FLARESTORM==setting.scenario && nextFlareTime<=sim->GetClock())
+		{
+			DispenseFlareStorm(sim);
+			nextFlareTime=sim->GetClock()+0.5;
+		}
+
+		auto t0=std::chrono::steady_clock::now();
+		world->SimulateOneStep(setting.stepTime,YSTRUE,setting.record,YSFALSE,YSFALSE,FSUSC_DISABLE,YSFALSE);
+		auto t1=std::chrono::steady_clock::now();
+		result.wallNanosec+=(long long int)std::chrono::duration_cast<std::chrono::nanoseconds>(t1-t0).count();
+		++result.nStep;
+	}
+
+	sim->SetPhaseTimer(nullptr);
+
+	result.nAirAlive=0;
+	for(FsAirplane *air=NULL; NULL!=(air=sim->FindNextAirplane(air)); )
+	{
+		if(YSTRUE==air->IsAlive())
+		{
+			++result.nAirAlive;
+		}
+	}
+	result.nGndAlive=0;
+	for(FsGround *gnd=NULL; NULL!=(gnd=sim->FindNextGround(gnd)); )
+	{
+		if(YSTRUE==gnd->IsAlive())
+		{
+			++result.nGndAlive;
+		}
+	}
+
+	sim->AfterSimulation();
+	world->TerminateSimulation();
+	return YSOK;
+}
+
+const FsSimulationBenchmark::Result &FsSimulationBenchmark::GetResult(void) const
+{
+	return result;
+}
+
+// Escapes a string value of the JSON output.  The field name comes from the command line and may have anything.
+static YsString FsSimulationBenchmarkEscapeJson(const char str[])
+{
+	YsString escaped;
+	for(int i=0; 0!=str[i]; ++i)
+	{
+		const unsigned char c=(unsigned char)str[i];
+		if('\"'==c || '\\'==c)
+		{
+			escaped.Append('\\');
+			escaped.Append((char)c);
+		}
+		else if('\n'==c)
+		{
+			escaped.Append("\\n");
+		}
+		else if('\r'==c)
+		{
+			escaped.Append("\\r");
+		}
+		else if('\t'==c)
+		{
+			escaped.Append("\\t");
+		}
+		else if(c<0x20)
+		{
+			char hex[8];
+			sprintf(hex,"\\u%04x",(int)c);
+			escaped.Append(hex);
+		}
+		else
+		{
+			escaped.Append((char)c);
+		}
+	}
+	return escaped;
+}
+
+void FsSimulationBenchmark::WriteJson(FILE *fp) const
+{
+	auto sec=[](long long int nanosec)
+	{
+		return (double)nanosec/1000000000.0;
+	};
+	auto usec=[](long long int nanosec)
+	{
+		return (double)nanosec/1000.0;
+	};
+
+	const double wallTime=sec(result.wallNanosec);
+
+	fprintf(fp,"{\n");
+	fprintf(fp,"  \"benchmark\": \"simulation\",\n");
+	fprintf(fp,"  \"scenario\": \"%s\",\n",FsSimulationBenchmarkEscapeJson(ScenarioToStr(setting.scenario)).Txt());
+	fprintf(fp,"  \"field\": \"%s\",\n",FsSimulationBenchmarkEscapeJson(setting.fldName).Txt());
+	fprintf(fp,"  \"seed\": %u,\n",setting.seed);
+	fprintf(fp,"  \"numAirplane\": %d,\n",setting.nAir);
+	fprintf(fp,"  \"numGround\": %d,\n",setting.nGnd);
+	fprintf(fp,"  \"record\": %s,\n",(YSTRUE==setting.record ? "true" : "false"));
+	fprintf(fp,"  \"stepTime\": %.6lf,\n",setting.stepTime);
+	fprintf(fp,"  \"simulatedTime\": %.6lf,\n",setting.stepTime*(double)result.nStep);
+	fprintf(fp,"  \"numStep\": %lld,\n",result.nStep);
+	fprintf(fp,"  \"wallTime\": %.6lf,\n",wallTime);
+	fprintf(fp,"  \"stepPerSecond\": %.3lf,\n",(0.0<wallTime ? (double)result.nStep/wallTime : 0.0));
+	fprintf(fp,"  \"realTimeFactor\": %.3lf,\n",(0.0<wallTime ? setting.stepTime*(double)result.nStep/wallTime : 0.0));
+	fprintf(fp,"  \"numAirplaneSpawned\": %lld,\n",result.nAirSpawned);
+	fprintf(fp,"  \"numAirplaneAlive\": %d,\n",result.nAirAlive);
+	fprintf(fp,"  \"numGroundAlive\": %d,\n",result.nGndAlive);
+	fprintf(fp,"  \"phase\": [\n");
+	for(int i=0; i<(int)FsSimulationPhaseTimer::NUM_PHASE; ++i)
+	{
+		const auto phase=(FsSimulationPhaseTimer::PHASE)i;
+		const auto &accum=result.phaseTimer.Get(phase);
+		fprintf(fp,"    {\"name\": \"%s\", \"calls\": %lld, \"totalTime\": %.6lf, \"usecPerStep\": %.3lf, \"maxUsec\": %.3lf}%s\n",
+		    FsSimulationBenchmarkEscapeJson(FsSimulationPhaseTimer::GetPhaseName(phase)).Txt(),
+		    accum.nCall,
+		    sec(accum.totalNanosec),
+		    (0<result.nStep ? usec(accum.totalNanosec)/(double)result.nStep : 0.0),
+		    usec(accum.maxNanosec),
+		    (i+1<(int)FsSimulationPhaseTimer::NUM_PHASE ? "," : ""));
+	}
+	fprintf(fp,"  ]\n");
+	fprintf(fp,"}\n");
+}
+
+FsAirplane *FsSimulationBenchmark::AddFighter(FsWorld *world,const YsArray <const char *> &fighter,int iff,const double &gLimit)
+{
+	FsAirplane *air=world->AddAirplane(fighter[rand()%fighter.GetN()],YSFALSE);
+	if(NULL!=air)
+	{
+		air->iff=(FSIFF)iff;
+
+		FsDogfight *df=FsDogfight::Create();
+		df->gLimit=gLimit;
+		df->minAlt=1000.0;
+		air->SetAutopilot(df);
+		air->gLimit=gLimit;
+
+		air->SendCommand("UNLOADWP");
+		air->SendCommand("LOADWEPN AIM9 2");
+		air->SendCommand("CTLLDGEA FALSE");
+		air->SendCommand("INITFUEL 100%");
+
+		++result.nAirSpawned;
+	}
+	return air;
+}
+
+static void FsSimulationBenchmarkGetFighterList(YsArray <const char *> &fighter,FsWorld *world)
+{
+	int nFig;
+	char *fig[256];
+	fighter.Clear();
+	if(YSOK==world->GetFighterList(nFig,fig,256))
+	{
+		for(int i=0; i<nFig; ++i)
+		{
+			fighter.Append(fig[i]);
+		}
+	}
+}
+
+YSRESULT FsSimulationBenchmark::SetUpDogfight(FsWorld *world,FsSimulation *,const YsVec3 &cen)
+{
+	YsArray <const char *> fighter;
+	FsSimulationBenchmarkGetFighterList(fighter,world);
+	if(0==fighter.GetN())
+	{
+		return YSERR;
+	}
+
+	// Two teams 10km apart head-on, in columns of eight 200m apart.
+	const int nPerRow=8;
+	for(int i=0; i<setting.nAir; ++i)
+	{
+		const int team=i%2,idx=i/2;
+		FsAirplane *air=AddFighter(world,fighter,(0==team ? FS_IFF0 : FS_IFF1),(0==team ? 7.0 : 8.0));
+		if(NULL==air)
+		{
+			return YSERR;
+		}
+
+		const double x=200.0*(double)(idx%nPerRow-nPerRow/2);
+		const double y=3000.0+150.0*(double)(idx/nPerRow);
+		const YsAtt3 att((0==team ? 0.0 : YsPi),0.0,0.0);
+		const YsVec3 pos=cen+YsVec3(x,y,(0==team ? -5000.0 : 5000.0));
+
+		air->Prop().SetPosition(pos);
+		air->Prop().SetAttitude(att);
+		air->Prop().SetVelocity(att.GetForwardVector()*200.0);
+	}
+	return YSOK;
+}
+
+YSRESULT FsSimulationBenchmark::SetUpEndurance(FsWorld *world,FsSimulation *sim,const YsVec3 &cen)
+{
+	YsArray <const char *> fighter;
+	FsSimulationBenchmarkGetFighterList(fighter,world);
+	if(0==fighter.GetN() || 2>setting.nAir)
+	{
+		return YSERR;
+	}
+
+	nFriendly=YsGreater(1,setting.nAir/4);
+	for(int i=0; i<nFriendly; ++i)
+	{
+		FsAirplane *air=AddFighter(world,fighter,FS_IFF0,9.0);
+		if(NULL==air)
+		{
+			return YSERR;
+		}
+		const YsVec3 pos=cen+YsVec3(200.0*(double)i,3000.0,0.0);
+		air->Prop().SetPosition(pos);
+		air->Prop().SetAttitude(YsZeroAtt());
+		air->Prop().SetVelocity(YsVec3(0.0,0.0,200.0));
+	}
+
+	nextSpawnTime=0.0;
+	SpawnEnduranceEnemy(world,sim);
+	nextSpawnTime=1.0;
+	return YSOK;
+}
+
+void FsSimulationBenchmark::SpawnEnduranceEnemy(FsWorld *world,FsSimulation *sim)
+{
+	// Same as FsSimulation::GenerateEnemyAirplane, but the number of the enemies is not limited to five.
+	YsVec3 refPos=YsOrigin();
+	int nEnemy=0;
+	YSBOOL friendlyExist=YSFALSE;
+	for(FsAirplane *air=NULL; NULL!=(air=sim->FindNextAirplane(air)); )
+	{
+		if(YSTRUE==air->Prop().IsActive())
+		{
+			if(FS_IFF3==air->iff)
+			{
+				++nEnemy;
+			}
+			else if(YSTRUE!=friendlyExist)
+			{
+				refPos=air->GetPosition();
+				friendlyExist=YSTRUE;
+			}
+		}
+	}
+	if(YSTRUE!=friendlyExist)
+	{
+		return;
+	}
+
+	YsArray <const char *> fighter;
+	FsSimulationBenchmarkGetFighterList(fighter,world);
+
+	double radial=YsDegToRad((double)(rand()%360));
+	for(int i=nEnemy; i<setting.nAir-nFriendly; ++i)
+	{
+		FsAirplane *air=AddFighter(world,fighter,FS_IFF3,7.5);
+		if(NULL!=air)
+		{
+			const YsVec3 dif(8000.0*sin(radial),0.0,8000.0*cos(radial));
+			YsVec3 pos=refPos+dif;
+			pos.SetY(refPos.y());
+
+			YsVec3 vel=-dif;
+			vel.Normalize();
+			vel*=200.0;
+
+			air->Prop().SetPosition(pos);
+			air->Prop().SetVelocity(vel);
+			air->airFlag=FSAIRFLAG_AUTOGENERATED;
+		}
+		radial+=YsDegToRad(10.0);
+	}
+}
+
+void FsSimulationBenchmark::DispenseFlareStorm(FsSimulation *sim)
+{
+	// Same flare as FsAirplaneProperty::FireWeapon dispenses.  Not recorded so that Recording measures the same thing.
+	for(FsAirplane *air=NULL; NULL!=(air=sim->FindNextAirplane(air)); )
+	{
+		if(YSTRUE==air->IsAlive())
+		{
+			YsVec3 vel;
+			air->Prop().GetVelocity(vel);
+			sim->GetWeaponStore().DispenseFlare(sim->GetClock(),air->GetPosition(),vel,120.0,1000.0,air,YSFALSE,YSFALSE);
+		}
+	}
+}
+
+YSRESULT FsSimulationBenchmark::SetUpAirshow(FsWorld *world,FsSimulation *,const YsVec3 &cen)
+{
+	YsArray <const char *> fighter;
+	FsSimulationBenchmarkGetFighterList(fighter,world);
+	if(0==fighter.GetN())
+	{
+		return YSERR;
+	}
+
+	// Delta loop of FsWorld::PrepareAcrobat.  Groups of six, 1.5km apart.
+	const int nGroupPerRow=8;
+	for(int group=0; group*6<setting.nAir; ++group)
+	{
+		const char *airType=fighter[rand()%fighter.GetN()];
+		const YsVec3 startPos=cen+YsVec3(1500.0*(double)(group%nGroupPerRow),1000.0,3000.0*(double)(group/nGroupPerRow));
+		const YsAtt3 startAtt=YsZeroAtt();
+
+		FsAirplane *leader=NULL;
+		for(int i=1; i<=6 && group*6+i<=setting.nAir; ++i)
+		{
+			FsAirplane *air=world->AddAirplane(airType,YSFALSE);
+			if(NULL==air)
+			{
+				return YSERR;
+			}
+			++result.nAirSpawned;
+
+			air->iff=FS_IFF0;
+			air->Prop().UnloadAllWeapon();
+			air->Prop().SendCommand("CTLLDGEA FALSE");
+
+			const double speed=(YSTRUE==air->Prop().IsJet() ? 140.0 : 70.0);
+			YsVec3 pos=startPos;
+			if(1==i)
+			{
+				leader=air;
+
+				FsAirshowControl *ap=FsAirshowControl::Create();
+				ap->action=FsAirshowControl::LOOP;
+				ap->waitTimer=2.0;
+				ap->fomPosition=1;
+				ap->loopG=4.0;
+				air->SetAutopilot(ap);
+			}
+			else
+			{
+				YsVec3 newpos;
+				FsAirshowControl::GetDeltaPosition(newpos,i,leader->GetRadiusFromCollision()*0.85);
+
+				FsFormation *fom=FsFormation::Create();
+				fom->leader=leader;
+				fom->synchronizeTrigger=YSTRUE;
+				fom->shouldBe=newpos;
+				air->SetAutopilot(fom);
+
+				startAtt.Mul(newpos,newpos);
+				pos+=newpos;
+			}
+
+			air->Prop().SetPosition(pos);
+			air->Prop().SetAttitude(startAtt);
+			air->Prop().SetVelocity(startAtt.GetForwardVector()*speed);
+		}
+	}
+	return YSOK;
+}
+
+YSRESULT FsSimulationBenchmark::SetUpStrike(FsWorld *world,FsSimulation *,const YsVec3 &cen)
+{
+	YsArray <const char *> fighter;
+	FsSimulationBenchmarkGetFighterList(fighter,world);
+	if(0==fighter.GetN())
+	{
+		return YSERR;
+	}
+
+	// Columns of eight 300m apart, 20km south of the sites, heading north.
+	const int nPerRow=8;
+	for(int i=0; i<setting.nAir; ++i)
+	{
+		FsAirplane *air=world->AddAirplane(fighter[rand()%fighter.GetN()],YSFALSE);
+		if(NULL==air)
+		{
+			return YSERR;
+		}
+		air->iff=FS_IFF0;
+		air->SetAutopilot(FsGroundAttack::Create());
+
+		air->SendCommand("UNLOADWP");
+		air->SendCommand("LOADWEPN AGM65 4");
+		air->SendCommand("CTLLDGEA FALSE");
+		air->SendCommand("INITFUEL 100%");
+		++result.nAirSpawned;
+
+		const double x=300.0*(double)(i%nPerRow-nPerRow/2);
+		const double y=3000.0+150.0*(double)(i/nPerRow);
+		const YsVec3 pos=cen+YsVec3(x,y,-20000.0);
+
+		air->Prop().SetPosition(pos);
+		air->Prop().SetAttitude(YsZeroAtt());
+		air->Prop().SetVelocity(YsZeroAtt().GetForwardVector()*200.0);
+	}
+	return YSOK;
+}
+
+YSRESULT FsSimulationBenchmark::SetUpGround(FsWorld *world,FsSimulation *sim,const YsVec3 &cen)
+{
+	if(0>=setting.nGnd)
+	{
+		return YSOK;
+	}
+
+	// Land units with a SAM or AAA are preferred so that the ground-to-air code runs.
+	YsArray <const char *> armed,land;
+	const FSGROUNDTYPE landType[]={FSSTATIC,FSVEHICLE,FSTANK};
+	for(auto type : landType)
+	{
+		YsArray <const char *> gndName;
+		world->GetGroundListByType(gndName,type);
+		for(auto name : gndName)
+		{
+			const FsGroundTemplate *tmpl=world->GetGroundTemplate(name);
+			if(NULL!=tmpl && YSTRUE!=tmpl->isAircraftCarrier)
+			{
+				land.Append(name);
+				if(0.0<tmpl->prop.GetSAMRange() || 0.0<tmpl->prop.GetAAARange())
+				{
+					armed.Append(name);
+				}
+			}
+		}
+	}
+	const YsArray <const char *> &candidate=(0<armed.GetN() ? armed : land);
+	if(0==candidate.GetN())
+	{
+		return YSERR;
+	}
+
+	// Square grid 800m apart around the center of the field.
+	int nPerRow=1;
+	while(nPerRow*nPerRow<setting.nGnd)
+	{
+		++nPerRow;
+	}
+	for(int i=0; i<setting.nGnd; ++i)
+	{
+		FsGround *gnd=world->AddGround(candidate[i%candidate.GetN()],YSFALSE);
+		if(NULL==gnd)
+		{
+			return YSERR;
+		}
+
+		YsVec3 pos=cen+YsVec3(800.0*(double)(i%nPerRow-nPerRow/2),0.0,800.0*(double)(i/nPerRow-nPerRow/2));
+		double elv;
+		sim->GetField()->GetFieldElevation(elv,pos.x(),pos.z());
+		pos.SetY(elv);
+		world->SettleGround(*gnd,pos);
+		world->SettleGround(*gnd,YsZeroAtt());
+
+		if(SCENARIO_DOGFIGHT==setting.scenario || SCENARIO_FLARESTORM==setting.scenario)
+		{
+			gnd->iff=(0==i%2 ? FS_IFF0 : FS_IFF1);
+		}
+		else if(SCENARIO_STRIKE==setting.scenario)
+		{
+			gnd->iff=FS_IFF1;
+		}
+		else
+		{
+			gnd->iff=FS_IFF0;
+		}
+	}
+	return YSOK;
+}
@@ -0,0 +1,96 @@
+#ifndef FSSIMBENCHMARK_IS_INCLUDED
+#define FSSIMBENCHMARK_IS_INCLUDED
+/* { */
+
+#include <stdio.h>
+#include <ysclass.h>
+
+#include "fssimphasetimer.h"
+
+class FsWorld;
+class FsSimulation;
+
+/*! Headless simulation benchmark.
+
+    SetUp loads a field with no field objects, and spawns the given numbers of AI airplanes and ground units in a
+    scripted scenario.  Run calls FsWorld::SimulateOneStep with a fixed time step as fast as possible, with no drawing
+    and no real-time pacing, and measures the time of each phase of the step by FsSimulationPhaseTimer.
+    WriteJson writes the setting and the result in JSON so that the numbers can be compared across builds.
+
+    The scenario is seeded by Setting::seed, and runs the same way every time in the same build.
+*/
+class FsSimulationBenchmark
+{
+public:
+	enum SCENARIO
+	{
+		SCENARIO_DOGFIGHT,    // Two teams of fighters (IFF0 and IFF1) head-on.
+		SCENARIO_ENDURANCE,   // A few IFF0 fighters against IFF3 waves.  Shot-down airplanes are replaced every second.
+		SCENARIO_AIRSHOW,     // Delta-loop formations of six airplanes.  No weapons.
+		SCENARIO_FLARESTORM,  // Dogfight with more AIM-9s.  Every airplane dispenses a flare every half second.
+		SCENARIO_STRIKE,      // IFF0 ground attackers against the IFF1 SAM and AAA sites.
+
+		SCENARIO_UNKNOWN
+	};
+
+	class Setting
+	{
+	public:
+		SCENARIO scenario;
+		YsString fldName;
+		int nAir,nGnd;
+		double simTime;     // Simulated time in seconds
+		double stepTime;    // Time given to each SimulateOneStep
+		unsigned int seed;
+		YSBOOL record;
+
+		Setting();
+	};
+
+	class Result
+	{
+	public:
+		long long int nStep;
+		long long int wallNanosec;           // Total of SimulateOneStep only.  Set-up and re-spawn are excluded.
+		long long int nAirSpawned;
+		int nAirAlive,nGndAlive;
+		FsSimulationPhaseTimer phaseTimer;
+	};
+
+private:
+	Setting setting;
+	Result result;
+	int nFriendly;      // Endurance only
+	double nextSpawnTime;
+	double nextFlareTime;   // Flare storm only
+
+public:
+	FsSimulationBenchmark();
+
+	static SCENARIO StrToScenario(const char str[]);
+	static const char *ScenarioToStr(SCENARIO scenario);
+
+	/*! Terminates the current simulation of the world, and starts a new simulation with the given setting. */
+	YSRESULT SetUp(FsWorld *world,const Setting &setting);
+
+	/*! Runs the simulation set up by SetUp for setting.simTime seconds, and then terminates the simulation. */
+	YSRESULT Run(FsWorld *world);
+
+	const Result &GetResult(void) const;
+
+	void WriteJson(FILE *fp) const;
+
+private:
+	YSRESULT SetUpDogfight(FsWorld *world,FsSimulation *sim,const YsVec3 &cen);
+	YSRESULT SetUpEndurance(FsWorld *world,FsSimulation *sim,const YsVec3 &cen);
+	YSRESULT SetUpAirshow(FsWorld *world,FsSimulation *sim,const YsVec3 &cen);
+	YSRESULT SetUpStrike(FsWorld *world,FsSimulation *sim,const YsVec3 &cen);
+	YSRESULT SetUpGround(FsWorld *world,FsSimulation *sim,const YsVec3 &cen);
+
+	class FsAirplane *AddFighter(FsWorld *world,const YsArray <const char *> &fighter,int iff,const double &gLimit);
+	void SpawnEnduranceEnemy(FsWorld *world,FsSimulation *sim);
+	void DispenseFlareStorm(FsSimulation *sim);
+};
+
+/* } */
+#endif
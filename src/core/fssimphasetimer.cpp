@@ -0,0 +1,70 @@
+#include "fssimphasetimer.h"
+
+
+
+FsSimulationPhaseTimer::FsSimulationPhaseTimer()
+{
+	CleanUp();
+}
+
+void FsSimulationPhaseTimer::CleanUp(void)
+{
+	for(auto &a : accum)
+	{
+		a.nCall=0;
+		a.totalNanosec=0;
+		a.maxNanosec=0;
+	}
+}
+
+void FsSimulationPhaseTimer::Add(PHASE phase,long long int nanosec)
+{
+	auto &a=accum[phase];
+	++a.nCall;
+	a.totalNanosec+=nanosec;
+	if(a.maxNanosec<nanosec)
+	{
+		a.maxNanosec=nanosec;
+	}
+}
+
+const FsSimulationPhaseTimer::Accum &FsSimulationPhaseTimer::Get(PHASE phase) const
+{
+	return accum[phase];
+}
+
+/* static */ const char *FsSimulationPhaseTimer::GetPhaseName(PHASE phase)
+{
+	switch(phase)
+	{
+	case PHASE_STEP:
+		return "SimulateOneStep";
+	case PHASE_CACHEFIELDELEVATION:
+		return "SimCacheFieldElevation";
+	case PHASE_CACHERECTREGION:
+		return "SimCacheRectRegion";
+	case PHASE_AIRTOOBJCOLLISION:
+		return "SimComputeAirToObjCollision";
+	case PHASE_COLLISIONANDTERRAIN:
+		return "SimProcessCollisionAndTerrain";
+	case PHASE_BULLETHIT:
+		return "BulletHit";
+	case PHASE_MOVE:
+		return "SimMove";
+	case PHASE_BULLETMOVE:
+		return "BulletMove";
+	case PHASE_EXPLOSIONMOVE:
+		return "ExplosionMove";
+	case PHASE_WEAPONPLAYRECORD:
+		return "WeaponPlayRecord";
+	case PHASE_CONTROLBYCOMPUTER:
+		return "SimControlByComputer";
+	case PHASE_RECORD:
+		return "Recording";
+	case PHASE_BROADPHASEUPDATE:
+		return "BroadPhaseUpdate";
+	default:
+		break;
+	}
+	return "Unknown";
+}
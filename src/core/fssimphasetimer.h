@@ -0,0 +1,90 @@
+#ifndef FSSIMPHASETIMER_IS_INCLUDED
+#define FSSIMPHASETIMER_IS_INCLUDED
+/* { */
+
+#include <chrono>
+
+/*! Accumulates the wall-clock time spent in each phase of FsSimulation::SimulateOneStep.
+
+    A phase may be nested in another phase (e.g. PHASE_BULLETMOVE is in PHASE_MOVE), and the time of the outer phase
+    includes the time of the inner phase.  The phases that run in parallel (PHASE_CACHEFIELDELEVATION,
+    PHASE_CACHERECTREGION, and PHASE_AIRTOOBJCOLLISION) write to their own slots, therefore no lock is needed.
+*/
+class FsSimulationPhaseTimer
+{
+public:
+	enum PHASE
+	{
+		PHASE_STEP,                   // Entire SimulateOneStep
+		PHASE_CACHEFIELDELEVATION,    // SimCacheFieldElevation
+		PHASE_CACHERECTREGION,        // SimCacheRectRegion
+		PHASE_AIRTOOBJCOLLISION,      // SimComputeAirToObjCollision
+		PHASE_COLLISIONANDTERRAIN,    // SimProcessCollisionAndTerrain
+		PHASE_BULLETHIT,              // Bullet and missile hit check in SimProcessCollisionAndTerrain
+		PHASE_MOVE,                   // SimMove
+		PHASE_BULLETMOVE,             // Bullet and missile update in SimMove
+		PHASE_EXPLOSIONMOVE,          // Explosion and particle update in SimMove
+		PHASE_WEAPONPLAYRECORD,       // Bullet and explosion record playback
+		PHASE_CONTROLBYCOMPUTER,      // SimControlByComputer
+		PHASE_RECORD,                 // SimRecordAir and SimRecordGnd
+		PHASE_BROADPHASEUPDATE,       // FsBroadPhase::Update
+
+		NUM_PHASE
+	};
+
+	class Accum
+	{
+	public:
+		long long int nCall;
+		long long int totalNanosec;
+		long long int maxNanosec;
+	};
+
+	/*! Measures the time from the construction to the destruction, and adds it to the phase.
+	    Does nothing if the timer is nullptr.
+	*/
+	class Scope
+	{
+	private:
+		FsSimulationPhaseTimer *timer;
+		PHASE phase;
+		std::chrono::steady_clock::time_point t0;
+
+	public:
+		inline Scope(FsSimulationPhaseTimer *timer,PHASE phase)
+		{
+			this->timer=timer;
+			this->phase=phase;
+			if(nullptr!=timer)
+			{
+				t0=std::chrono::steady_clock::now();
+			}
+		}
+		inline ~Scope()
+		{
+			if(nullptr!=timer)
+			{
+				auto t1=std::chrono::steady_clock::now();
+				timer->Add(phase,(long long int)std::chrono::duration_cast<std::chrono::nanoseconds>(t1-t0).count());
+			}
+		}
+		Scope(const Scope &)=delete;
+		Scope &operator=(const Scope &)=delete;
+	};
+
+private:
+	Accum accum[NUM_PHASE];
+
+public:
+	FsSimulationPhaseTimer();
+	void CleanUp(void);
+
+	void Add(PHASE phase,long long int nanosec);
+	const Accum &Get(PHASE phase) const;
+
+	/*! Returns the name of the phase, which is the name of the function where possible. */
+	static const char *GetPhaseName(PHASE phase);
+};
+
+/* } */
+#endif
@@ -154,8 +154,11 @@ FsSimulation::FsSimulation(FsWorld *w) : airplaneList(FsAirplaneAllocator),groun
 	goal=new FsMissionGoal;
 	goal->SetIsActiveMission(YSFALSE);  // By default, FsSimulation doesn't have an active mission.
 	simEvent=new FsSimulationEventStore;
+	particleMan=new YsGLParticleManager;
+	particleMan->SetSortMethod(YsGLParticleManager::SORT_COHERENT);
 
 	airTrafficSequence=FsAirTrafficSequence::Create();
+	phaseTimer=nullptr;
 
 	// In-Game Message Bitmap >>
 	escTwiceToEnd=new YsBitmap;
@@ -202,7 +205,8 @@ FsSimulation::FsSimulation(FsWorld *w) : airplaneList(FsAirplaneAllocator),groun
 
 	tallestGroundObjectHeight=0.0;
 
-	ltc.SetUp(YsVec2(-20000.0,-20000.0),YsVec2(20000.0,20000.0),64,64);  // 64x2500m=160000 sq m
+	broadPhase.Initialize();
+	gndThreatIndex.CleanUp();
 
 	systemMessage[0]=0;
 
@@ -347,6 +351,7 @@ FsSimulation::~FsSimulation()
 	delete cloud;
 	delete goal;
 	delete simEvent;
+	delete particleMan;
 
 	delete localUser;
 
@@ -1072,9 +1077,10 @@ FsAirplane *FsSimulation::AddAirplane(FsAirplane &airplane,YSBOOL isPlayerPlane,
 		{
 			neo->dat.SetSearchKeyForNetworkSynchronizationPurpose(netSearchKey);
 		}
+		neo->dat.Prop().SetRandomSeed((unsigned int)FsExistence::GetSearchKey(&neo->dat));
 		airplaneSearch->AddElement(FsExistence::GetSearchKey(&neo->dat),&neo->dat);
 
-		ltc.Add(&neo->dat);
+		broadPhase.Add(&neo->dat);
 
 		return &neo->dat;
 	}
@@ -1136,7 +1142,7 @@ YSRESULT FsSimulation::DeleteAirplane(FsAirplane *air)
 
 
 
-		ltc.Delete(air);
+		broadPhase.Delete(air);
 
 
 
@@ -1179,7 +1185,8 @@ FsGround *FsSimulation::AddGround(FsGround &ground,YSBOOL isCarrier,const wchar_
 		neo->dat.SetProperty(ground.Prop()); // 2009/05/02  Why was the program working without it??
 
 
-		ltc.Add(&neo->dat);
+		broadPhase.Add(&neo->dat);
+		gndThreatIndex.Invalidate();
 
 		if(netSearchKey!=0)
 		{
@@ -1337,7 +1344,8 @@ YSRESULT FsSimulation::DeleteGround(FsGround *gnd)
 			}
 		}
 
-		ltc.Delete(gnd);
+		broadPhase.Delete(gnd);
+		gndThreatIndex.Invalidate();
 
 		gnd->CleanUp();  // coll is cleaned up in here.
 		groundList.Delete(gnd->thisInTheList);
@@ -1390,7 +1398,7 @@ FsField *FsSimulation::SetField(FsField &fld,const YsVec3 &pos,const YsAtt3 &att
 
 	fieldLoaded=YSTRUE;
 
-	RemakeLattice();
+	RemakeBroadPhase();
 
 	return &field;
 }
@@ -1447,24 +1455,24 @@ YSBOOL FsSimulation::SimTestCollision(const class FsVisualSrf &shl,const YsVec3
 	coll1.GetBoundingBox(bbx[0],bbx[1]);
 
 	YsArray <FsAirplane *,256> airCandidate;
-	GetLattice().GetAirCollisionCandidate(airCandidate,bbx[0],bbx[1]);
+	GetBroadPhase().GetAirCollisionCandidateInBox(airCandidate,bbx[0],bbx[1]);
 	for(int i=0; i<airCandidate.GetN(); i++)
 	{
 		FsAirplane *air2=airCandidate[i];
 		YsVec3 collPos;
-		if(YSTRUE==air2->IsAlive() && YSTRUE==CheckMidAir(collPos,coll1.Conv(),*air2))
+		if(YSTRUE==air2->IsAlive() && YSTRUE==CheckMidAir(collPos,coll1,*air2))
 		{
 			return YSTRUE;
 		}
 	}
 
 	YsArray <FsGround *,256> gndCandidate;
-	GetLattice().GetGndCollisionCandidate(gndCandidate,bbx[0],bbx[1]);
+	GetBroadPhase().GetGndCollisionCandidateInBox(gndCandidate,bbx[0],bbx[1]);
 	for(int i=0; i<gndCandidate.GetN(); i++)
 	{
 		FsGround *gnd2=gndCandidate[i];
 		YsVec3 collPos;
-		if(YSTRUE==gnd2->IsAlive() && YSTRUE==CheckMidAir(collPos,coll1.Conv(),*gnd2))
+		if(YSTRUE==gnd2->IsAlive() && YSTRUE==CheckMidAir(collPos,coll1,*gnd2))
 		{
 			return YSTRUE;
 		}
@@ -2259,6 +2267,15 @@ void FsSimulation::PrepareRunSimulation(void)
 
 	fsConsole.Printf("**** Preparing Simulation ****\n");
 
+	if(YSTRUE==cfgPtr->asyncTextureDecode)
+	{
+		FsCommonTexture::GetCommonTexture().StartAsyncTextureDecode();
+	}
+	if(YSTRUE==cfgPtr->asyncAirplaneModel)
+	{
+		world->SetUseStandInAirplaneModel(YSTRUE);
+	}
+
 	fsConsole.Printf("Setting Player Airplane.\n");
 
 	if(playerPlane!=NULL)
@@ -2516,6 +2533,8 @@ void FsSimulation::SimulateOneStep(
     YSBOOL demoMode,YSBOOL record,YSBOOL showTimer,YSBOOL networkStandby,FSUSERCONTROL userControl,
     YSBOOL showTimeMarker)
 {
+	FsSimulationPhaseTimer::Scope stepTimer(phaseTimer,FsSimulationPhaseTimer::PHASE_STEP);
+
 	#ifdef CRASHINVESTIGATION
 		printf("S0\n");
 	#endif
@@ -2526,6 +2545,8 @@ void FsSimulation::SimulateOneStep(
 		firstPlayer.SetObject(GetPlayerObject());
 	}
 
+	world->UpdateAirplaneModelStreaming(YSFALSE);
+
 
 	if(airTrafficSequence->GetNextUpdateTime()<currentTime)
 	{
@@ -2567,12 +2588,15 @@ void FsSimulation::SimulateOneStep(
 		#ifdef CRASHINVESTIGATION
 			printf("S2\n");
 		#endif
-			bulletHolder.PlayRecord(currentTime,dt);
+			{
+				FsSimulationPhaseTimer::Scope playRecordTimer(phaseTimer,FsSimulationPhaseTimer::PHASE_WEAPONPLAYRECORD);
+				bulletHolder.PlayRecord(currentTime,dt);
 
-		#ifdef CRASHINVESTIGATION
-			printf("S3\n");
-		#endif
-			explosionHolder.PlayRecord(currentTime,dt);
+			#ifdef CRASHINVESTIGATION
+				printf("S3\n");
+			#endif
+				explosionHolder.PlayRecord(currentTime,dt);
+			}
 
 
 			SimPlayTimedEvent(currentTime);
@@ -2606,6 +2630,7 @@ void FsSimulation::SimulateOneStep(
 		#endif
 			if(record==YSTRUE)
 			{
+				FsSimulationPhaseTimer::Scope recordTimer(phaseTimer,FsSimulationPhaseTimer::PHASE_RECORD);
 				if(currentTime>nextAirRecordTime)
 				{
 					SimRecordAir(currentTime,YSFALSE);
@@ -2741,7 +2766,12 @@ void FsSimulation::SimulateOneStep(
 	printf("S9\n");
 #endif
 
-	ltc.Update(this);
+	{
+		FsSimulationPhaseTimer::Scope broadPhaseTimer(phaseTimer,FsSimulationPhaseTimer::PHASE_BROADPHASEUPDATE);
+		broadPhase.Update(this);
+		gndThreatIndex.Update(this);
+		UpdateRoutePlannerThreat();
+	}
 
 #ifdef CRASHINVESTIGATION
 	printf("S-1\n");
@@ -2789,6 +2819,9 @@ void FsSimulation::AfterSimulation(void)
 	}
 	FsSplitMainWindow(YSFALSE);
 
+	FsCommonTexture::GetCommonTexture().EndAsyncTextureDecode();
+	world->SetUseStandInAirplaneModel(YSFALSE);
+
 	*weather=*iniWeather;
 }
 
@@ -3614,8 +3647,20 @@ void FsSimulation::AddEvent(const class FsSimulationEvent &evt)
 	simEvent->AddEvent(currentTime,evt);
 }
 
+static YSBOOL FsSimMoveIdentical(const YsVec3 &a,const YsVec3 &b)
+{
+	return (a.x()==b.x() && a.y()==b.y() && a.z()==b.z() ? YSTRUE : YSFALSE);
+}
+
+static YSBOOL FsSimMoveIdentical(const YsAtt3 &a,const YsAtt3 &b)
+{
+	return (a.h()==b.h() && a.p()==b.p() && a.b()==b.b() ? YSTRUE : YSFALSE);
+}
+
 void FsSimulation::SimMove(const double &dt)
 {
+	FsSimulationPhaseTimer::Scope moveTimer(phaseTimer,FsSimulationPhaseTimer::PHASE_MOVE);
+
 	int airId;
 	FsAirplane *airplane;
 	airplane=NULL;
@@ -3625,15 +3670,90 @@ void FsSimulation::SimMove(const double &dt)
 	printf("S1-1\n");
 #endif
 
+	// Parallel phase >>
+	// Prop().Move, SmartRudder, and RecordClimbRatio only change the aircraft itself.
+	// Aircraft near a carrier may load/unload themselves to/from the carrier, and are moved serially.
+	// Without PARALMOVE, each aircraft is moved in the serial phase right before its side effects, as it used to be.
+	YsArray <FsAirplane *> airArray;
+	YsArray <FsAirplane *> parallelAirArray,serialAirArray;
+	YsArray <YSBOOL> parallelIntegrateArray,serialIntegrateArray;
 	while((airplane=FindNextAirplane(airplane))!=NULL)
 	{
+		airArray.Append(airplane);
+		if(YSTRUE==cfgPtr->parallelSimMove)
+		{
+			const YSBOOL integrate=(airplane->isPlayingRecord!=YSTRUE && airplane->IsAlive()==YSTRUE ? YSTRUE : YSFALSE);
+			if(YSTRUE==integrate && YSTRUE==SimMayInteractWithAircraftCarrier(airplane,dt))
+			{
+				serialAirArray.Append(airplane);
+				serialIntegrateArray.Append(integrate);
+			}
+			else
+			{
+				parallelAirArray.Append(airplane);
+				parallelIntegrateArray.Append(integrate);
+			}
+		}
+	}
+
+	if(YSTRUE==cfgPtr->parallelSimMove)
+	{
+		YsArray <FsAirplaneProperty> serialResult;
+		if(YSTRUE==cfgPtr->checkParallelSimMove)
+		{
+			// Integrate serially first, keep the result, and then roll back.
+			YsArray <FsAirplaneProperty> savedProp;
+			savedProp.Set(parallelAirArray.GetN(),NULL);
+			serialResult.Set(parallelAirArray.GetN(),NULL);
+			for(YSSIZE_T idx=0; idx<parallelAirArray.GetN(); ++idx)
+			{
+				savedProp[idx]=parallelAirArray[idx]->Prop();
+				SimMoveAirplanePhysics(parallelAirArray[idx],dt,parallelIntegrateArray[idx]);
+				serialResult[idx]=parallelAirArray[idx]->Prop();
+				parallelAirArray[idx]->Prop()=savedProp[idx];
+			}
+		}
+
+		SimMoveAirplanePhysicsInParallel(parallelAirArray.GetN(),parallelAirArray,parallelIntegrateArray,dt);
+		SimMoveAirplanePhysicsRange(0,serialAirArray.GetN(),serialAirArray,serialIntegrateArray,dt);
+
+		if(YSTRUE==cfgPtr->checkParallelSimMove)
+		{
+			for(YSSIZE_T idx=0; idx<parallelAirArray.GetN(); ++idx)
+			{
+				const FsAirplaneProperty &prop=parallelAirArray[idx]->Prop();
+				const FsAirplaneProperty &ref=serialResult[idx];
+				YsVec3 vel,refVel;
+				prop.GetVelocity(vel);
+				ref.GetVelocity(refVel);
+				// Must be bit-identical.  YsVec3::operator== and YsAtt3::operator== allow tolerance.
+				if(YSTRUE!=FsSimMoveIdentical(prop.GetPosition(),ref.GetPosition()) ||
+				   YSTRUE!=FsSimMoveIdentical(prop.GetAttitude(),ref.GetAttitude()) ||
+				   YSTRUE!=FsSimMoveIdentical(vel,refVel) ||
+				   prop.GetFlightState()!=ref.GetFlightState())
+				{
+					printf("Parallel SimMove mismatch: %s (ysfId=%d) at %lf\n",
+					    prop.GetIdentifier(),parallelAirArray[idx]->ysfId,currentTime);
+				}
+			}
+		}
+	}
+	// Parallel phase <<
+
+	// Serial phase >>
+	for(YSSIZE_T airIdx=0; airIdx<airArray.GetN(); ++airIdx)
+	{
+		airplane=airArray[airIdx];
+
 #ifdef CRASHINVESTIGATION_S1_LEVEL2
 		printf("S1-2 %s\n",airplane->Prop().GetIdentifier());
 #endif
 
-		airplane->Prop().RecordClimbRatio(dt);
-		airplane->prevPos=airplane->GetPosition();
-		airplane->prevDt=dt;
+		if(YSTRUE!=cfgPtr->parallelSimMove)
+		{
+			const YSBOOL integrate=(airplane->isPlayingRecord!=YSTRUE && airplane->IsAlive()==YSTRUE ? YSTRUE : YSFALSE);
+			SimMoveAirplanePhysics(airplane,dt,integrate);
+		}
 
 		if(airplane->isPlayingRecord==YSTRUE)
 		{
@@ -3642,22 +3762,6 @@ void FsSimulation::SimMove(const double &dt)
 		}
 		else if(airplane->IsAlive()==YSTRUE)
 		{
-#ifdef CRASHINVESTIGATION_S1_LEVEL2
-		printf("S1-3\n");
-#endif
-			airplane->Prop().Move(dt,aircraftCarrierList,*weather);  // Elevation must be set in Prop() before this function.
-
-#ifdef CRASHINVESTIGATION_S1_LEVEL2
-		printf("S1-4\n");
-#endif
-
-			if(cfgPtr->autoCoordination==YSTRUE &&
-			   airplane->isPlayingRecord!=YSTRUE &&
-			   airplane->netType==FSNET_LOCAL)
-			{
-				airplane->Prop().SmartRudder(dt);
-			}
-
 #ifdef CRASHINVESTIGATION_S1_LEVEL2
 		printf("S1-5\n");
 #endif
@@ -3874,18 +3978,24 @@ void FsSimulation::SimMove(const double &dt)
 		printf("S1-20\n");
 #endif
 
-	bulletHolder.Move(dt,currentTime,*weather);
-	if(NULL!=GetPlayerGround() && NULL!=GetPlayerGround()->Prop().GetAirTarget())
 	{
-		FsExistence *target=GetPlayerGround()->Prop().GetAirTarget();
-		bulletHolder.CalculateBulletCalibrator(target);
+		FsSimulationPhaseTimer::Scope bulletTimer(phaseTimer,FsSimulationPhaseTimer::PHASE_BULLETMOVE);
+		bulletHolder.Move(dt,currentTime,*weather);
+		if(NULL!=GetPlayerGround() && NULL!=GetPlayerGround()->Prop().GetAirTarget())
+		{
+			FsExistence *target=GetPlayerGround()->Prop().GetAirTarget();
+			bulletHolder.CalculateBulletCalibrator(target);
+		}
+		else
+		{
+			bulletHolder.ClearBulletCalibrator();
+		}
 	}
-	else
 	{
-		bulletHolder.ClearBulletCalibrator();
+		FsSimulationPhaseTimer::Scope explosionTimer(phaseTimer,FsSimulationPhaseTimer::PHASE_EXPLOSIONMOVE);
+		explosionHolder.Move(dt);
+		particleStore.Move(dt,weather->GetWind());
 	}
-	explosionHolder.Move(dt);
-	particleStore.Move(dt,weather->GetWind());
 
 	weather->WeatherTransition(dt);
 	weather->UpdateRain(dt);
@@ -3958,6 +4068,78 @@ void FsSimulation::SimMove(const double &dt)
 #endif
 }
 
+void FsSimulation::SimMoveAirplanePhysics(FsAirplane *airplane,const double dt,YSBOOL integrate)
+{
+	airplane->Prop().RecordClimbRatio(dt);
+	airplane->prevPos=airplane->GetPosition();
+	airplane->prevDt=dt;
+
+	if(YSTRUE==integrate)
+	{
+#ifdef CRASHINVESTIGATION_S1_LEVEL2
+		printf("S1-3\n");
+#endif
+		airplane->Prop().Move(dt,aircraftCarrierList,*weather);  // Elevation must be set in Prop() before this function.
+
+#ifdef CRASHINVESTIGATION_S1_LEVEL2
+		printf("S1-4\n");
+#endif
+
+		if(cfgPtr->autoCoordination==YSTRUE &&
+		   airplane->isPlayingRecord!=YSTRUE &&
+		   airplane->netType==FSNET_LOCAL)
+		{
+			airplane->Prop().SmartRudder(dt);
+		}
+	}
+}
+
+void FsSimulation::SimMoveAirplanePhysicsRange(YSSIZE_T i0,YSSIZE_T i1,FsAirplane *const airArray[],const YSBOOL integrateArray[],const double dt)
+{
+	for(YSSIZE_T idx=i0; idx<i1; ++idx)
+	{
+		SimMoveAirplanePhysics(airArray[idx],dt,integrateArray[idx]);
+	}
+}
+
+void FsSimulation::SimMoveAirplanePhysicsInParallel(YSSIZE_T nAir,FsAirplane *const airArray[],const YSBOOL integrateArray[],const double dt)
+{
+	const YSSIZE_T nThread=(YSSIZE_T)threadPool.GetN();
+	if(nThread<=1 || nAir<2)
+	{
+		SimMoveAirplanePhysicsRange(0,nAir,airArray,integrateArray,dt);
+		return;
+	}
+
+	// A few chunks per thread so that a thread that finishes early can steal the rest.
+	const YSSIZE_T grainSize=YsGreater <YSSIZE_T> (1,nAir/(nThread*4));
+	threadPool.GetScheduler().ParallelFor(0,nAir,grainSize,[&](long long int i0,long long int i1)
+	{
+		SimMoveAirplanePhysicsRange(i0,i1,airArray,integrateArray,dt);
+	});
+}
+
+YSBOOL FsSimulation::SimMayInteractWithAircraftCarrier(const FsAirplane *air,const double dt) const
+{
+	if(NULL!=air->Prop().OnThisCarrier())
+	{
+		return YSTRUE;
+	}
+
+	// Conservative.  Twice the travel distance of both plus the bounding radii.
+	const double airTravel=air->Prop().GetVelocity()*dt;
+	for(auto carrier : aircraftCarrierList)
+	{
+		const double carrierTravel=carrier->Prop().GetVelocity()*dt;
+		const double r=carrier->GetApproximatedCollideRadius()+air->Prop().GetOutsideRadius()+2.0*(airTravel+carrierTravel);
+		if((carrier->GetPosition()-air->GetPosition()).GetSquareLength()<r*r)
+		{
+			return YSTRUE;
+		}
+	}
+	return YSFALSE;
+}
+
 void FsSimulation::SimCheckTailStrike(void)
 {
 	FsAirplane *air=NULL;
@@ -3994,6 +4176,8 @@ void FsSimulation::SimCheckTailStrike(void)
 
 void FsSimulation::SimCacheFieldElevation(void)
 {
+	FsSimulationPhaseTimer::Scope phaseScope(phaseTimer,FsSimulationPhaseTimer::PHASE_CACHEFIELDELEVATION);
+
 	int airId;
 
 	airId=0;
@@ -4036,16 +4220,20 @@ void FsSimulation::SimCacheFieldElevation(void)
 				airPtr->terrainOrg.Set(pos.x(),elv,pos.z());
 				airPtr->terrainNom=nom;
 
-				for(int i=0; i<airPtr->Prop().GetNumTire(); i++)
+				// Tires only need elevations.  Query them in one batch.
+				const int nTire=airPtr->Prop().GetNumTire();
+				YsArray <YsVec2,8> tireXz(nTire,NULL);
+				YsArray <double,8> tireElv(nTire,NULL);
+				for(int i=0; i<nTire; i++)
 				{
 					YsVec3 pos;
 					airPtr->Prop().GetMatrix().Mul(pos,airPtr->Prop().GetTirePosition(i),1.0);
-
-					YsVec3 nom;
-					double elv;
-					field.GetFieldElevationAndNormal(elv,nom,pos.x(),pos.z());
-
-					YsVec3 foot(pos.x(),elv,pos.z());
+					tireXz[i].Set(pos.x(),pos.z());
+				}
+				field.GetFieldElevationAndNormal(nTire,tireXz,tireElv,nullptr);
+				for(int i=0; i<nTire; i++)
+				{
+					YsVec3 foot(tireXz[i].x(),tireElv[i],tireXz[i].y());
 					airPtr->Prop().SetElevationAtTire(i,foot);
 				}
 			}
@@ -4065,6 +4253,8 @@ void FsSimulation::SimCacheFieldElevation(void)
 
 void FsSimulation::SimCacheRectRegion(void)
 {
+	FsSimulationPhaseTimer::Scope phaseScope(phaseTimer,FsSimulationPhaseTimer::PHASE_CACHERECTREGION);
+
 	for(FsAirplane *airPtr=NULL; NULL!=(airPtr=FindNextAirplane(airPtr)); )
 	{
 		if(YSTRUE==airPtr->IsAlive())
@@ -4133,6 +4323,8 @@ void FsSimulation::UpdateGroundTerrainElevationAndNormal(FsGround *gndPtr)
 
 void FsSimulation::SimComputeAirToObjCollision(void)
 {
+	FsSimulationPhaseTimer::Scope phaseScope(phaseTimer,FsSimulationPhaseTimer::PHASE_AIRTOOBJCOLLISION);
+
 	YsArray <FsAirplane *,256> airCandidate;
 	YsArray <FsGround *,256> gndCandidate;
 
@@ -4146,7 +4338,7 @@ void FsSimulation::SimComputeAirToObjCollision(void)
 	{
 		if(air1->IsAlive()==YSTRUE)
 		{
-			GetLattice().GetAirCollisionCandidate(airCandidate,air1);
+			GetBroadPhase().GetAirCollisionCandidate(airCandidate,air1);
 
 			for(int j=0; j<airCandidate.GetN(); j++)
 			{
@@ -4175,7 +4367,7 @@ void FsSimulation::SimComputeAirToObjCollision(void)
 
 		if(air1->GetPosition().y()-air1->GetApproximatedCollideRadius()<tallestGroundObjectHeight)
 		{
-			GetLattice().GetGndCollisionCandidate(gndCandidate,air1);
+			GetBroadPhase().GetGndCollisionCandidate(gndCandidate,air1);
 			for(int j=0; j<gndCandidate.GetN(); j++)
 			{
 				FsGround *gnd2=gndCandidate[j];
@@ -4203,9 +4395,14 @@ void FsSimulation::SimComputeAirToObjCollision(void)
 
 void FsSimulation::SimProcessCollisionAndTerrain(const double & /*dt*/)
 {
-	// Call HitObject BEFORE HitGround
-	bulletHolder.HitObject(currentTime,&explosionHolder,this,tallestGroundObjectHeight);
-	bulletHolder.HitGround(currentTime,field,&explosionHolder,this);
+	FsSimulationPhaseTimer::Scope phaseScope(phaseTimer,FsSimulationPhaseTimer::PHASE_COLLISIONANDTERRAIN);
+
+	{
+		FsSimulationPhaseTimer::Scope bulletTimer(phaseTimer,FsSimulationPhaseTimer::PHASE_BULLETHIT);
+		// Call HitObject BEFORE HitGround
+		bulletHolder.HitObject(currentTime,&explosionHolder,this,tallestGroundObjectHeight);
+		bulletHolder.HitGround(currentTime,field,&explosionHolder,this);
+	}
 
 	YsArray <FsAirplane *,256> airCandidate;
 	YsArray <FsGround *,256> gndCandidate;
@@ -4336,7 +4533,7 @@ void FsSimulation::SimProcessCollisionAndTerrain(const double & /*dt*/)
 		{
 			if((YSTRUE!=gnd1->Prop().IsStatic() || YSTRUE==gnd1->BouncedLastTime()) && YSTRUE!=gnd1->Prop().SkipGroundToGroundCollisionCheck())
 			{
-				// GetLattice().GetAirCollisionCandidate(airCandidate,gnd1);
+				// GetBroadPhase().GetAirCollisionCandidate(airCandidate,gnd1);
 
 				// for(int j=0; j<airCandidate.GetN(); j++)
 				// {
@@ -4352,7 +4549,7 @@ void FsSimulation::SimProcessCollisionAndTerrain(const double & /*dt*/)
 				// 	}
 				// }
 
-				GetLattice().GetGndCollisionCandidate(gndCandidate,gnd1);
+				GetBroadPhase().GetGndCollisionCandidate(gndCandidate,gnd1);
 				for(auto j=gndCandidate.GetN()-1; j>=0; j--)
 				{
 					FsGround *gnd2=gndCandidate[j];
@@ -4430,7 +4627,7 @@ YSBOOL FsSimulation::MayCollide(const YsVec3 &objPos,const double objRad,const F
 YSBOOL FsSimulation::MayCollideWithAir(const YsVec3 &objPos,const double objRad,const FsExistence *selfPtr,const int nExclude,const FsExistence * const exclude[]) const
 {
 	YsArray <FsAirplane *,256> airCandidate;
-	GetLattice().GetAirCollisionCandidate(airCandidate,objPos,objRad);
+	GetBroadPhase().GetAirCollisionCandidate(airCandidate,objPos,objRad);
 	for(int i=0; i<airCandidate.GetN(); i++)
 	{
 		const YsVec3 dif=objPos-airCandidate[i]->GetPosition();;
@@ -4450,7 +4647,7 @@ YSBOOL FsSimulation::MayCollideWithAir(const YsVec3 &objPos,const double objRad,
 YSBOOL FsSimulation::MayCollideWithGround(const YsVec3 &objPos,const double objRad,const FsExistence *selfPtr,const int nExclude,const FsExistence * const exclude[]) const
 {
 	YsArray <FsGround *,256> gndCandidate;
-	GetLattice().GetGndCollisionCandidate(gndCandidate,objPos,objRad);
+	GetBroadPhase().GetGndCollisionCandidate(gndCandidate,objPos,objRad);
 	for(int i=0; i<gndCandidate.GetN(); i++)
 	{
 		const YsVec3 dif=objPos-gndCandidate[i]->GetPosition();
@@ -4482,7 +4679,7 @@ YSBOOL FsSimulation::MayCollideWithAir(const YsVec3 &objPos,const YsAtt3 &objAtt
 	const double objRad=selfPtr->GetApproximatedCollideRadius();
 
 	YsArray <FsAirplane *,256> airCandidate;
-	GetLattice().GetAirCollisionCandidate(airCandidate,objPos,objRad);
+	GetBroadPhase().GetAirCollisionCandidate(airCandidate,objPos,objRad);
 	if(0<airCandidate.GetN())
 	{
 		YsMatrix4x4 objMat;
@@ -4516,7 +4713,7 @@ YSBOOL FsSimulation::MayCollideWithGround(const YsVec3 &objPos,const YsAtt3 &obj
 	const double objRad=selfPtr->GetApproximatedCollideRadius();
 
 	YsArray <FsGround *,256> gndCandidate;
-	GetLattice().GetGndCollisionCandidate(gndCandidate,objPos,objRad);
+	GetBroadPhase().GetGndCollisionCandidate(gndCandidate,objPos,objRad);
 	if(0<gndCandidate.GetN())
 	{
 		YsMatrix4x4 objMat;
@@ -5793,6 +5990,8 @@ void FsSimulation::SimProcessButtonFunction(FSBUTTONFUNCTION fnc,FSUSERCONTROL u
 
 void FsSimulation::SimControlByComputer(const double &dt)
 {
+	FsSimulationPhaseTimer::Scope phaseScope(phaseTimer,FsSimulationPhaseTimer::PHASE_CONTROLBYCOMPUTER);
+
 	YsArray <YsVec2i,256> blockList;
 	YsArray <FsAirplane *,256> potentialAirTarget;
 	YsArray <FsGround *,256> potentialGndTarget;
@@ -5801,6 +6000,12 @@ void FsSimulation::SimControlByComputer(const double &dt)
 	printf("%s %d\n",__FUNCTION__,__LINE__);
 #endif
 
+	// Decide phase.  Autopilots read the snapshot for the autopilot state of the other airplanes, and write only to
+	// themselves and the controls of their own airplanes.  The autopilots that cannot decide in parallel go first,
+	// one by one, so that the parallel ones see a settled state.
+	aiControlSnapshot.Make(this);
+
+	YsArray <FsAirplane *,256> parallelAir;
 	for(FsAirplane *air=NULL; NULL!=(air=FindNextAirplane(air)); )
 	{
 #ifdef CRASHINVESTIGATION_SIMCONTROLBYCOMPUTER
@@ -5810,13 +6015,34 @@ void FsSimulation::SimControlByComputer(const double &dt)
 		FsAutopilot *ap=air->GetAutopilot();
 		if(air->IsAlive()==YSTRUE && ap!=NULL)
 		{
+			if(YSTRUE==cfgPtr->parallelAiDecision && YSTRUE==ap->CanDecideInParallel())
+			{
+				parallelAir.Append(air);
+			}
+			else
+			{
 #ifdef CRASHINVESTIGATION_SIMCONTROLBYCOMPUTER
-			printf("%s %d\n",__FUNCTION__,__LINE__);
+				printf("%s %d\n",__FUNCTION__,__LINE__);
 #endif
-			ap->Control(*air,this,dt);
+				ap->Decide(*air,this,dt);
 #ifdef CRASHINVESTIGATION_SIMCONTROLBYCOMPUTER
-			printf("%s %d\n",__FUNCTION__,__LINE__);
+				printf("%s %d\n",__FUNCTION__,__LINE__);
 #endif
+			}
+		}
+	}
+	// The serial autopilots may move the other airplanes (FsFormation).  The sensor index is made after them.
+	sensorIndex.Make(this);
+	SimDecideByComputerInParallel(parallelAir.GetN(),parallelAir,dt);
+
+	// Apply phase.  Deferred actions, autopilot switching, and turret gunners, in the order of the airplane list.
+	for(FsAirplane *air=NULL; NULL!=(air=FindNextAirplane(air)); )
+	{
+		FsAutopilot *ap=air->GetAutopilot();
+		if(air->IsAlive()==YSTRUE && ap!=NULL)
+		{
+			ap->ApplyDeferredAction(*air,this);
+
 			if(air->GetLandWhenLowFuel()>YsTolerance &&
 			   ap->Type()!=FSAUTOPILOT_LANDING &&
 			   ap->Type()!=FSAUTOPILOT_VLANDING)
@@ -5862,11 +6088,11 @@ void FsSimulation::SimControlByComputer(const double &dt)
 
 				if(air->Prop().GetHasAntiAirTurret()==YSTRUE)
 				{
-					GetLattice().GetAirCollisionCandidate(potentialAirTarget,air->GetPosition(),range);
+					GetBroadPhase().GetAirCollisionCandidate(potentialAirTarget,air->GetPosition(),range);
 				}
 				if(air->Prop().GetHasAntiGroundTurret()==YSTRUE)
 				{
-					GetLattice().GetGndCollisionCandidate(potentialGndTarget,air->GetPosition(),range);
+					GetBroadPhase().GetGndCollisionCandidate(potentialGndTarget,air->GetPosition(),range);
 				}
 
 				for(auto i=potentialGndTarget.GetN()-1; i>=0; i--)
@@ -5889,6 +6115,7 @@ void FsSimulation::SimControlByComputer(const double &dt)
 	printf("%s %d\n",__FUNCTION__,__LINE__);
 #endif
 	}
+	aiControlSnapshot.Invalidate();
 
 #ifdef CRASHINVESTIGATION_SIMCONTROLBYCOMPUTER
 	printf("%s %d\n",__FUNCTION__,__LINE__);
@@ -5913,11 +6140,11 @@ void FsSimulation::SimControlByComputer(const double &dt)
 
 				if(gnd->Prop().GetHasAntiAirTurret()==YSTRUE)
 				{
-					GetLattice().GetAirCollisionCandidate(potentialAirTarget,gnd->GetPosition(),range);
+					GetBroadPhase().GetAirCollisionCandidate(potentialAirTarget,gnd->GetPosition(),range);
 				}
 				if(gnd->Prop().GetHasAntiGroundTurret()==YSTRUE)
 				{
-					GetLattice().GetGndCollisionCandidate(potentialGndTarget,gnd->GetPosition(),range);
+					GetBroadPhase().GetGndCollisionCandidate(potentialGndTarget,gnd->GetPosition(),range);
 				}
 
 				for(auto i=potentialGndTarget.GetN()-1; i>=0; i--)
@@ -5936,6 +6163,29 @@ void FsSimulation::SimControlByComputer(const double &dt)
 			}
 		}
 	}
+	sensorIndex.Invalidate();
+}
+
+void FsSimulation::SimDecideByComputerInParallel(YSSIZE_T nAir,FsAirplane *const airArray[],const double &dt)
+{
+	const YSSIZE_T nThread=(YSSIZE_T)threadPool.GetN();
+	if(nThread<=1 || nAir<2)
+	{
+		for(YSSIZE_T idx=0; idx<nAir; ++idx)
+		{
+			airArray[idx]->GetAutopilot()->Decide(*airArray[idx],this,dt);
+		}
+		return;
+	}
+
+	const YSSIZE_T grainSize=YsGreater <YSSIZE_T> (1,nAir/(nThread*4));
+	threadPool.GetScheduler().ParallelFor(0,nAir,grainSize,[&](long long int i0,long long int i1)
+	{
+		for(long long int idx=i0; idx<i1; ++idx)
+		{
+			airArray[idx]->GetAutopilot()->Decide(*airArray[idx],this,dt);
+		}
+	});
 }
 
 void FsSimulation::SimMakeUpCockpitIndicationSet(class FsCockpitIndicationSet &cockpitIndicationSet) const
@@ -6339,6 +6589,10 @@ void FsSimulation::SimDrawAllScreen(YSBOOL demoMode,YSBOOL showTimer,YSBOOL show
 	// FsSplitMainWindow(YSTRUE);  <- Test split.
 
 	FsSelectMainWindow();
+
+	// Textures decoded in the background since the last frame.  Until then, the placeholder is drawn.
+	FsCommonTexture::GetCommonTexture().UploadDecodedTexture((long long int)cfgPtr->textureUploadBudget*1024);
+
 	if(YSTRUE!=FsIsMainWindowSplit())
 	{
 		SimDrawScreen(0,cockpitIndicationSet,demoMode,showTimer,showTimeMarker,mainWindowActualViewMode);
@@ -6404,8 +6658,9 @@ void FsSimulation::SimDrawScreen(
 	// printf("%s\n",ViewmodeToStr(actualViewMode.actualViewMode));
 
 
-	YsGLParticleManager partMan;
+	YsGLParticleManager &partMan=*particleMan;
 	{
+		partMan.ClearParticle();
 		particleStore.AddToParticleManager(partMan);
 		if(YSTRUE==cfgPtr->useParticle)
 		{
@@ -7812,7 +8067,6 @@ void FsSimulation::SimDrawAircraftInterior(const ActualViewMode &actualViewMode,
 	FsSetCameraPosition(actualViewMode.viewPoint,actualViewMode.viewAttitude,YSTRUE); // BiStartBuffer(&eye);
 
 
-	// #### ltc.TestDraw();  Lattice Test
 	if(cfgPtr->neverDrawAirplaneContainer==YSFALSE)
 	{
 		if(YSTRUE==NeedToDrawGameInfo(actualViewMode))
@@ -10108,7 +10362,20 @@ YSBOOL FsSimulation::CheckMidAir(YsVec3 &collisionPos,FsExistence &ex1,FsExisten
 		YsShellPolygonHandle plHd1,plHd2;
 		if(YSTRUE==ex1.MayCollideWith(ex2) && YSTRUE==ex2.MayCollideWith(ex1))
 		{
-			if(YsCheckShellCollisionEx(collisionPos,plHd1,plHd2,ex1.TransformedCollisionShell().Conv(),ex2.TransformedCollisionShell().Conv())==YSTRUE)
+			auto tree1=ex1.GetCollisionShellBoundingBoxTree();
+			auto tree2=ex2.GetCollisionShellBoundingBoxTree();
+			if(nullptr!=tree1 && nullptr!=tree2)
+			{
+				// Trees are in the untransformed coordinate.  Only the relative transformation is needed.
+				YsMatrix4x4 mat1,mat2;
+				ex1.TransformedCollisionShell().GetMatrix(mat1);
+				ex2.TransformedCollisionShell().GetMatrix(mat2);
+				if(YsCheckShellCollisionEx(collisionPos,plHd1,plHd2,*tree1,mat1,*tree2,mat2)==YSTRUE)
+				{
+					return YSTRUE;
+				}
+			}
+			else if(YsCheckShellCollisionEx(collisionPos,plHd1,plHd2,ex1.TransformedCollisionShell().Conv(),ex2.TransformedCollisionShell().Conv())==YSTRUE)
 			{
 				return YSTRUE;
 			}
@@ -10117,10 +10384,22 @@ YSBOOL FsSimulation::CheckMidAir(YsVec3 &collisionPos,FsExistence &ex1,FsExisten
 	return YSFALSE;
 }
 
-YSBOOL FsSimulation::CheckMidAir(YsVec3 &collisionPos,const YsShell &coll,FsExistence &ex2)
+YSBOOL FsSimulation::CheckMidAir(YsVec3 &collisionPos,const FsVisualSrf &coll,FsExistence &ex2)
 {
 	YsShellPolygonHandle plHd1,plHd2;
-	if(YsCheckShellCollisionEx(collisionPos,plHd1,plHd2,coll,ex2.TransformedCollisionShell().Conv())==YSTRUE)
+	auto tree1=coll.GetBoundingBoxTree();
+	auto tree2=ex2.GetCollisionShellBoundingBoxTree();
+	if(nullptr!=tree2)
+	{
+		YsMatrix4x4 mat1,mat2;
+		coll.GetMatrix(mat1);
+		ex2.TransformedCollisionShell().GetMatrix(mat2);
+		if(YsCheckShellCollisionEx(collisionPos,plHd1,plHd2,*tree1,mat1,*tree2,mat2)==YSTRUE)
+		{
+			return YSTRUE;
+		}
+	}
+	else if(YsCheckShellCollisionEx(collisionPos,plHd1,plHd2,coll.Conv(),ex2.TransformedCollisionShell().Conv())==YSTRUE)
 	{
 		return YSTRUE;
 	}
@@ -13310,21 +13589,22 @@ void FsSimulation::FindGroundToAirThreat(YsArray <FsSimInfo::GndToAirThreat,16>
 		return;
 	}
 
-	// Maximum weapon range is unknown.  So, I cannot use lattice.
-	for(const FsGround *gnd=NULL; NULL!=(gnd=FindNextGround(gnd)); )
+	// Sites are stored in the threat index with their ranges.  Scan all if the index is not up to date.
+	YsArray <const FsGround *,64> gndCan;
+	if(YSOK!=gndThreatIndex.GetThreatCandidateOnLine(gndCan,A,B,air.GetIff()))
 	{
-		if(FS_IFF_NEUTRAL!=gnd->GetIff() && air.GetIff()!=gnd->GetIff())
+		gndCan.Clear();
+		for(const FsGround *gnd=NULL; NULL!=(gnd=FindNextGround(gnd)); )
 		{
-			double range=0.0;
-			if(0<gnd->Prop().GetNumSAM())
-			{
-				range=YsGreater(range,gnd->Prop().GetSAMRange());
-			}
-			if(0<gnd->Prop().GetNumAaaBullet())
-			{
-				range=YsGreater(range,gnd->Prop().GetAAARange());
-			}
+			gndCan.Append(gnd);
+		}
+	}
 
+	for(auto gnd : gndCan)
+	{
+		if(FS_IFF_NEUTRAL!=gnd->GetIff() && air.GetIff()!=gnd->GetIff() && YSTRUE==gnd->IsAlive())
+		{
+			const double range=FsGroundThreatIndex::GetThreatRange(*gnd);
 			if(YsTolerance<range &&
 			   YsGetPointLineDistance3(A,B,gnd->GetPosition())<range)
 			{
@@ -13336,6 +13616,41 @@ void FsSimulation::FindGroundToAirThreat(YsArray <FsSimInfo::GndToAirThreat,16>
 	}
 }
 
+std::shared_future <FsRoutePlanner::Route> FsSimulation::RequestThreatAvoidingRoute(const FsAirplane &air,const YsVec3 &goal)
+{
+	const YsVec3 &pos=air.GetPosition();
+	return routePlanner.RequestRoute(air.GetIff(),YsVec2(pos.x(),pos.z()),YsVec2(goal.x(),goal.z()));
+}
+
+unsigned int FsSimulation::GetThreatAvoidingRouteVersion(void) const
+{
+	return routePlanner.GetThreatVersion();
+}
+
+void FsSimulation::UpdateRoutePlannerThreat(void)
+{
+	if(YSTRUE!=gndThreatIndex.IsValid() || gndThreatIndex.GetVersion()==routePlanner.GetThreatVersion())
+	{
+		return;
+	}
+
+	// Same threats as FindGroundToAirThreat.
+	YsArray <FsRoutePlanner::Threat> threat;
+	for(const FsGround *gnd=NULL; NULL!=(gnd=FindNextGround(gnd)); )
+	{
+		const double range=FsGroundThreatIndex::GetThreatRange(*gnd);
+		if(FS_IFF_NEUTRAL!=gnd->GetIff() && YSTRUE==gnd->IsAlive() && YsTolerance<range)
+		{
+			const YsVec3 &pos=gnd->GetPosition();
+			threat.Increment();
+			threat.Last().iff=gnd->GetIff();
+			threat.Last().pos.Set(pos.x(),pos.z());
+			threat.Last().range=range;
+		}
+	}
+	routePlanner.SetThreat(gndThreatIndex.GetVersion(),threat);
+}
+
 const FsFlightConfig &FsSimulation::GetConfig(void) const
 {
 	return *cfgPtr;
@@ -13587,10 +13902,10 @@ YSRESULT FsSimulation::FindNearbyBoardableVehicle(YsArray <const FsExistence *,1
 	objArray.Clear();
 
 	YsArray <FsAirplane *,16> nearbyAir;
-	ltc.GetAirCollisionCandidate(nearbyAir,from.GetPosition(),from.GetApproximatedCollideRadius()*2.0);
+	broadPhase.GetAirCollisionCandidate(nearbyAir,from.GetPosition(),from.GetApproximatedCollideRadius()*2.0);
 
 	YsArray <FsGround *,16> nearbyGnd;
-	ltc.GetGndCollisionCandidate(nearbyGnd,from.GetPosition(),from.GetApproximatedCollideRadius()*2.0);
+	broadPhase.GetGndCollisionCandidate(nearbyGnd,from.GetPosition(),from.GetApproximatedCollideRadius()*2.0);
 
 	for(int idx=0; idx<nearbyAir.GetN(); ++idx)
 	{
@@ -13803,54 +14118,49 @@ YSRESULT FsSimulation::GetFormationCenter(YsVec3 &pos,FsAirplane &wingLeader) co
 	}
 }
 
-void FsSimulation::RemakeLattice(void)
+void FsSimulation::RemakeBroadPhase(void)
 {
-	ltc.Initialize();
-
 	YsVec3 bbx[2];
 	field.GetBoundingBox(bbx[0],bbx[1]);
 
 	YsVec2 min2d(bbx[0].x()-20000.0,bbx[0].z()-20000.0);  // 20km margin
 	YsVec2 max2d(bbx[1].x()+20000.0,bbx[1].z()+20000.0);  // 20km margin
-	const YsVec2 dim(max2d-min2d);
-
-	int nx=1+(int)(dim.x()/1000.0);
-	int ny=1+(int)(dim.y()/1000.0);
-
-	printf("FsLattice\n");
-	printf(" %s to %s\n",min2d.Txt(),max2d.Txt());
-	printf(" NX=%d, NY=%d\n",nx,ny);
-
-	while(1<(nx/1024)*(ny/1024))
-	{
-		printf("Lattice Size Too Big! Reducing.\n");
-		if(1024<nx)
-		{
-			nx/=2;
-		}
-		if(1024<ny)
-		{
-			ny/=2;
-		}
-		printf("%d %d\n",nx,ny);
-	}
-
-	ltc.SetUp(min2d,max2d,nx,ny);
+	broadPhase.SetUp(min2d,max2d,(double)FsBroadPhase::DEFAULT_CELL_SIZE,(double)FsBroadPhase::DEFAULT_POSITION_SLACK);
 
 	for(const FsAirplane *air=NULL; NULL!=(air=FindNextAirplane(air)); )
 	{
-		ltc.Add(air);
+		broadPhase.Add(air);
 	}
 
 	for(const FsGround *gnd=NULL; NULL!=(gnd=FindNextGround(gnd)); )
 	{
-		ltc.Add(gnd);
+		broadPhase.Add(gnd);
 	}
 }
 
-const FsLattice &FsSimulation::GetLattice(void) const
+const FsBroadPhase &FsSimulation::GetBroadPhase(void) const
+{
+	return broadPhase;
+}
+
+const FsGroundThreatIndex &FsSimulation::GetGroundThreatIndex(void) const
+{
+	return gndThreatIndex;
+}
+
+const FsAiControlSnapshot &FsSimulation::GetAiControlSnapshot(void) const
+{
+	return aiControlSnapshot;
+}
+
+const FsSensorIndex &FsSimulation::GetSensorIndex(void) const
+{
+	return sensorIndex;
+}
+
+void FsSimulation::SetPhaseTimer(FsSimulationPhaseTimer *timer)
 {
-	return ltc;
+	phaseTimer=timer;
 }
 
 int FsSimulation::RerecordByNewInterval(const double &itvl)
@@ -49,6 +49,12 @@ class FsWorld;
 ////////////////////////////////////////////////////////////
 
 #include "fslattice.h"
+#include "fsbroadphase.h"
+#include "fsaicontrolsnapshot.h"
+#include "fssensorindex.h"
+#include "fsgroundthreatindex.h"
+#include "fsrouteplanner.h"
+#include "fssimphasetimer.h"
 
 // Declaration /////////////////////////////////////////////
 
@@ -276,7 +282,12 @@ protected:
 	YsHashTable <FsAirplane *> *airplaneSearch;
 	YsHashTable <FsGround *> *groundSearch;
 
-	FsLattice ltc;
+	FsBroadPhase broadPhase;
+	FsAiControlSnapshot aiControlSnapshot;  // Valid only in SimControlByComputer
+	FsSensorIndex sensorIndex;              // Valid only in SimControlByComputer
+	FsGroundThreatIndex gndThreatIndex;
+	FsRoutePlanner routePlanner;            // Threats are taken from gndThreatIndex
+	FsSimulationPhaseTimer *phaseTimer;     // nullptr unless measuring
 
 	double tallestGroundObjectHeight; // Updated everytime ground object moves
 
@@ -361,6 +372,7 @@ protected:
 	FsWeaponHolder bulletHolder;
 	FsExplosionHolder explosionHolder;
 	FsParticleStore particleStore;
+	class YsGLParticleManager *particleMan;  // Kept across frames so that the sort can start from the last order.
 
 	class FsWeather *weather,*iniWeather;
 	class FsClouds *cloud;
@@ -430,11 +442,13 @@ public:
 
 	YSRESULT TestAircraftCarrierDataIntegrity(void) const;
 
+	/*! If binRec is not nullptr, airplane and ground records are written to binRec, and only the BINRECOR lines go to fp. */
 	YSRESULT Save(FILE *fp,
 	     int airPosPrecision,int airAttPrecision,
 	     int gndPosPrecision,int gndAttPresicion,
 	     int wpnPosPrecision,int wpnAttPrecision,
-	     const double &timeStep);
+	     const double &timeStep,
+	     class FsBinaryRecordWriter *binRec=nullptr);
 	YSRESULT LoadWeaponRecord(FILE *fp);
 	YSRESULT LoadExplosionRecord(FILE *fp);
 	YSRESULT LoadCloud(FILE *fp);
@@ -781,6 +795,20 @@ public:
 	    Note: This function is altitude aware.  Set altitude of A and B as the flight path. */
 	void FindGroundToAirThreat(YsArray <FsSimInfo::GndToAirThreat,16> &threatFound,const YsVec3 &A,const YsVec3 &B,const FsAirplane &air) const;
 
+	/*! Returns a route on the XZ plane from the airplane to the goal that goes around the SAM and AAA sites of the
+	    other IFFs.  The route is planned in a worker thread, and is shared with the other airplanes of the same IFF
+	    that leave the same area for the same goal.  The future may not be ready yet.
+	    Can be called from FsAutopilot::MakeDecision in parallel. */
+	std::shared_future <FsRoutePlanner::Route> RequestThreatAvoidingRoute(const FsAirplane &air,const YsVec3 &goal);
+
+	/*! Returns the version of the threats that RequestThreatAvoidingRoute plans against.  A route of an older
+	    FsRoutePlanner::Route::threatVersion needs to be asked again.
+	    Can be called from FsAutopilot::MakeDecision in parallel. */
+	unsigned int GetThreatAvoidingRouteVersion(void) const;
+private:
+	void UpdateRoutePlannerThreat(void);
+public:
+
 
 public:
 	const class FsFlightConfig &GetConfig(void) const;
@@ -816,8 +844,24 @@ private:
 public:
 	YSRESULT GetFormationCenter(YsVec3 &pos,FsAirplane &wingLeader) const;
 
-	void RemakeLattice(void);
-	const FsLattice &GetLattice(void) const;
+	void RemakeBroadPhase(void);
+	const FsBroadPhase &GetBroadPhase(void) const;
+
+	/*! Returns the index of the SAM and AAA sites used by FindGroundToAirThreat.  Its version changes when the threats
+	    change. */
+	const FsGroundThreatIndex &GetGroundThreatIndex(void) const;
+
+	/*! Returns the state of the airplanes taken at the beginning of the control tick.  IsValid of the returned
+	    snapshot is YSFALSE outside of SimControlByComputer. */
+	const FsAiControlSnapshot &GetAiControlSnapshot(void) const;
+
+	/*! Returns the airplanes and the ground objects partitioned by IFF for the target search.  IsValid of the returned
+	    index is YSFALSE outside of SimControlByComputer. */
+	const FsSensorIndex &GetSensorIndex(void) const;
+
+	/*! Sets the timer that accumulates the time spent in each phase of SimulateOneStep.  The timer is not owned by
+	    FsSimulation.  Give nullptr (default) to stop measuring. */
+	void SetPhaseTimer(FsSimulationPhaseTimer *timer);
 
 	int RerecordByNewInterval(const double &itvl);
 	void AdjustPrecisionOfFlightRecord(const double &precPos,const double &precAng);
@@ -837,6 +881,17 @@ protected:
 	void SimMove(const double &deltaTime);
 	void SimCheckTailStrike(void);
 
+	/*! Per-aircraft part of SimMove that only touches the aircraft itself.
+	    It can run in parallel for different aircraft.
+	    Side effects (crash, particles, home base, etc.) must be processed after this function. */
+	void SimMoveAirplanePhysics(FsAirplane *air,const double dt,YSBOOL integrate);
+	void SimMoveAirplanePhysicsRange(YSSIZE_T i0,YSSIZE_T i1,FsAirplane *const airArray[],const YSBOOL integrateArray[],const double dt);
+	void SimMoveAirplanePhysicsInParallel(YSSIZE_T nAir,FsAirplane *const airArray[],const YSBOOL integrateArray[],const double dt);
+
+	/*! Returns YSTRUE if the aircraft may be loaded to or unloaded from an aircraft carrier in this step.
+	    Loading and unloading change the carrier's state, therefore such an aircraft must be moved serially. */
+	YSBOOL SimMayInteractWithAircraftCarrier(const FsAirplane *air,const double dt) const;
+
 protected:
 	void SimCacheFieldElevation(void);
 	void UpdateGroundTerrainElevationAndNormal(FsGround *gndPtr);
@@ -880,6 +935,8 @@ public:
 	void SimProcessButtonFunction(FSBUTTONFUNCTION fnc,FSUSERCONTROL userControl);
 protected:
 	void SimControlByComputer(const double &dt);
+	/*! Decide phase of the autopilots that can decide in parallel. */
+	void SimDecideByComputerInParallel(YSSIZE_T nAir,FsAirplane *const airArray[],const double &dt);
 	void SimMakeUpCockpitIndicationSet(class FsCockpitIndicationSet &cockpitIndicationSet) const;
 	void SimDrawAllScreen(YSBOOL demoMode,YSBOOL showTimer,YSBOOL showTimeMarker) const;
 	void SimDrawScreen(const double &dt,const FsCockpitIndicationSet &cockpitIndicationSet,YSBOOL demoMode,YSBOOL showTimer,YSBOOL showTimeMarker,const ActualViewMode &actualViewMode) const;
@@ -1001,7 +1058,7 @@ protected:
 	YSBOOL AllRecordedFlightsAreOver(double &lastRecordTime);
 
 	YSBOOL CheckMidAir(YsVec3 &collisionPos,FsExistence &ex1,FsExistence &ex2);
-	YSBOOL CheckMidAir(YsVec3 &collisionPos,const YsShell &shl,FsExistence &ex2);
+	YSBOOL CheckMidAir(YsVec3 &collisionPos,const FsVisualSrf &shl,FsExistence &ex2);
 	YSBOOL Explode(FsExistence &ex,YSBOOL sound);
 
 	void UpdateViewpointAccordingToPlayerAirplane(const double &distance,YSBOOL reset);
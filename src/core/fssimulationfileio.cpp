@@ -1,6 +1,7 @@
 #include <ysclass.h>
 #include <ysport.h>
 #include "fs.h"
+#include "fsbinaryrecord.h"
 #include "fsfilename.h"
 #include "fsinstpanel.h"
 #include "platform/common/fswindow.h"
@@ -39,7 +40,8 @@ YSRESULT FsSimulation::Save(
     int airPosPrecision,int airAttPrecision,
     int gndPosPrecision,int gndAttPrecision,
     int wpnPosPrecision,int wpnAttPrecision,
-    const double & /*timeStep*/)
+    const double & /*timeStep*/,
+    FsBinaryRecordWriter *binRec)
 {
 	int i;
 	const FsField *fld;
@@ -267,7 +269,16 @@ YSRESULT FsSimulation::Save(
 
 		air->SaveAutoPilot(fp,this);
 
-		if(air->rec!=NULL)
+		if(air->rec!=NULL && nullptr!=binRec)
+		{
+			const int streamIdx=binRec->AddStream(*air->rec);
+			if(0>streamIdx)
+			{
+				return YSERR;
+			}
+			fprintf(fp,"BINRECOR %d\n",streamIdx);
+		}
+		else if(air->rec!=NULL)
 		{
 			int i,j,nr;
 			FsFlightRecord *r;
@@ -311,10 +322,11 @@ YSRESULT FsSimulation::Save(
 				fprintf(fp,"%d %d %d %d ",r->ail        ,r->rud         ,r->elvTrim,r->thrVector);
 				fprintf(fp,"%d %d\n"     ,r->thrReverser,r->bombBay);
 
-				fprintf(fp,"%d",r->turret.GetN());
-				for(j=0; j<r->turret.GetN(); j++)
+				auto turret=air->rec->GetTurret(i);
+				fprintf(fp,"%d",(int)turret.GetN());
+				for(j=0; j<turret.GetN(); j++)
 				{
-					fprintf(fp,turretFormat,r->turret[j].h,r->turret[j].p,r->turret[j].turretState);
+					fprintf(fp,turretFormat,turret[j].h,turret[j].p,turret[j].turretState);
 				}
 				fprintf(fp,"\n");
 			}
@@ -403,7 +415,16 @@ YSRESULT FsSimulation::Save(
 		// Ground Intention ....
 		// in the future
 
-		if(gnd->rec!=NULL)
+		if(gnd->rec!=NULL && nullptr!=binRec)
+		{
+			const int streamIdx=binRec->AddStream(*gnd->rec);
+			if(0>streamIdx)
+			{
+				return YSERR;
+			}
+			fprintf(fp,"BINRECOR %d\n",streamIdx);
+		}
+		else if(gnd->rec!=NULL)
 		{
 			int i,j,nr;
 			FsGroundRecord *r;
@@ -455,10 +476,11 @@ YSRESULT FsSimulation::Save(
 				    r->lightState);
 
 
-				fprintf(fp,"%d",r->turret.GetN());
-				for(j=0; j<r->turret.GetN(); j++)
+				auto turret=gnd->rec->GetTurret(i);
+				fprintf(fp,"%d",(int)turret.GetN());
+				for(j=0; j<turret.GetN(); j++)
 				{
-					fprintf(fp,turretFormat,r->turret[j].h,r->turret[j].p,r->turret[j].turretState);
+					fprintf(fp,turretFormat,turret[j].h,turret[j].p,turret[j].turretState);
 				}
 				fprintf(fp,"\n");
 			}
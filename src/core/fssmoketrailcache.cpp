@@ -0,0 +1,146 @@
+#include <ysclass.h>
+#include <ysglcpp.h>
+
+#include "fssmoketrailcache.h"
+
+
+
+FsSmokeTrailCache::FsSmokeTrailCache()
+{
+	CleanUp();
+}
+
+void FsSmokeTrailCache::CleanUp(void)
+{
+	smk=FSSMKNULL;
+	step=0;
+	smkGen=YsOrigin();
+	lastTime=0.0;
+
+	seg.Set(0,nullptr);
+	segTop=0;
+	vtx.Set(0,nullptr);
+	nom.Set(0,nullptr);
+	isNewerEnd.Set(0,nullptr);
+}
+
+YSBOOL FsSmokeTrailCache::IsEmpty(void) const
+{
+	return (seg.GetN()<=segTop ? YSTRUE : YSFALSE);
+}
+
+const FsSmokeTrailCache::Segment &FsSmokeTrailCache::Oldest(void) const
+{
+	return seg[segTop];
+}
+
+const FsSmokeTrailCache::Segment &FsSmokeTrailCache::Newest(void) const
+{
+	return seg.Last();
+}
+
+void FsSmokeTrailCache::Expire(double t0)
+{
+	while(segTop<seg.GetN() && seg[segTop].tm1<=t0)
+	{
+		++segTop;
+	}
+
+	if(seg.GetN()<=segTop)
+	{
+		seg.Set(0,nullptr);
+		segTop=0;
+		vtx.Set(0,nullptr);
+		nom.Set(0,nullptr);
+		isNewerEnd.Set(0,nullptr);
+	}
+	else if(seg.GetN()<segTop*2)
+	{
+		// More than half expired.  Move the rest to the front.
+		const YSSIZE_T vtxTop=seg[segTop].vtxTop;
+		const YSSIZE_T nVtx=isNewerEnd.GetN()-vtxTop;
+		for(YSSIZE_T i=0; i<nVtx*3; ++i)
+		{
+			vtx[i]=vtx[vtxTop*3+i];
+			nom[i]=nom[vtxTop*3+i];
+		}
+		for(YSSIZE_T i=0; i<nVtx; ++i)
+		{
+			isNewerEnd[i]=isNewerEnd[vtxTop+i];
+		}
+		vtx.Resize(nVtx*3);
+		nom.Resize(nVtx*3);
+		isNewerEnd.Resize(nVtx);
+
+		const YSSIZE_T nSeg=seg.GetN()-segTop;
+		for(YSSIZE_T i=0; i<nSeg; ++i)
+		{
+			seg[i]=seg[segTop+i];
+			seg[i].vtxTop-=vtxTop;
+		}
+		seg.Resize(nSeg);
+		segTop=0;
+	}
+}
+
+void FsSmokeTrailCache::Add(
+    YSSIZE_T recIdx0,double tm0,YSSIZE_T recIdx1,double tm1,
+    const class YsGLVertexBuffer &vtxBuf,const class YsGLNormalBuffer &nomBuf,const class YsGLColorBuffer &colBuf)
+{
+	seg.Increment();
+	auto &s=seg.Last();
+	s.recIdx0=recIdx0;
+	s.recIdx1=recIdx1;
+	s.tm0=tm0;
+	s.tm1=tm1;
+	s.vtxTop=isNewerEnd.GetN();
+	s.nVtx=vtxBuf.GetN();
+
+	vtx.Add(vtxBuf.GetN()*3,vtxBuf.GetArrayPointer());
+	nom.Add(nomBuf.GetN()*3,nomBuf.GetArrayPointer());
+	for(YSSIZE_T i=0; i<colBuf.GetN(); ++i)
+	{
+		isNewerEnd.Add(0.5f<colBuf[i][3] ? 1 : 0);
+	}
+}
+
+void FsSmokeTrailCache::AddToBuffer(
+    class YsGLVertexBuffer &vtxBuf,class YsGLNormalBuffer &nomBuf,class YsGLColorBuffer &colBuf,
+    const YsColor &smkCol,double currentTime,double remainTime) const
+{
+	if(YSTRUE==IsEmpty())
+	{
+		return;
+	}
+
+	YsArray <float> col(4*(isNewerEnd.GetN()-seg[segTop].vtxTop),nullptr);
+	float *colPtr=col.GetEditableArray();
+
+	for(YSSIZE_T segIdx=seg.GetN()-1; segTop<=segIdx; --segIdx)
+	{
+		auto &s=seg[segIdx];
+		if(0==s.nVtx)
+		{
+			continue;
+		}
+
+		vtxBuf.AddArray(s.nVtx,vtx.GetArray()+s.vtxTop*3);
+		nomBuf.AddArray(s.nVtx,nom.GetArray()+s.vtxTop*3);
+
+		const float alpha[2]=
+		{
+			(float)(0.8-0.8*(currentTime-s.tm0)/remainTime),
+			(float)(0.8-0.8*(currentTime-s.tm1)/remainTime)
+		};
+		for(YSSIZE_T i=s.vtxTop; i<s.vtxTop+s.nVtx; ++i)
+		{
+			colPtr[0]=smkCol.Rf();
+			colPtr[1]=smkCol.Gf();
+			colPtr[2]=smkCol.Bf();
+			colPtr[3]=alpha[isNewerEnd[i]];
+			colPtr+=4;
+		}
+	}
+
+	colBuf.AddArray((colPtr-col.GetArray())/4,col);
+}
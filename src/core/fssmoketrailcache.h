@@ -0,0 +1,72 @@
+#ifndef FSSMOKETRAILCACHE_IS_INCLUDED
+#define FSSMOKETRAILCACHE_IS_INCLUDED
+/* { */
+
+#include <ysclass.h>
+#include "fsdef.h"
+
+/*! Smoke-ribbon segments that do not change any more except for the transparency.
+
+    Near the airplane, the ribbon must be made from the flight record every frame.  The radius of the smoke grows
+    for the first second, and the ribbon is sampled at every record.  Beyond that, a segment between two records
+    has a fixed shape, and only the alpha changes linearly in time.  Such segments are made once, appended to this
+    cache as the airplane flies, and expired from the oldest end.
+
+    The alpha of a cached vertex is not stored.  Each vertex remembers which end of the segment it belongs to, and
+    the alpha is calculated from the record time of the end when the segments are copied to the draw buffers.
+*/
+class FsSmokeTrailCache
+{
+public:
+	class Segment
+	{
+	public:
+		YSSIZE_T recIdx0,recIdx1;  // Record indices of the older and the newer ends.
+		double tm0,tm1;            // Record times of the older and the newer ends.
+		YSSIZE_T vtxTop,nVtx;
+	};
+
+	// Parameters that the shape depends on.  The segments are discarded when one of them changes.
+	FSSMOKETYPE smk;
+	int step;
+	YsVec3 smkGen;
+
+	double lastTime;  // currentTime of the last update.  The segments are discarded when the time goes back.
+
+private:
+	YsArray <Segment> seg;         // Oldest first.  seg[0] to seg[segTop-1] have expired.
+	YSSIZE_T segTop;
+	YsArray <float> vtx,nom;       // Three values per vertex.
+	YsArray <unsigned char> isNewerEnd;
+
+public:
+	FsSmokeTrailCache();
+	void CleanUp(void);
+
+	YSBOOL IsEmpty(void) const;
+
+	/*! Returns the oldest segment.  The cache must not be empty. */
+	const Segment &Oldest(void) const;
+
+	/*! Returns the newest segment.  The cache must not be empty. */
+	const Segment &Newest(void) const;
+
+	/*! Removes the segments whose newer end is at or before t0.  AddSingleSmokeVertexArray does not draw
+	    such segments either. */
+	void Expire(double t0);
+
+	/*! Adds a segment newer than all the segments in the cache.
+	    The alpha of colBuf must be 0 at the older end and 1 at the newer end. */
+	void Add(
+	    YSSIZE_T recIdx0,double tm0,YSSIZE_T recIdx1,double tm1,
+	    const class YsGLVertexBuffer &vtxBuf,const class YsGLNormalBuffer &nomBuf,const class YsGLColorBuffer &colBuf);
+
+	/*! Adds the segments to the draw buffers from the newest to the oldest.
+	    The alpha is 0.8 at the record time, and decreases to zero in remainTime. */
+	void AddToBuffer(
+	    class YsGLVertexBuffer &vtxBuf,class YsGLNormalBuffer &nomBuf,class YsGLColorBuffer &colBuf,
+	    const YsColor &smkCol,double currentTime,double remainTime) const;
+};
+
+/* } */
+#endif
@@ -0,0 +1,149 @@
+#include <stdlib.h>
+#include <ysclass.h>
+#include <ysport.h>
+
+#include "fsairplaneproperty.h"
+#include "fstemplateindex.h"
+
+
+static const char *const fsAirplaneTemplateIndexHeader="AIRTMPLINDEX 1";
+
+FsAirplaneTemplateIndex::FsAirplaneTemplateIndex()
+{
+	CleanUp();
+}
+
+void FsAirplaneTemplateIndex::CleanUp(void)
+{
+	entry.ClearDeep();
+	datFnToEntry.CleanUp();
+	modified=YSFALSE;
+}
+
+YSRESULT FsAirplaneTemplateIndex::Load(const wchar_t fn[])
+{
+	CleanUp();
+
+	FILE *fp=YsFileIO::Fopen(fn,"r");
+	if(nullptr==fp)
+	{
+		return YSERR;
+	}
+
+	YsString str;
+	if(nullptr==str.Fgets(fp) || 0!=strcmp(str,fsAirplaneTemplateIndexHeader))
+	{
+		fclose(fp);
+		return YSERR;
+	}
+
+	// One entry per line.  Tab-separated so that the identifier and the path can have any character but a tab.
+	//   size<TAB>time<TAB>category<TAB>identifier<TAB>.dat path (UTF-8)
+	YsArray <YsString,8> field;
+	while(nullptr!=str.Fgets(fp))
+	{
+		field.CleanUp();
+		for(const char *ptr=str; ;)
+		{
+			const char *tab=strchr(ptr,'\t');
+			field.Increment();
+			if(nullptr==tab)
+			{
+				field.Last().Set(ptr);
+				break;
+			}
+			field.Last().Set(tab-ptr,ptr);
+			ptr=tab+1;
+		}
+
+		if(5==field.GetN() && 0<field[3].Strlen())
+		{
+			const FSAIRPLANECATEGORY airCat=FsGetAirplaneCategoryFromString(field[2]);
+			if(FSAC_UNKNOWN!=airCat)
+			{
+				YsWString datFn;
+				datFn.SetUTF8String(field[4]);
+				Update(datFn,atoll(field[0]),atoll(field[1]),field[3],airCat).used=YSFALSE;
+			}
+		}
+	}
+	fclose(fp);
+
+	modified=YSFALSE;
+	return YSOK;
+}
+
+YSRESULT FsAirplaneTemplateIndex::Save(const wchar_t fn[]) const
+{
+	FILE *fp=YsFileIO::Fopen(fn,"w");
+	if(nullptr==fp)
+	{
+		return YSERR;
+	}
+
+	fprintf(fp,"%s\n",fsAirplaneTemplateIndexHeader);
+	for(auto &e : entry)
+	{
+		// A category that has no string cannot be read back.  Such a .dat file is read every time.
+		const char *catStr=FsGetAirplaneCategoryString(e.airCat);
+		if(YSTRUE==e.used && 0!=catStr[0])
+		{
+			YsString datFnUtf8;
+			datFnUtf8.EncodeUTF8 <wchar_t> (e.datFn);
+			fprintf(fp,"%lld\t%lld\t%s\t%s\t%s\n",e.fileSize,e.fileTime,catStr,e.idName.Txt(),datFnUtf8.Txt());
+		}
+	}
+	fclose(fp);
+	return YSOK;
+}
+
+YSBOOL FsAirplaneTemplateIndex::NeedSave(void) const
+{
+	if(YSTRUE==modified)
+	{
+		return YSTRUE;
+	}
+	for(auto &e : entry)
+	{
+		if(YSTRUE!=e.used)
+		{
+			return YSTRUE;
+		}
+	}
+	return YSFALSE;
+}
+
+const FsAirplaneTemplateIndex::Entry *FsAirplaneTemplateIndex::Find(const wchar_t datFn[],long long int fileSize,long long int fileTime)
+{
+	auto idxPtr=datFnToEntry.FindAttrib(datFn);
+	if(nullptr!=idxPtr)
+	{
+		auto &e=entry[*idxPtr];
+		if(e.fileSize==fileSize && e.fileTime==fileTime)
+		{
+			e.used=YSTRUE;
+			return &e;
+		}
+	}
+	return nullptr;
+}
+
+FsAirplaneTemplateIndex::Entry &FsAirplaneTemplateIndex::Update(const wchar_t datFn[],long long int fileSize,long long int fileTime,const char idName[],FSAIRPLANECATEGORY airCat)
+{
+	auto idxPtr=datFnToEntry.FindAttrib(datFn);
+	if(nullptr==idxPtr)
+	{
+		datFnToEntry.AddWord(datFn,entry.GetN());
+		entry.Increment();
+		entry.Last().datFn.Set(datFn);
+	}
+
+	auto &e=(nullptr!=idxPtr ? entry[*idxPtr] : entry.Last());
+	e.fileSize=fileSize;
+	e.fileTime=fileTime;
+	e.idName.Set(idName);
+	e.airCat=airCat;
+	e.used=YSTRUE;
+	modified=YSTRUE;
+	return e;
+}
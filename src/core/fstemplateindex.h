@@ -0,0 +1,58 @@
+#ifndef FSTEMPLATEINDEX_IS_INCLUDED
+#define FSTEMPLATEINDEX_IS_INCLUDED
+/* { */
+
+#include <ysclass.h>
+#include "fsdef.h"
+
+/*! Identifiers and categories of the airplane templates, kept over sessions.
+
+    FsWorld::LoadAirplaneTemplate used to open every .dat file listed in aircraft/air*.lst and read it
+    until IDENTIFY and CATEGORY were found.  With this index, a .dat file is opened only when its size or
+    modification time differs from the one recorded, or when it is not in the index yet.
+
+    The list files themselves are read every time.  They are small, and they are what decides which
+    templates exist.  Therefore only the .dat files need to be validated.
+
+    Entries that were not looked up since Load are dropped by Save, so that templates removed from the
+    lists do not stay in the file forever.
+*/
+class FsAirplaneTemplateIndex
+{
+public:
+	class Entry
+	{
+	public:
+		YsWString datFn;
+		long long int fileSize,fileTime;
+		YsString idName;
+		FSAIRPLANECATEGORY airCat;
+		YSBOOL used;
+	};
+
+private:
+	YsArray <Entry> entry;
+	YsDictionary <YsWString,YSSIZE_T> datFnToEntry;
+	YSBOOL modified;
+
+public:
+	FsAirplaneTemplateIndex();
+	void CleanUp(void);
+
+	YSRESULT Load(const wchar_t fn[]);
+
+	/*! Writes the entries that were found or added since Load. */
+	YSRESULT Save(const wchar_t fn[]) const;
+
+	/*! Returns YSTRUE if Save would write something different from what Load read. */
+	YSBOOL NeedSave(void) const;
+
+	/*! Returns the entry of the .dat file if the size and the time match.  Otherwise returns nullptr. */
+	const Entry *Find(const wchar_t datFn[],long long int fileSize,long long int fileTime);
+
+	/*! Adds or replaces the entry of the .dat file. */
+	Entry &Update(const wchar_t datFn[],long long int fileSize,long long int fileTime,const char idName[],FSAIRPLANECATEGORY airCat);
+};
+
+/* } */
+#endif
@@ -624,8 +624,6 @@ FsWeapon::FsWeapon()
 
 	prev=NULL;
 	next=NULL;
-	prevFlare=NULL;
-	nextFlare=NULL;
 
 	trail=NULL;
 }
@@ -891,7 +889,7 @@ void FsWeapon::ThrowDebris(const double &/*ctime*/,const YsVec3 &p,const YsVec3
 	att=YsZeroAtt();
 }
 
-void FsWeapon::Move(const double &dt,const double &cTime,const FsWeather &weather,const FsWeapon *flareList)
+void FsWeapon::Move(const double &dt,const double &cTime,const FsWeather &weather,const FsFlareIndex &flareIndex)
 {
 	if(lifeRemain>0.0)
 	{
@@ -949,13 +947,22 @@ void FsWeapon::Move(const double &dt,const double &cTime,const FsWeather &weathe
 				tpos=mat*(target->GetPosition());
 				if(type==FSWEAPON_AIM9 || type==FSWEAPON_AIM9X || type==FSWEAPON_AIM120) // Extension 2001/11/23
 				{
-					const FsWeapon *flare;
 					YsVec3 flarePos;
 					double flareZ;
 					YSBOOL fooled;
 					fooled=YSFALSE;
 					flareZ=lifeRemain;
-					for(flare=flareList; flare!=NULL; flare=flare->nextFlare)
+
+					// A flare in the cone satisfies 0<z<lifeRemain and x*x+y*y<z*tan(radar), therefore it is within
+					// sqrt(lifeRemain*tan(radar)) from the segment from pos to lifeRemain ahead.
+					double searchRadius=-1.0;
+					if(radar<YsPi/2.0-0.01)
+					{
+						searchRadius=sqrt(lifeRemain*tan(radar)*1.01);
+					}
+					YsArray <const FsWeapon *,16> flareCandidate;
+					flareIndex.FindFlareCandidate(flareCandidate,pos,pos+att.GetForwardVector()*lifeRemain,searchRadius);
+					for(auto flare : flareCandidate)
 					{
 						flarePos=mat*flare->pos;
 						if(flarePos.z()>0.0 && flarePos.z()<flareZ &&
@@ -1547,6 +1554,13 @@ void FsWeapon::ExplodeBombInWater(
 // void FsWeapon::Draw(void)
 
 YSRESULT FsWeapon::AddKillCredit(YsList <FsKillCredit> *&killCredit,FsExistence *whoIsKilled,const double &when) const
+{
+	return AddKillCredit(killCredit,firedBy,creditOwner,type,pos,whoIsKilled,when);
+}
+
+/* static */ YSRESULT FsWeapon::AddKillCredit(
+    YsList <FsKillCredit> *&killCredit,FsExistence *firedBy,FSWEAPON_CREDIT_OWNER creditOwner,FSWEAPONTYPE type,
+    const YsVec3 &pos,FsExistence *whoIsKilled,const double &when)
 {
 	if(whoIsKilled!=NULL && whoIsKilled->isPlayingRecord!=YSTRUE)
 	{
@@ -1569,7 +1583,7 @@ YSRESULT FsWeapon::AddKillCredit(YsList <FsKillCredit> *&killCredit,FsExistence
 		neo->dat.where=pos;
 		neo->dat.when=when;
 
-		killCredit=killCredit->Append(neo);
+		killCredit=(NULL!=killCredit ? killCredit->Append(neo) : neo);  // Don't call a member function of NULL
 	}
 	return YSOK;
 }
@@ -1591,6 +1605,272 @@ void FsWeapon::AddToParticleManager(class YsGLParticleManager &partMan,const dou
 }
 
 // Implementation //////////////////////////////////////////
+FsGunRoundPool::FsGunRoundPool()
+{
+	nGroundHit=0;
+	Clear();
+}
+
+void FsGunRoundPool::Clear(void)
+{
+	nActive=0;
+}
+
+int FsGunRoundPool::Fire(
+    const YsVec3 &pos,const YsAtt3 &att,const double &v,const double &l,int destruction,
+    FsExistence *owner,FSWEAPON_CREDIT_OWNER creditOwnerIn)
+{
+	if(nActive<NumGunRoundBuffer)
+	{
+		const int idx=nActive++;
+
+		YsVec3 vec(0.0,0.0,v);
+		att.Mul(vec,vec); // vec=att.GetMatrix()*vec;
+
+		posX[idx]=pos.x();
+		posY[idx]=pos.y();
+		posZ[idx]=pos.z();
+		prvX[idx]=pos.x();
+		prvY[idx]=pos.y();
+		prvZ[idx]=pos.z();
+		lastCheckedX[idx]=pos.x();
+		lastCheckedY[idx]=pos.y();
+		lastCheckedZ[idx]=pos.z();
+		vecX[idx]=vec.x();
+		vecY[idx]=vec.y();
+		vecZ[idx]=vec.z();
+		velocity[idx]=v;
+		lifeRemain[idx]=l;
+		destructivePower[idx]=destruction;
+		firedBy[idx]=owner;
+		creditOwner[idx]=creditOwnerIn;
+		return idx;
+	}
+	return -1;
+}
+
+void FsGunRoundPool::Move(const double &dt,const YsVec3 &wind)
+{
+	// Same arithmetic as FsWeapon::Move for FSWEAPON_GUN.  No branch in the loops so that the compiler can vectorize them.
+	const double gravity=FsGravityConst*dt;
+	const YsVec3 windMove=wind*dt;
+	const int n=nActive;
+	for(int i=0; i<n; ++i)
+	{
+		vecY[i]=vecY[i]-gravity;
+	}
+	for(int i=0; i<n; ++i)
+	{
+		prvX[i]=posX[i];
+		posX[i]=posX[i]+vecX[i]*dt;
+		posX[i]+=windMove.x();
+	}
+	for(int i=0; i<n; ++i)
+	{
+		prvY[i]=posY[i];
+		posY[i]=posY[i]+vecY[i]*dt;
+		posY[i]+=windMove.y();
+	}
+	for(int i=0; i<n; ++i)
+	{
+		prvZ[i]=posZ[i];
+		posZ[i]=posZ[i]+vecZ[i]*dt;
+		posZ[i]+=windMove.z();
+	}
+	for(int i=0; i<n; ++i)
+	{
+		const double l=lifeRemain[i]-velocity[i]*dt;
+		lifeRemain[i]=(l<=YsTolerance ? 0.0 : l);
+	}
+}
+
+void FsGunRoundPool::Compact(void)
+{
+	// Rounds mostly expire in the order they were fired.  Shifting the remaining rounds would move almost all of
+	// them every step.  Fill the hole by the last round instead.
+	int i=0;
+	while(i<nActive)
+	{
+		if(YsTolerance<lifeRemain[i])
+		{
+			++i;
+			continue;
+		}
+
+		const int last=--nActive;
+		if(i!=last)
+		{
+			posX[i]=posX[last];
+			posY[i]=posY[last];
+			posZ[i]=posZ[last];
+			prvX[i]=prvX[last];
+			prvY[i]=prvY[last];
+			prvZ[i]=prvZ[last];
+			vecX[i]=vecX[last];
+			vecY[i]=vecY[last];
+			vecZ[i]=vecZ[last];
+			lastCheckedX[i]=lastCheckedX[last];
+			lastCheckedY[i]=lastCheckedY[last];
+			lastCheckedZ[i]=lastCheckedZ[last];
+			velocity[i]=velocity[last];
+			lifeRemain[i]=lifeRemain[last];
+			destructivePower[i]=destructivePower[last];
+			firedBy[i]=firedBy[last];
+			creditOwner[i]=creditOwner[last];
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////
+
+FsFlareIndex::FsFlareIndex()
+{
+	CleanUp();
+}
+
+void FsFlareIndex::CleanUp(void)
+{
+	allFlare.Clear();
+	allPos.Clear();
+	for(int axis=0; axis<3; ++axis)
+	{
+		sortedKey[axis].Clear();
+		sortedOrder[axis].Clear();
+	}
+	maxStep=0.0;
+}
+
+void FsFlareIndex::Build(const FsWeapon *activeList,const double &dt,const YsVec3 &wind)
+{
+	CleanUp();
+
+	YSBOOL seekerExist=YSFALSE;
+	for(const FsWeapon *wpn=activeList; wpn!=NULL; wpn=wpn->next)
+	{
+		if(wpn->type==FSWEAPON_FLARE)
+		{
+			allFlare.Append(wpn);
+		}
+		else if((wpn->type==FSWEAPON_AIM9 || wpn->type==FSWEAPON_AIM9X || wpn->type==FSWEAPON_AIM120) &&
+		        0.0<wpn->lifeRemain && NULL!=wpn->target)
+		{
+			seekerExist=YSTRUE;
+		}
+	}
+	if(YSTRUE!=seekerExist)
+	{
+		// Nobody will ask.
+		allFlare.Clear();
+		return;
+	}
+
+	// The seekers used to test flares from the last one in the active list.
+	for(YSSIZE_T i=0; i<allFlare.GetN()/2; ++i)
+	{
+		auto tmp=allFlare[i];
+		allFlare[i]=allFlare[allFlare.GetN()-1-i];
+		allFlare[allFlare.GetN()-1-i]=tmp;
+	}
+
+	// A flare may be moved before or after a seeker tests it.
+	// FsWeapon::Move adds the gravity before moving, and only slows down a flare after that.
+	const double windStep=wind.GetLength()*dt;
+	allPos.Resize(allFlare.GetN());
+	for(YSSIZE_T i=0; i<allFlare.GetN(); ++i)
+	{
+		auto flare=allFlare[i];
+		allPos[i]=flare->pos;
+		if(0.0<flare->lifeRemain)
+		{
+			const double step=(flare->vec.GetLength()+FsGravityConst*dt)*dt+windStep;
+			if(maxStep<step)
+			{
+				maxStep=step;
+			}
+		}
+	}
+
+	for(int axis=0; axis<3; ++axis)
+	{
+		sortedKey[axis].Resize(allFlare.GetN());
+		sortedOrder[axis].Resize(allFlare.GetN());
+		for(YSSIZE_T i=0; i<allFlare.GetN(); ++i)
+		{
+			sortedKey[axis][i]=allPos[i][axis];
+			sortedOrder[axis][i]=(int)i;
+		}
+		YsQuickSort <double,int> (sortedKey[axis].GetN(),sortedKey[axis],sortedOrder[axis]);
+	}
+}
+
+YSSIZE_T FsFlareIndex::GetNumFlare(void) const
+{
+	return allFlare.GetN();
+}
+
+void FsFlareIndex::FindFlareCandidate(
+    YsArray <const FsWeapon *,16> &flare,const YsVec3 &p0,const YsVec3 &p1,const double &radius) const
+{
+	flare.Clear();
+	if(0.0>radius)
+	{
+		flare=allFlare;
+		return;
+	}
+
+	const double r=radius+maxStep+1.0;  // 1.0m for the round-off error.
+
+	// Scan along the axis in which the segment is the shortest.
+	int axis=0;
+	for(int a=1; a<3; ++a)
+	{
+		if(fabs(p1[a]-p0[a])<fabs(p1[axis]-p0[axis]))
+		{
+			axis=a;
+		}
+	}
+	const double keyMin=YsSmaller(p0[axis],p1[axis])-r;
+	const double keyMax=YsGreater(p0[axis],p1[axis])+r;
+
+	const auto &key=sortedKey[axis];
+	YSSIZE_T lo=0,hi=key.GetN();
+	while(lo<hi)
+	{
+		const YSSIZE_T mid=(lo+hi)/2;
+		if(key[mid]<keyMin)
+		{
+			lo=mid+1;
+		}
+		else
+		{
+			hi=mid;
+		}
+	}
+
+	const YsVec3 d=p1-p0;
+	const double dd=d*d;
+	YsArray <int,16> order;
+	for(YSSIZE_T i=lo; i<key.GetN() && key[i]<=keyMax; ++i)
+	{
+		const int o=sortedOrder[axis][i];
+		const YsVec3 q=allPos[o]-p0;
+		double t=(YsTolerance<dd ? (q*d)/dd : 0.0);
+		t=YsBound(t,0.0,1.0);
+		if((q-d*t).GetSquareLength()<=r*r)
+		{
+			order.Append(o);
+		}
+	}
+
+	YsQuickSort <int,int> (order.GetN(),order,NULL);
+	for(auto o : order)
+	{
+		flare.Append(allFlare[o]);
+	}
+}
+
+////////////////////////////////////////////////////////////
+
 FsWeaponHolder::FsWeaponHolder(FsSimulation *simPtr) : sim(simPtr)
 {
 	LoadMissilePattern();
@@ -1619,7 +1899,10 @@ FsWeaponHolder::~FsWeaponHolder()
 	{
 		delete toPlay;
 	}
-	killCredit->DeleteList();
+	if(killCredit!=NULL)
+	{
+		killCredit->DeleteList();
+	}
 }
 
 YSRESULT FsWeaponHolder::LoadMissilePattern(void)
@@ -2085,7 +2368,7 @@ YSRESULT FsWeaponHolder::Save(FILE *fp,FsSimulation *sim,int wpnPosPrecision,int
 			}
 		}
 
-		if(killCredit->GetNumObject()>0)
+		if(killCredit!=NULL && killCredit->GetNumObject()>0)
 		{
 			YsList <FsKillCredit> *kcSeeker;
 			fprintf(fp,"KILLCREDIT 1 %d\n",killCredit->GetNumObject());  // 1 : Version 1
@@ -2160,8 +2443,11 @@ YSRESULT FsWeaponHolder::Load(FILE *fp,FsSimulation *sim)
 		delete toPlay;
 		toPlay=NULL;
 	}
-	killCredit->DeleteList();
-	killCredit=NULL;
+	if(killCredit!=NULL)
+	{
+		killCredit->DeleteList();
+		killCredit=NULL;
+	}
 
 	toPlay=new FsRecord <FsWeaponRecord>;
 
@@ -2433,7 +2719,7 @@ YSRESULT FsWeaponHolder::Load(FILE *fp,FsSimulation *sim)
 							neo->dat.where.Set(x,y,z);
 							neo->dat.when=when;
 						}
-						killCredit=killCredit->Append(neo);
+						killCredit=(NULL!=killCredit ? killCredit->Append(neo) : neo);
 					}
 					else
 					{
@@ -2494,6 +2780,8 @@ void FsWeaponHolder::Clear(void)
 	activeList=NULL;
 	freeList=&buf[0];
 
+	gunRound.Clear();
+
 	bulletCalibrator.Clear();
 }
 
@@ -2585,49 +2873,51 @@ void FsWeaponHolder::ClearBulletCalibrator(void)
 void FsWeaponHolder::CalculateBulletCalibrator(const FsExistence *target)
 {
 	ClearBulletCalibrator();
-	for(FsWeapon *seeker=activeList; seeker!=NULL; seeker=seeker->next)
+	for(int i=0; i<gunRound.nActive; ++i)
 	{
-		if(FSWEAPON_GUN==seeker->type)
-		{
-			const YsVec3 &prv=seeker->prv;
-			const YsVec3 &pos=seeker->pos;
+		const YsVec3 prv=gunRound.GetPrevPosition(i);
+		const YsVec3 pos=gunRound.GetPosition(i);
 
-			YsVec3 nearPos;
-			if(YSTRUE==YsCheckInBetween3(target->GetPosition(),pos,prv) &&
-			   YSOK==YsGetNearestPointOnLine3(nearPos,prv,pos,target->GetPosition()))
-			{
-				bulletCalibrator.Append(nearPos);
-			}
+		YsVec3 nearPos;
+		if(YSTRUE==YsCheckInBetween3(target->GetPosition(),pos,prv) &&
+		   YSOK==YsGetNearestPointOnLine3(nearPos,prv,pos,target->GetPosition()))
+		{
+			bulletCalibrator.Append(nearPos);
 		}
 	}
 }
 
 YSBOOL FsWeaponHolder::GiveDamage(YSBOOL &killed,FsExistence &obj,int destPower,FSDIEDOF diedOf,FsWeapon &wpn)
+{
+	return GiveDamage(killed,obj,destPower,diedOf,wpn.firedBy,wpn.type);
+}
+
+YSBOOL FsWeaponHolder::GiveDamage(YSBOOL &killed,FsExistence &obj,int destPower,FSDIEDOF diedOf,FsExistence *firedBy,FSWEAPONTYPE wpnType)
 {
 	if(&obj!=NULL && obj.GetDamage(killed,destPower,diedOf)==YSTRUE)
 	{
 		if(YSTRUE==killed && NULL!=netServer)
 		{
-			netServer->ReportKill(&obj,wpn.firedBy,wpn.type);
+			netServer->ReportKill(&obj,firedBy,wpnType);
 		}
 
 		// Network Transmission
-		if(wpn.firedBy!=NULL && wpn.firedBy->netType==FSNET_LOCAL)
+		if(firedBy!=NULL && firedBy->netType==FSNET_LOCAL)
 		{
 			if(NULL!=netServer)
 			{
-				netServer->BroadcastGetDamage(&obj,wpn.firedBy,destPower,diedOf);
+				netServer->BroadcastGetDamage(&obj,firedBy,destPower,diedOf);
 			}
 			if(NULL!=netClient)
 			{
-				netClient->SendGetDamage(&obj,wpn.firedBy,destPower,diedOf,wpn.type);
+				netClient->SendGetDamage(&obj,firedBy,destPower,diedOf,wpnType);
 			}
 		}
-		else if(wpn.firedBy==NULL)  // Let's assume it's server's local.
+		else if(firedBy==NULL)  // Let's assume it's server's local.
 		{
 			if(netServer!=NULL)
 			{
-				netServer->BroadcastGetDamage(&obj,wpn.firedBy,destPower,diedOf);
+				netServer->BroadcastGetDamage(&obj,firedBy,destPower,diedOf);
 			}
 		}
 		return YSTRUE;
@@ -2732,13 +3022,10 @@ int FsWeaponHolder::Fire
      FsExistence *owner,
      YSBOOL recordIt,YSBOOL /*transmit*/)
 {
-	if(freeList!=NULL)
+	FSWEAPON_CREDIT_OWNER creditOwner=(sim->GetPlayerObject()==owner ? FSWEAPON_CREDIT_OWNER_PLAYER : FSWEAPON_CREDIT_OWNER_NON_PLAYER);
+	const int idx=gunRound.Fire(pos,att,v,l,destructivePower,owner,creditOwner);
+	if(0<=idx)
 	{
-		FsWeapon *toShoot=freeList;
-		FSWEAPON_CREDIT_OWNER creditOwner=(sim->GetPlayerObject()==owner ? FSWEAPON_CREDIT_OWNER_PLAYER : FSWEAPON_CREDIT_OWNER_NON_PLAYER);
-
-		toShoot->Fire(ctime,pos,att,v,l,destructivePower,owner,creditOwner);
-		MoveToActiveList(toShoot);
 
 		if(recordIt==YSTRUE && toSave!=NULL)
 		{
@@ -2762,7 +3049,7 @@ int FsWeaponHolder::Fire
 
 			toSave->AddElement(rec,ctime);
 		}
-		return (int)(toShoot-buf);
+		return idx;
 	}
 	return -1;
 }
@@ -3127,6 +3414,16 @@ const FsWeapon *FsWeaponHolder::FindNextActiveWeapon(const FsWeapon *wpn) const
 	}
 }
 
+YSBOOL FsWeaponHolder::IsAnyWeaponActive(void) const
+{
+	return (NULL!=activeList || 0<gunRound.nActive ? YSTRUE : YSFALSE);
+}
+
+const FsGunRoundPool &FsWeaponHolder::GetGunRoundPool(void) const
+{
+	return gunRound;
+}
+
 const FsWeapon *FsWeaponHolder::GetWeapon(int id) const
 {
 	if(0<=id && id<NumBulletBuffer)
@@ -3139,7 +3436,7 @@ const FsWeapon *FsWeaponHolder::GetWeapon(int id) const
 	}
 }
 
-void FsWeaponHolder::ObjectIsDeleted(FsExistence *obj) const
+void FsWeaponHolder::ObjectIsDeleted(FsExistence *obj)
 {
 	FsWeapon *wpn;
 	for(wpn=activeList; wpn!=NULL; wpn=wpn->next)
@@ -3153,6 +3450,14 @@ void FsWeaponHolder::ObjectIsDeleted(FsExistence *obj) const
 			wpn->target=NULL;
 		}
 	}
+
+	for(int i=0; i<gunRound.nActive; ++i)
+	{
+		if(gunRound.firedBy[i]==obj)
+		{
+			gunRound.firedBy[i]=NULL;
+		}
+	}
 }
 
 void FsWeaponHolder::Move(const double &dt,const double &cTime,const FsWeather &weather)
@@ -3160,32 +3465,21 @@ void FsWeaponHolder::Move(const double &dt,const double &cTime,const FsWeather &
 	FsWeapon *seeker,*nxt;
 	FSWEAPONTYPE type;
 
-	FsWeapon *flareList;
-	flareList=NULL;
-	for(seeker=activeList; seeker!=NULL; seeker=seeker->next)
-	{
-		if(seeker->type==FSWEAPON_FLARE)
-		{
-			seeker->prevFlare=NULL;
-			seeker->nextFlare=flareList;
-			if(seeker->nextFlare!=NULL)
-			{
-				seeker->nextFlare->prevFlare=seeker;
-			}
-			flareList=seeker;
-		}
-	}
+	flareIndex.Build(activeList,dt,weather.GetWind());
 
 	for(seeker=activeList; seeker!=NULL; seeker=nxt)
 	{
 		nxt=seeker->next;
 		type=seeker->type;
-		seeker->Move(dt,cTime,weather,flareList);
+		seeker->Move(dt,cTime,weather,flareIndex);
 		if(seeker->lifeRemain<=YsTolerance && seeker->timeRemain<=YsTolerance)
 		{
 			MoveToFreeList(seeker);
 		}
 	}
+
+	gunRound.Move(dt,weather.GetWind());
+	gunRound.Compact();
 }
 
 void FsWeaponHolder::HitGround(
@@ -3207,6 +3501,123 @@ void FsWeaponHolder::HitGround(
 	NEXT:
 		;
 	}
+
+	GunRoundHitGround(ctime,field,explosion,sim);
+}
+
+void FsWeaponHolder::GunRoundHitGround(
+    const double &ctime,const class FsField &field,FsExplosionHolder *explosion,class FsSimulation *sim)
+{
+	const int n=gunRound.nActive;
+	if(0==n)
+	{
+		return;
+	}
+
+	gunRoundXz.Resize(n);
+	gunRoundElv.Resize(n);
+	for(int i=0; i<n; ++i)
+	{
+		gunRoundXz[i].Set(gunRound.posX[i],gunRound.posZ[i]);
+	}
+	field.GetFieldElevationAndNormal(n,gunRoundXz,gunRoundElv,nullptr);
+
+	// Rounds above the ground are checked against the field shells in one batch.
+	auto aboveGround=[&](int i)
+	{
+		return (0.0<gunRound.lifeRemain[i] && gunRound.posY[i]>gunRoundElv[i]+YsTolerance);
+	};
+	gunRoundSeg[0].Clear();
+	gunRoundSeg[1].Clear();
+	for(int i=0; i<n; ++i)
+	{
+		if(true==aboveGround(i))
+		{
+			gunRoundSeg[0].Append(gunRound.GetPrevPosition(i));
+			gunRoundSeg[1].Append(gunRound.GetPosition(i));
+		}
+	}
+	gunRoundShellColl.Resize(gunRoundSeg[0].GetN());
+	gunRoundShellItsc.Resize(gunRoundSeg[0].GetN());
+	field.GetFieldShellCollision(gunRoundSeg[0].GetN(),gunRoundSeg[0],gunRoundSeg[1],gunRoundShellColl,gunRoundShellItsc);
+
+	// Same as FsWeapon::HitGround for FSWEAPON_GUN.
+	YSSIZE_T shellIdx=0;
+	for(int i=0; i<n; ++i)
+	{
+		if(0.0>=gunRound.lifeRemain[i])
+		{
+			continue;
+		}
+
+		const YsVec3 prv=gunRound.GetPrevPosition(i);
+		YsVec3 pos=gunRound.GetPosition(i);
+		double elv=gunRoundElv[i];
+
+		int collType=0; // 1:Ground  2:Shell
+		YsVec3 shellItsc;
+		if(true!=aboveGround(i))
+		{
+			collType=1;
+		}
+		else
+		{
+			if(YSTRUE==gunRoundShellColl[shellIdx])
+			{
+				collType=2;
+				shellItsc=gunRoundShellItsc[shellIdx];
+			}
+			++shellIdx;
+		}
+
+		if(collType!=0)
+		{
+			gunRound.lifeRemain[i]=0.0;
+			if(explosion!=NULL)
+			{
+				if((gunRound.nGroundHit&3)==0)
+				{
+					// See FsWeapon::HitGround for the reason why the intersection is calculated only for guns.
+					const YsSceneryItem *evg=NULL;
+					YSSCNAREATYPE areaType=YSSCNAREA_NOAREA;
+					if(collType==1)
+					{
+						evg=field.GetFieldElevation(elv,pos.x(),pos.z());
+						areaType=sim->GetAreaType(pos);
+
+						YsVec3 cen,nom,crs;
+						YsPlane pln;
+						cen=pos;
+						cen.SetY(elv);
+
+						field.GetFieldElevationAndNormal(elv,nom,pos.x(),pos.z());
+						pln.Set(cen,nom);
+						if(pln.GetIntersection(crs,pos,pos-prv)==YSOK)
+						{
+							pos=crs;
+						}
+					}
+					else if(collType==2)
+					{
+						pos=shellItsc;
+					}
+					gunRound.SetPosition(i,pos);
+
+					if(evg==NULL && collType==1 && areaType==YSSCNAREA_WATER)
+					{
+						explosion->WaterPlume(ctime,pos,3.0,1.0,10.0,NULL,YSFALSE);
+					}
+					else
+					{
+						explosion->Explode(ctime,pos,1.0,0.0,5.0,YSTRUE,NULL,YSFALSE);
+					}
+				}
+				gunRound.nGroundHit=(gunRound.nGroundHit+1)&255;
+			}
+		}
+	}
+
+	gunRound.Compact();
 }
 
 void FsWeaponHolder::HitObject(
@@ -3225,10 +3636,12 @@ void FsWeaponHolder::HitObject(
 		nxt=seeker->next;
 
 		/* Smarter version */
+		// The margin covers the proximity tube of the air-to-air missiles in FsWeapon::HitObject.
+		const double proximityMargin=25.0;
 		YsArray <FsAirplane *,256> airCandidate;
 		YsArray <FsGround *,256> gndCandidate;
-		sim->GetLattice().GetAirCollisionCandidate(airCandidate,seeker->pos,seeker->lastChecked);
-		sim->GetLattice().GetGndCollisionCandidate(gndCandidate,seeker->pos,seeker->lastChecked);
+		sim->GetBroadPhase().GetAirCollisionCandidateOnSegment(airCandidate,seeker->lastChecked,seeker->pos,proximityMargin);
+		sim->GetBroadPhase().GetGndCollisionCandidateOnSegment(gndCandidate,seeker->lastChecked,seeker->pos,proximityMargin);
 
 		for(int j=0; j<airCandidate.GetN(); j++)
 		{
@@ -3334,6 +3747,137 @@ void FsWeaponHolder::HitObject(
 			MoveToFreeList(seeker);
 		}
 	}
+
+	GunRoundHitObject(ctime,explo,sim);
+}
+
+void FsWeaponHolder::GunRoundHitObject(const double &ctime,FsExplosionHolder *explosion,FsSimulation *sim)
+{
+	const int n=gunRound.nActive;
+	if(0==n)
+	{
+		return;
+	}
+
+	gunRoundSeg[0].Resize(n);
+	gunRoundSeg[1].Resize(n);
+	for(int i=0; i<n; ++i)
+	{
+		gunRoundSeg[0][i]=gunRound.GetLastChecked(i);
+		gunRoundSeg[1][i]=gunRound.GetPosition(i);
+	}
+
+	// Gun rounds do not have the proximity tube.  The margin only needs to cover the tolerance.
+	const double margin=1.0;
+	sim->GetBroadPhase().GetCollisionCandidateOnSegments(gunRoundAirCan,gunRoundGndCan,n,gunRoundSeg[0],gunRoundSeg[1],margin);
+
+	YSSIZE_T airCanIdx=0,gndCanIdx=0;
+	for(int i=0; i<n; ++i)
+	{
+		for(; airCanIdx<gunRoundAirCan.GetN() && gunRoundAirCan[airCanIdx].segIdx==i; ++airCanIdx)
+		{
+			FsAirplane *air=gunRoundAirCan[airCanIdx].obj;
+			if(air->Prop().IsAlive()==YSTRUE && GunRoundHitObject(i,ctime,*air,explosion,sim)==YSTRUE)
+			{
+				if(air->Prop().IsActive()==YSTRUE)
+				{
+					if(air==sim->GetPlayerAirplane())
+					{
+						FsSoundSetOneTime(FSSND_ONETIME_DAMAGE);
+					}
+					else
+					{
+						FsSoundSetOneTime(FSSND_ONETIME_HIT);
+					}
+				}
+				else
+				{
+					FsSoundSetOneTime(FSSND_ONETIME_BLAST);
+				}
+			}
+		}
+		for(; gndCanIdx<gunRoundGndCan.GetN() && gunRoundGndCan[gndCanIdx].segIdx==i; ++gndCanIdx)
+		{
+			FsGround *gnd=gunRoundGndCan[gndCanIdx].obj;
+			if(gnd->Prop().IsAlive()==YSTRUE && GunRoundHitObject(i,ctime,*gnd,explosion,sim)==YSTRUE)
+			{
+				if(gnd->Prop().IsAlive()==YSTRUE)
+				{
+					FsSoundSetOneTime(FSSND_ONETIME_HIT);
+				}
+				else
+				{
+					FsSoundSetOneTime(FSSND_ONETIME_BLAST);
+				}
+			}
+		}
+	}
+
+	for(int i=0; i<n; ++i)
+	{
+		gunRound.lastCheckedX[i]=gunRound.posX[i];
+		gunRound.lastCheckedY[i]=gunRound.posY[i];
+		gunRound.lastCheckedZ[i]=gunRound.posZ[i];
+	}
+
+	gunRound.Compact();
+}
+
+YSBOOL FsWeaponHolder::GunRoundHitObject(int idx,const double &ctime,FsExistence &obj,FsExplosionHolder *explosion,FsSimulation *sim)
+{
+	// Same as FsWeapon::HitObject for FSWEAPON_GUN.
+	if(0.0<gunRound.lifeRemain[idx] && gunRound.firedBy[idx]!=&obj)
+	{
+		const YsVec3 pos=gunRound.GetPosition(idx);
+		const YsVec3 lastChecked=gunRound.GetLastChecked(idx);
+		const YsVec3 &tpos=obj.GetPosition();
+		const double rad=obj.GetApproximatedCollideRadius();
+
+		const double sqDist1=(pos-tpos).GetSquareLength();
+		const double sqDist2=(lastChecked-tpos).GetSquareLength();
+		const double sqLastMovedDist=(lastChecked-pos).GetSquareLength();
+		if(sqDist1<=sqLastMovedDist+rad*rad ||
+		   sqDist2<=sqLastMovedDist+rad*rad)
+		{
+			YsVec3 np;
+			YsGetNearestPointOnLine3(np,pos,lastChecked,tpos);
+			const double sqDist3=(np-tpos).GetSquareLength();
+			if(sqDist1>rad*rad && sqDist2>rad*rad && sqDist3>rad*rad)
+			{
+				return YSFALSE;
+			}
+
+			YsShellPolygonHandle plHd;
+			YsVec3 intersect;
+			plHd=obj.TransformedCollisionShell().ShootRayH(intersect,lastChecked,pos-lastChecked);
+
+			if(plHd!=NULL && YsCheckInBetween3(intersect,pos,lastChecked)==YSTRUE)
+			{
+				YSBOOL killed;
+				gunRound.lifeRemain[idx]=0.0;
+
+				FsExistence *firedBy=gunRound.firedBy[idx];
+				if(GiveDamage(killed,obj,gunRound.destructivePower[idx],FSDIEDOF_GUN,firedBy,FSWEAPON_GUN)==YSTRUE &&
+				   explosion!=NULL)
+				{
+					ThrowRandomDebris(ctime,intersect,obj.GetAttitude(),60.0);
+					if(killed==YSTRUE)
+					{
+						ThrowMultiDebris(5,ctime,pos,obj.GetAttitude(),60.0);
+						sim->KillCallBack(obj,tpos);
+						FsWeapon::AddKillCredit(killCredit,firedBy,gunRound.creditOwner[idx],FSWEAPON_GUN,pos,&obj,ctime);
+					}
+					else
+					{
+						explosion->Explode(ctime,intersect,5.0,3.0,3.0,YSTRUE,NULL,YSTRUE);
+					}
+				}
+
+				return YSTRUE;
+			}
+		}
+	}
+	return YSFALSE;
 }
 
 void FsWeaponHolder::Draw(
@@ -3345,6 +3889,29 @@ void FsWeaponHolder::Draw(
 	{
 		seeker->Draw(coarse,viewMat,projMat,transparency,smk,cTime,drawFlag);
 	}
+
+	// Gun rounds are drawn through a temporary FsWeapon so that the graphics back ends and the weapon-shape
+	// override stay the same.
+	FsWeapon round;
+	round.type=FSWEAPON_GUN;
+	round.timeRemain=0.0;
+	round.trail=NULL;
+	round.target=NULL;
+	for(int i=0; i<gunRound.nActive; ++i)
+	{
+		round.pos=gunRound.GetPosition(i);
+		round.prv=gunRound.GetPrevPosition(i);
+		round.vec=gunRound.GetVelocity(i);
+		round.lastChecked=gunRound.GetLastChecked(i);
+		round.velocity=gunRound.velocity[i];
+		round.lifeRemain=gunRound.lifeRemain[i];
+		round.destructivePower=gunRound.destructivePower[i];
+		round.firedBy=gunRound.firedBy[i];
+		round.creditOwner=gunRound.creditOwner[i];
+		round.att.SetForwardVector(round.vec);
+		round.att.SetB(0.0);
+		round.Draw(coarse,viewMat,projMat,transparency,smk,cTime,drawFlag);
+	}
 }
 
 void FsWeaponHolder::CollectRecord(void)
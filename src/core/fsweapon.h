@@ -7,6 +7,7 @@
 #include "fsdef.h"
 #include "fsrecord.h"
 #include "fsinstreading.h"
+#include "fsbroadphase.h"
 
 class FsWeaponRecord
 {
@@ -82,7 +83,6 @@ public:
 
 
 	FsWeapon *prev,*next;
-	FsWeapon *prevFlare,*nextFlare;
 
 	FSWEAPONTYPE type;
 
@@ -171,7 +171,7 @@ public:
 	void ThrowDebris(const double &ctime,const YsVec3 &pos,const YsVec3 &vec,const double &l);
 
 
-	void Move(const double &dt,const double &cTime,const class FsWeather &weather,const FsWeapon *flareList);
+	void Move(const double &dt,const double &cTime,const class FsWeather &weather,const class FsFlareIndex &flareIndex);
 	YSBOOL IsOwnerStillHaveTarget(void);
 	void HitGround
 	    (class FsWeaponHolder *callback,
@@ -209,12 +209,120 @@ public:
 
 	void AddToParticleManager(class YsGLParticleManager &partMan,const double cTime) const;
 
+	static YSRESULT AddKillCredit(
+	    YsList <FsKillCredit> *&killCredit,FsExistence *firedBy,FSWEAPON_CREDIT_OWNER creditOwner,FSWEAPONTYPE type,
+	    const YsVec3 &pos,FsExistence *whoIsKilled,const double &when);
+
 protected:
 	YSRESULT AddKillCredit(YsList <FsKillCredit> *&killCredit,FsExistence *whoIsKilled,const double &when) const;
 };
 
 
 
+// Declaration /////////////////////////////////////////////
+/*! Gun rounds in the structure-of-arrays layout.
+
+    A gun round only has a position, a velocity, and the remaining range, but there can be hundreds of them in flight.
+    The active rounds are always packed in [0,nActive) of the arrays, so that FsWeaponHolder can move them in one
+    loop over contiguous memory, and check all of them against the broad phase in one query.
+    A gun round behaves the same as an FsWeapon of FSWEAPON_GUN.
+*/
+class FsGunRoundPool
+{
+public:
+	enum
+	{
+		NumGunRoundBuffer=1024
+	};
+
+	int nActive;
+
+	double posX[NumGunRoundBuffer],posY[NumGunRoundBuffer],posZ[NumGunRoundBuffer];
+	double prvX[NumGunRoundBuffer],prvY[NumGunRoundBuffer],prvZ[NumGunRoundBuffer];
+	double vecX[NumGunRoundBuffer],vecY[NumGunRoundBuffer],vecZ[NumGunRoundBuffer];
+	double lastCheckedX[NumGunRoundBuffer],lastCheckedY[NumGunRoundBuffer],lastCheckedZ[NumGunRoundBuffer];
+	double velocity[NumGunRoundBuffer];    // Muzzle velocity.  The range is consumed by this velocity as FsWeapon::Move does.
+	double lifeRemain[NumGunRoundBuffer];  // Life remaining by distance
+	int destructivePower[NumGunRoundBuffer];
+	class FsExistence *firedBy[NumGunRoundBuffer];
+	FSWEAPON_CREDIT_OWNER creditOwner[NumGunRoundBuffer];
+
+	unsigned int nGroundHit;  // Only one of four rounds that hit the ground makes an explosion.
+
+	FsGunRoundPool();
+	void Clear(void);
+
+	/*! Fires a gun round, and returns the index, or -1 if the pool is full.  The index is valid until the next Compact. */
+	int Fire(
+	    const YsVec3 &pos,const YsAtt3 &att,const double &v,const double &l,int destruction,
+	    class FsExistence *owner,FSWEAPON_CREDIT_OWNER creditOwnerIn);
+
+	/*! Applies the gravity and the wind, and consumes the range of the active rounds. */
+	void Move(const double &dt,const YsVec3 &wind);
+
+	/*! Removes the rounds that have no life remaining.  The remaining rounds may be reordered. */
+	void Compact(void);
+
+	inline YsVec3 GetPosition(int idx) const
+	{
+		return YsVec3(posX[idx],posY[idx],posZ[idx]);
+	}
+	inline YsVec3 GetPrevPosition(int idx) const
+	{
+		return YsVec3(prvX[idx],prvY[idx],prvZ[idx]);
+	}
+	inline YsVec3 GetVelocity(int idx) const
+	{
+		return YsVec3(vecX[idx],vecY[idx],vecZ[idx]);
+	}
+	inline YsVec3 GetLastChecked(int idx) const
+	{
+		return YsVec3(lastCheckedX[idx],lastCheckedY[idx],lastCheckedZ[idx]);
+	}
+	inline void SetPosition(int idx,const YsVec3 &pos)
+	{
+		posX[idx]=pos.x();
+		posY[idx]=pos.y();
+		posZ[idx]=pos.z();
+	}
+};
+
+
+
+// Declaration /////////////////////////////////////////////
+/*! Active flares sorted along x, y, and z for the IR seekers.
+
+    FsWeaponHolder builds it once per Move before any weapon is moved.  Since the flares move during the same loop
+    as the seekers, FindFlareCandidate widens the search radius by the maximum distance a flare can travel in the
+    step, and returns the candidates in the same order as the old linked list of flares, so that the seeker picks
+    exactly the same flare as testing every flare.
+*/
+class FsFlareIndex
+{
+private:
+	YsArray <const FsWeapon *> allFlare;  // In the order the seeker tests them.
+	YsArray <YsVec3> allPos;              // Position of allFlare[i] when the index was built.
+	YsArray <double> sortedKey[3];        // x, y, and z of the flares, sorted.
+	YsArray <int> sortedOrder[3];         // Index to allFlare for sortedKey[axis][i].
+	double maxStep;
+
+public:
+	FsFlareIndex();
+	void CleanUp(void);
+
+	/*! Collects flares from activeList.  dt and wind must be the ones given to FsWeapon::Move in this step. */
+	void Build(const FsWeapon *activeList,const double &dt,const YsVec3 &wind);
+
+	YSSIZE_T GetNumFlare(void) const;
+
+	/*! Returns flares that may be within radius from line segment p0-p1 at any time in this step, in the order the
+	    seeker tests them.  If radius is negative, it returns all flares. */
+	void FindFlareCandidate(
+	    YsArray <const FsWeapon *,16> &flare,const YsVec3 &p0,const YsVec3 &p1,const double &radius) const;
+};
+
+
+
 // Declaration /////////////////////////////////////////////
 class FsWeaponHolder
 {
@@ -248,6 +356,7 @@ public:
 
 
 	YSBOOL GiveDamage(YSBOOL &killed,FsExistence &obj,int power,enum FSDIEDOF diedOf,FsWeapon &wpn);
+	YSBOOL GiveDamage(YSBOOL &killed,FsExistence &obj,int power,enum FSDIEDOF diedOf,FsExistence *firedBy,FSWEAPONTYPE wpnType);
 
 	YSRESULT RipOffEarlyPartOfRecord(void);
 
@@ -255,7 +364,7 @@ public:
 
 	YSRESULT RefreshOrdinanceByWeaponRecord(const double &currentTime);
 
-	// Firing Gun
+	// Firing Gun  Returns the index in gunRound.
 	int Fire
 	    (const double &ctime,
 	     YsVec3 &pos,
@@ -304,9 +413,12 @@ public:
 	YSRESULT FindOldestMissilePosition(YsVec3 &vec,YsAtt3 &att,const FsExistence *fired) const;
 	YSRESULT FindNewestMissilePosition(YsVec3 &vec,YsAtt3 &att,const FsExistence *fired) const;
 
+	/*! Gun rounds are not in the list.  See GetGunRoundPool. */
 	const FsWeapon *FindNextActiveWeapon(const FsWeapon *wpn) const;
+	YSBOOL IsAnyWeaponActive(void) const;
+	const FsGunRoundPool &GetGunRoundPool(void) const;
 	const FsWeapon *GetWeapon(int id) const;
-	void ObjectIsDeleted(FsExistence *obj) const;
+	void ObjectIsDeleted(FsExistence *obj);
 
 	void Move(const double &dt,const double &cTime,const class FsWeather &weather);
 	void HitGround(
@@ -331,7 +443,9 @@ public:
 	FsWeapon buf[NumBulletBuffer];
 	FsWeaponSmokeTrail trl[NumSmokeTrailBuffer];
 
-	FsWeapon *activeList,*freeList;
+	FsWeapon *activeList,*freeList;   // Missiles, bombs, flares, and debris
+	FsFlareIndex flareIndex;
+	FsGunRoundPool gunRound;
 
 	FsRecord <FsWeaponRecord> *toPlay;
 	FsRecord <FsWeaponRecord> *toSave;
@@ -341,6 +455,19 @@ public:
 protected:
 	FsExistence *FindObjectByAxxGxxN(const char identifier[],const class FsSimulation *sim);
 
+	void GunRoundHitGround(const double &ctime,const class FsField &field,FsExplosionHolder *explosion,class FsSimulation *sim);
+	void GunRoundHitObject(const double &ctime,FsExplosionHolder *explosion,class FsSimulation *sim);
+	YSBOOL GunRoundHitObject(int idx,const double &ctime,FsExistence &obj,FsExplosionHolder *explosion,class FsSimulation *sim);
+
+	// Work buffers for the batched gun-round queries.
+	YsArray <YsVec2> gunRoundXz;
+	YsArray <double> gunRoundElv;
+	YsArray <YSBOOL> gunRoundShellColl;
+	YsArray <YsVec3> gunRoundShellItsc;
+	YsArray <YsVec3> gunRoundSeg[2];
+	YsArray <FsBroadPhase::SegmentCandidate <FsAirplane> > gunRoundAirCan;
+	YsArray <FsBroadPhase::SegmentCandidate <FsGround> > gunRoundGndCan;
+
 
 // For network play
 protected:
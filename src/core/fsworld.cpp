@@ -25,6 +25,7 @@
 #include <fsairproperty.h>
 
 #include "fs.h"
+#include "fsbinaryrecord.h"
 
 #include "fsgui.h"
 #include "fsguiselectiondialogbase.h"
@@ -56,6 +57,7 @@ static YSRESULT YsLoadFld(YsScenery &scn,const wchar_t fn[])
 		YsFileIO::ChDir(pth);
 		YSRESULT res=scn.LoadFld(fp);
 		scn.CacheMapDrawingOrder();
+		scn.CacheElevationIndex();
 
 		YsFileIO::ChDir(curPath);
 
@@ -83,12 +85,6 @@ FsAirplaneTemplate::FsAirplaneTemplate()
 	lod=NULL;
 	coll=NULL;
 
-	for(int i=0; i<FSWEAPON_NUMWEAPONTYPE; i++)
-	{
-		weaponShapeOverride[0][i]=NULL;
-		weaponShapeOverride[1][i]=NULL;
-	}
-
 	SetPropFileName(L"");
 	SetVisualFileName(L"");
 	SetCockpitFileName(L"");
@@ -114,6 +110,9 @@ void FsAirplaneTemplate::Initialize(void)
 
 void FsAirplaneTemplate::Unprepare(void)
 {
+	// Workers do not touch the template.  The models being streamed are simply dropped.
+	streamedModel.ClearDeep();
+
 	vis.CleanUp();
 	cockpit.CleanUp();
 	lod.CleanUp();
@@ -127,11 +126,8 @@ void FsAirplaneTemplate::Unprepare(void)
 		delete prop;
 		prop=NULL;
 	}
-	for(int i=0; i<(int)FSWEAPON_NUMWEAPONTYPE; i++)
-	{
-		weaponShapeOverride[0][i].CleanUp();
-		weaponShapeOverride[1][i].CleanUp();
-	}
+	weaponShapeOverride[0].reset();
+	weaponShapeOverride[1].reset();
 }
 
 FsAirplaneTemplate::~FsAirplaneTemplate()
@@ -243,6 +239,10 @@ FsVisualDnm FsAirplaneTemplate::GetVisual(void) const
 		return NULL;
 	}
 
+	if(nullptr==vis)
+	{
+		WaitStreamedModel(FsAirplaneModelSet::MODEL_VISUAL);
+	}
 	if(nullptr==vis && GetVisualFileName()[0]!=0)
 	{
 		vis.Load(GetVisualFileName());
@@ -263,6 +263,10 @@ FsVisualDnm FsAirplaneTemplate::GetLod(void) const
 		return nullptr;
 	}
 
+	if(nullptr==lod)
+	{
+		WaitStreamedModel(FsAirplaneModelSet::MODEL_LOD);
+	}
 	if(nullptr==lod && GetLodFileName()[0]!=0)
 	{
 		lod.Load(GetLodFileName());
@@ -283,6 +287,10 @@ FsVisualDnm FsAirplaneTemplate::GetCockpit(void) const
 		return nullptr;
 	}
 
+	if(nullptr==cockpit)
+	{
+		WaitStreamedModel(FsAirplaneModelSet::MODEL_COCKPIT);
+	}
 	if(nullptr==cockpit && GetCockpitFileName()[0]!=0)
 	{
 		cockpit.Load(GetCockpitFileName());
@@ -297,6 +305,116 @@ FsVisualDnm FsAirplaneTemplate::GetCockpit(void) const
 	return cockpit;
 }
 
+void FsAirplaneTemplate::StreamModel(FsAirplaneAssetStreamer &streamer,unsigned int modelMask,YSBOOL prefetch) const
+{
+	if(nullptr!=vis || 0==GetVisualFileName()[0])
+	{
+		modelMask&=~FsAirplaneModelSet::MODEL_VISUAL;
+	}
+	if(nullptr!=lod || 0==GetLodFileName()[0])
+	{
+		modelMask&=~FsAirplaneModelSet::MODEL_LOD;
+	}
+	if(nullptr!=cockpit || 0==GetCockpitFileName()[0])
+	{
+		modelMask&=~FsAirplaneModelSet::MODEL_COCKPIT;
+	}
+	for(auto &streamed : streamedModel)
+	{
+		if(0!=(streamed.modelMask&modelMask) && YSTRUE!=prefetch)
+		{
+			streamed.prefetch=YSFALSE;
+		}
+		modelMask&=~streamed.modelMask;
+	}
+
+	if(0!=modelMask)
+	{
+		streamedModel.Increment();
+		streamedModel.Last().modelMask=modelMask;
+		streamedModel.Last().prefetch=prefetch;
+		streamedModel.Last().request=streamer.Load(modelMask,GetVisualFileName(),GetLodFileName(),GetCockpitFileName());
+	}
+}
+
+void FsAirplaneTemplate::CancelPrefetch(void) const
+{
+	for(auto &streamed : streamedModel)
+	{
+		if(YSTRUE==streamed.prefetch)
+		{
+			streamed.request.Cancel();
+		}
+	}
+}
+
+YSBOOL FsAirplaneTemplate::IsStreamingModel(unsigned int modelMask) const
+{
+	for(auto &streamed : streamedModel)
+	{
+		if(0!=(streamed.modelMask&modelMask))
+		{
+			return YSTRUE;
+		}
+	}
+	return YSFALSE;
+}
+
+YSBOOL FsAirplaneTemplate::InstallStreamedModel(YSBOOL wait) const
+{
+	for(auto idx=streamedModel.GetN()-1; 0<=idx; --idx)
+	{
+		if(YSTRUE==wait || std::future_status::ready==streamedModel[idx].request.modelSet.wait_for(std::chrono::seconds(0)))
+		{
+			auto modelSet=streamedModel[idx].request.modelSet;
+			streamedModel.Delete(idx);
+			InstallStreamedModel(modelSet.get());
+		}
+	}
+	return (0==streamedModel.GetN() ? YSTRUE : YSFALSE);
+}
+
+void FsAirplaneTemplate::WaitStreamedModel(unsigned int modelMask) const
+{
+	for(auto idx=streamedModel.GetN()-1; 0<=idx; --idx)
+	{
+		if(0!=(streamedModel[idx].modelMask&modelMask))
+		{
+			auto modelSet=streamedModel[idx].request.modelSet;
+			streamedModel.Delete(idx);
+			InstallStreamedModel(modelSet.get());
+		}
+	}
+}
+
+void FsAirplaneTemplate::InstallStreamedModel(const FsAirplaneModelSet &modelSet) const
+{
+	// A model may have been loaded synchronously while streaming.  Keep the one that is already given out.
+	// A model that could not be loaded stays nullptr, and the getter tries again and reports the error.
+	if(0!=(modelSet.modelMask&FsAirplaneModelSet::MODEL_VISUAL) && nullptr==vis)
+	{
+		vis=modelSet.vis;
+	}
+	if(0!=(modelSet.modelMask&FsAirplaneModelSet::MODEL_LOD) && nullptr==lod)
+	{
+		lod=modelSet.lod;
+	}
+	if(0!=(modelSet.modelMask&FsAirplaneModelSet::MODEL_COCKPIT) && nullptr==cockpit)
+	{
+		cockpit=modelSet.cockpit;
+	}
+}
+
+YSBOOL FsAirplaneTemplate::IsVisualReady(void) const
+{
+	if(YSTRUE==FsIsConsoleServer() || nullptr!=vis || 0==GetVisualFileName()[0])
+	{
+		return YSTRUE;
+	}
+	InstallStreamedModel(YSFALSE);
+	return (nullptr!=vis ? YSTRUE : YSFALSE);
+}
+
 const FsVisualSrf *FsAirplaneTemplate::GetCollision(void) const
 {
 	if(coll==NULL && GetCollisionFileName()[0]!=0)
@@ -370,6 +488,10 @@ FsVisualDnm FsAirplaneTemplate::GetWeaponVisual(FSWEAPONTYPE wpnType,int state)
 	const FsAirplaneProperty *prop=GetProperty();
 	if(wpnType<FSWEAPON_NUMWEAPONTYPE && 0<=state && state<2)
 	{
+		if(nullptr==weaponShapeOverride[state])
+		{
+			weaponShapeOverride[state].reset(new FsVisualDnm [FSWEAPON_NUMWEAPONTYPE]);
+		}
 		if(nullptr==weaponShapeOverride[state][(int)wpnType])
 		{
 			const wchar_t *fn=prop->GetWeaponShapeFile(wpnType,state);
@@ -833,10 +955,18 @@ FsWorld::FsWorld() :
 	lastError=ERROR_NOERROR;
 	extensionRegistry.reset(new FsSimExtensionRegistry);
 	extensionRegistry->RegisterKnownExtension();
+	useStandInAirplaneModel=YSFALSE;
 }
 
 FsWorld::~FsWorld()
 {
+	CancelAirplaneModelPrefetch();
+	airplaneAssetStreamer.reset();
+
+	airplaneTemplateDict.CleanUp();
+	groundTemplateDict.CleanUp();
+	fieldTemplateDict.CleanUp();
+
 	airplaneTemplate.CleanUp();
 	groundTemplate.CleanUp();
 	fieldTemplate.CleanUp();
@@ -877,22 +1007,45 @@ YSRESULT FsWorld::Save(const wchar_t fn[],
      int airPosPrecision,int airAttPrecision,
      int gndPosPrecision,int gndAttPrecision,
      int wpnPosPrecision,int wpnAttPrecision,
-     const double &timeStep)
+     const double &timeStep,
+     YSBOOL binaryRecord)
 {
+	FsBinaryRecordWriter binRec;
 	FILE *fp=YsFileIO::Fopen(fn,"w");
 	if(fp!=NULL)
 	{
 		fprintf(fp,"YFSVERSI %d\n",YSFLIGHT_YFSVERSION);
 
+		if(YSTRUE==binaryRecord)
+		{
+			YsWString binFn(fn),path,binFil;
+			binFn.ReplaceExtension(L".yfr");
+			binFn.SeparatePathFile(path,binFil);
+			if(YSOK!=binRec.Open(binFn))
+			{
+				fsStderr.Printf("Cannot open the binary record file.\n");
+				goto ERRTRAP;
+			}
+
+			fprintf(fp,"RECDFILE \"%s\"\n",binFil.GetUTF8String().Txt());
+		}
+
 		if(sim->Save(fp,
 		   airPosPrecision,airAttPrecision,
 		   gndPosPrecision,gndAttPrecision,
 		   wpnPosPrecision,wpnAttPrecision,
-		   timeStep)!=YSOK)
+		   timeStep,
+		   (YSTRUE==binaryRecord ? &binRec : nullptr))!=YSOK)
 		{
 			goto ERRTRAP;
 		}
 
+		if(YSTRUE==binaryRecord && YSOK!=binRec.Close())
+		{
+			fsStderr.Printf("Cannot write the binary record file.\n");
+			goto ERRTRAP;
+		}
+
 		fclose(fp);
 		return YSOK;
 	}
@@ -1002,6 +1155,10 @@ static const char *const ysflightCommand[]=
 	// Added 2017/12/17
 	"EXTENSIO",
 
+	// Added 2026/10/17
+	"RECDFILE", // Binary record file (.yfr)  RECDFILE "filename"
+	"BINRECOR", // Record of the current object from the binary record file  BINRECOR streamIndex
+
 	NULL
 };
 
@@ -1041,6 +1198,37 @@ void FsWorld::RegisterExtension(std::shared_ptr <FsSimExtensionBase> addOnPtr)
 
 // fieldPos,fieldAtt are only for defining ground object.
 // Don't use for other purposes. Don't screw up!
+/*! Scans AIRPLANE lines of a .yfs file, and starts loading the models in worker threads so that
+    they are ready or half-way ready when LoadInternal reaches the line.  Rewinds the file at the end.
+*/
+void FsWorld::PrefetchAirplaneModel(FILE *fp)
+{
+	YsString readBuf;
+	YsArray <YsString,16> args;
+	while(readBuf.Fgets(fp)!=NULL)
+	{
+		int cmd;
+		if(YSOK==readBuf.Arguments(args," \t","") && 2<=args.GetN() &&
+		   YSOK==YsCommandNumber(&cmd,args[0],ysflightCommand) && 4==cmd) // 4:"AIRPLANE"
+		{
+			if(NULL!=FindAirplaneTemplate(args[1]))
+			{
+				PrefetchAirplaneModel(args[1]);
+				continue;
+			}
+			for(YSSIZE_T i=3; i<args.GetN(); i++)
+			{
+				if(strncmp(args[i],"SUBST:",6)==0 && NULL!=FindAirplaneTemplate(((const char *)args[i])+6))
+				{
+					PrefetchAirplaneModel(((const char *)args[i])+6);
+					break;
+				}
+			}
+		}
+	}
+	fseek(fp,0,SEEK_SET);
+}
+
 YSRESULT FsWorld::LoadInternal(const wchar_t fn[],const YsVec3 &fieldPos,const YsAtt3 &fieldAtt)
 {
 	FSIFF iffTab[]=
@@ -1071,6 +1259,8 @@ YSRESULT FsWorld::LoadInternal(const wchar_t fn[],const YsVec3 &fieldPos,const Y
 		int i,nr,version;
 		FsFlightRecord record;
 		FsGroundRecord gdRecord;
+		YsArray <FsTurretRecord,16> turret,gdTurret;
+		FsBinaryRecordReader binRec;
 		FsAirplane *air;
 		FsGround *gnd;
 		const YsSceneryPointSet *mpa;
@@ -1089,6 +1279,8 @@ YSRESULT FsWorld::LoadInternal(const wchar_t fn[],const YsVec3 &fieldPos,const Y
 		YsString readBuf;
 		YsArray <YsString,16> args;
 
+		PrefetchAirplaneModel(fp);
+
 		air=NULL;
 		gnd=NULL;
 		while(readBuf.Fgets(fp)!=NULL)
@@ -1260,12 +1452,12 @@ YSRESULT FsWorld::LoadInternal(const wchar_t fn[],const YsVec3 &fieldPos,const Y
 								{
 									int j,n;
 									n=atoi(args[0]);
-									record.turret.Alloc(n);
+									turret.Resize(n);
 									for(j=0; j<n; j++)
 									{
-										record.turret[j].h=(float)atof(args[1+j*3]);
-										record.turret[j].p=(float)atof(args[2+j*3]);
-										record.turret[j].turretState=atoi(args[3+j*3]);
+										turret[j].h=(float)atof(args[1+j*3]);
+										turret[j].p=(float)atof(args[2+j*3]);
+										turret[j].turretState=atoi(args[3+j*3]);
 									}
 								}
 
@@ -1292,7 +1484,7 @@ YSRESULT FsWorld::LoadInternal(const wchar_t fn[],const YsVec3 &fieldPos,const Y
 								record.thrVector=(unsigned char)thrVector;
 								record.thrReverser=(unsigned char)thrReverser;
 								record.bombBay=(unsigned char)bombBay;
-								air->Record(t,record,YSTRUE);
+								air->Record(t,record,turret,YSTRUE);
 							}
 						}
 						else if(version==2)
@@ -1351,7 +1543,7 @@ YSRESULT FsWorld::LoadInternal(const wchar_t fn[],const YsVec3 &fieldPos,const Y
 								record.thrVector=(unsigned char)thrVector;
 								record.thrReverser=(unsigned char)thrReverser;
 								record.bombBay=(unsigned char)bombBay;
-								air->Record(t,record,YSTRUE);
+								air->Record(t,record,turret,YSTRUE);
 							}
 						}
 						else if(version==1)
@@ -1407,7 +1599,7 @@ YSRESULT FsWorld::LoadInternal(const wchar_t fn[],const YsVec3 &fieldPos,const Y
 								record.thrVector=0;
 								record.thrReverser=0;
 								record.bombBay=0;
-								air->Record(t,record,YSTRUE);
+								air->Record(t,record,turret,YSTRUE);
 							}
 						}
 						else if(version==0) // Old Version
@@ -1456,7 +1648,7 @@ YSRESULT FsWorld::LoadInternal(const wchar_t fn[],const YsVec3 &fieldPos,const Y
 								record.thrVector=0;
 								record.thrReverser=0;
 								record.bombBay=0;
-								air->Record(t,record,YSTRUE);
+								air->Record(t,record,turret,YSTRUE);
 							}
 						}
 						break;
@@ -1545,16 +1737,16 @@ YSRESULT FsWorld::LoadInternal(const wchar_t fn[],const YsVec3 &fieldPos,const Y
 								{
 									int j,n;
 									n=atoi(args[0]);
-									gdRecord.turret.Alloc(n);
+									gdTurret.Resize(n);
 									for(j=0; j<n; j++)
 									{
-										gdRecord.turret[j].h=(float)atof(args[1+j*3]);
-										gdRecord.turret[j].p=(float)atof(args[2+j*3]);
-										gdRecord.turret[j].turretState=atoi(args[3+j*3]);
+										gdTurret[j].h=(float)atof(args[1+j*3]);
+										gdTurret[j].p=(float)atof(args[2+j*3]);
+										gdTurret[j].turretState=atoi(args[3+j*3]);
 									}
 								}
 
-								gnd->Record(t,gdRecord,YSTRUE);
+								gnd->Record(t,gdRecord,gdTurret,YSTRUE);
 							}
 						}
 						else if(version==2)
@@ -1598,12 +1790,12 @@ YSRESULT FsWorld::LoadInternal(const wchar_t fn[],const YsVec3 &fieldPos,const Y
 								{
 									int j,n;
 									n=atoi(args[0]);
-									gdRecord.turret.Alloc(n);
+									gdTurret.Resize(n);
 									for(j=0; j<n; j++)
 									{
-										gdRecord.turret[j].h=(float)atof(args[1+j*3]);
-										gdRecord.turret[j].p=(float)atof(args[2+j*3]);
-										gdRecord.turret[j].turretState=atoi(args[3+j*3]);
+										gdTurret[j].h=(float)atof(args[1+j*3]);
+										gdTurret[j].p=(float)atof(args[2+j*3]);
+										gdTurret[j].turretState=atoi(args[3+j*3]);
 									}
 								}
 
@@ -1614,7 +1806,7 @@ YSRESULT FsWorld::LoadInternal(const wchar_t fn[],const YsVec3 &fieldPos,const Y
 								gdRecord.brake=0;
 								gdRecord.lightState=0;
 
-								gnd->Record(t,gdRecord,YSTRUE);
+								gnd->Record(t,gdRecord,gdTurret,YSTRUE);
 							}
 						}
 						else if(version==1)
@@ -1659,7 +1851,7 @@ YSRESULT FsWorld::LoadInternal(const wchar_t fn[],const YsVec3 &fieldPos,const Y
 								gdRecord.brake=0;
 								gdRecord.lightState=0;
 
-								gnd->Record(t,gdRecord,YSTRUE);
+								gnd->Record(t,gdRecord,gdTurret,YSTRUE);
 							}
 						}
 						else if(version==0)
@@ -1703,7 +1895,7 @@ YSRESULT FsWorld::LoadInternal(const wchar_t fn[],const YsVec3 &fieldPos,const Y
 								gdRecord.brake=0;
 								gdRecord.lightState=0;
 
-								gnd->Record(t,gdRecord,YSTRUE);
+								gnd->Record(t,gdRecord,gdTurret,YSTRUE);
 							}
 						}
 						break;
@@ -1984,6 +2176,46 @@ YSRESULT FsWorld::LoadInternal(const wchar_t fn[],const YsVec3 &fieldPos,const Y
 						}
 						break;
 
+					case 53: // "RECDFILE"
+						if(2<=args.size())
+						{
+							YsWString binFil,binFn;
+							binFil.SetUTF8String(args[1]);
+							binFn.MakeFullPathName(relPath,binFil);
+							if(YSOK!=binRec.Open(binFn))
+							{
+								fsStderr.Printf("Cannot open the binary record file.\n");
+								goto ERRTRAP;
+							}
+						}
+						break;
+					case 54: // "BINRECOR"
+						if(2<=args.size())
+						{
+							const YSSIZE_T streamIdx=atoi(args[1]);
+							auto stream=binRec.GetStream(streamIdx);
+							if(nullptr==stream)
+							{
+								fsStderr.Printf("Binary record stream not found:%s\n",readBuf.Txt());
+								goto ERRTRAP;
+							}
+							if(FsBinaryRecord::STREAM_AIRPLANE==stream->streamType && nullptr!=air)
+							{
+								if(YSOK!=binRec.LoadStream(streamIdx,*air))
+								{
+									goto ERRTRAP;
+								}
+							}
+							else if(FsBinaryRecord::STREAM_GROUND==stream->streamType && nullptr!=gnd)
+							{
+								if(YSOK!=binRec.LoadStream(streamIdx,*gnd))
+								{
+									goto ERRTRAP;
+								}
+							}
+						}
+						break;
+
 					default:
 						fsStderr.Printf("Unrecognized:%s\n",readBuf.Txt());
 						goto ERRTRAP;
@@ -2140,7 +2372,8 @@ const wchar_t *FsWorld::GetAirplanePropFileName(const char idName[]) const
 }
 
 YSRESULT FsWorld::LoadAirplaneTemplate(
-    const wchar_t rootDir[],const wchar_t prop[],const wchar_t vis[],const wchar_t coll[],const wchar_t cock[],const wchar_t lod[])
+    const wchar_t rootDir[],const wchar_t prop[],const wchar_t vis[],const wchar_t coll[],const wchar_t cock[],const wchar_t lod[],
+    FsAirplaneTemplateIndex *index)
 {
 	YsListItem <FsAirplaneTemplate> *neo;
 	// #### YsShell collTest;
@@ -2160,8 +2393,21 @@ YSRESULT FsWorld::LoadAirplaneTemplate(
 		YsWString propFullPath;
 		propFullPath.MakeFullPathName(rootDir,prop);
 
-		FILE *fp=YsFileIO::Fopen(propFullPath,"r");
-		if(fp!=NULL)
+		long long int propFileSize=0,propFileTime=0;
+		const FsAirplaneTemplateIndex::Entry *indexed=nullptr;
+		if(nullptr!=index && YSOK==YsFileIO::GetFileSizeAndTime(propFileSize,propFileTime,propFullPath))
+		{
+			indexed=index->Find(propFullPath,propFileSize,propFileTime);
+		}
+
+		FILE *fp=(nullptr==indexed ? YsFileIO::Fopen(propFullPath,"r") : nullptr);
+		if(nullptr!=indexed)
+		{
+			neo->dat.SetRootDir(rootDir);
+			neo->dat.idName.Set(indexed->idName);
+			neo->dat.airCat=indexed->airCat;
+		}
+		else if(fp!=NULL)
 		{
 			YsString str;
 			int ac;
@@ -2212,6 +2458,11 @@ YSRESULT FsWorld::LoadAirplaneTemplate(
 				airplaneTemplate.Delete(neo);
 				return YSERR;
 			}
+
+			if(nullptr!=index && 0<propFileSize)
+			{
+				index->Update(propFullPath,propFileSize,propFileTime,neo->dat.idName,neo->dat.airCat);
+			}
 		}
 		else
 		{
@@ -2260,6 +2511,9 @@ YSRESULT FsWorld::LoadAirplaneTemplate(
 
 		// fsConsole.Printf("%s\n",neo->dat.prop.GetIdentifier());
 
+		YsString key;
+		airplaneTemplateDict.AddWord(MakeTemplateSearchKey(key,neo->dat.idName,YSTRUE),neo);  // First one wins as in the linear search.
+
 		return YSOK;
 	}
 	return YSERR;
@@ -2280,33 +2534,42 @@ const FsAirplaneTemplate *FsWorld::GetAirplaneTemplate(const char idName[]) cons
 	}
 }
 
-YsListItem <FsAirplaneTemplate> *FsWorld::FindAirplaneTemplate(const char iIdName[]) const
+const FsGroundTemplate *FsWorld::GetGroundTemplate(const char idName[]) const
 {
-	int i;
-	YsListItem <FsAirplaneTemplate> *ptr;
-	char idName[256];
+	YsListItem <FsGroundTemplate> *found=FindGroundTemplate(idName);
+	return (NULL!=found ? &found->dat : NULL);
+}
 
-	strcpy(idName,iIdName);
+YsListItem <FsAirplaneTemplate> *FsWorld::FindAirplaneTemplate(const char iIdName[]) const
+{
+	YsString key;
+	auto found=airplaneTemplateDict.FindAttrib(MakeTemplateSearchKey(key,iIdName,YSTRUE));
+	return (nullptr!=found ? *found : NULL);
+}
 
-	for(i=0; idName[i]!=0; i++)
+/*! Makes the key of the template dictionaries from an identifier.  Blanks are replaced with '_'.
+    Airplane and ground identifiers are capitalized and compared only up to 31 letters, which is what the
+    linear search with strncmp used to do.  Field identifiers are case sensitive and compared to the end.
+*/
+/* static */ const YsString &FsWorld::MakeTemplateSearchKey(YsString &key,const char idName[],YSBOOL vehicle)
+{
+	key.Set(idName);
+	for(YSSIZE_T i=0; i<key.Strlen(); i++)
 	{
-		if(idName[i]==' ' || idName[i]=='\t')
+		if(key[i]==' ' || key[i]=='\t')
 		{
-			idName[i]='_';
+			key.Set(i,'_');
 		}
 	}
-
-	YsCapitalize(idName);
-
-	ptr=NULL;
-	while((ptr=airplaneTemplate.FindNext(ptr))!=NULL)
+	if(YSTRUE==vehicle)
 	{
-		if(strncmp(ptr->dat.idName,idName,31)==0)
+		key.Capitalize();
+		if(31<key.Strlen())
 		{
-			return ptr;
+			key.SetLength(31);
 		}
 	}
-	return NULL;
+	return key;
 }
 
 FsVisualDnm FsWorld::GetAirplaneVisual(const char idName[]) const
@@ -2467,18 +2730,27 @@ YSRESULT FsWorld::LoadAirplaneTemplate(InitializationOption opt)
 		fsWorldProgressCallback(0, 3, L"Aircraft Templates");
 	}
 	const wchar_t *userYsflightDir=FsGetUserYsflightDir();
+
+	FsAirplaneTemplateIndex index;
+	index.Load(FsGetAirplaneTemplateIndexFile());
+
 	if(YSTRUE==opt.loadDefAir)
 	{
-		LoadAirplaneTemplateList(L".",L"aircraft",L"air",L"lst");
+		LoadAirplaneTemplateList(L".",L"aircraft",L"air",L"lst",&index);
 	}
 	if(YSTRUE==opt.loadUserAir)
 	{
-		LoadAirplaneTemplateList(userYsflightDir,L"aircraft",L"air",L"lst");
+		LoadAirplaneTemplateList(userYsflightDir,L"aircraft",L"air",L"lst",&index);
+	}
+
+	if(YSTRUE==index.NeedSave())
+	{
+		index.Save(FsGetAirplaneTemplateIndexFile());
 	}
 	return YSOK;
 }
 
-YSRESULT FsWorld::LoadAirplaneTemplateList(const wchar_t rootDir[],const wchar_t subDir[],const wchar_t prefix[],const wchar_t ext[])
+YSRESULT FsWorld::LoadAirplaneTemplateList(const wchar_t rootDir[],const wchar_t subDir[],const wchar_t prefix[],const wchar_t ext[],FsAirplaneTemplateIndex *index)
 {
 	int i;
 	YsWString ful;
@@ -2525,7 +2797,7 @@ YSRESULT FsWorld::LoadAirplaneTemplateList(const wchar_t rootDir[],const wchar_t
 					collFileName.SetUTF8String(av[2]);
 					cockFileName.SetUTF8String(ac>=4 ? av[3] : NULL);
 					lodFileName.SetUTF8String(ac>=5 ? av[4] : NULL);
-					if(LoadAirplaneTemplate(rootDir,propFileName,visFileName,collFileName,cockFileName,lodFileName)!=YSOK)
+					if(LoadAirplaneTemplate(rootDir,propFileName,visFileName,collFileName,cockFileName,lodFileName,index)!=YSOK)
 					{
 						// Collect error instead of showing immediately
 						if(nullptr != fsWorldErrorCallback)
@@ -2649,6 +2921,9 @@ YSRESULT FsWorld::LoadGroundTemplate(
 
 		neo->dat.SetCollisionFileName(coll);
 
+		YsString key;
+		groundTemplateDict.AddWord(MakeTemplateSearchKey(key,neo->dat.prop.GetIdentifier(),YSTRUE),neo);
+
 		// if(collTest.LoadSrf(coll)!=YSOK)   Commented out 2004/07/22
 		// {
 		// 	fsStderr.Printf("Load Error :%s\n",coll);
@@ -2678,31 +2953,9 @@ YSRESULT FsWorld::LoadGroundTemplate(
 
 YsListItem <FsGroundTemplate> *FsWorld::FindGroundTemplate(const char iIdName[]) const
 {
-	int i;
-	YsListItem <FsGroundTemplate> *ptr;
-	char idName[256];
-
-	strcpy(idName,iIdName);
-
-	for(i=0; idName[i]!=0; i++)
-	{
-		if(idName[i]==' ' || idName[i]=='\t')
-		{
-			idName[i]='_';
-		}
-	}
-
-	YsCapitalize(idName);
-
-	ptr=NULL;
-	while((ptr=groundTemplate.FindNext(ptr))!=NULL)
-	{
-		if(strncmp(ptr->dat.prop.GetIdentifier(),idName,31)==0)
-		{
-			return ptr;
-		}
-	}
-	return NULL;
+	YsString key;
+	auto found=groundTemplateDict.FindAttrib(MakeTemplateSearchKey(key,iIdName,YSTRUE));
+	return (nullptr!=found ? *found : NULL);
 }
 
 YSRESULT FsWorld::PrepareGroundVisual(YsListItem <FsGroundTemplate> *templ) const
@@ -3008,6 +3261,9 @@ YSRESULT FsWorld::LoadFieldTemplate(const wchar_t rootDir[],const char idName[],
 
 		neo->dat.SetIdName(idName);
 		neo->dat.SetVisualFileName(vis);
+
+		YsString key;
+		fieldTemplateDict.AddWord(MakeTemplateSearchKey(key,idName,YSFALSE),neo);
 		if(NULL!=yfs)
 		{
 			neo->dat.SetYfsFileName(yfs);
@@ -3843,28 +4099,9 @@ YSRESULT FsWorld::SettleGround(FsGround &gnd,const YsAtt3 &att)
 
 YsListItem <FsFieldTemplate> *FsWorld::FindFieldTemplate(const char iIdName[]) const
 {
-	int i;
-	YsListItem <FsFieldTemplate> *ptr;
-	char idName[256];
-	strcpy(idName,iIdName);
-
-	for(i=0; idName[i]!=0; i++)
-	{
-		if(idName[i]==' ' || idName[i]=='\t')
-		{
-			idName[i]='_';
-		}
-	}
-
-	ptr=NULL;
-	while((ptr=fieldTemplate.FindNext(ptr))!=NULL)
-	{
-		if(strcmp(ptr->dat.GetIdName(),idName)==0)
-		{
-			return ptr;
-		}
-	}
-	return NULL;
+	YsString key;
+	auto found=fieldTemplateDict.FindAttrib(MakeTemplateSearchKey(key,iIdName,YSFALSE));
+	return (nullptr!=found ? *found : NULL);
 }
 
 YSRESULT FsWorld::GetRunwayRectFromPosition(const YsSceneryRectRegion *&rgn,YsVec3 rect[4],const YsVec3 &pos)
@@ -3980,8 +4217,7 @@ FsAirplane *FsWorld::AddAirplane(const char idName[],YSBOOL isPlayerPlane,unsign
 			}
 
 			neo.SetProperty(*ptr->dat.GetProperty(),ptr->dat.GetTemplateRootDirectory());
-			neo.vis=ptr->dat.GetVisual();
-			neo.lod=ptr->dat.GetLod();
+			const YSBOOL standIn=SetAirplaneModel(neo,ptr->dat);
 
 			for(int i=0; i<(int)FSWEAPON_NUMWEAPONTYPE; i++)
 			{
@@ -3989,9 +4225,12 @@ FsAirplane *FsWorld::AddAirplane(const char idName[],YSBOOL isPlayerPlane,unsign
 				neo.weaponShapeOverrideFlying[i]=ptr->dat.GetWeaponVisual((FSWEAPONTYPE)i,1);
 			}
 
-			neo.cockpit=ptr->dat.GetCockpit();
-
-			return sim->AddAirplane(neo,isPlayerPlane,ptr->dat.GetTemplateRootDirectory(),netSearchKey);
+			auto air=sim->AddAirplane(neo,isPlayerPlane,ptr->dat.GetTemplateRootDirectory(),netSearchKey);
+			if(NULL!=air && YSTRUE==standIn)
+			{
+				airplaneWithStandInModel.Append(FsExistence::GetSearchKey(air));
+			}
+			return air;
 		}
 	}
 	return NULL;
@@ -4023,10 +4262,10 @@ FsAirplane *FsWorld::ResetAirplane(FsAirplane *air)
 			air->SetCollisionShell(*ptr->dat.GetCollision());
 
 			air->SetProperty(*ptr->dat.GetProperty(),ptr->dat.GetTemplateRootDirectory());
-			air->vis=ptr->dat.GetVisual();
-			air->lod=ptr->dat.GetLod();
-
-			air->cockpit=ptr->dat.GetCockpit();
+			if(YSTRUE==SetAirplaneModel(*air,ptr->dat))
+			{
+				airplaneWithStandInModel.Append(FsExistence::GetSearchKey(air));
+			}
 
 			return air;
 		}
@@ -4034,6 +4273,111 @@ FsAirplane *FsWorld::ResetAirplane(FsAirplane *air)
 	return NULL;
 }
 
+FsAirplaneAssetStreamer *FsWorld::GetAirplaneAssetStreamer(void)
+{
+	if(YSTRUE==FsIsConsoleServer())
+	{
+		return nullptr;
+	}
+	if(nullptr==airplaneAssetStreamer)
+	{
+		airplaneAssetStreamer.reset(new FsAirplaneAssetStreamer(2));
+	}
+	return airplaneAssetStreamer.get();
+}
+
+/*! Gives the visual, coarse, and cockpit models of the template to the airplane.
+    Returns YSTRUE if the coarse model is given as a stand-in for the visual model that is still being loaded.
+*/
+YSBOOL FsWorld::SetAirplaneModel(FsAirplane &air,const FsAirplaneTemplate &tmpl)
+{
+	air.lod=tmpl.GetLod();
+
+	auto streamer=GetAirplaneAssetStreamer();
+	if(YSTRUE==useStandInAirplaneModel && nullptr!=streamer && nullptr!=air.lod && YSTRUE!=tmpl.IsVisualReady())
+	{
+		tmpl.StreamModel(*streamer,FsAirplaneModelSet::MODEL_VISUAL|FsAirplaneModelSet::MODEL_COCKPIT);
+		streamingAirplaneTemplate.Append(&tmpl);
+
+		air.vis=air.lod;
+		air.cockpit=nullptr;
+		air.Prop().ForgetVisual(&air.vis);
+		return YSTRUE;
+	}
+
+	air.vis=tmpl.GetVisual();
+	air.cockpit=tmpl.GetCockpit();
+	return YSFALSE;
+}
+
+void FsWorld::PrefetchAirplaneModel(const char idName[],unsigned int modelMask)
+{
+	auto streamer=GetAirplaneAssetStreamer();
+	auto ptr=FindAirplaneTemplate(idName);
+	if(nullptr!=streamer && NULL!=ptr)
+	{
+		ptr->dat.StreamModel(*streamer,modelMask,YSTRUE);
+		if(YSTRUE==ptr->dat.IsStreamingModel())
+		{
+			streamingAirplaneTemplate.Append(&ptr->dat);
+		}
+	}
+}
+
+void FsWorld::SetUseStandInAirplaneModel(YSBOOL useStandIn)
+{
+	useStandInAirplaneModel=useStandIn;
+	if(YSTRUE!=useStandIn)
+	{
+		// Not to wait for the prefetch of the models that no airplane is using.
+		CancelAirplaneModelPrefetch();
+		UpdateAirplaneModelStreaming(YSTRUE);
+	}
+}
+
+void FsWorld::CancelAirplaneModelPrefetch(void)
+{
+	for(auto tmpl : streamingAirplaneTemplate)
+	{
+		tmpl->CancelPrefetch();
+	}
+}
+
+void FsWorld::UpdateAirplaneModelStreaming(YSBOOL wait)
+{
+	// A template may appear more than once.  The duplicates go away in the same call.
+	for(auto idx=streamingAirplaneTemplate.GetN()-1; 0<=idx; --idx)
+	{
+		if(YSTRUE==streamingAirplaneTemplate[idx]->InstallStreamedModel(wait))
+		{
+			streamingAirplaneTemplate.DeleteBySwapping(idx);
+		}
+	}
+
+	if(NULL==sim)
+	{
+		airplaneWithStandInModel.CleanUp();
+		return;
+	}
+	for(auto idx=airplaneWithStandInModel.GetN()-1; 0<=idx; --idx)
+	{
+		auto air=sim->FindAirplane(airplaneWithStandInModel[idx]);
+		auto ptr=(NULL!=air ? FindAirplaneTemplate(air->Prop().GetIdentifier()) : NULL);
+		if(NULL==ptr)
+		{
+			airplaneWithStandInModel.DeleteBySwapping(idx);
+		}
+		else if(YSTRUE==ptr->dat.IsVisualReady() || YSTRUE!=ptr->dat.IsStreamingModel(FsAirplaneModelSet::MODEL_VISUAL))
+		{
+			// If the streamed model could not be loaded, GetVisual tries again and reports the error.
+			air->vis=ptr->dat.GetVisual();
+			air->cockpit=ptr->dat.GetCockpit();
+			air->Prop().ForgetVisual(&air->vis);  // Turret node IDs were taken from the stand-in.
+			airplaneWithStandInModel.DeleteBySwapping(idx);
+		}
+	}
+}
+
 FsAirplane *FsWorld::AddMatchingAirplane(
     FSAIRCRAFTCLASS airClass,FSAIRPLANECATEGORY airCategory,unsigned int /*nationality*/,YSBOOL isJet,const double &dimension,
     YSBOOL isPlayerPlane,unsigned netSearchKey)
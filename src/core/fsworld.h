@@ -6,6 +6,8 @@
 
 #include "fsgroundproperty.h"
 #include "fssimulation.h"
+#include "fsairplaneassetstreamer.h"
+#include "fstemplateindex.h"
 
 // Global progress callback for asset loading
 typedef void (*FsWorldProgressCallback)(int current, int total, const wchar_t *description);
@@ -55,13 +57,48 @@ public:
 	void SetLodFileName(const wchar_t fn[]);
 	void SetCollisionFileName(const wchar_t fn[]);
 
+	/*! Starts loading the models in modelMask (combination of FsAirplaneModelSet::MODEL_*) in the
+	    worker threads of the streamer.  Models that are loaded or already being loaded are skipped.
+	    If prefetch is YSTRUE, the load can be dropped by CancelPrefetch.  A load that is asked again with
+	    prefetch=YSFALSE is not dropped any more.
+	    Must be called from the main thread. */
+	void StreamModel(FsAirplaneAssetStreamer &streamer,unsigned int modelMask,YSBOOL prefetch=YSFALSE) const;
+
+	/*! Skips the prefetch loads that no worker has started yet.  They are taken by InstallStreamedModel
+	    without giving a model, and the getters load the file when the model is needed. */
+	void CancelPrefetch(void) const;
+
+	/*! Returns YSTRUE if one of the models in modelMask is being loaded in worker threads. */
+	YSBOOL IsStreamingModel(unsigned int modelMask=FsAirplaneModelSet::MODEL_ALL) const;
+
+	/*! Gives the models loaded in worker threads to this template.  If wait is YSFALSE, only the loads
+	    that are finished are taken.  Returns YSTRUE if no model is being streamed after the call. */
+	YSBOOL InstallStreamedModel(YSBOOL wait) const;
+
+	/*! Returns YSTRUE if GetVisual will return without loading a file. */
+	YSBOOL IsVisualReady(void) const;
+
 protected:
+	class StreamedModel
+	{
+	public:
+		unsigned int modelMask;
+		YSBOOL prefetch;
+		FsAirplaneModelRequest request;
+	};
+	mutable YsArray <StreamedModel,2> streamedModel;
+
+	void InstallStreamedModel(const FsAirplaneModelSet &modelSet) const;
+	void WaitStreamedModel(unsigned int modelMask) const;
+
 	mutable class FsVisualDnm vis;
 	mutable class FsVisualDnm cockpit;
 	mutable class FsVisualDnm lod;
 	mutable class FsVisualSrf *coll;
 	mutable class FsAirplaneProperty *prop;
-	mutable class FsVisualDnm weaponShapeOverride[2][FSWEAPON_NUMWEAPONTYPE];
+	// Allocated on the first GetWeaponVisual.  An FsVisualDnm is not cheap to construct, and a template is
+	// created for every airplane in the lists while most of them never show the weapons.
+	mutable std::unique_ptr <class FsVisualDnm []> weaponShapeOverride[2];
 
 	YsWString tmplRootDir;
 
@@ -242,6 +279,12 @@ protected:
 	YsListContainer <FsGroundTemplate> groundTemplate;
 	YsListContainer <FsFieldTemplate> fieldTemplate;
 
+	/* Dictionaries from the normalized identifier (see MakeTemplateSearchKey) to the template.
+	*/
+	YsDictionary <YsString,YsListItem <FsAirplaneTemplate> *> airplaneTemplateDict;
+	YsDictionary <YsString,YsListItem <FsGroundTemplate> *> groundTemplateDict;
+	YsDictionary <YsString,YsListItem <FsFieldTemplate> *> fieldTemplateDict;
+
 	/* emptyFieldTemplate is used for the situation that field template is unnecessary.
 	*/
 	FsFieldTemplate emptyFieldTemplate;
@@ -282,6 +325,16 @@ private:
 
 	std::unique_ptr <class FsSimExtensionRegistry> extensionRegistry;
 
+	// Airplane models loaded in worker threads.  See PrefetchAirplaneModel and SetUseStandInAirplaneModel.
+	std::unique_ptr <FsAirplaneAssetStreamer> airplaneAssetStreamer;
+	YsArray <const FsAirplaneTemplate *> streamingAirplaneTemplate;
+	YsArray <YSHASHKEY> airplaneWithStandInModel;
+	YSBOOL useStandInAirplaneModel;
+
+	FsAirplaneAssetStreamer *GetAirplaneAssetStreamer(void);
+	void CancelAirplaneModelPrefetch(void);
+	YSBOOL SetAirplaneModel(FsAirplane &air,const FsAirplaneTemplate &tmpl);
+
 public:
 	FsWorld();
 	virtual ~FsWorld();
@@ -297,11 +350,13 @@ public:
 	const class FsSimulation *GetSimulation(void) const;
 
 
+	/*! If binaryRecord is YSTRUE, airplane and ground records are saved in a binary container (.yfr) next to the .yfs file. */
 	YSRESULT Save(const wchar_t fn[],
 	     int airPosPrecision,int airAttPrecision,
 	     int gndPosPrecision,int gndAttPresicion,
 	     int wpnPosPrecision,int wpnAttPrecision,
-	     const double &timeStep);
+	     const double &timeStep,
+	     YSBOOL binaryRecord=YSFALSE);
 	YSRESULT Load(const wchar_t fn[]);
 
 	void SetCanContinue(YSBOOL canContinue);
@@ -318,10 +373,11 @@ public:
 	YSRESULT LoadTemplate(InitializationOption opt);
 
 	YSRESULT LoadAirplaneTemplate(InitializationOption opt);
-	YSRESULT LoadAirplaneTemplateList(const wchar_t rootDir[],const wchar_t dir[],const wchar_t prefix[],const wchar_t ext[]);
+	YSRESULT LoadAirplaneTemplateList(const wchar_t rootDir[],const wchar_t dir[],const wchar_t prefix[],const wchar_t ext[],FsAirplaneTemplateIndex *index=nullptr);
 	YSRESULT LoadAirplaneTemplate(
 	    const wchar_t rootDir[],
-	    const wchar_t prop[],const wchar_t vis[],const wchar_t coll[],const wchar_t cock[],const wchar_t lod[]);
+	    const wchar_t prop[],const wchar_t vis[],const wchar_t coll[],const wchar_t cock[],const wchar_t lod[],
+	    FsAirplaneTemplateIndex *index=nullptr);
 	FsVisualDnm GetAirplaneVisual(const char idName[]) const;
 	const FsVisualSrf *GetAirplaneCollision(const char idName[]) const;
 	const FsVisualDnm GetAirplaneWeaponShapeOverride(const char idName[],FSWEAPONTYPE wpnType,int state) const;
@@ -375,6 +431,21 @@ public:
 	FSENVIRONMENT GetEnvironment(void);
 	FsAirplane *AddAirplane(const char idName[],YSBOOL isPlayerPlane,unsigned netSearchKey=0);
 	FsAirplane *ResetAirplane(FsAirplane *air);
+
+	/*! Starts loading the models (combination of FsAirplaneModelSet::MODEL_*) of the airplane in worker threads
+	    so that AddAirplane does not have to wait for the files. */
+	void PrefetchAirplaneModel(const char idName[],unsigned int modelMask=FsAirplaneModelSet::MODEL_ALL);
+
+	/*! While YSTRUE, AddAirplane and ResetAirplane do not wait for the visual model that is not loaded yet.
+	    The airplane is drawn with the coarse model until the visual model streamed in worker threads is
+	    given to it by UpdateAirplaneModelStreaming.  Setting YSFALSE waits for all the airplanes with a
+	    stand-in to get the visual model. */
+	void SetUseStandInAirplaneModel(YSBOOL useStandIn);
+
+	/*! Takes the models finished in worker threads, and gives the visual models to the airplanes
+	    that have been using the coarse model as a stand-in.  Called once per simulation step.
+	    If wait is YSTRUE, waits for all the models being loaded. */
+	void UpdateAirplaneModelStreaming(YSBOOL wait);
 	FsAirplane *AddMatchingAirplane(
 	    FSAIRCRAFTCLASS airClass,FSAIRPLANECATEGORY airCategory,unsigned int nationality,YSBOOL isJet,const double &dimension,
 	    YSBOOL isPlayerPlane,unsigned netSearchKey=0);
@@ -495,10 +566,12 @@ public:
 	void AdjustPrecisionOfFlightRecord(const double &precPos,const double &precAng);
 
 	const FsAirplaneTemplate *GetAirplaneTemplate(const char idName[]) const;
+	const FsGroundTemplate *GetGroundTemplate(const char idName[]) const;
 
 
 
 protected:
+	static const YsString &MakeTemplateSearchKey(YsString &key,const char idName[],YSBOOL vehicle);
 	YsListItem <FsAirplaneTemplate> *FindAirplaneTemplate(const char idName[]) const;
 	YSRESULT PrepareAirplaneVisual(YsListItem <FsAirplaneTemplate> *templ) const;
 	YsListItem <FsGroundTemplate> *FindGroundTemplate(const char idName[]) const;
@@ -506,6 +579,7 @@ protected:
 	YsListItem <FsFieldTemplate> *FindFieldTemplate(const char idName[]) const;
 	YSRESULT PrepareFieldVisual(YsListItem <FsFieldTemplate> *templ) const;
 
+	void PrefetchAirplaneModel(FILE *fp);
 	YSRESULT LoadInternal(const wchar_t fn[],const YsVec3 &pos,const YsAtt3 &att);
 };
 
@@ -458,6 +458,27 @@ const wchar_t *FsGetNetChatLogDir(void)
 	return fn;
 }
 
+const wchar_t *FsGetModelCacheDir(void)
+{
+	static YsWString fn;
+	if(fn.Strlen()==0)
+	{
+		fn.MakeFullPathName(FsGetUserYsflightDir(),L"modelcache");
+		YsFileIO::MkDir(fn);
+	}
+	return fn;
+}
+
+const wchar_t *FsGetAirplaneTemplateIndexFile(void)
+{
+	static YsWString fn;
+	if(fn.Strlen()==0)
+	{
+		fn.MakeFullPathName(FsGetUserYsflightDir(),L"airtemplateindex.txt");
+	}
+	return fn;
+}
+
 const wchar_t *FsGetIpBlockFile(void)
 {
 	static YsWString fn;
@@ -24,6 +24,8 @@ const wchar_t *FsGetControlAssignFile(void);
 const wchar_t *FsGetWindowSizeFile(void);
 const wchar_t *FsGetNetServerAddressHistoryFile(void);
 const wchar_t *FsGetNetChatLogDir(void);
+const wchar_t *FsGetModelCacheDir(void);  // Binary cache of the DNM and SRF files.  Created if it does not exist.
+const wchar_t *FsGetAirplaneTemplateIndexFile(void);  // IDENTIFY and CATEGORY of the airplane .DAT files, validated by the file time.
 const wchar_t *FsGetPlugInDir(void);
 const wchar_t *FsGetSoundDllFile(void);
 const wchar_t *FsGetVoiceDllFile(void);
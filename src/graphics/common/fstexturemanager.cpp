@@ -1,6 +1,7 @@
 #include <ysport.h>
 #include <fsdef.h>
 #include "fstexturemanager.h"
+#include <ystexturedecodequeue.h>
 
 YsTextureManager::TexHandle fsGroundTileTexHd=nullptr;
 YsTextureManager::TexHandle fsRunwayLightTexHd=nullptr;
@@ -24,6 +25,17 @@ FsCommonTexture::FsCommonTexture()
 	{
 		hd=nullptr;
 	}
+
+	decodeQueue=nullptr;
+}
+
+FsCommonTexture::~FsCommonTexture()
+{
+	EndAsyncTextureDecode();
+	if(nullptr!=decodeQueue)
+	{
+		delete decodeQueue;
+	}
 }
 
 YsTextureManager::TexHandle FsCommonTexture::UpdateTextureFromPngFile(YsTextureManager::TexHandle texHd,const char fn[])
@@ -148,3 +160,26 @@ const YsTextureManager::Unit *FsCommonTexture::GetShadowMapTexture(YSSIZE_T shad
 {
 	return texMan.GetTextureReady(ShadowMapTexHd[shadowMapIdx]);
 }
+
+void FsCommonTexture::StartAsyncTextureDecode(void)
+{
+	if(nullptr==decodeQueue)
+	{
+		decodeQueue=new YsTextureDecodeQueue(2);
+	}
+	YsTextureManager::SetDefaultDecodeQueue(decodeQueue);
+}
+
+void FsCommonTexture::EndAsyncTextureDecode(void)
+{
+	// Textures still in the queue will be decoded synchronously when they are bound next time.
+	YsTextureManager::SetDefaultDecodeQueue(nullptr);
+}
+
+void FsCommonTexture::UploadDecodedTexture(long long int byteBudget)
+{
+	if(nullptr!=decodeQueue)
+	{
+		decodeQueue->Upload(byteBudget);
+	}
+}
@@ -21,6 +21,8 @@ private:
 
 	YsTextureManager::TexHandle ShadowMapTexHd[MAX_NUM_SHADOWMAP];
 
+	YsTextureDecodeQueue *decodeQueue;
+
 	YsTextureManager::TexHandle UpdateTextureFromPngFile(YsTextureManager::TexHandle texHd,const char fn[]);
 	FsCommonTexture(const FsCommonTexture &);
 	FsCommonTexture &operator=(const FsCommonTexture &);
@@ -29,6 +31,7 @@ public:
 	static FsCommonTexture &GetCommonTexture(void);
 
 	FsCommonTexture();
+	~FsCommonTexture();
 
 	YsTextureManager &GetTextureManager(void);
 
@@ -47,6 +50,16 @@ public:
 	YSRESULT ReadyShadowMap(void);
 	YSSIZE_T GetMaxNumShadowMap(void) const;
 	const YsTextureManager::Unit *GetShadowMapTexture(YSSIZE_T shadowTexId) const;
+
+	/*! Makes all texture managers decode PNG textures in worker threads.  Called when a simulation starts.
+	    UploadDecodedTexture must be called in every frame until EndAsyncTextureDecode. */
+	void StartAsyncTextureDecode(void);
+
+	/*! Makes the texture managers decode textures synchronously again.  Called when a simulation ends. */
+	void EndAsyncTextureDecode(void);
+
+	/*! Sends the decoded textures to the GPU up to byteBudget bytes.  Does nothing unless StartAsyncTextureDecode has been called. */
+	void UploadDecodedTexture(long long int byteBudget);
 };
 
 /* } */
@@ -5,30 +5,105 @@
 #include <ysshellext_orientationutil.h>
 
 #include "fsvisual.h"
+#include "fsfilename.h"
+
+
+/* static */ YSBOOL FsVisualCache::enabled=YSTRUE;
+
+/* static */ YsWString FsVisualCache::GetCacheFileName(const YsVisualCache::SourceInfo &src)
+{
+	YsString utf8;
+	utf8.EncodeUTF8 <wchar_t> (src.fn);
+
+	// 64-bit FNV-1a
+	unsigned long long hash=14695981039346656037ULL;
+	for(YSSIZE_T i=0; i<utf8.Strlen(); ++i)
+	{
+		hash^=(unsigned char)utf8[i];
+		hash*=1099511628211ULL;
+	}
+
+	YsWString path,base;
+	src.fn.SeparatePathFile(path,base);
+	base.RemoveExtension();
+
+	YsString hashStr;
+	hashStr.Printf("_%016llx.ysvcache",hash);
+	YsWString hashWStr;
+	hashWStr.SetUTF8String(hashStr);
+	base.Append(hashWStr);
+
+	YsWString cacheFn;
+	cacheFn.MakeFullPathName(FsGetModelCacheDir(),base);
+	return cacheFn;
+}
+
 
 
 FsVisualSrf::FsVisualSrf(const FsVisualSrf &incoming)
 {
 	YsShellExt::CopyFrom(incoming);
+	bbxTree=incoming.GetBuiltBoundingBoxTree();
+	bbxTreeShapeModificationCounter=GetShapeModificationCounter();
 }
 FsVisualSrf &FsVisualSrf::operator=(const FsVisualSrf &incoming)
 {
 	vboSet.CleanUp();
+	SetPolygonBufferCached(YSFALSE);
 	YsShellExt::CopyFrom(incoming);
+	auto tree=incoming.GetBuiltBoundingBoxTree();
+	std::lock_guard <std::mutex> lock(bbxTreeMutex);
+	bbxTree=tree;
+	bbxTreeShapeModificationCounter=GetShapeModificationCounter();
 	return *this;
 }
 
 YSRESULT FsVisualSrf::Load(const wchar_t fn[])
 {
+	YsVisualCache::SourceInfo src;
+	const YSBOOL useCache=(YSTRUE==FsVisualCache::enabled && YSOK==src.Get(fn) ? YSTRUE : YSFALSE);
+	if(YSTRUE==useCache && YSOK==YsVisualCache::Load(*this,FsVisualCache::GetCacheFileName(src),src))
+	{
+		return YSOK;
+	}
+
 	YsFileIO::File fp(fn,"r");
 	if(nullptr!=fp.Fp())
 	{
 		auto inStream=fp.InStream();
-		return YsVisualSrf::Load(inStream);
+		auto res=YsVisualSrf::Load(inStream);
+		if(YSOK==res && YSTRUE==useCache)
+		{
+			YsVisualCache::Save(FsVisualCache::GetCacheFileName(src),src,*this);
+		}
+		return res;
 	}
 	return YSERR;
 }
 
+std::shared_ptr <const YsShellBoundingBoxTree> FsVisualSrf::GetBoundingBoxTree(void) const
+{
+	std::lock_guard <std::mutex> lock(bbxTreeMutex);
+	if(nullptr==bbxTree || bbxTreeShapeModificationCounter!=GetShapeModificationCounter())
+	{
+		std::shared_ptr <YsShellBoundingBoxTree> newTree(new YsShellBoundingBoxTree);
+		newTree->Build(Conv());
+		bbxTree=newTree;
+		bbxTreeShapeModificationCounter=GetShapeModificationCounter();
+	}
+	return bbxTree;
+}
+
+std::shared_ptr <const YsShellBoundingBoxTree> FsVisualSrf::GetBuiltBoundingBoxTree(void) const
+{
+	std::lock_guard <std::mutex> lock(bbxTreeMutex);
+	if(bbxTreeShapeModificationCounter!=GetShapeModificationCounter())
+	{
+		return nullptr;
+	}
+	return bbxTree;
+}
+
 
 ////////////////////////////////////////////////////////////
 
@@ -48,6 +123,13 @@ FsVisualDnm::~FsVisualDnm()
 }
 YSRESULT FsVisualDnm::Load(const wchar_t fn[])
 {
+	YsVisualCache::SourceInfo src;
+	const YSBOOL useCache=(YSTRUE==FsVisualCache::enabled && YSOK==src.Get(fn) ? YSTRUE : YSFALSE);
+	if(YSTRUE==useCache && YSOK==YsVisualCache::Load(*this,FsVisualCache::GetCacheFileName(src),src))
+	{
+		return YSOK;
+	}
+
 	YsString fnUtf8;
 	fnUtf8.EncodeUTF8(fn);
 
@@ -55,7 +137,12 @@ YSRESULT FsVisualDnm::Load(const wchar_t fn[])
 	if(nullptr!=fp.Fp())
 	{
 		auto inStream=fp.InStream();
-		return YsVisualDnm::Load(inStream,fnUtf8);
+		auto res=YsVisualDnm::Load(inStream,fnUtf8);
+		if(YSOK==res && YSTRUE==useCache)
+		{
+			YsVisualCache::Save(FsVisualCache::GetCacheFileName(src),src,*this);
+		}
+		return res;
 	}
 	return YSERR;
 }
@@ -2,7 +2,10 @@
 #define FSVISUAL_IS_INCLUDED
 /* { */
 
+#include <memory>
+#include <mutex>
 #include <ysvisual.h>
+#include <ysvisualcache.h>
 
 
 const unsigned int FSVISUAL_DRAWOPAQUE=YsVisual::DRAWOPAQUE;
@@ -10,18 +13,54 @@ const unsigned int FSVISUAL_DRAWTRANSPARENT=YsVisual::DRAWTRANSPARENT;
 const unsigned int FSVISUAL_DRAWALL=YsVisual::DRAWALL;
 
 
+/*! Binary cache of the visual models.  FsVisualSrf::Load and FsVisualDnm::Load read the cache if it is made
+    from the same file, and otherwise read the text file and write the cache in FsGetModelCacheDir. */
+class FsVisualCache
+{
+public:
+	static YSBOOL enabled;  // Default YSTRUE
+
+	/*! Returns the cache-file name for the source file.  The name is the base name of the source file
+	    followed by the hash of the full-path name so that the same base names in different directories
+	    do not collide. */
+	static YsWString GetCacheFileName(const YsVisualCache::SourceInfo &src);
+};
+
+
+
 class FsVisualSrf : public YsVisualSrf
 {
 public:
 	using YsShell::SetMatrix;
+	using YsShell::GetMatrix;
 	using YsShell::ShootRayH;
 	using YsShell::SetTrustPolygonNormal;
 
-	inline FsVisualSrf(){}
+private:
+	// Bounding-box tree for collision check.  Shared among copies so that it is built once per template.
+	// Valid while bbxTreeShapeModificationCounter matches GetShapeModificationCounter().
+	mutable std::mutex bbxTreeMutex;
+	mutable std::shared_ptr <const YsShellBoundingBoxTree> bbxTree;
+	mutable unsigned long long int bbxTreeShapeModificationCounter;
+
+	std::shared_ptr <const YsShellBoundingBoxTree> GetBuiltBoundingBoxTree(void) const;
+
+public:
+	inline FsVisualSrf()
+	{
+		bbxTreeShapeModificationCounter=0;
+	}
 	FsVisualSrf(const FsVisualSrf &incoming);
 	FsVisualSrf &operator=(const FsVisualSrf &incoming);
 
 	YSRESULT Load(const wchar_t fn[]);
+
+	/*! Returns the bounding-box tree of this shell.  The tree is built on the first call, and built again
+	    when the shape has changed since, including the changes made through a reference to YsShellExt or YsShell.
+	    The tree is in the untransformed coordinate, and the polygon handles stored in the tree
+	    are of the shell from which the tree was built first.
+	    The function can be called from multiple threads.  Only one of them builds the tree. */
+	std::shared_ptr <const YsShellBoundingBoxTree> GetBoundingBoxTree(void) const;
 };
 
 
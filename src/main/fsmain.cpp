@@ -945,6 +945,22 @@ YSBOOL FsLazyWindowApplication::StepByStepInitialization(void)
 					fsRunLoop.StartReplayRecord(YSFALSE);
 				}
 			}
+			else if(FsCommandParameter::EXEMODE_NETSTATEBENCHMARK==fscp.executionMode)
+			{
+				printf("Network airplane-state benchmark is available only in the console-server.\n");
+			}
+			else if(FsCommandParameter::EXEMODE_CONVERTFLIGHTRECORD==fscp.executionMode)
+			{
+				printf("Flight-record conversion is available only in the console-server.\n");
+			}
+			else if(FsCommandParameter::EXEMODE_BROADPHASEBENCHMARK==fscp.executionMode)
+			{
+				printf("Broad-phase benchmark is available only in the console-server.\n");
+			}
+			else if(FsCommandParameter::EXEMODE_ELEVATIONBENCHMARK==fscp.executionMode)
+			{
+				printf("Elevation benchmark is available only in the console-server.\n");
+			}
 			else if(FsCommandParameter::EXEMODE_OPENINGDEMOFOREVER==fscp.executionMode)
 			{
 				fsRunLoop.StartOpeningDemo();
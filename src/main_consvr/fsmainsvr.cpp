@@ -3,6 +3,8 @@
 #include <string.h>
 #include <stddef.h>
 #include <time.h>
+#include <chrono>
+#include <functional>
 
 #ifdef _WIN32
 #include <winsock2.h> // This needs to be included before windows.h (is included somewhere else.)
@@ -30,6 +32,7 @@
 #include "fstextresource.h"
 
 #include "fsatc.h"
+#include "fssimbenchmark.h"
 
 #include "fsrunloop.h"
 
@@ -44,6 +47,7 @@
 
 
 #include "fscmdparaminfo.h"
+#include "fsnetutil.h"
 
 
 
@@ -97,6 +101,12 @@ static void FsCaptureWorkingDirectory(void)
 
 void Initialize(void);
 void FsMain(void);
+int NetworkAirplaneStateBenchmark(const wchar_t yfsFilename[]);
+int ConvertFlightRecord(const wchar_t inFilename[],const wchar_t outFilename[],YSBOOL toBinary);
+int BroadPhaseBenchmark(const wchar_t yfsFilename[]);
+int ElevationBenchmark(const char fldName[]);
+int TemplateBenchmark(const wchar_t rootDir[]);
+int SimulationBenchmark(const FsCommandParameter &fscp);
 
 ////////////////////////////////////////////////////////////
 
@@ -389,7 +399,15 @@ int main(int ac,char *av[])
 
 
 
-		if(FsIsConsoleServer()==YSTRUE && fscp.executionMode!=1 && fscp.executionMode!=0)
+		if(FsIsConsoleServer()==YSTRUE &&
+		   fscp.executionMode!=1 &&
+		   fscp.executionMode!=0 &&
+		   fscp.executionMode!=FsCommandParameter::EXEMODE_NETSTATEBENCHMARK &&
+		   fscp.executionMode!=FsCommandParameter::EXEMODE_CONVERTFLIGHTRECORD &&
+		   fscp.executionMode!=FsCommandParameter::EXEMODE_BROADPHASEBENCHMARK &&
+		   fscp.executionMode!=FsCommandParameter::EXEMODE_ELEVATIONBENCHMARK &&
+		   fscp.executionMode!=FsCommandParameter::EXEMODE_TEMPLATEBENCHMARK &&
+		   fscp.executionMode!=FsCommandParameter::EXEMODE_SIMBENCHMARK)
 		{
 			printf("Unavailable option.\n");
 			return -1;
@@ -426,6 +444,48 @@ int main(int ac,char *av[])
 		{
 			printf("Replay-recording mode is unavailable in the console-server.\n");
 		}
+		else if(FsCommandParameter::EXEMODE_NETSTATEBENCHMARK==fscp.executionMode)
+		{
+			int res=NetworkAirplaneStateBenchmark(fscp.yfsFilename);
+			FsFreePlugIn();
+			FsCloseWindow();
+			return res;
+		}
+		else if(FsCommandParameter::EXEMODE_CONVERTFLIGHTRECORD==fscp.executionMode)
+		{
+			int res=ConvertFlightRecord(fscp.yfsFilename,fscp.convertOutputFilename,fscp.convertToBinary);
+			FsFreePlugIn();
+			FsCloseWindow();
+			return res;
+		}
+		else if(FsCommandParameter::EXEMODE_BROADPHASEBENCHMARK==fscp.executionMode)
+		{
+			int res=BroadPhaseBenchmark(fscp.yfsFilename);
+			FsFreePlugIn();
+			FsCloseWindow();
+			return res;
+		}
+		else if(FsCommandParameter::EXEMODE_ELEVATIONBENCHMARK==fscp.executionMode)
+		{
+			int res=ElevationBenchmark(fscp.fldName);
+			FsFreePlugIn();
+			FsCloseWindow();
+			return res;
+		}
+		else if(FsCommandParameter::EXEMODE_TEMPLATEBENCHMARK==fscp.executionMode)
+		{
+			int res=TemplateBenchmark(fscp.yfsFilename);
+			FsFreePlugIn();
+			FsCloseWindow();
+			return res;
+		}
+		else if(FsCommandParameter::EXEMODE_SIMBENCHMARK==fscp.executionMode)
+		{
+			int res=SimulationBenchmark(fscp);
+			FsFreePlugIn();
+			FsCloseWindow();
+			return res;
+		}
 		else // executionMode=0 i.e., no option is given
 		{
 			FsConMenu(fscp,world);
@@ -512,3 +572,800 @@ RESETSERVER:
 		goto RESETSERVER;
 	}
 }
+
+////////////////////////////////////////////////////////////
+
+// Plays back the flight record, and sends the airplane states through FsNetSendQueue as the server does
+// for a client that agreed on FSNETCAPABILITY_AIRPLANESTATE_DELTA.  Then, decodes the wire and compares with the original packets.
+int NetworkAirplaneStateBenchmark(const wchar_t yfsFilename[])
+{
+	if(YSOK!=world->Load(yfsFilename))
+	{
+		fsStderr.Printf("Cannot load the flight.\n");
+		return 1;
+	}
+
+	auto sim=world->GetSimulation();
+
+	double t0=0.0,t1=0.0;
+	int nAir=0;
+	for(FsAirplane *air=NULL; NULL!=(air=sim->FindNextAirplane(air)); )
+	{
+		if(NULL!=air->rec && 0<air->rec->GetNumRecord())
+		{
+			if(0==nAir)
+			{
+				t0=air->rec->GetRecordBeginTime();
+				t1=air->rec->GetRecordEndTime();
+			}
+			else
+			{
+				YsMakeSmaller(t0,air->rec->GetRecordBeginTime());
+				YsMakeGreater(t1,air->rec->GetRecordEndTime());
+			}
+			++nAir;
+		}
+	}
+	if(0==nAir)
+	{
+		fsStderr.Printf("The flight does not have a record.\n");
+		return 1;
+	}
+
+	FsNetSendQueue sendQueue;
+	FsNetAirplaneStateDeltaEncoder encoder;
+	FsNetAirplaneStateDeltaDecoder decoder;
+
+	YsArray <unsigned char> sentPacket;     // Packets given to the queue, for comparison
+	YsArray <YSSIZE_T> sentPacketTop;
+	YsArray <unsigned char> wire;
+
+	long long int nLegacyByte=0,nDeltaByte=0,nState=0,nKeyFrame=0,nMismatch=0;
+	double encodeTime=0.0,decodeTime=0.0;
+
+	int step=0;
+	for(double t=t0; t<=t1; ++step)
+	{
+		const double dt=(0==step%2 ? 0.1 : 0.1167);  // Server broadcast interval is not constant.
+		t+=dt;
+
+		sentPacket.Clear();
+		sentPacketTop.Clear();
+		for(FsAirplane *air=NULL; NULL!=(air=sim->FindNextAirplane(air)); )
+		{
+			if(NULL!=air->rec && 0<air->rec->GetNumRecord())
+			{
+				air->PlayRecord(t,dt);
+
+				unsigned char dat[256];
+				memset(dat,0,sizeof(dat));
+				auto nDat=air->Prop().NetworkEncode(dat,FsExistence::GetSearchKey(air),t,YSTRUE);
+				if(0==nDat)
+				{
+					nDat=air->Prop().NetworkEncode(dat,FsExistence::GetSearchKey(air),t,YSFALSE);
+				}
+				sendQueue.Add(nDat,dat);
+				sentPacketTop.Append(sentPacket.GetN());
+				sentPacket.Append(nDat,dat);
+				nLegacyByte+=4+nDat;
+				++nState;
+			}
+		}
+		sentPacketTop.Append(sentPacket.GetN());
+
+		wire.Clear();
+		auto encodeStart=clock();
+		YSSIZE_T nByteSent;
+		sendQueue.Flush(
+		    nByteSent,
+		    [&](YSSIZE_T nByte,unsigned char dat[]) -> YSRESULT
+		    {
+			    wire.Append(nByte,dat);
+			    return YSOK;
+		    },
+		    &encoder);
+		encodeTime+=(double)(clock()-encodeStart)/(double)CLOCKS_PER_SEC;
+		nDeltaByte+=nByteSent;
+
+		YSSIZE_T nReceived=0;
+		auto compare=[&](YSSIZE_T nDat,const unsigned char dat[])
+		{
+			if(nReceived+1<sentPacketTop.GetN())
+			{
+				auto top=sentPacketTop[nReceived];
+				auto length=sentPacketTop[nReceived+1]-top;
+				if(length!=nDat || 0!=memcmp(dat,sentPacket.GetArray()+top,nDat))
+				{
+					++nMismatch;
+				}
+			}
+			else
+			{
+				++nMismatch;
+			}
+			++nReceived;
+		};
+
+		auto decodeStart=clock();
+		for(YSSIZE_T ptr=0; ptr+4<=wire.GetN(); )
+		{
+			auto nDat=FsGetUnsignedInt(wire.GetArray()+ptr);
+			unsigned char *dat=wire.GetEditableArray()+ptr+4;
+			if(FSNETCMD_AIRPLANESTATE_DELTA==FsGetInt(dat))
+			{
+				decoder.Decode(nDat,dat,compare);
+			}
+			else
+			{
+				decoder.SetKeyFrame(nDat,dat);
+				compare(nDat,dat);
+				++nKeyFrame;
+			}
+			ptr+=4+nDat;
+		}
+		decodeTime+=(double)(clock()-decodeStart)/(double)CLOCKS_PER_SEC;
+
+		if(nReceived+1!=sentPacketTop.GetN())
+		{
+			++nMismatch;
+		}
+	}
+
+	fsConsole.Printf("Airplanes      : %d\n",nAir);
+	fsConsole.Printf("Time Range     : %.2lf to %.2lf\n",t0,t1);
+	fsConsole.Printf("States         : %lld (%lld sent as full packets)\n",nState,nKeyFrame);
+	fsConsole.Printf("Legacy Bytes   : %lld\n",nLegacyByte);
+	fsConsole.Printf("Delta Bytes    : %lld\n",nDeltaByte);
+	fsConsole.Printf("Ratio          : %.2lf\n",(0<nDeltaByte ? (double)nLegacyByte/(double)nDeltaByte : 0.0));
+	fsConsole.Printf("Encode Time    : %.3lf sec\n",encodeTime);
+	fsConsole.Printf("Decode Time    : %.3lf sec\n",decodeTime);
+	fsConsole.Printf("Mismatches     : %lld\n",nMismatch);
+
+	return (0==nMismatch ? 0 : 1);
+}
+
+////////////////////////////////////////////////////////////
+
+// Loads a flight record and saves it with the airplane and ground records in text or in a binary record file.
+int ConvertFlightRecord(const wchar_t inFilename[],const wchar_t outFilename[],YSBOOL toBinary)
+{
+	auto loadStart=std::chrono::high_resolution_clock::now();
+	if(YSOK!=world->Load(inFilename))
+	{
+		fsStderr.Printf("Cannot load the flight.\n");
+		return 1;
+	}
+	auto loadTime=std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now()-loadStart).count();
+
+	auto sim=world->GetSimulation();
+	long long int nAir=0,nGnd=0,nRecord=0;
+	for(FsAirplane *air=NULL; NULL!=(air=sim->FindNextAirplane(air)); )
+	{
+		++nAir;
+		nRecord+=(NULL!=air->rec ? air->rec->GetNumRecord() : 0);
+	}
+	for(FsGround *gnd=NULL; NULL!=(gnd=sim->FindNextGround(gnd)); )
+	{
+		++nGnd;
+		nRecord+=(NULL!=gnd->rec ? gnd->rec->GetNumRecord() : 0);
+	}
+
+	// Precisions are the same as the defaults of the Save Flight menu.
+	auto saveStart=std::chrono::high_resolution_clock::now();
+	if(YSOK!=world->Save(outFilename,3,4,2,2,2,2,0.0,toBinary))
+	{
+		fsStderr.Printf("Cannot save the flight.\n");
+		return 1;
+	}
+	auto saveTime=std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now()-saveStart).count();
+
+	fsConsole.Printf("Airplanes      : %lld\n",nAir);
+	fsConsole.Printf("Ground Objects : %lld\n",nGnd);
+	fsConsole.Printf("Records        : %lld\n",nRecord);
+	fsConsole.Printf("Load Time      : %.3lf sec\n",(double)loadTime/1000000.0);
+	fsConsole.Printf("Save Time      : %.3lf sec\n",(double)saveTime/1000000.0);
+	fsConsole.Printf("Output         : %s\n",(YSTRUE==toBinary ? "BINARY" : "TEXT"));
+
+	return 0;
+}
+
+////////////////////////////////////////////////////////////
+
+// Plays back the flight record, and runs the queries of the collision check (per object), the turret (sphere),
+// and the gun (segment) against FsBroadPhase and the old FsLattice.  Also checks that FsBroadPhase does not miss
+// an object that actually is within the range.
+int BroadPhaseBenchmark(const wchar_t yfsFilename[])
+{
+	if(YSOK!=world->Load(yfsFilename))
+	{
+		fsStderr.Printf("Cannot load the flight.\n");
+		return 1;
+	}
+
+	auto sim=world->GetSimulation();
+
+	double t0=0.0,t1=0.0;
+	int nAir=0,nGnd=0;
+	for(FsAirplane *air=NULL; NULL!=(air=sim->FindNextAirplane(air)); )
+	{
+		if(NULL!=air->rec && 0<air->rec->GetNumRecord())
+		{
+			if(0==nAir)
+			{
+				t0=air->rec->GetRecordBeginTime();
+				t1=air->rec->GetRecordEndTime();
+			}
+			else
+			{
+				YsMakeSmaller(t0,air->rec->GetRecordBeginTime());
+				YsMakeGreater(t1,air->rec->GetRecordEndTime());
+			}
+			++nAir;
+		}
+	}
+	for(FsGround *gnd=NULL; NULL!=(gnd=sim->FindNextGround(gnd)); )
+	{
+		++nGnd;
+	}
+	if(0==nAir)
+	{
+		fsStderr.Printf("The flight does not have a record.\n");
+		return 1;
+	}
+
+	const double dt=0.05;
+	const double turretRange=2000.0;
+	const double gunSegment=1000.0*dt;  // Bullet at 1000m/s
+	const double longSegment=3000.0;    // Bullet checked over a long interval, or a long-range weapon
+	const double proximityMargin=25.0;
+
+	// Same set up as FsSimulation::RemakeBroadPhase and the old FsSimulation::RemakeLattice
+	FsLattice ltc;
+	FsBroadPhase broadPhase;
+	{
+		YsVec3 bbx[2];
+		sim->GetField()->GetBoundingBox(bbx[0],bbx[1]);
+		YsVec2 min2d(bbx[0].x()-20000.0,bbx[0].z()-20000.0);
+		YsVec2 max2d(bbx[1].x()+20000.0,bbx[1].z()+20000.0);
+		const YsVec2 dim(max2d-min2d);
+		ltc.SetUp(min2d,max2d,1+(int)(dim.x()/1000.0),1+(int)(dim.y()/1000.0));
+		broadPhase.SetUp(min2d,max2d,(double)FsBroadPhase::DEFAULT_CELL_SIZE,(double)FsBroadPhase::DEFAULT_POSITION_SLACK);
+	}
+
+	for(FsAirplane *air=NULL; NULL!=(air=sim->FindNextAirplane(air)); )
+	{
+		if(NULL!=air->rec && 0<air->rec->GetNumRecord())
+		{
+			air->PlayRecord(t0,dt);
+		}
+		ltc.Add(air);
+		broadPhase.Add(air);
+	}
+	for(FsGround *gnd=NULL; NULL!=(gnd=sim->FindNextGround(gnd)); )
+	{
+		ltc.Add(gnd);
+		broadPhase.Add(gnd);
+	}
+
+	enum
+	{
+		QUERY_COLLISION,
+		QUERY_TURRET,
+		QUERY_GUN,
+		QUERY_LONGSEGMENT,
+		NUM_QUERY
+	};
+	const char *const queryLabel[NUM_QUERY]=
+	{
+		"Collision     ",
+		"Turret Range  ",
+		"Gun Segment   ",
+		"Long Segment  "
+	};
+	long long int nQuery[NUM_QUERY]={0,0,0,0};
+	long long int nLatticeCan[NUM_QUERY]={0,0,0,0},nBroadPhaseCan[NUM_QUERY]={0,0,0,0},nActual[NUM_QUERY]={0,0,0,0};
+	long long int nMiss[NUM_QUERY]={0,0,0,0};
+	long long int latticeTime[NUM_QUERY]={0,0,0,0},broadPhaseTime[NUM_QUERY]={0,0,0,0};  // Micro seconds
+	long long int latticeUpdateTime=0,broadPhaseUpdateTime=0;
+
+	YsArray <FsAirplane *> activeAir;
+	YsArray <YsVec3> segEnd;
+	YsArray <FsAirplane *,256> airCan;
+	YsArray <FsGround *,256> gndCan;
+
+	auto now=[](){return std::chrono::high_resolution_clock::now();};
+	auto usec=[](std::chrono::high_resolution_clock::time_point t0,std::chrono::high_resolution_clock::time_point t1)
+	{
+		return (long long int)std::chrono::duration_cast<std::chrono::microseconds>(t1-t0).count();
+	};
+
+	// Queries are made one kind at a time, first to the lattice, then to the broad phase.
+	auto runQuery=[&](int queryType,std::function <void(FsAirplane *,YSSIZE_T)> latticeQuery,std::function <void(FsAirplane *,YSSIZE_T)> broadPhaseQuery)
+	{
+		auto start=now();
+		for(YSSIZE_T i=0; i<activeAir.GetN(); ++i)
+		{
+			latticeQuery(activeAir[i],i);
+			nLatticeCan[queryType]+=airCan.GetN()+gndCan.GetN();
+		}
+		latticeTime[queryType]+=usec(start,now());
+
+		start=now();
+		for(YSSIZE_T i=0; i<activeAir.GetN(); ++i)
+		{
+			broadPhaseQuery(activeAir[i],i);
+			nBroadPhaseCan[queryType]+=airCan.GetN()+gndCan.GetN();
+		}
+		broadPhaseTime[queryType]+=usec(start,now());
+
+		nQuery[queryType]+=activeAir.GetN();
+	};
+
+	// Objects that are actually within the range must be in the candidates.
+	auto verify=[&](int queryType,FsAirplane *air,const YsVec3 &p0,const YsVec3 &p1,const double rad)
+	{
+		auto isNear=[&](const FsExistence *obj)
+		{
+			YsVec3 np;
+			if(YSOK!=YsGetNearestPointOnLine3(np,p0,p1,obj->GetPosition()) || YSTRUE!=YsCheckInBetween3(np,p0,p1))
+			{
+				np=((obj->GetPosition()-p0).GetSquareLength()<(obj->GetPosition()-p1).GetSquareLength() ? p0 : p1);
+			}
+			const double r=rad+obj->GetApproximatedCollideRadius();
+			return (obj->GetPosition()-np).GetSquareLength()<=r*r;
+		};
+
+		for(FsAirplane *air2=NULL; NULL!=(air2=sim->FindNextAirplane(air2)); )
+		{
+			if(air2!=air && true==isNear(air2))
+			{
+				++nActual[queryType];
+				if(YSTRUE!=airCan.IsIncluded(air2))
+				{
+					++nMiss[queryType];
+				}
+			}
+		}
+		for(FsGround *gnd=NULL; NULL!=(gnd=sim->FindNextGround(gnd)); )
+		{
+			if(true==isNear(gnd))
+			{
+				++nActual[queryType];
+				if(YSTRUE!=gndCan.IsIncluded(gnd))
+				{
+					++nMiss[queryType];
+				}
+			}
+		}
+	};
+
+	long long int nStep=0;
+	for(double t=t0+dt; t<=t1; t+=dt)
+	{
+		for(FsAirplane *air=NULL; NULL!=(air=sim->FindNextAirplane(air)); )
+		{
+			if(NULL!=air->rec && 0<air->rec->GetNumRecord())
+			{
+				air->PlayRecord(t,dt);
+			}
+		}
+
+		auto start=now();
+		ltc.Update(sim);
+		latticeUpdateTime+=usec(start,now());
+
+		start=now();
+		broadPhase.Update(sim);
+		broadPhaseUpdateTime+=usec(start,now());
+
+		activeAir.Clear();
+		segEnd.Clear();
+		for(FsAirplane *air=NULL; NULL!=(air=sim->FindNextAirplane(air)); )
+		{
+			if(YSTRUE==air->IsAlive())
+			{
+				activeAir.Append(air);
+				segEnd.Append(air->GetPosition()+air->GetAttitude().GetForwardVector()*longSegment);
+			}
+		}
+
+		runQuery(QUERY_COLLISION,
+		    [&](FsAirplane *air,YSSIZE_T)
+		    {
+			    ltc.GetAirCollisionCandidate(airCan,air);
+			    ltc.GetGndCollisionCandidate(gndCan,air);
+		    },
+		    [&](FsAirplane *air,YSSIZE_T)
+		    {
+			    broadPhase.GetAirCollisionCandidate(airCan,air);
+			    broadPhase.GetGndCollisionCandidate(gndCan,air);
+		    });
+		runQuery(QUERY_TURRET,
+		    [&](FsAirplane *air,YSSIZE_T)
+		    {
+			    ltc.GetAirCollisionCandidate(airCan,air->GetPosition(),turretRange);
+			    ltc.GetGndCollisionCandidate(gndCan,air->GetPosition(),turretRange);
+		    },
+		    [&](FsAirplane *air,YSSIZE_T)
+		    {
+			    broadPhase.GetAirCollisionCandidate(airCan,air->GetPosition(),turretRange);
+			    broadPhase.GetGndCollisionCandidate(gndCan,air->GetPosition(),turretRange);
+		    });
+		runQuery(QUERY_GUN,
+		    [&](FsAirplane *air,YSSIZE_T)
+		    {
+			    const YsVec3 p1=air->GetPosition()+air->GetAttitude().GetForwardVector()*gunSegment;
+			    ltc.GetAirCollisionCandidate(airCan,air->GetPosition(),p1);
+			    ltc.GetGndCollisionCandidate(gndCan,air->GetPosition(),p1);
+		    },
+		    [&](FsAirplane *air,YSSIZE_T)
+		    {
+			    const YsVec3 p1=air->GetPosition()+air->GetAttitude().GetForwardVector()*gunSegment;
+			    broadPhase.GetAirCollisionCandidateOnSegment(airCan,air->GetPosition(),p1,proximityMargin);
+			    broadPhase.GetGndCollisionCandidateOnSegment(gndCan,air->GetPosition(),p1,proximityMargin);
+		    });
+		runQuery(QUERY_LONGSEGMENT,
+		    [&](FsAirplane *air,YSSIZE_T i)
+		    {
+			    ltc.GetAirCollisionCandidate(airCan,air->GetPosition(),segEnd[i]);
+			    ltc.GetGndCollisionCandidate(gndCan,air->GetPosition(),segEnd[i]);
+		    },
+		    [&](FsAirplane *air,YSSIZE_T i)
+		    {
+			    broadPhase.GetAirCollisionCandidateOnSegment(airCan,air->GetPosition(),segEnd[i],proximityMargin);
+			    broadPhase.GetGndCollisionCandidateOnSegment(gndCan,air->GetPosition(),segEnd[i],proximityMargin);
+		    });
+
+		if(0==nStep%20)
+		{
+			for(YSSIZE_T i=0; i<activeAir.GetN(); ++i)
+			{
+				auto air=activeAir[i];
+				const YsVec3 &pos=air->GetPosition();
+
+				broadPhase.GetAirCollisionCandidate(airCan,air);
+				broadPhase.GetGndCollisionCandidate(gndCan,air);
+				verify(QUERY_COLLISION,air,pos,pos,air->GetApproximatedCollideRadius());
+
+				broadPhase.GetAirCollisionCandidate(airCan,pos,turretRange);
+				broadPhase.GetGndCollisionCandidate(gndCan,pos,turretRange);
+				verify(QUERY_TURRET,air,pos,pos,turretRange);
+
+				broadPhase.GetAirCollisionCandidateOnSegment(airCan,pos,segEnd[i],proximityMargin);
+				broadPhase.GetGndCollisionCandidateOnSegment(gndCan,pos,segEnd[i],proximityMargin);
+				verify(QUERY_LONGSEGMENT,air,pos,segEnd[i],proximityMargin);
+			}
+		}
+		++nStep;
+	}
+
+	long long int nTotalMiss=0;
+	fsConsole.Printf("Airplanes      : %d\n",nAir);
+	fsConsole.Printf("Ground Objects : %d\n",nGnd);
+	fsConsole.Printf("Steps          : %lld\n",nStep);
+	fsConsole.Printf("Cells          : %lld columns  %lld cells (%lld empty)  %lld large objects\n",
+	    (long long int)broadPhase.GetStatistics().nColumn,
+	    (long long int)broadPhase.GetStatistics().nCell,
+	    (long long int)broadPhase.GetStatistics().nEmptyCell,
+	    (long long int)broadPhase.GetStatistics().nLargeObject);
+	fsConsole.Printf("Update Time    : Lattice %.3lf sec  BroadPhase %.3lf sec\n",
+	    (double)latticeUpdateTime/1000000.0,(double)broadPhaseUpdateTime/1000000.0);
+	fsConsole.Printf("Query           Candidates/Query (Lattice  BroadPhase)  Time (Lattice  BroadPhase)  Missed\n");
+	for(int q=0; q<NUM_QUERY; ++q)
+	{
+		const double n=(double)YsGreater <long long int> (1,nQuery[q]);
+		fsConsole.Printf("%s  %10.2lf %10.2lf  %9.3lf sec %9.3lf sec  %lld/%lld\n",
+		    queryLabel[q],
+		    (double)nLatticeCan[q]/n,(double)nBroadPhaseCan[q]/n,
+		    (double)latticeTime[q]/1000000.0,(double)broadPhaseTime[q]/1000000.0,
+		    nMiss[q],nActual[q]);
+		nTotalMiss+=nMiss[q];
+	}
+
+	return (0==nTotalMiss ? 0 : 1);
+}
+
+////////////////////////////////////////////////////////////
+
+// Loads the field, and runs the same elevation queries through the scenery tree (no index) and the elevation index.
+// Also checks that both give the same elevation, elevation grid, and normal.
+int ElevationBenchmark(const char fldName[])
+{
+	YsScenery scn;
+	if(YSOK!=world->GetFieldVisual(scn,fldName))
+	{
+		fsStderr.Printf("Cannot load the field.\n");
+		return 1;
+	}
+
+	auto now=[](){return std::chrono::high_resolution_clock::now();};
+	auto usec=[](std::chrono::high_resolution_clock::time_point t0,std::chrono::high_resolution_clock::time_point t1)
+	{
+		return (long long int)std::chrono::duration_cast<std::chrono::microseconds>(t1-t0).count();
+	};
+
+	// Sample points cover the bounding box of the field and a 10% margin around it.
+	const YSSIZE_T nPos=200000;
+	YsVec3 bbx[2];
+	scn.GetBoundingBox(bbx);
+	const YsVec3 dgn=bbx[1]-bbx[0];
+	YsArray <YsVec3> pos(nPos,NULL);
+	unsigned int seed=12345;
+	auto rnd=[&seed](){seed=seed*1103515245+12345; return (double)((seed>>8)&0xffff)/65535.0;};
+	for(auto &p : pos)
+	{
+		p.Set(bbx[0].x()-dgn.x()*0.1+dgn.x()*1.2*rnd(),0.0,bbx[0].z()-dgn.z()*0.1+dgn.z()*1.2*rnd());
+	}
+
+	YsArray <double> refElv(nPos,NULL),refElvN(nPos,NULL),elv(nPos,NULL);
+	YsArray <YsVec3> refNom(nPos,NULL),nom(nPos,NULL);
+	YsArray <const YsSceneryItem *> refEvg(nPos,NULL),evg(nPos,NULL);
+
+	scn.ClearElevationIndex();
+
+	auto t0=now();
+	for(YSSIZE_T i=0; i<nPos; ++i)
+	{
+		refElv[i]=scn.GetElevation(refEvg[i],pos[i]);
+	}
+	const long long int treeElvTime=usec(t0,now());
+
+	t0=now();
+	for(YSSIZE_T i=0; i<nPos; ++i)
+	{
+		const YsSceneryItem *itm;
+		scn.GetElevationAndNormal(itm,refElvN[i],refNom[i],pos[i]);
+	}
+	const long long int treeNomTime=usec(t0,now());
+
+	t0=now();
+	scn.CacheElevationIndex();
+	const long long int indexBuildTime=usec(t0,now());
+
+	long long int nElvMismatch=0,nEvgMismatch=0,nNomMismatch=0;
+	double maxElvDiff=0.0,maxNomDiff=0.0;
+	auto compare=[&](const YsArray <double> &ref)
+	{
+		for(YSSIZE_T i=0; i<nPos; ++i)
+		{
+			const double d=fabs(elv[i]-ref[i]);
+			YsMakeGreater(maxElvDiff,d);
+			if(1e-6<d)
+			{
+				++nElvMismatch;
+			}
+		}
+	};
+
+	t0=now();
+	for(YSSIZE_T i=0; i<nPos; ++i)
+	{
+		elv[i]=scn.GetElevation(evg[i],pos[i]);
+	}
+	const long long int indexElvTime=usec(t0,now());
+	compare(refElv);
+	for(YSSIZE_T i=0; i<nPos; ++i)
+	{
+		if(evg[i]!=refEvg[i])
+		{
+			++nEvgMismatch;
+		}
+	}
+
+	t0=now();
+	scn.GetElevation(nPos,pos,elv,nullptr);
+	const long long int batchElvTime=usec(t0,now());
+	compare(refElv);
+
+	t0=now();
+	for(YSSIZE_T i=0; i<nPos; ++i)
+	{
+		const YsSceneryItem *itm;
+		scn.GetElevationAndNormal(itm,elv[i],nom[i],pos[i]);
+	}
+	const long long int indexNomTime=usec(t0,now());
+	compare(refElvN);
+
+	t0=now();
+	scn.GetElevationAndNormal(nPos,pos,elv,nom,nullptr);
+	const long long int batchNomTime=usec(t0,now());
+	compare(refElvN);
+	for(YSSIZE_T i=0; i<nPos; ++i)
+	{
+		const double d=(nom[i]-refNom[i]).GetLength();
+		YsMakeGreater(maxNomDiff,d);
+		if(1e-6<d)
+		{
+			++nNomMismatch;
+		}
+	}
+
+	const auto &idx=scn.GetElevationIndex();
+	fsConsole.Printf("Field           : %s\n",fldName);
+	fsConsole.Printf("Elevation Grids : %lld\n",(long long int)idx.grid.GetN());
+	fsConsole.Printf("Cells           : %d x %d (%.1lfm)  %lld entries  %lld sub-scenery tests\n",
+	    idx.nx,idx.nz,idx.cellSize,(long long int)idx.cellGrid.GetN(),(long long int)idx.ancestor.GetN());
+	fsConsole.Printf("Index Build     : %.3lf sec\n",(double)indexBuildTime/1000000.0);
+	fsConsole.Printf("Queries         : %lld\n",(long long int)nPos);
+	fsConsole.Printf("Elevation       : Tree %.3lf sec  Index %.3lf sec  Index(Batch) %.3lf sec\n",
+	    (double)treeElvTime/1000000.0,(double)indexElvTime/1000000.0,(double)batchElvTime/1000000.0);
+	fsConsole.Printf("Elevation+Normal: Tree %.3lf sec  Index %.3lf sec  Index(Batch) %.3lf sec\n",
+	    (double)treeNomTime/1000000.0,(double)indexNomTime/1000000.0,(double)batchNomTime/1000000.0);
+	fsConsole.Printf("Mismatch        : Elevation %lld (max %.3le)  Grid %lld  Normal %lld (max %.3le)\n",
+	    nElvMismatch,maxElvDiff,nEvgMismatch,nNomMismatch,maxNomDiff);
+
+	return (0==nElvMismatch && 0==nEvgMismatch && 0==nNomMismatch ? 0 : 1);
+}
+
+////////////////////////////////////////////////////////////
+
+// Loads the airplane templates of rootDir/aircraft/air*.lst with no index (cold start) and with the index written by
+// the cold start (warm start), and checks that both give the same identifiers and categories.
+// Also compares the template lookup by the dictionary against the linear search that FindAirplaneTemplate used to do.
+int TemplateBenchmark(const wchar_t rootDir[])
+{
+	auto now=[](){return std::chrono::high_resolution_clock::now();};
+	auto usec=[](std::chrono::high_resolution_clock::time_point t0,std::chrono::high_resolution_clock::time_point t1)
+	{
+		return (long long int)std::chrono::duration_cast<std::chrono::microseconds>(t1-t0).count();
+	};
+
+	YsWString indexFn;
+	indexFn.MakeFullPathName(rootDir,L"airtemplateindex.txt");
+	YsFileIO::Remove(indexFn);
+
+	auto load=[&](FsWorld &tmpWorld,long long int &loadTime)
+	{
+		auto t0=now();
+		FsAirplaneTemplateIndex index;
+		index.Load(indexFn);
+		tmpWorld.LoadAirplaneTemplateList(rootDir,L"aircraft",L"air",L"lst",&index);
+		if(YSTRUE==index.NeedSave())
+		{
+			index.Save(indexFn);
+		}
+		loadTime=usec(t0,now());
+	};
+
+	long long int coldTime,warmTime;
+	FsWorld coldWorld,warmWorld;
+	load(coldWorld,coldTime);
+	load(warmWorld,warmTime);
+
+	YsArray <YsString> idName;
+	long long int nMismatch=0;
+	for(int i=0; nullptr!=coldWorld.GetAirplaneTemplateName(i); ++i)
+	{
+		idName.Increment();
+		idName.Last().Set(coldWorld.GetAirplaneTemplateName(i));
+		if(nullptr==warmWorld.GetAirplaneTemplateName(i) ||
+		   0!=strcmp(idName.Last(),warmWorld.GetAirplaneTemplateName(i)) ||
+		   coldWorld.GetAirplaneTemplateCategory(i)!=warmWorld.GetAirplaneTemplateCategory(i))
+		{
+			++nMismatch;
+		}
+	}
+	if(nullptr!=warmWorld.GetAirplaneTemplateName((int)idName.GetN()))
+	{
+		++nMismatch;
+	}
+
+	// Each query is given in lower case with a blank, which the lookup must normalize.
+	YsArray <YsString> query;
+	for(auto &name : idName)
+	{
+		query.Increment();
+		query.Last()=name;
+		query.Last().Uncapitalize();
+		for(YSSIZE_T i=0; i<query.Last().Strlen(); ++i)
+		{
+			if('_'==query.Last()[i])
+			{
+				query.Last().Set(i,' ');
+			}
+		}
+	}
+
+	const int nRound=10;
+	long long int nNotFound=0;
+	auto t0=now();
+	for(int round=0; round<nRound; ++round)
+	{
+		for(auto &q : query)
+		{
+			YsString key(q);
+			key.Capitalize();
+			for(YSSIZE_T i=0; i<key.Strlen(); ++i)
+			{
+				if(' '==key[i])
+				{
+					key.Set(i,'_');
+				}
+			}
+			YSBOOL found=YSFALSE;
+			for(auto &name : idName)
+			{
+				if(0==strncmp(name,key,31))
+				{
+					found=YSTRUE;
+					break;
+				}
+			}
+			if(YSTRUE!=found)
+			{
+				++nNotFound;
+			}
+		}
+	}
+	const long long int linearTime=usec(t0,now());
+
+	t0=now();
+	for(int round=0; round<nRound; ++round)
+	{
+		for(auto &q : query)
+		{
+			if(nullptr==warmWorld.GetAirplaneTemplate(q))
+			{
+				++nNotFound;
+			}
+		}
+	}
+	const long long int hashTime=usec(t0,now());
+
+	fsConsole.Printf("Airplane Templates : %lld\n",(long long int)idName.GetN());
+	fsConsole.Printf("Cold Start         : %.3lf sec\n",(double)coldTime/1000000.0);
+	fsConsole.Printf("Warm Start         : %.3lf sec\n",(double)warmTime/1000000.0);
+	fsConsole.Printf("Lookups            : %lld\n",(long long int)query.GetN()*nRound);
+	fsConsole.Printf("Lookup             : Linear %.3lf sec  Dictionary %.3lf sec\n",
+	    (double)linearTime/1000000.0,(double)hashTime/1000000.0);
+	fsConsole.Printf("Mismatch           : %lld  Not Found %lld\n",nMismatch,nNotFound);
+
+	return (0==nMismatch && 0==nNotFound ? 0 : 1);
+}
+
+////////////////////////////////////////////////////////////
+
+// Runs the scripted scenario with no drawing and no real-time pacing, and writes the time of each phase of
+// SimulateOneStep in JSON.
+int SimulationBenchmark(const FsCommandParameter &fscp)
+{
+	FsSimulationBenchmark::Setting setting;
+	setting.scenario=FsSimulationBenchmark::StrToScenario(fscp.simBenchScenario);
+	setting.fldName=fscp.fldName;
+	setting.nAir=fscp.simBenchNumAir;
+	setting.nGnd=fscp.simBenchNumGnd;
+	setting.simTime=fscp.simBenchTime;
+	if(FsSimulationBenchmark::SCENARIO_UNKNOWN==setting.scenario)
+	{
+		fsStderr.Printf("Unknown scenario %s.\n",fscp.simBenchScenario.Txt());
+		return 1;
+	}
+	if(0>=setting.nAir || 0>setting.nGnd || YsTolerance>setting.simTime)
+	{
+		fsStderr.Printf("Invalid number of objects or simulation time.\n");
+		return 1;
+	}
+
+	FsSimulationBenchmark bench;
+	if(YSOK!=bench.SetUp(world,setting))
+	{
+		fsStderr.Printf("Cannot set up the scenario.\n");
+		return 1;
+	}
+	bench.Run(world);
+
+	FILE *fp=YsFileIO::Fopen(fscp.simBenchOutputFilename,"w");
+	if(NULL==fp)
+	{
+		fsStderr.Printf("Cannot write the result.\n");
+		return 1;
+	}
+	bench.WriteJson(fp);
+	fclose(fp);
+
+	const auto &result=bench.GetResult();
+	fsConsole.Printf("Steps              : %lld\n",result.nStep);
+	fsConsole.Printf("Wall Time          : %.3lf sec\n",(double)result.wallNanosec/1000000000.0);
+
+	return 0;
+}
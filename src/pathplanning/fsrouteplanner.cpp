@@ -0,0 +1,163 @@
+#include <math.h>
+
+#include "fsthreatavoidingpath.h"
+#include "fsrouteplanner.h"
+
+
+
+bool FsRoutePlanner::Key::operator<(const Key &incoming) const
+{
+	if(iff!=incoming.iff)
+	{
+		return iff<incoming.iff;
+	}
+	for(int i=0; i<2; ++i)
+	{
+		if(start[i]!=incoming.start[i])
+		{
+			return start[i]<incoming.start[i];
+		}
+	}
+	for(int i=0; i<2; ++i)
+	{
+		if(goal[i]!=incoming.goal[i])
+		{
+			return goal[i]<incoming.goal[i];
+		}
+	}
+	return false;
+}
+
+////////////////////////////////////////////////////////////
+
+FsRoutePlanner::FsRoutePlanner(int nThread) : scheduler(nThread),group(scheduler)
+{
+	cellSize=(double)DEFAULT_CELL_SIZE;
+	threatVersion=0;
+	threat=std::make_shared <const YsArray <Threat> >();
+}
+
+FsRoutePlanner::~FsRoutePlanner()
+{
+	group.Wait();
+}
+
+void FsRoutePlanner::CleanUp(void)
+{
+	std::lock_guard <std::mutex> lock(cacheMutex);
+	threatVersion=0;
+	threat=std::make_shared <const YsArray <Threat> >();
+	cache.clear();
+}
+
+void FsRoutePlanner::SetThreat(unsigned int version,const YsArray <Threat> &newThreat)
+{
+	std::lock_guard <std::mutex> lock(cacheMutex);
+	if(version!=threatVersion)
+	{
+		threatVersion=version;
+		threat=std::make_shared <const YsArray <Threat> >(newThreat);
+
+		// Every route in the cache was planned against the older threats.
+		cache.clear();
+	}
+}
+
+unsigned int FsRoutePlanner::GetThreatVersion(void) const
+{
+	std::lock_guard <std::mutex> lock(cacheMutex);
+	return threatVersion;
+}
+
+std::shared_future <FsRoutePlanner::Route> FsRoutePlanner::RequestRoute(int iff,const YsVec2 &start,const YsVec2 &goal)
+{
+	Key key;
+	key.iff=iff;
+	GetCell(key.start,start);
+	GetCell(key.goal,goal);
+
+	std::lock_guard <std::mutex> lock(cacheMutex);
+
+	auto found=cache.find(key);
+	if(cache.end()!=found)
+	{
+		return found->second;
+	}
+
+	if(MAX_NUM_CACHED_ROUTE<=(int)cache.size())
+	{
+		cache.clear();
+	}
+
+	const unsigned int version=threatVersion;
+	const std::shared_ptr <const YsArray <Threat> > threatCopy=threat;
+	const YsVec2 startCen=GetCellCenter(key.start),goalCen=GetCellCenter(key.goal);
+
+	// std::function needs a copyable callable.  packaged_task is move-only, therefore it is shared.
+	auto task=std::make_shared <std::packaged_task <Route()> >(
+		[version,threatCopy,iff,startCen,goalCen]()
+		{
+			return Plan(version,*threatCopy,iff,startCen,goalCen);
+		});
+
+	std::shared_future <Route> routeFuture=task->get_future().share();
+	cache[key]=routeFuture;
+	group.Run([task](){(*task)();});
+	return routeFuture;
+}
+
+/* static */ FsRoutePlanner::Route FsRoutePlanner::Plan(unsigned int threatVersion,const YsArray <Threat> &threat,int iff,const YsVec2 &start,const YsVec2 &goal)
+{
+	Route route;
+	route.threatVersion=threatVersion;
+
+	FsThreatAvoidingPathFinder finder;
+	finder.SetStart(start);
+	finder.SetGoal(goal);
+
+	// A threat that covers the goal cannot be avoided anyway.
+	for(auto &t : threat)
+	{
+		const double rad=t.range+(double)THREAT_MARGIN;
+		if(t.iff!=iff && rad<(goal-t.pos).GetLength())
+		{
+			finder.AddCircle(t.pos,rad);
+		}
+	}
+
+	if(start==goal || YSOK!=finder.MakeLattice(MAX_NUM_LATTICE_CELL))
+	{
+		route.wayPoint.Append(start);
+		route.wayPoint.Append(goal);
+		return route;
+	}
+
+	while(YSTRUE==finder.RemoveOverlap())
+	{
+	}
+	for(auto &circle : finder.circleArray)
+	{
+		if(YSTRUE==circle.isAlive && YSTRUE==circle.IsInside(goal))
+		{
+			circle.isAlive=YSFALSE;
+		}
+	}
+
+	finder.DisplaceStartPositionOutOfThreat();
+	finder.CalculatePathCircleIntersection();
+	finder.MakeFlightPath();
+
+	route.wayPoint=finder.flightPath;
+	return route;
+}
+
+void FsRoutePlanner::GetCell(int cell[2],const YsVec2 &pos) const
+{
+	cell[0]=(int)floor(pos.x()/cellSize);
+	cell[1]=(int)floor(pos.y()/cellSize);
+}
+
+YsVec2 FsRoutePlanner::GetCellCenter(const int cell[2]) const
+{
+	return YsVec2(((double)cell[0]+0.5)*cellSize,((double)cell[1]+0.5)*cellSize);
+}
@@ -0,0 +1,98 @@
+#ifndef FSROUTEPLANNER_IS_INCLUDED
+#define FSROUTEPLANNER_IS_INCLUDED
+/* { */
+
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include <ysclass.h>
+#include <ystaskscheduler.h>
+
+/*! Threat-avoiding routes planned by FsThreatAvoidingPathFinder in worker threads.
+
+    A route is planned from the center of the cell of the start to the center of the cell of the goal, and is cached
+    with the IFF of the requester, the two cells, and the version of the threats.  Airplanes that leave the same area
+    for the same goal share one route, and asking for the route every control tick only costs a look-up.
+
+    The threats are given in the main thread by SetThreat.  When the version changes, the routes planned against the
+    older threats are dropped from the cache.  The futures already handed out stay valid.
+
+    RequestRoute may be called from the threads of the parallel decision of the autopilots.
+*/
+class FsRoutePlanner
+{
+public:
+	enum
+	{
+		DEFAULT_NUM_THREAD=2,
+		DEFAULT_CELL_SIZE=2000,
+		THREAT_MARGIN=1000,          // Added to the range of the threats.
+		MAX_NUM_LATTICE_CELL=4096,   // For FsThreatAvoidingPathFinder::MakeLattice
+		MAX_NUM_CACHED_ROUTE=1024
+	};
+
+	class Threat
+	{
+	public:
+		int iff;
+		YsVec2 pos;
+		double range;
+	};
+
+	class Route
+	{
+	public:
+		unsigned int threatVersion;
+		YsArray <YsVec2> wayPoint;   // wayPoint[0] is the start and wayPoint.Last() is the goal.
+	};
+
+private:
+	FsRoutePlanner(const FsRoutePlanner &);
+	FsRoutePlanner &operator=(const FsRoutePlanner &);
+
+	class Key
+	{
+	public:
+		int iff;
+		int start[2],goal[2];
+
+		bool operator<(const Key &incoming) const;
+	};
+
+	YsTaskScheduler scheduler;
+	YsTaskScheduler::TaskGroup group;
+
+	double cellSize;
+	mutable std::mutex cacheMutex;
+	unsigned int threatVersion;
+	std::shared_ptr <const YsArray <Threat> > threat;
+	std::map <Key,std::shared_future <Route> > cache;
+
+	static Route Plan(unsigned int threatVersion,const YsArray <Threat> &threat,int iff,const YsVec2 &start,const YsVec2 &goal);
+	void GetCell(int cell[2],const YsVec2 &pos) const;
+	YsVec2 GetCellCenter(const int cell[2]) const;
+
+public:
+	FsRoutePlanner(int nThread=DEFAULT_NUM_THREAD);
+
+	/*! Waits for the routes that are being planned. */
+	~FsRoutePlanner();
+
+	/*! Drops all the threats and the cached routes. */
+	void CleanUp(void);
+
+	/*! Replaces the threats.  Does nothing if the version is the same as the current threats. */
+	void SetThreat(unsigned int version,const YsArray <Threat> &threat);
+
+	unsigned int GetThreatVersion(void) const;
+
+	/*! Returns the route from start to goal that avoids the threats of the IFFs other than iff.
+	    The route is the cached one if the same cells were asked with the current threats, or starts being planned
+	    otherwise.  The future becomes ready when the route is planned. */
+	std::shared_future <Route> RequestRoute(int iff,const YsVec2 &start,const YsVec2 &goal);
+};
+
+/* } */
+#endif
@@ -225,6 +225,7 @@ void FsThreatAvoidingPathFinder::CalculatePathCircleIntersection(void) // Still
 	YsArray <double,16> itscDist;
 
 	YsVec2 pathDir=YsUnitVector(goal-start);
+	const double pathLng=(goal-start).GetLength();
 	for(auto circleIdx : circleArray.AllIndex())
 	{
 		auto &circle=circleArray[circleIdx];
@@ -243,6 +244,12 @@ void FsThreatAvoidingPathFinder::CalculatePathCircleIntersection(void) // Still
 				YsSwapSomething(itsc[0],itsc[1]);
 			}
 
+			// The line is not bounded.  Skip the circles behind the start and beyond the goal.
+			if(dist[1]<0.0 || pathLng<dist[0])
+			{
+				continue;
+			}
+
 			itscArray.Increment();
 			itscArray.Last().circleIdx=circleIdx;
 			itscArray.Last().itsc[0]=itsc[0];
@@ -2345,6 +2345,7 @@ void YsScenery::Initialize(void)
 	YsSceneryItem::Initialize();
 
 	mapDrawingOrderCache.CleanUp();
+	elevationIndexCache.CleanUp();
 	mapElevationCache.CleanUp();
 
 	idName.Set("");
@@ -3185,8 +3186,302 @@ YSRESULT YsScenery::GetFirstPointOfPointSet(YsVec3 &point,const YsSceneryPointSe
 	return YSERR;
 }
 
+void YsScenery::ElevationIndex::Frame::Set(const YsMatrix4x4 &tfm,const YsVec3 bbx[2])
+{
+	for(int i=0; i<4; ++i)
+	{
+		this->tfm[0][i]=tfm.v(1,i+1);
+		this->tfm[1][i]=tfm.v(3,i+1);
+	}
+	this->bbx[0].GetXZ(bbx[0]);
+	this->bbx[1].GetXZ(bbx[1]);
+}
+
+YSBOOL YsScenery::ElevationIndex::Frame::IsVertical(void) const
+{
+	if(YsTolerance>fabs(tfm[0][1]) && YsTolerance>fabs(tfm[1][1]))
+	{
+		return YSTRUE;
+	}
+	return YSFALSE;
+}
+
+void YsScenery::ElevationIndex::Frame::GetCorner(YsVec2 corner[4]) const
+{
+	// Local (x,z)=A(X,Z)+t  ->  (X,Z)=A^-1((x,z)-t)
+	const double a=tfm[0][0],b=tfm[0][2],c=tfm[1][0],d=tfm[1][2];
+	const double det=a*d-b*c;
+	const YsVec2 loc[4]=
+	{
+		YsVec2(bbx[0].x()-YsTolerance,bbx[0].y()-YsTolerance),
+		YsVec2(bbx[1].x()+YsTolerance,bbx[0].y()-YsTolerance),
+		YsVec2(bbx[1].x()+YsTolerance,bbx[1].y()+YsTolerance),
+		YsVec2(bbx[0].x()-YsTolerance,bbx[1].y()+YsTolerance),
+	};
+	for(int i=0; i<4; ++i)
+	{
+		const double x=loc[i].x()-tfm[0][3];
+		const double z=loc[i].y()-tfm[1][3];
+		corner[i].Set((d*x-b*z)/det,(a*z-c*x)/det);
+	}
+}
+
+void YsScenery::CacheElevationIndex(void)
+{
+	auto &idx=elevationIndexCache;
+	idx.CleanUp();
+
+	YsArray <ElevationIndex::Frame,4> ancestor;
+	YsMatrix4x4 sceneryTfm;
+	YsMatrix3x3 nomTfm;
+	MakeElevationIndex(idx,ancestor,sceneryTfm,nomTfm);
+
+	// Cells cover the bounding box of this scenery, since GetElevation_Index rejects a point outside of it first.
+	YsVec2 min,max;
+	min.GetXZ(bbx[0]);
+	max.GetXZ(bbx[1]);
+	min-=YsVec2(1.0,1.0);
+	max+=YsVec2(1.0,1.0);
+
+	const double maxCellPerSide=256.0,minCellSize=50.0;
+	idx.min=min;
+	idx.cellSize=YsGreater(YsGreater(max.x()-min.x(),max.y()-min.y())/maxCellPerSide,minCellSize);
+	idx.nx=YsGreater(1,(int)ceil((max.x()-min.x())/idx.cellSize));
+	idx.nz=YsGreater(1,(int)ceil((max.y()-min.y())/idx.cellSize));
+
+	YsArray <int> gridRange;  // x0,z0,x1,z1 for each grid
+	gridRange.Resize(idx.grid.GetN()*4);
+	for(YSSIZE_T gridIdx=0; gridIdx<idx.grid.GetN(); ++gridIdx)
+	{
+		int *range=gridRange.GetEditableArray()+gridIdx*4;
+		range[0]=0;
+		range[1]=0;
+		range[2]=idx.nx-1;
+		range[3]=idx.nz-1;
+
+		const auto &frame=idx.grid[gridIdx].frame;
+		if(YSTRUE==frame.IsVertical())
+		{
+			YsVec2 corner[4];
+			frame.GetCorner(corner);
+			YsBoundingBoxMaker2 mkBbx;
+			mkBbx.Make(4,corner);
+			YsVec2 gridMin,gridMax;
+			mkBbx.Get(gridMin,gridMax);
+
+			range[0]=YsBound((int)floor((gridMin.x()-idx.min.x())/idx.cellSize),0,idx.nx-1);
+			range[1]=YsBound((int)floor((gridMin.y()-idx.min.y())/idx.cellSize),0,idx.nz-1);
+			range[2]=YsBound((int)floor((gridMax.x()-idx.min.x())/idx.cellSize),0,idx.nx-1);
+			range[3]=YsBound((int)floor((gridMax.y()-idx.min.y())/idx.cellSize),0,idx.nz-1);
+			if(gridMax.x()<idx.min.x() || gridMax.y()<idx.min.y() ||
+			   idx.min.x()+idx.cellSize*(double)idx.nx<gridMin.x() || idx.min.y()+idx.cellSize*(double)idx.nz<gridMin.y())
+			{
+				range[2]=-1;  // Entirely outside.  Never found.
+			}
+		}
+	}
+
+	// Counting sort.  Grids are added in the ascending order, so each cell lists grids in the ascending order.
+	idx.cellTop.Resize(idx.nx*idx.nz+1);
+	for(auto &top : idx.cellTop)
+	{
+		top=0;
+	}
+	for(int pass=0; pass<2; ++pass)
+	{
+		for(YSSIZE_T gridIdx=0; gridIdx<idx.grid.GetN(); ++gridIdx)
+		{
+			const int *range=gridRange.GetArray()+gridIdx*4;
+			for(int z=range[1]; z<=range[3]; ++z)
+			{
+				for(int x=range[0]; x<=range[2]; ++x)
+				{
+					const int cellIdx=z*idx.nx+x;
+					if(0==pass)
+					{
+						++idx.cellTop[cellIdx+1];
+					}
+					else
+					{
+						idx.cellGrid[idx.cellTop[cellIdx]++]=(int)gridIdx;
+					}
+				}
+			}
+		}
+		if(0==pass)
+		{
+			for(YSSIZE_T i=1; i<idx.cellTop.GetN(); ++i)
+			{
+				idx.cellTop[i]+=idx.cellTop[i-1];
+			}
+			idx.cellGrid.Resize(idx.cellTop.Last());
+		}
+		else
+		{
+			// cellTop[i] now points to the end of cell i, which is the top of cell i+1.
+			for(YSSIZE_T i=idx.cellTop.GetN()-1; 0<i; --i)
+			{
+				idx.cellTop[i]=idx.cellTop[i-1];
+			}
+			idx.cellTop[0]=0;
+		}
+	}
+
+	idx.cached=YSTRUE;
+}
+
+void YsScenery::ClearElevationIndex(void)
+{
+	elevationIndexCache.CleanUp();
+}
+
+YSBOOL YsScenery::ElevationIndexCached(void) const
+{
+	return elevationIndexCache.cached;
+}
+
+const YsScenery::ElevationIndex &YsScenery::GetElevationIndex(void) const
+{
+	return elevationIndexCache;
+}
+
+void YsScenery::MakeElevationIndex(
+    ElevationIndex &idx,YsArray <ElevationIndex::Frame,4> &ancestor,const YsMatrix4x4 &sceneryTfm,const YsMatrix3x3 &nomTfm) const
+{
+	// Same order as GetElevation_Recursion.
+	const YsListItem <YsSceneryElevationGrid> *evg=NULL;
+	while((evg=FindNextElevationGrid(evg))!=NULL)
+	{
+		YsMatrix4x4 gridTfm;
+		gridTfm.MultiplyInverse(evg->dat.pos,evg->dat.att);
+		gridTfm*=sceneryTfm;
+
+		YsVec3 gridBbx[2];
+		evg->dat.GetBoundingBox(gridBbx);
+
+		ElevationIndex::GridEntry ent;
+		ent.evg=&evg->dat;
+		ent.frame.Set(gridTfm,gridBbx);
+		ent.nomTfm=nomTfm;
+		ent.nomTfm*=evg->dat.att;
+		ent.ancestorTop=idx.ancestor.GetN();
+
+		YsVec2 corner[4];
+		const YSBOOL gridIsVertical=ent.frame.IsVertical();
+		if(YSTRUE==gridIsVertical)
+		{
+			ent.frame.GetCorner(corner);
+		}
+		for(auto &frame : ancestor)
+		{
+			// The test by a sub-scenery is redundant if the grid is entirely inside of its bounding box.
+			YSBOOL redundant=YSFALSE;
+			if(YSTRUE==gridIsVertical && YSTRUE==frame.IsVertical())
+			{
+				redundant=YSTRUE;
+				for(auto &c : corner)
+				{
+					const YsVec2 loc=frame.GetLocalXZ(YsVec3(c.x(),0.0,c.y()));
+					if(loc.x()<frame.bbx[0].x() || frame.bbx[1].x()<loc.x() ||
+					   loc.y()<frame.bbx[0].y() || frame.bbx[1].y()<loc.y())
+					{
+						redundant=YSFALSE;
+						break;
+					}
+				}
+			}
+			if(YSTRUE!=redundant)
+			{
+				idx.ancestor.Append(frame);
+			}
+		}
+		ent.nAncestor=idx.ancestor.GetN()-ent.ancestorTop;
+
+		idx.grid.Append(ent);
+	}
+
+	const YsListItem <YsScenery> *scn=NULL;
+	while((scn=FindNextChildScenery(scn))!=NULL)
+	{
+		YsMatrix4x4 subTfm;
+		subTfm.MultiplyInverse(scn->dat.pos,scn->dat.att);
+		subTfm*=sceneryTfm;
+
+		YsMatrix3x3 subNomTfm=nomTfm;
+		subNomTfm*=scn->dat.att;
+
+		ancestor.Increment();
+		ancestor.Last().Set(subTfm,scn->dat.bbx);
+		scn->dat.MakeElevationIndex(idx,ancestor,subTfm,subNomTfm);
+		ancestor.DeleteLast();
+	}
+}
+
+const YsScenery::ElevationIndex::GridEntry *YsScenery::GetElevation_Index(double &elv,int &x,int &z,int &f,const YsVec3 &pos) const
+{
+	auto &idx=elevationIndexCache;
+
+	elv=0.0;
+
+	YsVec2 tst2,bbx2[2];
+	tst2.GetXZ(pos);
+	bbx2[0].GetXZ(bbx[0]);
+	bbx2[1].GetXZ(bbx[1]);
+	if(YsCheckInsideBoundingBox2(tst2,bbx2[0],bbx2[1])!=YSTRUE)
+	{
+		return nullptr;
+	}
+
+	const int cx=YsBound((int)((tst2.x()-idx.min.x())/idx.cellSize),0,idx.nx-1);
+	const int cz=YsBound((int)((tst2.y()-idx.min.y())/idx.cellSize),0,idx.nz-1);
+	const int cellIdx=cz*idx.nx+cx;
+
+	const ElevationIndex::GridEntry *found=nullptr;
+	for(int i=idx.cellTop[cellIdx]; i<idx.cellTop[cellIdx+1]; ++i)
+	{
+		const auto &ent=idx.grid[idx.cellGrid[i]];
+
+		const YsVec2 loc=ent.frame.GetLocalXZ(pos);
+		if(YsCheckInsideBoundingBox2(loc,ent.frame.bbx[0],ent.frame.bbx[1])!=YSTRUE)
+		{
+			continue;
+		}
+
+		YSBOOL inside=YSTRUE;
+		for(YSSIZE_T j=0; j<ent.nAncestor; ++j)
+		{
+			const auto &frame=idx.ancestor[ent.ancestorTop+j];
+			if(YsCheckInsideBoundingBox2(frame.GetLocalXZ(pos),frame.bbx[0],frame.bbx[1])!=YSTRUE)
+			{
+				inside=YSFALSE;
+				break;
+			}
+		}
+
+		int tstX,tstZ,tstF;
+		double tstElv;
+		if(YSTRUE==inside &&
+		   ent.evg->evg.GetElevation(tstElv,tstX,tstZ,tstF,YsVec3(loc.x(),0.0,loc.y()))==YSOK && tstElv>elv)
+		{
+			elv=tstElv;
+			x=tstX;
+			z=tstZ;
+			f=tstF;
+			found=&ent;
+		}
+	}
+	return found;
+}
+
 double YsScenery::GetElevation(const YsSceneryItem *&evg,const YsVec3 &pos) const
 {
+	if(YSTRUE==elevationIndexCache.cached)
+	{
+		double elv;
+		GetElevation(1,&pos,&elv,&evg);
+		return elv;
+	}
+
 	double elv;
 	elv=0.0;
 	evg=NULL;
@@ -3200,6 +3495,46 @@ double YsScenery::GetElevation(const YsSceneryItem *&evg,const YsVec3 &pos) cons
 	}
 }
 
+void YsScenery::GetElevation(YSSIZE_T nPos,const YsVec3 pos[],double elv[],const YsSceneryItem *evg[]) const
+{
+	if(YSTRUE!=elevationIndexCache.cached)
+	{
+		for(YSSIZE_T i=0; i<nPos; ++i)
+		{
+			const YsSceneryItem *itm;
+			elv[i]=GetElevation(itm,pos[i]);
+			if(nullptr!=evg)
+			{
+				evg[i]=itm;
+			}
+		}
+		return;
+	}
+
+	// FsField seldom rotates the field.  Skip sine and cosine then.
+	const YSBOOL rotated=(0.0!=att.h() || 0.0!=att.p() || 0.0!=att.b() ? YSTRUE : YSFALSE);
+	YsMatrix4x4 tfm;
+	if(YSTRUE==rotated)
+	{
+		tfm.MultiplyInverse(this->pos,att);
+	}
+	for(YSSIZE_T i=0; i<nPos; ++i)
+	{
+		YsVec3 posInScenery=pos[i]-this->pos;
+		if(YSTRUE==rotated)
+		{
+			tfm.Mul(posInScenery,pos[i],1.0);
+		}
+
+		int x,z,f;
+		auto ent=GetElevation_Index(elv[i],x,z,f,posInScenery);
+		if(nullptr!=evg)
+		{
+			evg[i]=(nullptr!=ent ? ent->evg : nullptr);
+		}
+	}
+}
+
 YSRESULT YsScenery::GetElevation_Recursion(const YsSceneryItem *&itm,double &elv,const YsVec3 &posOutside) const
 {
 	YsVec2 tst2,bbx2[2];
@@ -3258,12 +3593,87 @@ YSRESULT YsScenery::GetElevation_Recursion(const YsSceneryItem *&itm,double &elv
 
 void YsScenery::GetElevationAndNormal(const YsSceneryItem *&evg,double &elv,YsVec3 &nom,const YsVec3 &pos)
 {
+	if(YSTRUE==elevationIndexCache.cached)
+	{
+		GetElevationAndNormal(1,&pos,&elv,&nom,&evg);
+		return;
+	}
+
 	elv=0.0;
 	evg=NULL;
 	nom=YsYVec();
 	GetElevationAndNormal_Recursion(evg,elv,nom,pos);
 }
 
+void YsScenery::GetElevationAndNormal(YSSIZE_T nPos,const YsVec3 pos[],double elv[],YsVec3 nom[],const YsSceneryItem *evg[]) const
+{
+	if(YSTRUE!=elevationIndexCache.cached)
+	{
+		for(YSSIZE_T i=0; i<nPos; ++i)
+		{
+			const YsSceneryItem *itm=NULL;
+			elv[i]=0.0;
+			nom[i]=YsYVec();
+			GetElevationAndNormal_Recursion(itm,elv[i],nom[i],pos[i]);
+			if(nullptr!=evg)
+			{
+				evg[i]=itm;
+			}
+		}
+		return;
+	}
+
+	const YSBOOL rotated=(0.0!=att.h() || 0.0!=att.p() || 0.0!=att.b() ? YSTRUE : YSFALSE);
+	YsMatrix4x4 tfm;
+	if(YSTRUE==rotated)
+	{
+		tfm.MultiplyInverse(this->pos,att);
+	}
+
+	// Normal is rotated by the attitudes of this scenery and its owners, as GetElevationAndNormal_Recursion does.
+	YsArray <const YsSceneryItem *,4> ownerChain;
+	for(const YsSceneryItem *itm=this; NULL!=itm; itm=itm->GetOwner())
+	{
+		ownerChain.Append(itm);
+	}
+	YsMatrix3x3 ownerNomTfm;
+	for(YSSIZE_T i=ownerChain.GetN()-1; 0<=i; --i)
+	{
+		const YsAtt3 &ownerAtt=ownerChain[i]->GetAttitude();
+		if(0.0!=ownerAtt.h() || 0.0!=ownerAtt.p() || 0.0!=ownerAtt.b())
+		{
+			ownerNomTfm*=ownerAtt;
+		}
+	}
+
+	for(YSSIZE_T i=0; i<nPos; ++i)
+	{
+		YsVec3 posInScenery=pos[i]-this->pos;
+		if(YSTRUE==rotated)
+		{
+			tfm.Mul(posInScenery,pos[i],1.0);
+		}
+
+		int x,z,f;
+		auto ent=GetElevation_Index(elv[i],x,z,f,posInScenery);
+		if(nullptr!=ent)
+		{
+			YsVec3 gridNom;
+			ent->evg->GetTriangleNormal(gridNom,x,z,f);
+			nom[i]=ownerNomTfm*(ent->nomTfm*gridNom);
+			nom[i].Normalize();
+		}
+		else
+		{
+			nom[i]=YsYVec();
+		}
+		if(nullptr!=evg)
+		{
+			evg[i]=(nullptr!=ent ? ent->evg : nullptr);
+		}
+	}
+}
+
 YSRESULT YsScenery::GetElevationAndNormal_Recursion(const YsSceneryItem *&itm,double &elv,YsVec3 &nom,const YsVec3 &posOutside) const
 {
 	YsVec2 tst2,bbx2[2];
@@ -3531,6 +3941,97 @@ const YsSceneryShell *YsScenery::CheckShellCollision(YsVec3 &itscPos,const YsVec
 	return nullptr;
 }
 
+void YsScenery::CheckShellCollision(
+    YSSIZE_T nSeg,const YsVec3 p1[],const YsVec3 p2[],const YsSceneryShell *collShl[],YsVec3 itscPos[],const YsMatrix4x4 &fieldTfm) const
+{
+	YsArray <YSSIZE_T,64> segIdx;
+	for(YSSIZE_T i=0; i<nSeg; ++i)
+	{
+		if(nullptr==collShl[i])
+		{
+			segIdx.Append(i);
+		}
+	}
+	CheckShellCollision_Recursion(segIdx.GetN(),segIdx,p1,p2,collShl,itscPos,fieldTfm);
+}
+
+void YsScenery::CheckShellCollision_Recursion(
+    YSSIZE_T nIdx,const YSSIZE_T segIdx[],
+    const YsVec3 p1[],const YsVec3 p2[],const YsSceneryShell *collShl[],YsVec3 itscPos[],const YsMatrix4x4 &fieldTfmIn) const
+{
+	YsMatrix4x4 fieldTfm;
+	fieldTfm.MultiplyInverse(this->pos,this->att);
+	fieldTfm*=fieldTfmIn;
+
+	// Segments that are already hit in the parent scenery stop there as the single-segment version does.
+	YsArray <YSSIZE_T,64> inside;
+	for(YSSIZE_T j=0; j<nIdx; ++j)
+	{
+		const YSSIZE_T i=segIdx[j];
+		if(nullptr==collShl[i])
+		{
+			const YsVec3 lineTfm[2]=
+			{
+				fieldTfm*p1[i],
+				fieldTfm*p2[i]
+			};
+			if(YSTRUE!=YsCheckOutsideBoundingBox(this->bbx,2,lineTfm))
+			{
+				inside.Append(i);
+			}
+		}
+	}
+	if(0==inside.GetN())
+	{
+		return;
+	}
+
+	const YsListItem <YsSceneryShell> *shl2=NULL;
+	while((shl2=FindNextShell(shl2))!=NULL)
+	{
+		YsMatrix4x4 overallTfm;
+		overallTfm.MultiplyInverse(shl2->dat.pos,shl2->dat.att);
+		overallTfm*=fieldTfm;
+
+		YsVec3 shl2Bbx[2];
+		shl2->dat.GetCollisionShell().GetBoundingBox(shl2Bbx);
+
+		for(auto i : inside)
+		{
+			if(nullptr!=collShl[i])
+			{
+				continue;
+			}
+
+			const YsVec3 lineTfm[2]=
+			{
+				overallTfm*p1[i],
+				overallTfm*p2[i]
+			};
+			if(YSTRUE==YsCheckOutsideBoundingBox(shl2Bbx,2,lineTfm))
+			{
+				continue;
+			}
+
+			YsArray <YsShellPolygonHandle,16> allItscPlHd;
+			YsArray <YsVec3,16> allItscPos;
+			if(YSOK==shl2->dat.collLtc.ShootFiniteRay(allItscPos,allItscPlHd,lineTfm[0],lineTfm[1]) &&
+			   0<allItscPos.size())
+			{
+				overallTfm.MulInverse(itscPos[i],allItscPos[0],1.0);
+				collShl[i]=&shl2->dat;
+			}
+		}
+	}
+
+	const YsListItem <YsScenery> *scn;
+	scn=NULL;
+	while((scn=FindNextChildScenery(scn))!=NULL)
+	{
+		scn->dat.CheckShellCollision_Recursion(inside.GetN(),inside,p1,p2,collShl,itscPos,fieldTfm);
+	}
+}
+
 const char *YsScenery::GetIdName(void) const
 {
 	return idName.Txt();
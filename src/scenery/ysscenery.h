@@ -1046,6 +1046,82 @@ public:
 		}
 	};
 
+	/*! Flattened 2D index of all elevation grids under a scenery, which saves GetElevation and
+	    GetElevationAndNormal from walking the scenery tree and rotating the point at every level.
+
+	    Everything is in the local coordinate of the scenery that owns the index, so the index stays valid
+	    when pos and att of the scenery change.  (FsField sets them before every query.)
+	    Each grid keeps the transformation from that coordinate to the grid's local coordinate,
+	    and the rotation that takes the grid's normal back.  The bounding box of an intermediate scenery
+	    is kept only when it may cut off part of the grid.
+
+	    Grids are numbered in the order GetElevation_Recursion visits them, and each cell lists them in
+	    ascending order, so that the same grid wins when two grids give the same elevation.
+
+	    The index is not updated when an elevation grid or a sub-scenery is moved or edited.
+	    Call CacheElevationIndex again or ClearElevationIndex after editing.
+	*/
+	class ElevationIndex
+	{
+	public:
+		/*! XZ test against a bounding box in a local coordinate. */
+		class Frame
+		{
+		public:
+			double tfm[2][4];  // Rows of the transformation that give local x and z.
+			YsVec2 bbx[2];
+
+			inline YsVec2 GetLocalXZ(const YsVec3 &pos) const
+			{
+				return YsVec2(
+				    tfm[0][0]*pos.x()+tfm[0][1]*pos.y()+tfm[0][2]*pos.z()+tfm[0][3],
+				    tfm[1][0]*pos.x()+tfm[1][1]*pos.y()+tfm[1][2]*pos.z()+tfm[1][3]);
+			}
+			void Set(const YsMatrix4x4 &tfm,const YsVec3 bbx[2]);
+
+			/*! Returns YSTRUE if local x and z do not depend on y, in which case the region that passes
+			    the test is a vertical prism. */
+			YSBOOL IsVertical(void) const;
+
+			/*! Returns the corners of the region that passes the test.  Valid only if IsVertical() is YSTRUE. */
+			void GetCorner(YsVec2 corner[4]) const;
+		};
+		class GridEntry
+		{
+		public:
+			const YsSceneryElevationGrid *evg;
+			Frame frame;
+			YsMatrix3x3 nomTfm;
+			YSSIZE_T ancestorTop,nAncestor;  // Range in ElevationIndex::ancestor
+		};
+
+		YSBOOL cached;
+		YsVec2 min;
+		double cellSize;
+		int nx,nz;
+		YsArray <GridEntry> grid;
+		YsArray <Frame> ancestor;
+		YsArray <int> cellTop;  // nx*nz+1
+		YsArray <int> cellGrid;
+
+		ElevationIndex()
+		{
+			CleanUp();
+		}
+		void CleanUp(void)
+		{
+			cached=YSFALSE;
+			min=YsVec2::Origin();
+			cellSize=1.0;
+			nx=0;
+			nz=0;
+			grid.CleanUp();
+			ancestor.CleanUp();
+			cellTop.CleanUp();
+			cellGrid.CleanUp();
+		}
+	};
+
 public:
 	static int lightPointSizePix;
 	static float lightPointSize3d;
@@ -1162,6 +1238,7 @@ public:
 	YsArray <double> mapElevationCache;
 private:
 	MapDrawingOrder mapDrawingOrderCache;
+	ElevationIndex elevationIndexCache;
 
 public:
 	// Error code from C standard library >>
@@ -1339,13 +1416,29 @@ public:
 
 	YSRESULT GetFirstPointOfPointSet(YsVec3 &point,const YsSceneryPointSet *pst) const;
 
+public:
+	/*! Makes the elevation index.  GetElevation and GetElevationAndNormal use the index once it is cached. */
+	void CacheElevationIndex(void);
+	void ClearElevationIndex(void);
+	YSBOOL ElevationIndexCached(void) const;
+	const ElevationIndex &GetElevationIndex(void) const;
+protected:
+	void MakeElevationIndex(ElevationIndex &idx,YsArray <ElevationIndex::Frame,4> &ancestor,const YsMatrix4x4 &sceneryTfm,const YsMatrix3x3 &nomTfm) const;
+	const ElevationIndex::GridEntry *GetElevation_Index(double &elv,int &x,int &z,int &f,const YsVec3 &posInScenery) const;
+
 public:
 	double GetElevation(const YsSceneryItem *&evg,const YsVec3 &pos) const;
+
+	/*! Batch version of GetElevation.  evg can be nullptr if the elevation grids are not needed. */
+	void GetElevation(YSSIZE_T nPos,const YsVec3 pos[],double elv[],const YsSceneryItem *evg[]) const;
 protected:
 	YSRESULT GetElevation_Recursion(const YsSceneryItem *&evg,double &elv,const YsVec3 &pos) const;
 
 public:
 	void GetElevationAndNormal(const YsSceneryItem *&evg,double &elv,YsVec3 &nom,const YsVec3 &pos);
+
+	/*! Batch version of GetElevationAndNormal.  evg can be nullptr if the elevation grids are not needed. */
+	void GetElevationAndNormal(YSSIZE_T nPos,const YsVec3 pos[],double elv[],YsVec3 nom[],const YsSceneryItem *evg[]) const;
 protected:
 	YSRESULT GetElevationAndNormal_Recursion(const YsSceneryItem *&evg,double &elv,YsVec3 &nom,const YsVec3 &pos) const;
 
@@ -1354,6 +1447,17 @@ public:
 	const YsSceneryShell *CheckShellCollision(const YsShell &shl,const YsMatrix4x4 &modelTfm) const;
 	const YsSceneryShell *CheckShellCollision(YsVec3 &itscPos,const YsVec3 &p1,const YsVec3 &p2,const YsMatrix4x4 &fieldTfm) const;
 
+	/*! Batch version of CheckShellCollision for line segments.  Only the segments with nullptr in collShl[] are checked.
+	    collShl[i] and itscPos[i] are set when the segment p1[i]-p2[i] hits a shell.  The transformation of each shell is
+	    calculated once for all segments.  The result for each segment is the same as the single-segment version. */
+	void CheckShellCollision(
+	    YSSIZE_T nSeg,const YsVec3 p1[],const YsVec3 p2[],const YsSceneryShell *collShl[],YsVec3 itscPos[],const YsMatrix4x4 &fieldTfm) const;
+protected:
+	void CheckShellCollision_Recursion(
+	    YSSIZE_T nIdx,const YSSIZE_T segIdx[],
+	    const YsVec3 p1[],const YsVec3 p2[],const YsSceneryShell *collShl[],YsVec3 itscPos[],const YsMatrix4x4 &fieldTfm) const;
+public:
+
 	const char *GetIdName(void) const;
 
 	const YsColor &GetGroundColor(void) const;
@@ -0,0 +1,219 @@
+/* ////////////////////////////////////////////////////////////
+
+File Name: test.cpp
+Copyright (c) 2017 Soji Yamakawa.  All rights reserved.
+http://www.ysflight.com
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, 
+   this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, 
+   this list of conditions and the following disclaimer in the documentation 
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR 
+PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) 
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+//////////////////////////////////////////////////////////// */
+
+#include <stdio.h>
+#include <chrono>
+#include <thread>
+#include <ysclass.h>
+#include <fsworld.h>
+
+// Linked with the YSFLIGHT libraries, which expect the program to define these.
+const wchar_t *FsProgramName=L"YSFLIGHT";
+const char *FsProgramTitle="YS FLIGHT SIMULATOR";
+
+static YsWString runtimeDir;
+
+/*! Gives access to the models and the streaming state of FsAirplaneTemplate.
+    The getters (GetVisual etc.) return nullptr in the console server, which this test is linked as. */
+class TestAirplaneTemplate : public FsAirplaneTemplate
+{
+public:
+	TestAirplaneTemplate()
+	{
+		SetRootDir(runtimeDir);
+		SetVisualFileName(L"aircraft/a10.dnm");
+		SetLodFileName(L"aircraft/a10coarse.dnm");
+	}
+
+	using FsAirplaneTemplate::WaitStreamedModel;
+
+	YSBOOL HasVisual(void) const
+	{
+		return (nullptr!=vis ? YSTRUE : YSFALSE);
+	}
+	YSBOOL HasLod(void) const
+	{
+		return (nullptr!=lod ? YSTRUE : YSFALSE);
+	}
+	YSSIZE_T GetNumStreamedModel(void) const
+	{
+		return streamedModel.GetN();
+	}
+};
+
+YSRESULT StreamAndInstallTest(void)
+{
+	printf("%s\n",__FUNCTION__);
+
+	FsAirplaneAssetStreamer streamer(2);
+	TestAirplaneTemplate tmpl;
+
+	tmpl.StreamModel(streamer,FsAirplaneModelSet::MODEL_VISUAL|FsAirplaneModelSet::MODEL_LOD);
+	if(YSTRUE!=tmpl.IsStreamingModel(FsAirplaneModelSet::MODEL_VISUAL) ||
+	   YSTRUE!=tmpl.IsStreamingModel(FsAirplaneModelSet::MODEL_LOD) ||
+	   YSTRUE==tmpl.IsStreamingModel(FsAirplaneModelSet::MODEL_COCKPIT))
+	{
+		fprintf(stderr,"Wrong models are being streamed.\n");
+		return YSERR;
+	}
+
+	// Models already being streamed, and the cockpit, which has no file, are not requested again.
+	tmpl.StreamModel(streamer,FsAirplaneModelSet::MODEL_ALL);
+	if(1!=tmpl.GetNumStreamedModel())
+	{
+		fprintf(stderr,"Same models are requested twice.\n");
+		return YSERR;
+	}
+
+	if(YSTRUE!=tmpl.InstallStreamedModel(YSTRUE))
+	{
+		fprintf(stderr,"InstallStreamedModel(YSTRUE) did not take all the models.\n");
+		return YSERR;
+	}
+	if(YSTRUE!=tmpl.HasVisual() || YSTRUE!=tmpl.HasLod() || YSTRUE==tmpl.IsStreamingModel())
+	{
+		fprintf(stderr,"Models are not installed.\n");
+		return YSERR;
+	}
+
+	// Models that are loaded are not requested again.
+	tmpl.StreamModel(streamer,FsAirplaneModelSet::MODEL_ALL);
+	if(0!=tmpl.GetNumStreamedModel())
+	{
+		fprintf(stderr,"Loaded models are requested again.\n");
+		return YSERR;
+	}
+	return YSOK;
+}
+
+YSRESULT WaitTest(void)
+{
+	printf("%s\n",__FUNCTION__);
+
+	FsAirplaneAssetStreamer streamer(2);
+	TestAirplaneTemplate tmpl;
+
+	tmpl.StreamModel(streamer,FsAirplaneModelSet::MODEL_LOD);
+	tmpl.StreamModel(streamer,FsAirplaneModelSet::MODEL_VISUAL);
+	if(2!=tmpl.GetNumStreamedModel())
+	{
+		fprintf(stderr,"Wrong number of requests.\n");
+		return YSERR;
+	}
+
+	tmpl.WaitStreamedModel(FsAirplaneModelSet::MODEL_LOD);
+	if(YSTRUE!=tmpl.HasLod() || YSTRUE==tmpl.IsStreamingModel(FsAirplaneModelSet::MODEL_LOD))
+	{
+		fprintf(stderr,"WaitStreamedModel did not install the coarse model.\n");
+		return YSERR;
+	}
+
+	// Only finished loads are taken without waiting.
+	for(int i=0; i<10000 && YSTRUE!=tmpl.InstallStreamedModel(YSFALSE); ++i)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	if(YSTRUE!=tmpl.HasVisual() || 0!=tmpl.GetNumStreamedModel())
+	{
+		fprintf(stderr,"InstallStreamedModel(YSFALSE) did not install the visual model.\n");
+		return YSERR;
+	}
+	return YSOK;
+}
+
+YSRESULT CancelPrefetchTest(void)
+{
+	printf("%s\n",__FUNCTION__);
+
+	// No worker thread.  Nothing is loaded until streamer.Wait, so that the cancellation always comes first.
+	FsAirplaneAssetStreamer streamer(0);
+	TestAirplaneTemplate prefetchOnly,prefetchAndUse,use;
+
+	prefetchOnly.StreamModel(streamer,FsAirplaneModelSet::MODEL_LOD,YSTRUE);
+	prefetchAndUse.StreamModel(streamer,FsAirplaneModelSet::MODEL_LOD,YSTRUE);
+	prefetchAndUse.StreamModel(streamer,FsAirplaneModelSet::MODEL_LOD);
+	use.StreamModel(streamer,FsAirplaneModelSet::MODEL_LOD);
+
+	prefetchOnly.CancelPrefetch();
+	prefetchAndUse.CancelPrefetch();
+	use.CancelPrefetch();
+	streamer.Wait();
+
+	prefetchOnly.InstallStreamedModel(YSTRUE);
+	prefetchAndUse.InstallStreamedModel(YSTRUE);
+	use.InstallStreamedModel(YSTRUE);
+
+	if(YSTRUE==prefetchOnly.HasLod() || YSTRUE==prefetchOnly.IsStreamingModel())
+	{
+		fprintf(stderr,"Cancelled prefetch is loaded.\n");
+		return YSERR;
+	}
+	if(YSTRUE!=prefetchAndUse.HasLod())
+	{
+		fprintf(stderr,"Prefetch that is asked again without prefetch is cancelled.\n");
+		return YSERR;
+	}
+	if(YSTRUE!=use.HasLod())
+	{
+		fprintf(stderr,"Load that is not a prefetch is cancelled.\n");
+		return YSERR;
+	}
+	return YSOK;
+}
+
+int main(int ac,char *av[])
+{
+	if(ac<2)
+	{
+		fprintf(stderr,"Usage: %s RuntimeDirectory\n",av[0]);
+		return 1;
+	}
+	runtimeDir.SetUTF8String(av[1]);
+
+	int nFail=0;
+	if(YSOK!=StreamAndInstallTest())
+	{
+		++nFail;
+	}
+	if(YSOK!=WaitTest())
+	{
+		++nFail;
+	}
+	if(YSOK!=CancelPrefetchTest())
+	{
+		++nFail;
+	}
+
+	printf("%d failed.\n",nFail);
+	if(0<nFail)
+	{
+		return 1;
+	}
+	return 0;
+}
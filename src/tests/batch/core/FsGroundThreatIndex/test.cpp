@@ -0,0 +1,320 @@
+/* ////////////////////////////////////////////////////////////
+
+File Name: test.cpp
+Copyright (c) 2017 Soji Yamakawa.  All rights reserved.
+http://www.ysflight.com
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, 
+   this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, 
+   this list of conditions and the following disclaimer in the documentation 
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR 
+PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) 
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+//////////////////////////////////////////////////////////// */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <ysclass.h>
+#include <fsgroundthreatindex.h>
+
+// Linked with the YSFLIGHT libraries, which expect the program to define these.
+const wchar_t *FsProgramName=L"YSFLIGHT";
+const char *FsProgramTitle="YS FLIGHT SIMULATOR";
+
+// The index does not look into FsGround.  The sites are identified by the addresses in this array.
+static char siteId[1024];
+
+static const FsGround *SiteId(YSSIZE_T i)
+{
+	return (const FsGround *)(siteId+i);
+}
+
+static double RandomNumber(const double min,const double max)
+{
+	return min+(max-min)*(double)rand()/(double)RAND_MAX;
+}
+
+/*! Same test as FsSimulation::FindGroundToAirThreat with all the ground objects. */
+static void BruteForce(YsArray <const FsGround *> &found,const YsArray <FsGroundThreatIndex::Site> &site,const YsVec3 &A,const YsVec3 &B,int airIff)
+{
+	found.Clear();
+	for(auto &s : site)
+	{
+		if(FS_IFF_NEUTRAL!=s.iff && airIff!=s.iff && YSTRUE==s.isAlive &&
+		   YsTolerance<s.range && YsGetPointLineDistance3(A,B,s.pos)<s.range)
+		{
+			found.Append(s.gnd);
+		}
+	}
+}
+
+static YSRESULT CheckSuperset(const FsGroundThreatIndex &index,const YsArray <FsGroundThreatIndex::Site> &site,const YsVec3 &A,const YsVec3 &B,int airIff)
+{
+	YsArray <const FsGround *,64> can;
+	if(YSOK!=index.GetThreatCandidateOnLine(can,A,B,airIff))
+	{
+		fprintf(stderr,"Index failed to narrow down (%lf %lf %lf)-(%lf %lf %lf).\n",A.x(),A.y(),A.z(),B.x(),B.y(),B.z());
+		return YSERR;
+	}
+
+	for(YSSIZE_T i=1; i<can.GetN(); ++i)
+	{
+		if(can[i]<=can[i-1])
+		{
+			fprintf(stderr,"Candidates are not unique, or not in the order of the ground list.\n");
+			return YSERR;
+		}
+	}
+
+	YsArray <const FsGround *> found;
+	BruteForce(found,site,A,B,airIff);
+	for(auto gnd : found)
+	{
+		YSBOOL inCan=YSFALSE;
+		for(auto c : can)
+		{
+			if(c==gnd)
+			{
+				inCan=YSTRUE;
+				break;
+			}
+		}
+		if(YSTRUE!=inCan)
+		{
+			const auto &s=site[(const char *)gnd-siteId];
+			fprintf(stderr,"Missed a site at (%lf %lf %lf) range %lf IFF %d\n",s.pos.x(),s.pos.y(),s.pos.z(),s.range,s.iff);
+			fprintf(stderr,"  Line (%lf %lf %lf)-(%lf %lf %lf) airIff %d\n",A.x(),A.y(),A.z(),B.x(),B.y(),B.z(),airIff);
+			return YSERR;
+		}
+	}
+	return YSOK;
+}
+
+static void MakeSite(YsArray <FsGroundThreatIndex::Site> &site,int nSite,const double areaSize)
+{
+	site.Clear();
+	for(int i=0; i<nSite; ++i)
+	{
+		site.Increment();
+		auto &s=site.Last();
+		s.gnd=SiteId(i);
+		s.pos.Set(RandomNumber(-areaSize,areaSize),RandomNumber(0.0,100.0),RandomNumber(-areaSize,areaSize));
+		s.iff=rand()%6;   // FS_IFF0 to FS_IFF_NEUTRAL, and one more for the last partition.
+		s.isAlive=(0!=rand()%8 ? YSTRUE : YSFALSE);
+		s.range=(YSTRUE==s.isAlive && 0!=rand()%4 ? RandomNumber(500.0,8000.0) : 0.0);
+	}
+}
+
+YSRESULT RandomLineTest(void)
+{
+	printf("%s\n",__FUNCTION__);
+
+	YsArray <FsGroundThreatIndex::Site> site;
+	for(int trial=0; trial<20; ++trial)
+	{
+		const double areaSize=RandomNumber(2000.0,100000.0);
+		MakeSite(site,1+rand()%300,areaSize);
+
+		FsGroundThreatIndex index;
+		index.Rebuild(site);
+
+		for(int i=0; i<2000; ++i)
+		{
+			const double lineArea=areaSize*1.5;
+			const YsVec3 A(RandomNumber(-lineArea,lineArea),RandomNumber(0.0,10000.0),RandomNumber(-lineArea,lineArea));
+			const YsVec3 B(RandomNumber(-lineArea,lineArea),RandomNumber(0.0,10000.0),RandomNumber(-lineArea,lineArea));
+			if(YSOK!=CheckSuperset(index,site,A,B,rand()%7))
+			{
+				return YSERR;
+			}
+		}
+	}
+	return YSOK;
+}
+
+// Vertical lines, lines that are almost vertical, and lines parallel to the X or Z axis.
+YSRESULT SpecialLineTest(void)
+{
+	printf("%s\n",__FUNCTION__);
+
+	YsArray <FsGroundThreatIndex::Site> site;
+	for(int trial=0; trial<20; ++trial)
+	{
+		const double areaSize=RandomNumber(2000.0,100000.0);
+		MakeSite(site,1+rand()%300,areaSize);
+
+		FsGroundThreatIndex index;
+		index.Rebuild(site);
+
+		for(int i=0; i<2000; ++i)
+		{
+			const double lineArea=areaSize*1.5;
+			const YsVec3 A(RandomNumber(-lineArea,lineArea),RandomNumber(0.0,10000.0),RandomNumber(-lineArea,lineArea));
+			YsVec3 B=A;
+			switch(i%5)
+			{
+			case 0:
+				B.SetY(A.y()+RandomNumber(100.0,5000.0));
+				break;
+			case 1:
+				B.Set(A.x()+1e-9,A.y()+1000.0,A.z()-1e-9);
+				break;
+			case 2:
+				B.Set(A.x()+1e-6,A.y()-1000.0,A.z());
+				break;
+			case 3:
+				B.SetX(A.x()+RandomNumber(-lineArea,lineArea));
+				break;
+			case 4:
+				B.SetZ(A.z()+RandomNumber(-lineArea,lineArea));
+				break;
+			}
+			if(YSOK!=CheckSuperset(index,site,A,B,rand()%7))
+			{
+				return YSERR;
+			}
+		}
+	}
+	return YSOK;
+}
+
+// Sites on the border of the grid, and lines along the border.
+YSRESULT GridBorderTest(void)
+{
+	printf("%s\n",__FUNCTION__);
+
+	const double areaSize=30000.0,range=3000.0;
+	YsArray <FsGroundThreatIndex::Site> site;
+	for(int i=0; i<=10; ++i)
+	{
+		const double t=-areaSize+2.0*areaSize*(double)i/10.0;
+		const YsVec2 border[4]=
+		{
+			YsVec2(-areaSize,t),YsVec2(areaSize,t),YsVec2(t,-areaSize),YsVec2(t,areaSize)
+		};
+		for(auto &b : border)
+		{
+			site.Increment();
+			auto &s=site.Last();
+			s.gnd=SiteId(site.GetN()-1);
+			s.pos.Set(b.x(),0.0,b.y());
+			s.iff=1;
+			s.isAlive=YSTRUE;
+			s.range=range;
+		}
+	}
+
+	FsGroundThreatIndex index;
+	index.Rebuild(site);
+
+	// The range circles reach areaSize+range+POSITION_SLACK.  Lines just inside, on, and just outside of the circles.
+	const double edge=areaSize+range;
+	const double offset[]={-range,-1.0,0.0,1.0,(double)FsGroundThreatIndex::POSITION_SLACK,(double)FsGroundThreatIndex::POSITION_SLACK+1.0};
+	for(auto d : offset)
+	{
+		const double v=edge+d;
+		const YsVec3 line[][2]=
+		{
+			{YsVec3(-v,0.0,-v),YsVec3( v,0.0,-v)},
+			{YsVec3(-v,0.0, v),YsVec3( v,0.0, v)},
+			{YsVec3(-v,0.0,-v),YsVec3(-v,0.0, v)},
+			{YsVec3( v,0.0,-v),YsVec3( v,0.0, v)},
+			{YsVec3(-v,0.0,-v),YsVec3( v,0.0, v)},
+			{YsVec3( v,0.0,-v),YsVec3(-v,0.0, v)},
+			{YsVec3( v,0.0, v),YsVec3( v,1000.0, v)},
+			{YsVec3(-areaSize,0.0,-areaSize),YsVec3(-areaSize,1000.0,-areaSize)},
+			{YsVec3( areaSize,0.0, areaSize),YsVec3( areaSize,1000.0, areaSize)},
+		};
+		for(auto &l : line)
+		{
+			if(YSOK!=CheckSuperset(index,site,l[0],l[1],0))
+			{
+				return YSERR;
+			}
+		}
+	}
+	return YSOK;
+}
+
+YSRESULT DegenerateTest(void)
+{
+	printf("%s\n",__FUNCTION__);
+
+	YsArray <const FsGround *,64> can;
+
+	FsGroundThreatIndex index;
+	if(YSOK==index.GetThreatCandidateOnLine(can,YsVec3(0.0,0.0,0.0),YsVec3(0.0,1000.0,0.0),0))
+	{
+		fprintf(stderr,"Index not built yet, but returned candidates.\n");
+		return YSERR;
+	}
+
+	YsArray <FsGroundThreatIndex::Site> site;
+	index.Rebuild(site);
+	if(YSOK!=index.GetThreatCandidateOnLine(can,YsVec3(0.0,0.0,0.0),YsVec3(1000.0,0.0,0.0),0) || 0<can.GetN())
+	{
+		fprintf(stderr,"Empty index returned candidates.\n");
+		return YSERR;
+	}
+
+	MakeSite(site,100,20000.0);
+	index.Rebuild(site);
+	if(YSOK==index.GetThreatCandidateOnLine(can,YsVec3(10.0,20.0,30.0),YsVec3(10.0,20.0,30.0),0))
+	{
+		fprintf(stderr,"A and B are the same point, but the index narrowed down the candidates.\n");
+		return YSERR;
+	}
+
+	index.Invalidate();
+	if(YSOK==index.GetThreatCandidateOnLine(can,YsVec3(0.0,0.0,0.0),YsVec3(0.0,1000.0,0.0),0))
+	{
+		fprintf(stderr,"Invalidated, but returned candidates.\n");
+		return YSERR;
+	}
+	return YSOK;
+}
+
+int main(void)
+{
+	srand(20261017);
+
+	int nFail=0;
+	if(YSOK!=RandomLineTest())
+	{
+		++nFail;
+	}
+	if(YSOK!=SpecialLineTest())
+	{
+		++nFail;
+	}
+	if(YSOK!=GridBorderTest())
+	{
+		++nFail;
+	}
+	if(YSOK!=DegenerateTest())
+	{
+		++nFail;
+	}
+
+	printf("%d failed.\n",nFail);
+	if(0<nFail)
+	{
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,278 @@
+/* ////////////////////////////////////////////////////////////
+
+File Name: test.cpp
+Copyright (c) 2017 Soji Yamakawa.  All rights reserved.
+http://www.ysflight.com
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, 
+   this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, 
+   this list of conditions and the following disclaimer in the documentation 
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR 
+PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) 
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+//////////////////////////////////////////////////////////// */
+
+#include <stdio.h>
+#include <math.h>
+#include <ysclass.h>
+#include <ysglcpp.h>
+#include <fssmoketrailcache.h>
+
+// Segments are made from the records at every step.  Segment i is between records i*step and (i+1)*step, and
+// has a different number of vertices so that the copy of the wrong range is caught.
+static const int step=4;
+static const double recInterval=0.05;
+static const double remainTime=30.0;
+
+static int NumVertex(int segIdx)
+{
+	return (0==segIdx%5 ? 0 : 6+2*(segIdx%3));  // Every fifth segment has no smoke.
+}
+
+static double SegmentTime(int segIdx,int end)
+{
+	return (double)((segIdx+end)*step)*recInterval;
+}
+
+static void MakeSegment(YsGLVertexBuffer &vtxBuf,YsGLNormalBuffer &nomBuf,YsGLColorBuffer &colBuf,int segIdx)
+{
+	vtxBuf.CleanUp();
+	nomBuf.CleanUp();
+	colBuf.CleanUp();
+	for(int i=0; i<NumVertex(segIdx); ++i)
+	{
+		const int newer=(i/2)%2;
+		vtxBuf.Add((float)segIdx,(float)i,(float)newer);
+		nomBuf.Add((float)i,(float)segIdx,1.0f);
+		colBuf.Add(0.0f,0.0f,0.0f,(float)newer);
+	}
+}
+
+static void AddSegment(FsSmokeTrailCache &cache,int segIdx)
+{
+	YsGLVertexBuffer vtxBuf;
+	YsGLNormalBuffer nomBuf;
+	YsGLColorBuffer colBuf;
+	MakeSegment(vtxBuf,nomBuf,colBuf,segIdx);
+	cache.Add(segIdx*step,SegmentTime(segIdx,0),(segIdx+1)*step,SegmentTime(segIdx,1),vtxBuf,nomBuf,colBuf);
+}
+
+/*! What AddToBuffer must make for segments seg0 to seg1-1.  Newest first, and the alpha of the end. */
+static void MakeReference(YsGLVertexBuffer &vtxBuf,YsGLNormalBuffer &nomBuf,YsGLColorBuffer &colBuf,int seg0,int seg1,const YsColor &col,double currentTime)
+{
+	vtxBuf.CleanUp();
+	nomBuf.CleanUp();
+	colBuf.CleanUp();
+	for(int segIdx=seg1-1; seg0<=segIdx; --segIdx)
+	{
+		YsGLVertexBuffer segVtxBuf;
+		YsGLNormalBuffer segNomBuf;
+		YsGLColorBuffer segColBuf;
+		MakeSegment(segVtxBuf,segNomBuf,segColBuf,segIdx);
+		for(YSSIZE_T i=0; i<segVtxBuf.GetN(); ++i)
+		{
+			const double tm=SegmentTime(segIdx,(0.5f<segColBuf[i][3] ? 1 : 0));
+			vtxBuf.Add(segVtxBuf[i][0],segVtxBuf[i][1],segVtxBuf[i][2]);
+			nomBuf.Add(segNomBuf[i][0],segNomBuf[i][1],segNomBuf[i][2]);
+			colBuf.Add(col.Rf(),col.Gf(),col.Bf(),(float)(0.8-0.8*(currentTime-tm)/remainTime));
+		}
+	}
+}
+
+static YSRESULT Compare(const FsSmokeTrailCache &cache,int seg0,int seg1,double currentTime)
+{
+	const YsColor col(0.2,0.4,0.6);
+
+	YsGLVertexBuffer refVtx,vtx;
+	YsGLNormalBuffer refNom,nom;
+	YsGLColorBuffer refCol,colBuf;
+	MakeReference(refVtx,refNom,refCol,seg0,seg1,col,currentTime);
+
+	// AddToBuffer appends.  Something already in the buffers must stay.
+	vtx.Add(-1.0f,-1.0f,-1.0f);
+	nom.Add(-1.0f,-1.0f,-1.0f);
+	colBuf.Add(-1.0f,-1.0f,-1.0f,-1.0f);
+	cache.AddToBuffer(vtx,nom,colBuf,col,currentTime,remainTime);
+
+	if(vtx.GetN()!=refVtx.GetN()+1 || nom.GetN()!=refNom.GetN()+1 || colBuf.GetN()!=refCol.GetN()+1)
+	{
+		fprintf(stderr,"Wrong number of vertices %d (Expected %d)\n",(int)vtx.GetN()-1,(int)refVtx.GetN());
+		return YSERR;
+	}
+	if(-1.0f!=vtx[0][0] || -1.0f!=nom[0][0] || -1.0f!=colBuf[0][3])
+	{
+		fprintf(stderr,"Overwrote what was in the buffer.\n");
+		return YSERR;
+	}
+	for(YSSIZE_T i=0; i<refVtx.GetN(); ++i)
+	{
+		for(int j=0; j<3; ++j)
+		{
+			if(vtx[i+1][j]!=refVtx[i][j] || nom[i+1][j]!=refNom[i][j])
+			{
+				fprintf(stderr,"Vertex %d is different.\n",(int)i);
+				return YSERR;
+			}
+		}
+		for(int j=0; j<4; ++j)
+		{
+			if(1e-6<fabs(colBuf[i+1][j]-refCol[i][j]))
+			{
+				fprintf(stderr,"Color of vertex %d is different.  %f (Expected %f)\n",(int)i,colBuf[i+1][j],refCol[i][j]);
+				return YSERR;
+			}
+		}
+	}
+	return YSOK;
+}
+
+YSRESULT AddAndDrawTest(void)
+{
+	printf("%s\n",__FUNCTION__);
+
+	FsSmokeTrailCache cache;
+	if(YSTRUE!=cache.IsEmpty())
+	{
+		fprintf(stderr,"Not empty after construction.\n");
+		return YSERR;
+	}
+	if(YSOK!=Compare(cache,0,0,1.0))
+	{
+		return YSERR;
+	}
+
+	for(int segIdx=1; segIdx<40; ++segIdx)
+	{
+		AddSegment(cache,segIdx);
+		if(YSTRUE==cache.IsEmpty() || 1*step!=cache.Oldest().recIdx0 || (segIdx+1)*step!=cache.Newest().recIdx1)
+		{
+			fprintf(stderr,"Oldest or newest segment is wrong.\n");
+			return YSERR;
+		}
+		const double currentTime=SegmentTime(segIdx,1)+1.0;
+		if(YSOK!=Compare(cache,1,segIdx+1,currentTime))
+		{
+			return YSERR;
+		}
+	}
+	return YSOK;
+}
+
+// Segments are added at the newer end and expired from the older end as the airplane flies.  The result must be
+// the same as the segments after t0 made from scratch, including after the cache moves the rest to the front.
+YSRESULT ExpireTest(void)
+{
+	printf("%s\n",__FUNCTION__);
+
+	FsSmokeTrailCache cache;
+	int oldestSeg=1,nextSeg=1;
+	for(int frame=0; frame<400; ++frame)
+	{
+		// Several segments per frame some times, and none other times.
+		const int nAdd=frame%4;
+		for(int i=0; i<nAdd; ++i)
+		{
+			AddSegment(cache,nextSeg++);
+		}
+
+		const double currentTime=SegmentTime(nextSeg,0)+1.0;
+		const double t0=YsGreater(0.0,currentTime-3.0+0.01*(double)(frame%7));
+		cache.Expire(t0);
+		while(oldestSeg<nextSeg && SegmentTime(oldestSeg,1)<=t0)
+		{
+			++oldestSeg;
+		}
+
+		if((oldestSeg==nextSeg)!=(YSTRUE==cache.IsEmpty()))
+		{
+			fprintf(stderr,"IsEmpty is wrong in frame %d.\n",frame);
+			return YSERR;
+		}
+		if(oldestSeg<nextSeg && (oldestSeg*step!=cache.Oldest().recIdx0 || nextSeg*step!=cache.Newest().recIdx1))
+		{
+			fprintf(stderr,"Oldest or newest segment is wrong in frame %d.\n",frame);
+			return YSERR;
+		}
+		if(YSOK!=Compare(cache,oldestSeg,nextSeg,currentTime))
+		{
+			fprintf(stderr,"  in frame %d\n",frame);
+			return YSERR;
+		}
+	}
+
+	// Everything expires.
+	cache.Expire(SegmentTime(nextSeg,1));
+	if(YSTRUE!=cache.IsEmpty() || YSOK!=Compare(cache,0,0,SegmentTime(nextSeg,1)))
+	{
+		fprintf(stderr,"Not empty after all segments expired.\n");
+		return YSERR;
+	}
+
+	// And can be used again.
+	AddSegment(cache,nextSeg);
+	if(YSOK!=Compare(cache,nextSeg,nextSeg+1,SegmentTime(nextSeg,1)))
+	{
+		return YSERR;
+	}
+	return YSOK;
+}
+
+YSRESULT CleanUpTest(void)
+{
+	printf("%s\n",__FUNCTION__);
+
+	FsSmokeTrailCache cache;
+	cache.smk=FSSMKSOLID;
+	cache.step=step;
+	cache.lastTime=10.0;
+	for(int segIdx=1; segIdx<10; ++segIdx)
+	{
+		AddSegment(cache,segIdx);
+	}
+	cache.CleanUp();
+	if(YSTRUE!=cache.IsEmpty() || FSSMKNULL!=cache.smk || 0!=cache.step || 0.0!=cache.lastTime)
+	{
+		fprintf(stderr,"CleanUp did not reset the cache.\n");
+		return YSERR;
+	}
+	return YSOK;
+}
+
+int main(void)
+{
+	int nFail=0;
+	if(YSOK!=AddAndDrawTest())
+	{
+		++nFail;
+	}
+	if(YSOK!=ExpireTest())
+	{
+		++nFail;
+	}
+	if(YSOK!=CleanUpTest())
+	{
+		++nFail;
+	}
+
+	printf("%d failed.\n",nFail);
+	if(0<nFail)
+	{
+		return 1;
+	}
+	return 0;
+}
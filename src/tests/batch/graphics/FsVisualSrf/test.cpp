@@ -0,0 +1,204 @@
+/* ////////////////////////////////////////////////////////////
+
+File Name: test.cpp
+Copyright (c) 2017 Soji Yamakawa.  All rights reserved.
+http://www.ysflight.com
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, 
+   this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, 
+   this list of conditions and the following disclaimer in the documentation 
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR 
+PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) 
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+//////////////////////////////////////////////////////////// */
+
+#include <stdio.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <ysclass.h>
+#include <fsvisual.h>
+
+// Linked with the YSFLIGHT libraries, which expect the program to define these.
+const wchar_t *FsProgramName=L"YSFLIGHT";
+const char *FsProgramTitle="YS FLIGHT SIMULATOR";
+
+static void MakeTriangle(FsVisualSrf &shl,YsShellVertexHandle vtHd[3])
+{
+	vtHd[0]=shl.AddVertex(YsVec3(0.0,0.0,0.0));
+	vtHd[1]=shl.AddVertex(YsVec3(1.0,0.0,0.0));
+	vtHd[2]=shl.AddVertex(YsVec3(0.0,1.0,0.0));
+	shl.AddPolygon(3,vtHd);
+}
+
+YSRESULT InvalidateTest(void)
+{
+	FsVisualSrf shl;
+	YsShellVertexHandle vtHd[3];
+	MakeTriangle(shl,vtHd);
+
+	auto tree0=shl.GetBoundingBoxTree();
+	if(1!=tree0->GetNumPolygon() || tree0!=shl.GetBoundingBoxTree())
+	{
+		fprintf(stderr,"The tree is not built once.\n");
+		return YSERR;
+	}
+
+	// Moving a vertex must give a new tree that reflects the new position.
+	shl.SetVertexPosition(vtHd[2],YsVec3(0.0,5.0,0.0));
+	auto tree1=shl.GetBoundingBoxTree();
+	if(tree0==tree1 || YsTolerance<fabs(tree1->GetNode(0).bbxMax.y()-5.0))
+	{
+		fprintf(stderr,"The tree is not rebuilt after SetVertexPosition.\n");
+		return YSERR;
+	}
+
+	// Adding a polygon.
+	YsShellVertexHandle vtHd2[3];
+	MakeTriangle(shl,vtHd2);
+	auto tree2=shl.GetBoundingBoxTree();
+	if(tree1==tree2 || 2!=tree2->GetNumPolygon())
+	{
+		fprintf(stderr,"The tree is not rebuilt after AddPolygon.\n");
+		return YSERR;
+	}
+
+	// Deleting a polygon.
+	YsShellPolygonHandle plHd=nullptr;
+	shl.MoveToNextPolygon(plHd);
+	shl.DeletePolygon(plHd);
+	auto tree3=shl.GetBoundingBoxTree();
+	if(tree2==tree3 || 1!=tree3->GetNumPolygon())
+	{
+		fprintf(stderr,"The tree is not rebuilt after DeletePolygon.\n");
+		return YSERR;
+	}
+
+	// Editing through a reference to the base class.
+	YsShellExt &ext=shl;
+	ext.SetVertexPosition(vtHd2[0],YsVec3(0.0,0.0,-7.0));
+	auto tree4=shl.GetBoundingBoxTree();
+	if(tree3==tree4 || YsTolerance<fabs(tree4->GetNode(0).bbxMin.z()+7.0))
+	{
+		fprintf(stderr,"The tree is not rebuilt after editing through YsShellExt &.\n");
+		return YSERR;
+	}
+
+	shl.CleanUp();
+	if(YSTRUE!=shl.GetBoundingBoxTree()->IsEmpty())
+	{
+		fprintf(stderr,"The tree is not rebuilt after CleanUp.\n");
+		return YSERR;
+	}
+	return YSOK;
+}
+
+YSRESULT CopyTest(void)
+{
+	FsVisualSrf shl;
+	YsShellVertexHandle vtHd[3];
+	MakeTriangle(shl,vtHd);
+	auto tree=shl.GetBoundingBoxTree();
+
+	// Copies share the tree until one of them is edited.
+	FsVisualSrf copy(shl),assigned;
+	assigned=shl;
+	if(tree!=copy.GetBoundingBoxTree() || tree!=assigned.GetBoundingBoxTree())
+	{
+		fprintf(stderr,"The copies do not share the tree.\n");
+		return YSERR;
+	}
+
+	YsShellVertexHandle copyVtHd=nullptr;
+	copy.MoveToNextVertex(copyVtHd);
+	copy.SetVertexPosition(copyVtHd,YsVec3(-3.0,0.0,0.0));
+	if(tree==copy.GetBoundingBoxTree() || tree!=shl.GetBoundingBoxTree())
+	{
+		fprintf(stderr,"Editing a copy affected the tree of the original.\n");
+		return YSERR;
+	}
+	return YSOK;
+}
+
+YSRESULT MultiThreadTest(void)
+{
+	// All the threads must get the same tree.
+	for(int repeat=0; repeat<100; ++repeat)
+	{
+		FsVisualSrf shl;
+		YsShellVertexHandle vtHd[3];
+		for(int i=0; i<50; ++i)
+		{
+			MakeTriangle(shl,vtHd);
+		}
+
+		const int nThread=4;
+		std::atomic <int> nReady(0);
+		std::vector <std::shared_ptr <const YsShellBoundingBoxTree> > tree(nThread);
+		std::vector <std::thread> thr;
+		for(int i=0; i<nThread; ++i)
+		{
+			thr.push_back(std::thread([&,i]()
+			{
+				++nReady;
+				while(nReady<nThread)
+				{
+				}
+				tree[i]=shl.GetBoundingBoxTree();
+			}));
+		}
+		for(auto &t : thr)
+		{
+			t.join();
+		}
+
+		for(int i=0; i<nThread; ++i)
+		{
+			if(tree[0]!=tree[i] || 50!=tree[i]->GetNumPolygon())
+			{
+				fprintf(stderr,"The threads got different trees.\n");
+				return YSERR;
+			}
+		}
+	}
+	return YSOK;
+}
+
+int main(void)
+{
+	int nFail=0;
+	if(YSOK!=InvalidateTest())
+	{
+		++nFail;
+	}
+	if(YSOK!=CopyTest())
+	{
+		++nFail;
+	}
+	if(YSOK!=MultiThreadTest())
+	{
+		++nFail;
+	}
+
+	printf("%d failed.\n",nFail);
+	if(0<nFail)
+	{
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,250 @@
+/* ////////////////////////////////////////////////////////////
+
+File Name: test.cpp
+Copyright (c) 2017 Soji Yamakawa.  All rights reserved.
+http://www.ysflight.com
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, 
+   this list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice, 
+   this list of conditions and the following disclaimer in the documentation 
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR 
+PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS 
+BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR 
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE 
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) 
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT 
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+//////////////////////////////////////////////////////////// */
+
+#include <stdio.h>
+#include <ysclass.h>
+#include <fsthreatavoidingpath.h>
+#include <fsrouteplanner.h>
+
+static FsRoutePlanner::Threat MakeThreat(int iff,const double x,const double z,const double range)
+{
+	FsRoutePlanner::Threat t;
+	t.iff=iff;
+	t.pos.Set(x,z);
+	t.range=range;
+	return t;
+}
+
+static double GetPointSegmentDistance(const YsVec2 &p,const YsVec2 &a,const YsVec2 &b)
+{
+	const YsVec2 d=b-a;
+	const double lSq=d.GetSquareLength();
+	const double t=(0.0<lSq ? YsBound(((p-a)*d)/lSq,0.0,1.0) : 0.0);
+	return (p-(a+d*t)).GetLength();
+}
+
+// The route must go around the threat on the straight line, and must not go around the ones that are behind the
+// start or of the same IFF.
+YSRESULT DetourTest(void)
+{
+	printf("%s\n",__FUNCTION__);
+
+	const YsVec2 start(0.0,0.0),goal(0.0,40000.0);
+
+	YsArray <FsRoutePlanner::Threat> threat;
+	threat.Append(MakeThreat(1,500.0,20000.0,4000.0));
+
+	FsRoutePlanner planner;
+	planner.SetThreat(1,threat);
+	const auto route=planner.RequestRoute(0,start,goal).get();
+
+	if(route.wayPoint.GetN()<3)
+	{
+		fprintf(stderr,"No detour.\n");
+		return YSERR;
+	}
+	if(1!=route.threatVersion)
+	{
+		fprintf(stderr,"Wrong threat version.\n");
+		return YSERR;
+	}
+	if(4000.0<(route.wayPoint[0]-start).GetLength() || 4000.0<(route.wayPoint.Last()-goal).GetLength())
+	{
+		fprintf(stderr,"The route does not connect the start and the goal.\n");
+		return YSERR;
+	}
+	for(YSSIZE_T i=0; i+1<route.wayPoint.GetN(); ++i)
+	{
+		const double dist=GetPointSegmentDistance(threat[0].pos,route.wayPoint[i],route.wayPoint[i+1]);
+		printf("  (%.0lf,%.0lf)-(%.0lf,%.0lf) %.0lf from the threat\n",
+		    route.wayPoint[i].x(),route.wayPoint[i].y(),route.wayPoint[i+1].x(),route.wayPoint[i+1].y(),dist);
+		if(dist<threat[0].range)
+		{
+			fprintf(stderr,"The route goes into the threat.\n");
+			return YSERR;
+		}
+	}
+	return YSOK;
+}
+
+YSRESULT IgnoredThreatTest(void)
+{
+	printf("%s\n",__FUNCTION__);
+
+	const YsVec2 start(0.0,0.0),goal(0.0,40000.0);
+
+	YsArray <FsRoutePlanner::Threat> threat;
+	threat.Append(MakeThreat(1,0.0,-20000.0,4000.0));  // On the line, but behind the start.
+	threat.Append(MakeThreat(1,0.0, 60000.0,4000.0));  // On the line, but beyond the goal.
+	threat.Append(MakeThreat(0,0.0, 20000.0,4000.0));  // Same IFF.
+
+	FsRoutePlanner planner;
+	planner.SetThreat(1,threat);
+	const auto route=planner.RequestRoute(0,start,goal).get();
+	if(2!=route.wayPoint.GetN())
+	{
+		fprintf(stderr,"Unnecessary detour (%d way points).\n",(int)route.wayPoint.GetN());
+		return YSERR;
+	}
+
+	// The same threats are hostile to IFF 2.
+	const auto hostile=planner.RequestRoute(2,start,goal).get();
+	if(hostile.wayPoint.GetN()<3)
+	{
+		fprintf(stderr,"Threat of the other IFF is ignored.\n");
+		return YSERR;
+	}
+	return YSOK;
+}
+
+YSRESULT CacheAndReplanTest(void)
+{
+	printf("%s\n",__FUNCTION__);
+
+	YsArray <FsRoutePlanner::Threat> threat;
+	threat.Append(MakeThreat(1,500.0,20000.0,4000.0));
+
+	FsRoutePlanner planner;
+	planner.SetThreat(1,threat);
+
+	// Same cells.  Must be the same route.
+	auto f=planner.RequestRoute(0,YsVec2(100.0,100.0),YsVec2(100.0,40100.0));
+	auto g=planner.RequestRoute(0,YsVec2(300.0,200.0),YsVec2(200.0,40300.0));
+	if(&f.get()!=&g.get())
+	{
+		fprintf(stderr,"Route of the same cells is not shared.\n");
+		return YSERR;
+	}
+
+	// Same version.  Cache must survive.
+	planner.SetThreat(1,threat);
+	auto h=planner.RequestRoute(0,YsVec2(100.0,100.0),YsVec2(100.0,40100.0));
+	if(&f.get()!=&h.get())
+	{
+		fprintf(stderr,"Cache dropped without a version change.\n");
+		return YSERR;
+	}
+
+	// New version.  Must be planned again against the new threats.
+	threat[0].pos.Set(-20000.0,20000.0);
+	planner.SetThreat(2,threat);
+	if(2!=planner.GetThreatVersion())
+	{
+		fprintf(stderr,"Version not updated.\n");
+		return YSERR;
+	}
+	auto k=planner.RequestRoute(0,YsVec2(100.0,100.0),YsVec2(100.0,40100.0));
+	if(&f.get()==&k.get() || 2!=k.get().threatVersion)
+	{
+		fprintf(stderr,"Not planned again after the threats changed.\n");
+		return YSERR;
+	}
+	if(2!=k.get().wayPoint.GetN())
+	{
+		fprintf(stderr,"The route is not planned against the new threats.\n");
+		return YSERR;
+	}
+
+	// The future handed out before the change stays valid.
+	if(1!=f.get().threatVersion || f.get().wayPoint.GetN()<3)
+	{
+		fprintf(stderr,"Old route broken.\n");
+		return YSERR;
+	}
+	return YSOK;
+}
+
+// CalculatePathCircleIntersection must only take the circles between the start and the goal.
+YSRESULT PathCircleIntersectionTest(void)
+{
+	printf("%s\n",__FUNCTION__);
+
+	FsThreatAvoidingPathFinder finder;
+	finder.SetStart(YsVec2(0.0,0.0));
+	finder.SetGoal(YsVec2(0.0,10000.0));
+	finder.AddCircle(YsVec2(0.0,-5000.0),1000.0);  // Behind the start
+	finder.AddCircle(YsVec2(0.0, 5000.0),1000.0);  // In between
+	finder.AddCircle(YsVec2(0.0,16000.0),1000.0);  // Beyond the goal
+	finder.AddCircle(YsVec2(0.0,  500.0),1000.0);  // Covers the start
+	finder.AddCircle(YsVec2(0.0, 9500.0),1000.0);  // Covers the goal
+	finder.CalculatePathCircleIntersection();
+
+	YSBOOL found[5]={YSFALSE,YSFALSE,YSFALSE,YSFALSE,YSFALSE};
+	for(auto &itsc : finder.itscArray)
+	{
+		found[itsc.circleIdx]=YSTRUE;
+	}
+	if(YSTRUE==found[0] || YSTRUE==found[2])
+	{
+		fprintf(stderr,"A circle outside of the path is taken.\n");
+		return YSERR;
+	}
+	if(YSTRUE!=found[1] || YSTRUE!=found[3] || YSTRUE!=found[4])
+	{
+		fprintf(stderr,"A circle on the path is missed.\n");
+		return YSERR;
+	}
+	for(YSSIZE_T i=1; i<finder.itscArray.GetN(); ++i)
+	{
+		if(finder.itscArray[i].dist[0]<finder.itscArray[i-1].dist[0])
+		{
+			fprintf(stderr,"Intersections are not sorted.\n");
+			return YSERR;
+		}
+	}
+	return YSOK;
+}
+
+int main(void)
+{
+	int nFail=0;
+	if(YSOK!=DetourTest())
+	{
+		++nFail;
+	}
+	if(YSOK!=IgnoredThreatTest())
+	{
+		++nFail;
+	}
+	if(YSOK!=CacheAndReplanTest())
+	{
+		++nFail;
+	}
+	if(YSOK!=PathCircleIntersectionTest())
+	{
+		++nFail;
+	}
+
+	printf("%d failed.\n",nFail);
+	if(0<nFail)
+	{
+		return 1;
+	}
+	return 0;
+}
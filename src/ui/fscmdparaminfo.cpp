@@ -23,6 +23,13 @@ FsCommandParameter::FsCommandParameter()
 	netServerName.Set("");
 	netCloseServerWhenAllLogOut=YSTFUNKNOWN;
 	yfsFilename.SetLength(0);
+	convertOutputFilename.SetLength(0);
+	convertToBinary=YSFALSE;
+	simBenchScenario.Set("");
+	simBenchNumAir=0;
+	simBenchNumGnd=0;
+	simBenchTime=0.0;
+	simBenchOutputFilename.SetLength(0);
 	airName.Set("");
 	fldName.Set("");
 	startPos.Set("");
@@ -89,6 +96,60 @@ YSRESULT FsCommandParameter::RecognizeCommandParameter(int ac,char *av[])
 			yfsFilename.Set(wStr);
 			i+=2;
 		}
+		else if(0==cmd.STRCMP("-netstatebench") && i+1<ac)
+		{
+			executionMode=EXEMODE_NETSTATEBENCHMARK;
+			YsWString wStr;
+			YsSystemEncodingToUnicode(wStr,av[i+1]);
+			yfsFilename.Set(wStr);
+			i+=2;
+		}
+		else if(0==cmd.STRCMP("-broadphasebench") && i+1<ac)
+		{
+			executionMode=EXEMODE_BROADPHASEBENCHMARK;
+			YsWString wStr;
+			YsSystemEncodingToUnicode(wStr,av[i+1]);
+			yfsFilename.Set(wStr);
+			i+=2;
+		}
+		else if(0==cmd.STRCMP("-elevationbench") && i+1<ac)
+		{
+			executionMode=EXEMODE_ELEVATIONBENCHMARK;
+			fldName.Set(av[i+1]);
+			i+=2;
+		}
+		else if(0==cmd.STRCMP("-templatebench") && i+1<ac)
+		{
+			executionMode=EXEMODE_TEMPLATEBENCHMARK;
+			YsWString wStr;
+			YsSystemEncodingToUnicode(wStr,av[i+1]);
+			yfsFilename.Set(wStr);
+			i+=2;
+		}
+		else if(0==cmd.STRCMP("-simbench") && i+6<ac)
+		{
+			executionMode=EXEMODE_SIMBENCHMARK;
+			simBenchScenario.Set(av[i+1]);
+			fldName.Set(av[i+2]);
+			simBenchNumAir=atoi(av[i+3]);
+			simBenchNumGnd=atoi(av[i+4]);
+			simBenchTime=atof(av[i+5]);
+			YsWString wStr;
+			YsSystemEncodingToUnicode(wStr,av[i+6]);
+			simBenchOutputFilename.Set(wStr);
+			i+=7;
+		}
+		else if(0==cmd.STRCMP("-convertyfs") && i+3<ac)
+		{
+			executionMode=EXEMODE_CONVERTFLIGHTRECORD;
+			YsWString wStr;
+			YsSystemEncodingToUnicode(wStr,av[i+1]);
+			yfsFilename.Set(wStr);
+			YsSystemEncodingToUnicode(wStr,av[i+2]);
+			convertOutputFilename.Set(wStr);
+			convertToBinary=(0==YsString(av[i+3]).STRCMP("BINARY") ? YSTRUE : YSFALSE);
+			i+=4;
+		}
 		else if(0==cmd.STRCMP("-server") && i+1<ac)
 		{
 			executionMode=1;
@@ -280,6 +341,37 @@ void FsCommandParameter::ShowHelp(void)
 	printf("   Replay flight record.\n");
 	printf("\n");
 
+	printf("  -netstatebench Filename\n");
+	printf("   Replay flight record through the airplane-state delta encoder and\n");
+	printf("   report the network traffic.  (Console server only)\n");
+	printf("\n");
+
+	printf("  -convertyfs Input Output TEXT|BINARY\n");
+	printf("   Convert flight record.  BINARY saves the airplane and ground records\n");
+	printf("   in a binary record file (.yfr) next to the output .yfs.  (Console server only)\n");
+	printf("\n");
+
+	printf("  -broadphasebench Filename\n");
+	printf("   Play back the flight record, and compare the collision candidates and\n");
+	printf("   the query time of the broad phase and the old lattice.  (Console server only)\n");
+	printf("\n");
+
+	printf("  -elevationbench Field\n");
+	printf("   Compare the terrain-elevation queries with and without the elevation\n");
+	printf("   index of the field.  (Console server only)\n");
+	printf("\n");
+
+	printf("  -templatebench RootDir\n");
+	printf("   Load the airplane templates listed in RootDir/aircraft/air*.lst without and\n");
+	printf("   with the template index, and time the template lookup.  (Console server only)\n");
+	printf("\n");
+
+	printf("  -simbench Scenario Field NumAirplane NumGround Seconds JsonFile\n");
+	printf("   Run the simulation of Scenario (dogfight, endurance, airshow, flarestorm, or strike)\n");
+	printf("   for the given simulated seconds as fast as possible, and write the time of\n");
+	printf("   each phase of the simulation step to JsonFile.  (Console server only)\n");
+	printf("\n");
+
 	printf("  -freeflight Airplane Field Position\n");
 	printf("   Fly Free Flight.\n");
 	printf("\n");
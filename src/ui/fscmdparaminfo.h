@@ -26,7 +26,13 @@ public:
 		EXEMODE_ENDURANCE=5,
 		EXEMODE_INTERCEPT=6,
 		EXEMODE_REPLAYRECORD=100,
-		EXEMODE_OPENINGDEMOFOREVER=200
+		EXEMODE_OPENINGDEMOFOREVER=200,
+		EXEMODE_NETSTATEBENCHMARK=300,
+		EXEMODE_CONVERTFLIGHTRECORD=301,
+		EXEMODE_BROADPHASEBENCHMARK=302,
+		EXEMODE_ELEVATIONBENCHMARK=303,
+		EXEMODE_TEMPLATEBENCHMARK=304,
+		EXEMODE_SIMBENCHMARK=305
 	};
 
 	int executionMode;  //  0:Normal
@@ -38,6 +44,12 @@ public:
 	                    //  6:Intercept Mission
 	                    //100:Replay Record
 	                    //200:Opening demo forever
+	                    //300:Network airplane-state benchmark (Console server only)
+	                    //301:Convert flight record between text and binary (Console server only)
+	                    //302:Broad-phase collision benchmark (Console server only)
+	                    //303:Terrain-elevation query benchmark (Console server only)
+	                    //304:Airplane-template loading benchmark (Console server only)
+	                    //305:Headless simulation benchmark (Console server only)
 
 	FsInterceptMissionInfo interceptMissionInfo;
 	int endModeNumWingman,endModeWingmanLevel;
@@ -56,6 +68,13 @@ public:
 
 	YSBOOL autoSave;
 	YsWString yfsFilename;
+	YsWString convertOutputFilename;
+	YSBOOL convertToBinary;
+
+	YsString simBenchScenario;
+	int simBenchNumAir,simBenchNumGnd;
+	double simBenchTime;
+	YsWString simBenchOutputFilename;
 
 	YsWString testScriptFilename;
 
@@ -111,6 +111,7 @@ void FsAirplaneProperty::InitializeState(void)
 	staHobbsTime=0.0;
 	staStateTimer=0.0;
 	staDiedOf=FSDIEDOF_NULL;
+	staRandomState=0;
 	staNeedTouchdownCheck=YSFALSE;
 	staOutOfRunway=YSFALSE;
 
@@ -228,6 +229,17 @@ void FsAirplaneProperty::InitializeState(void)
 	ClearMalfunction();
 }
 
+void FsAirplaneProperty::SetRandomSeed(unsigned int seed)
+{
+	staRandomState=seed;
+}
+
+int FsAirplaneProperty::Random(void)
+{
+	staRandomState=staRandomState*1103515245+12345;
+	return (int)((staRandomState>>16)&RANDOM_MAX);
+}
+
 void FsAirplaneProperty::Initialize(void)
 {
 	InitializeState();
@@ -1043,7 +1055,7 @@ void FsAirplaneProperty::Move(
 		if(0.0>staHUDFlickerTimer)
 		{
 			YsFlip(staHUDVisible);
-			staHUDFlickerTimer=(double)rand()/(double)RAND_MAX;
+			staHUDFlickerTimer=(double)Random()/(double)RANDOM_MAX;
 		}
 	}
 }
@@ -2104,7 +2116,7 @@ void FsAirplaneProperty::CalculateGround(const double &dt)
 				// Change in 0.2 sec is 100 %
 				// Change in dt sec is 100*(dt/0.2) %
 				double rnd;
-				rnd=(double)(rand()%10000)/10000.0;
+				rnd=(double)(Random()%10000)/10000.0;
 				if(rnd<dt/0.2)
 				{
 					double v;
@@ -6500,7 +6512,7 @@ YSBOOL FsAirplaneProperty::GetDamage(YSBOOL &killed,int dmg,FSDIEDOF diedOf)
 		staDamageTolerance-=dmg;
 		if(staDamageTolerance<=0)
 		{
-			switch((rand()%700)/100)
+			switch((Random()%700)/100)
 			{
 			case 0:
 				SetState(FSDEAD,diedOf);
@@ -10069,7 +10081,7 @@ YSBOOL FsAirplaneProperty::IsTrailingSmoke(int smkIdx) const
 	return YSFALSE;
 }
 
-void FsAirplaneProperty::WriteFlightRecord(FsFlightRecord &rec) const
+void FsAirplaneProperty::WriteFlightRecord(FsFlightRecord &rec,YsArray <FsTurretRecord,16> &turret) const
 {
 	rec.pos=staPosition;
 	rec.h=(float)staAttitude.h();
@@ -10145,24 +10157,17 @@ void FsAirplaneProperty::WriteFlightRecord(FsFlightRecord &rec) const
 	rec.bombBay=YsBound((int)(staBombBayDoor*99),0,99);
 	rec.thrReverser=YsBound((int)(staThrRev*99.0),0,99);
 
-	if(staTurret.GetN()>0)
+	turret.Resize(staTurret.GetN());
+	for(YSSIZE_T i=0; i<staTurret.GetN(); i++)
 	{
-		rec.turret.Alloc((int)staTurret.GetN());
-		if(rec.turret.GetN()==staTurret.GetN())
-		{
-			int i;
-			for(i=0; i<staTurret.GetN(); i++)
-			{
-				rec.turret[i].h=(float)staTurret[i].h;
-				rec.turret[i].p=(float)staTurret[i].p;
-				rec.turret[i].turretState=staTurret[i].turretState;
-			}
-		}
+		turret[i].h=(float)staTurret[i].h;
+		turret[i].p=(float)staTurret[i].p;
+		turret[i].turretState=staTurret[i].turretState;
 	}
 }
 
 void FsAirplaneProperty::ReadbackFlightRecord(
-    const FsFlightRecord &rec,
+    const FsFlightRecord &rec,const YsConstArrayMask <FsTurretRecord> &turret,
     const double &dt,const double &velocity,
     const YsAtt3 &vRot,const YsVec3 &totalForce,const YsVec3 &unitVelocityVector)
 {
@@ -10247,16 +10252,16 @@ void FsAirplaneProperty::ReadbackFlightRecord(
 	staBombBayDoor=((double)rec.bombBay)/99.0;
 	staThrRev=((double)rec.thrReverser)/99.0;
 
-	if(staTurret.GetN()>0 && rec.turret.GetN()==staTurret.GetN())
+	if(staTurret.GetN()>0 && turret.GetN()==staTurret.GetN())
 	{
 		int i;
 		for(i=0; i<staTurret.GetN(); i++)
 		{
-			staTurret[i].h=(double)rec.turret[i].h;
-			staTurret[i].p=(double)rec.turret[i].p;
-			staTurret[i].ctlH=(double)rec.turret[i].h;
-			staTurret[i].ctlP=(double)rec.turret[i].p;
-			staTurret[i].turretState=rec.turret[i].turretState;
+			staTurret[i].h=(double)turret[i].h;
+			staTurret[i].p=(double)turret[i].p;
+			staTurret[i].ctlH=(double)turret[i].h;
+			staTurret[i].ctlP=(double)turret[i].p;
+			staTurret[i].turretState=turret[i].turretState;
 		}
 	}
 
@@ -10450,6 +10455,22 @@ const char *FsGetAirplaneCategoryString(FSAIRPLANECATEGORY cat)
 	{
 		return "HEAVYBOMBER";
 	}
+	else if(cat==FSAC_WW2FIGHTER)
+	{
+		return "WW2FIGHTER";
+	}
+	else if(cat==FSAC_WW2BOMBER)
+	{
+		return "WW2BOMBER";
+	}
+	else if(cat==FSAC_WW2ATTACKER)
+	{
+		return "WW2ATTACKER";
+	}
+	else if(cat==FSAC_WW2DIVEBOMBER)
+	{
+		return "WW2DIVEBOMBER";
+	}
 	else
 	{
 		return "";
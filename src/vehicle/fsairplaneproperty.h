@@ -211,6 +211,8 @@ protected:
 	YSBOOL staHUDVisible;
 	double staHUDFlickerTimer;
 
+	unsigned int staRandomState;   // Random numbers of this airplane.  Move may run in a worker thread, and cannot use rand().
+
 
 	YsArray <FsWeaponSlotLoading> staWeaponSlot;
 
@@ -487,9 +489,22 @@ protected:
 	static const char *const keyWordSource[];
 	static YsKeyWordList keyWordList;
 
+	enum
+	{
+		RANDOM_MAX=0x7fff
+	};
+
 public:
 	FsAirplaneProperty();
 	void InitializeState(void);
+
+	/*! Seeds the random numbers of this airplane.  FsSimulation::AddAirplane seeds it with the search key of the airplane
+	    so that the global rand() sequence is not disturbed. */
+	void SetRandomSeed(unsigned int seed);
+private:
+	/*! Returns 0 to RANDOM_MAX from the random numbers of this airplane. */
+	int Random(void);
+public:
 	void Initialize(void);
 	void ClearMalfunction(void);
 	void ReleaseVirtualButton(void);
@@ -888,9 +903,9 @@ public:
 	YSBOOL IsTrailingVapor(void) const;
 	YSBOOL IsTrailingSmoke(int smkIdx) const;
 
-	void WriteFlightRecord(class FsFlightRecord &rec) const;
+	void WriteFlightRecord(class FsFlightRecord &rec,YsArray <class FsTurretRecord,16> &turret) const;
 	void ReadbackFlightRecord
-	(const FsFlightRecord &rec,
+	(const FsFlightRecord &rec,const YsConstArrayMask <class FsTurretRecord> &turret,
 	 const double &dt,const double &velocity,
 	 const YsAtt3 &vRot,const YsVec3 &totalForce,const YsVec3 &unitVelocityVector);
 	void ComputeCarrierLandingAfterReadingFlightRecord(const double &dt,const YsArray <FsGround *> &carrierList);
@@ -2177,7 +2177,7 @@ const double &FsGroundProperty::GetNdbRange(void) const
 	return chNdbRange;
 }
 
-void FsGroundProperty::WriteRecord(FsGroundRecord &rec) const
+void FsGroundProperty::WriteRecord(FsGroundRecord &rec,YsArray <FsTurretRecord,16> &turret) const
 {
 	rec.pos=staPosition;
 	rec.h=float(staAttitude.h());
@@ -2206,23 +2206,16 @@ void FsGroundProperty::WriteRecord(FsGroundRecord &rec) const
 	rec.canAimp=float(staCanAim.p());
 	rec.canAimb=float(staCanAim.b());
 
-	if(staTurret.GetN()>0)
+	turret.Resize(staTurret.GetN());
+	for(YSSIZE_T i=0; i<staTurret.GetN(); i++)
 	{
-		rec.turret.Alloc((int)staTurret.GetN());
-		if(rec.turret.GetN()==staTurret.GetN())
-		{
-			int i;
-			for(i=0; i<staTurret.GetN(); i++)
-			{
-				rec.turret[i].h=(float)staTurret[i].h;
-				rec.turret[i].p=(float)staTurret[i].p;
-				rec.turret[i].turretState=staTurret[i].turretState;
-			}
-		}
+		turret[i].h=(float)staTurret[i].h;
+		turret[i].p=(float)staTurret[i].p;
+		turret[i].turretState=staTurret[i].turretState;
 	}
 }
 
-void FsGroundProperty::ReadbackRecord(FsGroundRecord &rec,const double &dt,const double &velocity)
+void FsGroundProperty::ReadbackRecord(const FsGroundRecord &rec,const YsConstArrayMask <FsTurretRecord> &turret,const double &dt,const double &velocity)
 {
 	YsMatrix4x4 prv;  // Used only if it is an aircraft carrier.
 	if(YSTRUE==isAircraftCarrier)
@@ -2262,15 +2255,15 @@ void FsGroundProperty::ReadbackRecord(FsGroundRecord &rec,const double &dt,const
 		aircraftCarrierProperty->MoveCargoAndILS(GetMatrix(),prv,0.0);
 	}
 
-	if(staTurret.GetN()>0 && rec.turret.GetN()==staTurret.GetN())
+	if(staTurret.GetN()>0 && turret.GetN()==staTurret.GetN())
 	{
 		for(int i=0; i<staTurret.GetN(); i++)
 		{
-			staTurret[i].h=(double)rec.turret[i].h;
-			staTurret[i].p=(double)rec.turret[i].p;
-			staTurret[i].ctlH=(double)rec.turret[i].h;
-			staTurret[i].ctlP=(double)rec.turret[i].p;
-			staTurret[i].turretState=rec.turret[i].turretState;
+			staTurret[i].h=(double)turret[i].h;
+			staTurret[i].p=(double)turret[i].p;
+			staTurret[i].ctlH=(double)turret[i].h;
+			staTurret[i].ctlP=(double)turret[i].p;
+			staTurret[i].turretState=turret[i].turretState;
 		}
 	}
 }
@@ -328,8 +328,8 @@ public:
 
 	const double &GetNdbRange(void) const;
 
-	void WriteRecord(class FsGroundRecord &rec) const;
-	void ReadbackRecord(class FsGroundRecord &rec,const double &dt,const double &velocity);
+	void WriteRecord(class FsGroundRecord &rec,YsArray <class FsTurretRecord,16> &turret) const;
+	void ReadbackRecord(const class FsGroundRecord &rec,const YsConstArrayMask <class FsTurretRecord> &turret,const double &dt,const double &velocity);
 	virtual void CaptureState(YsArray <YsString> &stateStringArray) const;
 
 	void SetState(FSGNDSTATE sta);
@@ -239,6 +239,28 @@ void FsRotatingTurretState::MoveGunner(
 	}
 }
 
+void FsRotatingTurretProperty::ForgetVisual(const FsVisualDnm *vis) const
+{
+	for(int j=0; j<3; j++)
+	{
+		if(dnm[j]==vis)
+		{
+			dnm[j]=NULL;
+			dnmNodeId[j]=-1;
+		}
+		if(dnmHdg[j]==vis)
+		{
+			dnmHdg[j]=NULL;
+			dnmHdgNodeId[j]=-1;
+		}
+		if(dnmPch[j]==vis)
+		{
+			dnmPch[j]=NULL;
+			dnmPchNodeId[j]=-1;
+		}
+	}
+}
+
 void FsRotatingTurretState::SetupVisual(FsVisualDnm &vis,const FsRotatingTurretProperty &chTurret) const
 {
 	int j;
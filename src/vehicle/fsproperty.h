@@ -50,6 +50,9 @@ public:
 
 	FsRotatingTurretProperty();
 	void Initialize(void);
+
+	// Drops the cached node IDs for vis.  Must be called when a different model is given to the same FsVisualDnm.
+	void ForgetVisual(const class FsVisualDnm *vis) const;
 };
 
 enum
@@ -309,6 +309,14 @@ void FsVehicleProperty::SaveTurretState(void) const
 	}
 }
 
+void FsVehicleProperty::ForgetVisual(const FsVisualDnm *vis) const
+{
+	for(auto &turret : chTurret)
+	{
+		turret.ForgetVisual(vis);
+	}
+}
+
 unsigned int FsVehicleProperty::EncodeTurretState(unsigned char dat[],int idOnSvr,const int netCmd) const
 {
 	if(staTurret.GetN()>0)
@@ -95,6 +95,9 @@ public:
 	YSRESULT SetPilotControlledTurretPitch(const double &a);
 	YSBOOL TurretStateChanged(void) const;
 	void SaveTurretState(void) const;
+	/*! Drops node IDs cached for vis.  Call after a new model is assigned to vis, for example when
+	    a streamed model replaces the coarse stand-in. */
+	void ForgetVisual(const class FsVisualDnm *vis) const;
 	unsigned int EncodeTurretState(unsigned char dat[],int idOnSvr,const int netCmd) const; // netCmd can be FSNETCMD_AIRTURRETSTATE or FSNETCMD_GNDTURRETSTATE
 	YSRESULT DecodeTurretState(unsigned char dat[],unsigned int packetLength);
 